@@ -30,6 +30,11 @@
 #define _POSIX_C_SOURCE 200809L
 #endif
 
+#ifdef _WIN32
+// exposes rand_s() of stdlib.h
+#define _CRT_RAND_S
+#endif
+
 #include "iotivity_config.h"
 
 #ifdef HAVE_FCNTL_H
@@ -48,18 +53,22 @@
 #include <time.h>
 #endif
 #if defined(__ANDROID__)
-#include <ctype.h>
 #include <linux/time.h>
 #endif
 #ifdef HAVE_WINDOWS_H
 #include <windows.h>
 #endif
-#include "ocrandom.h"
-#include <stdio.h>
-
-#ifdef HAVE_UUID_UUID_H
-#include <uuid/uuid.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#if defined(HAVE_SYS_RANDOM_H) && defined(__linux__)
+#include <sys/random.h>
 #endif
+#include "ocrandom.h"
+#include "platform_features.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
 
 #define NANO_SEC 1000000000
 
@@ -113,10 +122,9 @@ uint8_t GetRandomBit()
 }
 #endif
 
-int8_t OCSeedRandom()
-{
 #ifndef ARDUINO
-    // Get current time to Seed.
+static uint64_t OCGetCurrentTimeUs()
+{
     uint64_t currentTime = 0;
 #ifdef __ANDROID__
     struct timespec getTs;
@@ -135,33 +143,293 @@ int8_t OCSeedRandom()
     struct timeval tv;
     gettimeofday(&tv, NULL);
     currentTime = tv.tv_sec * (uint64_t)1000000 + tv.tv_usec;
+#endif
+    return currentTime;
+}
+
+/**
+ * Reads len bytes of entropy from the operating system.
+ * @return true on success, false if no source is available.
+ */
+static bool OCGetEntropy(uint8_t *location, size_t len)
+{
+#if defined(HAVE_SYS_RANDOM_H) && defined(__linux__)
+    while (len > 0)
+    {
+        ssize_t currentRead = getrandom(location, len, 0);
+        if (currentRead > 0)
+        {
+            location += currentRead;
+            len -= currentRead;
+        }
+        else if (currentRead < 0 && EINTR != errno)
+        {
+            break;
+        }
+    }
+    if (0 == len)
+    {
+        return true;
+    }
 #endif
 #if defined(__unix__) || defined(__APPLE__)
     int32_t fd = open("/dev/urandom", O_RDONLY);
-    if (fd >= 0)
+    if (fd < 0)
+    {
+        return false;
+    }
+    while (len > 0)
     {
-        uint32_t randomSeed = 0;
-        uint32_t totalRead = 0; //how many integers were read
-        int32_t currentRead = 0;
-        while (totalRead < sizeof(randomSeed))
+        ssize_t currentRead = read(fd, location, len);
+        if (currentRead > 0)
         {
-            currentRead = read(fd, (uint8_t*) &randomSeed + totalRead,
-                    sizeof(randomSeed) - totalRead);
-            if (currentRead > 0)
+            location += currentRead;
+            len -= currentRead;
+        }
+        else if (currentRead < 0 && EINTR != errno)
+        {
+            break;
+        }
+    }
+    close(fd);
+    return 0 == len;
+#elif defined(_WIN32)
+    while (len > 0)
+    {
+        unsigned int value = 0;
+        if (0 != rand_s(&value))
+        {
+            return false;
+        }
+        size_t size = len < sizeof(value) ? len : sizeof(value);
+        memcpy(location, &value, size);
+        location += size;
+        len -= size;
+    }
+    return true;
+#else
+    (void) location;
+    return false;
+#endif
+}
+
+/*
+ * Random numbers come from a ChaCha20 stream generator per thread, keyed from
+ * the operating system. Output is generated a few blocks at a time into a
+ * buffer. The first bytes of every refill replace the key and served bytes
+ * are wiped, so earlier output can not be recovered from the state
+ * ("fast key erasure"). The key is mixed with new entropy every
+ * RANDOM_RESEED_BYTES of output, every RANDOM_RESEED_SEC seconds and after
+ * fork().
+ */
+#define CHACHA20_BLOCK_SIZE     (64)
+#define RANDOM_BUFFER_BLOCKS    (4)
+#define RANDOM_BUFFER_SIZE      (CHACHA20_BLOCK_SIZE * RANDOM_BUFFER_BLOCKS)
+#define RANDOM_KEY_SIZE         (32)
+#define RANDOM_RESEED_BYTES     (1024 * 1024)
+#define RANDOM_RESEED_SEC       (300)
+
+typedef struct
+{
+    uint32_t key[RANDOM_KEY_SIZE / 4];      /**< ChaCha20 key */
+    uint8_t buffer[RANDOM_BUFFER_SIZE];     /**< generated output */
+    size_t available;                       /**< unserved bytes at the end of buffer */
+    uint64_t served;                        /**< bytes served since the last seed */
+    uint64_t seedTime;                      /**< time of the last seed, microseconds */
+    uint32_t forkCount;                     /**< g_forkCount at the last seed */
+    bool seeded;                            /**< whether the key was seeded */
+} OCRandomState_t;
+
+// Without thread local storage all threads share one generator.
+#ifdef OC_THREAD_LOCAL
+static OC_THREAD_LOCAL OCRandomState_t g_randomState;
+#else
+static OCRandomState_t g_randomState;
+#endif
+
+// Number of fork() calls this process is a child of.
+static volatile uint32_t g_forkCount = 0;
+
+#if defined(HAVE_PTHREAD_H) && !defined(_WIN32)
+static pthread_once_t g_atForkOnce = PTHREAD_ONCE_INIT;
+
+static void OCRandomAtForkChild(void)
+{
+    g_forkCount++;
+}
+
+static void OCRandomRegisterAtFork(void)
+{
+    pthread_atfork(NULL, NULL, OCRandomAtForkChild);
+}
+#endif
+
+// Clears a local variable, which a plain memset() may be optimized away for.
+static void OCWipe(void *location, size_t len)
+{
+    volatile uint8_t *p = (volatile uint8_t *) location;
+    while (len--)
+    {
+        *p++ = 0;
+    }
+}
+
+static uint32_t OCLoad32(const uint8_t *p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+           ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static void OCStore32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t) value;
+    p[1] = (uint8_t) (value >> 8);
+    p[2] = (uint8_t) (value >> 16);
+    p[3] = (uint8_t) (value >> 24);
+}
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTERROUND(a, b, c, d) \
+    a += b; d ^= a; d = ROTL32(d, 16); \
+    c += d; b ^= c; b = ROTL32(b, 12); \
+    a += b; d ^= a; d = ROTL32(d, 8); \
+    c += d; b ^= c; b = ROTL32(b, 7);
+
+/**
+ * Generates one ChaCha20 block (RFC 7539) of the given input state.
+ */
+static void OCChaCha20Block(const uint32_t input[16], uint8_t output[CHACHA20_BLOCK_SIZE])
+{
+    uint32_t x[16];
+    memcpy(x, input, sizeof(x));
+
+    for (int i = 0; i < 10; i++)
+    {
+        QUARTERROUND(x[0], x[4], x[8], x[12])
+        QUARTERROUND(x[1], x[5], x[9], x[13])
+        QUARTERROUND(x[2], x[6], x[10], x[14])
+        QUARTERROUND(x[3], x[7], x[11], x[15])
+        QUARTERROUND(x[0], x[5], x[10], x[15])
+        QUARTERROUND(x[1], x[6], x[11], x[12])
+        QUARTERROUND(x[2], x[7], x[8], x[13])
+        QUARTERROUND(x[3], x[4], x[9], x[14])
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+        OCStore32(output + 4 * i, x[i] + input[i]);
+    }
+    OCWipe(x, sizeof(x));
+}
+
+static void OCRandomRefill(OCRandomState_t *state)
+{
+    // "expand 32-byte k", key, block counter and a zero nonce. The key is
+    // never used twice, so neither is the nonce.
+    uint32_t input[16] = { 0x61707865, 0x3320646e, 0x79622d32, 0x6b206574 };
+    memcpy(&input[4], state->key, sizeof(state->key));
+
+    for (uint32_t block = 0; block < RANDOM_BUFFER_BLOCKS; block++)
+    {
+        input[12] = block;
+        OCChaCha20Block(input, state->buffer + block * CHACHA20_BLOCK_SIZE);
+    }
+    OCWipe(input, sizeof(input));
+
+    for (size_t i = 0; i < RANDOM_KEY_SIZE / 4; i++)
+    {
+        state->key[i] = OCLoad32(state->buffer + 4 * i);
+    }
+    memset(state->buffer, 0, RANDOM_KEY_SIZE);
+    state->available = RANDOM_BUFFER_SIZE - RANDOM_KEY_SIZE;
+}
+
+static void OCRandomSeed(OCRandomState_t *state)
+{
+#if defined(HAVE_PTHREAD_H) && !defined(_WIN32)
+    pthread_once(&g_atForkOnce, OCRandomRegisterAtFork);
+#endif
+    state->forkCount = g_forkCount;
+
+    uint8_t seed[RANDOM_KEY_SIZE];
+    uint64_t currentTime = OCGetCurrentTimeUs();
+    if (!OCGetEntropy(seed, sizeof(seed)))
+    {
+        // Nothing better than the time and the location of the state
+        // (which differs per thread) is available.
+        uintptr_t address = (uintptr_t) state;
+        memset(seed, 0, sizeof(seed));
+        memcpy(seed, &currentTime, sizeof(currentTime));
+        memcpy(seed + sizeof(currentTime), &address, sizeof(address));
+    }
+
+    // Entropy is added to the key, which keeps what it already had.
+    for (size_t i = 0; i < RANDOM_KEY_SIZE / 4; i++)
+    {
+        state->key[i] ^= OCLoad32(seed + 4 * i);
+    }
+    OCWipe(seed, sizeof(seed));
+    memset(state->buffer, 0, sizeof(state->buffer));
+
+    state->available = 0;
+    state->served = 0;
+    state->seedTime = currentTime;
+    state->seeded = true;
+}
+
+static void OCRandomFill(uint8_t *location, size_t len)
+{
+    OCRandomState_t *state = &g_randomState;
+    if (!state->seeded || state->forkCount != g_forkCount
+        || RANDOM_RESEED_BYTES <= state->served)
+    {
+        OCRandomSeed(state);
+    }
+    state->served += len;
+
+    while (len > 0)
+    {
+        if (0 == state->available)
+        {
+            if (OCGetCurrentTimeUs() - state->seedTime >= RANDOM_RESEED_SEC * (uint64_t)1000000)
             {
-                totalRead += currentRead;
+                OCRandomSeed(state);
             }
+            OCRandomRefill(state);
         }
-        close(fd);
+
+        size_t size = len < state->available ? len : state->available;
+        uint8_t *output = state->buffer + RANDOM_BUFFER_SIZE - state->available;
+        memcpy(location, output, size);
+        memset(output, 0, size);
+
+        state->available -= size;
+        location += size;
+        len -= size;
+    }
+}
+#endif
+
+int8_t OCSeedRandom()
+{
+#ifndef ARDUINO
+    // Get current time to Seed.
+    uint64_t currentTime = OCGetCurrentTimeUs();
+
+    // rand() is still seeded for code that uses it directly.
+    uint32_t randomSeed = 0;
+    if (OCGetEntropy((uint8_t *) &randomSeed, sizeof(randomSeed)))
+    {
         srand(randomSeed | currentTime);
     }
     else
-#endif
     {
-        // Do time based seed when problem in accessing "/dev/urandom"
+        // Do time based seed when no entropy source is available
         srand(currentTime);
     }
 
+    OCRandomSeed(&g_randomState);
     return 0;
 #elif defined ARDUINO
     uint32_t result =0;
@@ -186,10 +454,14 @@ void OCFillRandomMem(uint8_t * location, uint16_t len)
     {
         return;
     }
+#ifndef ARDUINO
+    OCRandomFill(location, len);
+#else
     for (; len--;)
     {
         *location++ = OCGetRandomByte();
     }
+#endif
 }
 
 uint32_t OCGetRandom()
@@ -201,7 +473,11 @@ uint32_t OCGetRandom()
 
 uint8_t OCGetRandomByte(void)
 {
-#ifdef HAVE_SRANDOM
+#ifndef ARDUINO
+    uint8_t result = 0;
+    OCRandomFill(&result, sizeof(result));
+    return result;
+#elif defined(HAVE_SRANDOM)
     return random() & 0x00FF;
 #else
     return rand() & 0x00FF;
@@ -231,70 +507,19 @@ uint32_t OCGetRandomRange(uint32_t firstBound, uint32_t secondBound)
     return result;
 }
 
-#if defined(__ANDROID__)
-uint8_t parseUuidChar(char c)
-{
-    if (isdigit(c))
-    {
-        return c - '0';
-    }
-    else
-    {
-        return c - 'a' + 10;
-    }
-}
-uint8_t parseUuidPart(const char *c)
-{
-    return (parseUuidChar(c[0])<<4) + parseUuidChar(c[1]);
-}
-#endif
-
 OCRandomUuidResult OCGenerateUuid(uint8_t uuid[UUID_SIZE])
 {
     if (!uuid)
     {
         return RAND_UUID_INVALID_PARAM;
     }
-#if defined(__ANDROID__)
-    char uuidString[UUID_STRING_SIZE];
-    int8_t ret = OCGenerateUuidString(uuidString);
-
-    if (ret < 0)
-    {
-        return ret;
-    }
-
-    uuid[ 0] = parseUuidPart(&uuidString[0]);
-    uuid[ 1] = parseUuidPart(&uuidString[2]);
-    uuid[ 2] = parseUuidPart(&uuidString[4]);
-    uuid[ 3] = parseUuidPart(&uuidString[6]);
-
-    uuid[ 4] = parseUuidPart(&uuidString[9]);
-    uuid[ 5] = parseUuidPart(&uuidString[11]);
-
-    uuid[ 6] = parseUuidPart(&uuidString[14]);
-    uuid[ 7] = parseUuidPart(&uuidString[16]);
-
-    uuid[ 8] = parseUuidPart(&uuidString[19]);
-    uuid[ 9] = parseUuidPart(&uuidString[21]);
 
-    uuid[10] = parseUuidPart(&uuidString[24]);
-    uuid[11] = parseUuidPart(&uuidString[26]);
-    uuid[12] = parseUuidPart(&uuidString[28]);
-    uuid[13] = parseUuidPart(&uuidString[30]);
-    uuid[14] = parseUuidPart(&uuidString[32]);
-    uuid[15] = parseUuidPart(&uuidString[34]);
-
-    return RAND_UUID_OK;
-#elif defined(HAVE_UUID_UUID_H)
-    // note: uuid_t is typedefed as unsigned char[16] on linux/apple
-    uuid_generate(uuid);
-    return RAND_UUID_OK;
-#else
-    // Fallback for all platforms is filling the array with random data
     OCFillRandomMem(uuid, UUID_SIZE);
+
+    // version 4 (random) and the variant of RFC4122
+    uuid[6] = (uuid[6] & 0x0F) | 0x40;
+    uuid[8] = (uuid[8] & 0x3F) | 0x80;
     return RAND_UUID_OK;
-#endif
 }
 
 OCRandomUuidResult OCGenerateUuidString(char uuidString[UUID_STRING_SIZE])
@@ -303,52 +528,11 @@ OCRandomUuidResult OCGenerateUuidString(char uuidString[UUID_STRING_SIZE])
     {
         return RAND_UUID_INVALID_PARAM;
     }
-#if defined(__ANDROID__)
-    int32_t fd = open("/proc/sys/kernel/random/uuid", O_RDONLY);
-    if (fd > 0)
-    {
-        ssize_t readResult = read(fd, uuidString, UUID_STRING_SIZE - 1);
-        close(fd);
-        if (readResult < 0)
-        {
-            return RAND_UUID_READ_ERROR;
-        }
-        else if (readResult < UUID_STRING_SIZE - 1)
-        {
-            uuidString[0] = '\0';
-            return RAND_UUID_READ_ERROR;
-        }
-
-        uuidString[UUID_STRING_SIZE - 1] = '\0';
-        for (char* p = uuidString; *p; ++p)
-        {
-            *p = tolower(*p);
-        }
-        return RAND_UUID_OK;
-    }
-    else
-    {
-        close(fd);
-        return RAND_UUID_READ_ERROR;
-    }
-#elif defined(HAVE_UUID_UUID_H)
-    uint8_t uuid[UUID_SIZE];
-    int8_t ret = OCGenerateUuid(uuid);
 
-    if (ret != 0)
-    {
-        return ret;
-    }
-
-    uuid_unparse_lower(uuid, uuidString);
-    return RAND_UUID_OK;
-
-#else
     uint8_t uuid[UUID_SIZE];
     OCGenerateUuid(uuid);
 
     return OCConvertUuidToString(uuid, uuidString);
-#endif
 }
 
 OCRandomUuidResult OCConvertUuidToString(const uint8_t uuid[UUID_SIZE],
@@ -360,18 +544,19 @@ OCRandomUuidResult OCConvertUuidToString(const uint8_t uuid[UUID_SIZE],
     }
 
 
-    int ret = snprintf(uuidString, UUID_STRING_SIZE,
-            "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
-            uuid[0], uuid[1], uuid[2], uuid[3],
-            uuid[4], uuid[5], uuid[6], uuid[7],
-            uuid[8], uuid[9], uuid[10], uuid[11],
-            uuid[12], uuid[13], uuid[14], uuid[15]
-            );
-
-    if (ret != UUID_STRING_SIZE - 1)
+    static const char hex[] = "0123456789abcdef";
+    char *p = uuidString;
+    for (size_t i = 0; i < UUID_SIZE; i++)
     {
-        return RAND_UUID_CONVERT_ERROR;
+        // "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+        if (4 == i || 6 == i || 8 == i || 10 == i)
+        {
+            *p++ = '-';
+        }
+        *p++ = hex[uuid[i] >> 4];
+        *p++ = hex[uuid[i] & 0x0F];
     }
+    *p = '\0';
 
     return RAND_UUID_OK;
 }
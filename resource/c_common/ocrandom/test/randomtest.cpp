@@ -26,6 +26,11 @@ extern "C" {
 
 #include "gtest/gtest.h"
 
+#include <string.h>
+
+#include <chrono>
+#include <iostream>
+
 #define ARR_SIZE (20)
 
 TEST(RandomGeneration,OCSeedRandom) {
@@ -90,3 +95,82 @@ TEST(RandomGeneration, OCGenerateUuidString)
                 << "UUID Character out of range: "<< uuidString[i];
     }
 }
+
+TEST(RandomGeneration, OCFillRandomMem_Differs)
+{
+    // Larger than the internal buffer so that it is refilled.
+    uint8_t first[1000] = {};
+    uint8_t second[1000] = {};
+
+    OCFillRandomMem(first, sizeof(first));
+    OCFillRandomMem(second, sizeof(second));
+
+    EXPECT_NE(0, memcmp(first, second, sizeof(first)));
+
+    int zeros = 0;
+    for (size_t i = 0; i < sizeof(first); ++i)
+    {
+        zeros += (0 == first[i]);
+    }
+    EXPECT_GT(32, zeros);
+}
+
+TEST(RandomGeneration, OCGenerateUuid_Version4)
+{
+    uint8_t first[UUID_SIZE] = {};
+    uint8_t second[UUID_SIZE] = {};
+
+    EXPECT_EQ(RAND_UUID_OK, OCGenerateUuid(first));
+    EXPECT_EQ(RAND_UUID_OK, OCGenerateUuid(second));
+    EXPECT_NE(0, memcmp(first, second, UUID_SIZE));
+
+    EXPECT_EQ(0x40, first[6] & 0xF0);
+    EXPECT_EQ(0x80, first[8] & 0xC0);
+}
+
+TEST(RandomGeneration, OCConvertUuidToString)
+{
+    const uint8_t uuid[UUID_SIZE] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+                                      0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10 };
+    char uuidString[UUID_STRING_SIZE] = {};
+
+    EXPECT_EQ(RAND_UUID_INVALID_PARAM, OCConvertUuidToString(NULL, uuidString));
+    EXPECT_EQ(RAND_UUID_OK, OCConvertUuidToString(uuid, uuidString));
+    EXPECT_STREQ("01234567-89ab-cdef-fedc-ba9876543210", uuidString);
+}
+
+// Measures filling tokens, bulk buffers and UUID strings.
+TEST(RandomGeneration, ThroughputBenchmark)
+{
+    const int tokens = 1000000;
+    const int buffers = 1000;
+    const int uuids = 100000;
+    uint8_t token[8];
+    static uint8_t buffer[UINT16_MAX];
+    char uuidString[UUID_STRING_SIZE];
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < tokens; ++i)
+    {
+        OCFillRandomMem(token, sizeof(token));
+    }
+    std::chrono::duration<double, std::nano> tokenTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < buffers; ++i)
+    {
+        OCFillRandomMem(buffer, sizeof(buffer));
+    }
+    std::chrono::duration<double> bufferTime = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < uuids; ++i)
+    {
+        EXPECT_EQ(RAND_UUID_OK, OCGenerateUuidString(uuidString));
+    }
+    std::chrono::duration<double, std::nano> uuidTime = std::chrono::steady_clock::now() - start;
+
+    std::cout << "8-byte token: " << tokenTime.count() / tokens << " ns, bulk fill: "
+              << buffers * sizeof(buffer) / bufferTime.count() / 1e6 << " MB/s, UUID string: "
+              << uuidTime.count() / uuids << " ns" << std::endl;
+}
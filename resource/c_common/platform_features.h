@@ -58,6 +58,18 @@
 #  endif
 #endif
 
+/* Storage class of a variable that each thread has its own copy of.
+ * Left undefined where it is not supported. */
+#if defined(ARDUINO)
+   /* No thread local storage. */
+#elif defined(_MSC_VER)
+#  define OC_THREAD_LOCAL __declspec(thread)
+#elif (__STDC_VERSION__ >= 201112L)
+#  define OC_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#  define OC_THREAD_LOCAL __thread
+#endif
+
 #ifdef _MSC_VER
 #  define OC_ANNOTATE_UNUSED
 #else
@@ -558,6 +558,7 @@ typedef struct
         WSAEVENT shutdownEvent;     /**< Event used to signal threads to stop */
 #else
         int shutdownFds[2];         /**< fds used to signal threads to stop */
+        int epollFd;                /**< epoll instance, -1 if select is used */
 #endif
         int selectTimeout;          /**< in seconds */
         int maxfd;                  /**< highest fd (for select) */
@@ -592,11 +593,12 @@ typedef struct
         void *threadpool;       /**< threadpool between Initialize and Start */
         CASocket_t ipv4;        /**< IPv4 accept socket */
         CASocket_t ipv6;        /**< IPv6 accept socket */
-        void *svrlist;          /**< unicast IPv4 TCP server information*/
+        void *svrlist;          /**< TCP sessions indexed by fd */
         int selectTimeout;      /**< in seconds */
         int listenBacklog;      /**< backlog counts*/
         int shutdownFds[2];     /**< shutdown pipe */
         int connectionFds[2];   /**< connection pipe */
+        int epollFd;            /**< epoll instance, -1 if select is used */
         int maxfd;              /**< highest fd (for select) */
         bool started;           /**< the TCP adapter has started */
         bool terminate;         /**< the TCP adapter needs to stop */
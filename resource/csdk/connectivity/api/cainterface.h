@@ -221,6 +221,21 @@ CAResult_t CAGetNetworkInformation(CAEndpoint_t **info, uint32_t *size);
  */
 CAResult_t CAHandleRequestResponse();
 
+/**
+ * Wait until there is received data for CAHandleRequestResponse() to handle.
+ * Returns early when CAWakeUpRequestResponse() is called. Returns immediately
+ * in the single thread model, which reads the data in CAHandleRequestResponse().
+ * @param[in]   timeoutMs   maximum time to wait in milliseconds.
+ * @return   ::CA_STATUS_OK or ::CA_STATUS_NOT_INITIALIZED
+ */
+CAResult_t CAWaitForRequestResponse(uint32_t timeoutMs);
+
+/**
+ * Make a pending or the next call of CAWaitForRequestResponse() return.
+ * @return   ::CA_STATUS_OK or ::CA_STATUS_NOT_INITIALIZED
+ */
+CAResult_t CAWakeUpRequestResponse();
+
 #ifdef RA_ADAPTER
 /**
  * Set Remote Access information for XMPP Client.
@@ -303,6 +303,28 @@ CAResult_t CAinitiateTlsHandshake(const CAEndpoint_t *endpoint);
  */
 CAResult_t CAcloseTlsConnection(const CAEndpoint_t *endpoint);
 
+/**
+ * Set the size and lifetime of the cache of TLS sessions that reconnecting peers
+ * may resume without a full handshake. May be called before or after CAInitialize,
+ * sessions already cached are dropped.
+ *
+ * @param[in] maxEntries  number of sessions kept, 0 disables resumption.
+ * @param[in] lifetime    seconds a session may be resumed after its full handshake.
+ *
+ * @retval  ::CA_STATUS_OK    Successful.
+ * @retval  ::CA_STATUS_FAILED Operation failed.
+ */
+CAResult_t CAsetTlsSessionCacheConfig(uint32_t maxEntries, uint32_t lifetime);
+
+/**
+ * Drop the TLS sessions cached for resumption. Must be called when credentials
+ * or the CRL change, since a resumed session skips checking the peer again.
+ *
+ * @retval  ::CA_STATUS_OK    Successful.
+ * @retval  ::CA_STATUS_FAILED Operation failed.
+ */
+CAResult_t CAclearTlsSessionCache();
+
 #endif /* __WITH_TLS__ */
 
 #ifdef __cplusplus
@@ -103,6 +103,15 @@ bool u_arraylist_add(u_arraylist_t *list, void *data);
  */
 void *u_arraylist_remove(u_arraylist_t *list, uint32_t index);
 
+/**
+ * Exchange the data of two indexes in the array list.
+ * @param[in] list       pointer of array list.
+ * @param[in] index1     index of array list.
+ * @param[in] index2     index of array list.
+ * @return true if success, false otherwise.
+ */
+bool u_arraylist_swap(u_arraylist_t *list, uint32_t index1, uint32_t index2);
+
 /**
  * Returns the length of the array list.
  * @param[in] list       pointer of array list.
@@ -0,0 +1,170 @@
+/* ****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the APIs for an open addressing hash map.
+ */
+
+#ifndef U_HASHMAP_H_
+#define U_HASHMAP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Seed to start a hash with (FNV-1a offset basis).
+ */
+#define U_HASHMAP_HASH_SEED 2166136261u
+
+/**
+ * Hash function for the keys of a hash map.
+ */
+typedef uint32_t (*u_hashmap_hash_t)(const void *key);
+
+/**
+ * Equality function for the keys of a hash map.
+ */
+typedef bool (*u_hashmap_equal_t)(const void *key1, const void *key2);
+
+/**
+ * hash map slot.
+ */
+typedef struct u_hashmap_entry_t
+{
+    uint32_t hash;
+    const void *key;    /**< NULL if the slot is empty. */
+    void *value;
+} u_hashmap_entry_t;
+
+/**
+ * hash map structure.
+ *
+ * Keys are stored by reference: a key must stay valid and unchanged while
+ * it is in the map. Usually it points into the stored value.
+ *
+ * @note
+ * Members should be treated as private and not accessed directly. Instead
+ * all access should be through the defined u_hashmap_*() functions.
+ */
+typedef struct u_hashmap_t
+{
+    u_hashmap_entry_t *entries;
+    uint32_t length;
+    uint32_t capacity;
+    u_hashmap_hash_t hash;
+    u_hashmap_equal_t equal;
+} u_hashmap_t;
+
+/**
+ * API to create a hash map.
+ * @param[in] hash       hash function for the keys.
+ * @param[in] equal      equality function for the keys.
+ * @return  u_hashmap_t if Success, NULL otherwise.
+ */
+u_hashmap_t *u_hashmap_create(u_hashmap_hash_t hash, u_hashmap_equal_t equal);
+
+/**
+ * Deletes the hash map. Keys and values are not freed.
+ * @param[in] map        pointer to the hash map pointer, set to NULL.
+ */
+void u_hashmap_free(u_hashmap_t **map);
+
+/**
+ * Add a value to the hash map, replacing the value of an equal key.
+ * Replacing a value does not allocate and always succeeds.
+ * @param[in] map        pointer of hash map.
+ * @param[in] key        pointer of key.
+ * @param[in] value      pointer of value.
+ * @return true if success, false otherwise.
+ */
+bool u_hashmap_put(u_hashmap_t *map, const void *key, void *value);
+
+/**
+ * Returns the value stored for the key.
+ * @param[in] map        pointer of hash map.
+ * @param[in] key        pointer of key.
+ * @return value if found, NULL otherwise.
+ */
+void *u_hashmap_get(const u_hashmap_t *map, const void *key);
+
+/**
+ * Remove the key from the hash map.
+ * @param[in] map        pointer of hash map.
+ * @param[in] key        pointer of key.
+ * @return the removed value if found, NULL otherwise.
+ */
+void *u_hashmap_remove(u_hashmap_t *map, const void *key);
+
+/**
+ * Returns the number of keys in the hash map.
+ * @param[in] map        pointer of hash map.
+ * @return number of keys.
+ */
+uint32_t u_hashmap_length(const u_hashmap_t *map);
+
+/**
+ * Iterate over the values of the hash map in no particular order.
+ * The map must not be modified while iterating.
+ * @param[in] map        pointer of hash map.
+ * @param[in,out] iter   iterator, must be 0 for the first call.
+ * @return next value, NULL when all values were returned.
+ */
+void *u_hashmap_next(const u_hashmap_t *map, uint32_t *iter);
+
+/**
+ * Continue a FNV-1a hash over the given bytes.
+ * @param[in] hash       ::U_HASHMAP_HASH_SEED or the result of a previous call.
+ * @param[in] data       bytes to hash.
+ * @param[in] size       number of bytes.
+ * @return hash value.
+ */
+uint32_t u_hashmap_hash_bytes(uint32_t hash, const void *data, size_t size);
+
+/**
+ * Hash and equality functions for NUL terminated string keys.
+ */
+uint32_t u_hashmap_hash_string(const void *key);
+bool u_hashmap_equal_string(const void *key1, const void *key2);
+
+/**
+ * Hash and equality functions for keys pointing to an int.
+ */
+uint32_t u_hashmap_hash_int(const void *key);
+bool u_hashmap_equal_int(const void *key1, const void *key2);
+
+/**
+ * Hash and equality functions for keys compared by their address.
+ */
+uint32_t u_hashmap_hash_pointer(const void *key);
+bool u_hashmap_equal_pointer(const void *key1, const void *key2);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* U_HASHMAP_H_ */
@@ -0,0 +1,122 @@
+/* ****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ *
+ * This file contains the APIs for a bounded lock-free queue with many
+ * producers and a single consumer.
+ */
+
+#ifndef U_RINGQUEUE_H_
+#define U_RINGQUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "uqueue.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Ring queue structure.
+ *
+ * Any thread may push. Only one thread at a time may pop, check for emptiness
+ * or wait; callers that pop from several threads serialize that themselves.
+ */
+typedef struct u_ringqueue_t u_ringqueue_t;
+
+/**
+ * Creates a ring queue.
+ * @param capacity  maximum number of messages, rounded up to a power of 2.
+ * @return  u_ringqueue_t pointer if Success, NULL if out of memory or if
+ *          the platform has no atomic operations for the queue.
+ */
+u_ringqueue_t *u_ringqueue_create(uint32_t capacity);
+
+/**
+ * Frees the ring queue. Messages still in the queue are not freed, pop them
+ * first.
+ * @param queue pointer to the queue pointer, which is set to NULL.
+ */
+void u_ringqueue_free(u_ringqueue_t **queue);
+
+/**
+ * Adds a message at the end of the queue. May be called from any thread.
+ * @param queue pointer to queue.
+ * @param msg   pointer to message.
+ * @param size  message size.
+ * @return true if added, false if the queue is full or closed.
+ */
+bool u_ringqueue_push(u_ringqueue_t *queue, void *msg, uint32_t size);
+
+/**
+ * Makes u_ringqueue_push() fail, or accept messages again. A caller that
+ * moves on to another queue once this one is full closes it, so that later
+ * messages do not overtake the ones in the other queue.
+ * @param queue   pointer to queue.
+ * @param closed  true to close, false to open.
+ */
+void u_ringqueue_set_closed(u_ringqueue_t *queue, bool closed);
+
+/**
+ * Removes up to count messages from the front of the queue. Consumer only.
+ * @param queue     pointer to queue.
+ * @param messages  array that receives the messages.
+ * @param count     number of entries in messages.
+ * @return number of messages removed.
+ */
+uint32_t u_ringqueue_pop(u_ringqueue_t *queue, u_queue_message_t *messages, uint32_t count);
+
+/**
+ * Consumer only.
+ * @param queue pointer to queue.
+ * @return true if no message is ready to pop.
+ */
+bool u_ringqueue_is_empty(u_ringqueue_t *queue);
+
+/**
+ * Announces that the consumer is going to sleep or has woken up.
+ *
+ * The consumer sets waiting, checks u_ringqueue_is_empty() and sleeps on a
+ * condition, then clears waiting. A producer that pushed a message and sees
+ * u_ringqueue_has_waiter() signals that condition under its mutex. Either
+ * the consumer sees the message or the producer sees the waiter.
+ *
+ * @param queue   pointer to queue.
+ * @param waiting true before sleeping, false after.
+ */
+void u_ringqueue_set_waiting(u_ringqueue_t *queue, bool waiting);
+
+/**
+ * Called by a producer after u_ringqueue_push().
+ * @param queue pointer to queue.
+ * @return true if the consumer may be sleeping and has to be signaled.
+ */
+bool u_ringqueue_has_waiter(u_ringqueue_t *queue);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* U_RINGQUEUE_H_ */
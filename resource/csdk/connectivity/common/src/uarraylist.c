@@ -181,6 +181,20 @@ void *u_arraylist_remove(u_arraylist_t *list, uint32_t index)
     return removed;
 }
 
+bool u_arraylist_swap(u_arraylist_t *list, uint32_t index1, uint32_t index2)
+{
+    if (!list || (index1 >= list->length) || (index2 >= list->length))
+    {
+        return false;
+    }
+
+    void *tmp = list->data[index1];
+    list->data[index1] = list->data[index2];
+    list->data[index2] = tmp;
+
+    return true;
+}
+
 uint32_t u_arraylist_length(const u_arraylist_t *list)
 {
     if (!list)
@@ -0,0 +1,286 @@
+/* ****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "uhashmap.h"
+#include "logger.h"
+#include "oic_malloc.h"
+
+#define TAG "UHASHMAP"
+
+/**
+ * Use this default capacity when initialized. Must be a power of two.
+ */
+#define U_HASHMAP_DEFAULT_CAPACITY 8
+
+#define FNV_PRIME 16777619u
+
+/**
+ * Linear probing with backward shift deletion, so there are no tombstones
+ * and a lookup stops at the first empty slot. The load factor is kept at
+ * or below 3/4.
+ */
+static uint32_t u_hashmap_find(const u_hashmap_t *map, const void *key, uint32_t hash)
+{
+    uint32_t mask = map->capacity - 1;
+    uint32_t i = hash & mask;
+
+    while (map->entries[i].key)
+    {
+        if (map->entries[i].hash == hash && map->equal(map->entries[i].key, key))
+        {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static bool u_hashmap_resize(u_hashmap_t *map, uint32_t capacity)
+{
+    u_hashmap_entry_t *entries =
+            (u_hashmap_entry_t *) OICCalloc(capacity, sizeof(u_hashmap_entry_t));
+    if (!entries)
+    {
+        OIC_LOG(DEBUG, TAG, "Out of memory");
+        return false;
+    }
+
+    u_hashmap_entry_t *old = map->entries;
+    uint32_t oldCapacity = map->capacity;
+
+    map->entries = entries;
+    map->capacity = capacity;
+
+    for (uint32_t i = 0; i < oldCapacity; i++)
+    {
+        if (old[i].key)
+        {
+            map->entries[u_hashmap_find(map, old[i].key, old[i].hash)] = old[i];
+        }
+    }
+
+    OICFree(old);
+    return true;
+}
+
+u_hashmap_t *u_hashmap_create(u_hashmap_hash_t hash, u_hashmap_equal_t equal)
+{
+    if (!hash || !equal)
+    {
+        OIC_LOG(DEBUG, TAG, "Invalid Parameter");
+        return NULL;
+    }
+
+    u_hashmap_t *map = (u_hashmap_t *) OICCalloc(1, sizeof(u_hashmap_t));
+    if (!map)
+    {
+        OIC_LOG(DEBUG, TAG, "Out of memory");
+        return NULL;
+    }
+
+    map->entries = (u_hashmap_entry_t *) OICCalloc(U_HASHMAP_DEFAULT_CAPACITY,
+                                                   sizeof(u_hashmap_entry_t));
+    if (!map->entries)
+    {
+        OIC_LOG(DEBUG, TAG, "Out of memory");
+        OICFree(map);
+        return NULL;
+    }
+
+    map->capacity = U_HASHMAP_DEFAULT_CAPACITY;
+    map->hash = hash;
+    map->equal = equal;
+    return map;
+}
+
+void u_hashmap_free(u_hashmap_t **map)
+{
+    if (!map || !(*map))
+    {
+        return;
+    }
+
+    OICFree((*map)->entries);
+    OICFree(*map);
+
+    *map = NULL;
+}
+
+bool u_hashmap_put(u_hashmap_t *map, const void *key, void *value)
+{
+    if (!map || !key)
+    {
+        return false;
+    }
+
+    uint32_t hash = map->hash(key);
+    uint32_t i = u_hashmap_find(map, key, hash);
+    if (!map->entries[i].key)
+    {
+        if ((map->length + 1) * 4 > map->capacity * 3)
+        {
+            if (!u_hashmap_resize(map, map->capacity * 2))
+            {
+                return false;
+            }
+            i = u_hashmap_find(map, key, hash);
+        }
+        map->length++;
+    }
+
+    map->entries[i].hash = hash;
+    map->entries[i].key = key;
+    map->entries[i].value = value;
+    return true;
+}
+
+void *u_hashmap_get(const u_hashmap_t *map, const void *key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    uint32_t i = u_hashmap_find(map, key, map->hash(key));
+    return map->entries[i].key ? map->entries[i].value : NULL;
+}
+
+void *u_hashmap_remove(u_hashmap_t *map, const void *key)
+{
+    if (!map || !key)
+    {
+        return NULL;
+    }
+
+    uint32_t mask = map->capacity - 1;
+    uint32_t i = u_hashmap_find(map, key, map->hash(key));
+    if (!map->entries[i].key)
+    {
+        return NULL;
+    }
+
+    void *removed = map->entries[i].value;
+
+    // Shift back following entries that would become unreachable.
+    uint32_t j = i;
+    for (;;)
+    {
+        j = (j + 1) & mask;
+        if (!map->entries[j].key)
+        {
+            break;
+        }
+        uint32_t home = map->entries[j].hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            map->entries[i] = map->entries[j];
+            i = j;
+        }
+    }
+
+    map->entries[i].key = NULL;
+    map->entries[i].value = NULL;
+    map->length--;
+
+    return removed;
+}
+
+uint32_t u_hashmap_length(const u_hashmap_t *map)
+{
+    if (!map)
+    {
+        OIC_LOG(DEBUG, TAG, "Invalid Parameter");
+        return 0;
+    }
+    return map->length;
+}
+
+void *u_hashmap_next(const u_hashmap_t *map, uint32_t *iter)
+{
+    if (!map || !iter)
+    {
+        return NULL;
+    }
+
+    while (*iter < map->capacity)
+    {
+        u_hashmap_entry_t *entry = &map->entries[(*iter)++];
+        if (entry->key)
+        {
+            return entry->value;
+        }
+    }
+    return NULL;
+}
+
+uint32_t u_hashmap_hash_bytes(uint32_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint32_t u_hashmap_hash_string(const void *key)
+{
+    return u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, key, strlen((const char *) key));
+}
+
+bool u_hashmap_equal_string(const void *key1, const void *key2)
+{
+    return 0 == strcmp((const char *) key1, (const char *) key2);
+}
+
+static uint32_t u_hashmap_mix(uint32_t hash)
+{
+    // murmur3 finalizer, spreads small consecutive values such as fds
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+uint32_t u_hashmap_hash_int(const void *key)
+{
+    return u_hashmap_mix((uint32_t) *(const int *) key);
+}
+
+bool u_hashmap_equal_int(const void *key1, const void *key2)
+{
+    return *(const int *) key1 == *(const int *) key2;
+}
+
+uint32_t u_hashmap_hash_pointer(const void *key)
+{
+    uint64_t address = (uint64_t) (uintptr_t) key;
+    return u_hashmap_mix((uint32_t) (address ^ (address >> 32)));
+}
+
+bool u_hashmap_equal_pointer(const void *key1, const void *key2)
+{
+    return key1 == key2;
+}
@@ -0,0 +1,309 @@
+/* ****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "uringqueue.h"
+#include "logger.h"
+#include "oic_malloc.h"
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+#define TAG "URINGQUEUE"
+
+/**
+ * Keeps the producer and consumer positions on separate cache lines.
+ */
+#define U_RINGQUEUE_CACHE_LINE 64
+
+/**
+ * Largest capacity, so that position differences fit into an int32_t.
+ */
+#define U_RINGQUEUE_MAX_CAPACITY (1u << 30)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define U_RINGQUEUE_ATOMICS
+#define ATOMIC_LOAD_ACQUIRE(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_LOAD_RELAXED(p)      __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ATOMIC_STORE_RELEASE(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_STORE_RELAXED(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_CAS(p, expected, desired) \
+    __atomic_compare_exchange_n((p), (expected), (desired), true, \
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define ATOMIC_FULL_FENCE()         __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#elif defined(_MSC_VER)
+#define U_RINGQUEUE_ATOMICS
+// Interlocked operations are full barriers, which is stronger than needed.
+#define ATOMIC_LOAD_ACQUIRE(p)      ((uint32_t) InterlockedOr((volatile LONG *)(p), 0))
+#define ATOMIC_LOAD_RELAXED(p)      (*(volatile uint32_t *)(p))
+#define ATOMIC_STORE_RELEASE(p, v)  InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#define ATOMIC_STORE_RELAXED(p, v)  InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+static bool u_ringqueue_cas(uint32_t *p, uint32_t *expected, uint32_t desired)
+{
+    uint32_t old = (uint32_t) InterlockedCompareExchange((volatile LONG *) p,
+                                                         (LONG) desired, (LONG) *expected);
+    if (old == *expected)
+    {
+        return true;
+    }
+    *expected = old;
+    return false;
+}
+#define ATOMIC_CAS(p, expected, desired) u_ringqueue_cas((p), (expected), (desired))
+#define ATOMIC_FULL_FENCE()         MemoryBarrier()
+#endif
+
+/**
+ * A slot of the ring. Its sequence tells who may use it next: it equals the
+ * position of a producer that may fill it, or that position plus one once it
+ * holds a message for the consumer.
+ */
+typedef struct
+{
+    uint32_t sequence;
+    u_queue_message_t message;
+} u_ringqueue_cell_t;
+
+struct u_ringqueue_t
+{
+    u_ringqueue_cell_t *cells;
+    uint32_t mask;
+    char pad0[U_RINGQUEUE_CACHE_LINE];
+    /** next position to fill, shared by the producers. */
+    uint32_t enqueuePos;
+    char pad1[U_RINGQUEUE_CACHE_LINE];
+    /** next position to empty, owned by the consumer. */
+    uint32_t dequeuePos;
+    /** set while the consumer sleeps. */
+    uint32_t waiting;
+    /** set while pushing is refused. */
+    uint32_t closed;
+};
+
+u_ringqueue_t *u_ringqueue_create(uint32_t capacity)
+{
+#ifdef U_RINGQUEUE_ATOMICS
+    if (0 == capacity || U_RINGQUEUE_MAX_CAPACITY < capacity)
+    {
+        OIC_LOG(ERROR, TAG, "invalid capacity");
+        return NULL;
+    }
+
+    uint32_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    u_ringqueue_t *queue = (u_ringqueue_t *) OICCalloc(1, sizeof(u_ringqueue_t));
+    if (!queue)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        return NULL;
+    }
+
+    queue->cells = (u_ringqueue_cell_t *) OICCalloc(size, sizeof(u_ringqueue_cell_t));
+    if (!queue->cells)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        OICFree(queue);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        queue->cells[i].sequence = i;
+    }
+    queue->mask = size - 1;
+
+    return queue;
+#else
+    (void) capacity;
+    OIC_LOG(INFO, TAG, "no atomic operations on this platform");
+    return NULL;
+#endif
+}
+
+void u_ringqueue_free(u_ringqueue_t **queue)
+{
+    if (!queue || !*queue)
+    {
+        return;
+    }
+
+    OICFree((*queue)->cells);
+    OICFree(*queue);
+    *queue = NULL;
+}
+
+#ifdef U_RINGQUEUE_ATOMICS
+bool u_ringqueue_push(u_ringqueue_t *queue, void *msg, uint32_t size)
+{
+    if (!queue)
+    {
+        return false;
+    }
+
+    if (ATOMIC_LOAD_ACQUIRE(&queue->closed))
+    {
+        return false;
+    }
+
+    u_ringqueue_cell_t *cell;
+    uint32_t pos = ATOMIC_LOAD_RELAXED(&queue->enqueuePos);
+    for (;;)
+    {
+        cell = &queue->cells[pos & queue->mask];
+        int32_t diff = (int32_t)(ATOMIC_LOAD_ACQUIRE(&cell->sequence) - pos);
+        if (0 == diff)
+        {
+            // Claim the slot; on failure pos holds the current position.
+            if (ATOMIC_CAS(&queue->enqueuePos, &pos, pos + 1))
+            {
+                break;
+            }
+        }
+        else if (0 > diff)
+        {
+            // The consumer has not emptied this slot one round ago.
+            return false;
+        }
+        else
+        {
+            pos = ATOMIC_LOAD_RELAXED(&queue->enqueuePos);
+        }
+    }
+
+    cell->message.msg = msg;
+    cell->message.size = size;
+    ATOMIC_STORE_RELEASE(&cell->sequence, pos + 1);
+    return true;
+}
+
+void u_ringqueue_set_closed(u_ringqueue_t *queue, bool closed)
+{
+    if (!queue)
+    {
+        return;
+    }
+
+    ATOMIC_STORE_RELEASE(&queue->closed, closed ? 1 : 0);
+}
+
+uint32_t u_ringqueue_pop(u_ringqueue_t *queue, u_queue_message_t *messages, uint32_t count)
+{
+    if (!queue || !messages)
+    {
+        return 0;
+    }
+
+    uint32_t pos = queue->dequeuePos;
+    uint32_t popped = 0;
+    while (popped < count)
+    {
+        u_ringqueue_cell_t *cell = &queue->cells[pos & queue->mask];
+        if (ATOMIC_LOAD_ACQUIRE(&cell->sequence) != pos + 1)
+        {
+            break;
+        }
+        messages[popped++] = cell->message;
+        // Hand the slot to the producer of the next round.
+        ATOMIC_STORE_RELEASE(&cell->sequence, pos + queue->mask + 1);
+        pos++;
+    }
+    queue->dequeuePos = pos;
+    return popped;
+}
+
+bool u_ringqueue_is_empty(u_ringqueue_t *queue)
+{
+    if (!queue)
+    {
+        return true;
+    }
+
+    uint32_t pos = queue->dequeuePos;
+    return ATOMIC_LOAD_ACQUIRE(&queue->cells[pos & queue->mask].sequence) != pos + 1;
+}
+
+void u_ringqueue_set_waiting(u_ringqueue_t *queue, bool waiting)
+{
+    if (!queue)
+    {
+        return;
+    }
+
+    ATOMIC_STORE_RELAXED(&queue->waiting, waiting ? 1 : 0);
+    // Orders the flag before the consumer's emptiness check.
+    ATOMIC_FULL_FENCE();
+}
+
+bool u_ringqueue_has_waiter(u_ringqueue_t *queue)
+{
+    if (!queue)
+    {
+        return false;
+    }
+
+    // Orders the pushed message before reading the flag.
+    ATOMIC_FULL_FENCE();
+    return 0 != ATOMIC_LOAD_RELAXED(&queue->waiting);
+}
+#else
+bool u_ringqueue_push(u_ringqueue_t *queue, void *msg, uint32_t size)
+{
+    (void) queue;
+    (void) msg;
+    (void) size;
+    return false;
+}
+
+void u_ringqueue_set_closed(u_ringqueue_t *queue, bool closed)
+{
+    (void) queue;
+    (void) closed;
+}
+
+uint32_t u_ringqueue_pop(u_ringqueue_t *queue, u_queue_message_t *messages, uint32_t count)
+{
+    (void) queue;
+    (void) messages;
+    (void) count;
+    return 0;
+}
+
+bool u_ringqueue_is_empty(u_ringqueue_t *queue)
+{
+    (void) queue;
+    return true;
+}
+
+void u_ringqueue_set_waiting(u_ringqueue_t *queue, bool waiting)
+{
+    (void) queue;
+    (void) waiting;
+}
+
+bool u_ringqueue_has_waiter(u_ringqueue_t *queue)
+{
+    (void) queue;
+    return false;
+}
+#endif // U_RINGQUEUE_ATOMICS
@@ -46,6 +46,25 @@ typedef void (*CAPacketSendCallback)(CAEndpoint_t *endpoint,
  */
 CAResult_t CAsetTlsCipherSuite(const uint32_t cipher);
 
+/**
+ * Sets the size and lifetime of the cache of sessions that reconnecting peers
+ * may resume without a full handshake. Cached sessions are dropped.
+ *
+ * @param[in] maxEntries  number of sessions kept, 0 disables resumption
+ * @param[in] lifetime    seconds a session may be resumed after its full handshake
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CAsetTlsSessionCacheConfig(uint32_t maxEntries, uint32_t lifetime);
+
+/**
+ * Drops the sessions cached for resumption, so reconnecting peers have to
+ * present their credentials again.
+ *
+ * @retval  ::CA_STATUS_OK for success, otherwise some error value
+ */
+CAResult_t CAclearTlsSessionCache();
+
 /**
  * Used set send and recv callbacks for different adapters(WIFI,EtherNet).
  *
@@ -52,8 +52,8 @@ typedef struct CAAdapterCallbacks
  */
 typedef struct stCADtlsContext
 {
-    u_arraylist_t *peerInfoList;         /**< peerInfo list which holds the mapping between
-                                              peer id to it's n/w address. */
+    u_hashmap_t *peerInfoMap;            /**< peerInfo map which holds the mapping between
+                                              peer id to it's n/w address, keyed by address. */
     u_arraylist_t *cacheList;            /**< PDU's are cached until DTLS session is formed. */
     struct dtls_context_t *dtlsContext;  /**< Pointer to tinyDTLS context. */
     struct stPacketInfo *packetInfo;     /**< used by callback during
@@ -50,6 +50,7 @@
 #include "logger.h"
 #include <coap/pdu.h>
 #include "uarraylist.h"
+#include "uhashmap.h"
 #include "cacommonutil.h"
 
 #ifdef __cplusplus
@@ -199,6 +200,22 @@ void CAClearNetInterfaceInfoList(u_arraylist_t *infoList);
  */
 void CAClearServerInfoList(u_arraylist_t *serverInfoList);
 
+/**
+ * Hash function for u_hashmap_t keys pointing to a ::CAEndpoint_t.
+ * Only the address and the port are hashed.
+ * @param[in]   key         endpoint.
+ * @return hash value.
+ */
+uint32_t CAHashEndpointAddress(const void *key);
+
+/**
+ * Equality function for u_hashmap_t keys pointing to a ::CAEndpoint_t.
+ * @param[in]   key1        endpoint.
+ * @param[in]   key2        endpoint.
+ * @return true if both endpoints have the same address and port.
+ */
+bool CAEqualEndpointAddress(const void *key1, const void *key2);
+
 #ifndef WITH_ARDUINO
 /**
  * Convert address from binary to string.
@@ -32,6 +32,7 @@
 #include "cathreadpool.h"
 #include "octhread.h"
 #include "uarraylist.h"
+#include "uhashmap.h"
 #include "cacommon.h"
 #include "caprotocolmessage.h"
 #include "camessagehandler.h"
@@ -67,6 +68,9 @@ typedef struct
     /** array list on which the thread is operating. **/
     u_arraylist_t *dataList;
 
+    /** block data of dataList by ::CABlockDataID_t. **/
+    u_hashmap_t *dataMap;
+
     /** data list mutex for synchronization. **/
     oc_mutex blockDataListMutex;
 
@@ -94,6 +98,7 @@ typedef struct
     CABlockDataID_t* blockDataId;        /**< ID set of CABlockData. */
     CAData_t *sentData;                 /**< sent request or response data information. */
     CAPayload_t payload;                /**< payload buffer. */
+    size_t payloadCapacity;             /**< allocated size of the payload buffer. */
     size_t payloadLength;               /**< the total payload length to be received. */
     size_t receivedPayloadLen;          /**< currently received payload length. */
 } CABlockData_t;
@@ -302,7 +307,7 @@ CAResult_t CASetMoreBitFromBlock(size_t payloadLen, coap_block_t *block);
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
-                            const CAEndpoint_t *endpoint, coap_list_t **options);
+                            const CAEndpoint_t *endpoint, CAPDUOptions_t *options);
 
 /**
  * Write the block option2 in pdu binary data.
@@ -313,7 +318,7 @@ CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t dataLength,
-                             const CABlockDataID_t *blockID, coap_list_t **options);
+                             const CABlockDataID_t *blockID, CAPDUOptions_t *options);
 
 /**
  * Write the block option1 in pdu binary data.
@@ -324,7 +329,7 @@ CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t dataLength,
-                             const CABlockDataID_t *blockID, coap_list_t **options);
+                             const CABlockDataID_t *blockID, CAPDUOptions_t *options);
 
 /**
  * Add the block option in option list.
@@ -334,15 +339,15 @@ CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t data
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockOptionImpl(coap_block_t *block, uint8_t blockType,
-                                coap_list_t **options);
+                                CAPDUOptions_t *options);
 
 /**
  * Add the option list in pdu data.
  * @param[out]  pdu    pdu object.
- * @param[out]  options   option list.
+ * @param[in]   options   option list.
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
-CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, coap_list_t **options);
+CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, const CAPDUOptions_t *options);
 
 /**
  * Add the size option in pdu data.
@@ -352,7 +357,7 @@ CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, coap_list_t **options);
  * @return ::CASTATUS_OK or ERROR CODES (::CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAAddBlockSizeOption(coap_pdu_t *pdu, uint16_t sizeType, size_t dataLength,
-                                coap_list_t **options);
+                                CAPDUOptions_t *options);
 
 /**
  * Get the size option from pdu data.
@@ -535,6 +540,16 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID,
 CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
                                           size_t *fullPayloadLen);
 
+/**
+ * Take the full payload out of block-wise list without copying it.
+ * The block data keeps an empty payload buffer afterwards.
+ * @param[in]   blockID     ID set of CABlockData.
+ * @param[out]  fullPayloadLen  received full payload length.
+ * @return payload, the caller has to free it with OICFree().
+ */
+CAPayload_t CATakePayloadFromBlockDataList(const CABlockDataID_t *blockID,
+                                           size_t *fullPayloadLen);
+
 /**
  * Create the block data from given data and add the data in block-wise transfer list.
  * @param[in]   sendData    data to be added to a list.
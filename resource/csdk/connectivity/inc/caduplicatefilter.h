@@ -0,0 +1,138 @@
+/* *****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ * This file contains the message deduplication of RFC 7252 section 4.5.
+ *
+ * Received requests are remembered by endpoint, message ID and token for
+ * ::CA_EXCHANGE_LIFETIME_SEC. The acknowledgement or reset sent for a
+ * request is stored with it, so that a duplicate can be answered with the
+ * same message instead of being delivered again. The token keeps apart the
+ * requests of a sender that reuses a message ID within the lifetime.
+ * An empty acknowledgement, sent ahead of a separate response, carries no
+ * token and is stored with the request of the same message ID.
+ */
+
+#ifndef CA_DUPLICATE_FILTER_H_
+#define CA_DUPLICATE_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "octhread.h"
+#include "uhashmap.h"
+#include "cacommon.h"
+#include "caretransmission.h"
+
+/** MAX_LATENCY is 100 sec(CoAP). **/
+#define CA_MAX_LATENCY_SEC          100
+
+/**
+ * EXCHANGE_LIFETIME of CoAP: MAX_TRANSMIT_SPAN + 2 * MAX_LATENCY + PROCESSING_DELAY,
+ * with ACK_RANDOM_FACTOR 1.5 and PROCESSING_DELAY set to the ACK timeout.
+ */
+#define CA_EXCHANGE_LIFETIME_SEC \
+    ((DEFAULT_ACK_TIMEOUT_SEC * ((1 << DEFAULT_RETRANSMISSION_COUNT) - 1) * 3) / 2 + \
+     2 * CA_MAX_LATENCY_SEC + DEFAULT_ACK_TIMEOUT_SEC)
+
+/** number of requests remembered at most, the oldest one is dropped first. **/
+#define CA_DUPLICATE_FILTER_SIZE    256
+
+typedef struct CADuplicateEntry_t CADuplicateEntry_t;
+
+typedef struct
+{
+    /** mutex for synchronization. **/
+    oc_mutex mutex;
+
+    /** remembered requests by endpoint, message id and token. **/
+    u_hashmap_t *map;
+
+    /** remembered requests in the order they were received. **/
+    CADuplicateEntry_t *oldest;
+    CADuplicateEntry_t *newest;
+    uint32_t count;
+} CADuplicateFilter_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Initializes the duplicate filter.
+ * @param[in]   filter          duplicate filter.
+ * @return  ::CA_STATUS_OK or an appropriate error code.
+ */
+CAResult_t CADuplicateFilterInitialize(CADuplicateFilter_t *filter);
+
+/**
+ * Records a received request and tells whether it was received before.
+ * @param[in]   filter          duplicate filter.
+ * @param[in]   endpoint        endpoint the request was received from.
+ * @param[in]   messageId       message id of the request.
+ * @param[in]   token           token of the request.
+ * @param[in]   tokenLength     length of the token.
+ * @param[out]  response        copy of the message that answered the first copy
+ *                              of a duplicate, NULL if it was not answered yet.
+ *                              The caller has to free it with OICFree().
+ * @param[out]  size            size of the response.
+ * @return  true if the request is a duplicate and must not be delivered.
+ */
+bool CADuplicateFilterReceivedRequest(CADuplicateFilter_t *filter,
+                                      const CAEndpoint_t *endpoint,
+                                      uint16_t messageId,
+                                      const CAToken_t token,
+                                      uint8_t tokenLength,
+                                      void **response,
+                                      uint32_t *size);
+
+/**
+ * Stores the acknowledgement or reset sent for a received request.
+ * It is ignored if the request is not remembered. Without a token, it is
+ * stored with the newest request of the endpoint and message id.
+ * @param[in]   filter          duplicate filter.
+ * @param[in]   endpoint        endpoint of the request.
+ * @param[in]   messageId       message id of the request and the response.
+ * @param[in]   token           token of the request and the response.
+ * @param[in]   tokenLength     length of the token.
+ * @param[in]   pdu             coap PDU of the response.
+ * @param[in]   size            size of the coap PDU.
+ */
+void CADuplicateFilterSentResponse(CADuplicateFilter_t *filter,
+                                   const CAEndpoint_t *endpoint,
+                                   uint16_t messageId,
+                                   const CAToken_t token,
+                                   uint8_t tokenLength,
+                                   const void *pdu,
+                                   uint32_t size);
+
+/**
+ * Drops all remembered requests and frees the filter.
+ * @param[in]   filter          duplicate filter.
+ */
+void CADuplicateFilterDestroy(CADuplicateFilter_t *filter);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  /* CA_DUPLICATE_FILTER_H_ */
@@ -90,6 +90,18 @@ void CATerminateMessageHandler();
  */
 void CAHandleRequestResponseCallbacks();
 
+/**
+ * Block until received data is waiting for CAHandleRequestResponseCallbacks(),
+ * CAWakeUpRequestResponseCallbacks() is called, or the timeout expires.
+ * @param[in]   timeoutMs   maximum time to wait in milliseconds.
+ */
+void CAWaitRequestResponseCallbacks(uint32_t timeoutMs);
+
+/**
+ * Make a pending or the next call of CAWaitRequestResponseCallbacks() return.
+ */
+void CAWakeUpRequestResponseCallbacks();
+
 /**
  * Setting the Callback funtion for network state change callback.
  * @param[in] nwMonitorHandler    callback for network state change.
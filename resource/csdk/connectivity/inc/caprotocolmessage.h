@@ -38,6 +38,43 @@ extern "C"
 
 typedef uint32_t code_t;
 
+/** maximum size of a variable length encoded option value. **/
+#define CA_ENCODE_BUFFER_SIZE (4)
+
+/** maximum number of options of a generated pdu. **/
+#ifdef ARDUINO
+#define CA_MAX_PDU_OPTIONS (16)
+#else
+#define CA_MAX_PDU_OPTIONS (64)
+#endif
+
+/**
+ * Option of a pdu to generate.
+ */
+typedef struct
+{
+    uint16_t key;                   /**< option number */
+    uint16_t length;                /**< length of the option value */
+    const uint8_t *data;            /**< option value */
+} CAPDUOption_t;
+
+/**
+ * Options of a pdu to generate, sorted by option number.
+ * Options with the same number keep the order they were added in.
+ * It has a fixed capacity so that it can live on the stack of the caller.
+ * Variable length encoded values and the values split from the URI are
+ * stored in the set, the other values refer to the data of the caller.
+ */
+typedef struct
+{
+    uint8_t count;                                          /**< number of options */
+    uint8_t encodedCount;                                   /**< number of encoded values */
+    uint16_t uriLength;                                     /**< used size of uri */
+    CAPDUOption_t options[CA_MAX_PDU_OPTIONS];              /**< sorted options */
+    uint8_t encoded[CA_MAX_PDU_OPTIONS][CA_ENCODE_BUFFER_SIZE]; /**< encoded values */
+    unsigned char uri[2 * CA_MAX_URI_LENGTH];               /**< Uri-Path, then Uri-Query values */
+} CAPDUOptions_t;
+
 #define CA_RESPONSE_CLASS(C) (((C) >> 5)*100)
 #define CA_RESPONSE_CODE(C) (CA_RESPONSE_CLASS(C) + (C - COAP_RESPONSE_CODE(CA_RESPONSE_CLASS(C))))
 
@@ -57,10 +94,12 @@ static const uint8_t PAYLOAD_MARKER = 1;
  * @param[in]   code                 code of the pdu packet.
  * @param[in]   info                 pdu information.
  * @param[in]   endpoint             endpoint information.
+ * @param[out]  options              options of the pdu. they refer to the data of info.
+ * @param[out]  transport            transport type of the pdu.
  * @return  generated pdu.
  */
 coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
-                          coap_list_t **optlist, coap_transport_t *transport);
+                          CAPDUOptions_t *options, coap_transport_t *transport);
 
 /**
  * extracts request information from received pdu.
@@ -97,11 +136,12 @@ CAResult_t CAGetErrorInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endp
  * @param[in]   code                 request or response code.
  * @param[in]   info                 information to create pdu.
  * @param[in]   endpoint             endpoint information.
- * @param[out]  options              options for the request and response.
+ * @param[in]   options              options for the request and response, in order.
+ * @param[out]  transport            transport type of the pdu.
  * @return  generated pdu.
  */
 coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
-                              const CAEndpoint_t *endpoint, coap_list_t *options,
+                              const CAEndpoint_t *endpoint, const CAPDUOptions_t *options,
                               coap_transport_t *transport);
 
 /**
@@ -110,48 +150,49 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
  * @param[out]   options             options information.
  * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
  */
-CAResult_t CAParseURI(const char *uriInfo, coap_list_t **options);
+CAResult_t CAParseURI(const char *uriInfo, CAPDUOptions_t *options);
 
 /**
  * Helper that uses libcoap to parse either the path or the parameters of a URI
- * and populate the supplied options list.
+ * and populate the supplied options.
  *
  * @param[in]   str                  the input partial URI string (either path or query).
  * @param[in]   length               the length of the supplied partial URI.
  * @param[in]   target               the part of the URI to parse (either COAP_OPTION_URI_PATH.
  *                                   or COAP_OPTION_URI_QUERY).
- * @param[out]  optlist              options information.
+ * @param[out]  options              options information.
  * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
  */
 CAResult_t CAParseUriPartial(const unsigned char *str, size_t length, int target,
-                             coap_list_t **optlist);
+                             CAPDUOptions_t *options);
 
 /**
- * create option list from header information in the info.
+ * create options from header information in the info.
  * @param[in]   code                 uri information.
  * @param[in]   info                 information of the request/response.
- * @param[out]  optlist              options information.
+ * @param[out]  options              options information.
  * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
  */
-CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **optlist);
+CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, CAPDUOptions_t *options);
 
 /**
- * creates option node from key length and data.
- * @param[in]   key                  key for the that needs to be sent.
- * @param[in]   length               length of the data that needs to be sent.
- * @param[in]   data                 data that needs to be sent.
- * @return  created list.
+ * empties the options.
+ * @param[out]  options              options to initialize.
  */
-coap_list_t *CACreateNewOptionNode(uint16_t key, uint32_t length, const char *data);
+void CAInitPDUOptions(CAPDUOptions_t *options);
 
 /**
- * order the inserted options.
- * need to replace queue head if new node has to be added before the existing queue head.
- * @param[in]   a                    option 1 for insertion.
- * @param[in]   b                    option 2 for insertion.
- * @return  0 or 1.
+ * adds an option in order of the option number.
+ * variable length encoded values are shrunk and stored in the options,
+ * other values have to stay valid until the pdu is generated.
+ * @param[in,out]   options          options to add to.
+ * @param[in]       key              option number.
+ * @param[in]       length           length of the data.
+ * @param[in]       data             value of the option.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
  */
-int CAOrderOpts(void *a, void *b);
+CAResult_t CAAddPDUOption(CAPDUOptions_t *options, uint16_t key, uint32_t length,
+                          const uint8_t *data);
 
 /**
  * number of options count.
@@ -235,6 +276,13 @@ CAMessageType_t CAGetMessageTypeFromPduBinaryData(const void *pdu, uint32_t size
  */
 uint16_t CAGetMessageIdFromPduBinaryData(const void *pdu, uint32_t size);
 
+/**
+ * Seeds the message IDs given to generated PDUs with a random value.
+ * Later PDUs get the following IDs in sequence, so that message IDs do not
+ * repeat within the deduplication window (RFC 7252, section 4.4).
+ */
+void CAInitializeMessageId();
+
 /**
  * gets code PDU binary data.
  * @param[in]   pdu                 pdu data.
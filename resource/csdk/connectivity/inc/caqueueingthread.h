@@ -32,6 +32,7 @@
 #include "cathreadpool.h"
 #include "octhread.h"
 #include "uqueue.h"
+#include "uringqueue.h"
 #include "cacommon.h"
 #ifdef __cplusplus
 extern "C"
@@ -60,6 +61,11 @@ typedef struct
     bool isStop;
     /** Que on which the thread is operating. **/
     u_queue_t *dataQueue;
+    /** Lock-free queue data is added to first, NULL to use dataQueue only.
+        dataQueue then takes the data that does not fit. **/
+    u_ringqueue_t *dataRing;
+    /** Set by CAQueueingThreadWakeUp. **/
+    bool wakeUp;
 } CAQueueingThread_t;
 
 /**
@@ -73,6 +79,23 @@ typedef struct
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy);
 
+/**
+ * Initializes the queuing thread with a lock-free queue, so adding data does not
+ * take a lock unless the consumer sleeps. Falls back to a plain queue where the
+ * platform has no atomic operations.
+ * @param[in]   thread       thread data for each thread.
+ * @param[in]   handle       thread pool handle created.
+ * @param[in]   task         function to be called for each data.
+ * @param[in]   destroy      function to data destroy.
+ * @param[in]   ringSize     number of data the lock-free queue holds.
+ * @return  CA_STATUS_OK or ERROR CODES (CAResult_t error codes in cacommon.h).
+ */
+CAResult_t CAQueueingThreadInitializeLockFree(CAQueueingThread_t *thread,
+                                              ca_thread_pool_t handle,
+                                              CAThreadTask task,
+                                              CADataDestroyFunction destroy,
+                                              uint32_t ringSize);
+
 /**
  * Start the queuing thread.
  * @param[in]   thread        thread data that needs to be started.
@@ -89,6 +112,29 @@ CAResult_t CAQueueingThreadStart(CAQueueingThread_t *thread);
  */
 CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint32_t size);
 
+/**
+ * Take the oldest data of a queuing thread that is not started, e.g. to handle
+ * it on the caller's thread.
+ * @param[in]   thread       thread data.
+ * @param[out]  message      data and its length.
+ * @return  true if data was taken, false if the queue is empty.
+ */
+bool CAQueueingThreadGetData(CAQueueingThread_t *thread, u_queue_message_t *message);
+
+/**
+ * Wait until a queuing thread that is not started has data, or until
+ * CAQueueingThreadWakeUp() is called or the timeout expires.
+ * @param[in]   thread       thread data.
+ * @param[in]   timeoutMs    maximum time to wait in milliseconds, 0 to not wait.
+ */
+void CAQueueingThreadWaitData(CAQueueingThread_t *thread, uint32_t timeoutMs);
+
+/**
+ * Make a pending or the next call of CAQueueingThreadWaitData() return.
+ * @param[in]   thread       thread data.
+ */
+void CAQueueingThreadWakeUp(CAQueueingThread_t *thread);
+
 /**
  * Stop the queuing thread.
  * @param[in]   thread       thread data that needs to be started.
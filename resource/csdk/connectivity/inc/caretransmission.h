@@ -31,6 +31,7 @@
 #include "cathreadpool.h"
 #include "octhread.h"
 #include "uarraylist.h"
+#include "uhashmap.h"
 #include "cacommon.h"
 
 /** IP, EDR, LE. **/
@@ -44,9 +45,6 @@
 /** default max retransmission trying count is 4(CoAP). **/
 #define DEFAULT_RETRANSMISSION_COUNT      4
 
-/** check period is 1 sec. **/
-#define RETRANSMISSION_CHECK_PERIOD_SEC     1
-
 /** retransmission data send method type. **/
 typedef CAResult_t (*CADataSendMethod_t)(const CAEndpoint_t *endpoint,
                                          const void *pdu,
@@ -91,9 +89,12 @@ typedef struct
     /** Variable to inform the thread to stop. **/
     bool isStop;
 
-    /** array list on which the thread is operating. **/
+    /** pending data as a min-heap ordered by next retransmission time. **/
     u_arraylist_t *dataList;
 
+    /** pending data indexed by transport adapter and message id. **/
+    u_hashmap_t *dataIndex;
+
 } CARetransmission_t;
 
 #ifdef __cplusplus
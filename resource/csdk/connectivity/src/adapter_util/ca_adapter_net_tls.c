@@ -26,6 +26,7 @@
 #include "cacommon.h"
 #include "caipinterface.h"
 #include "oic_malloc.h"
+#include "oic_time.h"
 #include "pkix/byte_array.h"
 #include "octhread.h"
 
@@ -109,6 +110,16 @@
  * @brief TLS master secret length
  */
 #define MASTER_SECRET_LEN (48)
+/**
+ * @def TLS_SESSION_CACHE_SIZE
+ * @brief Default number of sessions kept for resumption
+ */
+#define TLS_SESSION_CACHE_SIZE (16)
+/**
+ * @def TLS_SESSION_LIFETIME
+ * @brief Default time in seconds a session may be resumed after its full handshake
+ */
+#define TLS_SESSION_LIFETIME (3600)
 
 /**@def TLS_CLOSE_NOTIFY(peer, ret)
  *
@@ -277,13 +288,45 @@ typedef struct TlsCallBacks
     CAPacketSendCallback sendCallback;      /**< Callback used to send data to socket layer. */
 } TlsCallbacks_t;
 
+/**
+ * Session kept for resumption. Clients look sessions up by the address of the
+ * server, servers by the session ID offered by the client.
+ */
+typedef struct TlsSessionEntry
+{
+    mbedtls_ssl_session session;
+    bool isClient;
+    CAEndpoint_t endpoint;          /**< server address, client sessions only. */
+    CARemoteId_t identity;          /**< peer identity learned in the full handshake. */
+    CARemoteId_t userId;            /**< peer user id learned in the full handshake. */
+    uint64_t expires;               /**< time in milliseconds after which it is dropped. */
+    struct TlsSessionEntry *prev;   /**< more recently used session. */
+    struct TlsSessionEntry *next;   /**< less recently used session. */
+} TlsSessionEntry_t;
+
+/**
+ * LRU cache of sessions for resumption.
+ */
+typedef struct TlsSessionCache
+{
+    u_hashmap_t *clientSessions;    /**< sessions keyed by server address. */
+    u_hashmap_t *serverSessions;    /**< sessions keyed by session ID. */
+    TlsSessionEntry_t *head;        /**< most recently used session. */
+    TlsSessionEntry_t *tail;        /**< least recently used session. */
+    uint32_t count;
+    uint32_t maxEntries;            /**< 0 disables resumption. */
+    uint32_t lifetime;              /**< in seconds. */
+} TlsSessionCache_t;
+
 /**
  * Data structure for holding the mbedTLS interface related info.
  */
 typedef struct TlsContext
 {
-    u_arraylist_t *peerList;         /**< peer list which holds the mapping between
-                                              peer id, it's n/w address and mbedTLS context. */
+    u_hashmap_t *peerMap;            /**< peer map which holds the mapping between
+                                              peer id, it's n/w address and mbedTLS context,
+                                              keyed by n/w address. */
+    TlsSessionCache_t sessionCache;
     mbedtls_entropy_context entropy;
     mbedtls_ctr_drbg_context rnd;
     mbedtls_x509_crt ca;
@@ -328,6 +371,18 @@ static CAgetPkixInfoHandler g_getPkixInfoCallback = NULL;
  */
 static oc_mutex g_tlsContextMutex = NULL;
 
+/**
+ * @var g_tlsSessionCacheSize
+ * @brief Number of sessions kept for resumption, applied by CAinitTlsAdapter
+ */
+static uint32_t g_tlsSessionCacheSize = TLS_SESSION_CACHE_SIZE;
+
+/**
+ * @var g_tlsSessionLifetime
+ * @brief Seconds a cached session may be resumed, applied by CAinitTlsAdapter
+ */
+static uint32_t g_tlsSessionLifetime = TLS_SESSION_LIFETIME;
+
 /**
  * @var g_tlsHandshakeCallback
  * @brief callback to deliver the TLS handshake result
@@ -604,31 +659,16 @@ static int getTlsCredentialsCallback(void * notUsed, mbedtls_ssl_context * ssl,
  */
 static TlsEndPoint_t *getTlsPeer(const CAEndpoint_t *peer)
 {
-    uint32_t listIndex = 0;
-    uint32_t listLength = 0;
     OIC_LOG_V(DEBUG, NET_TLS_TAG, "In %s", __func__);
     VERIFY_NON_NULL_RET(peer, NET_TLS_TAG, "TLS peer is NULL", NULL);
 
-    TlsEndPoint_t *tep = NULL;
-    listLength = u_arraylist_length(g_caTlsContext->peerList);
-    for (listIndex = 0; listIndex < listLength; listIndex++)
+    TlsEndPoint_t *tep = (TlsEndPoint_t *) u_hashmap_get(g_caTlsContext->peerMap, peer);
+    if (NULL == tep)
     {
-        tep = (TlsEndPoint_t *) u_arraylist_get(g_caTlsContext->peerList, listIndex);
-        if (NULL == tep)
-        {
-            continue;
-        }
-        OIC_LOG_V(DEBUG, NET_TLS_TAG, "Compare [%s] and [%s]", peer->addr, tep->sep.endpoint.addr);
-        if((0 == strncmp(peer->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA))
-                && (peer->port == tep->sep.endpoint.port))
-        {
-            OIC_LOG_V(DEBUG, NET_TLS_TAG, "Out %s", __func__);
-            return tep;
-        }
+        OIC_LOG(DEBUG, NET_TLS_TAG, "Return NULL");
     }
-    OIC_LOG(DEBUG, NET_TLS_TAG, "Return NULL");
     OIC_LOG_V(DEBUG, NET_TLS_TAG, "Out %s", __func__);
-    return NULL;
+    return tep;
 }
 /**
  * Deletes cached message.
@@ -692,40 +732,353 @@ static void deleteTlsEndPoint(TlsEndPoint_t * tep)
  */
 static void removePeerFromList(CAEndpoint_t * endpoint)
 {
-    uint32_t listLength = u_arraylist_length(g_caTlsContext->peerList);
     VERIFY_NON_NULL_VOID(endpoint, NET_TLS_TAG, "endpoint");
-    for (uint32_t listIndex = 0; listIndex < listLength; listIndex++)
+    TlsEndPoint_t * tep = (TlsEndPoint_t *) u_hashmap_remove(g_caTlsContext->peerMap, endpoint);
+    if (NULL != tep)
     {
-        TlsEndPoint_t * tep = (TlsEndPoint_t *)u_arraylist_get(g_caTlsContext->peerList,listIndex);
-        if (NULL == tep)
+        deleteTlsEndPoint(tep);
+    }
+}
+/**
+ * Deletes session list.
+ */
+static void deletePeerList()
+{
+    uint32_t iter = 0;
+    TlsEndPoint_t * tep = NULL;
+    while (NULL != (tep = (TlsEndPoint_t *) u_hashmap_next(g_caTlsContext->peerMap, &iter)))
+    {
+        deleteTlsEndPoint(tep);
+    }
+    u_hashmap_free(&g_caTlsContext->peerMap);
+}
+/**
+ * Hash function for server session keys, which point to the mbedTLS session.
+ */
+static uint32_t hashTlsSessionId(const void * key)
+{
+    const mbedtls_ssl_session * session = (const mbedtls_ssl_session *) key;
+    return u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, session->id, session->id_len);
+}
+/**
+ * Equality function for server session keys.
+ */
+static bool equalTlsSessionId(const void * key1, const void * key2)
+{
+    const mbedtls_ssl_session * session1 = (const mbedtls_ssl_session *) key1;
+    const mbedtls_ssl_session * session2 = (const mbedtls_ssl_session *) key2;
+    return session1->id_len == session2->id_len
+            && 0 == memcmp(session1->id, session2->id, session1->id_len);
+}
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+/**
+ * Copies the peer certificate of a session.
+ *
+ * @param[out] dst    copy, freed by mbedtls_ssl_session_free()
+ * @param[in]  src    certificate
+ *
+ * @return  0 on success or -1 on error
+ */
+static int copyPeerCert(mbedtls_x509_crt ** dst, const mbedtls_x509_crt * src)
+{
+    *dst = NULL;
+    if (NULL == src)
+    {
+        return 0;
+    }
+    mbedtls_x509_crt * crt = (mbedtls_x509_crt *) mbedtls_calloc(1, sizeof(mbedtls_x509_crt));
+    if (NULL == crt)
+    {
+        OIC_LOG(ERROR, NET_TLS_TAG, "calloc failed!");
+        return -1;
+    }
+    mbedtls_x509_crt_init(crt);
+    if (0 != mbedtls_x509_crt_parse_der(crt, src->raw.p, src->raw.len))
+    {
+        OIC_LOG(ERROR, NET_TLS_TAG, "Failed to copy peer certificate");
+        mbedtls_x509_crt_free(crt);
+        mbedtls_free(crt);
+        return -1;
+    }
+    *dst = crt;
+    return 0;
+}
+#endif
+/**
+ * Copies a session for the session cache.
+ *
+ * @param[out] dst    copy, to be freed with mbedtls_ssl_session_free()
+ * @param[in]  src    session
+ *
+ * @return  0 on success or -1 on error
+ */
+static int copyTlsSession(mbedtls_ssl_session * dst, const mbedtls_ssl_session * src)
+{
+    memcpy(dst, src, sizeof(mbedtls_ssl_session));
+#if defined(MBEDTLS_SSL_SESSION_TICKETS) && defined(MBEDTLS_SSL_CLI_C)
+    // Sessions are resumed by ID only.
+    dst->ticket = NULL;
+    dst->ticket_len = 0;
+#endif
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if (0 != copyPeerCert(&dst->peer_cert, src->peer_cert))
+    {
+        return -1;
+    }
+#endif
+    return 0;
+}
+/**
+ * Removes a session from the session cache and frees it.
+ *
+ * @param[in]  cache    session cache
+ * @param[in]  entry    cached session
+ */
+static void removeTlsSession(TlsSessionCache_t * cache, TlsSessionEntry_t * entry)
+{
+    if (entry->isClient)
+    {
+        u_hashmap_remove(cache->clientSessions, &entry->endpoint);
+    }
+    else
+    {
+        u_hashmap_remove(cache->serverSessions, &entry->session);
+    }
+
+    if (entry->prev)
+    {
+        entry->prev->next = entry->next;
+    }
+    else
+    {
+        cache->head = entry->next;
+    }
+    if (entry->next)
+    {
+        entry->next->prev = entry->prev;
+    }
+    else
+    {
+        cache->tail = entry->prev;
+    }
+    cache->count--;
+
+    mbedtls_ssl_session_free(&entry->session);
+    OICFree(entry);
+}
+/**
+ * Makes a cached session the most recently used one.
+ *
+ * @param[in]  cache    session cache
+ * @param[in]  entry    cached session, not linked yet if both its links are NULL
+ *                      and it is not the head
+ */
+static void touchTlsSession(TlsSessionCache_t * cache, TlsSessionEntry_t * entry)
+{
+    if (cache->head == entry)
+    {
+        return;
+    }
+    if (entry->prev)
+    {
+        entry->prev->next = entry->next;
+        if (entry->next)
         {
-            continue;
+            entry->next->prev = entry->prev;
         }
-        if(0 == strncmp(endpoint->addr, tep->sep.endpoint.addr, MAX_ADDR_STR_SIZE_CA)
-                && (endpoint->port == tep->sep.endpoint.port))
+        else
         {
-            u_arraylist_remove(g_caTlsContext->peerList, listIndex);
-            deleteTlsEndPoint(tep);
-            return;
+            cache->tail = entry->prev;
         }
     }
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head)
+    {
+        cache->head->prev = entry;
+    }
+    cache->head = entry;
+    if (NULL == cache->tail)
+    {
+        cache->tail = entry;
+    }
 }
 /**
- * Deletes session list.
+ * Drops all cached sessions.
+ *
+ * @param[in]  cache    session cache
  */
-static void deletePeerList()
+static void clearTlsSessionCache(TlsSessionCache_t * cache)
+{
+    while (cache->head)
+    {
+        removeTlsSession(cache, cache->head);
+    }
+}
+/**
+ * Looks up a cached session which may still be resumed.
+ *
+ * @param[in]  cache    session cache
+ * @param[in]  map      client or server sessions of the cache
+ * @param[in]  key      server address or session with ID
+ *
+ * @return  cached session or NULL
+ */
+static TlsSessionEntry_t * findTlsSession(TlsSessionCache_t * cache, u_hashmap_t * map,
+                                          const void * key)
+{
+    TlsSessionEntry_t * entry = (TlsSessionEntry_t *) u_hashmap_get(map, key);
+    if (NULL == entry)
+    {
+        return NULL;
+    }
+    if (OICGetCurrentTime(TIME_IN_MS) >= entry->expires)
+    {
+        OIC_LOG(DEBUG, NET_TLS_TAG, "Cached session expired");
+        removeTlsSession(cache, entry);
+        return NULL;
+    }
+    touchTlsSession(cache, entry);
+    return entry;
+}
+/**
+ * Caches the session of a completed handshake, or restores the peer identity
+ * if the handshake resumed a cached session.
+ *
+ * @param[in]  cache    session cache
+ * @param[in]  tep      endpoint with session info
+ */
+static void saveTlsSession(TlsSessionCache_t * cache, TlsEndPoint_t * tep)
 {
-    uint32_t listLength = u_arraylist_length(g_caTlsContext->peerList);
-    for (uint32_t listIndex = 0; listIndex < listLength; listIndex++)
+    const mbedtls_ssl_session * session = tep->ssl.session;
+    if (0 == cache->maxEntries || NULL == session || 0 == session->id_len)
     {
-        TlsEndPoint_t * tep = (TlsEndPoint_t *)u_arraylist_get(g_caTlsContext->peerList,listIndex);
-        if (NULL == tep)
+        return;
+    }
+
+    bool isClient = (MBEDTLS_SSL_IS_CLIENT == tep->ssl.conf->endpoint);
+    u_hashmap_t * map = isClient ? cache->clientSessions : cache->serverSessions;
+    const void * key = isClient ? (const void *) &tep->sep.endpoint : (const void *) session;
+
+    TlsSessionEntry_t * entry = findTlsSession(cache, map, key);
+    if (NULL != entry)
+    {
+        if (equalTlsSessionId(&entry->session, session))
         {
-            continue;
+            // Resumed, the peer did not present its credentials again.
+            OIC_LOG(DEBUG, NET_TLS_TAG, "Session resumed");
+            tep->sep.identity = entry->identity;
+            tep->sep.userId = entry->userId;
+            return;
         }
-        deleteTlsEndPoint(tep);
+        // The server did not resume the offered session.
+        removeTlsSession(cache, entry);
+    }
+
+    while (cache->count >= cache->maxEntries)
+    {
+        removeTlsSession(cache, cache->tail);
+    }
+
+    entry = (TlsSessionEntry_t *) OICCalloc(1, sizeof(TlsSessionEntry_t));
+    if (NULL == entry)
+    {
+        OIC_LOG(ERROR, NET_TLS_TAG, "calloc failed!");
+        return;
+    }
+    if (0 != copyTlsSession(&entry->session, session))
+    {
+        mbedtls_ssl_session_free(&entry->session);
+        OICFree(entry);
+        return;
+    }
+    entry->isClient = isClient;
+    entry->endpoint = tep->sep.endpoint;
+    entry->identity = tep->sep.identity;
+    entry->userId = tep->sep.userId;
+    entry->expires = OICGetCurrentTime(TIME_IN_MS) + (uint64_t) cache->lifetime * 1000;
+
+    key = isClient ? (const void *) &entry->endpoint : (const void *) &entry->session;
+    if (!u_hashmap_put(map, key, entry))
+    {
+        OIC_LOG(ERROR, NET_TLS_TAG, "u_hashmap_put failed!");
+        mbedtls_ssl_session_free(&entry->session);
+        OICFree(entry);
+        return;
+    }
+    touchTlsSession(cache, entry);
+    cache->count++;
+}
+/**
+ * Session cache callback of the server configuration.
+ *
+ * @param[in]      data       session cache
+ * @param[in,out]  session    session with the ID offered by the client, completed on success
+ *
+ * @return  0 if the session may be resumed, 1 otherwise
+ */
+static int getTlsServerSession(void * data, mbedtls_ssl_session * session)
+{
+    TlsSessionCache_t * cache = (TlsSessionCache_t *) data;
+    TlsSessionEntry_t * entry = findTlsSession(cache, cache->serverSessions, session);
+    if (NULL == entry
+        || entry->session.ciphersuite != session->ciphersuite
+        || entry->session.compression != session->compression)
+    {
+        return 1;
+    }
+
+    memcpy(session->master, entry->session.master, sizeof(session->master));
+    session->verify_result = entry->session.verify_result;
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if (0 != copyPeerCert(&session->peer_cert, entry->session.peer_cert))
+    {
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+CAResult_t CAsetTlsSessionCacheConfig(uint32_t maxEntries, uint32_t lifetime)
+{
+    OIC_LOG_V(DEBUG, NET_TLS_TAG, "In %s", __func__);
+    // Before the adapter is initialized only the values are kept, CAinitTlsAdapter applies them.
+    if (NULL == g_tlsContextMutex)
+    {
+        g_tlsSessionCacheSize = maxEntries;
+        g_tlsSessionLifetime = lifetime;
+        return CA_STATUS_OK;
+    }
+    oc_mutex_lock(g_tlsContextMutex);
+    g_tlsSessionCacheSize = maxEntries;
+    g_tlsSessionLifetime = lifetime;
+    if (NULL != g_caTlsContext)
+    {
+        clearTlsSessionCache(&g_caTlsContext->sessionCache);
+        g_caTlsContext->sessionCache.maxEntries = maxEntries;
+        g_caTlsContext->sessionCache.lifetime = lifetime;
+    }
+    oc_mutex_unlock(g_tlsContextMutex);
+    OIC_LOG_V(DEBUG, NET_TLS_TAG, "Out %s", __func__);
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAclearTlsSessionCache()
+{
+    OIC_LOG_V(DEBUG, NET_TLS_TAG, "In %s", __func__);
+    // Nothing is cached while the adapter is not initialized.
+    if (NULL == g_tlsContextMutex)
+    {
+        return CA_STATUS_OK;
+    }
+    oc_mutex_lock(g_tlsContextMutex);
+    if (NULL != g_caTlsContext)
+    {
+        clearTlsSessionCache(&g_caTlsContext->sessionCache);
     }
-    u_arraylist_free(&g_caTlsContext->peerList);
+    oc_mutex_unlock(g_tlsContextMutex);
+    OIC_LOG_V(DEBUG, NET_TLS_TAG, "Out %s", __func__);
+    return CA_STATUS_OK;
 }
 
 CAResult_t CAcloseTlsConnection(const CAEndpoint_t *endpoint)
@@ -908,11 +1261,22 @@ static TlsEndPoint_t * initiateTlsHandshake(const CAEndpoint_t *endpoint)
     //Load allowed SVR suites from SVR DB
     setupCipher(&g_caTlsContext->clientConf);
 
+    TlsSessionEntry_t * cached = findTlsSession(&g_caTlsContext->sessionCache,
+                                                g_caTlsContext->sessionCache.clientSessions,
+                                                endpoint);
+    if (NULL != cached && 0 != mbedtls_ssl_set_session(&tep->ssl, &cached->session))
+    {
+        OIC_LOG(WARNING, NET_TLS_TAG, "Failed to offer cached session");
+    }
+
+    // A new handshake replaces an existing session with the endpoint.
+    removePeerFromList(&tep->sep.endpoint);
+
     OIC_LOG_V(DEBUG, NET_TLS_TAG, "Add %s:%d", tep->sep.endpoint.addr, tep->sep.endpoint.port);
-    ret = u_arraylist_add(g_caTlsContext->peerList, (void *) tep);
+    ret = u_hashmap_put(g_caTlsContext->peerMap, &tep->sep.endpoint, (void *) tep);
     if (!ret)
     {
-        OIC_LOG(ERROR, NET_TLS_TAG, "u_arraylist_add failed!");
+        OIC_LOG(ERROR, NET_TLS_TAG, "u_hashmap_put failed!");
         deleteTlsEndPoint(tep);
         return NULL;
     }
@@ -942,6 +1306,9 @@ void CAdeinitTlsAdapter()
 
     // Clear all lists
     deletePeerList();
+    clearTlsSessionCache(&g_caTlsContext->sessionCache);
+    u_hashmap_free(&g_caTlsContext->sessionCache.clientSessions);
+    u_hashmap_free(&g_caTlsContext->sessionCache.serverSessions);
 
     // De-initialize mbedTLS
     mbedtls_x509_crt_free(&g_caTlsContext->crt);
@@ -993,12 +1360,23 @@ CAResult_t CAinitTlsAdapter()
         return CA_MEMORY_ALLOC_FAILED;
     }
 
-    // Create peer list
-    g_caTlsContext->peerList = u_arraylist_create();
+    // Create peer map and session cache
+    g_caTlsContext->peerMap = u_hashmap_create(CAHashEndpointAddress, CAEqualEndpointAddress);
+    g_caTlsContext->sessionCache.clientSessions = u_hashmap_create(CAHashEndpointAddress,
+                                                                   CAEqualEndpointAddress);
+    g_caTlsContext->sessionCache.serverSessions = u_hashmap_create(hashTlsSessionId,
+                                                                   equalTlsSessionId);
+    g_caTlsContext->sessionCache.maxEntries = g_tlsSessionCacheSize;
+    g_caTlsContext->sessionCache.lifetime = g_tlsSessionLifetime;
 
-    if(NULL == g_caTlsContext->peerList)
+    if(NULL == g_caTlsContext->peerMap
+       || NULL == g_caTlsContext->sessionCache.clientSessions
+       || NULL == g_caTlsContext->sessionCache.serverSessions)
     {
-        OIC_LOG(ERROR, NET_TLS_TAG, "peerList initialization failed!");
+        OIC_LOG(ERROR, NET_TLS_TAG, "peerMap initialization failed!");
+        u_hashmap_free(&g_caTlsContext->peerMap);
+        u_hashmap_free(&g_caTlsContext->sessionCache.clientSessions);
+        u_hashmap_free(&g_caTlsContext->sessionCache.serverSessions);
         OICFree(g_caTlsContext);
         g_caTlsContext = NULL;
         oc_mutex_unlock(g_tlsContextMutex);
@@ -1101,6 +1479,9 @@ CAResult_t CAinitTlsAdapter()
                                  MBEDTLS_SSL_MINOR_VERSION_1);
     mbedtls_ssl_conf_renegotiation(&g_caTlsContext->serverConf, MBEDTLS_SSL_RENEGOTIATION_DISABLED);
     mbedtls_ssl_conf_authmode(&g_caTlsContext->serverConf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    // Sessions are cached once the peer identity is known, see saveTlsSession().
+    mbedtls_ssl_conf_session_cache(&g_caTlsContext->serverConf, &g_caTlsContext->sessionCache,
+                                   getTlsServerSession, NULL);
 
 #ifndef NDEBUG
     mbedtls_ssl_conf_dbg( &g_caTlsContext->serverConf, debugTls, NULL);
@@ -1371,10 +1752,10 @@ CAResult_t CAdecryptTls(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t d
         //Load allowed SVR suites from SVR DB
         setupCipher(&g_caTlsContext->serverConf);
 
-        ret = u_arraylist_add(g_caTlsContext->peerList, (void *) peer);
+        ret = u_hashmap_put(g_caTlsContext->peerMap, &peer->sep.endpoint, (void *) peer);
         if (!ret)
         {
-            OIC_LOG(ERROR, NET_TLS_TAG, "u_arraylist_add failed!");
+            OIC_LOG(ERROR, NET_TLS_TAG, "u_hashmap_put failed!");
             OICFree(peer);
             oc_mutex_unlock(g_tlsContextMutex);
             return CA_STATUS_FAILED;
@@ -1412,6 +1793,7 @@ CAResult_t CAdecryptTls(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t d
         {
             if (MBEDTLS_SSL_IS_CLIENT == peer->ssl.conf->endpoint)
             {
+                saveTlsSession(&g_caTlsContext->sessionCache, peer);
                 sendCacheMessages(peer);
                 if (g_tlsHandshakeCallback)
                 {
@@ -1456,6 +1838,7 @@ CAResult_t CAdecryptTls(const CASecureEndpoint_t *sep, uint8_t *data, uint32_t d
                         OIC_LOG(WARNING, NET_TLS_TAG, "Subject alternative name not found");
                     }
                 }
+                saveTlsSession(&g_caTlsContext->sessionCache, peer);
             }
             oc_mutex_unlock(g_tlsContextMutex);
             OIC_LOG_V(DEBUG, NET_TLS_TAG, "Out %s", __func__);
@@ -1587,6 +1970,10 @@ CAResult_t CAsetTlsCipherSuite(const uint32_t cipher)
             return CA_STATUS_FAILED;
         }
     }
+    // Sessions negotiated for the previous cipher suite are not resumed.
+    oc_mutex_lock(g_tlsContextMutex);
+    clearTlsSessionCache(&g_caTlsContext->sessionCache);
+    oc_mutex_unlock(g_tlsContextMutex);
     OIC_LOG_V(DEBUG, NET_TLS_TAG, "Selected cipher: 0x%x", cipher);
     OIC_LOG_V(DEBUG, NET_TLS_TAG, "Out %s", __func__);
     return CA_STATUS_OK;
@@ -105,32 +105,13 @@ static CAGetDTLSCrlHandler g_getCrlCallback = NULL;
 
 static CASecureEndpoint_t *GetPeerInfo(const CAEndpoint_t *peer)
 {
-    uint32_t list_index = 0;
-    uint32_t list_length = 0;
-
     if(NULL == peer)
     {
         OIC_LOG(ERROR, NET_DTLS_TAG, "CAPeerInfoListContains invalid parameters");
         return NULL;
     }
 
-    CASecureEndpoint_t *peerInfo = NULL;
-    list_length = u_arraylist_length(g_caDtlsContext->peerInfoList);
-    for (list_index = 0; list_index < list_length; list_index++)
-    {
-        peerInfo = (CASecureEndpoint_t *)u_arraylist_get(g_caDtlsContext->peerInfoList, list_index);
-        if (NULL == peerInfo)
-        {
-            continue;
-        }
-
-        if((0 == strncmp(peer->addr, peerInfo->endpoint.addr, MAX_ADDR_STR_SIZE_CA)) &&
-                (peer->port == peerInfo->endpoint.port))
-        {
-            return peerInfo;
-        }
-    }
-    return NULL;
+    return (CASecureEndpoint_t *)u_hashmap_get(g_caDtlsContext->peerInfoMap, peer);
 }
 
 static CAResult_t CAAddIdToPeerInfoList(const char *peerAddr, uint32_t port,
@@ -166,10 +147,10 @@ static CAResult_t CAAddIdToPeerInfoList(const char *peerAddr, uint32_t port,
         return CA_STATUS_FAILED;
     }
 
-    bool result = u_arraylist_add(g_caDtlsContext->peerInfoList, (void *)peer);
+    bool result = u_hashmap_put(g_caDtlsContext->peerInfoMap, &peer->endpoint, (void *)peer);
     if (!result)
     {
-        OIC_LOG(ERROR, NET_DTLS_TAG, "u_arraylist_add failed!");
+        OIC_LOG(ERROR, NET_DTLS_TAG, "u_hashmap_put failed!");
         OICFree(peer);
         return CA_STATUS_FAILED;
     }
@@ -179,15 +160,14 @@ static CAResult_t CAAddIdToPeerInfoList(const char *peerAddr, uint32_t port,
 
 static void CAFreePeerInfoList()
 {
-    uint32_t list_length = u_arraylist_length(g_caDtlsContext->peerInfoList);
-    for (uint32_t list_index = 0; list_index < list_length; list_index++)
+    uint32_t iter = 0;
+    CASecureEndpoint_t *peerInfo = NULL;
+    while (NULL != (peerInfo = (CASecureEndpoint_t *)u_hashmap_next(
+                                   g_caDtlsContext->peerInfoMap, &iter)))
     {
-        CAEndpoint_t *peerInfo = (CAEndpoint_t *)u_arraylist_get(
-                                     g_caDtlsContext->peerInfoList, list_index);
         OICFree(peerInfo);
     }
-    u_arraylist_free(&(g_caDtlsContext->peerInfoList));
-    g_caDtlsContext->peerInfoList = NULL;
+    u_hashmap_free(&(g_caDtlsContext->peerInfoMap));
 }
 
 static void CARemovePeerFromPeerInfoList(const char * addr, uint16_t port)
@@ -198,22 +178,11 @@ static void CARemovePeerFromPeerInfoList(const char * addr, uint16_t port)
         return;
     }
 
-    uint32_t list_length = u_arraylist_length(g_caDtlsContext->peerInfoList);
-    for (uint32_t list_index = 0; list_index < list_length; list_index++)
-    {
-        CAEndpoint_t *peerInfo = (CAEndpoint_t *)u_arraylist_get(
-                                g_caDtlsContext->peerInfoList,list_index);
-        if (NULL == peerInfo)
-        {
-            continue;
-        }
-        if((0 == strncmp(addr, peerInfo->addr, MAX_ADDR_STR_SIZE_CA)) &&
-                (port == peerInfo->port))
-        {
-            OICFree(u_arraylist_remove(g_caDtlsContext->peerInfoList, list_index));
-            return;
-        }
-    }
+    CAEndpoint_t endpoint = { .adapter = CA_DEFAULT_ADAPTER };
+    OICStrcpy(endpoint.addr, sizeof(endpoint.addr), addr);
+    endpoint.port = port;
+
+    OICFree(u_hashmap_remove(g_caDtlsContext->peerInfoMap, &endpoint));
 }
 
 static int CASizeOfAddrInfo(stCADtlsAddrInfo_t *addrInfo)
@@ -1080,13 +1049,14 @@ CAResult_t CAAdapterNetDtlsInit()
 
 
     // Create PeerInfoList and CacheList
-    g_caDtlsContext->peerInfoList = u_arraylist_create();
+    g_caDtlsContext->peerInfoMap = u_hashmap_create(CAHashEndpointAddress,
+                                                    CAEqualEndpointAddress);
     g_caDtlsContext->cacheList = u_arraylist_create();
 
-    if( (NULL == g_caDtlsContext->peerInfoList) ||
+    if( (NULL == g_caDtlsContext->peerInfoMap) ||
         (NULL == g_caDtlsContext->cacheList))
     {
-    OIC_LOG(ERROR, NET_DTLS_TAG, "peerInfoList or cacheList initialization failed!");
+    OIC_LOG(ERROR, NET_DTLS_TAG, "peerInfoMap or cacheList initialization failed!");
         CAClearCacheList();
         CAFreePeerInfoList();
         OICFree(g_caDtlsContext);
@@ -221,6 +221,22 @@ void CAConvertNameToAddr(const char *host, uint16_t port, struct sockaddr_storag
 }
 #endif // WITH_ARDUINO
 
+uint32_t CAHashEndpointAddress(const void *key)
+{
+    const CAEndpoint_t *endpoint = (const CAEndpoint_t *)key;
+    uint32_t hash = u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, endpoint->addr,
+                                         strnlen(endpoint->addr, sizeof(endpoint->addr)));
+    return u_hashmap_hash_bytes(hash, &endpoint->port, sizeof(endpoint->port));
+}
+
+bool CAEqualEndpointAddress(const void *key1, const void *key2)
+{
+    const CAEndpoint_t *endpoint1 = (const CAEndpoint_t *)key1;
+    const CAEndpoint_t *endpoint2 = (const CAEndpoint_t *)key2;
+    return (endpoint1->port == endpoint2->port)
+            && !strncmp(endpoint1->addr, endpoint2->addr, sizeof(endpoint1->addr));
+}
+
 #ifdef __ANDROID__
 void CANativeJNISetContext(JNIEnv *env, jobject context)
 {
@@ -53,10 +53,40 @@
 
 #define BLOCK_SIZE(arg) (1 << ((arg) + 4))
 
+// the total payload length of Size1/Size2 is preallocated up to this length
+#define BLOCK_PAYLOAD_PREALLOC_MAX (1024 * 1024)
+
 // context for block-wise transfer
 static CABlockWiseContext_t g_context = { .sendThreadFunc = NULL,
                                           .receivedThreadFunc = NULL,
-                                          .dataList = NULL };
+                                          .dataList = NULL,
+                                          .dataMap = NULL };
+
+static uint32_t CAHashBlockDataID(const void *key)
+{
+    const CABlockDataID_t *blockID = (const CABlockDataID_t *) key;
+    return u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, blockID->id, blockID->idLength);
+}
+
+static bool CAEqualBlockDataID(const void *key1, const void *key2)
+{
+    const CABlockDataID_t *blockID1 = (const CABlockDataID_t *) key1;
+    const CABlockDataID_t *blockID2 = (const CABlockDataID_t *) key2;
+    return blockID1->idLength == blockID2->idLength
+            && !memcmp(blockID1->id, blockID2->id, blockID1->idLength);
+}
+
+/**
+ * Finds the block data of the given ID. The list mutex must be held.
+ */
+static CABlockData_t *CAFindBlockData(const CABlockDataID_t *blockID)
+{
+    if (!g_context.dataMap || !blockID->id)
+    {
+        return NULL;
+    }
+    return (CABlockData_t *) u_hashmap_get(g_context.dataMap, blockID);
+}
 
 static bool CACheckPayloadLength(const CAData_t *sendData)
 {
@@ -96,11 +126,17 @@ CAResult_t CAInitializeBlockWiseTransfer(CASendThreadFunc sendThreadFunc,
         g_context.dataList = u_arraylist_create();
     }
 
+    if (!g_context.dataMap)
+    {
+        g_context.dataMap = u_hashmap_create(CAHashBlockDataID, CAEqualBlockDataID);
+    }
+
     CAResult_t res = CAInitBlockWiseMutexVariables();
     if (CA_STATUS_OK != res)
     {
         u_arraylist_free(&g_context.dataList);
         g_context.dataList = NULL;
+        u_hashmap_free(&g_context.dataMap);
         OIC_LOG(ERROR, TAG, "init has failed");
     }
 
@@ -116,6 +152,7 @@ CAResult_t CATerminateBlockWiseTransfer()
         CARemoveAllBlockDataFromList();
         u_arraylist_free(&g_context.dataList);
     }
+    u_hashmap_free(&g_context.dataMap);
 
     CATerminateBlockWiseMutexVariables();
 
@@ -768,6 +805,7 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     {
         OICFree(data->payload);
         data->payload = NULL;
+        data->payloadCapacity = 0;
         data->payloadLength = 0;
         data->receivedPayloadLen = 0;
         data->block1.num = 0;
@@ -777,6 +815,32 @@ CAResult_t CASendErrorMessage(const coap_pdu_t *pdu, uint8_t status,
     return CA_STATUS_OK;
 }
 
+/**
+ * Hands the payload buffer over to the data without copying it.
+ */
+static CAResult_t CAMovePayloadToCAData(CAData_t *data, CAPayload_t payload, size_t payloadLen)
+{
+    CAInfo_t *info = NULL;
+    if (CA_REQUEST_DATA == data->dataType && data->requestInfo)
+    {
+        info = &data->requestInfo->info;
+    }
+    else if (CA_RESPONSE_DATA == data->dataType && data->responseInfo)
+    {
+        info = &data->responseInfo->info;
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "Not supported data type");
+        return CA_STATUS_FAILED;
+    }
+
+    OICFree(info->payload);
+    info->payload = payload;
+    info->payloadSize = payloadLen;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *receivedData)
 {
     VERIFY_NON_NULL(blockID, TAG, "blockID");
@@ -792,13 +856,14 @@ CAResult_t CAReceiveLastBlock(const CABlockDataID_t *blockID, const CAData_t *re
 
     // update payload
     size_t fullPayloadLen = 0;
-    CAPayload_t fullPayload = CAGetPayloadFromBlockDataList(blockID, &fullPayloadLen);
+    CAPayload_t fullPayload = CATakePayloadFromBlockDataList(blockID, &fullPayloadLen);
     if (fullPayload)
     {
-        CAResult_t res = CAUpdatePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
+        CAResult_t res = CAMovePayloadToCAData(cloneData, fullPayload, fullPayloadLen);
         if (CA_STATUS_OK != res)
         {
             OIC_LOG(ERROR, TAG, "update has failed");
+            OICFree(fullPayload);
             CADestroyDataSet(cloneData);
             return res;
         }
@@ -1379,7 +1444,7 @@ CAResult_t CAUpdateMessageId(coap_pdu_t *pdu, const CABlockDataID_t *blockID)
 }
 
 CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
-                            const CAEndpoint_t *endpoint, coap_list_t **options)
+                            const CAEndpoint_t *endpoint, CAPDUOptions_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-AddBlockOption");
     VERIFY_NON_NULL(pdu, TAG, "pdu");
@@ -1440,18 +1505,12 @@ CAResult_t CAAddBlockOption(coap_pdu_t **pdu, const CAInfo_t *info,
         OIC_LOG(DEBUG, TAG, "no BLOCK option");
 
         // in case it is not large data, add option list to pdu.
-        if (*options)
+        for (uint8_t i = 0; i < options->count; i++)
         {
-            for (coap_list_t *opt = *options; opt; opt = opt->next)
-            {
-                OIC_LOG_V(DEBUG, TAG, "[%s] opt will be added.",
-                          COAP_OPTION_DATA(*(coap_option *) opt->data));
-
-                OIC_LOG_V(DEBUG, TAG, "[%d] pdu length", (*pdu)->length);
-                coap_add_option(*pdu, COAP_OPTION_KEY(*(coap_option *) opt->data),
-                                COAP_OPTION_LENGTH(*(coap_option *) opt->data),
-                                COAP_OPTION_DATA(*(coap_option *) opt->data));
-            }
+            const CAPDUOption_t *opt = &options->options[i];
+            OIC_LOG_V(DEBUG, TAG, "[%d] opt will be added, [%d] pdu length",
+                      opt->key, (*pdu)->length);
+            coap_add_option(*pdu, opt->key, opt->length, opt->data);
         }
 
         OIC_LOG_V(DEBUG, TAG, "[%d] pdu length after option", (*pdu)->length);
@@ -1493,7 +1552,7 @@ exit:
 }
 
 CAResult_t CAAddBlockOption2(coap_pdu_t **pdu, const CAInfo_t *info, size_t dataLength,
-                             const CABlockDataID_t *blockID, coap_list_t **options)
+                             const CABlockDataID_t *blockID, CAPDUOptions_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-AddBlockOption2");
     VERIFY_NON_NULL(pdu, TAG, "pdu");
@@ -1598,7 +1657,7 @@ exit:
 }
 
 CAResult_t CAAddBlockOption1(coap_pdu_t **pdu, const CAInfo_t *info, size_t dataLength,
-                             const CABlockDataID_t *blockID, coap_list_t **options)
+                             const CABlockDataID_t *blockID, CAPDUOptions_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-AddBlockOption1");
     VERIFY_NON_NULL(pdu, TAG, "pdu");
@@ -1709,7 +1768,7 @@ exit:
 }
 
 CAResult_t CAAddBlockOptionImpl(coap_block_t *block, uint8_t blockType,
-                                coap_list_t **options)
+                                CAPDUOptions_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-AddBlockOptionImpl");
     VERIFY_NON_NULL(block, TAG, "block");
@@ -1721,36 +1780,31 @@ CAResult_t CAAddBlockOptionImpl(coap_block_t *block, uint8_t blockType,
                                                        | (block->m << BLOCK_M_BIT_IDX)
                                                        | block->szx));
 
-    int ret = coap_insert(options,
-                          CACreateNewOptionNode(blockType, optionLength, (char *) buf),
-                          CAOrderOpts);
-    if (ret <= 0)
+    CAResult_t res = CAAddPDUOption(options, blockType, optionLength, buf);
+    if (CA_STATUS_OK != res)
     {
-        return CA_STATUS_INVALID_PARAM;
+        return res;
     }
 
     OIC_LOG(DEBUG, TAG, "OUT-AddBlockOptionImpl");
     return CA_STATUS_OK;
 }
 
-CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, coap_list_t **options)
+CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, const CAPDUOptions_t *options)
 {
+    VERIFY_NON_NULL(pdu, TAG, "pdu");
+    VERIFY_NON_NULL(options, TAG, "options");
+
     // after adding the block option to option list, add option list to pdu.
-    if (*options)
+    for (uint8_t i = 0; i < options->count; i++)
     {
-        for (coap_list_t *opt = *options; opt; opt = opt->next)
+        const CAPDUOption_t *opt = &options->options[i];
+        OIC_LOG_V(DEBUG, TAG, "[%d] opt will be added, [%d] pdu length",
+                  opt->key, pdu->length);
+        int ret = coap_add_option(pdu, opt->key, opt->length, opt->data);
+        if (!ret)
         {
-            OIC_LOG_V(DEBUG, TAG, "[%s] opt will be added.",
-                      COAP_OPTION_DATA(*(coap_option *) opt->data));
-
-            OIC_LOG_V(DEBUG, TAG, "[%d] pdu length", pdu->length);
-            int ret = coap_add_option(pdu, COAP_OPTION_KEY(*(coap_option *) opt->data),
-                                      COAP_OPTION_LENGTH(*(coap_option *) opt->data),
-                                      COAP_OPTION_DATA(*(coap_option *) opt->data));
-            if (!ret)
-            {
-                return CA_STATUS_FAILED;
-            }
+            return CA_STATUS_FAILED;
         }
     }
 
@@ -1760,7 +1814,7 @@ CAResult_t CAAddOptionToPDU(coap_pdu_t *pdu, coap_list_t **options)
 }
 
 CAResult_t CAAddBlockSizeOption(coap_pdu_t *pdu, uint16_t sizeType, size_t dataLength,
-                                coap_list_t **options)
+                                CAPDUOptions_t *options)
 {
     OIC_LOG(DEBUG, TAG, "IN-CAAddBlockSizeOption");
     VERIFY_NON_NULL(pdu, TAG, "pdu");
@@ -1775,12 +1829,10 @@ CAResult_t CAAddBlockSizeOption(coap_pdu_t *pdu, uint16_t sizeType, size_t dataL
     unsigned char value[BLOCKWISE_OPTION_BUFFER] = { 0 };
     unsigned int optionLength = coap_encode_var_bytes(value, dataLength);
 
-    int ret = coap_insert(options,
-                          CACreateNewOptionNode(sizeType, optionLength, (char *) value),
-                          CAOrderOpts);
-    if (ret <= 0)
+    CAResult_t res = CAAddPDUOption(options, sizeType, optionLength, value);
+    if (CA_STATUS_OK != res)
     {
-        return CA_STATUS_INVALID_PARAM;
+        return res;
     }
 
     OIC_LOG(DEBUG, TAG, "OUT-CAAddBlockSizeOption");
@@ -1920,6 +1972,41 @@ uint8_t CACheckBlockErrorType(CABlockData_t *currData, coap_block_t *receivedBlo
     return CA_BLOCK_UNKNOWN;
 }
 
+/**
+ * Makes room for the given payload length in the payload buffer.
+ * The buffer grows geometrically, so a payload of unknown length is
+ * reassembled in linear time.
+ */
+static CAResult_t CAReservePayload(CABlockData_t *currData, size_t payloadLen)
+{
+    if (payloadLen <= currData->payloadCapacity)
+    {
+        return CA_STATUS_OK;
+    }
+
+    size_t capacity = currData->payloadCapacity;
+    if (0 == capacity)
+    {
+        capacity = payloadLen;
+    }
+    while (capacity < payloadLen)
+    {
+        capacity = (capacity > SIZE_MAX / 2) ? payloadLen : capacity * 2;
+    }
+
+    OIC_LOG_V(DEBUG, TAG, "allocate %zu bytes for the received block payload", capacity);
+    CAPayload_t newPayload = OICRealloc(currData->payload, capacity);
+    if (NULL == newPayload)
+    {
+        OIC_LOG(ERROR, TAG, "out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    currData->payload = newPayload;
+    currData->payloadCapacity = capacity;
+    return CA_STATUS_OK;
+}
+
 CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *receivedData,
                                uint8_t status, bool isSizeOption, uint16_t blockType)
 {
@@ -1944,55 +2031,31 @@ CAResult_t CAUpdatePayloadData(CABlockData_t *currData, const CAData_t *received
                 BLOCK_SIZE(currData->block2.szx) : BLOCK_SIZE(currData->block1.szx);
     }
 
-    // memory allocation for the received block payload
-    size_t prePayloadLen = currData->receivedPayloadLen;
     if (blockPayload)
     {
-        if (currData->payloadLength)
+        // in case the block message has the size option
+        // allocate the memory for the total payload at once
+        size_t prePayloadLen = currData->receivedPayloadLen;
+        size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
+        if (isSizeOption && totalPayloadLen < currData->payloadLength
+            && BLOCK_PAYLOAD_PREALLOC_MAX >= currData->payloadLength)
         {
-            // in case the block message has the size option
-            // allocate the memory for the total payload
-            if (isSizeOption)
-            {
-                CAPayload_t prePayload = currData->payload;
-
-                OIC_LOG(DEBUG, TAG, "allocate memory for the total payload");
-                currData->payload = (CAPayload_t) OICCalloc(1, currData->payloadLength);
-                if (NULL == currData->payload)
-                {
-                    OIC_LOG(ERROR, TAG, "out of memory");
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy(currData->payload, prePayload, prePayloadLen);
-                OICFree(prePayload);
-            }
-
-            // update the total payload
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+            totalPayloadLen = currData->payloadLength;
         }
-        else
-        {
-            OIC_LOG(DEBUG, TAG, "allocate memory for the received block payload");
-
-            size_t totalPayloadLen = prePayloadLen + blockPayloadLen;
-            CAPayload_t newPayload = OICRealloc(currData->payload, totalPayloadLen);
-            if (NULL == newPayload)
-            {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return CA_MEMORY_ALLOC_FAILED;
-            }
 
-            // update the total payload
-            memset(newPayload + prePayloadLen, 0, blockPayloadLen);
-            currData->payload = newPayload;
-            memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+        CAResult_t res = CAReservePayload(currData, totalPayloadLen);
+        if (CA_STATUS_OK != res)
+        {
+            return res;
         }
 
+        // update the total payload
+        memcpy(currData->payload + prePayloadLen, blockPayload, blockPayloadLen);
+
         // update received payload length
         currData->receivedPayloadLen += blockPayloadLen;
 
-        OIC_LOG_V(DEBUG, TAG, "updated payload: %s, len: %zu", currData->payload,
-                  currData->receivedPayloadLen);
+        OIC_LOG_V(DEBUG, TAG, "updated payload len: %zu", currData->receivedPayloadLen);
     }
 
     OIC_LOG(DEBUG, TAG, "OUT-UpdatePayloadData");
@@ -2232,17 +2295,13 @@ CAResult_t CAUpdateBlockOptionType(const CABlockDataID_t *blockID, uint8_t block
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            currData->type = blockType;
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
-            return CA_STATUS_OK;
-        }
+        currData->type = blockType;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-UpdateBlockOptionType");
+        return CA_STATUS_OK;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2257,16 +2316,13 @@ uint8_t CAGetBlockOptionType(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
-            return currData->type;
-        }
+        uint8_t type = currData->type;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOptionType");
+        return type;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2280,15 +2336,12 @@ CAData_t *CAGetDataSetFromBlockDataList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData->sentData;
-        }
+        CAData_t *sentData = currData->sentData;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return sentData;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2391,19 +2444,10 @@ CABlockData_t *CAGetBlockDataFromBlockDataList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
-    {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            return currData;
-        }
-    }
+    CABlockData_t *currData = CAFindBlockData(blockID);
     oc_mutex_unlock(g_context.blockDataListMutex);
 
-    return NULL;
+    return currData;
 }
 
 coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockType)
@@ -2413,23 +2457,20 @@ coap_block_t *CAGetBlockOption(const CABlockDataID_t *blockID, uint16_t blockTyp
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
+        if (COAP_OPTION_BLOCK2 == blockType)
         {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            OIC_LOG(DEBUG, TAG, "OUT-GetBlockOption");
-            if (COAP_OPTION_BLOCK2 == blockType)
-            {
-                return &currData->block2;
-            }
-            else if (COAP_OPTION_BLOCK1 == blockType)
-            {
-                return &currData->block1;
-            }
+            return &currData->block2;
+        }
+        else if (COAP_OPTION_BLOCK1 == blockType)
+        {
+            return &currData->block1;
         }
+        return NULL;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2446,17 +2487,14 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
-    size_t len = u_arraylist_length(g_context.dataList);
-    for (size_t i = 0; i < len; i++)
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
-        {
-            oc_mutex_unlock(g_context.blockDataListMutex);
-            *fullPayloadLen = currData->receivedPayloadLen;
-            OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
-            return currData->payload;
-        }
+        *fullPayloadLen = currData->receivedPayloadLen;
+        CAPayload_t payload = currData->payload;
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        OIC_LOG(DEBUG, TAG, "OUT-GetFullPayload");
+        return payload;
     }
     oc_mutex_unlock(g_context.blockDataListMutex);
 
@@ -2464,6 +2502,44 @@ CAPayload_t CAGetPayloadFromBlockDataList(const CABlockDataID_t *blockID,
     return NULL;
 }
 
+CAPayload_t CATakePayloadFromBlockDataList(const CABlockDataID_t *blockID,
+                                           size_t *fullPayloadLen)
+{
+    OIC_LOG(DEBUG, TAG, "IN-TakeFullPayload");
+    VERIFY_NON_NULL_RET(blockID, TAG, "blockID", NULL);
+    VERIFY_NON_NULL_RET(fullPayloadLen, TAG, "fullPayloadLen", NULL);
+
+    *fullPayloadLen = 0;
+
+    oc_mutex_lock(g_context.blockDataListMutex);
+
+    CAPayload_t payload = NULL;
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (currData && currData->payload)
+    {
+        payload = currData->payload;
+        *fullPayloadLen = currData->receivedPayloadLen;
+
+        currData->payload = NULL;
+        currData->payloadCapacity = 0;
+        currData->receivedPayloadLen = 0;
+    }
+    oc_mutex_unlock(g_context.blockDataListMutex);
+
+    // give back the unused part of a geometrically grown buffer
+    if (payload && *fullPayloadLen)
+    {
+        CAPayload_t shrunkPayload = OICRealloc(payload, *fullPayloadLen);
+        if (shrunkPayload)
+        {
+            payload = shrunkPayload;
+        }
+    }
+
+    OIC_LOG(DEBUG, TAG, "OUT-TakeFullPayload");
+    return payload;
+}
+
 CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
 {
     OIC_LOG(DEBUG, TAG, "IN-CACreateNewBlockData");
@@ -2524,6 +2600,16 @@ CABlockData_t *CACreateNewBlockData(const CAData_t *sendData)
     oc_mutex_lock(g_context.blockDataListMutex);
 
     bool res = u_arraylist_add(g_context.dataList, (void *) data);
+    if (res && CAFindBlockData(data->blockDataId))
+    {
+        // like the list scan before the map, lookups keep finding the first data of an ID
+        OIC_LOG(WARNING, TAG, "block data of this ID already exists");
+    }
+    else if (res && !u_hashmap_put(g_context.dataMap, data->blockDataId, data))
+    {
+        u_arraylist_remove(g_context.dataList, u_arraylist_length(g_context.dataList) - 1);
+        res = false;
+    }
     if (!res)
     {
         OIC_LOG(ERROR, TAG, "add has failed");
@@ -2546,11 +2632,18 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
 
     oc_mutex_lock(g_context.blockDataListMutex);
 
+    CABlockData_t *currData = CAFindBlockData(blockID);
+    if (!currData)
+    {
+        oc_mutex_unlock(g_context.blockDataListMutex);
+        return CA_STATUS_OK;
+    }
+    u_hashmap_remove(g_context.dataMap, currData->blockDataId);
+
     size_t len = u_arraylist_length(g_context.dataList);
     for (size_t i = 0; i < len; i++)
     {
-        CABlockData_t *currData = (CABlockData_t *) u_arraylist_get(g_context.dataList, i);
-        if (CABlockidMatches(currData, blockID))
+        if (currData == u_arraylist_get(g_context.dataList, i))
         {
             CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i);
             if (!removedData)
@@ -2560,6 +2653,20 @@ CAResult_t CARemoveBlockDataFromList(const CABlockDataID_t *blockID)
                 return CA_STATUS_FAILED;
             }
 
+            // a later data of the same ID is found from now on
+            for (size_t j = i; j < len - 1; j++)
+            {
+                CABlockData_t *nextData = u_arraylist_get(g_context.dataList, j);
+                if (CABlockidMatches(nextData, currData->blockDataId))
+                {
+                    if (!u_hashmap_put(g_context.dataMap, nextData->blockDataId, nextData))
+                    {
+                        OIC_LOG(ERROR, TAG, "add has failed");
+                    }
+                    break;
+                }
+            }
+
             // destroy memory
             CADestroyDataSet(currData->sentData);
             CADestroyBlockID(currData->blockDataId);
@@ -2586,6 +2693,7 @@ CAResult_t CARemoveAllBlockDataFromList()
         CABlockData_t *removedData = u_arraylist_remove(g_context.dataList, i - 1);
         if (removedData)
         {
+            u_hashmap_remove(g_context.dataMap, removedData->blockDataId);
             // destroy memory
             if (removedData->sentData)
             {
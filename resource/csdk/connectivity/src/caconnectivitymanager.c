@@ -43,7 +43,11 @@
 #endif
 
 CAGlobals_t caglobals = { .clientFlags = 0,
-                          .serverFlags = 0, };
+                          .serverFlags = 0,
+#if !defined(_WIN32)
+                          .ip = { .epollFd = -1 },
+#endif
+                        };
 
 #define TAG "OIC_CA_CONN_MGR"
 
@@ -531,6 +535,31 @@ CAResult_t CAHandleRequestResponse()
     return CA_STATUS_OK;
 }
 
+CAResult_t CAWaitForRequestResponse(uint32_t timeoutMs)
+{
+    if (!g_isInitialized)
+    {
+        OIC_LOG(ERROR, TAG, "not initialized");
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    CAWaitRequestResponseCallbacks(timeoutMs);
+
+    return CA_STATUS_OK;
+}
+
+CAResult_t CAWakeUpRequestResponse()
+{
+    if (!g_isInitialized)
+    {
+        return CA_STATUS_NOT_INITIALIZED;
+    }
+
+    CAWakeUpRequestResponseCallbacks();
+
+    return CA_STATUS_OK;
+}
+
 #if defined (__WITH_DTLS__) || defined(__WITH_TLS__)
 CAResult_t CASelectCipherSuite(const uint16_t cipher, CATransportAdapter_t adapter)
 {
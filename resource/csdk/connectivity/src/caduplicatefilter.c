@@ -0,0 +1,299 @@
+/* *****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include <string.h>
+
+#include "caduplicatefilter.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "oic_time.h"
+#include "logger.h"
+
+#define TAG "OIC_CA_DUPLICATE"
+
+typedef struct
+{
+    CATransportAdapter_t adapter;       /**< transport adapter of the endpoint */
+    uint16_t port;                      /**< port of the endpoint */
+    uint16_t messageId;                 /**< coap PDU message id */
+    uint8_t tokenLength;                /**< length of the token */
+    char token[CA_MAX_TOKEN_LEN];       /**< token of the request */
+    char addr[MAX_ADDR_STR_SIZE_CA];    /**< address of the endpoint */
+} CADuplicateKey_t;
+
+struct CADuplicateEntry_t
+{
+    CADuplicateKey_t key;               /**< key of the entry */
+    uint64_t expireTime;                /**< time to forget the request. microseconds */
+    void *response;                     /**< coap PDU sent for the request */
+    uint32_t size;                      /**< coap PDU size */
+    CADuplicateEntry_t *next;           /**< next newer entry */
+};
+
+static uint32_t CAHashDuplicateKey(const void *key)
+{
+    const CADuplicateKey_t *dupKey = (const CADuplicateKey_t *) key;
+    uint32_t hash = u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, dupKey->addr, strlen(dupKey->addr));
+    hash = u_hashmap_hash_bytes(hash, &dupKey->port, sizeof(dupKey->port));
+    hash = u_hashmap_hash_bytes(hash, &dupKey->messageId, sizeof(dupKey->messageId));
+    hash = u_hashmap_hash_bytes(hash, dupKey->token, dupKey->tokenLength);
+    return u_hashmap_hash_bytes(hash, &dupKey->adapter, sizeof(dupKey->adapter));
+}
+
+static bool CAEqualDuplicateKey(const void *key1, const void *key2)
+{
+    const CADuplicateKey_t *dupKey1 = (const CADuplicateKey_t *) key1;
+    const CADuplicateKey_t *dupKey2 = (const CADuplicateKey_t *) key2;
+    return dupKey1->messageId == dupKey2->messageId
+            && dupKey1->tokenLength == dupKey2->tokenLength
+            && !memcmp(dupKey1->token, dupKey2->token, dupKey1->tokenLength)
+            && dupKey1->port == dupKey2->port
+            && dupKey1->adapter == dupKey2->adapter
+            && !strcmp(dupKey1->addr, dupKey2->addr);
+}
+
+static void CASetDuplicateKey(CADuplicateKey_t *key, const CAEndpoint_t *endpoint,
+                              uint16_t messageId, const CAToken_t token, uint8_t tokenLength)
+{
+    memset(key, 0, sizeof(*key));
+    key->adapter = endpoint->adapter;
+    key->port = endpoint->port;
+    key->messageId = messageId;
+    if (token && tokenLength)
+    {
+        key->tokenLength = tokenLength < CA_MAX_TOKEN_LEN ? tokenLength : CA_MAX_TOKEN_LEN;
+        memcpy(key->token, token, key->tokenLength);
+    }
+    OICStrcpy(key->addr, sizeof(key->addr), endpoint->addr);
+}
+
+/**
+ * Finds the newest remembered request an empty acknowledgement or reset
+ * answers. It carries no token, so only endpoint and message id have to
+ * match. The mutex must be held.
+ */
+static CADuplicateEntry_t *CAFindEmptyResponseEntry(const CADuplicateFilter_t *filter,
+                                                    const CADuplicateKey_t *key)
+{
+    CADuplicateEntry_t *found = NULL;
+    for (CADuplicateEntry_t *entry = filter->oldest; entry; entry = entry->next)
+    {
+        if (entry->key.messageId == key->messageId
+            && entry->key.port == key->port
+            && entry->key.adapter == key->adapter
+            && !strcmp(entry->key.addr, key->addr))
+        {
+            found = entry;
+        }
+    }
+    return found;
+}
+
+/**
+ * Drops the oldest remembered request. The mutex must be held.
+ */
+static void CADropOldestEntry(CADuplicateFilter_t *filter)
+{
+    CADuplicateEntry_t *entry = filter->oldest;
+    filter->oldest = entry->next;
+    if (!filter->oldest)
+    {
+        filter->newest = NULL;
+    }
+    filter->count--;
+
+    u_hashmap_remove(filter->map, &entry->key);
+    OICFree(entry->response);
+    OICFree(entry);
+}
+
+CAResult_t CADuplicateFilterInitialize(CADuplicateFilter_t *filter)
+{
+    if (NULL == filter)
+    {
+        OIC_LOG(ERROR, TAG, "filter is empty");
+        return CA_STATUS_INVALID_PARAM;
+    }
+
+    memset(filter, 0, sizeof(*filter));
+    filter->map = u_hashmap_create(CAHashDuplicateKey, CAEqualDuplicateKey);
+    if (!filter->map)
+    {
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
+    filter->mutex = oc_mutex_new();
+    if (!filter->mutex)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create mutex");
+        u_hashmap_free(&filter->map);
+        return CA_STATUS_FAILED;
+    }
+
+    return CA_STATUS_OK;
+}
+
+bool CADuplicateFilterReceivedRequest(CADuplicateFilter_t *filter,
+                                      const CAEndpoint_t *endpoint,
+                                      uint16_t messageId,
+                                      const CAToken_t token,
+                                      uint8_t tokenLength,
+                                      void **response,
+                                      uint32_t *size)
+{
+    if (NULL == filter || NULL == endpoint || NULL == response || NULL == size)
+    {
+        OIC_LOG(ERROR, TAG, "invalid parameter");
+        return false;
+    }
+
+    *response = NULL;
+    *size = 0;
+
+    if (NULL == filter->map)
+    {
+        return false;
+    }
+
+    CADuplicateKey_t key;
+    CASetDuplicateKey(&key, endpoint, messageId, token, tokenLength);
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+
+    oc_mutex_lock(filter->mutex);
+
+    // Entries expire in the order they were received.
+    while (filter->oldest && filter->oldest->expireTime <= currentTime)
+    {
+        CADropOldestEntry(filter);
+    }
+
+    CADuplicateEntry_t *entry = (CADuplicateEntry_t *) u_hashmap_get(filter->map, &key);
+    if (entry)
+    {
+        if (entry->response)
+        {
+            *response = OICMalloc(entry->size);
+            if (*response)
+            {
+                memcpy(*response, entry->response, entry->size);
+                *size = entry->size;
+            }
+        }
+        oc_mutex_unlock(filter->mutex);
+
+        OIC_LOG_V(INFO, TAG, "duplicate message %u from %s:%u", messageId,
+                  endpoint->addr, endpoint->port);
+        return true;
+    }
+
+    if (CA_DUPLICATE_FILTER_SIZE <= filter->count)
+    {
+        CADropOldestEntry(filter);
+    }
+
+    entry = (CADuplicateEntry_t *) OICCalloc(1, sizeof(CADuplicateEntry_t));
+    if (!entry)
+    {
+        oc_mutex_unlock(filter->mutex);
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        return false;
+    }
+    entry->key = key;
+    entry->expireTime = currentTime + (uint64_t) CA_EXCHANGE_LIFETIME_SEC * 1000000;
+
+    if (!u_hashmap_put(filter->map, &entry->key, entry))
+    {
+        oc_mutex_unlock(filter->mutex);
+        OIC_LOG(ERROR, TAG, "Out of memory");
+        OICFree(entry);
+        return false;
+    }
+
+    if (filter->newest)
+    {
+        filter->newest->next = entry;
+    }
+    else
+    {
+        filter->oldest = entry;
+    }
+    filter->newest = entry;
+    filter->count++;
+
+    oc_mutex_unlock(filter->mutex);
+    return false;
+}
+
+void CADuplicateFilterSentResponse(CADuplicateFilter_t *filter,
+                                   const CAEndpoint_t *endpoint,
+                                   uint16_t messageId,
+                                   const CAToken_t token,
+                                   uint8_t tokenLength,
+                                   const void *pdu,
+                                   uint32_t size)
+{
+    if (NULL == filter || NULL == filter->map || NULL == endpoint || NULL == pdu || 0 == size)
+    {
+        return;
+    }
+
+    CADuplicateKey_t key;
+    CASetDuplicateKey(&key, endpoint, messageId, token, tokenLength);
+
+    oc_mutex_lock(filter->mutex);
+
+    CADuplicateEntry_t *entry = (CADuplicateEntry_t *) u_hashmap_get(filter->map, &key);
+    if (!entry && !key.tokenLength)
+    {
+        // e.g. the empty acknowledgement sent ahead of a separate response
+        entry = CAFindEmptyResponseEntry(filter, &key);
+    }
+    if (entry && !entry->response)
+    {
+        entry->response = OICMalloc(size);
+        if (entry->response)
+        {
+            memcpy(entry->response, pdu, size);
+            entry->size = size;
+        }
+    }
+
+    oc_mutex_unlock(filter->mutex);
+}
+
+void CADuplicateFilterDestroy(CADuplicateFilter_t *filter)
+{
+    if (NULL == filter || NULL == filter->map)
+    {
+        return;
+    }
+
+    oc_mutex_lock(filter->mutex);
+    while (filter->oldest)
+    {
+        CADropOldestEntry(filter);
+    }
+    u_hashmap_free(&filter->map);
+    oc_mutex_unlock(filter->mutex);
+
+    oc_mutex_free(filter->mutex);
+    filter->mutex = NULL;
+}
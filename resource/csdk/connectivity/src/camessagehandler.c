@@ -46,10 +46,14 @@
 #include "uqueue.h"
 #include "cathreadpool.h" /* for thread pool */
 #include "caqueueingthread.h"
+#include "caduplicatefilter.h"
 
 #define SINGLE_HANDLE
 #define MAX_THREAD_POOL_SIZE    20
 
+// messages the send and receive queues hold before they fall back to a locked list
+#define MESSAGE_QUEUE_RING_SIZE 1024
+
 // thread pool handle
 static ca_thread_pool_t g_threadPoolHandle = NULL;
 
@@ -57,6 +61,9 @@ static ca_thread_pool_t g_threadPoolHandle = NULL;
 static CAQueueingThread_t g_sendThread;
 static CAQueueingThread_t g_receiveThread;
 
+// received requests, to answer duplicates
+static CADuplicateFilter_t g_duplicateFilter;
+
 #else
 #define CA_MAX_RT_ARRAY_SIZE    3
 #endif  // SINGLE_THREAD
@@ -89,6 +96,10 @@ static void CADestroyData(void *data, uint32_t size);
 static void CALogPayloadInfo(CAInfo_t *info);
 static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *endpoint, uint16_t id,
                                 CAToken_t token, uint8_t tokenLength);
+#ifndef SINGLE_THREAD
+static bool CAIsDuplicateRequest(const CAEndpoint_t *endpoint, uint16_t id,
+                                 const CAToken_t token, uint8_t tokenLength);
+#endif
 
 #ifdef WITH_BWT
 void CAAddDataToSendThread(CAData_t *data)
@@ -195,6 +206,15 @@ static CAData_t* CAGenerateHandlerData(const CAEndpoint_t *endpoint,
             goto exit;
         }
 
+#ifndef SINGLE_THREAD
+        if (CAIsDuplicateRequest(endpoint, reqInfo->info.messageId,
+                                 reqInfo->info.token, reqInfo->info.tokenLength))
+        {
+            CADestroyRequestInfoInternal(reqInfo);
+            goto exit;
+        }
+#endif
+
         cadata->requestInfo = reqInfo;
         info = &reqInfo->info;
         if (identity)
@@ -420,7 +440,7 @@ static CAResult_t CAProcessMulticastData(const CAData_t *data)
 
     coap_pdu_t *pdu = NULL;
     CAInfo_t *info = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
     CAResult_t res = CA_SEND_FAILED;
 
@@ -450,7 +470,6 @@ static CAResult_t CAProcessMulticastData(const CAData_t *data)
     {
         OIC_LOG(ERROR,TAG,"Failed to generate multicast PDU");
         CASendErrorInfo(data->remoteEndpoint, info, CA_SEND_FAILED);
-        coap_delete_list(options);
         return res;
     }
 
@@ -479,13 +498,11 @@ static CAResult_t CAProcessMulticastData(const CAData_t *data)
         goto exit;
     }
 
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
     return res;
 
 exit:
     CAErrorHandler(data->remoteEndpoint, pdu->transport_hdr, pdu->length, res);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
     return res;
 }
@@ -501,7 +518,7 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
 
     coap_pdu_t *pdu = NULL;
     CAInfo_t *info = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     if (SEND_TYPE_UNICAST == type)
@@ -560,7 +577,6 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
                     {
                         OIC_LOG(INFO, TAG, "to write block option has failed");
                         CAErrorHandler(data->remoteEndpoint, pdu->transport_hdr, pdu->length, res);
-                        coap_delete_list(options);
                         coap_delete_pdu(pdu);
                         return res;
                     }
@@ -575,11 +591,21 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
             {
                 OIC_LOG_V(ERROR, TAG, "send failed:%d", res);
                 CAErrorHandler(data->remoteEndpoint, pdu->transport_hdr, pdu->length, res);
-                coap_delete_list(options);
                 coap_delete_pdu(pdu);
                 return res;
             }
 
+#ifndef SINGLE_THREAD
+            // keep the answer of a request for its duplicates
+            if (NULL != data->responseInfo
+                && (CA_MSG_ACKNOWLEDGE == info->type || CA_MSG_RESET == info->type))
+            {
+                CADuplicateFilterSentResponse(&g_duplicateFilter, data->remoteEndpoint,
+                                              info->messageId, info->token, info->tokenLength,
+                                              pdu->transport_hdr, pdu->length);
+            }
+#endif
+
 #ifdef WITH_TCP
             if (CAIsSupportedCoAPOverTCP(data->remoteEndpoint->adapter))
             {
@@ -600,13 +626,11 @@ static CAResult_t CAProcessSendData(const CAData_t *data)
                 {
                     //when retransmission not supported this will return CA_NOT_SUPPORTED, ignore
                     OIC_LOG_V(INFO, TAG, "retransmission is not enabled due to error, res : %d", res);
-                    coap_delete_list(options);
                     coap_delete_pdu(pdu);
                     return res;
                 }
             }
 
-            coap_delete_list(options);
             coap_delete_pdu(pdu);
         }
         else
@@ -726,6 +750,48 @@ static bool CADropSecondMessage(CAHistory_t *history, const CAEndpoint_t *ep, ui
     return ret;
 }
 
+#ifndef SINGLE_THREAD
+/*
+ * A request that was received before within the exchange lifetime is not
+ * delivered again. If it was answered already, the answer is sent again.
+ */
+static bool CAIsDuplicateRequest(const CAEndpoint_t *endpoint, uint16_t id,
+                                 const CAToken_t token, uint8_t tokenLength)
+{
+#ifdef WITH_TCP
+    // CoAP over TCP has no message ids
+    if (CAIsSupportedCoAPOverTCP(endpoint->adapter))
+    {
+        return false;
+    }
+#endif
+
+    void *response = NULL;
+    uint32_t size = 0;
+    if (!CADuplicateFilterReceivedRequest(&g_duplicateFilter, endpoint, id, token, tokenLength,
+                                          &response, &size))
+    {
+        return false;
+    }
+
+    if (response)
+    {
+        OIC_LOG(DEBUG, TAG, "Duplicate request, send the stored response again");
+        CAResult_t res = CASendUnicastData(endpoint, response, size, CA_RESPONSE_DATA);
+        if (CA_STATUS_OK != res)
+        {
+            OIC_LOG_V(ERROR, TAG, "send failed:%d", res);
+        }
+        OICFree(response);
+    }
+    else
+    {
+        OIC_LOG(DEBUG, TAG, "Duplicate request is not answered yet, Drop it");
+    }
+    return true;
+}
+#endif
+
 static void CAReceivedPacketCallback(const CASecureEndpoint_t *sep,
                                      const void *data, uint32_t dataLen)
 {
@@ -840,19 +906,14 @@ void CAHandleRequestResponseCallbacks()
     // #1 parse the data
     // #2 get endpoint
 
-    oc_mutex_lock(g_receiveThread.threadMutex);
-
-    u_queue_message_t *item = u_queue_get_element(g_receiveThread.dataQueue);
-
-    oc_mutex_unlock(g_receiveThread.threadMutex);
-
-    if (NULL == item || NULL == item->msg)
+    u_queue_message_t item;
+    if (!CAQueueingThreadGetData(&g_receiveThread, &item) || NULL == item.msg)
     {
         return;
     }
 
     // get endpoint
-    CAData_t *td = (CAData_t *) item->msg;
+    CAData_t *td = (CAData_t *) item.msg;
 
     if (td->requestInfo && g_requestHandler)
     {
@@ -870,13 +931,30 @@ void CAHandleRequestResponseCallbacks()
         g_errorHandler(td->remoteEndpoint, td->errorInfo);
     }
 
-    CADestroyData(item->msg, sizeof(CAData_t));
-    OICFree(item);
+    CADestroyData(item.msg, sizeof(CAData_t));
 
 #endif // SINGLE_HANDLE
 #endif // SINGLE_THREAD
 }
 
+void CAWaitRequestResponseCallbacks(uint32_t timeoutMs)
+{
+#if !defined(SINGLE_THREAD) && defined(SINGLE_HANDLE)
+    // The queueing thread is not started in SINGLE_HANDLE mode, so the caller
+    // is the consumer of its queue.
+    CAQueueingThreadWaitData(&g_receiveThread, timeoutMs);
+#else
+    (void) timeoutMs;
+#endif
+}
+
+void CAWakeUpRequestResponseCallbacks()
+{
+#if !defined(SINGLE_THREAD) && defined(SINGLE_HANDLE)
+    CAQueueingThreadWakeUp(&g_receiveThread);
+#endif
+}
+
 static CAData_t* CAPrepareSendData(const CAEndpoint_t *endpoint, const void *sendData,
                                    CADataType_t dataType)
 {
@@ -1033,24 +1111,36 @@ CAResult_t CAInitializeMessageHandler()
 {
     CASetPacketReceivedCallback(CAReceivedPacketCallback);
     CASetErrorHandleCallback(CAErrorHandler);
+    CAInitializeMessageId();
 
 #ifndef SINGLE_THREAD
+    // duplicate filter initialize
+    CAResult_t res = CADuplicateFilterInitialize(&g_duplicateFilter);
+    if (CA_STATUS_OK != res)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to Initialize duplicate filter.");
+        return res;
+    }
+
     // create thread pool
-    CAResult_t res = ca_thread_pool_init(MAX_THREAD_POOL_SIZE, &g_threadPoolHandle);
+    res = ca_thread_pool_init(MAX_THREAD_POOL_SIZE, &g_threadPoolHandle);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "thread pool initialize error.");
+        CADuplicateFilterDestroy(&g_duplicateFilter);
         return res;
     }
 
     // send thread initialize
-    res = CAQueueingThreadInitialize(&g_sendThread, g_threadPoolHandle,
-                                     CASendThreadProcess, CADestroyData);
+    res = CAQueueingThreadInitializeLockFree(&g_sendThread, g_threadPoolHandle,
+                                             CASendThreadProcess, CADestroyData,
+                                             MESSAGE_QUEUE_RING_SIZE);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize send queue thread");
         ca_thread_pool_free(g_threadPoolHandle);
         g_threadPoolHandle = NULL;
+        CADuplicateFilterDestroy(&g_duplicateFilter);
         return res;
     }
 
@@ -1061,18 +1151,21 @@ CAResult_t CAInitializeMessageHandler()
         OIC_LOG(ERROR, TAG, "thread start error(send thread).");
         ca_thread_pool_free(g_threadPoolHandle);
         g_threadPoolHandle = NULL;
+        CADuplicateFilterDestroy(&g_duplicateFilter);
         CAQueueingThreadDestroy(&g_sendThread);
         return res;
     }
 
     // receive thread initialize
-    res = CAQueueingThreadInitialize(&g_receiveThread, g_threadPoolHandle,
-                                     CAReceiveThreadProcess, CADestroyData);
+    res = CAQueueingThreadInitializeLockFree(&g_receiveThread, g_threadPoolHandle,
+                                             CAReceiveThreadProcess, CADestroyData,
+                                             MESSAGE_QUEUE_RING_SIZE);
     if (CA_STATUS_OK != res)
     {
         OIC_LOG(ERROR, TAG, "Failed to Initialize receive queue thread");
         ca_thread_pool_free(g_threadPoolHandle);
         g_threadPoolHandle = NULL;
+        CADuplicateFilterDestroy(&g_duplicateFilter);
         CAQueueingThreadDestroy(&g_sendThread);
         return res;
     }
@@ -1085,6 +1178,7 @@ CAResult_t CAInitializeMessageHandler()
         OIC_LOG(ERROR, TAG, "thread start error(receive thread).");
         ca_thread_pool_free(g_threadPoolHandle);
         g_threadPoolHandle = NULL;
+        CADuplicateFilterDestroy(&g_duplicateFilter);
         CAQueueingThreadDestroy(&g_sendThread);
         CAQueueingThreadDestroy(&g_receiveThread);
         return res;
@@ -1099,6 +1193,7 @@ CAResult_t CAInitializeMessageHandler()
         OIC_LOG(ERROR, TAG, "Failed to Initialize Retransmission.");
         ca_thread_pool_free(g_threadPoolHandle);
         g_threadPoolHandle = NULL;
+        CADuplicateFilterDestroy(&g_duplicateFilter);
         CAQueueingThreadDestroy(&g_sendThread);
         CAQueueingThreadDestroy(&g_receiveThread);
         return res;
@@ -1112,6 +1207,7 @@ CAResult_t CAInitializeMessageHandler()
         OIC_LOG(ERROR, TAG, "Failed to Initialize BlockWiseTransfer.");
         ca_thread_pool_free(g_threadPoolHandle);
         g_threadPoolHandle = NULL;
+        CADuplicateFilterDestroy(&g_duplicateFilter);
         CAQueueingThreadDestroy(&g_sendThread);
         CAQueueingThreadDestroy(&g_receiveThread);
         CARetransmissionDestroy(&g_retransmissionContext);
@@ -1126,6 +1222,7 @@ CAResult_t CAInitializeMessageHandler()
         OIC_LOG(ERROR, TAG, "thread start error(retransmission thread).");
         ca_thread_pool_free(g_threadPoolHandle);
         g_threadPoolHandle = NULL;
+        CADuplicateFilterDestroy(&g_duplicateFilter);
         CAQueueingThreadDestroy(&g_sendThread);
         CAQueueingThreadDestroy(&g_receiveThread);
         CARetransmissionDestroy(&g_retransmissionContext);
@@ -1209,6 +1306,8 @@ void CATerminateMessageHandler()
 
     // terminate interface adapters by controller
     CATerminateAdapters();
+
+    CADuplicateFilterDestroy(&g_duplicateFilter);
 #else
     // terminate interface adapters by controller
     CATerminateAdapters();
@@ -29,6 +29,9 @@
 #define _DEFAULT_SOURCE
 
 #include "iotivity_config.h"
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -47,12 +50,42 @@
 #define TAG "OIC_CA_PRTCL_MSG"
 
 #define CA_PDU_MIN_SIZE (4)
-#define CA_ENCODE_BUFFER_SIZE (4)
 
 static const char COAP_URI_HEADER[] = "coap://[::]/";
 
 static char g_chproxyUri[CA_MAX_URI_LENGTH];
 
+/**
+ * Message ID of the last generated PDU, only the low 16 bits are used.
+ */
+static uint32_t g_lastMessageId = 0;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ATOMIC_INCREMENT(p)     __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+#elif defined(_MSC_VER)
+#define ATOMIC_INCREMENT(p)     ((uint32_t) InterlockedIncrement((volatile LONG *)(p)))
+#else
+#define ATOMIC_INCREMENT(p)     (++*(p))
+#endif
+
+void CAInitializeMessageId()
+{
+    uint16_t seed = 0;
+    OCFillRandomMem((uint8_t *) &seed, sizeof(seed));
+    g_lastMessageId = seed;
+}
+
+static uint16_t CANextMessageId()
+{
+    uint16_t message_id = 0;
+    while (0 == message_id)
+    {
+        // 0 asks for a generated message ID, it is never handed out
+        message_id = (uint16_t) ATOMIC_INCREMENT(&g_lastMessageId);
+    }
+    return message_id;
+}
+
 CAResult_t CASetProxyUri(const char *uri)
 {
     VERIFY_NON_NULL(uri, TAG, "uri");
@@ -98,13 +131,14 @@ CAResult_t CAGetErrorInfoFromPDU(const coap_pdu_t *pdu, const CAEndpoint_t *endp
 }
 
 coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_t *endpoint,
-                          coap_list_t **optlist, coap_transport_t *transport)
+                          CAPDUOptions_t *options, coap_transport_t *transport)
 {
     VERIFY_NON_NULL_RET(info, TAG, "info", NULL);
     VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint", NULL);
-    VERIFY_NON_NULL_RET(optlist, TAG, "optlist", NULL);
+    VERIFY_NON_NULL_RET(options, TAG, "options", NULL);
 
     coap_pdu_t *pdu = NULL;
+    CAInitPDUOptions(options);
 
     // RESET have to use only 4byte (empty message)
     // and ACKNOWLEDGE can use empty message when code is empty.
@@ -140,34 +174,25 @@ coap_pdu_t *CAGeneratePDU(uint32_t code, const CAInfo_t *info, const CAEndpoint_
                 return NULL;
             }
 
-            uint32_t uriLength = length + sizeof(COAP_URI_HEADER);
-            char *coapUri = (char *) OICCalloc(1, uriLength);
-            if (NULL == coapUri)
-            {
-                OIC_LOG(ERROR, TAG, "out of memory");
-                return NULL;
-            }
-            OICStrcat(coapUri, uriLength, COAP_URI_HEADER);
-            OICStrcat(coapUri, uriLength, info->resourceUri);
+            char coapUri[CA_MAX_URI_LENGTH + sizeof(COAP_URI_HEADER)];
+            memcpy(coapUri, COAP_URI_HEADER, sizeof(COAP_URI_HEADER) - 1);
+            memcpy(coapUri + sizeof(COAP_URI_HEADER) - 1, info->resourceUri, length + 1);
 
             // parsing options in URI
-            CAResult_t res = CAParseURI(coapUri, optlist);
+            CAResult_t res = CAParseURI(coapUri, options);
             if (CA_STATUS_OK != res)
             {
-                OICFree(coapUri);
                 return NULL;
             }
-
-            OICFree(coapUri);
         }
         // parsing options in HeadOption
-        CAResult_t ret = CAParseHeadOption(code, info, optlist);
+        CAResult_t ret = CAParseHeadOption(code, info, options);
         if (CA_STATUS_OK != ret)
         {
             return NULL;
         }
 
-        pdu = CAGeneratePDUImpl((code_t) code, info, endpoint, *optlist, transport);
+        pdu = CAGeneratePDUImpl((code_t) code, info, endpoint, options, transport);
         if (NULL == pdu)
         {
             OIC_LOG(ERROR, TAG, "pdu NULL");
@@ -245,7 +270,7 @@ exit:
 }
 
 coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
-                              const CAEndpoint_t *endpoint, coap_list_t *options,
+                              const CAEndpoint_t *endpoint, const CAPDUOptions_t *options,
                               coap_transport_t *transport)
 {
     VERIFY_NON_NULL_RET(info, TAG, "info", NULL);
@@ -260,16 +285,16 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
         if (options)
         {
             unsigned short prevOptNumber = 0;
-            for (coap_list_t *opt = options; opt; opt = opt->next)
+            for (uint8_t i = 0; i < options->count; i++)
             {
-                unsigned short curOptNumber = COAP_OPTION_KEY(*(coap_option *) opt->data);
+                unsigned short curOptNumber = options->options[i].key;
                 if (prevOptNumber > curOptNumber)
                 {
                     OIC_LOG(ERROR, TAG, "option list is wrong");
                     return NULL;
                 }
 
-                size_t optValueLen = COAP_OPTION_LENGTH(*(coap_option *) opt->data);
+                size_t optValueLen = options->options[i].length;
                 size_t optLength = coap_get_opt_header_length(curOptNumber - prevOptNumber, optValueLen);
                 if (0 == optLength)
                 {
@@ -321,8 +346,8 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
         uint16_t message_id = 0;
         if (0 == info->messageId)
         {
-            /* initialize message id */
-            prng((uint8_t * ) &message_id, sizeof(message_id));
+            /* next message id in sequence */
+            message_id = CANextMessageId();
 
             OIC_LOG_V(DEBUG, TAG, "gen msg id=%d", message_id);
         }
@@ -366,15 +391,13 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
 
     if (options)
     {
-        for (coap_list_t *opt = options; opt; opt = opt->next)
+        // options are in order, so they are encoded straight into the pdu.
+        for (uint8_t i = 0; i < options->count; i++)
         {
-            OIC_LOG_V(DEBUG, TAG, "[%s] opt will be added.",
-                      COAP_OPTION_DATA(*(coap_option *) opt->data));
-
-            OIC_LOG_V(DEBUG, TAG, "[%d] pdu length", pdu->length);
-            coap_add_option2(pdu, COAP_OPTION_KEY(*(coap_option *) opt->data),
-                             COAP_OPTION_LENGTH(*(coap_option *) opt->data),
-                             COAP_OPTION_DATA(*(coap_option *) opt->data), *transport);
+            const CAPDUOption_t *opt = &options->options[i];
+            OIC_LOG_V(DEBUG, TAG, "[%d] opt will be added, [%d] pdu length",
+                      opt->key, pdu->length);
+            coap_add_option2(pdu, opt->key, opt->length, opt->data, *transport);
         }
     }
 
@@ -389,10 +412,10 @@ coap_pdu_t *CAGeneratePDUImpl(code_t code, const CAInfo_t *info,
     return pdu;
 }
 
-CAResult_t CAParseURI(const char *uriInfo, coap_list_t **optlist)
+CAResult_t CAParseURI(const char *uriInfo, CAPDUOptions_t *options)
 {
     VERIFY_NON_NULL(uriInfo, TAG, "uriInfo");
-    VERIFY_NON_NULL(optlist, TAG, "optlist");
+    VERIFY_NON_NULL(options, TAG, "options");
 
     OIC_LOG_V(DEBUG, TAG, "url : %s", uriInfo);
 
@@ -403,21 +426,18 @@ CAResult_t CAParseURI(const char *uriInfo, coap_list_t **optlist)
     if (uri.port != COAP_DEFAULT_PORT)
     {
         unsigned char portbuf[CA_ENCODE_BUFFER_SIZE] = { 0 };
-        int ret = coap_insert(optlist,
-                              CACreateNewOptionNode(COAP_OPTION_URI_PORT,
-                                                    coap_encode_var_bytes(portbuf, uri.port),
-                                                    (char *)portbuf),
-                              CAOrderOpts);
-        if (ret <= 0)
+        CAResult_t ret = CAAddPDUOption(options, COAP_OPTION_URI_PORT,
+                                        coap_encode_var_bytes(portbuf, uri.port), portbuf);
+        if (CA_STATUS_OK != ret)
         {
-            return CA_STATUS_INVALID_PARAM;
+            return ret;
         }
     }
 
     if (uri.path.s && uri.path.length)
     {
         CAResult_t ret = CAParseUriPartial(uri.path.s, uri.path.length,
-                                           COAP_OPTION_URI_PATH, optlist);
+                                           COAP_OPTION_URI_PATH, options);
         if (CA_STATUS_OK != ret)
         {
             OIC_LOG(ERROR, TAG, "CAParseUriPartial failed(uri path)");
@@ -428,7 +448,7 @@ CAResult_t CAParseURI(const char *uriInfo, coap_list_t **optlist)
     if (uri.query.s && uri.query.length)
     {
         CAResult_t ret = CAParseUriPartial(uri.query.s, uri.query.length, COAP_OPTION_URI_QUERY,
-                                           optlist);
+                                           options);
         if (CA_STATUS_OK != ret)
         {
             OIC_LOG(ERROR, TAG, "CAParseUriPartial failed(uri query)");
@@ -440,9 +460,9 @@ CAResult_t CAParseURI(const char *uriInfo, coap_list_t **optlist)
 }
 
 CAResult_t CAParseUriPartial(const unsigned char *str, size_t length, int target,
-                             coap_list_t **optlist)
+                             CAPDUOptions_t *options)
 {
-    VERIFY_NON_NULL(optlist, TAG, "optlist");
+    VERIFY_NON_NULL(options, TAG, "options");
 
     if ((target != COAP_OPTION_URI_PATH) && (target != COAP_OPTION_URI_QUERY))
     {
@@ -452,28 +472,31 @@ CAResult_t CAParseUriPartial(const unsigned char *str, size_t length, int target
     }
     else if (str && length)
     {
-        unsigned char uriBuffer[CA_MAX_URI_LENGTH] = { 0 };
-        unsigned char *pBuf = uriBuffer;
-        size_t buflen = sizeof(uriBuffer);
+        // the values are split into the uri storage of the options and stay there.
+        unsigned char *pBuf = options->uri + options->uriLength;
+        size_t buflen = sizeof(options->uri) - options->uriLength;
         int res = (target == COAP_OPTION_URI_PATH) ? coap_split_path(str, length, pBuf, &buflen) :
                                                      coap_split_query(str, length, pBuf, &buflen);
 
         if (res > 0)
         {
+            // coap_split_path returns the size written, coap_split_query the size left.
+            size_t used = (target == COAP_OPTION_URI_PATH) ? buflen :
+                          sizeof(options->uri) - options->uriLength - buflen;
+            options->uriLength += used;
+
             size_t prevIdx = 0;
             while (res--)
             {
-                int ret = coap_insert(optlist,
-                                      CACreateNewOptionNode(target, COAP_OPT_LENGTH(pBuf),
-                                                            (char *)COAP_OPT_VALUE(pBuf)),
-                                      CAOrderOpts);
-                if (ret <= 0)
+                CAResult_t ret = CAAddPDUOption(options, target, COAP_OPT_LENGTH(pBuf),
+                                                COAP_OPT_VALUE(pBuf));
+                if (CA_STATUS_OK != ret)
                 {
-                    return CA_STATUS_INVALID_PARAM;
+                    return ret;
                 }
 
                 size_t optSize = COAP_OPT_SIZE(pBuf);
-                if ((prevIdx + optSize) < buflen)
+                if ((prevIdx + optSize) < used)
                 {
                     pBuf += optSize;
                     prevIdx += optSize;
@@ -495,16 +518,16 @@ CAResult_t CAParseUriPartial(const unsigned char *str, size_t length, int target
     return CA_STATUS_OK;
 }
 
-CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **optlist)
+CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, CAPDUOptions_t *options)
 {
     (void)code;
     VERIFY_NON_NULL_RET(info, TAG, "info", CA_STATUS_INVALID_PARAM);
 
     OIC_LOG_V(DEBUG, TAG, "parse Head Opt: %d", info->numOptions);
 
-    if (!optlist)
+    if (!options)
     {
-        OIC_LOG(ERROR, TAG, "optlist is null");
+        OIC_LOG(ERROR, TAG, "options is null");
         return CA_STATUS_INVALID_PARAM;
     }
 
@@ -526,13 +549,11 @@ CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **
             OIC_LOG_V(DEBUG, TAG, "Head opt ID: %d", id);
             OIC_LOG_V(DEBUG, TAG, "Head opt data: %s", (info->options + i)->optionData);
             OIC_LOG_V(DEBUG, TAG, "Head opt length: %d", (info->options + i)->optionLength);
-            int ret = coap_insert(optlist,
-                                  CACreateNewOptionNode(id, (info->options + i)->optionLength,
-                                                        (info->options + i)->optionData),
-                                  CAOrderOpts);
-            if (ret <= 0)
+            CAResult_t ret = CAAddPDUOption(options, id, (info->options + i)->optionLength,
+                                            (const uint8_t *) (info->options + i)->optionData);
+            if (CA_STATUS_OK != ret)
             {
-                return CA_STATUS_INVALID_PARAM;
+                return ret;
             }
         }
     }
@@ -540,82 +561,74 @@ CAResult_t CAParseHeadOption(uint32_t code, const CAInfo_t *info, coap_list_t **
     // insert one extra header with the payload format if applicable.
     if (CA_FORMAT_UNDEFINED != info->payloadFormat)
     {
-        coap_list_t* node = NULL;
         uint8_t buf[CA_ENCODE_BUFFER_SIZE] = {0};
         switch (info->payloadFormat)
         {
             case CA_FORMAT_APPLICATION_CBOR:
-                node = CACreateNewOptionNode(
-                        COAP_OPTION_CONTENT_FORMAT,
-                        coap_encode_var_bytes(buf, (unsigned short)COAP_MEDIATYPE_APPLICATION_CBOR),
-                        (char *)buf);
                 break;
             default:
                 OIC_LOG_V(ERROR, TAG, "format option:[%d] not supported", info->payloadFormat);
+                OIC_LOG(ERROR, TAG, "format option not created");
+                return CA_STATUS_INVALID_PARAM;
         }
-        if (!node)
-        {
-            OIC_LOG(ERROR, TAG, "format option not created");
-            return CA_STATUS_INVALID_PARAM;
-        }
-        int ret = coap_insert(optlist, node, CAOrderOpts);
-        if (ret <= 0)
+        CAResult_t ret = CAAddPDUOption(options, COAP_OPTION_CONTENT_FORMAT,
+                coap_encode_var_bytes(buf, (unsigned short)COAP_MEDIATYPE_APPLICATION_CBOR), buf);
+        if (CA_STATUS_OK != ret)
         {
-            coap_delete(node);
             OIC_LOG(ERROR, TAG, "format option not inserted in header");
-            return CA_STATUS_INVALID_PARAM;
+            return ret;
         }
     }
     if (CA_FORMAT_UNDEFINED != info->acceptFormat)
     {
-        coap_list_t* node = NULL;
         uint8_t buf[CA_ENCODE_BUFFER_SIZE] = {0};
         switch (info->acceptFormat)
         {
             case CA_FORMAT_APPLICATION_CBOR:
-                node = CACreateNewOptionNode(
-                        COAP_OPTION_ACCEPT,
-                        coap_encode_var_bytes(buf, (unsigned short)COAP_MEDIATYPE_APPLICATION_CBOR),
-                        (char *)buf);
                 break;
             default:
                 OIC_LOG_V(ERROR, TAG, "format option:[%d] not supported", info->acceptFormat);
+                OIC_LOG(ERROR, TAG, "format option not created");
+                return CA_STATUS_INVALID_PARAM;
         }
-        if (!node)
-        {
-            OIC_LOG(ERROR, TAG, "format option not created");
-            return CA_STATUS_INVALID_PARAM;
-        }
-        int ret = coap_insert(optlist, node, CAOrderOpts);
-        if (ret <= 0)
+        CAResult_t ret = CAAddPDUOption(options, COAP_OPTION_ACCEPT,
+                coap_encode_var_bytes(buf, (unsigned short)COAP_MEDIATYPE_APPLICATION_CBOR), buf);
+        if (CA_STATUS_OK != ret)
         {
-            coap_delete(node);
             OIC_LOG(ERROR, TAG, "format option not inserted in header");
-            return CA_STATUS_INVALID_PARAM;
+            return ret;
         }
     }
 
     return CA_STATUS_OK;
 }
 
-coap_list_t *CACreateNewOptionNode(uint16_t key, uint32_t length, const char *data)
+void CAInitPDUOptions(CAPDUOptions_t *options)
 {
-    VERIFY_NON_NULL_RET(data, TAG, "data", NULL);
-
-    coap_option *option = coap_malloc(sizeof(coap_option) + length + 1);
-    if (!option)
+    if (options)
     {
-        OIC_LOG(ERROR, TAG, "Out of memory");
-        return NULL;
+        options->count = 0;
+        options->encodedCount = 0;
+        options->uriLength = 0;
     }
-    memset(option, 0, sizeof(coap_option) + length + 1);
+}
 
-    COAP_OPTION_KEY(*option) = key;
+CAResult_t CAAddPDUOption(CAPDUOptions_t *options, uint16_t key, uint32_t length,
+                          const uint8_t *data)
+{
+    VERIFY_NON_NULL(options, TAG, "options");
+    VERIFY_NON_NULL(data, TAG, "data");
+
+    if (CA_MAX_PDU_OPTIONS <= options->count)
+    {
+        OIC_LOG_V(ERROR, TAG, "too many options, [%d] is not added", key);
+        return CA_STATUS_INVALID_PARAM;
+    }
 
     coap_option_def_t* def = coap_opt_def(key);
     if (NULL != def && coap_is_var_bytes(def))
     {
-       if (length > def->max)
+        if (length > def->max)
         {
             // make sure we shrink the value so it fits the coap option definition
             // by truncating the value, disregard the leading bytes.
@@ -626,42 +639,31 @@ coap_list_t *CACreateNewOptionNode(uint16_t key, uint32_t length, const char *da
         }
         // Shrink the encoding length to a minimum size for coap
         // options that support variable length encoding.
-         COAP_OPTION_LENGTH(*option) = coap_encode_var_bytes(
-                COAP_OPTION_DATA(*option),
-                coap_decode_var_bytes((unsigned char *)data, length));
+        uint8_t *value = options->encoded[options->encodedCount++];
+        length = coap_encode_var_bytes(value, coap_decode_var_bytes((unsigned char *)data, length));
+        data = value;
     }
-    else
+    else if (UINT16_MAX < length)
     {
-        COAP_OPTION_LENGTH(*option) = length;
-        memcpy(COAP_OPTION_DATA(*option), data, length);
-    }
-
-    /* we can pass NULL here as delete function since option is released automatically  */
-    coap_list_t *node = coap_new_listnode(option, NULL);
-
-    if (!node)
-    {
-        OIC_LOG(ERROR, TAG, "node is NULL");
-        coap_free(option);
-        return NULL;
+        OIC_LOG_V(ERROR, TAG, "Option [%d] data size [%d] is too long", key, length);
+        return CA_STATUS_INVALID_PARAM;
     }
 
-    return node;
-}
-
-int CAOrderOpts(void *a, void *b)
-{
-    if (!a || !b)
+    // options mostly come in order, so look for the place from the end.
+    uint8_t index = options->count;
+    while (index > 0 && options->options[index - 1].key > key)
     {
-        return a < b ? -1 : 1;
+        index--;
     }
+    memmove(&options->options[index + 1], &options->options[index],
+            (options->count - index) * sizeof(CAPDUOption_t));
 
-    if (COAP_OPTION_KEY(*(coap_option *) a) < COAP_OPTION_KEY(*(coap_option * ) b))
-    {
-        return -1;
-    }
+    options->options[index].key = key;
+    options->options[index].length = (uint16_t) length;
+    options->options[index].data = data;
+    options->count++;
 
-    return COAP_OPTION_KEY(*(coap_option *) a) == COAP_OPTION_KEY(*(coap_option * ) b);
+    return CA_STATUS_OK;
 }
 
 uint32_t CAGetOptionCount(coap_opt_iterator_t opt_iter)
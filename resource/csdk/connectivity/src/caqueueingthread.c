@@ -31,10 +31,63 @@
 
 #include "caqueueingthread.h"
 #include "oic_malloc.h"
+#include "oic_time.h"
 #include "logger.h"
 
 #define TAG PCF("OIC_CA_QING")
 
+/**
+ * Number of data the queuing thread takes from its queue at once.
+ */
+#define CA_QUEUEING_THREAD_BATCH_SIZE 16
+
+static void CAQueueingThreadDestroyMessage(CAQueueingThread_t *thread,
+                                           u_queue_message_t *message)
+{
+    if (NULL != thread->destroy)
+    {
+        thread->destroy(message->msg, message->size);
+    }
+    else
+    {
+        OICFree(message->msg);
+    }
+}
+
+/**
+ * Take up to count data from the overflow queue. threadMutex must be locked.
+ */
+static uint32_t CAQueueingThreadGetOverflowData(CAQueueingThread_t *thread,
+                                                u_queue_message_t *messages, uint32_t count)
+{
+    uint32_t taken = 0;
+    while (taken < count)
+    {
+        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
+        if (NULL == message)
+        {
+            break;
+        }
+        messages[taken++] = *message;
+        OICFree(message);
+    }
+
+    if (thread->dataRing && 0 == u_queue_get_size(thread->dataQueue))
+    {
+        // Everything that overflowed is handled, the ring may be used again.
+        u_ringqueue_set_closed(thread->dataRing, false);
+    }
+    return taken;
+}
+
+/**
+ * Whether no data is queued. Only the consumer may call it, with threadMutex locked.
+ */
+static bool CAQueueingThreadIsEmpty(CAQueueingThread_t *thread)
+{
+    return u_ringqueue_is_empty(thread->dataRing) && 0 == u_queue_get_size(thread->dataQueue);
+}
+
 static void CAQueueingThreadBaseRoutine(void *threadValue)
 {
     OIC_LOG(DEBUG, TAG, "message handler main thread start..");
@@ -47,53 +100,52 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
         return;
     }
 
+    u_queue_message_t messages[CA_QUEUEING_THREAD_BATCH_SIZE];
+
     while (!thread->isStop)
     {
-        // mutex lock
-        oc_mutex_lock(thread->threadMutex);
-
-        // if queue is empty, thread will wait
-        if (!thread->isStop && u_queue_get_size(thread->dataQueue) <= 0)
+        // The ring is emptied before the overflow queue, which only holds newer data.
+        uint32_t count = u_ringqueue_pop(thread->dataRing, messages,
+                                         CA_QUEUEING_THREAD_BATCH_SIZE);
+        if (0 == count)
         {
-            OIC_LOG(DEBUG, TAG, "wait..");
+            // mutex lock
+            oc_mutex_lock(thread->threadMutex);
 
-            // wait
-            oc_cond_wait(thread->threadCond, thread->threadMutex);
+            count = CAQueueingThreadGetOverflowData(thread, messages,
+                                                    CA_QUEUEING_THREAD_BATCH_SIZE);
 
-            OIC_LOG(DEBUG, TAG, "wake up..");
-        }
+            // if queue is empty, thread will wait
+            if (0 == count)
+            {
+                u_ringqueue_set_waiting(thread->dataRing, true);
+                if (!thread->isStop && CAQueueingThreadIsEmpty(thread))
+                {
+                    OIC_LOG(DEBUG, TAG, "wait..");
+
+                    // wait
+                    oc_cond_wait(thread->threadCond, thread->threadMutex);
+
+                    OIC_LOG(DEBUG, TAG, "wake up..");
+                }
+                u_ringqueue_set_waiting(thread->dataRing, false);
+            }
 
-        // check stop flag
-        if (thread->isStop)
-        {
             // mutex unlock
             oc_mutex_unlock(thread->threadMutex);
-            continue;
         }
 
-        // get data
-        u_queue_message_t *message = u_queue_get_element(thread->dataQueue);
-        // mutex unlock
-        oc_mutex_unlock(thread->threadMutex);
-        if (NULL == message)
+        for (uint32_t i = 0; i < count; i++)
         {
-            continue;
-        }
-
-        // process data
-        thread->threadTask(message->msg);
+            // process data, unless the thread is stopping
+            if (!thread->isStop)
+            {
+                thread->threadTask(messages[i].msg);
+            }
 
-        // free
-        if (NULL != thread->destroy)
-        {
-            thread->destroy(message->msg, message->size);
-        }
-        else
-        {
-            OICFree(message->msg);
+            // free
+            CAQueueingThreadDestroyMessage(thread, &messages[i]);
         }
-
-        OICFree(message);
     }
 
     oc_mutex_lock(thread->threadMutex);
@@ -105,6 +157,15 @@ static void CAQueueingThreadBaseRoutine(void *threadValue)
 
 CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool_t handle,
                                       CAThreadTask task, CADataDestroyFunction destroy)
+{
+    return CAQueueingThreadInitializeLockFree(thread, handle, task, destroy, 0);
+}
+
+CAResult_t CAQueueingThreadInitializeLockFree(CAQueueingThread_t *thread,
+                                              ca_thread_pool_t handle,
+                                              CAThreadTask task,
+                                              CADataDestroyFunction destroy,
+                                              uint32_t ringSize)
 {
     if (NULL == thread)
     {
@@ -128,6 +189,13 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     thread->isStop = true;
     thread->threadTask = task;
     thread->destroy = destroy;
+    thread->dataRing = NULL;
+    thread->wakeUp = false;
+    if (ringSize)
+    {
+        // Without a ring, all data goes through dataQueue.
+        thread->dataRing = u_ringqueue_create(ringSize);
+    }
     if (NULL == thread->dataQueue || NULL == thread->threadMutex || NULL == thread->threadCond)
     {
         goto ERROR_MEM_FAILURE;
@@ -136,6 +204,7 @@ CAResult_t CAQueueingThreadInitialize(CAQueueingThread_t *thread, ca_thread_pool
     return CA_STATUS_OK;
 
 ERROR_MEM_FAILURE:
+    u_ringqueue_free(&thread->dataRing);
     if (thread->dataQueue)
     {
         u_queue_delete(thread->dataQueue);
@@ -205,11 +274,35 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
         return CA_STATUS_INVALID_PARAM;
     }
 
+    if (u_ringqueue_push(thread->dataRing, data, size))
+    {
+        // Only lock when the consumer sleeps.
+        if (u_ringqueue_has_waiter(thread->dataRing))
+        {
+            oc_mutex_lock(thread->threadMutex);
+            oc_cond_signal(thread->threadCond);
+            oc_mutex_unlock(thread->threadMutex);
+        }
+        return CA_STATUS_OK;
+    }
+
+    // mutex lock
+    oc_mutex_lock(thread->threadMutex);
+
+    // The ring may have been emptied and reopened meanwhile.
+    if (u_ringqueue_push(thread->dataRing, data, size))
+    {
+        oc_cond_signal(thread->threadCond);
+        oc_mutex_unlock(thread->threadMutex);
+        return CA_STATUS_OK;
+    }
+
     // create thread data
     u_queue_message_t *message = (u_queue_message_t *) OICMalloc(sizeof(u_queue_message_t));
 
     if (NULL == message)
     {
+        oc_mutex_unlock(thread->threadMutex);
         OIC_LOG(ERROR, TAG, "memory error!!");
         return CA_MEMORY_ALLOC_FAILED;
     }
@@ -217,8 +310,8 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
     message->msg = data;
     message->size = size;
 
-    // mutex lock
-    oc_mutex_lock(thread->threadMutex);
+    // Data added from now on has to queue up behind this one.
+    u_ringqueue_set_closed(thread->dataRing, true);
 
     // add thread data into list
     u_queue_add_element(thread->dataQueue, message);
@@ -232,6 +325,57 @@ CAResult_t CAQueueingThreadAddData(CAQueueingThread_t *thread, void *data, uint3
     return CA_STATUS_OK;
 }
 
+bool CAQueueingThreadGetData(CAQueueingThread_t *thread, u_queue_message_t *message)
+{
+    if (NULL == thread || NULL == message || NULL == thread->threadMutex)
+    {
+        return false;
+    }
+
+    // The lock makes concurrent callers take turns as the single consumer.
+    oc_mutex_lock(thread->threadMutex);
+    uint32_t count = u_ringqueue_pop(thread->dataRing, message, 1);
+    if (0 == count)
+    {
+        count = CAQueueingThreadGetOverflowData(thread, message, 1);
+    }
+    oc_mutex_unlock(thread->threadMutex);
+
+    return 0 < count;
+}
+
+void CAQueueingThreadWaitData(CAQueueingThread_t *thread, uint32_t timeoutMs)
+{
+    if (NULL == thread || NULL == thread->threadMutex || 0 == timeoutMs)
+    {
+        return;
+    }
+
+    oc_mutex_lock(thread->threadMutex);
+    u_ringqueue_set_waiting(thread->dataRing, true);
+    if (!thread->wakeUp && CAQueueingThreadIsEmpty(thread))
+    {
+        oc_cond_wait_for(thread->threadCond, thread->threadMutex,
+                         (uint64_t) timeoutMs * US_PER_MS);
+    }
+    u_ringqueue_set_waiting(thread->dataRing, false);
+    thread->wakeUp = false;
+    oc_mutex_unlock(thread->threadMutex);
+}
+
+void CAQueueingThreadWakeUp(CAQueueingThread_t *thread)
+{
+    if (NULL == thread || NULL == thread->threadMutex)
+    {
+        return;
+    }
+
+    oc_mutex_lock(thread->threadMutex);
+    thread->wakeUp = true;
+    oc_cond_signal(thread->threadCond);
+    oc_mutex_unlock(thread->threadMutex);
+}
+
 CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
 {
     if (NULL == thread)
@@ -246,6 +390,14 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
     thread->threadMutex = NULL;
     oc_cond_free(thread->threadCond);
 
+    // remove all remained ring data.
+    u_queue_message_t ringMessage;
+    while (u_ringqueue_pop(thread->dataRing, &ringMessage, 1))
+    {
+        CAQueueingThreadDestroyMessage(thread, &ringMessage);
+    }
+    u_ringqueue_free(&thread->dataRing);
+
     // remove all remained list data.
     while (u_queue_get_size(thread->dataQueue) > 0)
     {
@@ -255,15 +407,7 @@ CAResult_t CAQueueingThreadDestroy(CAQueueingThread_t *thread)
         // free
         if (NULL != message)
         {
-            if (NULL != thread->destroy)
-            {
-                thread->destroy(message->msg, message->size);
-            }
-            else
-            {
-                OICFree(message->msg);
-            }
-
+            CAQueueingThreadDestroyMessage(thread, message);
             OICFree(message);
         }
     }
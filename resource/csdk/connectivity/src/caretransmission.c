@@ -80,21 +80,26 @@
 
 typedef struct
 {
+    CATransportAdapter_t adapter;       /**< transport adapter of the endpoint */
+    uint16_t messageId;                 /**< coap PDU message id */
+} CARetransmissionKey_t;
+
+typedef struct
+{
+    CARetransmissionKey_t key;          /**< key of the data index */
     uint64_t timeStamp;                 /**< last sent time. microseconds */
+    uint64_t nextTime;                  /**< next retransmission time. microseconds */
+    uint32_t heapIndex;                 /**< position in the data heap */
 #ifndef SINGLE_THREAD
     uint64_t timeout;                   /**< timeout value. microseconds */
 #endif
     uint8_t triedCount;                 /**< retransmission count */
-    uint16_t messageId;                 /**< coap PDU message id */
     CADataType_t dataType;              /**< data Type (Request/Response) */
     CAEndpoint_t *endpoint;             /**< remote endpoint */
     void *pdu;                          /**< coap PDU */
     uint32_t size;                      /**< coap PDU size */
 } CARetransmissionData_t;
 
-static const uint64_t USECS_PER_SEC = 1000000;
-static const uint64_t MSECS_PER_SEC = 1000;
-
 #ifndef SINGLE_THREAD
 /**
  * @brief   timeout value is
@@ -137,36 +142,149 @@ CAResult_t CARetransmissionStart(CARetransmission_t *context)
 #endif
 
 /**
- * @brief   check timeout routine
- * @param   currentTime     [IN]microseconds
+ * @brief   calculate the next retransmission time
  * @param   retData         [IN]retransmission data
- * @return  true if the timeout period has elapsed, false otherwise
+ * @return  microseconds
  */
-static bool CACheckTimeout(uint64_t currentTime, CARetransmissionData_t *retData)
+static uint64_t CAGetNextTime(const CARetransmissionData_t *retData)
 {
 #ifndef SINGLE_THREAD
-    // #1. calculate timeout
     uint32_t milliTimeoutValue = retData->timeout * 0.001;
     uint64_t timeout = (milliTimeoutValue << retData->triedCount) * (uint64_t) 1000;
+#else
+    uint64_t timeout = (2 << retData->triedCount) * (uint64_t) 1000000;
+#endif
+    return retData->timeStamp + timeout;
+}
+
+static uint32_t CAHashRetransmissionKey(const void *key)
+{
+    const CARetransmissionKey_t *retKey = (const CARetransmissionKey_t *) key;
+    uint32_t hash = u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, &retKey->adapter,
+                                         sizeof(retKey->adapter));
+    return u_hashmap_hash_bytes(hash, &retKey->messageId, sizeof(retKey->messageId));
+}
+
+static bool CAEqualRetransmissionKey(const void *key1, const void *key2)
+{
+    const CARetransmissionKey_t *retKey1 = (const CARetransmissionKey_t *) key1;
+    const CARetransmissionKey_t *retKey2 = (const CARetransmissionKey_t *) key2;
+    return (retKey1->messageId == retKey2->messageId) && (retKey1->adapter == retKey2->adapter);
+}
+
+/*
+ * context->dataList is a binary min-heap ordered by nextTime, so the
+ * retransmission thread only looks at data that is due and can sleep until
+ * the earliest next retransmission time. Each data knows its heap position
+ * to be removed in O(log n) when its ACK or RST arrives.
+ */
+static CARetransmissionData_t *CAGetHeapData(CARetransmission_t *context, uint32_t index)
+{
+    return (CARetransmissionData_t *) u_arraylist_get(context->dataList, index);
+}
+
+static void CASwapHeapData(CARetransmission_t *context, uint32_t index1, uint32_t index2)
+{
+    u_arraylist_swap(context->dataList, index1, index2);
+    CAGetHeapData(context, index1)->heapIndex = index1;
+    CAGetHeapData(context, index2)->heapIndex = index2;
+}
 
-    if (currentTime >= retData->timeStamp + timeout)
+static void CASiftUpHeapData(CARetransmission_t *context, uint32_t index)
+{
+    while (index > 0)
     {
-        OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
-                  timeout, retData->triedCount);
-        return true;
+        uint32_t parent = (index - 1) / 2;
+        if (CAGetHeapData(context, parent)->nextTime <= CAGetHeapData(context, index)->nextTime)
+        {
+            break;
+        }
+        CASwapHeapData(context, parent, index);
+        index = parent;
     }
-#else
-    // #1. calculate timeout
-    uint64_t timeOut = (2 << retData->triedCount) * 1000000;
+}
+
+static void CASiftDownHeapData(CARetransmission_t *context, uint32_t index)
+{
+    uint32_t len = u_arraylist_length(context->dataList);
+    for (;;)
+    {
+        uint32_t smallest = index;
+        uint32_t left = 2 * index + 1;
+        uint32_t right = left + 1;
+
+        if (left < len && CAGetHeapData(context, left)->nextTime
+                < CAGetHeapData(context, smallest)->nextTime)
+        {
+            smallest = left;
+        }
+        if (right < len && CAGetHeapData(context, right)->nextTime
+                < CAGetHeapData(context, smallest)->nextTime)
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        CASwapHeapData(context, index, smallest);
+        index = smallest;
+    }
+}
 
-    if (currentTime >= retData->timeStamp + timeOut)
+/**
+ * @brief   add data to the heap and the index. context->threadMutex must be locked.
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ * @return  true if success, false otherwise
+ */
+static bool CAAddRetransmissionData(CARetransmission_t *context, CARetransmissionData_t *retData)
+{
+    if (!u_hashmap_put(context->dataIndex, &retData->key, retData))
     {
-        OIC_LOG_V(DEBUG, TAG, "timeout=%d, tried cnt=%d",
-                  (2 << retData->triedCount), retData->triedCount);
-        return true;
+        return false;
     }
-#endif
-    return false;
+
+    retData->heapIndex = u_arraylist_length(context->dataList);
+    if (!u_arraylist_add(context->dataList, retData))
+    {
+        u_hashmap_remove(context->dataIndex, &retData->key);
+        return false;
+    }
+    CASiftUpHeapData(context, retData->heapIndex);
+    return true;
+}
+
+/**
+ * @brief   remove data from the heap and the index. context->threadMutex must be locked.
+ * @param   context         [IN]context for retransmission
+ * @param   retData         [IN]retransmission data
+ */
+static void CARemoveRetransmissionData(CARetransmission_t *context,
+                                       CARetransmissionData_t *retData)
+{
+    u_hashmap_remove(context->dataIndex, &retData->key);
+
+    uint32_t index = retData->heapIndex;
+    uint32_t last = u_arraylist_length(context->dataList) - 1;
+    if (index != last)
+    {
+        CASwapHeapData(context, index, last);
+    }
+    u_arraylist_remove(context->dataList, last);
+
+    if (index != last)
+    {
+        CASiftDownHeapData(context, index);
+        CASiftUpHeapData(context, index);
+    }
+}
+
+static void CAFreeRetransmissionData(CARetransmissionData_t *retData)
+{
+    CAFreeEndpoint(retData->endpoint);
+    OICFree(retData->pdu);
+    OICFree(retData);
 }
 
 static void CACheckRetransmissionList(CARetransmission_t *context)
@@ -180,65 +298,48 @@ static void CACheckRetransmissionList(CARetransmission_t *context)
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
+    uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
 
-    for (i = 0; i < len; i++)
+    // only the data which is due is visited, earliest first.
+    CARetransmissionData_t *retData = NULL;
+    while (NULL != (retData = CAGetHeapData(context, 0)) && retData->nextTime <= currentTime)
     {
-        CARetransmissionData_t *retData = u_arraylist_get(context->dataList, i);
+        OIC_LOG_V(DEBUG, TAG, "%" PRIu64 " microseconds time out!!, tried count(%d)",
+                  retData->nextTime - retData->timeStamp, retData->triedCount);
 
-        if (NULL == retData)
+        // #1. if time's up, send the data.
+        if (NULL != context->dataSendMethod)
         {
-            continue;
+            OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
+                      retData->key.messageId);
+            context->dataSendMethod(retData->endpoint, retData->pdu,
+                                    retData->size, retData->dataType);
         }
 
-        uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
-
-        if (CACheckTimeout(currentTime, retData))
-        {
-            // #2. if time's up, send the data.
-            if (NULL != context->dataSendMethod)
-            {
-                OIC_LOG_V(DEBUG, TAG, "retransmission CON data!!, msgid=%d",
-                          retData->messageId);
-                context->dataSendMethod(retData->endpoint, retData->pdu,
-                                        retData->size, retData->dataType);
-            }
+        // #2. increase the retransmission count and update timestamp.
+        retData->timeStamp = currentTime;
+        retData->triedCount++;
 
-            // #3. increase the retransmission count and update timestamp.
-            retData->timeStamp = currentTime;
-            retData->triedCount++;
-        }
-
-        // #4. if tried count is max, remove the retransmission data from list.
+        // #3. if tried count is max, remove the retransmission data.
         if (retData->triedCount >= context->config.tryingCount)
         {
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
-            {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
-                // mutex unlock
-                oc_mutex_unlock(context->threadMutex);
-                return;
-            }
+            CARemoveRetransmissionData(context, retData);
             OIC_LOG_V(DEBUG, TAG, "max trying count, remove RTCON data,"
-                      "msgid=%d", removedData->messageId);
+                      "msgid=%d", retData->key.messageId);
 
             // callback for retransmit timeout
             if (NULL != context->timeoutCallback)
             {
-                context->timeoutCallback(removedData->endpoint, removedData->pdu,
-                                         removedData->size);
+                context->timeoutCallback(retData->endpoint, retData->pdu,
+                                         retData->size);
             }
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-
-            OICFree(removedData);
-
-            // modify loop value.
-            len = u_arraylist_length(context->dataList);
-            --i;
+            CAFreeRetransmissionData(retData);
+        }
+        else
+        {
+            retData->nextTime = CAGetNextTime(retData);
+            CASiftDownHeapData(context, 0);
         }
     }
 
@@ -273,7 +374,8 @@ void CARetransmissionBaseRoutine(void *threadValue)
         // mutex lock
         oc_mutex_lock(context->threadMutex);
 
-        if (!context->isStop && u_arraylist_length(context->dataList) <= 0)
+        CARetransmissionData_t *firstData = CAGetHeapData(context, 0);
+        if (!context->isStop && NULL == firstData)
         {
             // if list is empty, thread will wait
             OIC_LOG(DEBUG, TAG, "wait..there is no retransmission data.");
@@ -285,13 +387,16 @@ void CARetransmissionBaseRoutine(void *threadValue)
         }
         else if (!context->isStop)
         {
-            // check each RETRANSMISSION_CHECK_PERIOD_SEC time.
-            OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds",
-                      RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC);
+            // sleep until the earliest retransmission is due.
+            // data which becomes the earliest signals the thread.
+            uint64_t currentTime = OICGetCurrentTime(TIME_IN_US);
+            if (firstData->nextTime > currentTime)
+            {
+                uint64_t waitTime = firstData->nextTime - currentTime;
+                OIC_LOG_V(DEBUG, TAG, "wait..(%" PRIu64 ")microseconds", waitTime);
 
-            // wait
-            uint64_t absTime = RETRANSMISSION_CHECK_PERIOD_SEC * (uint64_t) USECS_PER_SEC;
-            oc_cond_wait_for(context->threadCond, context->threadMutex, absTime );
+                oc_cond_wait_for(context->threadCond, context->threadMutex, waitTime);
+            }
         }
         else
         {
@@ -358,6 +463,15 @@ CAResult_t CARetransmissionInitialize(CARetransmission_t *context,
     context->config = cfg;
     context->isStop = false;
     context->dataList = u_arraylist_create();
+    context->dataIndex = u_hashmap_create(CAHashRetransmissionKey, CAEqualRetransmissionKey);
+
+    if (NULL == context->dataList || NULL == context->dataIndex)
+    {
+        OIC_LOG(ERROR, TAG, "memory error");
+        u_arraylist_free(&context->dataList);
+        u_hashmap_free(&context->dataIndex);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
 
     return CA_STATUS_OK;
 }
@@ -428,54 +542,52 @@ CAResult_t CARetransmissionSentData(CARetransmission_t *context,
     retData->timeout = CAGetTimeoutValue();
 #endif
     retData->triedCount = 0;
-    retData->messageId = messageId;
+    retData->key.adapter = endpoint->adapter;
+    retData->key.messageId = messageId;
     retData->endpoint = remoteEndpoint;
     retData->pdu = pduData;
     retData->size = size;
     retData->dataType = dataType;
-#ifndef SINGLE_THREAD
+    retData->nextTime = CAGetNextTime(retData);
+
     // mutex lock
     oc_mutex_lock(context->threadMutex);
 
-    uint32_t i = 0;
-    uint32_t len = u_arraylist_length(context->dataList);
-
     // #3. add data into list
-    for (i = 0; i < len; i++)
+    if (NULL != u_hashmap_get(context->dataIndex, &retData->key))
     {
-        CARetransmissionData_t *currData = u_arraylist_get(context->dataList, i);
+        OIC_LOG(ERROR, TAG, "Duplicate message ID");
 
-        if (NULL == currData)
-        {
-            continue;
-        }
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-        // found index
-        if (NULL != currData->endpoint && currData->messageId == messageId
-            && (currData->endpoint->adapter == endpoint->adapter))
-        {
-            OIC_LOG(ERROR, TAG, "Duplicate message ID");
+        CAFreeRetransmissionData(retData);
+        return CA_STATUS_FAILED;
+    }
 
-            // mutex unlock
-            oc_mutex_unlock(context->threadMutex);
+    if (!CAAddRetransmissionData(context, retData))
+    {
+        OIC_LOG(ERROR, TAG, "memory error");
 
-            OICFree(retData);
-            OICFree(pduData);
-            OICFree(remoteEndpoint);
-            return CA_STATUS_FAILED;
-        }
-    }
+        // mutex unlock
+        oc_mutex_unlock(context->threadMutex);
 
-    u_arraylist_add(context->dataList, (void *) retData);
+        CAFreeRetransmissionData(retData);
+        return CA_MEMORY_ALLOC_FAILED;
+    }
 
-    // notify the thread
-    oc_cond_signal(context->threadCond);
+#ifndef SINGLE_THREAD
+    // notify the thread if its wait time got shorter
+    if (0 == retData->heapIndex)
+    {
+        oc_cond_signal(context->threadCond);
+    }
 
     // mutex unlock
     oc_mutex_unlock(context->threadMutex);
-
 #else
-    u_arraylist_add(context->dataList, (void *) retData);
+    // mutex unlock
+    oc_mutex_unlock(context->threadMutex);
 
     CACheckRetransmissionList(context);
 #endif
@@ -517,75 +629,40 @@ CAResult_t CARetransmissionReceivedData(CARetransmission_t *context,
 
     // mutex lock
     oc_mutex_lock(context->threadMutex);
-    uint32_t len = u_arraylist_length(context->dataList);
-
-    // find index
-    uint32_t i;
-    for (i = 0; i < len; i++)
-    {
-        CARetransmissionData_t *retData = (CARetransmissionData_t *) u_arraylist_get(
-                context->dataList, i);
 
-        if (NULL == retData)
-        {
-            continue;
-        }
+    // find data
+    CARetransmissionKey_t key = { .adapter = endpoint->adapter, .messageId = messageId };
+    CARetransmissionData_t *retData =
+            (CARetransmissionData_t *) u_hashmap_get(context->dataIndex, &key);
 
-        // found index
-        if (NULL != retData->endpoint && retData->messageId == messageId
-            && (retData->endpoint->adapter == endpoint->adapter))
+    if (NULL != retData)
+    {
+        // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
+        // if retransmission was finish..token will be unavailable.
+        if (CA_EMPTY == code)
         {
-            // get pdu data for getting token when CA_EMPTY(RST/ACK) is received from remote device
-            // if retransmission was finish..token will be unavailable.
-            if (CA_EMPTY == CAGetCodeFromPduBinaryData(pdu, size))
-            {
-                OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
-
-                if (NULL == retData->pdu)
-                {
-                    OIC_LOG(ERROR, TAG, "retData->pdu is null");
-                    OICFree(retData);
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_STATUS_FAILED;
-                }
-
-                // copy PDU data
-                (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
-                if ((*retransmissionPdu) == NULL)
-                {
-                    OICFree(retData);
-                    OIC_LOG(ERROR, TAG, "memory error");
-
-                    // mutex unlock
-                    oc_mutex_unlock(context->threadMutex);
-
-                    return CA_MEMORY_ALLOC_FAILED;
-                }
-                memcpy((*retransmissionPdu), retData->pdu, retData->size);
-            }
+            OIC_LOG(DEBUG, TAG, "code is CA_EMPTY");
 
-            // #2. remove data from list
-            CARetransmissionData_t *removedData = u_arraylist_remove(context->dataList, i);
-            if (NULL == removedData)
+            // copy PDU data
+            (*retransmissionPdu) = (void *) OICCalloc(1, retData->size);
+            if ((*retransmissionPdu) == NULL)
             {
-                OIC_LOG(ERROR, TAG, "Removed data is NULL");
+                OIC_LOG(ERROR, TAG, "memory error");
 
                 // mutex unlock
                 oc_mutex_unlock(context->threadMutex);
 
-                return CA_STATUS_FAILED;
+                return CA_MEMORY_ALLOC_FAILED;
             }
+            memcpy((*retransmissionPdu), retData->pdu, retData->size);
+        }
 
-            OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
+        // #2. remove data from list
+        CARemoveRetransmissionData(context, retData);
 
-            CAFreeEndpoint(removedData->endpoint);
-            OICFree(removedData->pdu);
-            OICFree(removedData);
+        OIC_LOG_V(DEBUG, TAG, "remove RTCON data!!, msgid=%d", messageId);
 
-            break;
-        }
+        CAFreeRetransmissionData(retData);
     }
 
     // mutex unlock
@@ -635,7 +712,15 @@ CAResult_t CARetransmissionDestroy(CARetransmission_t *context)
     oc_mutex_free(context->threadMutex);
     context->threadMutex = NULL;
     oc_cond_free(context->threadCond);
+    context->threadCond = NULL;
+
+    uint32_t len = u_arraylist_length(context->dataList);
+    for (uint32_t i = 0; i < len; i++)
+    {
+        CAFreeRetransmissionData(CAGetHeapData(context, i));
+    }
     u_arraylist_free(&context->dataList);
+    u_hashmap_free(&context->dataIndex);
 
     return CA_STATUS_OK;
 }
@@ -56,6 +56,9 @@
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #endif
+#ifdef WITH_EPOLL
+#include <sys/epoll.h>
+#endif
 
 #include <coap/pdu.h>
 #include "caipinterface.h"
@@ -80,6 +83,10 @@
 
 #define SELECT_TIMEOUT 1     // select() seconds (and termination latency)
 
+#ifdef WITH_EPOLL
+#define EPOLL_MAX_EVENTS 16  // 8 IP sockets + netlink + shutdown pipe, with headroom
+#endif
+
 #define IPv4_MULTICAST     "224.0.1.187"
 static struct in_addr IPv4MulticastAddress = { 0 };
 
@@ -141,6 +148,10 @@ static CAIPPacketReceivedCallback g_packetReceivedCallback = NULL;
 static void CAFindReadyMessage();
 #if !defined(WSA_WAIT_EVENT_0)
 static void CASelectReturned(fd_set *readFds, int ret);
+#ifdef WITH_EPOLL
+static void CAEpollFindReadyMessage();
+static void CAEpollReturned(struct epoll_event *events, int ret);
+#endif
 #else
 static void CAEventReturned(CASocketFd_t socket);
 #endif
@@ -182,6 +193,14 @@ static void CAReceiveHandler(void *data)
 
 static void CAFindReadyMessage()
 {
+#ifdef WITH_EPOLL
+    if (caglobals.ip.epollFd != -1)
+    {
+        CAEpollFindReadyMessage();
+        return;
+    }
+#endif
+
     fd_set readFds;
     struct timeval timeout;
 
@@ -273,6 +292,162 @@ static void CASelectReturned(fd_set *readFds, int ret)
     }
 }
 
+#ifdef WITH_EPOLL
+
+/*
+ * The IP sockets are registered edge-triggered with the fd in the low and the
+ * transport flags in the high 32 bits of the event data. The netlink fd and
+ * the shutdown pipe stay level-triggered since they are read only once per
+ * wakeup.
+ */
+#define EPOLL_DATA(FD, FLAGS) (((uint64_t)(FLAGS) << 32) | (uint32_t)(FD))
+#define EPOLL_DATA_FD(DATA) ((CASocketFd_t)(uint32_t)(DATA))
+#define EPOLL_DATA_FLAGS(DATA) ((CATransportFlags_t)((DATA) >> 32))
+
+#define EPOLL_ADD(TYPE, FLAGS) \
+    if (caglobals.ip.TYPE.fd != OC_INVALID_SOCKET) \
+    { \
+        ret |= CAEpollControl(EPOLL_CTL_ADD, caglobals.ip.TYPE.fd, FLAGS, EPOLLIN | EPOLLET); \
+    }
+
+static int CAEpollControl(int op, int fd, CATransportFlags_t flags, uint32_t events)
+{
+    struct epoll_event event = { .events = events, .data.u64 = EPOLL_DATA(fd, flags) };
+
+    if (-1 == epoll_ctl(caglobals.ip.epollFd, op, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl(%d) for fd %d failed: %s", op, fd, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static void CAInitializeEpoll()
+{
+    if (caglobals.ip.epollFd != -1)
+    {
+        close(caglobals.ip.epollFd);
+    }
+
+    caglobals.ip.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == caglobals.ip.epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed, using select: %s", strerror(errno));
+        return;
+    }
+
+    int ret = 0;
+    EPOLL_ADD(u6,  CA_IPV6)
+    EPOLL_ADD(u6s, CA_IPV6 | CA_SECURE)
+    EPOLL_ADD(u4,  CA_IPV4)
+    EPOLL_ADD(u4s, CA_IPV4 | CA_SECURE)
+    EPOLL_ADD(m6,  CA_MULTICAST | CA_IPV6)
+    EPOLL_ADD(m6s, CA_MULTICAST | CA_IPV6 | CA_SECURE)
+    EPOLL_ADD(m4,  CA_MULTICAST | CA_IPV4)
+    EPOLL_ADD(m4s, CA_MULTICAST | CA_IPV4 | CA_SECURE)
+
+    if (caglobals.ip.shutdownFds[0] != -1)
+    {
+        ret |= CAEpollControl(EPOLL_CTL_ADD, caglobals.ip.shutdownFds[0], CA_DEFAULT_FLAGS, EPOLLIN);
+    }
+    if (caglobals.ip.netlinkFd != OC_INVALID_SOCKET)
+    {
+        ret |= CAEpollControl(EPOLL_CTL_ADD, caglobals.ip.netlinkFd, CA_DEFAULT_FLAGS, EPOLLIN);
+    }
+
+    if (ret)
+    {
+        OIC_LOG(ERROR, TAG, "epoll registration failed, using select");
+        close(caglobals.ip.epollFd);
+        caglobals.ip.epollFd = -1;
+    }
+}
+
+static void CAEpollFindReadyMessage()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    int timeout = caglobals.ip.selectTimeout == -1 ? -1 : caglobals.ip.selectTimeout * 1000;
+
+    int ret = epoll_wait(caglobals.ip.epollFd, events, EPOLL_MAX_EVENTS, timeout);
+
+    if (caglobals.ip.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+
+    if (ret <= 0)
+    {
+        if (ret < 0 && errno != EINTR)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    CAEpollReturned(events, ret);
+}
+
+static void CAEpollReturned(struct epoll_event *events, int ret)
+{
+    CASocketFd_t readyFds[EPOLL_MAX_EVENTS];
+    CATransportFlags_t readyFlags[EPOLL_MAX_EVENTS];
+    int readyCount = 0;
+
+    for (int i = 0; i < ret; i++)
+    {
+        CASocketFd_t fd = EPOLL_DATA_FD(events[i].data.u64);
+
+        if ((caglobals.ip.netlinkFd != OC_INVALID_SOCKET) && (fd == caglobals.ip.netlinkFd))
+        {
+            CAInterface_t *ifchanged = CAFindInterfaceChange();
+            if (ifchanged)
+            {
+                CAProcessNewInterface(ifchanged);
+                OICFree(ifchanged);
+            }
+        }
+        else if (fd == caglobals.ip.shutdownFds[0])
+        {
+            char buf[10] = {0};
+            (void)read(caglobals.ip.shutdownFds[0], buf, sizeof (buf));
+        }
+        else
+        {
+            readyFds[readyCount] = fd;
+            readyFlags[readyCount] = EPOLL_DATA_FLAGS(events[i].data.u64);
+            readyCount++;
+        }
+    }
+
+    // Edge-triggered sockets must be drained until EAGAIN. Take one datagram
+    // from each ready socket per pass so a multicast storm on one socket
+    // cannot starve unicast traffic on the others.
+    while (readyCount > 0 && !caglobals.ip.terminate)
+    {
+        for (int i = 0; i < readyCount && !caglobals.ip.terminate; )
+        {
+            CAResult_t res = CAReceiveMessage(readyFds[i], readyFlags[i]);
+            if (CA_STATUS_OK == res)
+            {
+                i++;
+                continue;
+            }
+            if (CA_RECEIVE_FAILED != res)
+            {
+                // Not drained: re-arm so any queued datagram raises a new edge.
+                (void)CAEpollControl(EPOLL_CTL_MOD, readyFds[i], readyFlags[i],
+                                     EPOLLIN | EPOLLET);
+            }
+            readyCount--;
+            readyFds[i] = readyFds[readyCount];
+            readyFlags[i] = readyFlags[readyCount];
+        }
+    }
+}
+
+#endif // WITH_EPOLL
+
 #else // if defined(WSA_WAIT_EVENT_0)
 
 #define CLOSE_SOCKET(TYPE) \
@@ -480,6 +655,14 @@ void CADeInitializeIPGlobals()
 #endif
         caglobals.ip.netlinkFd = OC_INVALID_SOCKET;
     }
+
+#ifdef WITH_EPOLL
+    if (caglobals.ip.epollFd != -1)
+    {
+        close(caglobals.ip.epollFd);
+        caglobals.ip.epollFd = -1;
+    }
+#endif
 }
 
 static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
@@ -523,7 +706,16 @@ static CAResult_t CAReceiveMessage(CASocketFd_t fd, CATransportFlags_t flags)
                           .msg_control = &cmsg,
                           .msg_controllen = CMSG_SPACE(len) };
 
+#ifdef WITH_EPOLL
+    // Sockets are drained until they run dry, so never block here.
+    ssize_t recvLen = recvmsg(fd, &msg, flags | MSG_DONTWAIT);
+    if (OC_SOCKET_ERROR == recvLen && (EAGAIN == errno || EWOULDBLOCK == errno))
+    {
+        return CA_RECEIVE_FAILED;
+    }
+#else
     ssize_t recvLen = recvmsg(fd, &msg, flags);
+#endif
     if (OC_SOCKET_ERROR == recvLen)
     {
         OIC_LOG_V(ERROR, TAG, "Recvfrom failed %s", strerror(errno));
@@ -928,6 +1120,11 @@ CAResult_t CAIPStartServer(const ca_thread_pool_t threadPool)
     // create source of network interface change notifications
     CAInitializeNetlink();
 
+#ifdef WITH_EPOLL
+    // register all of the above; falls back to select() on failure
+    CAInitializeEpoll();
+#endif
+
     caglobals.ip.selectTimeout = CAGetPollingInterval(caglobals.ip.selectTimeout);
 
     res = CAIPStartListenServer();
@@ -249,6 +249,7 @@ static void CAInitializeTCPGlobals()
     caglobals.tcp.selectTimeout = CA_TCP_SELECT_TIMEOUT;
     caglobals.tcp.listenBacklog = CA_TCP_LISTEN_BACKLOG;
     caglobals.tcp.svrlist = NULL;
+    caglobals.tcp.epollFd = -1;
 
     CATransportFlags_t flags = 0;
     if (caglobals.client)
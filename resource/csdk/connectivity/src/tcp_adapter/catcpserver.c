@@ -30,6 +30,9 @@
 #include <netinet/in.h>
 #include <net/if.h>
 #include <errno.h>
+#ifdef WITH_EPOLL
+#include <sys/epoll.h>
+#endif
 
 #ifndef WITH_ARDUINO
 #include <sys/socket.h>
@@ -41,6 +44,7 @@
 #include "caipnwmonitor.h"
 #include <coap/pdu.h>
 #include "caadapterutils.h"
+#include "uhashmap.h"
 #include "octhread.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
@@ -65,11 +69,24 @@
  */
 #define TLS_HEADER_SIZE 5
 
+#ifdef WITH_EPOLL
+/**
+ * Maximum number of events taken from epoll per wakeup.
+ */
+#define EPOLL_MAX_EVENTS 64
+#endif
+
 /**
  * Mutex to synchronize device object list.
  */
 static oc_mutex g_mutexObjectList = NULL;
 
+/**
+ * Sessions indexed by remote address and port. caglobals.tcp.svrlist
+ * holds the same sessions indexed by file descriptor.
+ */
+static u_hashmap_t *g_sessionsByEndpoint = NULL;
+
 /**
  * Conditional mutex to synchronize.
  */
@@ -98,6 +115,10 @@ static int CACreateAcceptSocket(int family, CASocket_t *sock);
 static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock);
 static void CAFindReadyMessage();
 static void CASelectReturned(fd_set *readFds);
+#ifdef WITH_EPOLL
+static void CAEpollFindReadyMessage();
+static void CAEpollAdd(int fd);
+#endif
 static void CAReceiveMessage(int fd);
 static void CAReceiveHandler(void *data);
 static int CATCPCreateSocket(int family, CATCPSessionInfo_t *tcpServerInfo);
@@ -216,8 +237,59 @@ static void CAReceiveHandler(void *data)
     OIC_LOG(DEBUG, TAG, "OUT - CAReceiveHandler");
 }
 
+/**
+ * Add a session to both session indexes. Must be called with
+ * g_mutexObjectList locked.
+ *
+ * @param[in] svritem - session to add
+ * @return            - true if success, false otherwise
+ */
+static bool CAAddSession(CATCPSessionInfo_t *svritem)
+{
+    if (!u_hashmap_put(caglobals.tcp.svrlist, &svritem->fd, svritem))
+    {
+        return false;
+    }
+    if (!u_hashmap_put(g_sessionsByEndpoint, &svritem->sep.endpoint, svritem))
+    {
+        u_hashmap_remove(caglobals.tcp.svrlist, &svritem->fd);
+        return false;
+    }
+#ifdef WITH_EPOLL
+    CAEpollAdd(svritem->fd);
+#endif
+    return true;
+}
+
+/**
+ * Remove a session from both session indexes. Must be called with
+ * g_mutexObjectList locked.
+ *
+ * @param[in] svritem - session to remove
+ */
+static void CARemoveSession(CATCPSessionInfo_t *svritem)
+{
+    if (u_hashmap_get(caglobals.tcp.svrlist, &svritem->fd) == svritem)
+    {
+        u_hashmap_remove(caglobals.tcp.svrlist, &svritem->fd);
+    }
+    // a newer session to the same endpoint may have replaced this one
+    if (u_hashmap_get(g_sessionsByEndpoint, &svritem->sep.endpoint) == svritem)
+    {
+        u_hashmap_remove(g_sessionsByEndpoint, &svritem->sep.endpoint);
+    }
+}
+
 static void CAFindReadyMessage()
 {
+#ifdef WITH_EPOLL
+    if (-1 != caglobals.tcp.epollFd)
+    {
+        CAEpollFindReadyMessage();
+        return;
+    }
+#endif
+
     fd_set readFds;
     struct timeval timeout = { .tv_sec = caglobals.tcp.selectTimeout };
 
@@ -240,16 +312,17 @@ static void CAFindReadyMessage()
         FD_SET(caglobals.tcp.connectionFds[0], &readFds);
     }
 
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-    for (size_t i = 0; i < length; i++)
+    oc_mutex_lock(g_mutexObjectList);
+    uint32_t iter = 0;
+    CATCPSessionInfo_t *svritem = NULL;
+    while (NULL != (svritem = (CATCPSessionInfo_t *) u_hashmap_next(caglobals.tcp.svrlist, &iter)))
     {
-        CATCPSessionInfo_t *svritem =
-                (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-        if (svritem && 0 <= svritem->fd)
+        if (0 <= svritem->fd)
         {
             FD_SET(svritem->fd, &readFds);
         }
     }
+    oc_mutex_unlock(g_mutexObjectList);
 
     int ret = select(caglobals.tcp.maxfd + 1, &readFds, NULL, NULL, &timeout);
 
@@ -301,23 +374,117 @@ static void CASelectReturned(fd_set *readFds)
     }
     else
     {
-        uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-        for (size_t i = 0; i < length; i++)
+        // collect first, receiving may disconnect sessions and change the index
+        int readyFds[FD_SETSIZE];
+        int readyCount = 0;
+
+        oc_mutex_lock(g_mutexObjectList);
+        uint32_t iter = 0;
+        CATCPSessionInfo_t *svritem = NULL;
+        while (NULL != (svritem = (CATCPSessionInfo_t *) u_hashmap_next(caglobals.tcp.svrlist, &iter)))
         {
-            CATCPSessionInfo_t *svritem =
-                    (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-            if (svritem && svritem->fd >= 0)
+            if (svritem->fd >= 0 && FD_ISSET(svritem->fd, readFds))
             {
-                if (FD_ISSET(svritem->fd, readFds))
-                {
-                    CAReceiveMessage(svritem->fd);
-                    FD_CLR(svritem->fd, readFds);
-                }
+                readyFds[readyCount++] = svritem->fd;
             }
         }
+        oc_mutex_unlock(g_mutexObjectList);
+
+        for (int i = 0; i < readyCount; i++)
+        {
+            CAReceiveMessage(readyFds[i]);
+        }
+    }
+}
+
+#ifdef WITH_EPOLL
+static void CAEpollAdd(int fd)
+{
+    if (-1 == caglobals.tcp.epollFd || 0 > fd)
+    {
+        return;
+    }
+
+    struct epoll_event event = { .events = EPOLLIN, .data.fd = fd };
+    if (-1 == epoll_ctl(caglobals.tcp.epollFd, EPOLL_CTL_ADD, fd, &event))
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_ctl add for fd %d failed: %s", fd, strerror(errno));
     }
 }
 
+static void CAInitializeEpoll()
+{
+    caglobals.tcp.epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == caglobals.tcp.epollFd)
+    {
+        OIC_LOG_V(ERROR, TAG, "epoll_create1 failed, using select: %s", strerror(errno));
+        return;
+    }
+
+    CAEpollAdd(caglobals.tcp.ipv4.fd);
+    CAEpollAdd(caglobals.tcp.ipv6.fd);
+    CAEpollAdd(caglobals.tcp.shutdownFds[0]);
+    CAEpollAdd(caglobals.tcp.connectionFds[0]);
+
+    oc_mutex_lock(g_mutexObjectList);
+    uint32_t iter = 0;
+    CATCPSessionInfo_t *svritem = NULL;
+    while (NULL != (svritem = (CATCPSessionInfo_t *) u_hashmap_next(caglobals.tcp.svrlist, &iter)))
+    {
+        CAEpollAdd(svritem->fd);
+    }
+    oc_mutex_unlock(g_mutexObjectList);
+}
+
+static void CAEpollFindReadyMessage()
+{
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+
+    int ret = epoll_wait(caglobals.tcp.epollFd, events, EPOLL_MAX_EVENTS,
+                         caglobals.tcp.selectTimeout * 1000);
+
+    if (caglobals.tcp.terminate)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Packet receiver Stop request received.");
+        return;
+    }
+    if (0 >= ret)
+    {
+        if (0 > ret && EINTR != errno)
+        {
+            OIC_LOG_V(FATAL, TAG, "epoll_wait error %s", strerror(errno));
+        }
+        return;
+    }
+
+    // Session fds are level-triggered: a partially read message raises the
+    // event again on the next wakeup.
+    for (int i = 0; i < ret && !caglobals.tcp.terminate; i++)
+    {
+        int fd = events[i].data.fd;
+
+        if (fd == caglobals.tcp.ipv4.fd)
+        {
+            CAAcceptConnection(CA_IPV4, &caglobals.tcp.ipv4);
+        }
+        else if (fd == caglobals.tcp.ipv6.fd)
+        {
+            CAAcceptConnection(CA_IPV6, &caglobals.tcp.ipv6);
+        }
+        else if (fd == caglobals.tcp.connectionFds[0])
+        {
+            // sessions are registered when created, just drain the event
+            char buf[MAX_ADDR_STR_SIZE_CA] = {0};
+            (void)read(caglobals.tcp.connectionFds[0], buf, sizeof (buf));
+        }
+        else if (fd != caglobals.tcp.shutdownFds[0])
+        {
+            CAReceiveMessage(fd);
+        }
+    }
+}
+#endif
+
 static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
 {
     VERIFY_NON_NULL_VOID(sock, TAG, "sock is NULL");
@@ -348,10 +515,10 @@ static void CAAcceptConnection(CATransportFlags_t flag, CASocket_t *sock)
                             svritem->sep.endpoint.addr, &svritem->sep.endpoint.port);
 
         oc_mutex_lock(g_mutexObjectList);
-        bool result = u_arraylist_add(caglobals.tcp.svrlist, svritem);
+        bool result = CAAddSession(svritem);
         if (!result)
         {
-            OIC_LOG(ERROR, TAG, "u_arraylist_add failed.");
+            OIC_LOG(ERROR, TAG, "CAAddSession failed.");
             close(sockfd);
             OICFree(svritem);
             oc_mutex_unlock(g_mutexObjectList);
@@ -568,8 +735,7 @@ static void CAReceiveMessage(int fd)
     CAResult_t res = CA_STATUS_OK;
 
     //get remote device information from file descriptor.
-    size_t index = 0;
-    CATCPSessionInfo_t *svritem = CAGetSessionInfoFromFD(fd, &index);
+    CATCPSessionInfo_t *svritem = CAGetSessionInfoFromFD(fd);
     if (!svritem)
     {
         OIC_LOG(ERROR, TAG, "there is no connection information in list");
@@ -596,8 +762,7 @@ static void CAReceiveMessage(int fd)
     //disconnect session and clean-up data if any error occurs
     if (res != CA_STATUS_OK)
     {
-        CADisconnectTCPSession(svritem, index);
-        CACleanData(svritem);
+        CADisconnectTCPSession(svritem);
     }
 }
 
@@ -860,10 +1025,20 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     oc_mutex_lock(g_mutexObjectList);
     if (!caglobals.tcp.svrlist)
     {
-        caglobals.tcp.svrlist = u_arraylist_create();
+        caglobals.tcp.svrlist = u_hashmap_create(u_hashmap_hash_int, u_hashmap_equal_int);
+    }
+    if (!g_sessionsByEndpoint)
+    {
+        g_sessionsByEndpoint = u_hashmap_create(CAHashEndpointAddress, CAEqualEndpointAddress);
     }
     oc_mutex_unlock(g_mutexObjectList);
 
+    if (!caglobals.tcp.svrlist || !g_sessionsByEndpoint)
+    {
+        OIC_LOG(ERROR, TAG, "failed to create session index");
+        return CA_MEMORY_ALLOC_FAILED;
+    }
+
     if (caglobals.server)
     {
         NEWSOCKET(AF_INET, ipv4);
@@ -884,6 +1059,11 @@ CAResult_t CATCPStartServer(const ca_thread_pool_t threadPool)
     CHECKFD(caglobals.tcp.connectionFds[0]);
     CHECKFD(caglobals.tcp.connectionFds[1]);
 
+#ifdef WITH_EPOLL
+    // register all of the above; falls back to select() on failure
+    CAInitializeEpoll();
+#endif
+
     caglobals.tcp.terminate = false;
     res = ca_thread_pool_add_task(threadPool, CAReceiveHandler, NULL);
     if (CA_STATUS_OK != res)
@@ -938,6 +1118,15 @@ void CATCPStopServer()
     }
 
     CATCPDisconnectAll();
+
+#ifdef WITH_EPOLL
+    if (-1 != caglobals.tcp.epollFd)
+    {
+        close(caglobals.tcp.epollFd);
+        caglobals.tcp.epollFd = -1;
+    }
+#endif
+
     CATCPDestroyMutex();
     CATCPDestroyCond();
 }
@@ -992,8 +1181,7 @@ static void sendData(const CAEndpoint_t *endpoint, const void *data,
                      size_t dlen, const char *fam)
 {
     // #1. get TCP Server object from list
-    size_t index = 0;
-    CATCPSessionInfo_t *svritem = CAGetTCPSessionInfoFromEndpoint(endpoint, &index);
+    CATCPSessionInfo_t *svritem = CAGetTCPSessionInfoFromEndpoint(endpoint);
     if (!svritem)
     {
         // if there is no connection info, connect to TCP Server
@@ -1019,7 +1207,7 @@ static void sendData(const CAEndpoint_t *endpoint, const void *data,
         if (!payloadLen)
         {
             OIC_LOG(DEBUG, TAG, "payload length is zero, disconnect from remote device");
-            CADisconnectTCPSession(svritem, index);
+            CADisconnectTCPSession(svritem);
             return;
         }
     }
@@ -1029,7 +1217,7 @@ static void sendData(const CAEndpoint_t *endpoint, const void *data,
     {
         // if file descriptor value is wrong, remove TCP Server info from list
         OIC_LOG(ERROR, TAG, "Failed to connect to TCP server");
-        CADisconnectTCPSession(svritem, index);
+        CADisconnectTCPSession(svritem);
         if (g_tcpErrorHandler)
         {
             g_tcpErrorHandler(endpoint, data, dlen, CA_SEND_FAILED);
@@ -1174,10 +1362,10 @@ CATCPSessionInfo_t *CAConnectTCPSession(const CAEndpoint_t *endpoint)
     oc_mutex_lock(g_mutexObjectList);
     if (caglobals.tcp.svrlist)
     {
-        bool res = u_arraylist_add(caglobals.tcp.svrlist, svritem);
+        bool res = CAAddSession(svritem);
         if (!res)
         {
-            OIC_LOG(ERROR, TAG, "u_arraylist_add failed.");
+            OIC_LOG(ERROR, TAG, "CAAddSession failed.");
             close(svritem->fd);
             OICFree(svritem);
             oc_mutex_unlock(g_mutexObjectList);
@@ -1197,7 +1385,7 @@ CATCPSessionInfo_t *CAConnectTCPSession(const CAEndpoint_t *endpoint)
     return svritem;
 }
 
-CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *svritem, size_t index)
+CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *svritem)
 {
     VERIFY_NON_NULL(svritem, TAG, "svritem is NULL");
 
@@ -1208,11 +1396,11 @@ CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *svritem, size_t index)
 #endif
 
     // close the socket and remove TCP connection info in list
+    CARemoveSession(svritem);
     if (svritem->fd >= 0)
     {
         close(svritem->fd);
     }
-    u_arraylist_remove(caglobals.tcp.svrlist, index);
     OICFree(svritem->data);
     svritem->data = NULL;
 
@@ -1231,13 +1419,12 @@ CAResult_t CADisconnectTCPSession(CATCPSessionInfo_t *svritem, size_t index)
 void CATCPDisconnectAll()
 {
     oc_mutex_lock(g_mutexObjectList);
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
 
+    uint32_t iter = 0;
     CATCPSessionInfo_t *svritem = NULL;
-    for (size_t i = 0; i < length; i++)
+    while (NULL != (svritem = (CATCPSessionInfo_t *) u_hashmap_next(caglobals.tcp.svrlist, &iter)))
     {
-        svritem = (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-        if (svritem && svritem->fd >= 0)
+        if (svritem->fd >= 0)
         {
 #ifdef __WITH_TLS__
             CAcloseTlsConnection(&svritem->sep.endpoint);
@@ -1253,63 +1440,40 @@ void CATCPDisconnectAll()
                 g_connectionCallback(&(svritem->sep.endpoint), false);
             }
         }
+        OICFree(svritem);
     }
-    u_arraylist_destroy(caglobals.tcp.svrlist);
+    u_hashmap_t *sessions = (u_hashmap_t *) caglobals.tcp.svrlist;
+    u_hashmap_free(&sessions);
     caglobals.tcp.svrlist = NULL;
+    u_hashmap_free(&g_sessionsByEndpoint);
     oc_mutex_unlock(g_mutexObjectList);
 }
 
-CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint, size_t *index)
+CATCPSessionInfo_t *CAGetTCPSessionInfoFromEndpoint(const CAEndpoint_t *endpoint)
 {
     VERIFY_NON_NULL_RET(endpoint, TAG, "endpoint is NULL", NULL);
-    VERIFY_NON_NULL_RET(index, TAG, "index is NULL", NULL);
 
-    // get connection info from list
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-    for (size_t i = 0; i < length; i++)
-    {
-        CATCPSessionInfo_t *svritem = (CATCPSessionInfo_t *) u_arraylist_get(
-                caglobals.tcp.svrlist, i);
-        if (!svritem)
-        {
-            continue;
-        }
+    // get connection info from the endpoint index
+    oc_mutex_lock(g_mutexObjectList);
+    CATCPSessionInfo_t *svritem =
+            (CATCPSessionInfo_t *) u_hashmap_get(g_sessionsByEndpoint, endpoint);
+    oc_mutex_unlock(g_mutexObjectList);
 
-        if (!strncmp(svritem->sep.endpoint.addr, endpoint->addr,
-                     sizeof(svritem->sep.endpoint.addr))
-                && (svritem->sep.endpoint.port == endpoint->port)
-                && (svritem->sep.endpoint.flags & endpoint->flags))
-        {
-            *index = i;
-            return svritem;
-        }
+    if (svritem && (svritem->sep.endpoint.flags & endpoint->flags))
+    {
+        return svritem;
     }
 
     return NULL;
 }
 
-CATCPSessionInfo_t *CAGetSessionInfoFromFD(int fd, size_t *index)
+CATCPSessionInfo_t *CAGetSessionInfoFromFD(int fd)
 {
     oc_mutex_lock(g_mutexObjectList);
-
-    // check from the last item.
-    CATCPSessionInfo_t *svritem = NULL;
-    uint32_t length = u_arraylist_length(caglobals.tcp.svrlist);
-    for (size_t i = 0; i < length; i++)
-    {
-        svritem = (CATCPSessionInfo_t *) u_arraylist_get(caglobals.tcp.svrlist, i);
-
-        if (svritem && svritem->fd == fd)
-        {
-            *index = i;
-            oc_mutex_unlock(g_mutexObjectList);
-            return svritem;
-        }
-    }
-
+    CATCPSessionInfo_t *svritem = (CATCPSessionInfo_t *) u_hashmap_get(caglobals.tcp.svrlist, &fd);
     oc_mutex_unlock(g_mutexObjectList);
 
-    return NULL;
+    return svritem;
 }
 
 size_t CAGetTotalLengthFromHeader(const unsigned char *recvBuffer)
@@ -24,8 +24,19 @@
 #include "cacommon.h"
 #include "caprotocolmessage.h"
 #include "cablockwisetransfer.h"
+#include "oic_malloc.h"
+
+#if !defined(_WIN32)
+#include <chrono>
+#include <iostream>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #define LARGE_PAYLOAD_LENGTH    1024
+#define TRANSFER_PAYLOAD_LENGTH (1024 * 1024)
 
 class CABlockTransferTests : public testing::Test {
     protected:
@@ -46,7 +57,7 @@ TEST_F(CABlockTransferTests, CACreateNewDataSetTest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -85,7 +96,6 @@ TEST_F(CABlockTransferTests, CACreateNewDataSetTest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -99,7 +109,7 @@ TEST_F(CABlockTransferTests, CARemoveBlockDataFromListWithSeed)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -136,7 +146,6 @@ TEST_F(CABlockTransferTests, CARemoveBlockDataFromListWithSeed)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -150,7 +159,7 @@ TEST_F(CABlockTransferTests, CAGetBlockDataFromBlockDataListTest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -179,7 +188,6 @@ TEST_F(CABlockTransferTests, CAGetBlockDataFromBlockDataListTest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -187,13 +195,59 @@ TEST_F(CABlockTransferTests, CAGetBlockDataFromBlockDataListTest)
     free(requestData.payload);
 }
 
+TEST_F(CABlockTransferTests, CAGetBlockDataFromBlockDataListWithSameID)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    coap_pdu_t *pdu = NULL;
+    CAPDUOptions_t options;
+    coap_transport_t transport = COAP_UDP;
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.type = CA_MSG_NONCONFIRM;
+
+    pdu = CAGeneratePDU(CA_GET, &requestData, tempRep, &options, &transport);
+
+    CAData_t *cadata = CACreateNewDataSet(pdu, tempRep);
+    EXPECT_TRUE(cadata != NULL);
+
+    CABlockData_t *firstData = CACreateNewBlockData(cadata);
+    EXPECT_TRUE(firstData != NULL);
+    CABlockData_t *secondData = CACreateNewBlockData(cadata);
+    EXPECT_TRUE(secondData != NULL);
+
+    if (firstData && secondData)
+    {
+        // the first data of an ID is found until it is removed
+        EXPECT_EQ(firstData, CAGetBlockDataFromBlockDataList(secondData->blockDataId));
+
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(firstData->blockDataId));
+        EXPECT_EQ(secondData, CAGetBlockDataFromBlockDataList(secondData->blockDataId));
+
+        EXPECT_EQ(CA_STATUS_OK, CARemoveBlockDataFromList(secondData->blockDataId));
+    }
+
+    CADestroyDataSet(cadata);
+    coap_delete_pdu(pdu);
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
 TEST_F(CABlockTransferTests, CAGetPayloadFromBlockDataListTest)
 {
     CAEndpoint_t* tempRep = NULL;
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -226,7 +280,6 @@ TEST_F(CABlockTransferTests, CAGetPayloadFromBlockDataListTest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -234,6 +287,75 @@ TEST_F(CABlockTransferTests, CAGetPayloadFromBlockDataListTest)
     free(requestData.payload);
 }
 
+TEST_F(CABlockTransferTests, CATakePayloadFromBlockDataListTest)
+{
+    CAEndpoint_t* tempRep = NULL;
+    CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
+
+    CAToken_t tempToken = NULL;
+    CAGenerateToken(&tempToken, CA_MAX_TOKEN_LEN);
+
+    CAPayload_t blockPayload = (CAPayload_t) "0123456789abcdef";
+    size_t blockPayloadLen = strlen((const char*) blockPayload);
+
+    CAInfo_t requestData;
+    memset(&requestData, 0, sizeof(CAInfo_t));
+    requestData.type = CA_MSG_NONCONFIRM;
+    requestData.token = tempToken;
+    requestData.tokenLength = CA_MAX_TOKEN_LEN;
+    requestData.payload = blockPayload;
+    requestData.payloadSize = blockPayloadLen;
+
+    CARequestInfo_t requestInfo;
+    memset(&requestInfo, 0, sizeof(CARequestInfo_t));
+    requestInfo.method = CA_POST;
+    requestInfo.info = requestData;
+
+    CAData_t cadata;
+    memset(&cadata, 0, sizeof(CAData_t));
+    cadata.type = SEND_TYPE_UNICAST;
+    cadata.remoteEndpoint = tempRep;
+    cadata.requestInfo = &requestInfo;
+    cadata.dataType = CA_REQUEST_DATA;
+
+    CABlockData_t *currData = CACreateNewBlockData(&cadata);
+    EXPECT_TRUE(currData != NULL);
+
+    if (currData)
+    {
+        EXPECT_TRUE(currData == CAGetBlockDataFromBlockDataList(currData->blockDataId));
+
+        for (int i = 0; i < 3; i++)
+        {
+            EXPECT_EQ(CA_STATUS_OK, CAUpdatePayloadData(currData, &cadata, CA_BLOCK_UNKNOWN,
+                                                         false, COAP_OPTION_BLOCK1));
+        }
+
+        size_t fullPayloadLen = 0;
+        CAPayload_t payload = CATakePayloadFromBlockDataList(currData->blockDataId,
+                                                             &fullPayloadLen);
+        ASSERT_TRUE(payload != NULL);
+        EXPECT_EQ(3 * blockPayloadLen, fullPayloadLen);
+        for (int i = 0; i < 3; i++)
+        {
+            EXPECT_EQ(0, memcmp(payload + i * blockPayloadLen, blockPayload, blockPayloadLen));
+        }
+        OICFree(payload);
+
+        EXPECT_TRUE(NULL == CAGetPayloadFromBlockDataList(currData->blockDataId,
+                                                          &fullPayloadLen));
+
+        CABlockDataID_t *blockDataId = CACreateBlockDatablockId(tempToken, CA_MAX_TOKEN_LEN,
+                                                                tempRep->port);
+        CARemoveBlockDataFromList(blockDataId);
+        EXPECT_TRUE(NULL == CAGetBlockDataFromBlockDataList(blockDataId));
+        CADestroyBlockID(blockDataId);
+    }
+
+    CADestroyToken(tempToken);
+    CADestroyEndpoint(tempRep);
+}
+
 // request and block option1
 TEST_F(CABlockTransferTests, CAAddBlockOptionTest)
 {
@@ -241,7 +363,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOptionTest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -266,7 +388,6 @@ TEST_F(CABlockTransferTests, CAAddBlockOptionTest)
 
     EXPECT_EQ(CA_STATUS_OK, CAAddBlockOption(&pdu, &requestData, tempRep, &options));
 
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -281,7 +402,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOption1InRequest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -321,7 +442,6 @@ TEST_F(CABlockTransferTests, CAAddBlockOption1InRequest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -336,7 +456,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOption1InResponse)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -377,7 +497,6 @@ TEST_F(CABlockTransferTests, CAAddBlockOption1InResponse)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -392,7 +511,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOption2InResponse)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -433,7 +552,6 @@ TEST_F(CABlockTransferTests, CAAddBlockOption2InResponse)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -448,7 +566,7 @@ TEST_F(CABlockTransferTests, CAAddBlockOption2InRequest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -488,7 +606,6 @@ TEST_F(CABlockTransferTests, CAAddBlockOption2InRequest)
     }
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -502,7 +619,7 @@ TEST_F(CABlockTransferTests, CAGetBlockSizeOptionFromPduTest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -520,7 +637,6 @@ TEST_F(CABlockTransferTests, CAGetBlockSizeOptionFromPduTest)
     EXPECT_FALSE(CAIsPayloadLengthInPduWithBlockSizeOption(pdu, COAP_OPTION_SIZE1,
                                                            &totalPayloadLen));
 
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -534,7 +650,7 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption1WithRequest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -558,7 +674,6 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption1WithRequest)
     EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption1(pdu, tempRep, cadata, block, pdu->length));
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -572,7 +687,7 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption1WithResponse)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -597,7 +712,6 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption1WithResponse)
     EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption1(pdu, tempRep, cadata, block, pdu->length));
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -611,7 +725,7 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption2WithRequest)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -635,7 +749,6 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption2WithRequest)
     EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption2(pdu, tempRep, cadata, block, pdu->length));
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -649,7 +762,7 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption2WithResponse)
     CACreateEndpoint(CA_DEFAULT_FLAGS, CA_ADAPTER_IP, "127.0.0.1", 5683, &tempRep);
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAToken_t tempToken = NULL;
@@ -674,7 +787,6 @@ TEST_F(CABlockTransferTests, CASetNextBlockOption2WithResponse)
     EXPECT_EQ(CA_STATUS_OK, CASetNextBlockOption2(pdu, tempRep, cadata, block, pdu->length));
 
     CADestroyDataSet(cadata);
-    coap_delete_list(options);
     coap_delete_pdu(pdu);
 
     CADestroyToken(tempToken);
@@ -750,3 +862,210 @@ TEST_F(CABlockTransferTests, CAUpdatePayloadToCADataWithResponse)
 
     EXPECT_STREQ((const char*) payload, (const char*) cadata.responseInfo->info.payload);
 }
+
+#if !defined(_WIN32)
+// The loopback benchmark forks a second CA instance.
+static uint8_t *g_transferPayload = NULL;
+static bool g_transferDone = false;
+static size_t g_transferReceived = 0;
+
+/**
+ * Answers a GET with the whole transfer payload and any other request
+ * with 2.04 Changed, after checking the payload the request carried.
+ */
+static void transferRequestHandler(const CAEndpoint_t *endpoint, const CARequestInfo_t *requestInfo)
+{
+    if (requestInfo->info.payloadSize &&
+        (TRANSFER_PAYLOAD_LENGTH != requestInfo->info.payloadSize ||
+         memcmp(g_transferPayload, requestInfo->info.payload, TRANSFER_PAYLOAD_LENGTH)))
+    {
+        return;
+    }
+    g_transferReceived = requestInfo->info.payloadSize;
+
+    CAResponseInfo_t responseInfo;
+    memset(&responseInfo, 0, sizeof(CAResponseInfo_t));
+    responseInfo.result = (CA_GET == requestInfo->method) ? CA_CONTENT : CA_CHANGED;
+    responseInfo.info.type = (CA_MSG_CONFIRM == requestInfo->info.type) ?
+                             CA_MSG_ACKNOWLEDGE : CA_MSG_NONCONFIRM;
+    responseInfo.info.messageId = requestInfo->info.messageId;
+    responseInfo.info.dataType = CA_RESPONSE_DATA;
+    responseInfo.info.token = requestInfo->info.token;
+    responseInfo.info.tokenLength = requestInfo->info.tokenLength;
+    responseInfo.info.resourceUri = requestInfo->info.resourceUri;
+    if (CA_GET == requestInfo->method)
+    {
+        responseInfo.info.payload = g_transferPayload;
+        responseInfo.info.payloadSize = TRANSFER_PAYLOAD_LENGTH;
+        responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+    }
+    CASendResponse(endpoint, &responseInfo);
+}
+
+static void transferResponseHandler(const CAEndpoint_t *endpoint,
+                                    const CAResponseInfo_t *responseInfo)
+{
+    (void)endpoint;
+    if (CA_CHANGED != responseInfo->result &&
+        (CA_CONTENT != responseInfo->result ||
+         TRANSFER_PAYLOAD_LENGTH != responseInfo->info.payloadSize ||
+         memcmp(g_transferPayload, responseInfo->info.payload, TRANSFER_PAYLOAD_LENGTH)))
+    {
+        return;
+    }
+    if (responseInfo->info.payloadSize)
+    {
+        g_transferReceived = responseInfo->info.payloadSize;
+    }
+    g_transferDone = true;
+}
+
+static void transferErrorHandler(const CAEndpoint_t *endpoint, const CAErrorInfo_t *errorInfo)
+{
+    (void)endpoint;
+    (void)errorInfo;
+}
+
+/**
+ * Returns the unicast IPv4 port of the IP adapter, 0 if it has none.
+ */
+static uint16_t unicastPort()
+{
+    CAEndpoint_t *interfaces = NULL;
+    uint32_t size = 0;
+    uint16_t port = 0;
+    if (CA_STATUS_OK == CAGetNetworkInformation(&interfaces, &size))
+    {
+        for (uint32_t i = 0; i < size && !port; i++)
+        {
+            if (CA_ADAPTER_IP == interfaces[i].adapter && (interfaces[i].flags & CA_IPV4))
+            {
+                port = interfaces[i].port;
+            }
+        }
+    }
+    OICFree(interfaces);
+    return port;
+}
+
+/**
+ * Serves transfers from a forked process, a second CA instance, so that the
+ * block data of the client and of the server are kept apart. Writes the
+ * unicast port to @p portPipe and handles requests until it is killed.
+ */
+static void serveTransfers(int portPipe)
+{
+    uint16_t port = 0;
+    if (CA_STATUS_OK == CAInitialize())
+    {
+        CARegisterHandler(transferRequestHandler, transferResponseHandler, transferErrorHandler);
+        if (CA_STATUS_OK == CASelectNetwork(CA_ADAPTER_IP) &&
+            CA_STATUS_OK == CAStartListeningServer())
+        {
+            port = unicastPort();
+        }
+    }
+    if (sizeof(port) != write(portPipe, &port, sizeof(port)) || !port)
+    {
+        _exit(1);
+    }
+    for (;;)
+    {
+        CAHandleRequestResponse();
+        usleep(1000);
+    }
+}
+
+/**
+ * Sends a request to @p port on the loopback address and handles messages
+ * until the response arrives. Returns the time it took in milliseconds, or
+ * a negative value if no response came.
+ */
+static double transferLoopback(uint16_t port, CAMethod_t method, CAPayload_t payload,
+                               size_t payloadSize)
+{
+    CAEndpoint_t *endpoint = NULL;
+    EXPECT_EQ(CA_STATUS_OK, CACreateEndpoint(CA_IPV4, CA_ADAPTER_IP, "127.0.0.1", port,
+                                             &endpoint));
+    CAToken_t token = NULL;
+    EXPECT_EQ(CA_STATUS_OK, CAGenerateToken(&token, CA_MAX_TOKEN_LEN));
+
+    CARequestInfo_t requestInfo;
+    memset(&requestInfo, 0, sizeof(CARequestInfo_t));
+    requestInfo.method = method;
+    requestInfo.info.type = CA_MSG_CONFIRM;
+    requestInfo.info.dataType = CA_REQUEST_DATA;
+    requestInfo.info.token = token;
+    requestInfo.info.tokenLength = CA_MAX_TOKEN_LEN;
+    requestInfo.info.resourceUri = (CAURI_t)"/a/transfer";
+    requestInfo.info.payload = payload;
+    requestInfo.info.payloadSize = payloadSize;
+    requestInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+
+    g_transferDone = false;
+    g_transferReceived = 0;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(CA_STATUS_OK, CASendRequest(endpoint, &requestInfo));
+    while (!g_transferDone && std::chrono::steady_clock::now() - start < std::chrono::seconds(30))
+    {
+        CAHandleRequestResponse();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    CADestroyToken(token);
+    CADestroyEndpoint(endpoint);
+    return g_transferDone ? std::chrono::duration<double, std::milli>(elapsed).count() : -1;
+}
+
+// Measures a 1 MiB request sent in Block1 blocks and a 1 MiB response
+// received in Block2 blocks between two CA instances over loopback.
+TEST(CABlockTransferLoopbackTests, TransferBenchmark)
+{
+    g_transferPayload = (uint8_t *)OICMalloc(TRANSFER_PAYLOAD_LENGTH);
+    ASSERT_TRUE(g_transferPayload != NULL);
+    for (size_t i = 0; i < TRANSFER_PAYLOAD_LENGTH; i++)
+    {
+        g_transferPayload[i] = (uint8_t)(i * 31 + (i >> 10));
+    }
+
+    int portPipe[2];
+    ASSERT_EQ(0, pipe(portPipe));
+    pid_t server = fork();
+    ASSERT_LE(0, server);
+    if (0 == server)
+    {
+        close(portPipe[0]);
+        serveTransfers(portPipe[1]);
+    }
+    close(portPipe[1]);
+    uint16_t port = 0;
+    EXPECT_EQ((ssize_t)sizeof(port), read(portPipe[0], &port, sizeof(port)));
+    close(portPipe[0]);
+
+    double block1 = -1;
+    double block2 = -1;
+    size_t block2Received = 0;
+    if (port && CA_STATUS_OK == CAInitialize())
+    {
+        CARegisterHandler(transferRequestHandler, transferResponseHandler, transferErrorHandler);
+        EXPECT_EQ(CA_STATUS_OK, CASelectNetwork(CA_ADAPTER_IP));
+        EXPECT_EQ(CA_STATUS_OK, CAStartListeningServer());
+
+        block1 = transferLoopback(port, CA_POST, g_transferPayload, TRANSFER_PAYLOAD_LENGTH);
+        block2 = transferLoopback(port, CA_GET, NULL, 0);
+        block2Received = g_transferReceived;
+        CATerminate();
+    }
+    kill(server, SIGKILL);
+    waitpid(server, NULL, 0);
+    OICFree(g_transferPayload);
+    g_transferPayload = NULL;
+
+    // The server checks the Block1 payload and answers only a complete one.
+    EXPECT_LT(0, block1);
+    EXPECT_LT(0, block2);
+    EXPECT_EQ((size_t)TRANSFER_PAYLOAD_LENGTH, block2Received);
+    std::cout << "1 MiB Block1 request: " << block1 << " ms, 1 MiB Block2 response: "
+              << block2 << " ms" << std::endl;
+}
+#endif
@@ -0,0 +1,159 @@
+/* *****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+#include "cacommon.h"
+#include "caduplicatefilter.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+
+class CADuplicateFilterTests : public testing::Test {
+    protected:
+    virtual void SetUp()
+    {
+        ASSERT_EQ(CA_STATUS_OK, CADuplicateFilterInitialize(&filter));
+
+        memset(&endpoint, 0, sizeof(endpoint));
+        endpoint.adapter = CA_ADAPTER_IP;
+        endpoint.port = 5683;
+        OICStrcpy(endpoint.addr, sizeof(endpoint.addr), "192.168.1.1");
+    }
+
+    virtual void TearDown()
+    {
+        CADuplicateFilterDestroy(&filter);
+    }
+
+    bool Received(const CAEndpoint_t *ep, uint16_t messageId, const char *token = "tok1")
+    {
+        void *response = NULL;
+        uint32_t size = 0;
+        bool duplicate = CADuplicateFilterReceivedRequest(&filter, ep, messageId,
+                                                          (CAToken_t) token, strlen(token),
+                                                          &response, &size);
+        OICFree(response);
+        return duplicate;
+    }
+
+    CADuplicateFilter_t filter;
+    CAEndpoint_t endpoint;
+};
+
+TEST_F(CADuplicateFilterTests, DetectsDuplicate)
+{
+    EXPECT_FALSE(Received(&endpoint, 1));
+    EXPECT_TRUE(Received(&endpoint, 1));
+    EXPECT_FALSE(Received(&endpoint, 2));
+}
+
+TEST_F(CADuplicateFilterTests, KeyedByEndpoint)
+{
+    EXPECT_FALSE(Received(&endpoint, 1));
+
+    CAEndpoint_t other = endpoint;
+    other.port = 5684;
+    EXPECT_FALSE(Received(&other, 1));
+
+    other = endpoint;
+    OICStrcpy(other.addr, sizeof(other.addr), "192.168.1.2");
+    EXPECT_FALSE(Received(&other, 1));
+
+    other = endpoint;
+    other.adapter = CA_ADAPTER_GATT_BTLE;
+    EXPECT_FALSE(Received(&other, 1));
+}
+
+TEST_F(CADuplicateFilterTests, KeyedByToken)
+{
+    // Different requests may get the same random message id.
+    EXPECT_FALSE(Received(&endpoint, 1, "tok1"));
+    EXPECT_FALSE(Received(&endpoint, 1, "tok2"));
+    EXPECT_FALSE(Received(&endpoint, 1, "tok12"));
+    EXPECT_FALSE(Received(&endpoint, 1, ""));
+    EXPECT_TRUE(Received(&endpoint, 1, "tok2"));
+    EXPECT_TRUE(Received(&endpoint, 1, ""));
+}
+
+TEST_F(CADuplicateFilterTests, ReturnsStoredResponse)
+{
+    const char ack[] = { 0x60, 0x45, 0x00, 0x07 };
+
+    char token[] = "tok1";
+
+    // A response for a request that was not received is not stored.
+    CADuplicateFilterSentResponse(&filter, &endpoint, 7, token, 4, ack, sizeof(ack));
+
+    EXPECT_FALSE(Received(&endpoint, 7));
+    CADuplicateFilterSentResponse(&filter, &endpoint, 7, token, 4, ack, sizeof(ack));
+
+    void *response = NULL;
+    uint32_t size = 0;
+    EXPECT_TRUE(CADuplicateFilterReceivedRequest(&filter, &endpoint, 7, token, 4,
+                                                 &response, &size));
+    ASSERT_TRUE(response != NULL);
+    EXPECT_EQ(sizeof(ack), size);
+    EXPECT_EQ(0, memcmp(ack, response, sizeof(ack)));
+    OICFree(response);
+}
+
+TEST_F(CADuplicateFilterTests, ReturnsStoredEmptyAck)
+{
+    // empty acknowledgement sent ahead of a separate response, it has no token
+    const char emptyAck[] = { 0x60, 0x00, 0x00, 0x08 };
+
+    char token[] = "tok1";
+    EXPECT_FALSE(Received(&endpoint, 8));
+    CADuplicateFilterSentResponse(&filter, &endpoint, 8, NULL, 0, emptyAck, sizeof(emptyAck));
+
+    void *response = NULL;
+    uint32_t size = 0;
+    EXPECT_TRUE(CADuplicateFilterReceivedRequest(&filter, &endpoint, 8, token, 4,
+                                                 &response, &size));
+    ASSERT_TRUE(response != NULL);
+    EXPECT_EQ(sizeof(emptyAck), size);
+    EXPECT_EQ(0, memcmp(emptyAck, response, sizeof(emptyAck)));
+    OICFree(response);
+}
+
+TEST_F(CADuplicateFilterTests, DuplicateWithoutResponse)
+{
+    EXPECT_FALSE(Received(&endpoint, 3));
+
+    void *response = NULL;
+    uint32_t size = 0;
+    char token[] = "tok1";
+    EXPECT_TRUE(CADuplicateFilterReceivedRequest(&filter, &endpoint, 3, token, 4,
+                                                 &response, &size));
+    EXPECT_TRUE(response == NULL);
+    EXPECT_EQ(0u, size);
+}
+
+TEST_F(CADuplicateFilterTests, ForgetsOldestWhenFull)
+{
+    for (uint16_t id = 0; id <= CA_DUPLICATE_FILTER_SIZE; id++)
+    {
+        EXPECT_FALSE(Received(&endpoint, id));
+    }
+    EXPECT_FALSE(Received(&endpoint, 0));
+    EXPECT_TRUE(Received(&endpoint, CA_DUPLICATE_FILTER_SIZE));
+}
@@ -20,6 +20,9 @@
 
 #include <stdio.h>
 
+#include <chrono>
+#include <iostream>
+
 #include "gtest/gtest.h"
 
 #include "caprotocolmessage.h"
@@ -41,23 +44,23 @@ public:
  *
  * @param cases array of expected parse results.
  * @param numCases number of expected parse results.
- * @param optlist parsed option list to verify.
+ * @param options parsed options to verify.
  */
 void verifyParsedOptions(CoAPOptionCase const *cases,
 			 size_t numCases,
-			 coap_list_t *optlist)
+			 const CAPDUOptions_t *options)
 {
     size_t index = 0;
-    for (coap_list_t *opt = optlist; opt; opt = opt->next)
+    for (uint8_t i = 0; i < options->count; i++)
     {
-        coap_option *option = (coap_option *) opt->data;
-        EXPECT_TRUE(option != NULL);
+        const CAPDUOption_t *option = &options->options[i];
+        EXPECT_TRUE(option->data != NULL);
         EXPECT_LT(index, numCases);
-        if (option && (index < numCases))
+        if (option->data && (index < numCases))
         {
-            unsigned short key = COAP_OPTION_KEY(*option);
-            unsigned int length = COAP_OPTION_LENGTH(*option);
-            std::string dataStr((const char*)COAP_OPTION_DATA(*option), length);
+            unsigned short key = option->key;
+            unsigned int length = option->length;
+            std::string dataStr((const char*)option->data, length);
             // First validate the test case:
             EXPECT_EQ(cases[index].length, cases[index].dataStr.length());
 
@@ -73,6 +76,31 @@ void verifyParsedOptions(CoAPOptionCase const *cases,
     EXPECT_EQ(numCases, index);
 }
 
+/**
+ * Generates @p count PDUs for @p info and returns the mean time of one in
+ * microseconds.
+ */
+double measureGeneratePDU(uint32_t code, const CAInfo_t *info, size_t count)
+{
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(CAEndpoint_t));
+    endpoint.flags = CA_DEFAULT_FLAGS;
+    endpoint.adapter = CA_ADAPTER_IP;
+    endpoint.port = 5683;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+        CAPDUOptions_t options;
+        coap_transport_t transport = COAP_UDP;
+        coap_pdu_t *pdu = CAGeneratePDU(code, info, &endpoint, &options, &transport);
+        EXPECT_TRUE(pdu != NULL);
+        coap_delete_pdu(pdu);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::micro>(elapsed).count() / count;
+}
+
 } // namespace
 
 TEST(CAProtocolMessage, CAParseURIBase)
@@ -87,12 +115,12 @@ TEST(CAProtocolMessage, CAParseURIBase)
     size_t numCases = sizeof(cases) / sizeof(cases[0]);
 
 
-    coap_list_t *optlist = NULL;
-    CAParseURI(sampleURI, &optlist);
+    CAPDUOptions_t options;
+    CAInitPDUOptions(&options);
+    CAParseURI(sampleURI, &options);
 
 
-    verifyParsedOptions(cases, numCases, optlist);
-    coap_delete_list(optlist);
+    verifyParsedOptions(cases, numCases, &options);
 }
 
 // Try for multiple URI path components that still total less than 128
@@ -120,12 +148,12 @@ TEST(CAProtocolMessage, CAParseURIManyPath)
     size_t numCases = sizeof(cases) / sizeof(cases[0]);
 
 
-    coap_list_t *optlist = NULL;
-    CAParseURI(sampleURI, &optlist);
+    CAPDUOptions_t options;
+    CAInitPDUOptions(&options);
+    CAParseURI(sampleURI, &options);
 
 
-    verifyParsedOptions(cases, numCases, optlist);
-    coap_delete_list(optlist);
+    verifyParsedOptions(cases, numCases, &options);
 }
 
 // Try for multiple URI parameters that still total less than 128
@@ -152,12 +180,12 @@ TEST(CAProtocolMessage, CAParseURIManyParams)
     size_t numCases = sizeof(cases) / sizeof(cases[0]);
 
 
-    coap_list_t *optlist = NULL;
-    CAParseURI(sampleURI, &optlist);
+    CAPDUOptions_t options;
+    CAInitPDUOptions(&options);
+    CAParseURI(sampleURI, &options);
 
 
-    verifyParsedOptions(cases, numCases, optlist);
-    coap_delete_list(optlist);
+    verifyParsedOptions(cases, numCases, &options);
 }
 
 // Test that an initial long path component won't hide latter ones.
@@ -179,12 +207,34 @@ TEST(CAProtocolMessage, CAParseURILongPath)
     size_t numCases = sizeof(cases) / sizeof(cases[0]);
 
 
-    coap_list_t *optlist = NULL;
-    CAParseURI(sampleURI, &optlist);
+    CAPDUOptions_t options;
+    CAInitPDUOptions(&options);
+    CAParseURI(sampleURI, &options);
+
 
+    verifyParsedOptions(cases, numCases, &options);
+}
+
+// Test that a long path and a long query both fit, and the space they use is counted.
+TEST(CAProtocolMessage, CAParseURILongPathAndQuery)
+{
+    std::string path(300, 'p');
+    std::string query(300, 'q');
+    std::string sampleURI = "coap://[::]/" + path + "?" + query;
 
-    verifyParsedOptions(cases, numCases, optlist);
-    coap_delete_list(optlist);
+    CoAPOptionCase cases[] = {
+        {COAP_OPTION_URI_PATH, 300, path},
+        {COAP_OPTION_URI_QUERY, 300, query},
+    };
+    size_t numCases = sizeof(cases) / sizeof(cases[0]);
+
+    CAPDUOptions_t options;
+    CAInitPDUOptions(&options);
+    EXPECT_EQ(CA_STATUS_OK, CAParseURI(sampleURI.c_str(), &options));
+
+    verifyParsedOptions(cases, numCases, &options);
+    // Each value has a 1 byte header and a 2 byte extended length.
+    EXPECT_EQ(2 * (3 + 300), options.uriLength);
 }
 
 TEST(CAProtocolMessage, CAGetTokenFromPDU)
@@ -196,7 +246,7 @@ TEST(CAProtocolMessage, CAGetTokenFromPDU)
     tempRep.port = 5683;
 
     coap_pdu_t *pdu = NULL;
-    coap_list_t *options = NULL;
+    CAPDUOptions_t options;
     coap_transport_t transport = COAP_UDP;
 
     CAInfo_t inData;
@@ -213,3 +263,99 @@ TEST(CAProtocolMessage, CAGetTokenFromPDU)
 
     EXPECT_EQ(CA_STATUS_OK, CAGetTokenFromPDU(pdu->transport_hdr, &outData, &tempRep));
 }
+
+TEST(CAProtocolMessage, CAAddPDUOptionInOrder)
+{
+    CAPDUOptions_t options;
+    CAInitPDUOptions(&options);
+
+    const uint8_t observe[] = { 0x00, 0x00, 0x01 };
+    const uint8_t version[] = { 0x08, 0x00 };
+    EXPECT_EQ(CA_STATUS_OK, CAAddPDUOption(&options, COAP_OPTION_URI_QUERY, 3,
+                                           (const uint8_t *) "a=0"));
+    EXPECT_EQ(CA_STATUS_OK, CAAddPDUOption(&options, COAP_OPTION_URI_PATH, 3,
+                                           (const uint8_t *) "oic"));
+    EXPECT_EQ(CA_STATUS_OK, CAAddPDUOption(&options, 2049, sizeof(version), version));
+    EXPECT_EQ(CA_STATUS_OK, CAAddPDUOption(&options, COAP_OPTION_URI_PATH, 3,
+                                           (const uint8_t *) "res"));
+    EXPECT_EQ(CA_STATUS_OK, CAAddPDUOption(&options, COAP_OPTION_OBSERVE, sizeof(observe),
+                                           observe));
+
+    // Observe is shrunk to its minimal encoding.
+    CoAPOptionCase cases[] = {
+        {COAP_OPTION_OBSERVE, 1, "\x01"},
+        {COAP_OPTION_URI_PATH, 3, "oic"},
+        {COAP_OPTION_URI_PATH, 3, "res"},
+        {COAP_OPTION_URI_QUERY, 3, "a=0"},
+        {2049, 2, std::string("\x08\x00", 2)},
+    };
+    size_t numCases = sizeof(cases) / sizeof(cases[0]);
+
+    verifyParsedOptions(cases, numCases, &options);
+}
+
+TEST(CAProtocolMessage, CAAddPDUOptionFull)
+{
+    CAPDUOptions_t options;
+    CAInitPDUOptions(&options);
+
+    for (int i = 0; i < CA_MAX_PDU_OPTIONS; i++)
+    {
+        EXPECT_EQ(CA_STATUS_OK, CAAddPDUOption(&options, COAP_OPTION_URI_QUERY, 3,
+                                               (const uint8_t *) "a=0"));
+    }
+    EXPECT_NE(CA_STATUS_OK, CAAddPDUOption(&options, COAP_OPTION_URI_QUERY, 3,
+                                           (const uint8_t *) "a=0"));
+    EXPECT_EQ(CA_MAX_PDU_OPTIONS, options.count);
+}
+
+// Measures generating the PDUs of typical OCF requests: a discovery, an
+// observe registration and an update with a CBOR payload.
+TEST(CAProtocolMessage, CAGeneratePDUBenchmark)
+{
+    const size_t count = 100000;
+    CAHeaderOption_t headerOptions[2];
+    memset(headerOptions, 0, sizeof(headerOptions));
+    // vendor specific header options
+    headerOptions[0].optionID = 2049;
+    headerOptions[0].optionLength = 2;
+    headerOptions[0].optionData[0] = 0x08;
+    headerOptions[1].optionID = 2053;
+    headerOptions[1].optionLength = 2;
+    headerOptions[1].optionData[0] = 0x08;
+
+    CAInfo_t discovery;
+    memset(&discovery, 0, sizeof(CAInfo_t));
+    discovery.type = CA_MSG_NONCONFIRM;
+    discovery.token = (CAToken_t)"12345678";
+    discovery.tokenLength = 8;
+    discovery.resourceUri = (CAURI_t)"/oic/res?rt=oic.r.light";
+    discovery.options = headerOptions;
+    discovery.numOptions = 1;
+    discovery.acceptFormat = CA_FORMAT_APPLICATION_CBOR;
+
+    CAHeaderOption_t observeOptions[2];
+    memcpy(observeOptions, headerOptions, sizeof(observeOptions));
+    observeOptions[1].optionID = COAP_OPTION_OBSERVE;
+    observeOptions[1].optionLength = 1;
+    observeOptions[1].optionData[0] = 0;
+
+    CAInfo_t observe = discovery;
+    observe.type = CA_MSG_CONFIRM;
+    observe.resourceUri = (CAURI_t)"/a/light/1?if=oic.if.baseline";
+    observe.options = observeOptions;
+    observe.numOptions = 2;
+
+    uint8_t payload[64];
+    memset(payload, 0xA5, sizeof(payload));
+    CAInfo_t update = observe;
+    update.options = headerOptions;
+    update.payload = payload;
+    update.payloadSize = sizeof(payload);
+    update.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+
+    std::cout << "discovery GET: " << measureGeneratePDU(CA_GET, &discovery, count)
+              << " us, observe GET: " << measureGeneratePDU(CA_GET, &observe, count)
+              << " us, POST: " << measureGeneratePDU(CA_POST, &update, count)
+              << " us per PDU" << std::endl;
+}
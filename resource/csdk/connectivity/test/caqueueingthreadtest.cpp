@@ -0,0 +1,135 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "caqueueingthread.h"
+
+#define TOTAL_DATA 100000
+#define RING_SIZE 1024
+
+static std::mutex g_handledMutex;
+static std::condition_variable g_handledCond;
+static size_t g_handled = 0;
+
+static void CountData(void *data)
+{
+    (void)data;
+    std::lock_guard<std::mutex> lock(g_handledMutex);
+    if (++g_handled == TOTAL_DATA)
+    {
+        g_handledCond.notify_one();
+    }
+}
+
+// The data are not allocated, there is nothing to free.
+static void KeepData(void *data, uint32_t size)
+{
+    (void)data;
+    (void)size;
+}
+
+class CAQueueingThreadTests : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_handled = 0;
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &m_threadPool));
+    }
+
+    virtual void TearDown()
+    {
+        ca_thread_pool_free(m_threadPool);
+    }
+
+    /**
+     * Adds TOTAL_DATA from @p producers threads and returns how many data per
+     * second the queuing thread handled.
+     */
+    double MeasureThroughput(bool lockFree, int producers)
+    {
+        CAQueueingThread_t thread;
+        memset(&thread, 0, sizeof(thread));
+        g_handled = 0;
+
+        CAResult_t res = lockFree ?
+            CAQueueingThreadInitializeLockFree(&thread, m_threadPool, CountData, KeepData,
+                                               RING_SIZE) :
+            CAQueueingThreadInitialize(&thread, m_threadPool, CountData, KeepData);
+        EXPECT_EQ(CA_STATUS_OK, res);
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadStart(&thread));
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++)
+        {
+            size_t count = TOTAL_DATA / producers + (p < TOTAL_DATA % producers ? 1 : 0);
+            threads.push_back(std::thread([&thread, count]
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    CAQueueingThreadAddData(&thread, (void *)(i + 1), sizeof(void *));
+                }
+            }));
+        }
+        for (size_t p = 0; p < threads.size(); p++)
+        {
+            threads[p].join();
+        }
+
+        bool handled = false;
+        {
+            std::unique_lock<std::mutex> lock(g_handledMutex);
+            handled = g_handledCond.wait_for(lock, std::chrono::seconds(30),
+                                             [] { return TOTAL_DATA == g_handled; });
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        EXPECT_TRUE(handled);
+
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadStop(&thread));
+        EXPECT_EQ(CA_STATUS_OK, CAQueueingThreadDestroy(&thread));
+        return TOTAL_DATA / std::chrono::duration<double>(elapsed).count();
+    }
+
+    ca_thread_pool_t m_threadPool;
+};
+
+// Measures the throughput of a queuing thread with 1 to 16 producer threads,
+// with the mutex protected queue and with the lock-free ring in front of it.
+TEST_F(CAQueueingThreadTests, ContentionBenchmark)
+{
+    for (int producers = 1; producers <= 16; producers *= 2)
+    {
+        double locked = MeasureThroughput(false, producers);
+        double lockFree = MeasureThroughput(true, producers);
+
+        std::cout << producers << " producers: " << locked << " data/s with u_queue, "
+                  << lockFree << " data/s with the lock-free ring" << std::endl;
+    }
+}
@@ -0,0 +1,252 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "catcpinterface.h"
+
+#define SOAK_SESSIONS 10000
+#define SMALL_SESSIONS 16
+#define CONNECT_BATCH 32
+#define MEASURED_MESSAGES 10000
+
+// accept sockets, pipes, epoll and the descriptors the test binary already uses
+#define RESERVED_FDS 64
+
+// CoAP over TCP GET with a single Uri-Path option "test": Len = 5, TKL = 0.
+static const uint8_t SOAK_MESSAGE[] = { 0x50, 0x01, 0xB4, 't', 'e', 's', 't' };
+
+static std::mutex g_receivedMutex;
+static std::condition_variable g_receivedCond;
+static size_t g_received = 0;
+static std::chrono::steady_clock::time_point g_receivedAt;
+
+static void SoakPacketReceived(const CASecureEndpoint_t *sep, const void *data,
+                               uint32_t dataLength)
+{
+    (void)sep;
+    (void)data;
+    (void)dataLength;
+    std::lock_guard<std::mutex> lock(g_receivedMutex);
+    g_receivedAt = std::chrono::steady_clock::now();
+    g_received++;
+    g_receivedCond.notify_one();
+}
+
+static bool WaitForReceived(size_t count)
+{
+    std::unique_lock<std::mutex> lock(g_receivedMutex);
+    return g_receivedCond.wait_for(lock, std::chrono::seconds(10),
+                                   [count] { return g_received >= count; });
+}
+
+/**
+ * Raises the descriptor limit as far as allowed and returns how many
+ * loopback sessions fit, each one holding a client and a server descriptor.
+ */
+static size_t AvailableSessions(size_t wanted)
+{
+    struct rlimit limit;
+    if (0 != getrlimit(RLIMIT_NOFILE, &limit))
+    {
+        return 0;
+    }
+    if (limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        if (0 != setrlimit(RLIMIT_NOFILE, &limit))
+        {
+            getrlimit(RLIMIT_NOFILE, &limit);
+        }
+    }
+
+    rlim_t descriptors = limit.rlim_cur;
+#ifndef WITH_EPOLL
+    // select() can not watch descriptors above FD_SETSIZE
+    descriptors = std::min(descriptors, (rlim_t)FD_SETSIZE);
+#endif
+    if (descriptors <= RESERVED_FDS)
+    {
+        return 0;
+    }
+    return std::min(wanted, (size_t)((descriptors - RESERVED_FDS) / 2));
+}
+
+class CATCPServerTests : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_received = 0;
+        m_sent = 0;
+
+        caglobals.server = true;
+        caglobals.tcp.ipv4.fd = -1;
+        caglobals.tcp.ipv4.port = 0;
+        caglobals.tcp.ipv6.fd = -1;
+        caglobals.tcp.ipv6.port = 0;
+        caglobals.tcp.selectTimeout = 1;
+        caglobals.tcp.listenBacklog = CONNECT_BATCH * 4;
+        caglobals.tcp.svrlist = NULL;
+        caglobals.tcp.epollFd = -1;
+
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &m_threadPool));
+        CATCPSetPacketReceiveCallback(SoakPacketReceived);
+        ASSERT_EQ(CA_STATUS_OK, CATCPStartServer(m_threadPool));
+    }
+
+    virtual void TearDown()
+    {
+        CATCPStopServer();
+        CATCPSetPacketReceiveCallback(NULL);
+        for (size_t i = 0; i < m_clients.size(); i++)
+        {
+            close(m_clients[i]);
+        }
+        m_clients.clear();
+        ca_thread_pool_free(m_threadPool);
+    }
+
+    bool SendMessage(int fd)
+    {
+        if ((ssize_t)sizeof(SOAK_MESSAGE) != write(fd, SOAK_MESSAGE, sizeof(SOAK_MESSAGE)))
+        {
+            return false;
+        }
+        m_sent++;
+        return true;
+    }
+
+    /**
+     * Opens loopback sessions until @p count are connected. Each batch sends
+     * one message per new session so the server has accepted all of them
+     * before the next batch connects.
+     */
+    bool ConnectSessions(size_t count)
+    {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(caglobals.tcp.ipv4.port);
+
+        while (m_clients.size() < count)
+        {
+            size_t batch = std::min((size_t)CONNECT_BATCH, count - m_clients.size());
+            for (size_t i = 0; i < batch; i++)
+            {
+                int fd = socket(AF_INET, SOCK_STREAM, 0);
+                if (0 > fd)
+                {
+                    return false;
+                }
+                if (0 != connect(fd, (struct sockaddr *)&addr, sizeof(addr)) || !SendMessage(fd))
+                {
+                    close(fd);
+                    return false;
+                }
+                m_clients.push_back(fd);
+            }
+            if (!WaitForReceived(m_sent))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Sends one message at a time on sessions spread over all connected ones
+     * and returns the dispatch latencies in microseconds, sorted.
+     */
+    std::vector<double> MeasureDispatch(size_t messages)
+    {
+        std::vector<double> latencies;
+
+        for (size_t i = 0; i < messages; i++)
+        {
+            int fd = m_clients[(i * 7919) % m_clients.size()];
+            auto start = std::chrono::steady_clock::now();
+            if (!SendMessage(fd) || !WaitForReceived(m_sent))
+            {
+                break;
+            }
+            std::lock_guard<std::mutex> lock(g_receivedMutex);
+            latencies.push_back(std::chrono::duration<double, std::micro>(
+                                    g_receivedAt - start).count());
+        }
+        std::sort(latencies.begin(), latencies.end());
+        return latencies;
+    }
+
+    void PrintLatencies(size_t sessions, const std::vector<double> &latencies)
+    {
+        double sum = 0;
+        for (size_t i = 0; i < latencies.size(); i++)
+        {
+            sum += latencies[i];
+        }
+        std::cout << sessions << " sessions: " << sum / latencies.size() << " us mean, "
+                  << latencies[latencies.size() * 99 / 100] << " us p99 dispatch latency"
+                  << std::endl;
+    }
+
+    ca_thread_pool_t m_threadPool;
+    std::vector<int> m_clients;
+    size_t m_sent;
+};
+
+// Measures the dispatch latency of one message with a few sessions open and
+// again with the soak count of sessions open.
+TEST_F(CATCPServerTests, SessionSoakBenchmark)
+{
+    size_t sessions = AvailableSessions(SOAK_SESSIONS);
+    ASSERT_LT((size_t)SMALL_SESSIONS, sessions);
+    if (sessions < SOAK_SESSIONS)
+    {
+        std::cout << "descriptor limit allows " << sessions << " sessions" << std::endl;
+    }
+
+    ASSERT_TRUE(ConnectSessions(SMALL_SESSIONS));
+    std::vector<double> small = MeasureDispatch(MEASURED_MESSAGES);
+    ASSERT_EQ((size_t)MEASURED_MESSAGES, small.size());
+
+    ASSERT_TRUE(ConnectSessions(sessions));
+    std::vector<double> soak = MeasureDispatch(MEASURED_MESSAGES);
+    ASSERT_EQ((size_t)MEASURED_MESSAGES, soak.size());
+
+    PrintLatencies(SMALL_SESSIONS, small);
+    PrintLatencies(sessions, soak);
+}
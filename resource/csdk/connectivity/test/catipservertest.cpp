@@ -0,0 +1,216 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "caipinterface.h"
+#include "caipnwmonitor.h"
+
+#define UNICAST_MESSAGES 50000
+#define IN_FLIGHT 32
+
+// CoAP GET and POST with message ID 1 and no token. The code tells the
+// unicast messages apart from the storm sent to the multicast socket.
+#define CODE_GET 0x01
+#define CODE_POST 0x02
+static const uint8_t UNICAST_MESSAGE[] = { 0x50, CODE_GET, 0x00, 0x01, 0xB4, 't', 'e', 's', 't' };
+static const uint8_t STORM_MESSAGE[] = { 0x50, CODE_POST, 0x00, 0x01, 0xB3, 'r', 'e', 's' };
+
+static std::mutex g_receivedMutex;
+static std::condition_variable g_receivedCond;
+static size_t g_unicastReceived = 0;
+static size_t g_stormReceived = 0;
+
+static void IPPacketReceived(const CASecureEndpoint_t *sep, const void *data,
+                             uint32_t dataLength)
+{
+    (void)sep;
+    if (dataLength < 2)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_receivedMutex);
+    if (CODE_GET == ((const uint8_t *)data)[1])
+    {
+        g_unicastReceived++;
+        g_receivedCond.notify_one();
+    }
+    else
+    {
+        g_stormReceived++;
+    }
+}
+
+static void IPAdapterStateChanged(CATransportAdapter_t adapter, CANetworkStatus_t status)
+{
+    (void)adapter;
+    (void)status;
+}
+
+class CAIPServerTests : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_unicastReceived = 0;
+        g_stormReceived = 0;
+
+        caglobals.ip.u6.fd  = -1;
+        caglobals.ip.u6s.fd = -1;
+        caglobals.ip.u4.fd  = -1;
+        caglobals.ip.u4s.fd = -1;
+        caglobals.ip.m6.fd  = -1;
+        caglobals.ip.m6s.fd = -1;
+        caglobals.ip.m4.fd  = -1;
+        caglobals.ip.m4s.fd = -1;
+        caglobals.ip.u4.port  = 0;
+        caglobals.ip.u4s.port = 0;
+        caglobals.ip.m4.port  = CA_COAP;
+        caglobals.ip.m4s.port = CA_SECURE_COAP;
+        caglobals.ip.ipv4enabled = true;
+        caglobals.ip.ipv6enabled = false;
+        caglobals.ip.epollFd = -1;
+
+        ASSERT_EQ(CA_STATUS_OK, ca_thread_pool_init(1, &m_threadPool));
+        ASSERT_EQ(CA_STATUS_OK, CAIPStartNetworkMonitor(IPAdapterStateChanged, CA_ADAPTER_IP));
+        CAIPSetPacketReceiveCallback(IPPacketReceived);
+        ASSERT_EQ(CA_STATUS_OK, CAIPStartServer(m_threadPool));
+
+        m_sender = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT_LE(0, m_sender);
+    }
+
+    virtual void TearDown()
+    {
+        close(m_sender);
+        CAIPStopServer();
+        // joins the receive thread
+        ca_thread_pool_free(m_threadPool);
+        CADeInitializeIPGlobals();
+        CAIPSetPacketReceiveCallback(NULL);
+        CAIPStopNetworkMonitor(CA_ADAPTER_IP);
+    }
+
+    static struct sockaddr_in LoopbackAddress(uint16_t port)
+    {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        return addr;
+    }
+
+    /**
+     * Sends @p count datagrams to the unicast socket, keeping at most
+     * IN_FLIGHT of them unreceived, and returns the datagrams received
+     * per second.
+     */
+    double MeasureUnicast(size_t count)
+    {
+        struct sockaddr_in addr = LoopbackAddress(caglobals.ip.u4.port);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t sent = 0; sent < count; sent++)
+        {
+            std::unique_lock<std::mutex> lock(g_receivedMutex);
+            if (!g_receivedCond.wait_for(lock, std::chrono::seconds(5),
+                                         [sent] { return sent < g_unicastReceived + IN_FLIGHT; }))
+            {
+                return 0;
+            }
+            lock.unlock();
+
+            if (0 > sendto(m_sender, UNICAST_MESSAGE, sizeof(UNICAST_MESSAGE), 0,
+                           (struct sockaddr *)&addr, sizeof(addr)))
+            {
+                return 0;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(g_receivedMutex);
+        if (!g_receivedCond.wait_for(lock, std::chrono::seconds(5),
+                                     [count] { return g_unicastReceived >= count; }))
+        {
+            return 0;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return count / std::chrono::duration<double>(elapsed).count();
+    }
+
+    const char *Backend()
+    {
+        return -1 != caglobals.ip.epollFd ? "epoll" : "select";
+    }
+
+    ca_thread_pool_t m_threadPool;
+    int m_sender;
+};
+
+// Measures the unicast receive rate of the compiled in backend, build with
+// WITH_EPOLL=1 and WITH_EPOLL=0 to compare epoll and select.
+TEST_F(CAIPServerTests, ReceiveThroughputBenchmark)
+{
+    double rate = MeasureUnicast(UNICAST_MESSAGES);
+    EXPECT_LT(0, rate);
+
+    std::cout << Backend() << ": " << rate << " unicast datagrams/s" << std::endl;
+}
+
+// Measures the unicast receive rate while another thread floods the
+// multicast socket as a discovery storm would.
+TEST_F(CAIPServerTests, ReceiveThroughputDuringStormBenchmark)
+{
+    std::atomic<bool> storming(true);
+    std::thread storm([&storming]
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr = LoopbackAddress(caglobals.ip.m4.port);
+        while (storming)
+        {
+            (void)sendto(fd, STORM_MESSAGE, sizeof(STORM_MESSAGE), 0,
+                         (struct sockaddr *)&addr, sizeof(addr));
+        }
+        close(fd);
+    });
+
+    double rate = MeasureUnicast(UNICAST_MESSAGES);
+    storming = false;
+    storm.join();
+    EXPECT_LT(0, rate);
+
+    std::lock_guard<std::mutex> lock(g_receivedMutex);
+    std::cout << Backend() << " during storm: " << rate << " unicast datagrams/s, "
+              << g_stormReceived << " storm datagrams received" << std::endl;
+}
@@ -0,0 +1,206 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include "ca_adapter_net_tls.h"
+
+// TLS_ECDH_ANON_WITH_AES_128_CBC_SHA256 of the patched mbedTLS, it needs no credentials.
+#define TEST_TLS_ANON_CIPHER 0xFF00
+
+#define CLIENT_PORT 40001
+#define SERVER_PORT 40002
+#define HANDSHAKES 200
+
+/**
+ * Client and server share the adapter, records are queued by the send
+ * callback and fed to CAdecryptTls once the adapter mutex is released.
+ */
+struct TlsRecord
+{
+    uint16_t to;
+    std::vector<uint8_t> data;
+};
+
+static std::deque<TlsRecord> g_records;
+static size_t g_recordBytes = 0;
+static int g_received = 0;
+static int g_handshakes = 0;
+
+static void TlsSend(CAEndpoint_t *endpoint, const void *data, uint32_t dataLength)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    g_records.push_back(TlsRecord { endpoint->port,
+                                    std::vector<uint8_t>(bytes, bytes + dataLength) });
+    g_recordBytes += dataLength;
+}
+
+static void TlsReceived(const CASecureEndpoint_t *sep, const void *data, uint32_t dataLength)
+{
+    (void)sep;
+    (void)data;
+    (void)dataLength;
+    g_received++;
+}
+
+static void TlsHandshakeDone(const CAEndpoint_t *endpoint, const CAErrorInfo_t *info)
+{
+    (void)endpoint;
+    if (CA_STATUS_OK == info->result)
+    {
+        g_handshakes++;
+    }
+}
+
+static void TlsCredentialTypes(bool *list)
+{
+    list[0] = false;
+    list[1] = false;
+}
+
+static int TlsCredentials(CADtlsPskCredType_t type, const uint8_t *desc, size_t descLen,
+                          uint8_t *result, size_t resultLength)
+{
+    (void)type;
+    (void)desc;
+    (void)descLen;
+    memset(result, 0x5a, resultLength);
+    return (int)resultLength;
+}
+
+static CAEndpoint_t TestEndpoint(uint16_t port)
+{
+    CAEndpoint_t endpoint;
+    memset(&endpoint, 0, sizeof(endpoint));
+    endpoint.adapter = CA_ADAPTER_TCP;
+    endpoint.flags = (CATransportFlags_t)(CA_IPV4 | CA_SECURE);
+    strncpy(endpoint.addr, "127.0.0.1", sizeof(endpoint.addr) - 1);
+    endpoint.port = port;
+    return endpoint;
+}
+
+/**
+ * Delivers queued records until both sides are idle. A record sent to the
+ * server port is decrypted as coming from the client and the other way round.
+ */
+static void TlsPump()
+{
+    while (!g_records.empty())
+    {
+        TlsRecord record = g_records.front();
+        g_records.pop_front();
+
+        CASecureEndpoint_t sep;
+        memset(&sep, 0, sizeof(sep));
+        sep.endpoint = TestEndpoint(SERVER_PORT == record.to ? CLIENT_PORT : SERVER_PORT);
+        CAdecryptTls(&sep, record.data.data(), (uint32_t)record.data.size());
+    }
+}
+
+class CATlsAdapterTests : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        g_records.clear();
+        g_recordBytes = 0;
+        g_received = 0;
+        g_handshakes = 0;
+
+        ASSERT_EQ(CA_STATUS_OK, CAinitTlsAdapter());
+        CAsetTlsAdapterCallbacks(TlsReceived, TlsSend, CA_ADAPTER_TCP);
+        CAsetTlsHandshakeCallback(TlsHandshakeDone);
+        CAsetCredentialTypesCallback(TlsCredentialTypes);
+        CAsetTlsCredentialsCallback(TlsCredentials);
+        ASSERT_EQ(CA_STATUS_OK, CAsetTlsCipherSuite(TEST_TLS_ANON_CIPHER));
+    }
+
+    virtual void TearDown()
+    {
+        CAdeinitTlsAdapter();
+        CAsetTlsSessionCacheConfig(16, 3600);
+    }
+
+    /**
+     * Connects, sends one message and closes the connection @p count times.
+     * Returns the mean time of a connection in microseconds.
+     */
+    double Reconnect(int count)
+    {
+        CAEndpoint_t server = TestEndpoint(SERVER_PORT);
+        char message[] = "ping";
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++)
+        {
+            EXPECT_EQ(CA_STATUS_OK, CAencryptTls(&server, message, sizeof(message)));
+            TlsPump();
+            EXPECT_EQ(CA_STATUS_OK, CAcloseTlsConnection(&server));
+            TlsPump();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()
+               / (double)count;
+    }
+};
+
+TEST_F(CATlsAdapterTests, SessionCacheConfigBeforeInit)
+{
+    CAdeinitTlsAdapter();
+    EXPECT_EQ(CA_STATUS_OK, CAsetTlsSessionCacheConfig(0, 0));
+    EXPECT_EQ(CA_STATUS_OK, CAinitTlsAdapter());
+    CAsetTlsAdapterCallbacks(TlsReceived, TlsSend, CA_ADAPTER_TCP);
+    ASSERT_EQ(CA_STATUS_OK, CAsetTlsCipherSuite(TEST_TLS_ANON_CIPHER));
+
+    // With resumption disabled before init every reconnect sends the full handshake.
+    Reconnect(1);
+    size_t fullBytes = g_recordBytes;
+    Reconnect(1);
+    EXPECT_EQ(2, g_received);
+    EXPECT_EQ(fullBytes * 2, g_recordBytes);
+}
+
+TEST_F(CATlsAdapterTests, ResumedHandshakeVersusFullHandshake)
+{
+    ASSERT_EQ(CA_STATUS_OK, CAsetTlsSessionCacheConfig(0, 0));
+    double full = Reconnect(HANDSHAKES);
+    size_t fullBytes = g_recordBytes / HANDSHAKES;
+    EXPECT_EQ(HANDSHAKES, g_received);
+
+    ASSERT_EQ(CA_STATUS_OK, CAsetTlsSessionCacheConfig(16, 3600));
+    // The first connection performs the full handshake that later ones resume.
+    Reconnect(1);
+    g_recordBytes = 0;
+    g_received = 0;
+    double resumed = Reconnect(HANDSHAKES);
+    size_t resumedBytes = g_recordBytes / HANDSHAKES;
+    EXPECT_EQ(HANDSHAKES, g_received);
+    EXPECT_LT(resumedBytes, fullBytes);
+
+    std::cout << "full handshake: " << full << " us, " << fullBytes << " bytes; "
+              << "resumed: " << resumed << " us, " << resumedBytes << " bytes"
+              << std::endl;
+}
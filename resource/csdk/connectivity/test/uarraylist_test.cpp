@@ -210,6 +210,27 @@ TEST_F(UArrayListF, Remove)
     ASSERT_EQ(static_cast<uint32_t>(500), u_arraylist_length(list));
 }
 
+TEST_F(UArrayListF, Swap)
+{
+    int dummy[3] = {0};
+    for (int i = 0; i < 3; ++i)
+    {
+        bool rc = u_arraylist_add(list, &dummy[i]);
+        ASSERT_TRUE(rc);
+    }
+
+    ASSERT_TRUE(u_arraylist_swap(list, 0, 2));
+    ASSERT_EQ(&dummy[2], u_arraylist_get(list, 0));
+    ASSERT_EQ(&dummy[1], u_arraylist_get(list, 1));
+    ASSERT_EQ(&dummy[0], u_arraylist_get(list, 2));
+
+    ASSERT_TRUE(u_arraylist_swap(list, 1, 1));
+    ASSERT_EQ(&dummy[1], u_arraylist_get(list, 1));
+
+    ASSERT_FALSE(u_arraylist_swap(list, 0, 3));
+    ASSERT_FALSE(u_arraylist_swap(NULL, 0, 1));
+}
+
 TEST_F(UArrayListF, Contains)
 {
     ASSERT_EQ(static_cast<uint32_t>(0), u_arraylist_length(list));
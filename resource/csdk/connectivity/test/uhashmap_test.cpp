@@ -0,0 +1,168 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include "uhashmap.h"
+
+class UHashMapF : public testing::Test {
+public:
+  UHashMapF() :
+      testing::Test(),
+      map(NULL)
+  {
+  }
+
+protected:
+    virtual void SetUp()
+    {
+        map = u_hashmap_create(u_hashmap_hash_int, u_hashmap_equal_int);
+        ASSERT_TRUE(map != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        u_hashmap_free(&map);
+        ASSERT_EQ(NULL, map);
+    }
+
+    u_hashmap_t *map;
+};
+
+TEST(UHashMap, Base)
+{
+    u_hashmap_t *map = u_hashmap_create(u_hashmap_hash_string, u_hashmap_equal_string);
+    ASSERT_TRUE(map != NULL);
+
+    u_hashmap_free(&map);
+    ASSERT_EQ(NULL, map);
+}
+
+TEST(UHashMap, CreateInvalid)
+{
+    EXPECT_EQ(NULL, u_hashmap_create(NULL, u_hashmap_equal_int));
+    EXPECT_EQ(NULL, u_hashmap_create(u_hashmap_hash_int, NULL));
+}
+
+TEST(UHashMap, FreeNull)
+{
+    u_hashmap_free(NULL);
+}
+
+TEST(UHashMap, StringKeys)
+{
+    u_hashmap_t *map = u_hashmap_create(u_hashmap_hash_string, u_hashmap_equal_string);
+    ASSERT_TRUE(map != NULL);
+
+    int one = 1;
+    int two = 2;
+    char key[] = "/a/light";
+
+    ASSERT_TRUE(u_hashmap_put(map, "/a/light", &one));
+    ASSERT_TRUE(u_hashmap_put(map, "/a/fan", &two));
+
+    // lookup by value, not by pointer
+    EXPECT_EQ(&one, u_hashmap_get(map, key));
+    EXPECT_EQ(&two, u_hashmap_get(map, "/a/fan"));
+    EXPECT_EQ(NULL, u_hashmap_get(map, "/a/door"));
+
+    u_hashmap_free(&map);
+}
+
+TEST_F(UHashMapF, Length)
+{
+    ASSERT_EQ(static_cast<uint32_t>(0), u_hashmap_length(map));
+
+    int key = 42;
+    ASSERT_TRUE(u_hashmap_put(map, &key, &key));
+    ASSERT_EQ(static_cast<uint32_t>(1), u_hashmap_length(map));
+
+    // replacing keeps the length
+    ASSERT_TRUE(u_hashmap_put(map, &key, &key));
+    ASSERT_EQ(static_cast<uint32_t>(1), u_hashmap_length(map));
+
+    EXPECT_EQ(&key, u_hashmap_remove(map, &key));
+    ASSERT_EQ(static_cast<uint32_t>(0), u_hashmap_length(map));
+    EXPECT_EQ(NULL, u_hashmap_remove(map, &key));
+}
+
+TEST_F(UHashMapF, PutGetRemoveMany)
+{
+    static const int COUNT = 10000;
+    static int keys[COUNT];
+
+    for (int i = 0; i < COUNT; ++i)
+    {
+        keys[i] = i;
+        ASSERT_TRUE(u_hashmap_put(map, &keys[i], &keys[i]));
+    }
+    ASSERT_EQ(static_cast<uint32_t>(COUNT), u_hashmap_length(map));
+
+    // remove every other key, the rest must stay reachable
+    for (int i = 0; i < COUNT; i += 2)
+    {
+        ASSERT_EQ(&keys[i], u_hashmap_remove(map, &keys[i]));
+    }
+    for (int i = 0; i < COUNT; ++i)
+    {
+        int probe = i;
+        EXPECT_EQ((i % 2) ? &keys[i] : NULL, u_hashmap_get(map, &probe));
+    }
+    ASSERT_EQ(static_cast<uint32_t>(COUNT / 2), u_hashmap_length(map));
+}
+
+TEST_F(UHashMapF, Iterate)
+{
+    int keys[100];
+    for (int i = 0; i < 100; ++i)
+    {
+        keys[i] = i * 7;
+        ASSERT_TRUE(u_hashmap_put(map, &keys[i], &keys[i]));
+    }
+
+    int sum = 0;
+    int count = 0;
+    uint32_t iter = 0;
+    int *value = NULL;
+    while (NULL != (value = (int *)u_hashmap_next(map, &iter)))
+    {
+        sum += *value;
+        count++;
+    }
+    EXPECT_EQ(100, count);
+    EXPECT_EQ(7 * 99 * 100 / 2, sum);
+}
+
+TEST(UHashMap, PointerKeys)
+{
+    u_hashmap_t *map = u_hashmap_create(u_hashmap_hash_pointer, u_hashmap_equal_pointer);
+    ASSERT_TRUE(map != NULL);
+
+    int first = 1;
+    int second = 1;
+
+    ASSERT_TRUE(u_hashmap_put(map, &first, &first));
+
+    // lookup by address, not by value
+    EXPECT_EQ(&first, u_hashmap_get(map, &first));
+    EXPECT_EQ(NULL, u_hashmap_get(map, &second));
+
+    u_hashmap_free(&map);
+}
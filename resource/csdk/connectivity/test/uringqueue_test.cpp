@@ -0,0 +1,216 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "uringqueue.h"
+
+class URingQueueF : public testing::Test {
+public:
+  URingQueueF() :
+      testing::Test(),
+      queue(NULL)
+  {
+  }
+
+protected:
+    virtual void SetUp()
+    {
+        queue = u_ringqueue_create(8);
+        ASSERT_TRUE(queue != NULL);
+    }
+
+    virtual void TearDown()
+    {
+        u_ringqueue_free(&queue);
+        ASSERT_EQ(NULL, queue);
+    }
+
+    u_ringqueue_t *queue;
+};
+
+static void *ToMessage(uintptr_t value)
+{
+    return (void *) value;
+}
+
+TEST(URingQueue, Base)
+{
+    u_ringqueue_t *queue = u_ringqueue_create(16);
+    ASSERT_TRUE(queue != NULL);
+    EXPECT_TRUE(u_ringqueue_is_empty(queue));
+
+    u_ringqueue_free(&queue);
+    ASSERT_EQ(NULL, queue);
+}
+
+TEST(URingQueue, CreateInvalid)
+{
+    EXPECT_EQ(NULL, u_ringqueue_create(0));
+}
+
+TEST_F(URingQueueF, PushPop)
+{
+    EXPECT_TRUE(u_ringqueue_push(queue, ToMessage(1), 10));
+    EXPECT_FALSE(u_ringqueue_is_empty(queue));
+
+    u_queue_message_t message;
+    ASSERT_EQ(1u, u_ringqueue_pop(queue, &message, 1));
+    EXPECT_EQ(ToMessage(1), message.msg);
+    EXPECT_EQ(10u, message.size);
+
+    EXPECT_TRUE(u_ringqueue_is_empty(queue));
+    EXPECT_EQ(0u, u_ringqueue_pop(queue, &message, 1));
+}
+
+TEST_F(URingQueueF, Full)
+{
+    for (uintptr_t i = 1; i <= 8; ++i)
+    {
+        EXPECT_TRUE(u_ringqueue_push(queue, ToMessage(i), 1));
+    }
+    EXPECT_FALSE(u_ringqueue_push(queue, ToMessage(9), 1));
+
+    u_queue_message_t message;
+    ASSERT_EQ(1u, u_ringqueue_pop(queue, &message, 1));
+    EXPECT_EQ(ToMessage(1), message.msg);
+    EXPECT_TRUE(u_ringqueue_push(queue, ToMessage(9), 1));
+}
+
+TEST_F(URingQueueF, CapacityRoundsUp)
+{
+    u_ringqueue_t *other = u_ringqueue_create(5);
+    ASSERT_TRUE(other != NULL);
+
+    int pushed = 0;
+    while (u_ringqueue_push(other, ToMessage(pushed + 1), 1))
+    {
+        ++pushed;
+    }
+    EXPECT_EQ(8, pushed);
+
+    u_ringqueue_free(&other);
+}
+
+TEST_F(URingQueueF, BatchPopKeepsOrder)
+{
+    // Several rounds, so positions wrap around the ring.
+    uintptr_t next = 1;
+    uintptr_t expected = 1;
+    for (int round = 0; round < 10; ++round)
+    {
+        for (int i = 0; i < 6; ++i)
+        {
+            ASSERT_TRUE(u_ringqueue_push(queue, ToMessage(next++), 1));
+        }
+
+        u_queue_message_t messages[4];
+        uint32_t count;
+        while (0 < (count = u_ringqueue_pop(queue, messages, 4)))
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                EXPECT_EQ(ToMessage(expected++), messages[i].msg);
+            }
+        }
+    }
+    EXPECT_EQ(next, expected);
+}
+
+TEST_F(URingQueueF, Closed)
+{
+    u_ringqueue_set_closed(queue, true);
+    EXPECT_FALSE(u_ringqueue_push(queue, ToMessage(1), 1));
+    EXPECT_TRUE(u_ringqueue_is_empty(queue));
+
+    u_ringqueue_set_closed(queue, false);
+    EXPECT_TRUE(u_ringqueue_push(queue, ToMessage(1), 1));
+}
+
+TEST_F(URingQueueF, Waiter)
+{
+    EXPECT_FALSE(u_ringqueue_has_waiter(queue));
+    u_ringqueue_set_waiting(queue, true);
+    EXPECT_TRUE(u_ringqueue_has_waiter(queue));
+    u_ringqueue_set_waiting(queue, false);
+    EXPECT_FALSE(u_ringqueue_has_waiter(queue));
+}
+
+TEST(URingQueue, ManyProducers)
+{
+    const uintptr_t producers = 8;
+    const uintptr_t perProducer = 20000;
+
+    u_ringqueue_t *queue = u_ringqueue_create(64);
+    ASSERT_TRUE(queue != NULL);
+
+    std::vector<std::thread> threads;
+    for (uintptr_t p = 0; p < producers; ++p)
+    {
+        threads.push_back(std::thread([queue, p, perProducer]
+        {
+            for (uintptr_t i = 0; i < perProducer; ++i)
+            {
+                // The value encodes producer and sequence number.
+                while (!u_ringqueue_push(queue, ToMessage(p * perProducer + i + 1), 1))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    std::vector<uintptr_t> next(producers, 0);
+    uintptr_t received = 0;
+    while (received < producers * perProducer)
+    {
+        u_queue_message_t messages[16];
+        uint32_t count = u_ringqueue_pop(queue, messages, 16);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uintptr_t value = (uintptr_t) messages[i].msg - 1;
+            uintptr_t p = value / perProducer;
+            EXPECT_LT(p, producers);
+            if (p < producers)
+            {
+                // Every producer's messages arrive in the order it pushed them.
+                EXPECT_EQ(next[p], value % perProducer);
+                next[p] = value % perProducer + 1;
+            }
+        }
+        received += count;
+        if (0 == count)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_TRUE(u_ringqueue_is_empty(queue));
+
+    u_ringqueue_free(&queue);
+}
@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include "logger_types.h"
 
 #ifdef __ANDROID__
@@ -120,6 +121,26 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
      */
     void OCLogShutdown();
 
+    /**
+     * Write log messages from a background thread.  Each calling thread queues the
+     * format with copies of its arguments, or the bytes of a buffer, in a queue of its
+     * own; the background thread formats and writes them.  A message that does not
+     * fit into the queue is dropped and counted.  Only available where pthreads are,
+     * otherwise logging stays synchronous.
+     *
+     * @param enable - true to start writing from the background thread, false to
+     *                 write the queued messages and stop it
+     * @return true if the logger is in the requested mode
+     */
+    bool OCLogSetAsync(bool enable);
+
+    /**
+     * Number of messages dropped since the start because the queue was full.
+     *
+     * @return number of dropped messages
+     */
+    uint32_t OCLogGetDroppedCount();
+
     /**
      * Output a variable argument list log string with the specified priority level.
      * Only defined for Linux and Android
@@ -206,6 +227,7 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
 #define OIC_LOG_V(level,tag,fmt,args...) LOG_(LOG_ID_MAIN, level, tag, fmt, ##args)
 #define OIC_LOG_BUFFER(level, tag, buffer, bufferSize)\
     OCLogBuffer((level), (tag), (buffer), (bufferSize))
+#define OIC_LOG_SET_ASYNC(enable)
 
 #else // These macros are defined for Linux, Android, Win32, and Arduino
 
@@ -219,6 +241,7 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
 
 #define OIC_LOG_CONFIG(ctx)
 #define OIC_LOG_SHUTDOWN()
+#define OIC_LOG_SET_ASYNC(enable)
 #define OIC_LOG(level, tag, logStr) OCLog((level), PCF(tag), __LINE__, PCF(logStr))
 #define OIC_LOG_V(level, tag, ...)
 
@@ -227,6 +250,7 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
 #define OIC_LOG_BUFFER(level, tag, buffer, bufferSize)  OCLogBuffer((level), (tag), (buffer), (bufferSize))
 #define OIC_LOG_CONFIG(ctx)    OCLogConfig((ctx))
 #define OIC_LOG_SHUTDOWN()     OCLogShutdown()
+#define OIC_LOG_SET_ASYNC(enable)    OCLogSetAsync((enable))
 #define OIC_LOG(level, tag, logStr)  OCLog((level), (tag), (logStr))
 // Define variable argument log function for Linux, Android, and Win32
 #define OIC_LOG_V(level, tag, ...)  OCLogv((level), (tag), __VA_ARGS__)
@@ -238,6 +262,7 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
 
 #define OIC_LOG_CONFIG(ctx)
 #define OIC_LOG_SHUTDOWN()
+#define OIC_LOG_SET_ASYNC(enable)
 #define OIC_LOG(level, tag, logStr)
 #define OIC_LOG_V(level, tag, ...)
 #define OIC_LOG_BUFFER(level, tag, buffer, bufferSize)
@@ -51,6 +51,14 @@
 #include <windows.h>
 #endif
 
+#if !defined(__TIZEN__) && !defined(ARDUINO) && defined(HAVE_PTHREAD_H) \
+    && (defined(__GNUC__) || defined(__clang__))
+#define LOG_ASYNC_SUPPORTED
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#endif
+
 #include "logger.h"
 #include "string.h"
 #include "logger_types.h"
@@ -59,6 +67,109 @@
 static oc_log_ctx_t *logCtx = 0;
 #endif
 
+#ifdef LOG_ASYNC_SUPPORTED
+// Number of records in the ring of each logging thread, a power of two.
+#define LOG_ASYNC_QUEUE_SIZE (128)
+#define LOG_ASYNC_TAG_SIZE (64)
+// Room for the format and copies of its string arguments, or for bytes to dump.
+#define LOG_ASYNC_DATA_SIZE (MAX_LOG_V_BUFFER_SIZE)
+// Formats with more arguments are formatted by the calling thread.
+#define LOG_ASYNC_MAX_ARGS (8)
+// Longest sleep of the writer thread, in case a wakeup is missed.
+#define LOG_ASYNC_WAIT_MS (100)
+
+typedef enum
+{
+    LOG_ASYNC_TEXT = 0,     // data holds the message
+    LOG_ASYNC_FORMAT,       // data holds the format followed by the string arguments
+    LOG_ASYNC_BUFFER        // data holds bytes to dump in hex
+} LogAsyncKind;
+
+typedef enum
+{
+    LOG_ARG_INT = 0,
+    LOG_ARG_LONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_INTMAX,
+    LOG_ARG_SIZE,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LDOUBLE,
+    LOG_ARG_POINTER,
+    LOG_ARG_STRING
+} LogAsyncArgType;
+
+/**
+ * A copied argument of a queued format, read with the type its conversion expects.
+ */
+typedef struct
+{
+    LogAsyncArgType type;
+    union
+    {
+        int i;
+        long l;
+        long long ll;
+        intmax_t im;
+        size_t z;
+        ptrdiff_t t;
+        double d;
+        long double ld;
+        void *p;
+        uint16_t offset;    // of the string copy in data
+    } value;
+} LogAsyncArg;
+
+/**
+ * A queued message.  It is formatted by the writer thread.
+ */
+typedef struct
+{
+    LogLevel level;
+    uint8_t kind;
+    uint8_t argCount;
+    uint16_t length;
+    struct timespec when;
+    char tag[LOG_ASYNC_TAG_SIZE];
+    LogAsyncArg args[LOG_ASYNC_MAX_ARGS];
+    char data[LOG_ASYNC_DATA_SIZE];
+} LogAsyncRecord;
+
+/**
+ * The ring of one logging thread.  Only that thread fills records and moves
+ * head, only the writer thread reads them and moves tail.
+ */
+typedef struct LogAsyncRing
+{
+    uint32_t head;
+    uint32_t tail;
+    uint32_t busy;          // the owner may be filling a record
+    bool orphaned;          // the owner exited, guarded by g_asyncRingsMutex
+    struct LogAsyncRing *next;
+    LogAsyncRecord records[LOG_ASYNC_QUEUE_SIZE];
+} LogAsyncRing;
+
+static __thread LogAsyncRing *t_asyncRing = NULL;
+static LogAsyncRing *g_asyncRings = NULL;
+static pthread_mutex_t g_asyncRingsMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t g_asyncRingKey;
+static pthread_once_t g_asyncRingKeyOnce = PTHREAD_ONCE_INIT;
+static uint32_t g_asyncEnabled = 0;
+static uint32_t g_asyncRunning = 0;
+static uint32_t g_asyncWaiting = 0;
+static uint32_t g_asyncDropped = 0;
+static uint32_t g_asyncReported = 0;        // drops already reported in the log
+static pthread_t g_asyncThread;
+static pthread_mutex_t g_asyncMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_asyncCond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t g_asyncControlMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bool OCLogAsyncPushFormat(LogLevel level, const char * tag, const char * format,
+                                 va_list args);
+static bool OCLogAsyncPushBuffer(LogLevel level, const char * tag,
+                                 const uint8_t * buffer, uint16_t bufferSize);
+#endif
+
 #if defined(_MSC_VER)
 #define LINE_BUFFER_SIZE (16 * 2) + 16 + 1  // Show 16 bytes, 2 chars/byte, spaces between bytes, null termination
 #else
@@ -130,6 +241,13 @@ void OCLogBuffer(LogLevel level, const char * tag, const uint8_t * buffer, uint1
         return;
     }
 
+#ifdef LOG_ASYNC_SUPPORTED
+    if (OCLogAsyncPushBuffer(level, tag, buffer, bufferSize))
+    {
+        return;
+    }
+#endif
+
     // No idea why the static initialization won't work here, it seems the compiler is convinced
     // that this is a variable-sized object.
     char lineBuffer[LINE_BUFFER_SIZE];
@@ -168,6 +286,7 @@ void OCLogInit()
 
 void OCLogShutdown()
 {
+    OCLogSetAsync(false);
 #if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
     if (logCtx && logCtx->destroy)
     {
@@ -189,30 +308,68 @@ void OCLogv(LogLevel level, const char * tag, const char * format, ...)
     if (!format || !tag) {
         return;
     }
-    char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
     va_list args;
     va_start(args, format);
+#ifdef LOG_ASYNC_SUPPORTED
+    if (OCLogAsyncPushFormat(level, tag, format, args))
+    {
+        va_end(args);
+        return;
+    }
+#endif
+    char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
     vsnprintf(buffer, sizeof buffer - 1, format, args);
     va_end(args);
     OCLog(level, tag, buffer);
 }
 
 /**
- * Output a log string with the specified priority level.
- * Only defined for Linux and Android
- *
- * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
- * @param tag    - Module name
- * @param logStr - log string
+ * Get the minute, second and millisecond of the current time.
  */
-void OCLog(LogLevel level, const char * tag, const char * logStr)
+static void OCLogGetTime(int *min, int *sec, int *ms)
 {
-    if (!logStr || !tag)
+    *min = 0;
+    *sec = 0;
+    *ms = 0;
+#if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
+    struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
+    clockid_t clk = CLOCK_REALTIME;
+#ifdef CLOCK_REALTIME_COARSE
+    clk = CLOCK_REALTIME_COARSE;
+#endif
+    if (!clock_gettime(clk, &when))
     {
-       return;
+        *min = (when.tv_sec / 60) % 60;
+        *sec = when.tv_sec % 60;
+        *ms = when.tv_nsec / 1000000;
+    }
+#elif defined(_WIN32)
+    SYSTEMTIME systemTime = {0};
+    GetLocalTime(&systemTime);
+    *min = (int)systemTime.wMinute;
+    *sec = (int)systemTime.wSecond;
+    *ms  = (int)systemTime.wMilliseconds;
+#else
+    struct timeval now;
+    if (!gettimeofday(&now, NULL))
+    {
+        *min = (now.tv_sec / 60) % 60;
+        *sec = now.tv_sec % 60;
+        *ms = now.tv_usec * 1000;
     }
+#endif
+}
 
+/**
+ * Write a log string taken at the given time.
+ */
+static void OCLogWrite(LogLevel level, const char * tag, const char * logStr,
+                       int min, int sec, int ms)
+{
    #ifdef __ANDROID__
+       UNUSED(min);
+       UNUSED(sec);
+       UNUSED(ms);
 
    #ifdef ADB_SHELL
        printf("%s: %s: %s\n", LEVEL[level], tag, logStr);
@@ -228,40 +385,765 @@ void OCLog(LogLevel level, const char * tag, const char * logStr)
        }
        else
        {
-           int min = 0;
-           int sec = 0;
-           int ms = 0;
-   #if defined(_POSIX_TIMERS) && _POSIX_TIMERS > 0
-           struct timespec when = { .tv_sec = 0, .tv_nsec = 0 };
-           clockid_t clk = CLOCK_REALTIME;
-   #ifdef CLOCK_REALTIME_COARSE
-           clk = CLOCK_REALTIME_COARSE;
-   #endif
-           if (!clock_gettime(clk, &when))
-           {
-               min = (when.tv_sec / 60) % 60;
-               sec = when.tv_sec % 60;
-               ms = when.tv_nsec / 1000000;
-           }
-   #elif defined(_WIN32)
-           SYSTEMTIME systemTime = {0};
-           GetLocalTime(&systemTime);
-           min = (int)systemTime.wMinute;
-           sec = (int)systemTime.wSecond;
-           ms  = (int)systemTime.wMilliseconds;
-   #else
-           struct timeval now;
-           if (!gettimeofday(&now, NULL))
-           {
-               min = (now.tv_sec / 60) % 60;
-               sec = now.tv_sec % 60;
-               ms = now.tv_usec * 1000;
-           }
-   #endif
            printf("%02d:%02d.%03d %s: %s: %s\n", min, sec, ms, LEVEL[level], tag, logStr);
        }
    #endif
-   }
+}
+
+#ifdef LOG_ASYNC_SUPPORTED
+static void OCLogAsyncReleaseRing(void *data)
+{
+    LogAsyncRing *ring = (LogAsyncRing *) data;
+    t_asyncRing = NULL;
+
+    pthread_mutex_lock(&g_asyncRingsMutex);
+    if (__atomic_load_n(&ring->tail, __ATOMIC_RELAXED)
+        == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))
+    {
+        LogAsyncRing **link = &g_asyncRings;
+        while (*link != ring)
+        {
+            link = &(*link)->next;
+        }
+        *link = ring->next;
+        free(ring);
+    }
+    else
+    {
+        // The writer thread frees it once the queued messages are written.
+        ring->orphaned = true;
+    }
+    pthread_mutex_unlock(&g_asyncRingsMutex);
+}
+
+static void OCLogAsyncCreateKey()
+{
+    pthread_key_create(&g_asyncRingKey, OCLogAsyncReleaseRing);
+}
+
+/**
+ * Start queueing a message from the calling thread.
+ *
+ * @return ring of the calling thread, or NULL if the message has to be written by the caller
+ */
+static LogAsyncRing *OCLogAsyncBegin()
+{
+    if (!__atomic_load_n(&g_asyncEnabled, __ATOMIC_RELAXED))
+    {
+        return NULL;
+    }
+
+    LogAsyncRing *ring = t_asyncRing;
+    if (!ring)
+    {
+        pthread_once(&g_asyncRingKeyOnce, OCLogAsyncCreateKey);
+        ring = (LogAsyncRing *) calloc(1, sizeof(LogAsyncRing));
+        if (!ring)
+        {
+            return NULL;
+        }
+        pthread_mutex_lock(&g_asyncRingsMutex);
+        ring->next = g_asyncRings;
+        g_asyncRings = ring;
+        pthread_mutex_unlock(&g_asyncRingsMutex);
+        pthread_setspecific(g_asyncRingKey, ring);
+        t_asyncRing = ring;
+    }
+
+    // Announce the producer before checking the mode again, so that stopping waits for it.
+    __atomic_store_n(&ring->busy, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&g_asyncEnabled, __ATOMIC_SEQ_CST))
+    {
+        __atomic_store_n(&ring->busy, 0, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    return ring;
+}
+
+/**
+ * Wake the writer thread if it sleeps and end queueing.
+ */
+static void OCLogAsyncEnd(LogAsyncRing *ring)
+{
+    // Orders the published records before reading the flag of the writer thread.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&g_asyncWaiting, __ATOMIC_RELAXED))
+    {
+        pthread_mutex_lock(&g_asyncMutex);
+        pthread_cond_signal(&g_asyncCond);
+        pthread_mutex_unlock(&g_asyncMutex);
+    }
+    __atomic_store_n(&ring->busy, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Take the next free record of the ring, or count a dropped message if it is full.
+ */
+static LogAsyncRecord *OCLogAsyncReserve(LogAsyncRing *ring, LogLevel level,
+                                         const char * tag, LogAsyncKind kind)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= LOG_ASYNC_QUEUE_SIZE)
+    {
+        __atomic_add_fetch(&g_asyncDropped, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    LogAsyncRecord *record = &ring->records[head & (LOG_ASYNC_QUEUE_SIZE - 1)];
+    record->level = level;
+    record->kind = kind;
+    record->argCount = 0;
+    record->length = 0;
+    clock_gettime(CLOCK_REALTIME, &record->when);
+    size_t i = 0;
+    for (; i < sizeof(record->tag) - 1 && tag[i]; i++)
+    {
+        record->tag[i] = tag[i];
+    }
+    record->tag[i] = '\0';
+    return record;
+}
+
+static void OCLogAsyncPublish(LogAsyncRing *ring)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Queue a log string for the writer thread.
+ *
+ * @return false if the message has to be written by the caller
+ */
+static bool OCLogAsyncPushText(LogLevel level, const char * tag, const char * logStr)
+{
+    LogAsyncRing *ring = OCLogAsyncBegin();
+    if (!ring)
+    {
+        return false;
+    }
+
+    LogAsyncRecord *record = OCLogAsyncReserve(ring, level, tag, LOG_ASYNC_TEXT);
+    if (record)
+    {
+        size_t length = strnlen(logStr, sizeof(record->data) - 1);
+        memcpy(record->data, logStr, length);
+        record->data[length] = '\0';
+        record->length = (uint16_t) length + 1;
+        OCLogAsyncPublish(ring);
+    }
+    OCLogAsyncEnd(ring);
+    return true;
+}
+
+/**
+ * Copy the format and its arguments into the record.  Strings are copied,
+ * so the caller may reuse them as soon as OCLogv returns.
+ *
+ * @return false if the format needs the caller to format it
+ */
+static bool OCLogAsyncCopyArgs(LogAsyncRecord *record, const char * format, va_list args)
+{
+    size_t used = strlen(format) + 1;
+    if (used > sizeof(record->data))
+    {
+        return false;
+    }
+    memcpy(record->data, format, used);
+
+    uint8_t count = 0;
+    for (const char *p = format; *p; p++)
+    {
+        if ('%' != *p)
+        {
+            continue;
+        }
+        p++;
+        if ('%' == *p)
+        {
+            continue;
+        }
+
+        while (*p && strchr("-+ #0'", *p))
+        {
+            p++;
+        }
+        if ('*' == *p)
+        {
+            if (count >= LOG_ASYNC_MAX_ARGS)
+            {
+                return false;
+            }
+            record->args[count].type = LOG_ARG_INT;
+            record->args[count++].value.i = va_arg(args, int);
+            p++;
+        }
+        while ('0' <= *p && '9' >= *p)
+        {
+            p++;
+        }
+
+        int precision = -1;
+        if ('.' == *p)
+        {
+            p++;
+            if ('*' == *p)
+            {
+                if (count >= LOG_ASYNC_MAX_ARGS)
+                {
+                    return false;
+                }
+                precision = va_arg(args, int);
+                record->args[count].type = LOG_ARG_INT;
+                record->args[count++].value.i = precision;
+                p++;
+            }
+            else
+            {
+                precision = 0;
+                while ('0' <= *p && '9' >= *p)
+                {
+                    precision = precision * 10 + (*p - '0');
+                    p++;
+                }
+            }
+        }
+
+        LogAsyncArgType type = LOG_ARG_INT;
+        bool isLongDouble = false;
+        switch (*p)
+        {
+            case 'h':
+                p += ('h' == p[1]) ? 2 : 1;
+                break;
+            case 'l':
+                type = ('l' == p[1]) ? LOG_ARG_LLONG : LOG_ARG_LONG;
+                p += ('l' == p[1]) ? 2 : 1;
+                break;
+            case 'j':
+                type = LOG_ARG_INTMAX;
+                p++;
+                break;
+            case 'z':
+                type = LOG_ARG_SIZE;
+                p++;
+                break;
+            case 't':
+                type = LOG_ARG_PTRDIFF;
+                p++;
+                break;
+            case 'L':
+                isLongDouble = true;
+                p++;
+                break;
+            default:
+                break;
+        }
+
+        if (count >= LOG_ASYNC_MAX_ARGS)
+        {
+            return false;
+        }
+        LogAsyncArg *arg = &record->args[count++];
+        switch (*p)
+        {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                if (isLongDouble)
+                {
+                    return false;
+                }
+                arg->type = type;
+                switch (type)
+                {
+                    case LOG_ARG_LONG:
+                        arg->value.l = va_arg(args, long);
+                        break;
+                    case LOG_ARG_LLONG:
+                        arg->value.ll = va_arg(args, long long);
+                        break;
+                    case LOG_ARG_INTMAX:
+                        arg->value.im = va_arg(args, intmax_t);
+                        break;
+                    case LOG_ARG_SIZE:
+                        arg->value.z = va_arg(args, size_t);
+                        break;
+                    case LOG_ARG_PTRDIFF:
+                        arg->value.t = va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        arg->value.i = va_arg(args, int);
+                        break;
+                }
+                break;
+            case 'c':
+                if (LOG_ARG_INT != type || isLongDouble)
+                {
+                    return false;
+                }
+                arg->type = LOG_ARG_INT;
+                arg->value.i = va_arg(args, int);
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (isLongDouble)
+                {
+                    arg->type = LOG_ARG_LDOUBLE;
+                    arg->value.ld = va_arg(args, long double);
+                }
+                else
+                {
+                    arg->type = LOG_ARG_DOUBLE;
+                    arg->value.d = va_arg(args, double);
+                }
+                break;
+            case 'p':
+                arg->type = LOG_ARG_POINTER;
+                arg->value.p = va_arg(args, void *);
+                break;
+            case 's':
+            {
+                if (LOG_ARG_INT != type || isLongDouble || used >= sizeof(record->data))
+                {
+                    return false;
+                }
+                const char *str = va_arg(args, const char *);
+                if (!str)
+                {
+                    str = "(null)";
+                }
+                size_t room = sizeof(record->data) - used - 1;
+                size_t length = strnlen(str, (0 <= precision && (size_t) precision < room) ?
+                                             (size_t) precision : room);
+                memcpy(record->data + used, str, length);
+                record->data[used + length] = '\0';
+                arg->type = LOG_ARG_STRING;
+                arg->value.offset = (uint16_t) used;
+                used += length + 1;
+                break;
+            }
+            default:
+                // %n, %m, wide characters and unknown conversions.
+                return false;
+        }
+    }
+
+    record->argCount = count;
+    record->length = (uint16_t) used;
+    return true;
+}
+
+/**
+ * Queue a format and copies of its arguments for the writer thread.
+ *
+ * @return false if the message has to be formatted by the caller
+ */
+static bool OCLogAsyncPushFormat(LogLevel level, const char * tag, const char * format,
+                                 va_list args)
+{
+    LogAsyncRing *ring = OCLogAsyncBegin();
+    if (!ring)
+    {
+        return false;
+    }
+
+    bool queued = true;
+    LogAsyncRecord *record = OCLogAsyncReserve(ring, level, tag, LOG_ASYNC_FORMAT);
+    if (record)
+    {
+        va_list copy;
+        va_copy(copy, args);
+        queued = OCLogAsyncCopyArgs(record, format, copy);
+        va_end(copy);
+        if (queued)
+        {
+            OCLogAsyncPublish(ring);
+        }
+    }
+    OCLogAsyncEnd(ring);
+    return queued;
+}
+
+/**
+ * Queue bytes to dump for the writer thread, in records of whole lines.
+ *
+ * @return false if the buffer has to be written by the caller
+ */
+static bool OCLogAsyncPushBuffer(LogLevel level, const char * tag,
+                                 const uint8_t * buffer, uint16_t bufferSize)
+{
+    LogAsyncRing *ring = OCLogAsyncBegin();
+    if (!ring)
+    {
+        return false;
+    }
+
+    const uint16_t chunk = (LOG_ASYNC_DATA_SIZE / 16) * 16;
+    for (uint16_t offset = 0; offset < bufferSize; offset += chunk)
+    {
+        LogAsyncRecord *record = OCLogAsyncReserve(ring, level, tag, LOG_ASYNC_BUFFER);
+        if (record)
+        {
+            uint16_t length = (bufferSize - offset < chunk) ? bufferSize - offset : chunk;
+            memcpy(record->data, buffer + offset, length);
+            record->length = length;
+            OCLogAsyncPublish(ring);
+        }
+    }
+    OCLogAsyncEnd(ring);
+    return true;
+}
+
+/**
+ * Format a queued format and its copied arguments.
+ */
+static void OCLogAsyncFormat(const LogAsyncRecord *record, char *buffer, size_t size)
+{
+    size_t used = 0;
+    uint8_t next = 0;
+    const char *p = record->data;
+    while (*p && used < size - 1)
+    {
+        if ('%' != *p || '%' == p[1])
+        {
+            buffer[used++] = *p;
+            p += ('%' == *p) ? 2 : 1;
+            continue;
+        }
+
+        // The conversion with the queued width and precision in place of '*'.
+        char spec[32];
+        size_t specLength = 0;
+        spec[specLength++] = *p++;
+        while (!strchr("diouxXcseEfFgGaAp", *p))
+        {
+            if ('*' == *p)
+            {
+                int value = record->args[next++].value.i;
+                if (0 > value && '.' == spec[specLength - 1])
+                {
+                    // A negative precision is taken as if it were omitted.
+                    specLength--;
+                }
+                else
+                {
+                    size_t room = sizeof(spec) - 1 - specLength;
+                    int length = snprintf(spec + specLength, room, "%d", value);
+                    if (0 < length)
+                    {
+                        specLength += ((size_t) length < room) ? (size_t) length : room - 1;
+                    }
+                }
+            }
+            else if (specLength < sizeof(spec) - 2)
+            {
+                spec[specLength++] = *p;
+            }
+            p++;
+        }
+        spec[specLength++] = *p++;
+        spec[specLength] = '\0';
+
+        const LogAsyncArg *arg = &record->args[next++];
+        char *out = buffer + used;
+        size_t room = size - used;
+        int length = 0;
+        switch (arg->type)
+        {
+            case LOG_ARG_LONG:
+                length = snprintf(out, room, spec, arg->value.l);
+                break;
+            case LOG_ARG_LLONG:
+                length = snprintf(out, room, spec, arg->value.ll);
+                break;
+            case LOG_ARG_INTMAX:
+                length = snprintf(out, room, spec, arg->value.im);
+                break;
+            case LOG_ARG_SIZE:
+                length = snprintf(out, room, spec, arg->value.z);
+                break;
+            case LOG_ARG_PTRDIFF:
+                length = snprintf(out, room, spec, arg->value.t);
+                break;
+            case LOG_ARG_DOUBLE:
+                length = snprintf(out, room, spec, arg->value.d);
+                break;
+            case LOG_ARG_LDOUBLE:
+                length = snprintf(out, room, spec, arg->value.ld);
+                break;
+            case LOG_ARG_POINTER:
+                length = snprintf(out, room, spec, arg->value.p);
+                break;
+            case LOG_ARG_STRING:
+                length = snprintf(out, room, spec, record->data + arg->value.offset);
+                break;
+            default:
+                length = snprintf(out, room, spec, arg->value.i);
+                break;
+        }
+        if (0 < length)
+        {
+            used += ((size_t) length < room) ? (size_t) length : room - 1;
+        }
+    }
+    buffer[used] = '\0';
+}
+
+static void OCLogAsyncWriteRecord(const LogAsyncRecord *record)
+{
+    int min = (record->when.tv_sec / 60) % 60;
+    int sec = record->when.tv_sec % 60;
+    int ms = record->when.tv_nsec / 1000000;
+
+    if (LOG_ASYNC_TEXT == record->kind)
+    {
+        OCLogWrite(record->level, record->tag, record->data, min, sec, ms);
+    }
+    else if (LOG_ASYNC_FORMAT == record->kind)
+    {
+        char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
+        OCLogAsyncFormat(record, buffer, sizeof buffer - 1);
+        OCLogWrite(record->level, record->tag, buffer, min, sec, ms);
+    }
+    else
+    {
+        const uint8_t *bytes = (const uint8_t *) record->data;
+        for (uint16_t line = 0; line < record->length; line += 16)
+        {
+            char lineBuffer[LINE_BUFFER_SIZE];
+            memset(lineBuffer, 0, sizeof lineBuffer);
+            for (uint16_t i = line; i < record->length && i < line + 16; i++)
+            {
+                snprintf(&lineBuffer[(i - line) * 3], sizeof(lineBuffer) - (i - line) * 3,
+                         "%02X ", bytes[i]);
+            }
+            OCLogWrite(record->level, record->tag, lineBuffer, min, sec, ms);
+        }
+    }
+}
+
+static bool OCLogAsyncIsEmpty()
+{
+    bool empty = true;
+    pthread_mutex_lock(&g_asyncRingsMutex);
+    for (LogAsyncRing *ring = g_asyncRings; ring && empty; ring = ring->next)
+    {
+        empty = (__atomic_load_n(&ring->tail, __ATOMIC_RELAXED)
+                 == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE));
+    }
+    pthread_mutex_unlock(&g_asyncRingsMutex);
+    return empty;
+}
+
+/**
+ * Write the queued messages, oldest first over all threads.  Messages of one
+ * thread are always written in the order it logged them.  Only called by the
+ * writer thread, or after it stopped.
+ *
+ * @return number of written messages
+ */
+static uint32_t OCLogAsyncDrain()
+{
+    uint32_t written = 0;
+    pthread_mutex_lock(&g_asyncRingsMutex);
+    for (;;)
+    {
+        LogAsyncRing *oldest = NULL;
+        const LogAsyncRecord *oldestRecord = NULL;
+        for (LogAsyncRing *ring = g_asyncRings; ring; ring = ring->next)
+        {
+            uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+            if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))
+            {
+                continue;
+            }
+            const LogAsyncRecord *record = &ring->records[tail & (LOG_ASYNC_QUEUE_SIZE - 1)];
+            if (!oldestRecord || record->when.tv_sec < oldestRecord->when.tv_sec
+                || (record->when.tv_sec == oldestRecord->when.tv_sec
+                    && record->when.tv_nsec < oldestRecord->when.tv_nsec))
+            {
+                oldest = ring;
+                oldestRecord = record;
+            }
+        }
+        if (!oldest)
+        {
+            break;
+        }
+
+        OCLogAsyncWriteRecord(oldestRecord);
+        // Hand the record back to the producer.
+        uint32_t tail = __atomic_load_n(&oldest->tail, __ATOMIC_RELAXED);
+        __atomic_store_n(&oldest->tail, tail + 1, __ATOMIC_RELEASE);
+        written++;
+    }
+
+    // Free the rings of exited threads.
+    LogAsyncRing **link = &g_asyncRings;
+    while (*link)
+    {
+        LogAsyncRing *ring = *link;
+        if (ring->orphaned && __atomic_load_n(&ring->tail, __ATOMIC_RELAXED)
+                              == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))
+        {
+            *link = ring->next;
+            free(ring);
+        }
+        else
+        {
+            link = &ring->next;
+        }
+    }
+    pthread_mutex_unlock(&g_asyncRingsMutex);
+
+    uint32_t dropped = __atomic_load_n(&g_asyncDropped, __ATOMIC_RELAXED);
+    if (dropped != g_asyncReported)
+    {
+        char buffer[MAX_LOG_V_BUFFER_SIZE] = {0};
+        snprintf(buffer, sizeof buffer, "%u log messages dropped", dropped - g_asyncReported);
+        g_asyncReported = dropped;
+
+        int min = 0;
+        int sec = 0;
+        int ms = 0;
+        OCLogGetTime(&min, &sec, &ms);
+        OCLogWrite(WARNING, "OIC_LOGGER", buffer, min, sec, ms);
+    }
+    return written;
+}
+
+static void *OCLogAsyncRoutine(void *arg)
+{
+    UNUSED(arg);
+    while (__atomic_load_n(&g_asyncRunning, __ATOMIC_ACQUIRE))
+    {
+        if (OCLogAsyncDrain())
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&g_asyncMutex);
+        __atomic_store_n(&g_asyncWaiting, 1, __ATOMIC_RELAXED);
+        // Orders the flag before the emptiness check.
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (OCLogAsyncIsEmpty() && __atomic_load_n(&g_asyncRunning, __ATOMIC_ACQUIRE))
+        {
+            struct timespec until = { .tv_sec = 0, .tv_nsec = 0 };
+            clock_gettime(CLOCK_REALTIME, &until);
+            until.tv_nsec += LOG_ASYNC_WAIT_MS * 1000000L;
+            if (until.tv_nsec >= 1000000000L)
+            {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&g_asyncCond, &g_asyncMutex, &until);
+        }
+        __atomic_store_n(&g_asyncWaiting, 0, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&g_asyncMutex);
+    }
+    return NULL;
+}
+#endif // LOG_ASYNC_SUPPORTED
+
+bool OCLogSetAsync(bool enable)
+{
+#ifdef LOG_ASYNC_SUPPORTED
+    bool result = true;
+    pthread_mutex_lock(&g_asyncControlMutex);
+    bool enabled = (0 != __atomic_load_n(&g_asyncEnabled, __ATOMIC_SEQ_CST));
+    if (enable && !enabled)
+    {
+        __atomic_store_n(&g_asyncRunning, 1, __ATOMIC_SEQ_CST);
+        if (pthread_create(&g_asyncThread, NULL, OCLogAsyncRoutine, NULL))
+        {
+            result = false;
+        }
+        else
+        {
+            __atomic_store_n(&g_asyncEnabled, 1, __ATOMIC_SEQ_CST);
+        }
+    }
+    else if (!enable && enabled)
+    {
+        __atomic_store_n(&g_asyncEnabled, 0, __ATOMIC_SEQ_CST);
+        // Wait for the threads that are queueing a message.
+        pthread_mutex_lock(&g_asyncRingsMutex);
+        for (LogAsyncRing *ring = g_asyncRings; ring; ring = ring->next)
+        {
+            while (__atomic_load_n(&ring->busy, __ATOMIC_SEQ_CST))
+            {
+                sched_yield();
+            }
+        }
+        pthread_mutex_unlock(&g_asyncRingsMutex);
+
+        pthread_mutex_lock(&g_asyncMutex);
+        __atomic_store_n(&g_asyncRunning, 0, __ATOMIC_SEQ_CST);
+        pthread_cond_signal(&g_asyncCond);
+        pthread_mutex_unlock(&g_asyncMutex);
+        pthread_join(g_asyncThread, NULL);
+
+        OCLogAsyncDrain();
+    }
+    pthread_mutex_unlock(&g_asyncControlMutex);
+    return result;
+#else
+    return !enable;
+#endif
+}
+
+uint32_t OCLogGetDroppedCount()
+{
+#ifdef LOG_ASYNC_SUPPORTED
+    return __atomic_load_n(&g_asyncDropped, __ATOMIC_RELAXED);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Output a log string with the specified priority level.
+ * Only defined for Linux and Android
+ *
+ * @param level  - DEBUG, INFO, WARNING, ERROR, FATAL
+ * @param tag    - Module name
+ * @param logStr - log string
+ */
+void OCLog(LogLevel level, const char * tag, const char * logStr)
+{
+    if (!logStr || !tag)
+    {
+       return;
+    }
+
+#ifdef LOG_ASYNC_SUPPORTED
+    if (OCLogAsyncPushText(level, tag, logStr))
+    {
+        return;
+    }
+#endif
+
+    int min = 0;
+    int sec = 0;
+    int ms = 0;
+#ifndef __ANDROID__
+    if (!logCtx || !logCtx->write_level)
+    {
+        OCLogGetTime(&min, &sec, &ms);
+    }
+#endif
+    OCLogWrite(level, tag, logStr, min, sec, ms);
+}
 #endif //__TIZEN__
 #endif //ARDUINO
 #ifdef ARDUINO
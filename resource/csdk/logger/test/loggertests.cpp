@@ -36,8 +36,27 @@ extern "C" {
 
 #include <iostream>
 #include <stdint.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
 using namespace std;
 
+#ifdef LOGGER_BUILD_TEST_DIR
+#define STR_DIR(val) #val
+#define STRINGIZE_DIR(name) STR_DIR(name)
+
+// The expected output files are installed next to the test binary.
+class LoggerTestEnvironment : public testing::Environment {
+public:
+    virtual void SetUp() {
+        ASSERT_EQ(0, chdir(STRINGIZE_DIR(LOGGER_BUILD_TEST_DIR)));
+    }
+};
+
+static testing::Environment * const loggerTestEnvironment =
+    testing::AddGlobalTestEnvironment(new LoggerTestEnvironment);
+#endif
+
 
 //-----------------------------------------------------------------------------
 // file_exist citation -
@@ -104,8 +123,9 @@ bool directStdOutToConsole() {
 #define PATH_LEN 256
 #define MD5_LEN 32
 
+// The time stamp and the trailing space of hex dumps are not part of the expected output.
 bool CalcFileMD5(const char *file_name, char *md5_sum) {
-    #define MD5SUM_CMD_FMT "md5sum %." STR(PATH_LEN) "s 2>/dev/null"
+    #define MD5SUM_CMD_FMT "sed -E 's/^[0-9]{2}:[0-9]{2}\\.[0-9]{3} //; s/ +$//' %." STR(PATH_LEN) "s 2>/dev/null | md5sum"
     char cmd[PATH_LEN + sizeof (MD5SUM_CMD_FMT)];
     snprintf(cmd, sizeof(cmd), MD5SUM_CMD_FMT, file_name);
     #undef MD5SUM_CMD_FMT
@@ -364,3 +384,132 @@ TEST(LoggerTest, LogBuffer) {
         EXPECT_STREQ(stdFileMD5, testFileMD5);
     }
 }
+
+//-----------------------------------------------------------------------------
+//  Asynchronous mode
+//-----------------------------------------------------------------------------
+static pthread_mutex_t capturedMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t capturedCond = PTHREAD_COND_INITIALIZER;
+static vector<string> captured;
+static bool writerBlocked = false;
+
+static size_t captureWrite(oc_log_ctx_t *ctx, const int level, const char *msg) {
+    (void)ctx;
+    (void)level;
+    pthread_mutex_lock(&capturedMutex);
+    while (writerBlocked) {
+        pthread_cond_wait(&capturedCond, &capturedMutex);
+    }
+    captured.push_back(msg);
+    pthread_mutex_unlock(&capturedMutex);
+    return strlen(msg);
+}
+
+static void blockWriter(bool block) {
+    pthread_mutex_lock(&capturedMutex);
+    writerBlocked = block;
+    pthread_cond_broadcast(&capturedCond);
+    pthread_mutex_unlock(&capturedMutex);
+}
+
+class LoggerAsyncTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        captured.clear();
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.write_level = captureWrite;
+        OCLogConfig(&ctx);
+        ASSERT_TRUE(OCLogSetAsync(true));
+    }
+
+    virtual void TearDown() {
+        blockWriter(false);
+        OCLogSetAsync(false);
+        OCLogConfig(NULL);
+    }
+
+    oc_log_ctx_t ctx;
+};
+
+TEST_F(LoggerAsyncTest, FormatsCopiedArguments) {
+    const char *tag = "Async";
+    char name[16] = "first";
+    OIC_LOG_V(DEBUG, tag, "%s %d %5.2f %c %zu %lld %.3s|%*d|%-4s|%%", name, -7, 123.45, 'A',
+              (size_t)42, 1234567890123LL, "abcdef", 4, 9, "ab");
+    // The writer formats later, the copy must not see the new contents.
+    strcpy(name, "second");
+    OIC_LOG_V(DEBUG, tag, "%s %.*s %p", name, 2, "xyz", (void *)0x10);
+    OCLogSetAsync(false);
+
+    char expected[64];
+    snprintf(expected, sizeof(expected), "second xy %p", (void *)0x10);
+    ASSERT_EQ(2u, captured.size());
+    EXPECT_EQ("first -7 123.45 A 42 1234567890123 abc|   9|ab  |%", captured[0]);
+    EXPECT_EQ(expected, captured[1]);
+}
+
+TEST_F(LoggerAsyncTest, LogBuffer) {
+    uint8_t buffer[300];
+    for (int i = 0; i < (int)(sizeof buffer); i++) {
+        buffer[i] = (uint8_t)i;
+    }
+    OIC_LOG_BUFFER(DEBUG, "Async", buffer, sizeof buffer);
+    OCLogSetAsync(false);
+
+    ASSERT_EQ((sizeof buffer + 15) / 16, captured.size());
+    EXPECT_EQ("00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F ", captured[0]);
+    EXPECT_EQ("F0 F1 F2 F3 F4 F5 F6 F7 F8 F9 FA FB FC FD FE FF ", captured[15]);
+    EXPECT_EQ("20 21 22 23 24 25 26 27 28 29 2A 2B ", captured.back());
+}
+
+TEST_F(LoggerAsyncTest, DropsWhenQueueIsFull) {
+    const int messages = 1000;
+    uint32_t dropped = OCLogGetDroppedCount();
+
+    // The writer blocks on the first message, so the queue fills up.
+    blockWriter(true);
+    for (int i = 0; i < messages; i++) {
+        OIC_LOG_V(INFO, "Async", "message %d", i);
+    }
+    uint32_t newlyDropped = OCLogGetDroppedCount() - dropped;
+    blockWriter(false);
+    OCLogSetAsync(false);
+
+    EXPECT_LT(0u, newlyDropped);
+    // Written messages, followed by the report of the dropped ones.
+    ASSERT_EQ(messages - newlyDropped + 1, captured.size());
+    for (size_t i = 0; i + 1 < captured.size(); i++) {
+        EXPECT_EQ("message " + to_string(i), captured[i]);
+    }
+    EXPECT_EQ(to_string(newlyDropped) + " log messages dropped", captured.back());
+}
+
+static void *logSequence(void *arg) {
+    long thread = (long)arg;
+    for (int i = 0; i < 100; i++) {
+        OIC_LOG_V(INFO, "Async", "thread %ld message %d", thread, i);
+    }
+    return NULL;
+}
+
+TEST_F(LoggerAsyncTest, KeepsOrderOfEachThread) {
+    const long threads = 4;
+    pthread_t ids[threads];
+    for (long t = 0; t < threads; t++) {
+        ASSERT_EQ(0, pthread_create(&ids[t], NULL, logSequence, (void *)t));
+    }
+    for (long t = 0; t < threads; t++) {
+        pthread_join(ids[t], NULL);
+    }
+    OCLogSetAsync(false);
+
+    ASSERT_EQ(400u, captured.size());
+    int next[threads] = {0};
+    for (size_t i = 0; i < captured.size(); i++) {
+        long thread = -1;
+        int message = -1;
+        ASSERT_EQ(2, sscanf(captured[i].c_str(), "thread %ld message %d", &thread, &message));
+        ASSERT_TRUE(thread >= 0 && thread < threads);
+        EXPECT_EQ(next[thread]++, message);
+    }
+}
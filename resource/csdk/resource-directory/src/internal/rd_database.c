@@ -50,6 +50,16 @@ static const uint8_t rt_link_id_index = 2;
 static const uint8_t if_value_index = 1;
 static const uint8_t if_link_id_index = 2;
 
+// Columns of the link queries.
+static const uint8_t link_ins_column = 0;
+static const uint8_t link_uri_column = 1;
+static const uint8_t link_p_column = 2;
+static const uint8_t link_device_column = 3;
+static const uint8_t link_di_column = 4;
+static const uint8_t link_address_column = 5;
+static const uint8_t link_rt_column = 6;
+static const uint8_t link_if_column = 7;
+
 #define VERIFY_SQLITE(arg) \
     if (SQLITE_OK != (arg)) \
     { \
@@ -97,6 +107,69 @@ static const uint8_t if_link_id_index = 2;
     "FOREIGN KEY("XSTR(LINK_ID)") REFERENCES RD_DEVICE_LINK_LIST("XSTR(OC_RSRVD_INS)") " \
     "ON DELETE CASCADE);"
 
+#define RD_INDEXES \
+    "create index if not exists RD_LINK_LIST_DEVICE_ID on RD_DEVICE_LINK_LIST(DEVICE_ID);" \
+    "create index if not exists RD_LINK_RT_LINK_ID on RD_LINK_RT(LINK_ID);" \
+    "create index if not exists RD_LINK_IF_LINK_ID on RD_LINK_IF(LINK_ID);"
+
+#define RD_LINK_MATCH_RT \
+    "L." XSTR(OC_RSRVD_INS) " IN (SELECT LINK_ID FROM RD_LINK_RT WHERE " \
+    XSTR(OC_RSRVD_RESOURCE_TYPE) " LIKE ?1)"
+
+#define RD_LINK_MATCH_IF \
+    "L." XSTR(OC_RSRVD_INS) " IN (SELECT LINK_ID FROM RD_LINK_IF WHERE " \
+    XSTR(OC_RSRVD_INTERFACE) " LIKE ?2)"
+
+#define RD_LINK_COLUMNS \
+    "SELECT L." XSTR(OC_RSRVD_INS) ", L." XSTR(OC_RSRVD_HREF) ", L." XSTR(OC_RSRVD_BITMAP) ", " \
+    "D.ID, D." XSTR(OC_RSRVD_DEVICE_ID) ", D.ADDRESS, "
+
+#define RD_LINK_JOIN \
+    " FROM RD_DEVICE_LINK_LIST AS L INNER JOIN RD_DEVICE_LIST AS D ON L.DEVICE_ID = D.ID "
+
+/*
+ * Returns the matching links in one query: a row per resource type and a
+ * row per interface of each link, with the link and device columns repeated,
+ * ordered by device and link.
+ */
+#define RD_SELECT_LINKS(match) \
+    RD_LINK_COLUMNS "T." XSTR(OC_RSRVD_RESOURCE_TYPE) ", NULL" RD_LINK_JOIN \
+    "INNER JOIN RD_LINK_RT AS T ON T.LINK_ID = L." XSTR(OC_RSRVD_INS) " WHERE " match \
+    " UNION ALL " \
+    RD_LINK_COLUMNS "NULL, I." XSTR(OC_RSRVD_INTERFACE) RD_LINK_JOIN \
+    "INNER JOIN RD_LINK_IF AS I ON I.LINK_ID = L." XSTR(OC_RSRVD_INS) " WHERE " match \
+    " ORDER BY 4, 1"
+
+/**
+ * Statements that are prepared once the database is open and kept until it is closed.
+ */
+typedef enum
+{
+    RD_INSERT_DEVICE = 0,
+    RD_INSERT_LINK,
+    RD_INSERT_RT,
+    RD_INSERT_IF,
+    RD_DELETE_DEVICE,
+    RD_SELECT_LINKS_BY_RT,
+    RD_SELECT_LINKS_BY_IF,
+    RD_SELECT_LINKS_BY_RT_IF,
+    RD_STATEMENT_COUNT
+} RDStatement;
+
+static const char *gRDStatementSQL[RD_STATEMENT_COUNT] =
+{
+    "INSERT INTO RD_DEVICE_LIST VALUES(?,?,?,?)",
+    "INSERT INTO RD_DEVICE_LINK_LIST VALUES(?,?,?,?,?,?,?,?)",
+    "INSERT INTO RD_LINK_RT VALUES(?, ?)",
+    "INSERT INTO RD_LINK_IF VALUES(?, ?)",
+    "DELETE FROM RD_DEVICE_LIST WHERE "XSTR(OC_RSRVD_DEVICE_ID)" = ?",
+    RD_SELECT_LINKS(RD_LINK_MATCH_RT),
+    RD_SELECT_LINKS(RD_LINK_MATCH_IF),
+    RD_SELECT_LINKS(RD_LINK_MATCH_RT " AND " RD_LINK_MATCH_IF)
+};
+
+static sqlite3_stmt *gRDStatements[RD_STATEMENT_COUNT];
+
 static void errorCallback(void *arg, int errCode, const char *errMsg)
 {
     OC_UNUSED(arg);
@@ -105,50 +178,108 @@ static void errorCallback(void *arg, int errCode, const char *errMsg)
     OIC_LOG_V(ERROR, TAG, "SQLLite Error: %s : %d", errMsg, errCode);
 }
 
-OCStackResult OCRDDatabaseInit(const char *path)
+static void finalizeStatements()
 {
-    if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
+    for (size_t i = 0; i < RD_STATEMENT_COUNT; i++)
     {
-        OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
+        sqlite3_finalize(gRDStatements[i]);
+        gRDStatements[i] = NULL;
     }
+}
 
+static OCStackResult prepareStatements()
+{
+    for (size_t i = 0; i < RD_STATEMENT_COUNT; i++)
+    {
+        if (SQLITE_OK != sqlite3_prepare_v2(gRDDB, gRDStatementSQL[i], -1, &gRDStatements[i], NULL))
+        {
+            OIC_LOG_V(ERROR, TAG, "Error in preparing %s, Error Message: %s",
+                      gRDStatementSQL[i], sqlite3_errmsg(gRDDB));
+            finalizeStatements();
+            return OC_STACK_ERROR;
+        }
+    }
+    return OC_STACK_OK;
+}
+
+/**
+ * Returns a prepared statement, reset and without bindings.
+ */
+static sqlite3_stmt *getStatement(RDStatement statement)
+{
+    sqlite3_stmt *stmt = gRDStatements[statement];
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return stmt;
+}
+
+/**
+ * Opens the database, creating it if needed, and prepares the statements.
+ * gRDDB is left for the caller to close on failure.
+ */
+static OCStackResult openDatabase(const char *path)
+{
     int sqlRet;
     sqlRet = sqlite3_open_v2(!path ? RD_PATH : path, &gRDDB, SQLITE_OPEN_READWRITE, NULL);
     if (SQLITE_OK != sqlRet)
     {
         OIC_LOG(DEBUG, TAG, "RD database file did not open, as no table exists.");
         OIC_LOG(DEBUG, TAG, "RD creating new table.");
-        sqlRet = sqlite3_open_v2(!path ? RD_PATH : path, &gRDDB,
-                                 SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
-        if (SQLITE_OK == sqlRet)
-        {
-            VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_TABLE, NULL, NULL, NULL));
-            OIC_LOG(DEBUG, TAG, "RD created RD_DEVICE_LIST table.");
+        sqlite3_close(gRDDB);
+        gRDDB = NULL;
+        VERIFY_SQLITE(sqlite3_open_v2(!path ? RD_PATH : path, &gRDDB,
+                                      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL));
 
-            VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_LL_TABLE, NULL, NULL, NULL));
-            OIC_LOG(DEBUG, TAG, "RD created RD_DEVICE_LINK_LIST table.");
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_TABLE, NULL, NULL, NULL));
+        OIC_LOG(DEBUG, TAG, "RD created RD_DEVICE_LIST table.");
 
-            VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_RT_TABLE, NULL, NULL, NULL));
-            OIC_LOG(DEBUG, TAG, "RD created RD_LINK_RT table.");
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_LL_TABLE, NULL, NULL, NULL));
+        OIC_LOG(DEBUG, TAG, "RD created RD_DEVICE_LINK_LIST table.");
 
-            VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_IF_TABLE, NULL, NULL, NULL));
-            OIC_LOG(DEBUG, TAG, "RD created RD_LINK_IF table.");
-            sqlRet = SQLITE_OK;
-        }
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_RT_TABLE, NULL, NULL, NULL));
+        OIC_LOG(DEBUG, TAG, "RD created RD_LINK_RT table.");
+
+        VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_IF_TABLE, NULL, NULL, NULL));
+        OIC_LOG(DEBUG, TAG, "RD created RD_LINK_IF table.");
     }
 
-    if (sqlRet == SQLITE_OK)
+    sqlite3_stmt *stmt = 0;
+    VERIFY_SQLITE(sqlite3_prepare_v2 (gRDDB, "PRAGMA foreign_keys = ON;", -1, &stmt, NULL));
+
+    if (sqlite3_step(stmt) != SQLITE_DONE)
     {
-        sqlite3_stmt *stmt = 0;
-        VERIFY_SQLITE(sqlite3_prepare_v2 (gRDDB, "PRAGMA foreign_keys = ON;", -1, &stmt, NULL));
+        sqlite3_finalize(stmt);
+        return OC_STACK_ERROR;
+    }
 
-        if (sqlite3_step(stmt) != SQLITE_DONE)
-        {
-            sqlite3_finalize(stmt);
-            return OC_STACK_ERROR;
-        }
+    VERIFY_SQLITE(sqlite3_finalize(stmt));
+
+    // Databases created before the indexes existed get them here.
+    VERIFY_SQLITE(sqlite3_exec(gRDDB, RD_INDEXES, NULL, NULL, NULL));
+
+    return prepareStatements();
+}
 
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
+OCStackResult OCRDDatabaseInit(const char *path)
+{
+    if (gRDDB)
+    {
+        // Already open, the publish handler initializes the database for every request.
+        return OC_STACK_OK;
+    }
+
+    if (SQLITE_OK == sqlite3_config(SQLITE_CONFIG_LOG, errorCallback))
+    {
+        OIC_LOG_V(INFO, TAG, "SQLite debugging log initialized.");
+    }
+
+    if (OC_STACK_OK != openDatabase(path))
+    {
+        // The next call opens the database again instead of using a half initialized one.
+        finalizeStatements();
+        sqlite3_close_v2(gRDDB);
+        gRDDB = NULL;
+        return OC_STACK_ERROR;
     }
 
     return OC_STACK_OK;
@@ -157,161 +288,148 @@ OCStackResult OCRDDatabaseInit(const char *path)
 OCStackResult OCRDDatabaseClose()
 {
     CHECK_DATABASE_INIT;
+    finalizeStatements();
     VERIFY_SQLITE(sqlite3_close_v2(gRDDB));
+    gRDDB = NULL;
     return OC_STACK_OK;
 }
 
-static int storeResourceType(char **link, size_t size, uint8_t rowid)
+static int storeResourceType(char **link, size_t size, int64_t rowid)
 {
-    int res = 1;
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
-
-    const char *insertRT = "INSERT INTO RD_LINK_RT VALUES(?, ?)";
-    sqlite3_stmt *stmtRT = 0;
-
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertRT, strlen(insertRT) + 1, &stmtRT, NULL));
+        sqlite3_stmt *stmtRT = getStatement(RD_INSERT_RT);
         if (link[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmtRT, rt_value_index, link[i],
                     strlen(link[i])+1, SQLITE_STATIC));
 
-            VERIFY_SQLITE(sqlite3_bind_int(stmtRT, rt_link_id_index, rowid));
+            VERIFY_SQLITE(sqlite3_bind_int64(stmtRT, rt_link_id_index, rowid));
         }
         if (sqlite3_step(stmtRT) != SQLITE_DONE)
         {
-            sqlite3_finalize(stmtRT);
-            return res;
+            return 1;
         }
     }
-
-    VERIFY_SQLITE(sqlite3_finalize(stmtRT));
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
-    res = SQLITE_OK;
-
-    return res;
+    return SQLITE_OK;
 }
 
-
-static int storeInterfaceType(char **link, size_t size, uint8_t rowid)
+static int storeInterfaceType(char **link, size_t size, int64_t rowid)
 {
-    int res = 1;
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
-
-    const char *insertIF = "INSERT INTO RD_LINK_IF VALUES(?, ?)";
-    sqlite3_stmt *stmtIF = 0;
-
     for (size_t i = 0; i < size; i++)
     {
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertIF, strlen(insertIF) + 1, &stmtIF, NULL));
-
+        sqlite3_stmt *stmtIF = getStatement(RD_INSERT_IF);
         if (link[i])
         {
             VERIFY_SQLITE(sqlite3_bind_text(stmtIF, if_value_index, link[i], strlen(link[i])+1, SQLITE_STATIC));
-            VERIFY_SQLITE(sqlite3_bind_int(stmtIF, if_link_id_index, rowid));
+            VERIFY_SQLITE(sqlite3_bind_int64(stmtIF, if_link_id_index, rowid));
         }
         if (sqlite3_step(stmtIF) != SQLITE_DONE)
         {
-            res = sqlite3_finalize(stmtIF);
-            return res;
+            return 1;
         }
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmtIF));
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
-    res = SQLITE_OK;
+    return SQLITE_OK;
+}
 
-    return res;
+static void freeStringArray(char **array, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        OICFree(array[i]);
+    }
+    OICFree(array);
 }
 
-static int storeLinkPayload(OCRepPayload *rdPayload, int64_t rowid)
+static int storeLink(OCRepPayload *link, int64_t rowid)
 {
-    OCRepPayload **links = NULL;
-    size_t dimensions[MAX_REP_ARRAY_DEPTH];
-    int res = 1 ;
-    size_t j = 0;
+    int res = SQLITE_OK;
+    sqlite3_stmt *stmt = getStatement(RD_INSERT_LINK);
 
-    if (OCRepPayloadGetPropObjectArray(rdPayload, OC_RSRVD_LINKS, &links, dimensions))
+    char *uri = NULL;
+    if (OCRepPayloadGetPropString(link, OC_RSRVD_HREF, &uri))
     {
-        const char *insertDeviceLLList = "INSERT INTO RD_DEVICE_LINK_LIST VALUES(?,?,?,?,?,?,?,?)";
-        sqlite3_stmt *stmt = 0;
+        res = sqlite3_bind_text(stmt, uri_index, uri, strlen(uri), SQLITE_STATIC);
+    }
 
-        for (size_t i = 0; i < dimensions[0]; i++)
+    OCRepPayload *p = NULL;
+    if (OCRepPayloadGetPropObject(link, OC_RSRVD_POLICY, &p))
+    {
+        int64_t bm = 0;
+        if (SQLITE_OK == res && OCRepPayloadGetPropInt(p, OC_RSRVD_BITMAP, &bm))
         {
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceLLList, strlen(insertDeviceLLList) + 1, &stmt, NULL));
-            VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
-
-            OCRepPayload *link = links[i];
-            char *uri = NULL;
-            if (OCRepPayloadGetPropString(link, OC_RSRVD_HREF, &uri))
-            {
-                VERIFY_SQLITE(sqlite3_bind_text(stmt, uri_index, uri, strlen(uri), SQLITE_STATIC));
-            }
+            res = sqlite3_bind_int(stmt, p_index, bm);
+        }
+    }
 
-            OCRepPayload *p = NULL;
-            if (OCRepPayloadGetPropObject(link, OC_RSRVD_POLICY, &p))
-            {
-                int64_t bm = 0;
-                if (OCRepPayloadGetPropInt(p, OC_RSRVD_BITMAP, &bm))
-                {
-                    VERIFY_SQLITE(sqlite3_bind_int(stmt, p_index, bm));
-                }
-            }
+    size_t mtDim[MAX_REP_ARRAY_DEPTH] = {0};
+    char **mediaType = NULL;
+    if (OCRepPayloadGetStringArray(link, OC_RSRVD_MEDIA_TYPE, &mediaType, mtDim) && mtDim[0])
+    {
+        if (SQLITE_OK == res)
+        {
+            res = sqlite3_bind_text(stmt, mt_index, mediaType[0], strlen(mediaType[0]),
+                                    SQLITE_STATIC);
+        }
+    }
 
-            size_t mtDim[MAX_REP_ARRAY_DEPTH] = {0};
-            char **mediaType = NULL;
-            if (OCRepPayloadGetStringArray(link, OC_RSRVD_MEDIA_TYPE, &mediaType, mtDim))
-            {
-                VERIFY_SQLITE(sqlite3_bind_text(stmt, mt_index, mediaType[0], mtDim[0], SQLITE_STATIC));
-            }
+    if (SQLITE_OK == res)
+    {
+        res = sqlite3_bind_int64(stmt, d_index, rowid);
+    }
 
-            VERIFY_SQLITE(sqlite3_bind_int(stmt, d_index, rowid));
+    size_t rtDim[MAX_REP_ARRAY_DEPTH] = {0};
+    char **rt = NULL;
+    OCRepPayloadGetStringArray(link, OC_RSRVD_RESOURCE_TYPE, &rt, rtDim);
 
-            size_t rtDim[MAX_REP_ARRAY_DEPTH] = {0};
-            char **rt = NULL;
-            OCRepPayloadGetStringArray(link, OC_RSRVD_RESOURCE_TYPE, &rt, rtDim);
+    size_t itfDim[MAX_REP_ARRAY_DEPTH] = {0};
+    char **itf = NULL;
+    OCRepPayloadGetStringArray(link, OC_RSRVD_INTERFACE, &itf, itfDim);
 
-            size_t itfDim[MAX_REP_ARRAY_DEPTH] = {0};
-            char **itf = NULL;
-            OCRepPayloadGetStringArray(link, OC_RSRVD_INTERFACE, &itf, itfDim);
+    if (SQLITE_OK == res && sqlite3_step(stmt) != SQLITE_DONE)
+    {
+        res = 1;
+    }
+    if (SQLITE_OK == res)
+    {
+        int64_t ins = sqlite3_last_insert_rowid(gRDDB);
+        res = storeResourceType(rt, rtDim[0], ins);
+        if (SQLITE_OK == res)
+        {
+            res = storeInterfaceType(itf, itfDim[0], ins);
+        }
+    }
+    if (SQLITE_OK != res)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed storing link, Error Message: %s", sqlite3_errmsg(gRDDB));
+    }
 
-            if (sqlite3_step(stmt) != SQLITE_DONE)
-            {
-                sqlite3_finalize(stmt);
-                return res;
-            }
-            VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
-
-            int64_t ins = sqlite3_last_insert_rowid(gRDDB);
-            VERIFY_SQLITE(storeResourceType(rt, rtDim[0], ins));
-            VERIFY_SQLITE(storeInterfaceType(itf, itfDim[0], ins));
-            OICFree(uri);
-            OCPayloadDestroy((OCPayload *)p);
-            for (j = 0; j < mtDim[0]; j++)
-            {
-                OICFree(mediaType[j]);
-            }
-            OICFree(mediaType);
+    OICFree(uri);
+    OCPayloadDestroy((OCPayload *)p);
+    freeStringArray(mediaType, mtDim[0]);
+    freeStringArray(rt, rtDim[0]);
+    freeStringArray(itf, itfDim[0]);
+    return res;
+}
 
-            for (j = 0; j < rtDim[0]; j++)
-            {
-                OICFree(rt[j]);
-            }
-            OICFree(rt);
+static int storeLinkPayload(OCRepPayload *rdPayload, int64_t rowid)
+{
+    OCRepPayload **links = NULL;
+    size_t dimensions[MAX_REP_ARRAY_DEPTH];
+    int res = 1 ;
 
-            for (j = 0; j < itfDim[0]; j++)
+    if (OCRepPayloadGetPropObjectArray(rdPayload, OC_RSRVD_LINKS, &links, dimensions))
+    {
+        res = SQLITE_OK;
+        for (size_t i = 0; i < dimensions[0]; i++)
+        {
+            if (SQLITE_OK == res)
             {
-                OICFree(itf[j]);
+                res = storeLink(links[i], rowid);
             }
-            OICFree(itf);
-
+            OCRepPayloadDestroy(links[i]);
         }
-
-        VERIFY_SQLITE(sqlite3_finalize(stmt));
-        res = SQLITE_OK;
+        OICFree(links);
     }
     return res;
 }
@@ -320,10 +438,9 @@ OCStackResult OCRDDatabaseStoreResources(OCRepPayload *payload, const OCDevAddr
 {
     CHECK_DATABASE_INIT;
 
+    // The device and all of its links are stored in one transaction.
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
-    const char *insertDeviceList = "INSERT INTO RD_DEVICE_LIST VALUES(?,?,?,?)";
-    sqlite3_stmt *stmt = 0;
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, insertDeviceList, strlen(insertDeviceList) + 1, &stmt, NULL));
+    sqlite3_stmt *stmt = getStatement(RD_INSERT_DEVICE);
 
     char *deviceid = NULL;
     if (OCRepPayloadGetPropString(payload, OC_RSRVD_DEVICE_ID, &deviceid))
@@ -334,7 +451,7 @@ OCStackResult OCRDDatabaseStoreResources(OCRepPayload *payload, const OCDevAddr
     int64_t ttl = 0;
     if (OCRepPayloadGetPropInt(payload, OC_RSRVD_DEVICE_TTL, &ttl))
     {
-        VERIFY_SQLITE(sqlite3_bind_int(stmt, ttl_index, ttl));
+        VERIFY_SQLITE(sqlite3_bind_int64(stmt, ttl_index, ttl));
     }
 
     char rdAddress[MAX_URI_LENGTH];
@@ -344,17 +461,16 @@ OCStackResult OCRDDatabaseStoreResources(OCRepPayload *payload, const OCDevAddr
 
     if (sqlite3_step(stmt) != SQLITE_DONE)
     {
-        sqlite3_finalize(stmt);
+        sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
+        OICFree(deviceid);
         return OC_STACK_ERROR;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
-
-    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
+    OICFree(deviceid);
 
     int64_t rowid = sqlite3_last_insert_rowid(gRDDB);
     VERIFY_SQLITE(storeLinkPayload(payload, rowid));
 
-    OICFree(deviceid);
+    VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
     return OC_STACK_OK;
 }
 
@@ -363,19 +479,14 @@ OCStackResult OCRDDatabaseDeleteDevice(const char *deviceId)
     CHECK_DATABASE_INIT;
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "BEGIN TRANSACTION", NULL, NULL, NULL));
 
-    sqlite3_stmt *stmt = 0;
-    char *delDevice = "DELETE FROM RD_DEVICE_LIST WHERE "XSTR(OC_RSRVD_DEVICE_ID)" = ?";
-    VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, delDevice, strlen(delDevice) + 1, &stmt, NULL));
-
+    sqlite3_stmt *stmt = getStatement(RD_DELETE_DEVICE);
     VERIFY_SQLITE(sqlite3_bind_text(stmt, 1, deviceId, strlen(deviceId) + 1, SQLITE_STATIC));
 
     if (sqlite3_step(stmt) != SQLITE_DONE)
     {
         sqlite3_exec(gRDDB, "ROLLBACK", NULL, NULL, NULL);
-        sqlite3_finalize(stmt);
         return OC_STACK_ERROR;
     }
-    VERIFY_SQLITE(sqlite3_finalize(stmt));
     VERIFY_SQLITE(sqlite3_exec(gRDDB, "COMMIT", NULL, NULL, NULL));
 
     return OC_STACK_OK;
@@ -391,6 +502,7 @@ static OCStackResult appendStringLL(OCStringLL **type, const unsigned char *valu
     temp->value = OICStrdup((char *)value);
     if (!temp->value)
     {
+        OICFree(temp);
         return OC_STACK_NO_MEMORY;
     }
     temp->next = NULL;
@@ -401,12 +513,41 @@ static OCStackResult appendStringLL(OCStringLL **type, const unsigned char *valu
     }
     else
     {
-        for (OCStringLL *tmp = *type; tmp->next; tmp = tmp->next);
+        OCStringLL *tmp = *type;
+        for (; tmp->next; tmp = tmp->next);
         tmp->next = temp;
     }
     return OC_STACK_OK;
 }
 
+/**
+ * Creates the resource payload for the link in the current row of a link query.
+ */
+static OCResourcePayload *createResourcePayload(sqlite3_stmt *stmt)
+{
+    OCResourcePayload *resourcePayload = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
+    if (!resourcePayload)
+    {
+        return NULL;
+    }
+
+    const unsigned char *uri = sqlite3_column_text(stmt, link_uri_column);
+    if (uri)
+    {
+        resourcePayload->uri = OICStrdup((char *)uri);
+        if (!resourcePayload->uri)
+        {
+            OCDiscoveryResourceDestroy(resourcePayload);
+            return NULL;
+        }
+    }
+
+    int bitmap = sqlite3_column_int(stmt, link_p_column);
+    resourcePayload->bitmap = bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE);
+    resourcePayload->secure = ((bitmap & OC_SECURE) != 0);
+    return resourcePayload;
+}
+
 OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *resourceType, OCDiscoveryPayload *discPayload)
 {
     CHECK_DATABASE_INIT;
@@ -414,147 +555,86 @@ OCStackResult OCRDDatabaseCheckResources(const char *interfaceType, const char *
     {
         return OC_STACK_INVALID_QUERY;
     }
-    OCResourcePayload *resourcePayload = (OCResourcePayload *)OICCalloc(1, sizeof(OCResourcePayload));
-    if (!resourcePayload)
+
+    RDStatement statement = RD_SELECT_LINKS_BY_RT_IF;
+    if (!interfaceType)
     {
-        return OC_STACK_NO_MEMORY;
+        statement = RD_SELECT_LINKS_BY_RT;
+    }
+    else if (!resourceType)
+    {
+        statement = RD_SELECT_LINKS_BY_IF;
     }
 
+    sqlite3_stmt *stmt = getStatement(statement);
     if (resourceType)
     {
-        sqlite3_stmt *stmt = 0;
-        const char *input = "SELECT * FROM RD_DEVICE_LINK_LIST INNER JOIN RD_LINK_RT ON " \
-        "RD_DEVICE_LINK_LIST.INS=RD_LINK_RT.LINK_ID WHERE RD_LINK_RT.rt LIKE ? ";
-
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, -1, &stmt, NULL));
         VERIFY_SQLITE(sqlite3_bind_text(stmt, 1, resourceType, strlen(resourceType) + 1, SQLITE_STATIC));
-
-        int res = sqlite3_step (stmt);
-        if (res == SQLITE_ROW || res == SQLITE_DONE)
-        {
-            int id = sqlite3_column_int(stmt, 0);
-            const unsigned char *uri = sqlite3_column_text(stmt, uri_index - 1);
-            int bitmap = sqlite3_column_int(stmt, p_index - 1);
-            int deviceId = sqlite3_column_int(stmt, d_index - 1);
-            OIC_LOG_V(DEBUG, TAG, " %s %d", uri, deviceId);
-            resourcePayload->uri = OICStrdup((char *)uri);
-            if (!resourcePayload->uri)
-            {
-                OCDiscoveryResourceDestroy(resourcePayload);
-                return OC_STACK_NO_MEMORY;
-            }
-            res = sqlite3_reset(stmt);
-            VERIFY_SQLITE(res);
-
-            sqlite3_stmt *stmtRT = 0;
-            const char *rt = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=?";
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, rt, -1, &stmtRT, NULL));
-            VERIFY_SQLITE(sqlite3_bind_int(stmtRT, 1, id));
-            while (SQLITE_ROW == sqlite3_step(stmtRT))
-            {
-                const unsigned char *rt1 = sqlite3_column_text(stmtRT, (rt_value_index - 1));
-                appendStringLL(&resourcePayload->types, rt1);
-            }
-
-            sqlite3_stmt *stmtIF = 0;
-            const char *itf = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=?";
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, itf, -1, &stmtIF, NULL));
-            VERIFY_SQLITE(sqlite3_bind_int(stmtIF, 1, id));
-            while (SQLITE_ROW == sqlite3_step(stmtIF))
-            {
-                const unsigned char *itf = sqlite3_column_text(stmtIF, (if_value_index - 1));
-                appendStringLL(&resourcePayload->interfaces, itf);
-            }
-
-            resourcePayload->bitmap = bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE);
-            resourcePayload->secure = (bitmap & OC_SECURE) != 0;
-
-            const char *address = "SELECT di, address FROM RD_DEVICE_LIST INNER JOIN RD_DEVICE_LINK_LIST ON " \
-            "RD_DEVICE_LINK_LIST.DEVICE_ID = RD_DEVICE_LIST.ID WHERE RD_DEVICE_LINK_LIST.DEVICE_ID=?";
-
-            sqlite3_stmt *stmt1 = 0;
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, address, -1, &stmt1, NULL));
-            VERIFY_SQLITE(sqlite3_bind_int(stmt1, 1, deviceId));
-            // TODO: Right now, we have a bug where discovery payload can only send one device information.
-            res = sqlite3_step(stmt1);
-            if (res == SQLITE_ROW || res == SQLITE_DONE)
-            {
-                const unsigned char *di = sqlite3_column_text(stmt1, 0);
-                const unsigned char *address = sqlite3_column_text(stmt1, 1);
-                OIC_LOG_V(DEBUG, TAG, " %s %s", di, address);
-                (discPayload)->baseURI = OICStrdup((char *)address);
-                (discPayload)->sid = OICStrdup((char *)di);
-            }
-            OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
-        }
     }
     if (interfaceType)
     {
-        sqlite3_stmt *stmt = 0;
-        const char *input = "SELECT * FROM RD_DEVICE_LINK_LIST INNER JOIN RD_LINK_IF ON " \
-        "RD_DEVICE_LINK_LIST.INS=RD_LINK_IF.LINK_ID WHERE RD_LINK_IF.if LIKE ? ";
-
-        VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, input, -1, &stmt, NULL));
-        VERIFY_SQLITE(sqlite3_bind_text(stmt, 1, interfaceType, strlen(interfaceType) + 1, SQLITE_STATIC));
+        VERIFY_SQLITE(sqlite3_bind_text(stmt, 2, interfaceType, strlen(interfaceType) + 1, SQLITE_STATIC));
+    }
 
-        int res = sqlite3_step (stmt);
-        if (res == SQLITE_ROW || res == SQLITE_DONE)
+    OCStackResult result = OC_STACK_NO_RESOURCE;
+    OCResourcePayload *resourcePayload = NULL;
+    int64_t linkId = 0;
+    int deviceId = 0;
+    while (SQLITE_ROW == sqlite3_step(stmt))
+    {
+        int64_t id = sqlite3_column_int64(stmt, link_ins_column);
+        int device = sqlite3_column_int(stmt, link_device_column);
+        if (!resourcePayload || id != linkId)
         {
-            int id = sqlite3_column_int(stmt, 0);
-            const unsigned char *uri = sqlite3_column_text(stmt, uri_index - 1);
-            int bitmap = sqlite3_column_int(stmt, p_index - 1);
-            int deviceId = sqlite3_column_int(stmt, d_index - 1);
-            OIC_LOG_V(DEBUG, TAG, " %s %d", uri, deviceId);
-            resourcePayload->uri = OICStrdup((char *)uri);
-            if (!resourcePayload->uri)
+            if (resourcePayload)
             {
-                OCDiscoveryResourceDestroy(resourcePayload);
-                return OC_STACK_NO_MEMORY;
+                OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
+                resourcePayload = NULL;
+                result = OC_STACK_OK;
+                // TODO: Right now, we have a bug where discovery payload can only send one device information.
+                if (device != deviceId)
+                {
+                    break;
+                }
             }
-            VERIFY_SQLITE(sqlite3_reset(stmt));
-
-            sqlite3_stmt *stmtRT = 0;
-            const char *rt = "SELECT rt FROM RD_LINK_RT WHERE LINK_ID=?";
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, rt, -1, &stmtRT, NULL));
-            VERIFY_SQLITE(sqlite3_bind_int(stmtRT, 1, id));
-            while (SQLITE_ROW == sqlite3_step(stmtRT))
+            else
             {
-                const unsigned char *rt1 = sqlite3_column_text(stmtRT, (rt_value_index - 1));
-                appendStringLL(&resourcePayload->types, rt1);
+                deviceId = device;
+                const unsigned char *di = sqlite3_column_text(stmt, link_di_column);
+                const unsigned char *address = sqlite3_column_text(stmt, link_address_column);
+                OIC_LOG_V(DEBUG, TAG, " %s %s", di, address);
+                OICFree(discPayload->baseURI);
+                discPayload->baseURI = OICStrdup((char *)address);
+                OICFree(discPayload->sid);
+                discPayload->sid = OICStrdup((char *)di);
             }
 
-            sqlite3_stmt *stmtIF = 0;
-            const char *itf = "SELECT if FROM RD_LINK_IF WHERE LINK_ID=?";
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, itf, -1, &stmtIF, NULL));
-            VERIFY_SQLITE(sqlite3_bind_int(stmtIF, 1, id));
-            while (SQLITE_ROW == sqlite3_step (stmtIF))
+            linkId = id;
+            resourcePayload = createResourcePayload(stmt);
+            if (!resourcePayload)
             {
-                const unsigned char *itf = sqlite3_column_text(stmtIF, (if_value_index - 1));
-                appendStringLL(&resourcePayload->interfaces, itf);
+                result = OC_STACK_NO_MEMORY;
+                break;
             }
+            OIC_LOG_V(DEBUG, TAG, " %s %d", resourcePayload->uri, deviceId);
+        }
 
-            resourcePayload->bitmap = bitmap & (OC_OBSERVABLE | OC_DISCOVERABLE);
-            resourcePayload->secure = ((bitmap & OC_SECURE) != 0);
-
-            const char *address = "SELECT di, address FROM RD_DEVICE_LIST INNER JOIN RD_DEVICE_LINK_LIST ON " \
-            "RD_DEVICE_LINK_LIST.DEVICE_ID = RD_DEVICE_LIST.ID WHERE RD_DEVICE_LINK_LIST.DEVICE_ID=?";
-
-            sqlite3_stmt *stmt1 = 0;
-            VERIFY_SQLITE(sqlite3_prepare_v2(gRDDB, address, -1, &stmt1, NULL));
-            VERIFY_SQLITE(sqlite3_bind_int(stmt1, 1, deviceId));
-
-            res = sqlite3_step(stmt1);
-            if (res == SQLITE_ROW || res == SQLITE_DONE)
-            {
-                const unsigned char *di = sqlite3_column_text(stmt1, 0);
-                const unsigned char *address = sqlite3_column_text(stmt1, 1);
-                OIC_LOG_V(DEBUG, TAG, " %s %s", di, address);
-                (discPayload)->baseURI = OICStrdup((char *)address);
-                (discPayload)->sid = OICStrdup((char *)di);
-            }
-            OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
+        if (SQLITE_NULL != sqlite3_column_type(stmt, link_rt_column))
+        {
+            appendStringLL(&resourcePayload->types, sqlite3_column_text(stmt, link_rt_column));
+        }
+        if (SQLITE_NULL != sqlite3_column_type(stmt, link_if_column))
+        {
+            appendStringLL(&resourcePayload->interfaces, sqlite3_column_text(stmt, link_if_column));
         }
     }
-    return OC_STACK_OK;
+    if (resourcePayload)
+    {
+        OCDiscoveryPayloadAddNewResource(discPayload, resourcePayload);
+        result = OC_STACK_OK;
+    }
+    sqlite3_reset(stmt);
+
+    return result;
 }
 #endif
@@ -29,6 +29,7 @@ extern "C"
     #include "oic_string.h"
     #include "ocpayload.h"
     #include "payload_logging.h"
+    #include "ocrandom.h"
 }
 
 #include "gtest/gtest.h"
@@ -45,6 +46,7 @@ extern "C"
 #include <stdio.h>
 #include <string.h>
 
+#include <chrono>
 #include <iostream>
 #include <stdint.h>
 
@@ -63,10 +65,58 @@ static const char TAG[] = "RDDatabaseTests";
 
 std::chrono::seconds const SHORT_TEST_TIMEOUT = std::chrono::seconds(5);
 
+#define BENCHMARK_DATABASE "RDBenchmark.db"
+#define BENCHMARK_DEVICES 5000
+#define BENCHMARK_LOOKUPS 1000
+
 //-----------------------------------------------------------------------------
 // Callback functions
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+// Helper functions
+//-----------------------------------------------------------------------------
+static OCRepPayload *createLink(const char *href, const char *resourceType, int64_t ins)
+{
+    OCRepPayload *link = OCRepPayloadCreate();
+    OCRepPayloadSetPropString(link, OC_RSRVD_HREF, href);
+    size_t dim[MAX_REP_ARRAY_DEPTH] = {1, 0, 0};
+    const char *rt[] = { resourceType };
+    OCRepPayloadSetStringArray(link, OC_RSRVD_RESOURCE_TYPE, rt, dim);
+    const char *itf[] = { OC_RSRVD_INTERFACE_DEFAULT };
+    OCRepPayloadSetStringArray(link, OC_RSRVD_INTERFACE, itf, dim);
+    OCRepPayloadSetPropInt(link, OC_RSRVD_INS, ins);
+    const char *mt[] = { DEFAULT_MESSAGE_TYPE };
+    OCRepPayloadSetStringArray(link, OC_RSRVD_MEDIA_TYPE, mt, dim);
+    OCRepPayload *policy = OCRepPayloadCreate();
+    OCRepPayloadSetPropInt(policy, OC_RSRVD_BITMAP, OC_DISCOVERABLE);
+    OCRepPayloadSetPropObjectAsOwner(link, OC_RSRVD_POLICY, policy);
+    return link;
+}
+
+/**
+ * Creates the publish payload of device @p index: a light shared by all
+ * devices and a sensor with a resource type only this device has.
+ */
+static OCRepPayload *createDevicePayload(int index)
+{
+    char deviceId[UUID_STRING_SIZE];
+    snprintf(deviceId, sizeof(deviceId), "%08x-0000-4000-8000-000000000000", index);
+    char sensorType[32];
+    snprintf(sensorType, sizeof(sensorType), "x.sensor.%d", index);
+
+    OCRepPayload *repPayload = OCRepPayloadCreate();
+    OCRepPayloadSetPropString(repPayload, OC_RSRVD_DEVICE_ID, deviceId);
+    OCRepPayloadSetPropInt(repPayload, OC_RSRVD_DEVICE_TTL, 86400);
+
+    OCRepPayload **links = (OCRepPayload **)OICMalloc(sizeof(OCRepPayload *) * 2);
+    links[0] = createLink("/a/light", "core.light", 0);
+    links[1] = createLink("/a/sensor", sensorType, 1);
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {2, 0, 0};
+    OCRepPayloadSetPropObjectArrayAsOwner(repPayload, OC_RSRVD_LINKS, links, dimensions);
+    return repPayload;
+}
+
 //-----------------------------------------------------------------------------
 //  Tests
 //-----------------------------------------------------------------------------
@@ -161,12 +211,65 @@ TEST_F(RDDatabaseTests, PublishDatabase)
     OCDiscoveryPayloadDestroy(discPayload);
     OCDiscoveryPayload *discPayload1 = OCDiscoveryPayloadCreate();
     EXPECT_EQ(OC_STACK_OK, OCRDDatabaseCheckResources(OC_RSRVD_INTERFACE_DEFAULT, NULL, discPayload1));
+    EXPECT_EQ(2u, OCDiscoveryPayloadGetResourceCount(discPayload1));
+    EXPECT_STREQ(deviceId, discPayload1->sid);
     OCDiscoveryPayloadDestroy(discPayload1);
     OCDiscoveryPayload *discPayload2 = OCDiscoveryPayloadCreate();
     EXPECT_EQ(OC_STACK_OK, OCRDDatabaseCheckResources(NULL, "core.light", discPayload2));
     OCDiscoveryPayloadDestroy(discPayload2);
     OCDiscoveryPayload *discPayload3 = OCDiscoveryPayloadCreate();
     EXPECT_EQ(OC_STACK_OK, OCRDDatabaseCheckResources(OC_RSRVD_INTERFACE_DEFAULT, "core.light", discPayload3));
+    ASSERT_EQ(1u, OCDiscoveryPayloadGetResourceCount(discPayload3));
+    OCResourcePayload *resource = OCDiscoveryPayloadGetResource(discPayload3, 0);
+    EXPECT_STREQ(resourceURI_light.c_str(), resource->uri);
+    EXPECT_STREQ(resourceTypeName_light.c_str(), resource->types->value);
+    EXPECT_STREQ(OC_RSRVD_INTERFACE_DEFAULT, resource->interfaces->value);
+    OCDiscoveryPayloadDestroy(discPayload3);
+    OCDiscoveryPayload *discPayload4 = OCDiscoveryPayloadCreate();
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCRDDatabaseCheckResources(NULL, "core.unknown", discPayload4));
+    OCDiscoveryPayloadDestroy(discPayload4);
     EXPECT_EQ(OC_STACK_OK, OCRDDatabaseDeleteDevice(deviceId));
     EXPECT_EQ(OC_STACK_OK, OCRDDatabaseClose());
 }
+
+// Measures publishing BENCHMARK_DEVICES devices and looking up the resource
+// type of one of them once all are published.
+TEST_F(RDDatabaseTests, PublishBenchmark)
+{
+    remove(BENCHMARK_DATABASE);
+    ASSERT_EQ(OC_STACK_OK, OCRDDatabaseInit(BENCHMARK_DATABASE));
+    OCDevAddr address;
+    address.port = 54321;
+    OICStrcpy(address.addr, MAX_ADDR_STR_SIZE, "192.168.1.1");
+
+    auto publishStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_DEVICES; i++)
+    {
+        OCRepPayload *repPayload = createDevicePayload(i);
+        ASSERT_EQ(OC_STACK_OK, OCRDDatabaseStoreResources(repPayload, &address));
+        OCRepPayloadDestroy(repPayload);
+    }
+    auto publish = std::chrono::steady_clock::now() - publishStart;
+
+    auto lookupStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_LOOKUPS; i++)
+    {
+        char sensorType[32];
+        snprintf(sensorType, sizeof(sensorType), "x.sensor.%d",
+                 (i * 7919) % BENCHMARK_DEVICES);
+        OCDiscoveryPayload *discPayload = OCDiscoveryPayloadCreate();
+        ASSERT_EQ(OC_STACK_OK, OCRDDatabaseCheckResources(NULL, sensorType, discPayload));
+        ASSERT_EQ(1u, OCDiscoveryPayloadGetResourceCount(discPayload));
+        OCDiscoveryPayloadDestroy(discPayload);
+    }
+    auto lookup = std::chrono::steady_clock::now() - lookupStart;
+
+    EXPECT_EQ(OC_STACK_OK, OCRDDatabaseClose());
+    remove(BENCHMARK_DATABASE);
+
+    std::cout << BENCHMARK_DEVICES << " devices: "
+              << std::chrono::duration<double, std::micro>(publish).count() / BENCHMARK_DEVICES
+              << " us per publish, "
+              << std::chrono::duration<double, std::micro>(lookup).count() / BENCHMARK_LOOKUPS
+              << " us per lookup" << std::endl;
+}
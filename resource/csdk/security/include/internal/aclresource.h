@@ -51,6 +51,41 @@ OCStackResult DeInitACLResource();
  */
 const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr);
 
+/**
+ * Result of matching a request against the ACL.
+ */
+typedef struct OicSecAclMatch
+{
+    bool subjectFound;          /**< true if the ACL has an ACE for the subject. */
+    const OicSecAce_t *ace;     /**< first ACE of the subject that lists the resource or the
+                                     wildcard resource, NULL if there is none. */
+    bool withinValidTime;       /**< true if ace allows access at this time. */
+    bool timeDependent;         /**< true if ace has validities, so withinValidTime changes
+                                     over time. */
+} OicSecAclMatch_t;
+
+/**
+ * This method is used by PolicyEngine to find the ACE that decides on a request.
+ * It uses an index of the ACL by subject and resource, which is rebuilt after
+ * the ACL changed.
+ *
+ * @param subjectId ID of the requesting subject.
+ * @param resource URI of the requested resource.
+ * @param match is filled with the result.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value.
+ */
+OCStackResult MatchACLResource(const OicUuid_t* subjectId, const char *resource,
+                               OicSecAclMatch_t *match);
+
+/**
+ * This method returns a number that changes whenever the ACL changes, so that
+ * results derived from the ACL can be dropped.
+ *
+ * @return version of the ACL.
+ */
+uint32_t GetACLVersion();
+
 /**
  * This function converts ACL data into CBOR format.
  *
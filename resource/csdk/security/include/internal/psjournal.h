@@ -0,0 +1,114 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * Journaled storage of the Secure Virtual Resources.
+ *
+ * Each SVR is kept as a separate section. An update appends one record for
+ * its section to a journal instead of rewriting the whole SVR database.
+ * Once the journal has grown enough, a snapshot of all sections is written
+ * to the other of two journal files, which replaces the current one only
+ * after it is complete. A torn record at the end of a journal is dropped
+ * when it is loaded.
+ *
+ * The journal files are opened through the registered OCPersistentStorage
+ * handler by their own names, so the handler has to honor its path argument.
+ * The SVR database file is only read while no journal exists yet.
+ */
+
+#ifndef IOTVT_SRM_PSJOURNAL_H
+#define IOTVT_SRM_PSJOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "octypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Names of the two journal files.
+ */
+extern const char * SVR_DB_JOURNAL_FILE_NAMES[2];
+
+/**
+ * Enables or disables the journal. The journal is loaded on first use.
+ *
+ * @param enable true to keep the SVRs in the journal, false to use the
+ *               SVR database file.
+ */
+void SetSVRJournalEnabled(bool enable);
+
+/**
+ * @return true if the SVRs are kept in the journal.
+ */
+bool IsSVRJournalEnabled(void);
+
+/**
+ * Reads a Secure Virtual Resource from the journal.
+ *
+ * @note Caller of this method MUST use OICFree() method to release memory
+ *       referenced by data.
+ *
+ * @param rsrcName is the name of the SVR. If the value is NULL, all SVRs
+ *                 are returned in the format of the SVR database file.
+ * @param data is the pointer to the SVR contents.
+ * @param size is the size of the SVR contents.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+OCStackResult GetSVRFromJournal(const char *rsrcName, uint8_t **data, size_t *size);
+
+/**
+ * Updates a Secure Virtual Resource in the journal.
+ *
+ * @param rsrcName is the name of the SVR.
+ * @param payload is the cbor payload of the SVR. An empty payload deletes it.
+ * @param size is the size of the cbor payload.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+OCStackResult UpdateSVRInJournal(const char *rsrcName, const uint8_t *payload, size_t size);
+
+/**
+ * Replaces all Secure Virtual Resources in the journal.
+ *
+ * @param data is the SVR database in the format of the SVR database file.
+ * @param size is the size of data.
+ *
+ * @return ::OC_STACK_OK for Success, otherwise some error value
+ */
+OCStackResult ReplaceSVRDatabaseInJournal(const uint8_t *data, size_t size);
+
+/**
+ * Drops the loaded journal, so that the next access reads it again.
+ */
+void DeInitSVRJournal(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //IOTVT_SRM_PSJOURNAL_H
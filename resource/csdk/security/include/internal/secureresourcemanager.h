@@ -43,6 +43,15 @@ OCStackResult SRMRegisterPersistentStorageHandler(OCPersistentStorage* persisten
  */
 OCPersistentStorage* SRMGetPersistentStorageHandler();
 
+/**
+ * Enable or disable keeping the Secure Virtual Resources in a journal.
+ *
+ * @param enable [IN] true to use the journal, false to use the SVR database file.
+ *
+ * @return ::OC_STACK_OK  is no errors and successful.
+ */
+OCStackResult SRMEnablePersistentStorageJournal(bool enable);
+
 /**
  * Register request and response callbacks. Requests and responses are delivered in these callbacks.
  *
@@ -160,6 +160,18 @@ struct IotvtICalRecur
  */
 IotvtICalResult_t IsRequestWithinValidTime(const char *period, const char *recur);
 
+/**
+ * Same as IsRequestWithinValidTime() for a period and recurrence rule that
+ * were parsed before, e.g. once when the ACL changed.
+ * @param period parsed period.
+ * @param recur parsed recurrence rule, NULL if there is none.
+ * @return ::IOTVTICAL_VALID_ACCESS, if the request is within valid time period
+ * ::IOTVTICAL_INVALID_ACCESS, if the request is not within valid time period
+ * ::IOTVTICAL_INVALID_PARAMETER, if parameter are invalid
+ */
+IotvtICalResult_t IsRequestWithinValidPeriod(const IotvtICalPeriod_t *period,
+                                             const IotvtICalRecur_t *recur);
+
 /**
  * Parses periodStr and populate struct IotvtICalPeriod_t.
  *
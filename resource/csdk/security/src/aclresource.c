@@ -43,6 +43,8 @@
 #include "srmutility.h"
 #include "psinterface.h"
 #include "ocpayloadcbor.h"
+#include "iotvticalendar.h"
+#include "uhashmap.h"
 
 #include "security_internals.h"
 
@@ -63,6 +65,50 @@ static const uint16_t CBOR_SIZE = 2048;
 static OicSecAcl_t *gAcl = NULL;
 static OCResourceHandle gAclHandle = NULL;
 
+#ifndef WITH_ARDUINO
+/**
+ * A period of an ACE validity with one of its recurrence rules, parsed.
+ */
+typedef struct AclIndexValidity
+{
+    IotvtICalPeriod_t period;
+    IotvtICalRecur_t recur;
+    bool hasRecur;
+} AclIndexValidity_t;
+#endif
+
+/**
+ * An ACE of the ACL index.
+ */
+typedef struct AclIndexAce
+{
+    const OicSecAce_t *ace;
+#ifndef WITH_ARDUINO
+    AclIndexValidity_t *validities; /**< access is allowed if one of them allows it. */
+    size_t validityCount;
+#endif
+} AclIndexAce_t;
+
+/**
+ * The ACEs of one subject, in the order of the ACL.
+ */
+typedef struct AclIndexSubject
+{
+    OicUuid_t subject;
+    AclIndexAce_t *aces;
+    size_t aceCount;
+    u_hashmap_t *hrefs;         /**< href -> first ACE that lists it. */
+    AclIndexAce_t *wildcard;    /**< first ACE that lists the wildcard resource. */
+} AclIndexSubject_t;
+
+/**
+ * Subject -> AclIndexSubject_t, built from gAcl when needed. NULL after gAcl changed.
+ */
+static u_hashmap_t *gAclIndex = NULL;
+static uint32_t gAclVersion = 0;
+
+static void InvalidateACLIndex();
+
 void FreeRsrc(OicSecRsrc_t *rsrc)
 {
     //Clean each member of resource
@@ -1347,6 +1393,8 @@ OCStackResult RemoveACE(const OicUuid_t * subject, const char * resource)
 
     if (deleteFlag)
     {
+        InvalidateACLIndex();
+
         // In case of unit test do not update persistant storage.
         if (memcmp(subject->id, &WILDCARD_SUBJECT_B64_ID, sizeof(subject->id)) == 0)
         {
@@ -1776,6 +1824,7 @@ static OCEntityHandlerResult HandleACLPostRequest(const OCEntityHandlerRequest *
             }
 
             DeleteACLList(newAcl);
+            InvalidateACLIndex();
 
             if(OC_EH_OK == ehRet)
             {
@@ -1899,6 +1948,7 @@ static OCStackResult CreateACLResource()
 OCStackResult SetDefaultACL(OicSecAcl_t *acl)
 {
     gAcl = acl;
+    InvalidateACLIndex();
     return OC_STACK_OK;
 }
 
@@ -2110,6 +2160,7 @@ OCStackResult InitACLResource()
         // TODO Needs to update persistent storage
     }
     VERIFY_NON_NULL(TAG, gAcl, FATAL);
+    InvalidateACLIndex();
 
     // Instantiate 'oic.sec.acl'
     ret = CreateACLResource();
@@ -2132,9 +2183,271 @@ OCStackResult DeInitACLResource()
         DeleteACLList(gAcl);
         gAcl = NULL;
     }
+    InvalidateACLIndex();
     return ret;
 }
 
+static uint32_t HashUuid(const void *key)
+{
+    return u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, key, sizeof(OicUuid_t));
+}
+
+static bool EqualUuid(const void *key1, const void *key2)
+{
+    return 0 == memcmp(key1, key2, sizeof(OicUuid_t));
+}
+
+static void FreeACLIndex()
+{
+    AclIndexSubject_t *entry = NULL;
+    uint32_t iter = 0;
+    while ((entry = (AclIndexSubject_t *) u_hashmap_next(gAclIndex, &iter)))
+    {
+#ifndef WITH_ARDUINO
+        for (size_t i = 0; i < entry->aceCount; i++)
+        {
+            OICFree(entry->aces[i].validities);
+        }
+#endif
+        OICFree(entry->aces);
+        u_hashmap_free(&entry->hrefs);
+        OICFree(entry);
+    }
+    u_hashmap_free(&gAclIndex);
+}
+
+/**
+ * Drops the ACL index. Called after every change of gAcl.
+ */
+static void InvalidateACLIndex()
+{
+    FreeACLIndex();
+    gAclVersion++;
+}
+
+#ifndef WITH_ARDUINO
+static bool IndexValidities(AclIndexAce_t *entry)
+{
+    const OicSecAce_t *ace = entry->ace;
+
+    // Periods and recurrences are paired; an ACE without recurrence never
+    // allows access.
+    if (NULL == ace->validities || NULL == ace->validities->recurrences)
+    {
+        return true;
+    }
+
+    size_t count = 0;
+    OicSecValidity_t *validity = NULL;
+    LL_FOREACH(ace->validities, validity)
+    {
+        count += validity->recurrenceLen;
+    }
+    if (0 == count)
+    {
+        return true;
+    }
+
+    entry->validities = (AclIndexValidity_t *) OICCalloc(count, sizeof(AclIndexValidity_t));
+    if (NULL == entry->validities)
+    {
+        return false;
+    }
+
+    LL_FOREACH(ace->validities, validity)
+    {
+        IotvtICalPeriod_t period = {.startDateTime={.tm_sec=0}};
+        if (IOTVTICAL_SUCCESS != ParsePeriod(validity->period, &period))
+        {
+            continue;
+        }
+        for (size_t i = 0; i < validity->recurrenceLen; i++)
+        {
+            AclIndexValidity_t *parsed = &entry->validities[entry->validityCount];
+            parsed->period = period;
+            parsed->hasRecur = (NULL != validity->recurrences[i]);
+            if (!parsed->hasRecur ||
+                IOTVTICAL_SUCCESS == ParseRecur(validity->recurrences[i], &parsed->recur))
+            {
+                entry->validityCount++;
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+static AclIndexSubject_t *GetACLIndexSubject(const OicUuid_t *subjectId, bool create)
+{
+    AclIndexSubject_t *entry = (AclIndexSubject_t *) u_hashmap_get(gAclIndex, subjectId);
+    if (NULL == entry && create)
+    {
+        entry = (AclIndexSubject_t *) OICCalloc(1, sizeof(AclIndexSubject_t));
+        if (NULL == entry)
+        {
+            return NULL;
+        }
+        memcpy(&entry->subject, subjectId, sizeof(OicUuid_t));
+        entry->hrefs = u_hashmap_create(u_hashmap_hash_string, u_hashmap_equal_string);
+        if (NULL == entry->hrefs || !u_hashmap_put(gAclIndex, &entry->subject, entry))
+        {
+            u_hashmap_free(&entry->hrefs);
+            OICFree(entry);
+            return NULL;
+        }
+    }
+    return entry;
+}
+
+/**
+ * Builds the ACL index from gAcl, unless it is up to date.
+ *
+ * @return true if the index can be used.
+ */
+static bool BuildACLIndex()
+{
+    if (gAclIndex)
+    {
+        return true;
+    }
+    if (NULL == gAcl)
+    {
+        return false;
+    }
+
+    gAclIndex = u_hashmap_create(HashUuid, EqualUuid);
+    if (NULL == gAclIndex)
+    {
+        return false;
+    }
+
+    // Count the ACEs of every subject first, so that their arrays do not move
+    // once the href maps point into them.
+    const OicSecAce_t *ace = NULL;
+    AclIndexSubject_t *entry = NULL;
+    LL_FOREACH(gAcl->aces, ace)
+    {
+        entry = GetACLIndexSubject(&ace->subjectuuid, true);
+        VERIFY_NON_NULL(TAG, entry, ERROR);
+        entry->aceCount++;
+    }
+
+    uint32_t iter = 0;
+    while ((entry = (AclIndexSubject_t *) u_hashmap_next(gAclIndex, &iter)))
+    {
+        entry->aces = (AclIndexAce_t *) OICCalloc(entry->aceCount, sizeof(AclIndexAce_t));
+        VERIFY_NON_NULL(TAG, entry->aces, ERROR);
+        entry->aceCount = 0;
+    }
+
+    LL_FOREACH(gAcl->aces, ace)
+    {
+        entry = GetACLIndexSubject(&ace->subjectuuid, false);
+        AclIndexAce_t *indexAce = &entry->aces[entry->aceCount++];
+        indexAce->ace = ace;
+#ifndef WITH_ARDUINO
+        VERIFY_SUCCESS(TAG, IndexValidities(indexAce), ERROR);
+#endif
+
+        OicSecRsrc_t *rsrc = NULL;
+        LL_FOREACH(ace->resources, rsrc)
+        {
+            if (NULL == rsrc->href)
+            {
+                continue;
+            }
+            if (0 == strcmp(WILDCARD_RESOURCE_URI, rsrc->href))
+            {
+                if (NULL == entry->wildcard)
+                {
+                    entry->wildcard = indexAce;
+                }
+            }
+            else if (NULL == u_hashmap_get(entry->hrefs, rsrc->href))
+            {
+                VERIFY_SUCCESS(TAG, u_hashmap_put(entry->hrefs, rsrc->href, indexAce), ERROR);
+            }
+        }
+    }
+    return true;
+
+exit:
+    OIC_LOG(ERROR, TAG, "Failed to build ACL index");
+    FreeACLIndex();
+    return false;
+}
+
+#ifndef WITH_ARDUINO
+static bool IsIndexedAceWithinValidTime(const AclIndexAce_t *indexAce)
+{
+    if (NULL == indexAce->ace->validities)
+    {
+        return true;
+    }
+
+    for (size_t i = 0; i < indexAce->validityCount; i++)
+    {
+        const AclIndexValidity_t *validity = &indexAce->validities[i];
+        if (IOTVTICAL_VALID_ACCESS == IsRequestWithinValidPeriod(&validity->period,
+                                          validity->hasRecur ? &validity->recur : NULL))
+        {
+            OIC_LOG(INFO, TAG, "Access request is in allowed time period");
+            return true;
+        }
+    }
+    OIC_LOG(ERROR, TAG, "Access request is in invalid time period");
+    return false;
+}
+#endif
+
+OCStackResult MatchACLResource(const OicUuid_t* subjectId, const char *resource,
+                               OicSecAclMatch_t *match)
+{
+    if (NULL == subjectId || NULL == resource || NULL == match)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    memset(match, 0, sizeof(*match));
+    if (!BuildACLIndex())
+    {
+        return (NULL == gAcl) ? OC_STACK_OK : OC_STACK_NO_MEMORY;
+    }
+
+    const AclIndexSubject_t *entry = GetACLIndexSubject(subjectId, false);
+    if (NULL == entry)
+    {
+        return OC_STACK_OK;
+    }
+    match->subjectFound = true;
+
+    // The first ACE in the ACL decides, whether it lists the resource or the wildcard.
+    const AclIndexAce_t *indexAce = (const AclIndexAce_t *) u_hashmap_get(entry->hrefs, resource);
+    if (entry->wildcard && (NULL == indexAce || entry->wildcard < indexAce))
+    {
+        indexAce = entry->wildcard;
+    }
+    if (NULL == indexAce)
+    {
+        return OC_STACK_OK;
+    }
+
+    match->ace = indexAce->ace;
+#ifndef WITH_ARDUINO //Period & Recurrence not supported on Arduino due
+    //lack of absolute time
+    match->timeDependent = (NULL != indexAce->ace->validities);
+    match->withinValidTime = IsIndexedAceWithinValidTime(indexAce);
+#else
+    match->withinValidTime = true;
+#endif
+    return OC_STACK_OK;
+}
+
+uint32_t GetACLVersion()
+{
+    return gAclVersion;
+}
+
 const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **savePtr)
 {
     OicSecAce_t *ace = NULL;
@@ -2145,6 +2458,28 @@ const OicSecAce_t* GetACLResourceData(const OicUuid_t* subjectId, OicSecAce_t **
         return NULL;
     }
 
+    if (BuildACLIndex())
+    {
+        const AclIndexSubject_t *entry = GetACLIndexSubject(subjectId, false);
+        size_t next = 0;
+        if (entry && NULL != *savePtr)
+        {
+            // Continue after the ACE returned by the previous call.
+            while (next < entry->aceCount && entry->aces[next].ace != *savePtr)
+            {
+                next++;
+            }
+            next++;
+        }
+        if (entry && next < entry->aceCount)
+        {
+            *savePtr = (OicSecAce_t *) entry->aces[next].ace;
+            return entry->aces[next].ace;
+        }
+        *savePtr = NULL;
+        return NULL;
+    }
+
     /*
      * savePtr MUST point to NULL if this is the 'first' call to retrieve ACL for
      * subjectID.
@@ -2282,6 +2617,7 @@ OCStackResult InstallNewACL2(const OicSecAcl_t* acl)
     {
         gAcl->aces = acl->aces;
     }
+    InvalidateACLIndex();
 
     printACL(gAcl);
 
@@ -2443,6 +2779,8 @@ OCStackResult UpdateDefaultSecProvACE()
 
         if(isRemoved)
         {
+            InvalidateACLIndex();
+
             /*
              * Generate new security resource ACE as follows :
              *      subject : "*"
@@ -2453,6 +2791,7 @@ OCStackResult UpdateDefaultSecProvACE()
             if (secDefaultAce)
             {
                 LL_APPEND(gAcl->aces, secDefaultAce);
+                InvalidateACLIndex();
 
                 size_t size = 0;
                 uint8_t *payload = NULL;
@@ -1050,6 +1050,11 @@ static bool UpdatePersistentStorage(const OicSecCred_t *cred)
 {
     bool ret = false;
 
+#ifdef __WITH_TLS__
+    // Resumed sessions would keep peers authenticated with the old credentials.
+    CAclearTlsSessionCache();
+#endif
+
     // Convert Cred data into JSON for update to persistent storage
     if (cred)
     {
@@ -32,6 +32,7 @@
 #include "crl.h"
 #include "ocpayloadcbor.h"
 #include "base64.h"
+#include "casecurityinterface.h"
 #include <time.h>
 
 #define TAG  "SRM-CRL"
@@ -476,6 +477,11 @@ OCStackResult UpdateCRLResource(OicSecCrl_t *crl)
         return OC_STACK_ERROR;
     }
 
+#ifdef __WITH_TLS__
+    // Peers whose certificates are now revoked must not resume their sessions.
+    CAclearTlsSessionCache();
+#endif
+
     char currentTime[32] = {0};
     getCurrentUTCTime(currentTime, sizeof(currentTime));
 
@@ -273,7 +273,7 @@ IotvtICalResult_t ParseRecur(const char *recurStr, IotvtICalRecur_t *recur)
  *
  * @return  number of days between date1 & date2.
  */
-static int DiffDays(IotvtICalDateTime_t *date1, IotvtICalDateTime_t *date2)
+static int DiffDays(const IotvtICalDateTime_t *date1, const IotvtICalDateTime_t *date2)
 {
     int days;
     int leapDays=0;
@@ -304,7 +304,7 @@ static int DiffDays(IotvtICalDateTime_t *date1, IotvtICalDateTime_t *date2)
  *
  * @return  number of seconds between time1 and time2.
  */
-static int DiffSecs(IotvtICalDateTime_t *time1, IotvtICalDateTime_t *time2)
+static int DiffSecs(const IotvtICalDateTime_t *time1, const IotvtICalDateTime_t *time2)
 {
     return (3600 * time2->tm_hour + 60 * time2->tm_min + time2->tm_sec) -
            (3600 * time1->tm_hour + 60 * time1->tm_min + time1->tm_sec);
@@ -320,7 +320,8 @@ static int DiffSecs(IotvtICalDateTime_t *time1, IotvtICalDateTime_t *time2)
  * ::IOTVTICAL_INVALID_ACCESS, if the request is not within valid time period.
  * ::IOTVTICAL_INVALID_PARAMETER, if parameter are invalid.
  */
-static IotvtICalResult_t ValidatePeriod(IotvtICalPeriod_t *period, IotvtICalDateTime_t *currentTime)
+static IotvtICalResult_t ValidatePeriod(const IotvtICalPeriod_t *period,
+                                        const IotvtICalDateTime_t *currentTime)
 {
     if (NULL == period || NULL == currentTime)
     {
@@ -378,19 +379,41 @@ IotvtICalResult_t IsRequestWithinValidTime(const char *periodStr, const char *re
     IotvtICalRecur_t recur = {.freq=0};
     IotvtICalResult_t ret = IOTVTICAL_INVALID_ACCESS;
 
-    time_t rawTime = time(0);
-    IotvtICalDateTime_t *currentTime = localtime(&rawTime);
-
     ret  = ParsePeriod(periodStr, &period);
     if (ret != IOTVTICAL_SUCCESS)
     {
         return ret;
     }
 
+    if (NULL != recurStr)
+    {
+        ret = ParseRecur(recurStr, &recur);
+        if (ret != IOTVTICAL_SUCCESS)
+        {
+            return ret;
+        }
+    }
+
+    return IsRequestWithinValidPeriod(&period, (NULL != recurStr) ? &recur : NULL);
+}
+
+IotvtICalResult_t IsRequestWithinValidPeriod(const IotvtICalPeriod_t *period,
+                                             const IotvtICalRecur_t *recur)
+{
+    if (NULL == period)
+    {
+        return IOTVTICAL_INVALID_PARAMETER;
+    }
+
+    IotvtICalResult_t ret = IOTVTICAL_INVALID_ACCESS;
+
+    time_t rawTime = time(0);
+    IotvtICalDateTime_t *currentTime = localtime(&rawTime);
+
     //If recur is NULL then the access time is between period's startDateTime and endDateTime
-    if (NULL == recurStr)
+    if (NULL == recur)
     {
-        ret = ValidatePeriod(&period, currentTime);
+        ret = ValidatePeriod(period, currentTime);
     }
 
     //If recur is not NULL then the access time is between period's startTime and
@@ -398,35 +421,29 @@ IotvtICalResult_t IsRequestWithinValidTime(const char *periodStr, const char *re
     //is computed from period's startDate and the last instance is computed from
     //"UNTIL". If "UNTIL" is not specified then the recurrence goes for forever.
     //Eg, RRULE: FREQ=DAILY; UNTIL=20150703; BYDAY=MO, WE, FR
-    if (NULL != recurStr)
+    if (NULL != recur)
     {
-        ret = ParseRecur(recurStr, &recur);
-        if (ret != IOTVTICAL_SUCCESS)
-        {
-            return ret;
-        }
-
-        if ((0 <= DiffSecs(&period.startDateTime, currentTime))&&
-           (0 <= DiffSecs(currentTime, &period.endDateTime)) &&
-           (0 <= DiffDays(&period.startDateTime, currentTime)))
+        if ((0 <= DiffSecs(&period->startDateTime, currentTime))&&
+           (0 <= DiffSecs(currentTime, &period->endDateTime)) &&
+           (0 <= DiffDays(&period->startDateTime, currentTime)))
         {
             IotvtICalDateTime_t emptyDT = {.tm_sec=0};
             ret = IOTVTICAL_VALID_ACCESS;
 
             //"UNTIL" is an optional parameter of RRULE, checking if until present in recur
-            if (0 != memcmp(&recur.until, &emptyDT, sizeof(IotvtICalDateTime_t)))
+            if (0 != memcmp(&recur->until, &emptyDT, sizeof(IotvtICalDateTime_t)))
             {
-                if(0 > DiffDays(currentTime, &recur.until))
+                if(0 > DiffDays(currentTime, &recur->until))
                 {
                     ret = IOTVTICAL_INVALID_ACCESS;
                 }
             }
 
             //"BYDAY" is an optional parameter of RRULE, checking if byday present in recur
-            if (NO_WEEKDAY != recur.byDay)
+            if (NO_WEEKDAY != recur->byDay)
             {
 
-                int isValidWD = (0x1 << currentTime->tm_wday) & recur.byDay; //Valid weekdays
+                int isValidWD = (0x1 << currentTime->tm_wday) & recur->byDay; //Valid weekdays
                 if (!isValidWD)
                 {
                     ret = IOTVTICAL_INVALID_ACCESS;
@@ -21,6 +21,8 @@
 
 #include "utlist.h"
 #include "oic_malloc.h"
+#include "oic_string.h"
+#include "uhashmap.h"
 #include "policyengine.h"
 #include "amsmgr.h"
 #include "resourcemanager.h"
@@ -30,7 +32,6 @@
 #include "aclresource.h"
 #include "srmutility.h"
 #include "doxmresource.h"
-#include "iotvticalendar.h"
 #include "pstatresource.h"
 #include "dpairingresource.h"
 #include "pconfresource.h"
@@ -39,6 +40,27 @@
 
 #define TAG "SRM-PE"
 
+/**
+ * Number of ACL decisions remembered by the policy engine.
+ */
+#define PE_DECISION_CACHE_SIZE (32)
+
+/**
+ * The outcome of checking a request against the ACL.
+ */
+typedef struct PEDecision
+{
+    uint32_t    aclVersion;     /**< version of the ACL it was made with. */
+    OicUuid_t   subject;
+    char        *resource;      /**< NULL for an unused entry. */
+    uint16_t    permission;
+    bool        wildcardSubject;    /**< the ACEs of the wildcard subject decided. */
+    bool        matchingAclFound;
+    SRMAccessResponse_t retVal;
+} PEDecision_t;
+
+static PEDecision_t gDecisionCache[PE_DECISION_CACHE_SIZE];
+
 uint16_t GetPermissionFromCAMethod_t(const CAMethod_t method)
 {
     uint16_t perm = 0;
@@ -310,134 +332,59 @@ static void CopyParamsToContext(PEContext_t     *context,
 }
 
 /**
- * Check whether 'resource' is getting accessed within the valid time period.
- *
- * @param acl is the ACL to check.
- *
- * @return true if access is within valid time period or if the period or recurrence is not present.
- * false if period and recurrence present and the access is not within valid time period.
- */
-static bool IsAccessWithinValidTime(const OicSecAce_t *ace)
-{
-#ifndef WITH_ARDUINO //Period & Recurrence not supported on Arduino due
-    //lack of absolute time
-    if (NULL== ace || NULL == ace->validities)
-    {
-        return true;
-    }
-
-    //periods & recurrences rules are paired.
-    if (NULL == ace->validities->recurrences)
-    {
-        return false;
-    }
-
-    OicSecValidity_t* validity =  NULL;
-    LL_FOREACH(ace->validities, validity)
-    {
-        for(size_t i = 0; i < validity->recurrenceLen; i++)
-        {
-            if (IOTVTICAL_VALID_ACCESS ==  IsRequestWithinValidTime(validity->period,
-                validity->recurrences[i]))
-            {
-                OIC_LOG(INFO, TAG, "Access request is in allowed time period");
-                return true;
-            }
-        }
-    }
-    OIC_LOG(ERROR, TAG, "Access request is in invalid time period");
-    return false;
-
-#else
-    return true;
-#endif
-}
-
-/**
- * Check whether 'resource' is in the passed ACE.
- *
- * @param resource is the resource being searched.
- * @param ace is the ACE to check.
+ * Find the ACE of context->subject that decides on the requested resource.
+ * If resource found, check for context->permission and period validity.
+ * Set context->retVal to the result.
  *
- * @return true if 'resource' found, otherwise false.
+ * @return true if the result does not depend on the time of the request.
  */
- static bool IsResourceInAce(const char *resource, const OicSecAce_t *ace)
+static bool ProcessAccessRequest(PEContext_t *context)
 {
-    if (NULL== ace || NULL == resource)
-    {
-        return false;
-    }
-
-    OicSecRsrc_t* rsrc = NULL;
-    LL_FOREACH(ace->resources, rsrc)
-    {
-         if (0 == strcmp(resource, rsrc->href) || // TODO null terms?
-             0 == strcmp(WILDCARD_RESOURCE_URI, rsrc->href))
-         {
-             return true;
-         }
-    }
-    return false;
-}
-
+    bool timeIndependent = true;
 
-/**
- * Find ACLs containing context->subject.
- * Search each ACL for requested resource.
- * If resource found, check for context->permission and period validity.
- * If the ACL is not found locally and AMACL for the resource is found
- * then sends the request to AMS service for the ACL.
- * Set context->retVal to result from first ACL found which contains
- * correct subject AND resource.
- */
-static void ProcessAccessRequest(PEContext_t *context)
-{
     OIC_LOG(DEBUG, TAG, "Entering ProcessAccessRequest()");
     if (NULL != context)
     {
-        const OicSecAce_t *currentAce = NULL;
-        OicSecAce_t *savePtr = NULL;
+        OicSecAclMatch_t match;
 
         // Start out assuming subject not found.
         context->retVal = ACCESS_DENIED_SUBJECT_NOT_FOUND;
 
-        // Loop through all ACLs with a matching Subject searching for the right
-        // ACL for this request.
-        do
+        if (OC_STACK_OK != MatchACLResource(&context->subject, context->resource, &match))
         {
-            OIC_LOG_V(DEBUG, TAG, "%s: getting ACE..." ,__func__);
-            currentAce = GetACLResourceData(&context->subject, &savePtr);
+            OIC_LOG_V(ERROR, TAG, "%s:failed to search the ACL", __func__);
+            context->retVal = ACCESS_DENIED_POLICY_ENGINE_ERROR;
+            timeIndependent = false;
+        }
+        else if (match.subjectFound)
+        {
+            // Found the subject, so how about resource?
+            OIC_LOG_V(DEBUG, TAG, "%s:found ACE matching subject" ,__func__);
 
-            if (NULL != currentAce)
+            // Subject was found, so err changes to Rsrc not found for now.
+            context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
+            if (NULL != match.ace)
             {
-                // Found the subject, so how about resource?
-                OIC_LOG_V(DEBUG, TAG, "%s:found ACE matching subject" ,__func__);
+                OIC_LOG_V(INFO, TAG, "%s:found matching resource in ACE" ,__func__);
+                context->matchingAclFound = true;
+                timeIndependent = !match.timeDependent;
 
-                // Subject was found, so err changes to Rsrc not found for now.
-                context->retVal = ACCESS_DENIED_RESOURCE_NOT_FOUND;
-                OIC_LOG_V(DEBUG, TAG, "%s:Searching for resource..." ,__func__);
-                if (IsResourceInAce(context->resource, currentAce))
+                // Found the resource, so it's down to valid period & permission.
+                context->retVal = ACCESS_DENIED_INVALID_PERIOD;
+                if (match.withinValidTime)
                 {
-                    OIC_LOG_V(INFO, TAG, "%s:found matching resource in ACE" ,__func__);
-                    context->matchingAclFound = true;
-
-                    // Found the resource, so it's down to valid period & permission.
-                    context->retVal = ACCESS_DENIED_INVALID_PERIOD;
-                    if (IsAccessWithinValidTime(currentAce))
+                    context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
+                    if (IsPermissionAllowingRequest(match.ace->permission, context->permission))
                     {
-                        context->retVal = ACCESS_DENIED_INSUFFICIENT_PERMISSION;
-                        if (IsPermissionAllowingRequest(currentAce->permission, context->permission))
-                        {
-                            context->retVal = ACCESS_GRANTED;
-                        }
+                        context->retVal = ACCESS_GRANTED;
                     }
                 }
             }
-            else
-            {
-                OIC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
-            }
-        } while ((NULL != currentAce) && (false == context->matchingAclFound));
+        }
+        else
+        {
+            OIC_LOG_V(INFO, TAG, "%s:no ACL found matching subject for resource %s",__func__, context->resource);
+        }
 
         if (IsAccessGranted(context->retVal))
         {
@@ -452,6 +399,65 @@ static void ProcessAccessRequest(PEContext_t *context)
     {
         OIC_LOG_V(ERROR, TAG, "%s:Leaving ProcessAccessRequest(context is NULL)", __func__);
     }
+    return timeIndependent;
+}
+
+static PEDecision_t *GetDecisionCacheEntry(const OicUuid_t *subject, const PEContext_t *context)
+{
+    uint32_t hash = u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, subject, sizeof(OicUuid_t));
+    hash = u_hashmap_hash_bytes(hash, context->resource, strlen(context->resource));
+    hash = u_hashmap_hash_bytes(hash, &context->permission, sizeof(context->permission));
+    return &gDecisionCache[hash % PE_DECISION_CACHE_SIZE];
+}
+
+/**
+ * Find the result of an earlier ACL check of the same request, made with the
+ * current ACL.
+ */
+static const PEDecision_t *FindCachedDecision(const PEContext_t *context)
+{
+    const PEDecision_t *decision = GetDecisionCacheEntry(&context->subject, context);
+    if (NULL != decision->resource
+        && decision->aclVersion == GetACLVersion()
+        && decision->permission == context->permission
+        && 0 == memcmp(&decision->subject, &context->subject, sizeof(OicUuid_t))
+        && 0 == strcmp(decision->resource, context->resource))
+    {
+        return decision;
+    }
+    return NULL;
+}
+
+/**
+ * Remember the result of the ACL check in context for requests of subject.
+ */
+static void CacheDecision(const PEContext_t *context, const OicUuid_t *subject,
+                          bool wildcardSubject)
+{
+    PEDecision_t *decision = GetDecisionCacheEntry(subject, context);
+    char *resource = OICStrdup(context->resource);
+    if (NULL == resource)
+    {
+        return;
+    }
+
+    OICFree(decision->resource);
+    decision->resource = resource;
+    decision->aclVersion = GetACLVersion();
+    memcpy(&decision->subject, subject, sizeof(OicUuid_t));
+    decision->permission = context->permission;
+    decision->wildcardSubject = wildcardSubject;
+    decision->matchingAclFound = context->matchingAclFound;
+    decision->retVal = context->retVal;
+}
+
+static void ClearDecisionCache()
+{
+    for (size_t i = 0; i < PE_DECISION_CACHE_SIZE; i++)
+    {
+        OICFree(gDecisionCache[i].resource);
+        gDecisionCache[i].resource = NULL;
+    }
 }
 
 SRMAccessResponse_t CheckPermission(PEContext_t     *context,
@@ -495,25 +501,49 @@ SRMAccessResponse_t CheckPermission(PEContext_t     *context,
         else
         {
             OicUuid_t saveSubject = {.id={0}};
+            OicUuid_t requestSubject = context->subject;
             bool isSubEmpty = IsRequestSubjectEmpty(context);
+            const PEDecision_t *decision = FindCachedDecision(context);
 
-            ProcessAccessRequest(context);
-
-            // If matching ACL not found, and subject != wildcard, try wildcard.
-            if ((false == context->matchingAclFound) && \
-              (false == IsWildCardSubject(&context->subject)))
+            if (decision)
             {
-                //Saving subject for Amacl check
-                memcpy(&saveSubject, &context->subject,sizeof(OicUuid_t));
-
-                //Setting context subject to WILDCARD_SUBJECT_ID
-                //TODO: change ProcessAccessRequest method signature to
-                //ProcessAccessRequest(context, subject) so that context
-                //subject is not tempered.
-                memset(&context->subject, 0, sizeof(context->subject));
-                memcpy(&context->subject, &WILDCARD_SUBJECT_ID,sizeof(OicUuid_t));
-                ProcessAccessRequest(context); // TODO anonymous subj can result
-                                               // in confusing err code return.
+                OIC_LOG(DEBUG, TAG, "Using the cached ACL decision");
+                context->retVal = decision->retVal;
+                context->matchingAclFound = decision->matchingAclFound;
+                if (decision->wildcardSubject)
+                {
+                    memcpy(&saveSubject, &context->subject, sizeof(OicUuid_t));
+                    memcpy(&context->subject, &WILDCARD_SUBJECT_ID, sizeof(OicUuid_t));
+                }
+            }
+            else
+            {
+                bool cacheable = ProcessAccessRequest(context);
+                bool wildcardSubject = false;
+
+                // If matching ACL not found, and subject != wildcard, try wildcard.
+                if ((false == context->matchingAclFound) && \
+                  (false == IsWildCardSubject(&context->subject)))
+                {
+                    //Saving subject for Amacl check
+                    memcpy(&saveSubject, &context->subject,sizeof(OicUuid_t));
+
+                    //Setting context subject to WILDCARD_SUBJECT_ID
+                    //TODO: change ProcessAccessRequest method signature to
+                    //ProcessAccessRequest(context, subject) so that context
+                    //subject is not tempered.
+                    memset(&context->subject, 0, sizeof(context->subject));
+                    memcpy(&context->subject, &WILDCARD_SUBJECT_ID,sizeof(OicUuid_t));
+                    // TODO anonymous subj can result in confusing err code return.
+                    cacheable = ProcessAccessRequest(context) && cacheable;
+                    wildcardSubject = true;
+                }
+
+                // Decisions of ACEs with validities change over time.
+                if (cacheable)
+                {
+                    CacheDecision(context, &requestSubject, wildcardSubject);
+                }
             }
 
             //No local ACE found for the request so checking Amacl resource
@@ -578,5 +608,6 @@ void DeInitPolicyEngine(PEContext_t *context)
         SetPolicyEngineState(context, STOPPED);
         OICFree(context->amsMgrContext);
     }
+    ClearDecisionCache();
     return;
 }
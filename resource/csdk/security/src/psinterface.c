@@ -32,6 +32,7 @@
 #include "ocstack.h"
 #include "oic_malloc.h"
 #include "payload_logging.h"
+#include "psjournal.h"
 #include "resourcemanager.h"
 #include "secureresourcemanager.h"
 #include "srmresourcestrings.h"
@@ -95,6 +96,11 @@ OCStackResult GetSecureVirtualDatabaseFromPS(const char *rsrcName, uint8_t **dat
         return OC_STACK_INVALID_PARAM;
     }
 
+    if (IsSVRJournalEnabled())
+    {
+        return GetSVRFromJournal(rsrcName, data, size);
+    }
+
     FILE *fp = NULL;
     uint8_t *fsData = NULL;
     size_t fileSize = 0;
@@ -170,6 +176,12 @@ OCStackResult UpdateSecureResourceInPS(const char *rsrcName, const uint8_t *psPa
         return OC_STACK_INVALID_PARAM;
     }
 
+    // Only the updated section is written, instead of the whole database.
+    if (IsSVRJournalEnabled())
+    {
+        return UpdateSVRInJournal(rsrcName, psPayload, psSize);
+    }
+
     size_t dbSize = 0;
     size_t outSize = 0;
     uint8_t *dbData = NULL;
@@ -540,7 +552,11 @@ OCStackResult ResetSecureResourceInPS(void)
             outSize = encoder.ptr - outPayload;
         }
 
-        if (outPayload && outSize)
+        if (outPayload && outSize && IsSVRJournalEnabled())
+        {
+            ret = ReplaceSVRDatabaseInJournal(outPayload, outSize);
+        }
+        else if (outPayload && outSize)
         {
             OIC_LOG_V(DEBUG, TAG, "Writing in the file: %zu", outSize);
             OCPersistentStorage *ps = SRMGetPersistentStorageHandler();
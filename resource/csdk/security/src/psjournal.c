@@ -0,0 +1,890 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#ifdef WITH_ARDUINO
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include "iotivity_config.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "cainterface.h"
+#include "cbor.h"
+#include "logger.h"
+#include "oic_malloc.h"
+#include "ocpayload.h"
+#include "psjournal.h"
+#include "secureresourcemanager.h"
+#include "srmresourcestrings.h"
+#include "srmutility.h"
+#include "utlist.h"
+
+#define TAG  "SRM-PSJ"
+
+const char * SVR_DB_JOURNAL_FILE_NAMES[2] = { "oic_svr_db.journal0", "oic_svr_db.journal1" };
+
+/*
+ * A journal starts with a header:
+ *   magic "OICJ" | version (1 byte) | generation (4 bytes)
+ * followed by records:
+ *   type (1 byte) | name length (1 byte) | payload length (4 bytes) | name | payload | crc32 (4 bytes)
+ * Numbers are big endian; the crc covers the record up to the end of the payload.
+ *
+ * A snapshot of all sections comes first and is closed by a commit record;
+ * a journal without it is incomplete. Updates are appended after it, a set
+ * record with an empty payload deletes its section.
+ */
+#define JOURNAL_MAGIC           "OICJ"
+#define JOURNAL_MAGIC_SIZE      4
+#define JOURNAL_VERSION         1
+#define JOURNAL_HEADER_SIZE     (JOURNAL_MAGIC_SIZE + 1 + 4)
+#define JOURNAL_RECORD_SET      1
+#define JOURNAL_RECORD_COMMIT   2
+#define RECORD_HEADER_SIZE      (1 + 1 + 4)
+#define RECORD_CRC_SIZE         4
+#define RECORD_MAX_NAME_LEN     UINT8_MAX
+
+/**
+ * The journal is compacted once it is larger than this and twice its snapshot.
+ */
+#define JOURNAL_MIN_COMPACT_SIZE (16 * 1024)
+
+/**
+ * Block size for reading journal files.
+ */
+#define JOURNAL_READ_BLOCK      1024
+
+typedef struct PSSection PSSection_t;
+
+struct PSSection
+{
+    char *name;
+    uint8_t *data;
+    size_t size;
+    PSSection_t *next;
+};
+
+typedef struct
+{
+    bool enabled;
+    bool loaded;
+    PSSection_t *sections;
+    int active;             /**< index of the journal file in use, -1 if none */
+    uint32_t generation;    /**< generation of the active journal */
+    size_t journalSize;     /**< size of the valid part of the active journal */
+    bool needsCompaction;   /**< the active journal can not be appended to */
+} PSJournal_t;
+
+static PSJournal_t gJournal = { .active = -1 };
+
+static uint32_t UpdateCrc32(uint32_t crc, const uint8_t *data, size_t size)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void PutUint32(uint8_t *buf, uint32_t value)
+{
+    buf[0] = (uint8_t)(value >> 24);
+    buf[1] = (uint8_t)(value >> 16);
+    buf[2] = (uint8_t)(value >> 8);
+    buf[3] = (uint8_t)value;
+}
+
+static uint32_t GetUint32(const uint8_t *buf)
+{
+    return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16)
+         | ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+}
+
+static size_t RecordSize(const char *name, size_t size)
+{
+    return RECORD_HEADER_SIZE + (name ? strlen(name) : 0) + size + RECORD_CRC_SIZE;
+}
+
+/**
+ * Writes a record into buf, which must hold RecordSize() bytes.
+ *
+ * @return size of the record.
+ */
+static size_t WriteRecord(uint8_t *buf, uint8_t type, const char *name,
+                          const uint8_t *data, size_t size)
+{
+    size_t nameLen = name ? strlen(name) : 0;
+    uint8_t *pos = buf;
+
+    *pos++ = type;
+    *pos++ = (uint8_t)nameLen;
+    PutUint32(pos, (uint32_t)size);
+    pos += 4;
+    if (nameLen)
+    {
+        memcpy(pos, name, nameLen);
+        pos += nameLen;
+    }
+    if (size)
+    {
+        memcpy(pos, data, size);
+        pos += size;
+    }
+    PutUint32(pos, UpdateCrc32(0, buf, pos - buf));
+    pos += RECORD_CRC_SIZE;
+
+    return pos - buf;
+}
+
+static void FreeSection(PSSection_t *section)
+{
+    if (section)
+    {
+        OICFree(section->name);
+        OICFree(section->data);
+        OICFree(section);
+    }
+}
+
+static void FreeSections(PSSection_t *sections)
+{
+    PSSection_t *section = NULL;
+    PSSection_t *tmp = NULL;
+    LL_FOREACH_SAFE(sections, section, tmp)
+    {
+        LL_DELETE(sections, section);
+        FreeSection(section);
+    }
+}
+
+static PSSection_t *FindSection(PSSection_t *sections, const char *name, size_t nameLen)
+{
+    PSSection_t *section = NULL;
+    LL_FOREACH(sections, section)
+    {
+        if (strlen(section->name) == nameLen && 0 == memcmp(section->name, name, nameLen))
+        {
+            return section;
+        }
+    }
+    return NULL;
+}
+
+static PSSection_t *NewSection(const char *name, size_t nameLen, const uint8_t *data, size_t size)
+{
+    PSSection_t *section = (PSSection_t *) OICCalloc(1, sizeof(PSSection_t));
+    VERIFY_NON_NULL(TAG, section, ERROR);
+
+    section->name = (char *) OICCalloc(1, nameLen + 1);
+    VERIFY_NON_NULL(TAG, section->name, ERROR);
+    memcpy(section->name, name, nameLen);
+
+    section->data = (uint8_t *) OICMalloc(size);
+    VERIFY_NON_NULL(TAG, section->data, ERROR);
+    memcpy(section->data, data, size);
+    section->size = size;
+    return section;
+
+exit:
+    FreeSection(section);
+    return NULL;
+}
+
+/**
+ * Sets or, for an empty payload, deletes a section.
+ *
+ * @return false if out of memory.
+ */
+static bool SetSection(PSSection_t **sections, const char *name, size_t nameLen,
+                       const uint8_t *data, size_t size)
+{
+    PSSection_t *section = FindSection(*sections, name, nameLen);
+    if (section)
+    {
+        LL_DELETE(*sections, section);
+        FreeSection(section);
+    }
+    if (size)
+    {
+        section = NewSection(name, nameLen, data, size);
+        if (!section)
+        {
+            return false;
+        }
+        LL_APPEND(*sections, section);
+    }
+    return true;
+}
+
+/**
+ * @return size of a journal holding only the snapshot of sections.
+ */
+static size_t SnapshotSize(PSSection_t *sections)
+{
+    size_t size = JOURNAL_HEADER_SIZE + RecordSize(NULL, 0);
+    PSSection_t *section = NULL;
+    LL_FOREACH(sections, section)
+    {
+        size += RecordSize(section->name, section->size);
+    }
+    return size;
+}
+
+/**
+ * Flushes a file opened through the persistent storage handler to the disk,
+ * so that it survives a power loss once this returns.
+ *
+ * @return true if successful.
+ */
+static bool SyncFile(FILE *fp)
+{
+    if (0 != fflush(fp))
+    {
+        return false;
+    }
+#if defined(HAVE_UNISTD_H) && !defined(WITH_ARDUINO)
+    return 0 == fsync(fileno(fp));
+#else
+    return true;
+#endif
+}
+
+/**
+ * Writes a whole file through the persistent storage handler and flushes it to the disk.
+ *
+ * @return true if successful.
+ */
+static bool WriteFileDurably(const OCPersistentStorage *ps, const char *name,
+                             const uint8_t *data, size_t size)
+{
+    FILE *fp = ps->open(name, "wb");
+    if (!fp)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed to open %s", name);
+        return false;
+    }
+    size_t numberItems = ps->write(data, 1, size, fp);
+    bool synced = SyncFile(fp);
+    ps->close(fp);
+    if (size != numberItems || !synced)
+    {
+        OIC_LOG_V(ERROR, TAG, "Failed writing %zu of %zu bytes into %s", numberItems, size, name);
+        return false;
+    }
+    OIC_LOG_V(DEBUG, TAG, "Written %zu bytes into %s", size, name);
+    return true;
+}
+
+/**
+ * Reads a whole file through the persistent storage handler.
+ *
+ * @return the file contents, NULL if it is missing, empty or out of memory.
+ */
+static uint8_t *ReadJournalFile(const OCPersistentStorage *ps, const char *name, size_t *size)
+{
+    uint8_t *data = NULL;
+    size_t capacity = 0;
+    *size = 0;
+
+    FILE *fp = ps->open(name, "rb");
+    if (!fp)
+    {
+        return NULL;
+    }
+    for (;;)
+    {
+        if (capacity - *size < JOURNAL_READ_BLOCK)
+        {
+            capacity = capacity ? capacity * 2 : 4 * JOURNAL_READ_BLOCK;
+            uint8_t *tmp = (uint8_t *) OICRealloc(data, capacity);
+            if (!tmp)
+            {
+                OIC_LOG(ERROR, TAG, "Failed to allocate memory for the journal");
+                OICFree(data);
+                data = NULL;
+                *size = 0;
+                break;
+            }
+            data = tmp;
+        }
+        size_t bytesRead = ps->read(data + *size, 1, JOURNAL_READ_BLOCK, fp);
+        if (0 == bytesRead)
+        {
+            break;
+        }
+        *size += bytesRead;
+    }
+    ps->close(fp);
+
+    if (data && 0 == *size)
+    {
+        OICFree(data);
+        data = NULL;
+    }
+    return data;
+}
+
+/**
+ * Replays a journal into sections.
+ *
+ * @param data contents of the journal file.
+ * @param size size of data.
+ * @param sections receives the sections.
+ * @param generation receives the generation of the journal.
+ * @param validSize receives the size of the records that could be read.
+ *
+ * @return true if the journal is complete.
+ */
+static bool ReplayJournal(const uint8_t *data, size_t size, PSSection_t **sections,
+                          uint32_t *generation, size_t *validSize)
+{
+    bool committed = false;
+    size_t pos = JOURNAL_HEADER_SIZE;
+
+    if (size < JOURNAL_HEADER_SIZE
+        || 0 != memcmp(data, JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE)
+        || JOURNAL_VERSION != data[JOURNAL_MAGIC_SIZE])
+    {
+        return false;
+    }
+    *generation = GetUint32(data + JOURNAL_MAGIC_SIZE + 1);
+
+    while (size - pos >= RECORD_HEADER_SIZE + RECORD_CRC_SIZE)
+    {
+        const uint8_t *record = data + pos;
+        uint8_t type = record[0];
+        size_t nameLen = record[1];
+        size_t payloadLen = GetUint32(record + 2);
+        size_t available = size - pos - RECORD_HEADER_SIZE - RECORD_CRC_SIZE;
+        if (nameLen > available || payloadLen > available - nameLen)
+        {
+            OIC_LOG(INFO, TAG, "Journal ends with a truncated record");
+            break;
+        }
+        size_t recordLen = RECORD_HEADER_SIZE + nameLen + payloadLen;
+        if (GetUint32(record + recordLen) != UpdateCrc32(0, record, recordLen))
+        {
+            OIC_LOG(INFO, TAG, "Journal ends with a corrupted record");
+            break;
+        }
+
+        if (JOURNAL_RECORD_COMMIT == type)
+        {
+            committed = true;
+        }
+        else if (JOURNAL_RECORD_SET == type && nameLen)
+        {
+            const char *name = (const char *)(record + RECORD_HEADER_SIZE);
+            if (!SetSection(sections, name, nameLen, record + RECORD_HEADER_SIZE + nameLen,
+                            payloadLen))
+            {
+                committed = false;
+                break;
+            }
+        }
+        else
+        {
+            OIC_LOG_V(INFO, TAG, "Journal has an unknown record type %u", type);
+            break;
+        }
+        pos += recordLen + RECORD_CRC_SIZE;
+    }
+
+    *validSize = pos;
+    return committed;
+}
+
+/**
+ * Parses an SVR database in the format of the SVR database file into sections.
+ */
+static OCStackResult ParseDatabase(const uint8_t *data, size_t size, PSSection_t **sections)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    char *name = NULL;
+    uint8_t *payload = NULL;
+
+    CborParser parser;  // will be initialized in |cbor_parser_init|
+    CborValue cbor;     // will be initialized in |cbor_parser_init|
+    CborValue map;      // will be initialized in |cbor_value_enter_container|
+    CborError cborFindResult = cbor_parser_init(data, size, 0, &parser, &cbor);
+    VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+    VERIFY_SUCCESS(TAG, cbor_value_is_map(&cbor), ERROR);
+
+    cborFindResult = cbor_value_enter_container(&cbor, &map);
+    VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+    while (cbor_value_is_valid(&map))
+    {
+        size_t nameLen = 0;
+        size_t payloadLen = 0;
+        VERIFY_SUCCESS(TAG, cbor_value_is_text_string(&map), ERROR);
+        cborFindResult = cbor_value_dup_text_string(&map, &name, &nameLen, &map);
+        VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+        VERIFY_SUCCESS(TAG, 0 < nameLen && RECORD_MAX_NAME_LEN >= nameLen, ERROR);
+        VERIFY_SUCCESS(TAG, cbor_value_is_valid(&map), ERROR);
+
+        if (cbor_value_is_byte_string(&map))
+        {
+            cborFindResult = cbor_value_dup_byte_string(&map, &payload, &payloadLen, &map);
+            VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+            VERIFY_SUCCESS(TAG, SetSection(sections, name, nameLen, payload, payloadLen), ERROR);
+            OICFree(payload);
+            payload = NULL;
+        }
+        else
+        {
+            cborFindResult = cbor_value_advance(&map);
+            VERIFY_SUCCESS(TAG, CborNoError == cborFindResult, ERROR);
+        }
+        OICFree(name);
+        name = NULL;
+    }
+    ret = OC_STACK_OK;
+
+exit:
+    OICFree(name);
+    OICFree(payload);
+    return ret;
+}
+
+/**
+ * Encodes sections in the format of the SVR database file.
+ */
+static OCStackResult EncodeDatabase(PSSection_t *sections, uint8_t **data, size_t *size)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    int64_t cborEncoderResult = CborNoError;
+    uint8_t *outPayload = NULL;
+
+    // Each section needs at most 9 bytes for both string headers.
+    size_t outSize = 2;
+    PSSection_t *section = NULL;
+    LL_FOREACH(sections, section)
+    {
+        outSize += strlen(section->name) + section->size + 18;
+    }
+
+    outPayload = (uint8_t *) OICCalloc(1, outSize);
+    VERIFY_NON_NULL(TAG, outPayload, ERROR);
+    CborEncoder encoder;  // will be initialized in |cbor_encoder_init|
+    cbor_encoder_init(&encoder, outPayload, outSize, 0);
+    CborEncoder secRsrc;  // will be initialized in |cbor_encoder_create_map|
+    cborEncoderResult |= cbor_encoder_create_map(&encoder, &secRsrc, CborIndefiniteLength);
+    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding PS Map.");
+
+    LL_FOREACH(sections, section)
+    {
+        cborEncoderResult |= cbor_encode_text_string(&secRsrc, section->name, strlen(section->name));
+        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value Tag");
+        cborEncoderResult |= cbor_encode_byte_string(&secRsrc, section->data, section->size);
+        VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Adding Value.");
+    }
+
+    cborEncoderResult |= cbor_encoder_close_container(&encoder, &secRsrc);
+    VERIFY_CBOR_SUCCESS(TAG, cborEncoderResult, "Failed Closing Map.");
+    VERIFY_SUCCESS(TAG, CborNoError == cborEncoderResult, ERROR);
+
+    *size = encoder.ptr - outPayload;
+    *data = outPayload;
+    outPayload = NULL;
+    ret = OC_STACK_OK;
+
+exit:
+    OICFree(outPayload);
+    return ret;
+}
+
+/**
+ * Loads the newest complete journal, or the SVR database file if there is none.
+ * Fails if the SVRs can not be restored, rather than starting from defaults.
+ */
+static OCStackResult LoadJournal(void)
+{
+    if (gJournal.loaded)
+    {
+        return OC_STACK_OK;
+    }
+
+    OCPersistentStorage *ps = SRMGetPersistentStorageHandler();
+    if (!ps)
+    {
+        OIC_LOG(ERROR, TAG, "Persistent storage handler is not registered");
+        return OC_STACK_ERROR;
+    }
+
+    PSSection_t *best = NULL;
+    int bestIndex = -1;
+    uint32_t bestGeneration = 0;
+    size_t bestSize = 0;
+    bool bestTorn = false;
+    bool journalFound = false;
+
+    for (int i = 0; i < 2; i++)
+    {
+        size_t fileSize = 0;
+        uint8_t *fileData = ReadJournalFile(ps, SVR_DB_JOURNAL_FILE_NAMES[i], &fileSize);
+        if (!fileData)
+        {
+            continue;
+        }
+        journalFound = true;
+
+        PSSection_t *sections = NULL;
+        uint32_t generation = 0;
+        size_t validSize = 0;
+        if (ReplayJournal(fileData, fileSize, &sections, &generation, &validSize)
+            && (bestIndex < 0 || (int32_t)(generation - bestGeneration) > 0))
+        {
+            FreeSections(best);
+            best = sections;
+            bestIndex = i;
+            bestGeneration = generation;
+            bestSize = validSize;
+            bestTorn = validSize < fileSize;
+        }
+        else
+        {
+            FreeSections(sections);
+        }
+        OICFree(fileData);
+    }
+
+    if (0 <= bestIndex)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Loaded journal %s of generation %u",
+                  SVR_DB_JOURNAL_FILE_NAMES[bestIndex], bestGeneration);
+        gJournal.sections = best;
+        gJournal.active = bestIndex;
+        gJournal.generation = bestGeneration;
+        gJournal.journalSize = bestSize;
+        // Records appended after a torn one would be lost on the next load.
+        gJournal.needsCompaction = bestTorn;
+    }
+    else
+    {
+        // Compaction keeps the SVR database file up to date with the snapshot of
+        // the journal, so it is only missing before the SVRs were first written.
+        OIC_LOG(DEBUG, TAG, "No complete journal, loading the SVR database file");
+        size_t dbSize = 0;
+        uint8_t *dbData = ReadJournalFile(ps, SVR_DB_DAT_FILE_NAME, &dbSize);
+        if (!dbData && journalFound)
+        {
+            OIC_LOG(ERROR, TAG, "Journal is corrupted and there is no SVR database file");
+            return OC_STACK_ERROR;
+        }
+        if (dbData && OC_STACK_OK != ParseDatabase(dbData, dbSize, &gJournal.sections))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to parse the SVR database file");
+            FreeSections(gJournal.sections);
+            gJournal.sections = NULL;
+            OICFree(dbData);
+            return OC_STACK_ERROR;
+        }
+        OICFree(dbData);
+        gJournal.active = -1;
+        gJournal.generation = 0;
+        gJournal.journalSize = 0;
+        gJournal.needsCompaction = true;
+    }
+    gJournal.loaded = true;
+    return OC_STACK_OK;
+}
+
+/**
+ * Writes a snapshot of all sections into the inactive journal file and
+ * switches to it. The previous journal stays valid until the new one is
+ * complete and on the disk, and is only removed afterwards. The snapshot
+ * is also written into the SVR database file, which is loaded if both
+ * journals are lost.
+ */
+static OCStackResult CompactJournal(void)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    OCPersistentStorage *ps = SRMGetPersistentStorageHandler();
+    VERIFY_NON_NULL(TAG, ps, ERROR);
+
+    int target = (0 == gJournal.active) ? 1 : 0;
+    uint32_t generation = gJournal.generation + 1;
+    size_t size = SnapshotSize(gJournal.sections);
+
+    uint8_t *buf = (uint8_t *) OICMalloc(size);
+    VERIFY_NON_NULL(TAG, buf, ERROR);
+
+    memcpy(buf, JOURNAL_MAGIC, JOURNAL_MAGIC_SIZE);
+    buf[JOURNAL_MAGIC_SIZE] = JOURNAL_VERSION;
+    PutUint32(buf + JOURNAL_MAGIC_SIZE + 1, generation);
+    size_t pos = JOURNAL_HEADER_SIZE;
+    PSSection_t *section = NULL;
+    LL_FOREACH(gJournal.sections, section)
+    {
+        pos += WriteRecord(buf + pos, JOURNAL_RECORD_SET, section->name,
+                           section->data, section->size);
+    }
+    pos += WriteRecord(buf + pos, JOURNAL_RECORD_COMMIT, NULL, NULL, 0);
+
+    if (WriteFileDurably(ps, SVR_DB_JOURNAL_FILE_NAMES[target], buf, pos))
+    {
+        ret = OC_STACK_OK;
+    }
+    OICFree(buf);
+
+    if (OC_STACK_OK == ret)
+    {
+        // The new journal is authoritative from here on, a failure only leaves
+        // the SVR database file behind it.
+        uint8_t *db = NULL;
+        size_t dbSize = 0;
+        if (OC_STACK_OK != EncodeDatabase(gJournal.sections, &db, &dbSize)
+            || !WriteFileDurably(ps, SVR_DB_DAT_FILE_NAME, db, dbSize))
+        {
+            OIC_LOG(ERROR, TAG, "Failed to update the SVR database file");
+        }
+        OICFree(db);
+
+        if (0 <= gJournal.active)
+        {
+            ps->unlink(SVR_DB_JOURNAL_FILE_NAMES[gJournal.active]);
+        }
+        gJournal.active = target;
+        gJournal.generation = generation;
+        gJournal.journalSize = pos;
+        gJournal.needsCompaction = false;
+    }
+
+exit:
+    return ret;
+}
+
+/**
+ * Appends a set record to the active journal.
+ */
+static OCStackResult AppendJournal(const char *name, const uint8_t *data, size_t size)
+{
+    OCStackResult ret = OC_STACK_ERROR;
+    OCPersistentStorage *ps = SRMGetPersistentStorageHandler();
+    VERIFY_NON_NULL(TAG, ps, ERROR);
+
+    size_t recordSize = RecordSize(name, size);
+    uint8_t *buf = (uint8_t *) OICMalloc(recordSize);
+    VERIFY_NON_NULL(TAG, buf, ERROR);
+    WriteRecord(buf, JOURNAL_RECORD_SET, name, data, size);
+
+    FILE *fp = ps->open(SVR_DB_JOURNAL_FILE_NAMES[gJournal.active], "ab");
+    if (fp)
+    {
+        size_t numberItems = ps->write(buf, 1, recordSize, fp);
+        ps->close(fp);
+        if (recordSize == numberItems)
+        {
+            gJournal.journalSize += recordSize;
+            ret = OC_STACK_OK;
+        }
+        else
+        {
+            OIC_LOG_V(ERROR, TAG, "Failed writing %zu in the journal", numberItems);
+            gJournal.needsCompaction = true;
+        }
+    }
+    else
+    {
+        OIC_LOG(ERROR, TAG, "File open failed.");
+    }
+    OICFree(buf);
+
+exit:
+    return ret;
+}
+
+void SetSVRJournalEnabled(bool enable)
+{
+    if (gJournal.enabled != enable)
+    {
+        DeInitSVRJournal();
+        gJournal.enabled = enable;
+    }
+}
+
+bool IsSVRJournalEnabled(void)
+{
+    return gJournal.enabled;
+}
+
+OCStackResult GetSVRFromJournal(const char *rsrcName, uint8_t **data, size_t *size)
+{
+    if (!data || *data || !size)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCStackResult ret = LoadJournal();
+    if (OC_STACK_OK != ret)
+    {
+        return ret;
+    }
+
+    if (!rsrcName)
+    {
+        // Like an empty SVR database file.
+        if (!gJournal.sections)
+        {
+            return OC_STACK_ERROR;
+        }
+        return EncodeDatabase(gJournal.sections, data, size);
+    }
+
+    PSSection_t *section = FindSection(gJournal.sections, rsrcName, strlen(rsrcName));
+    if (!section)
+    {
+        return OC_STACK_ERROR;
+    }
+    *data = (uint8_t *) OICMalloc(section->size);
+    if (!*data)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to allocate memory for the SVR");
+        return OC_STACK_NO_MEMORY;
+    }
+    memcpy(*data, section->data, section->size);
+    *size = section->size;
+    return OC_STACK_OK;
+}
+
+OCStackResult UpdateSVRInJournal(const char *rsrcName, const uint8_t *payload, size_t size)
+{
+    if (!rsrcName || !*rsrcName || RECORD_MAX_NAME_LEN < strlen(rsrcName)
+        || (size && !payload) || UINT32_MAX < size)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCStackResult ret = LoadJournal();
+    if (OC_STACK_OK != ret)
+    {
+        return ret;
+    }
+
+    size_t nameLen = strlen(rsrcName);
+    PSSection_t *section = NULL;
+    if (size)
+    {
+        section = NewSection(rsrcName, nameLen, payload, size);
+        if (!section)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+
+    // Keep the previous section, in case the update can not be stored.
+    PSSection_t *previous = FindSection(gJournal.sections, rsrcName, nameLen);
+    if (previous)
+    {
+        LL_DELETE(gJournal.sections, previous);
+    }
+    if (section)
+    {
+        LL_APPEND(gJournal.sections, section);
+    }
+
+    ret = OC_STACK_ERROR;
+    size_t snapshotSize = SnapshotSize(gJournal.sections);
+    size_t threshold = (2 * snapshotSize > JOURNAL_MIN_COMPACT_SIZE) ?
+                       2 * snapshotSize : JOURNAL_MIN_COMPACT_SIZE;
+    if (!gJournal.needsCompaction && 0 <= gJournal.active
+        && gJournal.journalSize + RecordSize(rsrcName, size) <= threshold)
+    {
+        ret = AppendJournal(rsrcName, payload, size);
+    }
+    if (OC_STACK_OK != ret)
+    {
+        ret = CompactJournal();
+    }
+
+    if (OC_STACK_OK == ret)
+    {
+        FreeSection(previous);
+    }
+    else
+    {
+        if (section)
+        {
+            LL_DELETE(gJournal.sections, section);
+            FreeSection(section);
+        }
+        if (previous)
+        {
+            LL_APPEND(gJournal.sections, previous);
+        }
+    }
+    return ret;
+}
+
+OCStackResult ReplaceSVRDatabaseInJournal(const uint8_t *data, size_t size)
+{
+    if (!data || !size)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCStackResult ret = LoadJournal();
+    if (OC_STACK_OK != ret)
+    {
+        return ret;
+    }
+
+    PSSection_t *sections = NULL;
+    ret = ParseDatabase(data, size, &sections);
+    if (OC_STACK_OK != ret)
+    {
+        FreeSections(sections);
+        return ret;
+    }
+
+    PSSection_t *previous = gJournal.sections;
+    gJournal.sections = sections;
+    ret = CompactJournal();
+    if (OC_STACK_OK == ret)
+    {
+        FreeSections(previous);
+    }
+    else
+    {
+        gJournal.sections = previous;
+        FreeSections(sections);
+    }
+    return ret;
+}
+
+void DeInitSVRJournal(void)
+{
+    FreeSections(gJournal.sections);
+    gJournal.sections = NULL;
+    gJournal.loaded = false;
+    gJournal.active = -1;
+    gJournal.generation = 0;
+    gJournal.journalSize = 0;
+    gJournal.needsCompaction = false;
+}
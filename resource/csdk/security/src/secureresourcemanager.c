@@ -33,6 +33,7 @@
 #include "secureresourcemanager.h"
 #include "srmresourcestrings.h"
 #include "ocresourcehandler.h"
+#include "psjournal.h"
 
 #ifdef __WITH_TLS__
 #include "pkix_interface.h"
@@ -337,6 +338,8 @@ OCStackResult SRMRegisterPersistentStorageHandler(OCPersistentStorage* persisten
         return OC_STACK_INVALID_PARAM;
     }
     gPersistentStorageHandler = persistentStorageHandler;
+    // The loaded journal may belong to the previous handler.
+    DeInitSVRJournal();
     return OC_STACK_OK;
 }
 
@@ -345,6 +348,13 @@ OCPersistentStorage* SRMGetPersistentStorageHandler()
     return gPersistentStorageHandler;
 }
 
+OCStackResult SRMEnablePersistentStorageJournal(bool enable)
+{
+    OIC_LOG_V(DEBUG, TAG, "SRMEnablePersistentStorageJournal %d", enable);
+    SetSVRJournalEnabled(enable);
+    return OC_STACK_OK;
+}
+
 OCStackResult SRMInitSecureResources()
 {
     // TODO: temporarily returning OC_STACK_OK every time until default
@@ -378,6 +388,7 @@ OCStackResult SRMInitSecureResources()
 void SRMDeInitSecureResources()
 {
     DestroySecureResources();
+    DeInitSVRJournal();
 }
 
 OCStackResult SRMInitPolicyEngine()
@@ -569,3 +569,88 @@ TEST(ACLResourceTest, ACLGetWithQueryTest)
     OICFree(ehReq.query);
     OICFree(payload);
 }
+
+static OicSecAce_t *AppendACE(OicSecAcl_t *acl, const char *subject, const char *rsrcName,
+                              uint16_t permission)
+{
+    OicSecAce_t *ace = (OicSecAce_t *)OICCalloc(1, sizeof(OicSecAce_t));
+    if (ace)
+    {
+        memcpy(ace->subjectuuid.id, subject, sizeof(ace->subjectuuid.id));
+        EXPECT_TRUE(AddResourceToACE(ace, rsrcName, "oic.core", "oic.if.r"));
+        ace->permission = permission;
+        LL_APPEND(acl->aces, ace);
+    }
+    return ace;
+}
+
+// MatchACLResource tests
+TEST(ACLResourceTest, MatchACLResourceTest)
+{
+    OicSecAcl_t *acl = (OicSecAcl_t *)OICCalloc(1, sizeof(OicSecAcl_t));
+    ASSERT_TRUE(NULL != acl);
+
+    const char subjectA[] = "1111111111111111";
+    const char subjectB[] = "2222222222222222";
+    OicSecAce_t *ledAce = AppendACE(acl, subjectA, "/a/led", PERMISSION_READ);
+    OicSecAce_t *wildcardAce = AppendACE(acl, subjectA, WILDCARD_RESOURCE_URI,
+                                         PERMISSION_FULL_CONTROL);
+    AppendACE(acl, subjectA, "/a/fan", PERMISSION_WRITE);
+    OicSecAce_t *doorAce = AppendACE(acl, subjectB, "/a/door", PERMISSION_READ);
+    ASSERT_TRUE(NULL != ledAce && NULL != wildcardAce && NULL != doorAce);
+
+    // An expired validity.
+    doorAce->validities = (OicSecValidity_t *)OICCalloc(1, sizeof(OicSecValidity_t));
+    ASSERT_TRUE(NULL != doorAce->validities);
+    doorAce->validities->period = OICStrdup("20150630/20150730");
+    doorAce->validities->recurrences = (char **)OICCalloc(1, sizeof(char *));
+    ASSERT_TRUE(NULL != doorAce->validities->recurrences);
+    doorAce->validities->recurrences[0] = OICStrdup("FREQ=DAILY; UNTIL=20150730");
+    doorAce->validities->recurrenceLen = 1;
+
+    uint32_t version = GetACLVersion();
+    EXPECT_EQ(OC_STACK_OK, SetDefaultACL(acl));
+    EXPECT_NE(version, GetACLVersion());
+
+    OicUuid_t subject = {.id = {0}};
+    OicSecAclMatch_t match;
+    memcpy(subject.id, subjectA, sizeof(subject.id));
+
+    // The first ACE that lists the resource decides.
+    EXPECT_EQ(OC_STACK_OK, MatchACLResource(&subject, "/a/led", &match));
+    EXPECT_TRUE(match.subjectFound);
+    EXPECT_EQ(ledAce, match.ace);
+    EXPECT_TRUE(match.withinValidTime);
+    EXPECT_FALSE(match.timeDependent);
+
+    // The wildcard resource comes before /a/fan.
+    EXPECT_EQ(OC_STACK_OK, MatchACLResource(&subject, "/a/fan", &match));
+    EXPECT_EQ(wildcardAce, match.ace);
+    EXPECT_EQ(OC_STACK_OK, MatchACLResource(&subject, "/a/light", &match));
+    EXPECT_EQ(wildcardAce, match.ace);
+
+    memcpy(subject.id, subjectB, sizeof(subject.id));
+    EXPECT_EQ(OC_STACK_OK, MatchACLResource(&subject, "/a/door", &match));
+    EXPECT_EQ(doorAce, match.ace);
+    EXPECT_FALSE(match.withinValidTime);
+    EXPECT_TRUE(match.timeDependent);
+
+    EXPECT_EQ(OC_STACK_OK, MatchACLResource(&subject, "/a/led", &match));
+    EXPECT_TRUE(match.subjectFound);
+    EXPECT_TRUE(NULL == match.ace);
+
+    OicUuid_t unknownSubject = {.id = {0}};
+    memcpy(unknownSubject.id, "3333333333333333", sizeof(unknownSubject.id));
+    EXPECT_EQ(OC_STACK_OK, MatchACLResource(&unknownSubject, "/a/led", &match));
+    EXPECT_FALSE(match.subjectFound);
+
+    // GetACLResourceData walks the ACEs of a subject in order.
+    memcpy(subject.id, subjectA, sizeof(subject.id));
+    OicSecAce_t *savePtr = NULL;
+    EXPECT_EQ(ledAce, GetACLResourceData(&subject, &savePtr));
+    EXPECT_EQ(wildcardAce, GetACLResourceData(&subject, &savePtr));
+    EXPECT_TRUE(NULL != GetACLResourceData(&subject, &savePtr));
+    EXPECT_TRUE(NULL == GetACLResourceData(&subject, &savePtr));
+
+    DeInitACLResource();
+}
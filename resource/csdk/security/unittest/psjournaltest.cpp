@@ -0,0 +1,265 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+
+#include "cbor.h"
+#include "ocstack.h"
+#include "oic_malloc.h"
+#include "cainterface.h"
+#include "secureresourcemanager.h"
+#include "srmresourcestrings.h"
+#include "psjournal.h"
+
+// Keeps the test files apart from the SVR database of the other tests.
+static std::string TestPath(const char *path)
+{
+    return std::string("psjournaltest_") + path;
+}
+
+static FILE *TestOpen(const char *path, const char *mode)
+{
+    return fopen(TestPath(path).c_str(), mode);
+}
+
+static int TestUnlink(const char *path)
+{
+    return unlink(TestPath(path).c_str());
+}
+
+static long TestFileSize(const char *path)
+{
+    FILE *fp = TestOpen(path, "rb");
+    if (!fp)
+    {
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+// Stays registered after the tests if no handler was registered before.
+static OCPersistentStorage gps;
+
+class PSJournalTest : public testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        m_previous = SRMGetPersistentStorageHandler();
+        gps.open = TestOpen;
+        gps.read = fread;
+        gps.write = fwrite;
+        gps.close = fclose;
+        gps.unlink = TestUnlink;
+        RemoveFiles();
+        SRMRegisterPersistentStorageHandler(&gps);
+        SetSVRJournalEnabled(true);
+    }
+
+    virtual void TearDown()
+    {
+        SetSVRJournalEnabled(false);
+        RemoveFiles();
+        if (m_previous)
+        {
+            SRMRegisterPersistentStorageHandler(m_previous);
+        }
+    }
+
+    void RemoveFiles()
+    {
+        TestUnlink(SVR_DB_DAT_FILE_NAME);
+        TestUnlink(SVR_DB_JOURNAL_FILE_NAMES[0]);
+        TestUnlink(SVR_DB_JOURNAL_FILE_NAMES[1]);
+    }
+
+    void Update(const char *name, const std::string& value)
+    {
+        ASSERT_EQ(OC_STACK_OK, UpdateSVRInJournal(name, (const uint8_t *) value.data(),
+                                                  value.size()));
+    }
+
+    std::string Get(const char *name)
+    {
+        uint8_t *data = NULL;
+        size_t size = 0;
+        if (OC_STACK_OK != GetSVRFromJournal(name, &data, &size))
+        {
+            return std::string();
+        }
+        std::string value((const char *) data, size);
+        OICFree(data);
+        return value;
+    }
+
+    OCPersistentStorage *m_previous;
+};
+
+TEST_F(PSJournalTest, UpdateAndReload)
+{
+    Update("acl", "acl1");
+    Update("cred", "cred1");
+    Update("acl", "acl2");
+    EXPECT_EQ("acl2", Get("acl"));
+    EXPECT_EQ("cred1", Get("cred"));
+
+    DeInitSVRJournal();
+    EXPECT_EQ("acl2", Get("acl"));
+    EXPECT_EQ("cred1", Get("cred"));
+    EXPECT_EQ("", Get("pstat"));
+}
+
+TEST_F(PSJournalTest, EmptyPayloadDeletes)
+{
+    Update("acl", "acl1");
+    EXPECT_EQ(OC_STACK_OK, UpdateSVRInJournal("acl", NULL, 0));
+    EXPECT_EQ("", Get("acl"));
+
+    DeInitSVRJournal();
+    EXPECT_EQ("", Get("acl"));
+}
+
+TEST_F(PSJournalTest, IgnoresTornRecord)
+{
+    Update("acl", "acl1");
+    Update("doxm", "doxm1");
+    ASSERT_LT(0, TestFileSize(SVR_DB_JOURNAL_FILE_NAMES[0]));
+
+    // A set record for "doxm" that ends before its payload.
+    const uint8_t torn[] = { 1, 4, 0, 0, 0, 5, 'd', 'o', 'x', 'm', 'd' };
+    FILE *fp = TestOpen(SVR_DB_JOURNAL_FILE_NAMES[0], "ab");
+    ASSERT_TRUE(fp != NULL);
+    fwrite(torn, 1, sizeof(torn), fp);
+    fclose(fp);
+
+    DeInitSVRJournal();
+    EXPECT_EQ("acl1", Get("acl"));
+    EXPECT_EQ("doxm1", Get("doxm"));
+
+    // The next update is not appended after the torn record.
+    Update("doxm", "doxm2");
+    DeInitSVRJournal();
+    EXPECT_EQ("acl1", Get("acl"));
+    EXPECT_EQ("doxm2", Get("doxm"));
+}
+
+TEST_F(PSJournalTest, CompactsIntoOtherFile)
+{
+    std::string value(1000, 'x');
+    for (int i = 0; i < 100; ++i)
+    {
+        value[0] = (char)('a' + i % 26);
+        Update("cred", value);
+    }
+    Update("acl", "acl1");
+
+    long size0 = TestFileSize(SVR_DB_JOURNAL_FILE_NAMES[0]);
+    long size1 = TestFileSize(SVR_DB_JOURNAL_FILE_NAMES[1]);
+    EXPECT_TRUE((0 > size0) != (0 > size1));
+    EXPECT_GT(32 * 1024, std::max(size0, size1));
+
+    DeInitSVRJournal();
+    EXPECT_EQ(value, Get("cred"));
+    EXPECT_EQ("acl1", Get("acl"));
+}
+
+TEST_F(PSJournalTest, ReadsDatabaseFileWithoutJournal)
+{
+    uint8_t db[64];
+    CborEncoder encoder;
+    CborEncoder map;
+    cbor_encoder_init(&encoder, db, sizeof(db), 0);
+    ASSERT_EQ(CborNoError, cbor_encoder_create_map(&encoder, &map, CborIndefiniteLength));
+    ASSERT_EQ(CborNoError, cbor_encode_text_string(&map, "pstat", 5));
+    ASSERT_EQ(CborNoError, cbor_encode_byte_string(&map, (const uint8_t *) "pstat1", 6));
+    ASSERT_EQ(CborNoError, cbor_encoder_close_container(&encoder, &map));
+    size_t dbSize = encoder.ptr - db;
+
+    FILE *fp = TestOpen(SVR_DB_DAT_FILE_NAME, "wb");
+    ASSERT_TRUE(fp != NULL);
+    fwrite(db, 1, dbSize, fp);
+    fclose(fp);
+
+    DeInitSVRJournal();
+    EXPECT_EQ("pstat1", Get("pstat"));
+
+    Update("acl", "acl1");
+    DeInitSVRJournal();
+    EXPECT_EQ("pstat1", Get("pstat"));
+    EXPECT_EQ("acl1", Get("acl"));
+}
+
+TEST_F(PSJournalTest, CompactionUpdatesDatabaseFile)
+{
+    Update("acl", "acl1");
+    Update("cred", "cred1");
+    ASSERT_LT(0, TestFileSize(SVR_DB_DAT_FILE_NAME));
+
+    // Both journals lost, the database file holds the last snapshot.
+    TestUnlink(SVR_DB_JOURNAL_FILE_NAMES[0]);
+    TestUnlink(SVR_DB_JOURNAL_FILE_NAMES[1]);
+    DeInitSVRJournal();
+    EXPECT_EQ("acl1", Get("acl"));
+}
+
+TEST_F(PSJournalTest, FailsWithoutJournalOrDatabaseFile)
+{
+    Update("acl", "acl1");
+    TestUnlink(SVR_DB_DAT_FILE_NAME);
+
+    FILE *fp = TestOpen(SVR_DB_JOURNAL_FILE_NAMES[0], "r+b");
+    ASSERT_TRUE(fp != NULL);
+    fwrite("XXXX", 1, 4, fp);
+    fclose(fp);
+
+    DeInitSVRJournal();
+    uint8_t *data = NULL;
+    size_t size = 0;
+    EXPECT_NE(OC_STACK_OK, GetSVRFromJournal("acl", &data, &size));
+    EXPECT_NE(OC_STACK_OK, UpdateSVRInJournal("acl", (const uint8_t *) "acl2", 4));
+}
+
+TEST_F(PSJournalTest, ReplaceDatabase)
+{
+    Update("acl", "acl1");
+    Update("cred", "cred1");
+
+    uint8_t *db = NULL;
+    size_t dbSize = 0;
+    ASSERT_EQ(OC_STACK_OK, GetSVRFromJournal(NULL, &db, &dbSize));
+    Update("acl", "acl2");
+    Update("pstat", "pstat1");
+
+    EXPECT_EQ(OC_STACK_OK, ReplaceSVRDatabaseInJournal(db, dbSize));
+    OICFree(db);
+
+    DeInitSVRJournal();
+    EXPECT_EQ("acl1", Get("acl"));
+    EXPECT_EQ("cred1", Get("cred"));
+    EXPECT_EQ("", Get("pstat"));
+}
@@ -128,10 +128,19 @@ typedef struct ClientCB {
 
     /** next node in this list.*/
     struct ClientCB    *next;
+
+    /** previous node in this list.*/
+    struct ClientCB    *prev;
+
+    /** next node in the list of callbacks ordered by TTL. Unused if TTL is 0.*/
+    struct ClientCB    *expiryNext;
+
+    /** previous node in the list of callbacks ordered by TTL. Unused if TTL is 0.*/
+    struct ClientCB    *expiryPrev;
 } ClientCB;
 
 /**
- * Linked list of ClientCB node.
+ * Doubly linked list of ClientCB node.
  */
 extern struct ClientCB *cbList;
 
@@ -186,6 +195,30 @@ void DeleteClientCB(ClientCB *cbNode);
 ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
                       OCDoHandle handle, const char * requestUri);
 
+/** @ingroup ocstack
+ *
+ * This method is used to set the time to live of a cb node in cbList.
+ *
+ * @param[in] cbNode       Address to client callback node.
+ * @param[in] ttl          time to live in coap_ticks, 0 if the callback does not time out.
+ */
+void SetClientCBTTL(ClientCB *cbNode, uint32_t ttl);
+
+/** @ingroup ocstack
+ *
+ * This method is used to get the earliest time to live of the cb nodes in cbList.
+ *
+ * @return time to live in coap_ticks, 0 if no callback times out.
+ */
+uint32_t GetNextClientCBTTL();
+
+/** @ingroup ocstack
+ *
+ * This method is used to delete all cb nodes in cbList whose time to live has passed.
+ * Presence and observe callbacks with a TTL of 0 are not deleted.
+ */
+void DeleteTimedOutClientCBs();
+
 #ifdef WITH_PRESENCE
 /**
  * Inserts a new resource type filter into this cb node.
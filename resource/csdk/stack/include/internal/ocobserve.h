@@ -77,6 +77,9 @@ typedef struct ResourceObserver
     /** next node in this list.*/
     struct ResourceObserver *next;
 
+    /** next observer of the same resource.*/
+    struct ResourceObserver *nextInResource;
+
     /** requested payload encoding format. */
     OCPayloadFormat acceptFormat;
 
@@ -0,0 +1,122 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains a bump allocator used to parse a whole representation
+ * payload tree out of a few large blocks.
+ */
+
+#ifndef OC_PAYLOAD_ARENA_H
+#define OC_PAYLOAD_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct OCPayloadArenaChunk OCPayloadArenaChunk;
+typedef struct OCPayloadArenaNode OCPayloadArenaNode;
+
+/**
+ * Arena the nodes, names and values of a parsed payload are allocated from.
+ */
+typedef struct OCPayloadArena
+{
+    /** Most recently allocated block, older blocks are chained behind it. */
+    OCPayloadArenaChunk *chunks;
+
+    /** Minimum size of a block. */
+    size_t chunkSize;
+
+    /** Payload whose destruction frees the arena, NULL while parsing. */
+    void *owner;
+
+    /** Payloads registered with OCPayloadArenaRegister, unregistered on destruction. */
+    OCPayloadArenaNode *registered;
+} OCPayloadArena;
+
+/**
+ * Prepare the index of arena payloads. Must be called before the first arena is created.
+ *
+ * @return true if successful, false otherwise.
+ */
+bool OCPayloadArenaInitialize(void);
+
+/**
+ * Free the index of arena payloads. It is kept while arena payloads are still alive.
+ */
+void OCPayloadArenaTerminate(void);
+
+/**
+ * Create an arena.
+ *
+ * @param sizeHint  Expected number of bytes that will be allocated.
+ *
+ * @return arena if successful, NULL otherwise.
+ */
+OCPayloadArena *OCPayloadArenaCreate(size_t sizeHint);
+
+/**
+ * Allocate zeroed memory from the arena, aligned for any payload type.
+ * The memory stays valid until the arena is destroyed.
+ *
+ * @param arena     Arena to allocate from.
+ * @param size      Number of bytes.
+ *
+ * @return pointer to the memory if successful, NULL otherwise.
+ */
+void *OCPayloadArenaAlloc(OCPayloadArena *arena, size_t size);
+
+/**
+ * Free the arena and everything allocated from it.
+ *
+ * @param arena     Arena to destroy.
+ */
+void OCPayloadArenaDestroy(OCPayloadArena *arena);
+
+/**
+ * Record that a payload was allocated from the arena, so OCPayloadArenaFind() knows it.
+ *
+ * @param arena     Arena the payload was allocated from.
+ * @param ptr       Payload.
+ *
+ * @return true if successful, false otherwise.
+ */
+bool OCPayloadArenaRegister(OCPayloadArena *arena, const void *ptr);
+
+/**
+ * Find the live arena a registered payload was allocated from.
+ *
+ * @param ptr       Payload to look up.
+ *
+ * @return arena holding the payload, NULL if it was not allocated from an arena.
+ */
+OCPayloadArena *OCPayloadArenaFind(const void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OC_PAYLOAD_ARENA_H
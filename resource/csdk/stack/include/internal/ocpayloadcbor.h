@@ -30,6 +30,14 @@ extern "C"
 OCStackResult OCParsePayload(OCPayload** outPayload, OCPayloadType type,
         const uint8_t* payload, size_t payloadSize);
 
+/**
+ * Parse a payload the stack received with a request or response.
+ * Same as OCParsePayload(), except that representation payloads are parsed into
+ * an arena when this was enabled with OCRepPayloadSetArenaParsing().
+ */
+OCStackResult OCParseReceivedPayload(OCPayload** outPayload, OCPayloadType type,
+        const uint8_t* payload, size_t payloadSize);
+
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size);
 
 #ifdef __cplusplus
@@ -177,6 +177,18 @@ void DeletePlatformInfo();
  */
 void DeleteDeviceInfo();
 
+/**
+ * Internal API used to drop the cached discovery responses, after a change of
+ * the resources or of the device information.
+ */
+void InvalidateDiscoveryCache();
+
+/**
+ * Internal API used to drop the cached discovery responses from another thread,
+ * after a change of the network. They are dropped by the next discovery request.
+ */
+void MarkDiscoveryCacheStale();
+
 /*
  * Prepare payload for resource representation.
  */
@@ -37,6 +37,25 @@
  */
 typedef OCStackResult (* OCEHResponseHandler)(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Observer that is sent the same notification as the server request it is attached to.
+ * Only the token, address and message type of the response differ.
+ */
+typedef struct OCNotificationReceiver
+{
+    /** Token of the observe request.*/
+    uint8_t token[CA_MAX_TOKEN_LEN];
+
+    /** token length of the observe request.*/
+    uint8_t tokenLength;
+
+    /** Quality of service of the notification.*/
+    OCQualityOfService qos;
+
+    /** Remote endpoint address **/
+    OCDevAddr devAddr;
+} OCNotificationReceiver;
+
 /**
  * following structure will be created in occoap and passed up the stack on the server side.
  */
@@ -103,6 +122,15 @@ typedef struct OCServerRequest
     /** Flag indicating notification.*/
     uint8_t notificationFlag;
 
+    /** Other observers sent the same notification.*/
+    OCNotificationReceiver *receivers;
+
+    /** Number of receivers.*/
+    uint32_t numReceivers;
+
+    /** Allocated number of receivers.*/
+    uint32_t receiversSize;
+
     /** Payload Size.*/
     size_t payloadSize;
 
@@ -143,6 +171,20 @@ typedef struct OCServerResponse {
  */
 OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse);
 
+/**
+ * Like HandleSingleResponse(), but sends a payload that is already encoded
+ * in CBOR instead of ehResponse->payload.
+ *
+ * @param ehResponse   Pointer to the response from the resource.
+ * @param payload      Encoded payload. It is copied, the caller keeps ownership.
+ * @param payloadSize  Size of the encoded payload.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult HandleSingleEncodedResponse(OCEntityHandlerResponse * ehResponse,
+                                          const uint8_t *payload, size_t payloadSize);
+
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
@@ -222,6 +264,23 @@ OCStackResult AddServerRequest (OCServerRequest ** request, uint16_t coapID,
         OCPayloadFormat acceptFormat,
         const OCDevAddr *devAddr);
 
+/**
+ * Attach an observer to a notification server request. The response to the request is
+ * encoded once and sent to the observer as well.
+ *
+ * @param request           Notification server request.
+ * @param token             Token of the observe request.
+ * @param tokenLength       Length of token.
+ * @param qos               Quality of service of the notification.
+ * @param devAddr           Device Address.
+ *
+ * @return
+ *     ::OCStackResult
+ */
+OCStackResult AddNotificationReceiver(OCServerRequest *request,
+        const CAToken_t token, uint8_t tokenLength,
+        OCQualityOfService qos, const OCDevAddr *devAddr);
+
 /**
  * Form the OCEntityHandlerRequest struct that is passed to a resource's entity handler
  *
@@ -228,6 +228,20 @@ bool OCRepPayloadGetPropObjectArray(const OCRepPayload* payload, const char* nam
 
 void OCRepPayloadDestroy(OCRepPayload* payload);
 
+/**
+ * Enable or disable arena parsing of received representation payloads.
+ *
+ * When enabled, the representation the stack hands to an entity handler or a
+ * response callback is parsed into a single arena that is released at once when
+ * the stack destroys the payload after the call. Such a payload is read only:
+ * the setters fail on it and OCRepPayloadDestroy() on any of its nested objects
+ * does nothing. Use OCRepPayloadClone() to keep or modify a part of it.
+ * Disabled by default.
+ *
+ * @param enable    true to parse received representations into an arena.
+ */
+void OCRepPayloadSetArenaParsing(bool enable);
+
 // Discovery Payload
 OCDiscoveryPayload* OCDiscoveryPayloadCreate();
 
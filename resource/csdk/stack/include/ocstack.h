@@ -114,6 +114,28 @@ OCStackResult OCStopMulticastServer();
  */
 OCStackResult OCProcess();
 
+/**
+ * This function blocks until OCProcess() has work to do: a message was received,
+ * a timer of the stack is due, or OCWakeUpProcess() was called. It lets a main
+ * loop sleep instead of polling OCProcess().
+ *
+ * @note: Call it from the thread that runs the OCProcess() loop, and do not hold
+ * a lock that other callers of the stack need while it waits.
+ *
+ * @param timeoutMs   Maximum time to wait in milliseconds, 0 to not wait.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCWaitForProcess(uint32_t timeoutMs);
+
+/**
+ * This function makes a pending or the next call of OCWaitForProcess() return,
+ * e.g. to stop the thread that runs OCProcess().
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCWakeUpProcess();
+
 /**
  * This function discovers or Perform requests on a specified resource
  * (specified by that Resource's respective URI).
@@ -183,6 +205,22 @@ OCStackResult OCCancel(OCDoHandle handle,
  */
 OCStackResult OCRegisterPersistentStorageHandler(OCPersistentStorage* persistentStorageHandler);
 
+/**
+ * Keep the Secure Virtual Resources in a journal, so that an update only writes the
+ * resource that changed instead of the whole SVR database file.
+ *
+ * The journal files are opened through the persistent storage handler by their own
+ * names, so its open handler must use the path it is given. The SVR database file is
+ * only read while no journal exists yet; once enabled, the journal should stay enabled.
+ * Call this after OCRegisterPersistentStorageHandler() and before OCInit().
+ *
+ * @param   enable  true to use the journal, false to use the SVR database file.
+ *
+ * @return
+ *     OC_STACK_OK                    No errors; Success.
+ */
+OCStackResult OCEnablePersistentStorageJournal(bool enable);
+
 #ifdef WITH_PRESENCE
 /**
  * When operating in  OCServer or  OCClientServer mode,
@@ -372,6 +410,19 @@ OCResourceHandle OCGetResourceHandle(uint8_t index);
  */
 OCStackResult OCDeleteResource(OCResourceHandle handle);
 
+/**
+ * This function returns the counters of the discovery response cache. Requests for
+ * /oic/res with the same query from the same kind of endpoint are answered with the
+ * response encoded for the first of them, until a resource is created, deleted or
+ * changed.
+ *
+ * @param hits            Number of requests answered from the cache.
+ * @param misses          Number of requests for which the response was built.
+ *
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+OCStackResult OCGetDiscoveryCacheCounters(uint32_t *hits, uint32_t *misses);
+
 /**
  * Get a string representation the server instance ID.
  * The memory is managed internal to this function, so freeing externally will result
@@ -650,6 +701,17 @@ OCStackResult OCGetDeviceId(OCUUIdentity *deviceId);
  * @return Returns ::OC_STACK_OK if success.
  */
 OCStackResult OCSetDeviceId(const OCUUIdentity *deviceId);
+
+/**
+ * Sets the size and lifetime of the cache of TLS sessions that reconnecting
+ * peers may resume without a full handshake. May be called before ::OCInit.
+ *
+ * @param maxEntries Number of sessions kept, 0 disables resumption.
+ * @param lifetime Seconds a session may be resumed after its full handshake.
+ * @return Returns ::OC_STACK_OK if success, ::OC_STACK_NOTIMPL without TLS support.
+ */
+OCStackResult OCSetTlsSessionCacheConfig(uint32_t maxEntries, uint32_t lifetime);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
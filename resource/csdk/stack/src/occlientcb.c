@@ -34,6 +34,7 @@
 
 #include "cacommon.h"
 #include "cainterface.h"
+#include "uhashmap.h"
 
 /// Module Name
 #define TAG "OIC_RI_CLIENTCB"
@@ -41,6 +42,154 @@
 struct ClientCB *cbList = NULL;
 static OCMulticastNode * mcPresenceNodes = NULL;
 
+/*
+ * Responses are dispatched through the indexes instead of walking cbList.
+ * Nodes with a TTL are also kept in cbExpiryList ordered by TTL, so timed-out
+ * nodes are deleted from its head. Since the TTL is mostly set to now plus a
+ * fixed timeout, a node is usually appended at the tail.
+ */
+
+/** cbList nodes indexed by token and token length. */
+static u_hashmap_t *cbTokenIndex = NULL;
+
+/** cbList nodes indexed by handle address. */
+static u_hashmap_t *cbHandleIndex = NULL;
+
+/** cbList nodes indexed by their own address, to verify a node is still alive. */
+static u_hashmap_t *cbNodeIndex = NULL;
+
+/** cbList nodes with a TTL, ordered by TTL. */
+static ClientCB *cbExpiryList = NULL;
+static ClientCB *cbExpiryTail = NULL;
+
+static uint32_t HashClientCBToken(const void *key)
+{
+    const ClientCB *cbNode = (const ClientCB *) key;
+    return u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, cbNode->token, cbNode->tokenLength);
+}
+
+static bool EqualClientCBToken(const void *key1, const void *key2)
+{
+    const ClientCB *cbNode1 = (const ClientCB *) key1;
+    const ClientCB *cbNode2 = (const ClientCB *) key2;
+    return cbNode1->tokenLength == cbNode2->tokenLength &&
+           0 == memcmp(cbNode1->token, cbNode2->token, cbNode1->tokenLength);
+}
+
+static bool CreateClientCBIndexes()
+{
+    if (!cbTokenIndex)
+    {
+        cbTokenIndex = u_hashmap_create(HashClientCBToken, EqualClientCBToken);
+    }
+    if (!cbHandleIndex)
+    {
+        cbHandleIndex = u_hashmap_create(u_hashmap_hash_pointer, u_hashmap_equal_pointer);
+    }
+    if (!cbNodeIndex)
+    {
+        cbNodeIndex = u_hashmap_create(u_hashmap_hash_pointer, u_hashmap_equal_pointer);
+    }
+    return cbTokenIndex && cbHandleIndex && cbNodeIndex;
+}
+
+static void RemoveFromExpiryList(ClientCB *cbNode)
+{
+    if (0 == cbNode->TTL)
+    {
+        return;
+    }
+
+    if (cbNode->expiryPrev)
+    {
+        cbNode->expiryPrev->expiryNext = cbNode->expiryNext;
+    }
+    else
+    {
+        cbExpiryList = cbNode->expiryNext;
+    }
+
+    if (cbNode->expiryNext)
+    {
+        cbNode->expiryNext->expiryPrev = cbNode->expiryPrev;
+    }
+    else
+    {
+        cbExpiryTail = cbNode->expiryPrev;
+    }
+
+    cbNode->expiryPrev = NULL;
+    cbNode->expiryNext = NULL;
+}
+
+static void InsertIntoExpiryList(ClientCB *cbNode)
+{
+    cbNode->expiryPrev = NULL;
+    cbNode->expiryNext = NULL;
+    if (0 == cbNode->TTL)
+    {
+        return;
+    }
+
+    // Search from the tail, where a new TTL usually belongs.
+    ClientCB *prev = cbExpiryTail;
+    while (prev && prev->TTL > cbNode->TTL)
+    {
+        prev = prev->expiryPrev;
+    }
+
+    cbNode->expiryPrev = prev;
+    cbNode->expiryNext = prev ? prev->expiryNext : cbExpiryList;
+    if (cbNode->expiryNext)
+    {
+        cbNode->expiryNext->expiryPrev = cbNode;
+    }
+    else
+    {
+        cbExpiryTail = cbNode;
+    }
+    if (prev)
+    {
+        prev->expiryNext = cbNode;
+    }
+    else
+    {
+        cbExpiryList = cbNode;
+        // OCWaitForProcess may be sleeping until a later deadline.
+        CAWakeUpRequestResponse();
+    }
+}
+
+static void RemoveFromIndexes(ClientCB *cbNode)
+{
+    // Tokens are random, but never let a duplicate unindex another node.
+    if (cbNode->tokenLength && u_hashmap_get(cbTokenIndex, cbNode) == cbNode)
+    {
+        u_hashmap_remove(cbTokenIndex, cbNode);
+    }
+    u_hashmap_remove(cbHandleIndex, cbNode->handle);
+    u_hashmap_remove(cbNodeIndex, cbNode);
+}
+
+static bool AddToIndexes(ClientCB *cbNode)
+{
+    if (!CreateClientCBIndexes())
+    {
+        return false;
+    }
+
+    if ((cbNode->tokenLength && !u_hashmap_put(cbTokenIndex, cbNode, cbNode)) ||
+        !u_hashmap_put(cbHandleIndex, cbNode->handle, cbNode) ||
+        !u_hashmap_put(cbNodeIndex, cbNode, cbNode))
+    {
+        RemoveFromIndexes(cbNode);
+        return false;
+    }
+
+    InsertIntoExpiryList(cbNode);
+    return true;
+}
+
 OCStackResult
 AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
              CAToken_t token, uint8_t tokenLength,
@@ -101,8 +250,15 @@ AddClientCB (ClientCB** clientCB, OCCallbackData* cbData,
             }
             cbNode->requestUri = requestUri;    // I own it now
             cbNode->devAddr = devAddr;          // I own it now
+            if (!AddToIndexes(cbNode))
+            {
+                // The caller still owns the token, handle, uri and address.
+                OICFree(cbNode);
+                *clientCB = NULL;
+                goto exit;
+            }
             OIC_LOG_V(INFO, TAG, "Added Callback for uri : %s", requestUri);
-            LL_APPEND(cbList, cbNode);
+            DL_APPEND(cbList, cbNode);
             *clientCB = cbNode;
         }
     }
@@ -149,7 +305,9 @@ void DeleteClientCB(ClientCB * cbNode)
 {
     if (cbNode)
     {
-        LL_DELETE(cbList, cbNode);
+        RemoveFromIndexes(cbNode);
+        RemoveFromExpiryList(cbNode);
+        DL_DELETE(cbList, cbNode);
         OIC_LOG (INFO, TAG, "Deleting token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)cbNode->token, cbNode->tokenLength);
         CADestroyToken (cbNode->token);
@@ -189,30 +347,36 @@ void DeleteClientCB(ClientCB * cbNode)
     }
 }
 
-/*
- * This function checks if the node is past its time to live and
- * deletes it if timed-out. Calling this function with a  presence or observe
- * callback with ttl set to 0 will not delete anything as presence nodes have
- * their own mechanisms for timeouts. A null argument will cause the function to
- * silently return.
- */
-static void CheckAndDeleteTimedOutCB(ClientCB* cbNode)
+void SetClientCBTTL(ClientCB *cbNode, uint32_t ttl)
 {
-    if (!cbNode)
+    if (!cbNode || cbNode->TTL == ttl)
     {
         return;
     }
-    if (cbNode->TTL == 0)
+    RemoveFromExpiryList(cbNode);
+    cbNode->TTL = ttl;
+    InsertIntoExpiryList(cbNode);
+}
+
+uint32_t GetNextClientCBTTL()
+{
+    return cbExpiryList ? cbExpiryList->TTL : 0;
+}
+
+void DeleteTimedOutClientCBs()
+{
+    if (!cbExpiryList)
     {
         return;
     }
+
     coap_tick_t now;
     coap_ticks(&now);
 
-    if (cbNode->TTL < now)
+    while (cbExpiryList && cbExpiryList->TTL < now)
     {
         OIC_LOG(INFO, TAG, "Deleting timed-out callback");
-        DeleteClientCB(cbNode);
+        DeleteClientCB(cbExpiryList);
     }
 }
 
@@ -225,30 +389,13 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
     {
         OIC_LOG (INFO, TAG,  "Looking for token");
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)token, tokenLength);
-        LL_FOREACH(cbList, out)
-        {
-            /* de-annotate below line if want to see all token in cbList */
-            //OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)out->token, tokenLength);
-            if (memcmp(out->token, token, tokenLength) == 0)
-            {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        ClientCB key = { .token = token, .tokenLength = tokenLength };
+        out = (ClientCB *) u_hashmap_get(cbTokenIndex, &key);
     }
     else if (handle)
     {
         OIC_LOG (INFO, TAG,  "Looking for handle");
-        LL_FOREACH(cbList, out)
-        {
-            if (out->handle == handle)
-            {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
-            }
-            CheckAndDeleteTimedOutCB(out);
-        }
+        out = (ClientCB *) u_hashmap_get(cbHandleIndex, handle);
     }
     else if (requestUri)
     {
@@ -259,12 +406,16 @@ ClientCB* GetClientCB(const CAToken_t token, uint8_t tokenLength,
             //OIC_LOG_V(INFO, TAG, "%s", out->requestUri);
             if (out->requestUri && strcmp(out->requestUri, requestUri ) == 0)
             {
-                OIC_LOG(INFO, TAG, "Found in callback list");
-                return out;
+                break;
             }
-            CheckAndDeleteTimedOutCB(out);
         }
     }
+
+    if (out)
+    {
+        OIC_LOG(INFO, TAG, "Found in callback list");
+        return out;
+    }
     OIC_LOG(INFO, TAG, "Callback Not found !!");
     return NULL;
 }
@@ -301,21 +452,20 @@ void DeleteClientCBList()
         DeleteClientCB(out);
     }
     cbList = NULL;
+    cbExpiryList = NULL;
+    cbExpiryTail = NULL;
+
+    u_hashmap_free(&cbTokenIndex);
+    u_hashmap_free(&cbHandleIndex);
+    u_hashmap_free(&cbNodeIndex);
 }
 
 void FindAndDeleteClientCB(ClientCB * cbNode)
 {
-    ClientCB* tmp;
-    if (cbNode)
+    // cbNode may already be deleted, so it is only looked up by address.
+    if (cbNode && u_hashmap_get(cbNodeIndex, cbNode))
     {
-        LL_FOREACH(cbList, tmp)
-        {
-            if (cbNode == tmp)
-            {
-                DeleteClientCB(tmp);
-                break;
-            }
-        }
+        DeleteClientCB(cbNode);
     }
 }
 
@@ -30,6 +30,8 @@
 #include "ocpayload.h"
 #include "ocserverrequest.h"
 #include "logger.h"
+#include "uarraylist.h"
+#include "uhashmap.h"
 
 #include <coap/utlist.h>
 #include <coap/pdu.h>
@@ -43,6 +45,65 @@
 #define VERIFY_NON_NULL(arg) { if (!arg) {OIC_LOG(FATAL, TAG, #arg " is NULL"); goto exit;} }
 
 static struct ResourceObserver * g_serverObsList = NULL;
+
+/**
+ * Observers of each resource, chained through nextInResource.
+ * Maps the resource address to its first observer.
+ */
+static u_hashmap_t * g_resourceObsIndex = NULL;
+
+static ResourceObserver* GetResourceObservers(const OCResource *resource)
+{
+    return (ResourceObserver *) u_hashmap_get(g_resourceObsIndex, resource);
+}
+
+static OCStackResult AddToResourceObservers(ResourceObserver *obsNode)
+{
+    if (!g_resourceObsIndex)
+    {
+        g_resourceObsIndex = u_hashmap_create(u_hashmap_hash_pointer, u_hashmap_equal_pointer);
+        if (!g_resourceObsIndex)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+
+    obsNode->nextInResource = GetResourceObservers(obsNode->resource);
+    if (!u_hashmap_put(g_resourceObsIndex, obsNode->resource, obsNode))
+    {
+        obsNode->nextInResource = NULL;
+        return OC_STACK_NO_MEMORY;
+    }
+    return OC_STACK_OK;
+}
+
+static void RemoveFromResourceObservers(ResourceObserver *obsNode)
+{
+    ResourceObserver *head = GetResourceObservers(obsNode->resource);
+    if (head == obsNode)
+    {
+        if (obsNode->nextInResource)
+        {
+            // Replacing the value of an existing key does not allocate.
+            u_hashmap_put(g_resourceObsIndex, obsNode->resource, obsNode->nextInResource);
+        }
+        else
+        {
+            u_hashmap_remove(g_resourceObsIndex, obsNode->resource);
+        }
+        return;
+    }
+
+    for (ResourceObserver *prev = head; prev; prev = prev->nextInResource)
+    {
+        if (prev->nextInResource == obsNode)
+        {
+            prev->nextInResource = obsNode->nextInResource;
+            return;
+        }
+    }
+}
+
 /**
  * Determine observe QOS based on the QOS of the request.
  * The qos passed as a parameter overrides what the client requested.
@@ -96,6 +157,62 @@ static OCQualityOfService DetermineObserverQoS(OCMethod method,
     return decidedQoS;
 }
 
+/**
+ * Add an observer to the notification request of its (accept format, query) group.
+ * The first observer of a group creates the request that the entity handler is
+ * called with, the others are sent the same encoded response.
+ *
+ * @param groups Notification requests of the groups, created on first use.
+ * @param resPtr Observed resource.
+ * @param resourceObserver Observer.
+ * @param qos Quality of service of the notification to the observer.
+ * @return ::OC_STACK_OK on success, some other value upon failure.
+ */
+static OCStackResult AddObserverToGroup(u_arraylist_t **groups, OCResource *resPtr,
+        ResourceObserver *resourceObserver, OCQualityOfService qos)
+{
+    const char *query = resourceObserver->query ? resourceObserver->query : "";
+    OCServerRequest *request = NULL;
+
+    uint32_t len = *groups ? u_arraylist_length(*groups) : 0;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        request = (OCServerRequest *) u_arraylist_get(*groups, i);
+        if (request->acceptFormat == resourceObserver->acceptFormat &&
+            strcmp(request->query, query) == 0)
+        {
+            return AddNotificationReceiver(request, resourceObserver->token,
+                    resourceObserver->tokenLength, qos, &resourceObserver->devAddr);
+        }
+    }
+
+    if (!*groups)
+    {
+        *groups = u_arraylist_create();
+        if (!*groups)
+        {
+            return OC_STACK_NO_MEMORY;
+        }
+    }
+
+    OCStackResult result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+            0, resPtr->sequenceNum, qos, resourceObserver->query,
+            NULL, NULL,
+            resourceObserver->token, resourceObserver->tokenLength,
+            resourceObserver->resUri, 0, resourceObserver->acceptFormat,
+            &resourceObserver->devAddr);
+    if (request)
+    {
+        request->observeResult = OC_STACK_OK;
+        if (result == OC_STACK_OK && !u_arraylist_add(*groups, request))
+        {
+            FindAndDeleteServerRequest(request);
+            result = OC_STACK_NO_MEMORY;
+        }
+    }
+    return result;
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr, uint32_t maxAge,
         OCPresenceTrigger trigger, OCResourceType *resourceType, OCQualityOfService qos)
@@ -111,115 +228,114 @@ OCStackResult SendAllObserverNotification (OCMethod method, OCResource *resPtr,
     }
 
     OCStackResult result = OC_STACK_ERROR;
-    ResourceObserver * resourceObserver = g_serverObsList;
-    uint8_t numObs = 0;
+    ResourceObserver * resourceObserver = GetResourceObservers(resPtr);
+    uint32_t numObs = 0;
     OCServerRequest * request = NULL;
     OCEntityHandlerRequest ehRequest = {0};
     OCEntityHandlerResult ehResult = OC_EH_ERROR;
     bool observeErrorFlag = false;
+    u_arraylist_t *groups = NULL;
 
-    // Find clients that are observing this resource
+    // Group the clients that are observing this resource
     while (resourceObserver)
     {
-        if (resourceObserver->resource == resPtr)
+        numObs++;
+#ifdef WITH_PRESENCE
+        if (method != OC_REST_PRESENCE)
         {
-            numObs++;
+#endif
+            OCQualityOfService obsQos = DetermineObserverQoS(method, resourceObserver, qos);
+            result = AddObserverToGroup(&groups, resPtr, resourceObserver, obsQos);
 #ifdef WITH_PRESENCE
-            if (method != OC_REST_PRESENCE)
+        }
+        else
+        {
+            OCEntityHandlerResponse ehResponse = {0};
+
+            //This is effectively the implementation for the presence entity handler.
+            OIC_LOG(DEBUG, TAG, "This notification is for Presence");
+            result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
+                    0, resPtr->sequenceNum, qos, resourceObserver->query,
+                    NULL, NULL,
+                    resourceObserver->token, resourceObserver->tokenLength,
+                    resourceObserver->resUri, 0, resourceObserver->acceptFormat,
+                    &resourceObserver->devAddr);
+
+            if (result == OC_STACK_OK)
             {
-#endif
-                qos = DetermineObserverQoS(method, resourceObserver, qos);
-
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resPtr->sequenceNum, qos, resourceObserver->query,
-                        NULL, NULL,
-                        resourceObserver->token, resourceObserver->tokenLength,
-                        resourceObserver->resUri, 0, resourceObserver->acceptFormat,
-                        &resourceObserver->devAddr);
+                OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
+                        resPtr->sequenceNum, maxAge, trigger,
+                        resourceType ? resourceType->resourcetypename : NULL);
 
-                if (request)
+                if (!presenceResBuf)
                 {
-                    request->observeResult = OC_STACK_OK;
-                    if (result == OC_STACK_OK)
-                    {
-                        result = FormOCEntityHandlerRequest(
-                                    &ehRequest,
-                                    (OCRequestHandle) request,
-                                    request->method,
-                                    &request->devAddr,
-                                    (OCResourceHandle) resPtr,
-                                    request->query,
-                                    PAYLOAD_TYPE_REPRESENTATION,
-                                    request->payload,
-                                    request->payloadSize,
-                                    request->numRcvdVendorSpecificHeaderOptions,
-                                    request->rcvdVendorSpecificHeaderOptions,
-                                    OC_OBSERVE_NO_OPTION,
-                                    0,
-                                    request->coapID);
-                        if (result == OC_STACK_OK)
-                        {
-                            ehResult = resPtr->entityHandler(OC_REQUEST_FLAG, &ehRequest,
-                                                resPtr->entityHandlerCallbackParam);
-                            if (ehResult == OC_EH_ERROR)
-                            {
-                                FindAndDeleteServerRequest(request);
-                            }
-                        }
-                        OCPayloadDestroy(ehRequest.payload);
-                    }
+                    return OC_STACK_NO_MEMORY;
                 }
-#ifdef WITH_PRESENCE
-            }
-            else
-            {
-                OCEntityHandlerResponse ehResponse = {0};
-
-                //This is effectively the implementation for the presence entity handler.
-                OIC_LOG(DEBUG, TAG, "This notification is for Presence");
-                result = AddServerRequest(&request, 0, 0, 1, OC_REST_GET,
-                        0, resPtr->sequenceNum, qos, resourceObserver->query,
-                        NULL, NULL,
-                        resourceObserver->token, resourceObserver->tokenLength,
-                        resourceObserver->resUri, 0, resourceObserver->acceptFormat,
-                        &resourceObserver->devAddr);
 
                 if (result == OC_STACK_OK)
                 {
-                    OCPresencePayload* presenceResBuf = OCPresencePayloadCreate(
-                            resPtr->sequenceNum, maxAge, trigger,
-                            resourceType ? resourceType->resourcetypename : NULL);
-
-                    if (!presenceResBuf)
-                    {
-                        return OC_STACK_NO_MEMORY;
-                    }
-
-                    if (result == OC_STACK_OK)
-                    {
-                        ehResponse.ehResult = OC_EH_OK;
-                        ehResponse.payload = (OCPayload*)presenceResBuf;
-                        ehResponse.persistentBufferFlag = 0;
-                        ehResponse.requestHandle = (OCRequestHandle) request;
-                        ehResponse.resourceHandle = (OCResourceHandle) resPtr;
-                        OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
-                                resourceObserver->resUri);
-                        result = OCDoResponse(&ehResponse);
-                    }
-
-                    OCPresencePayloadDestroy(presenceResBuf);
+                    ehResponse.ehResult = OC_EH_OK;
+                    ehResponse.payload = (OCPayload*)presenceResBuf;
+                    ehResponse.persistentBufferFlag = 0;
+                    ehResponse.requestHandle = (OCRequestHandle) request;
+                    ehResponse.resourceHandle = (OCResourceHandle) resPtr;
+                    OICStrcpy(ehResponse.resourceUri, sizeof(ehResponse.resourceUri),
+                            resourceObserver->resUri);
+                    result = OCDoResponse(&ehResponse);
                 }
+
+                OCPresencePayloadDestroy(presenceResBuf);
             }
+        }
 #endif
 
-            // Since we are in a loop, set an error flag to indicate at least one error occurred.
-            if (result != OC_STACK_OK)
+        // Since we are in a loop, set an error flag to indicate at least one error occurred.
+        if (result != OC_STACK_OK)
+        {
+            observeErrorFlag = true;
+        }
+        resourceObserver = resourceObserver->nextInResource;
+    }
+
+    // The entity handler is called once per group, its response goes to every
+    // observer of the group.
+    uint32_t numGroups = groups ? u_arraylist_length(groups) : 0;
+    for (uint32_t i = 0; i < numGroups; i++)
+    {
+        request = (OCServerRequest *) u_arraylist_get(groups, i);
+        result = FormOCEntityHandlerRequest(
+                    &ehRequest,
+                    (OCRequestHandle) request,
+                    request->method,
+                    &request->devAddr,
+                    (OCResourceHandle) resPtr,
+                    request->query,
+                    PAYLOAD_TYPE_REPRESENTATION,
+                    request->payload,
+                    request->payloadSize,
+                    request->numRcvdVendorSpecificHeaderOptions,
+                    request->rcvdVendorSpecificHeaderOptions,
+                    OC_OBSERVE_NO_OPTION,
+                    0,
+                    request->coapID);
+        if (result == OC_STACK_OK)
+        {
+            ehResult = resPtr->entityHandler(OC_REQUEST_FLAG, &ehRequest,
+                                resPtr->entityHandlerCallbackParam);
+            if (ehResult == OC_EH_ERROR)
             {
-                observeErrorFlag = true;
+                FindAndDeleteServerRequest(request);
             }
         }
-        resourceObserver = resourceObserver->next;
+        else
+        {
+            FindAndDeleteServerRequest(request);
+            observeErrorFlag = true;
+        }
+        OCPayloadDestroy(ehRequest.payload);
+        ehRequest.payload = NULL;
     }
+    u_arraylist_free(&groups);
 
     if (numObs == 0)
     {
@@ -410,6 +526,10 @@ OCStackResult AddObserver (const char         *resUri,
         obsNode->devAddr = *devAddr;
         obsNode->resource = resHandle;
 
+        if (OC_STACK_OK != AddToResourceObservers(obsNode))
+        {
+            goto exit;
+        }
         LL_APPEND (g_serverObsList, obsNode);
 
         return OC_STACK_OK;
@@ -420,6 +540,7 @@ exit:
     {
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
+        OICFree(obsNode->token);
         OICFree(obsNode);
     }
     return OC_STACK_NO_MEMORY;
@@ -484,6 +605,7 @@ OCStackResult DeleteObserverUsingToken (CAToken_t token, uint8_t tokenLength)
         OIC_LOG_V(INFO, TAG, "deleting observer id  %u with token", obsNode->observeId);
         OIC_LOG_BUFFER(INFO, TAG, (const uint8_t *)obsNode->token, tokenLength);
         LL_DELETE (g_serverObsList, obsNode);
+        RemoveFromResourceObservers(obsNode);
         OICFree(obsNode->resUri);
         OICFree(obsNode->query);
         OICFree(obsNode->token);
@@ -505,6 +627,7 @@ void DeleteObserverList()
         }
     }
     g_serverObsList = NULL;
+    u_hashmap_free(&g_resourceObsIndex);
 }
 
 /*
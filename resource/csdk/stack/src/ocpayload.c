@@ -30,6 +30,7 @@
 #include "oic_string.h"
 #include "ocstackinternal.h"
 #include "ocresource.h"
+#include "ocpayloadarena.h"
 #include "logger.h"
 
 #define TAG "OIC_RI_PAYLOAD"
@@ -90,6 +91,11 @@ void OCRepPayloadAppend(OCRepPayload* parent, OCRepPayload* child)
     {
         return;
     }
+    if (OCPayloadArenaFind(parent))
+    {
+        OIC_LOG(ERROR, TAG, "Cannot append to a payload parsed into an arena");
+        return;
+    }
 
     while(parent->next)
     {
@@ -343,6 +349,11 @@ static OCRepPayloadValue* OCRepPayloadFindAndSetValue(OCRepPayload* payload, con
     {
         return NULL;
     }
+    if (OCPayloadArenaFind(payload))
+    {
+        OIC_LOG(ERROR, TAG, "Payload parsed into an arena is read only");
+        return NULL;
+    }
 
     OCRepPayloadValue* val = payload->values;
     if (val == NULL)
@@ -403,7 +414,7 @@ bool OCRepPayloadAddResourceType(OCRepPayload* payload, const char* resourceType
 
 bool OCRepPayloadAddResourceTypeAsOwner(OCRepPayload* payload, char* resourceType)
 {
-    if (!payload || !resourceType)
+    if (!payload || !resourceType || OCPayloadArenaFind(payload))
     {
         return false;
     }
@@ -444,7 +455,7 @@ bool OCRepPayloadAddInterface(OCRepPayload* payload, const char* iface)
 
 bool OCRepPayloadAddInterfaceAsOwner(OCRepPayload* payload, char* iface)
 {
-    if (!payload || !iface)
+    if (!payload || !iface || OCPayloadArenaFind(payload))
     {
         return false;
     }
@@ -479,7 +490,7 @@ bool OCRepPayloadAddInterfaceAsOwner(OCRepPayload* payload, char* iface)
 
 bool OCRepPayloadSetUri(OCRepPayload* payload, const char*  uri)
 {
-    if (!payload)
+    if (!payload || OCPayloadArenaFind(payload))
     {
         return false;
     }
@@ -1593,6 +1604,17 @@ void OCRepPayloadDestroy(OCRepPayload* payload)
         return;
     }
 
+    OCPayloadArena *arena = OCPayloadArenaFind(payload);
+    if (arena)
+    {
+        // The whole tree goes with the arena, nested nodes are not freed alone.
+        if (arena->owner == payload)
+        {
+            OCPayloadArenaDestroy(arena);
+        }
+        return;
+    }
+
     OICFree(payload->uri);
     OCFreeOCStringLL(payload->types);
     OCFreeOCStringLL(payload->interfaces);
@@ -0,0 +1,279 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <stdint.h>
+#include "ocpayloadarena.h"
+#include "oic_malloc.h"
+#include "octhread.h"
+#include "uhashmap.h"
+#include "logger.h"
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+#define TAG "OIC_RI_PAYLOADARENA"
+
+/**
+ * Smallest block the arena allocates.
+ */
+#define MIN_ARENA_CHUNK_SIZE 256
+
+/**
+ * Every allocation is aligned for the widest member of a payload.
+ */
+typedef union
+{
+    int64_t i;
+    double d;
+    void *p;
+} OCPayloadArenaAlign;
+
+#define ARENA_ALIGN(size) \
+    (((size) + sizeof(OCPayloadArenaAlign) - 1) & ~(sizeof(OCPayloadArenaAlign) - 1))
+
+struct OCPayloadArenaChunk
+{
+    OCPayloadArenaChunk *next;
+    size_t size;
+    size_t used;
+    OCPayloadArenaAlign data[];
+};
+
+struct OCPayloadArenaNode
+{
+    const void *ptr;
+    OCPayloadArenaNode *next;
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ATOMIC_LOAD_ACQUIRE(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_RELEASE(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+#define ATOMIC_LOAD_ACQUIRE(p)      ((uint32_t) InterlockedOr((volatile LONG *)(p), 0))
+#define ATOMIC_STORE_RELEASE(p, v)  InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#else
+#define ATOMIC_LOAD_ACQUIRE(p)      (*(volatile uint32_t *)(p))
+#define ATOMIC_STORE_RELEASE(p, v)  (*(volatile uint32_t *)(p) = (v))
+#endif
+
+/**
+ * Payloads allocated from a live arena, mapped to their arena.
+ */
+static u_hashmap_t *g_arenaPayloads = NULL;
+
+/**
+ * Number of entries in g_arenaPayloads. It is written under the mutex and read
+ * without it, so payloads not parsed into an arena never take the lock while no
+ * arena payload is alive.
+ */
+static uint32_t g_arenaPayloadCount = 0;
+
+/**
+ * Mutex guarding g_arenaPayloads.
+ */
+static oc_mutex g_arenaPayloadsMutex = NULL;
+
+bool OCPayloadArenaInitialize(void)
+{
+    if (!g_arenaPayloadsMutex)
+    {
+        g_arenaPayloadsMutex = oc_mutex_new();
+        if (!g_arenaPayloadsMutex)
+        {
+            return false;
+        }
+    }
+
+    oc_mutex_lock(g_arenaPayloadsMutex);
+    if (!g_arenaPayloads)
+    {
+        g_arenaPayloads = u_hashmap_create(u_hashmap_hash_pointer, u_hashmap_equal_pointer);
+    }
+    bool result = (NULL != g_arenaPayloads);
+    oc_mutex_unlock(g_arenaPayloadsMutex);
+    return result;
+}
+
+void OCPayloadArenaTerminate(void)
+{
+    if (!g_arenaPayloadsMutex)
+    {
+        return;
+    }
+
+    oc_mutex_lock(g_arenaPayloadsMutex);
+    bool inUse = (0 != g_arenaPayloadCount);
+    if (!inUse)
+    {
+        u_hashmap_free(&g_arenaPayloads);
+    }
+    oc_mutex_unlock(g_arenaPayloadsMutex);
+
+    if (inUse)
+    {
+        OIC_LOG(WARNING, TAG, "Arena payloads are still alive, keeping their index");
+        return;
+    }
+    oc_mutex_free(g_arenaPayloadsMutex);
+    g_arenaPayloadsMutex = NULL;
+}
+
+static OCPayloadArenaChunk *OCPayloadArenaAddChunk(OCPayloadArenaChunk *next, size_t size)
+{
+    // Calloc so the memory handed out is already zeroed.
+    OCPayloadArenaChunk *chunk =
+            (OCPayloadArenaChunk *) OICCalloc(1, sizeof(OCPayloadArenaChunk) + size);
+    if (!chunk)
+    {
+        OIC_LOG(ERROR, TAG, "Failed allocating arena chunk");
+        return NULL;
+    }
+    chunk->next = next;
+    chunk->size = size;
+    return chunk;
+}
+
+OCPayloadArena *OCPayloadArenaCreate(size_t sizeHint)
+{
+    if (!g_arenaPayloadsMutex)
+    {
+        OIC_LOG(ERROR, TAG, "Payload arenas are not initialized");
+        return NULL;
+    }
+
+    size_t size = ARENA_ALIGN(sizeHint + sizeof(OCPayloadArena));
+    if (size < MIN_ARENA_CHUNK_SIZE)
+    {
+        size = MIN_ARENA_CHUNK_SIZE;
+    }
+
+    OCPayloadArenaChunk *chunk = OCPayloadArenaAddChunk(NULL, size);
+    if (!chunk)
+    {
+        return NULL;
+    }
+
+    // The arena itself lives at the start of its first chunk.
+    OCPayloadArena *arena = (OCPayloadArena *) chunk->data;
+    chunk->used = ARENA_ALIGN(sizeof(OCPayloadArena));
+    arena->chunks = chunk;
+    arena->chunkSize = size;
+    return arena;
+}
+
+void *OCPayloadArenaAlloc(OCPayloadArena *arena, size_t size)
+{
+    if (!arena)
+    {
+        return NULL;
+    }
+
+    size = ARENA_ALIGN(size ? size : 1);
+
+    OCPayloadArenaChunk *chunk = arena->chunks;
+    if (chunk->size - chunk->used < size)
+    {
+        size_t chunkSize = size > arena->chunkSize ? size : arena->chunkSize;
+        chunk = OCPayloadArenaAddChunk(arena->chunks, chunkSize);
+        if (!chunk)
+        {
+            return NULL;
+        }
+        arena->chunks = chunk;
+    }
+
+    void *mem = (uint8_t *) chunk->data + chunk->used;
+    chunk->used += size;
+    return mem;
+}
+
+void OCPayloadArenaDestroy(OCPayloadArena *arena)
+{
+    if (!arena)
+    {
+        return;
+    }
+
+    if (arena->registered)
+    {
+        oc_mutex_lock(g_arenaPayloadsMutex);
+        uint32_t count = g_arenaPayloadCount;
+        for (OCPayloadArenaNode *node = arena->registered; node; node = node->next)
+        {
+            if (u_hashmap_remove(g_arenaPayloads, node->ptr))
+            {
+                count--;
+            }
+        }
+        ATOMIC_STORE_RELEASE(&g_arenaPayloadCount, count);
+        oc_mutex_unlock(g_arenaPayloadsMutex);
+    }
+
+    // The first chunk holds the arena, so read the list head before freeing.
+    OCPayloadArenaChunk *chunk = arena->chunks;
+    while (chunk)
+    {
+        OCPayloadArenaChunk *next = chunk->next;
+        OICFree(chunk);
+        chunk = next;
+    }
+}
+
+bool OCPayloadArenaRegister(OCPayloadArena *arena, const void *ptr)
+{
+    if (!arena || !ptr)
+    {
+        return false;
+    }
+
+    OCPayloadArenaNode *node =
+            (OCPayloadArenaNode *) OCPayloadArenaAlloc(arena, sizeof(OCPayloadArenaNode));
+    if (!node)
+    {
+        return false;
+    }
+    node->ptr = ptr;
+
+    oc_mutex_lock(g_arenaPayloadsMutex);
+    bool result = u_hashmap_put(g_arenaPayloads, ptr, arena);
+    if (result)
+    {
+        ATOMIC_STORE_RELEASE(&g_arenaPayloadCount, g_arenaPayloadCount + 1);
+        node->next = arena->registered;
+        arena->registered = node;
+    }
+    oc_mutex_unlock(g_arenaPayloadsMutex);
+    return result;
+}
+
+OCPayloadArena *OCPayloadArenaFind(const void *ptr)
+{
+    // A payload handed over from another thread is registered before the handover.
+    if (!ptr || 0 == ATOMIC_LOAD_ACQUIRE(&g_arenaPayloadCount))
+    {
+        return NULL;
+    }
+
+    oc_mutex_lock(g_arenaPayloadsMutex);
+    OCPayloadArena *arena = (OCPayloadArena *) u_hashmap_get(g_arenaPayloads, ptr);
+    oc_mutex_unlock(g_arenaPayloadsMutex);
+    return arena;
+}
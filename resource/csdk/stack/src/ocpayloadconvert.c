@@ -22,9 +22,13 @@
 #define __STDC_LIMIT_MACROS
 #endif
 
+#include "iotivity_config.h"
 #include "ocpayloadcbor.h"
 #include "platform_features.h"
 #include <stdlib.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "logger.h"
@@ -66,6 +70,125 @@ static int64_t AddTextStringToMap(CborEncoder *map, const char *key, size_t keyl
 static int64_t ConditionalAddTextStringToMap(CborEncoder *map, const char *key, size_t keylen,
         const char *value);
 
+#if defined(HAVE_PTHREAD_H) && !defined(_WIN32)
+/*
+ * Each thread encodes into a buffer that is kept between calls, so a payload
+ * is usually encoded only once. The result is copied out at its exact size.
+ * Larger buffers are handed out as the result instead of being kept.
+ * The kept buffer is freed by the key destructor when its thread exits.
+ */
+#define KEEP_ENCODE_BUFFER
+#define MAX_KEPT_BUFFER_SIZE (16 * 1024)
+
+typedef struct
+{
+    uint8_t *buffer;
+    size_t size;
+} EncodeBuffer_t;
+
+static pthread_key_t g_encodeBufferKey;
+static pthread_once_t g_encodeBufferKeyOnce = PTHREAD_ONCE_INIT;
+static bool g_encodeBufferKeyCreated = false;
+
+static void FreeEncodeBuffer(void *data)
+{
+    EncodeBuffer_t *kept = (EncodeBuffer_t *)data;
+    OICFree(kept->buffer);
+    OICFree(kept);
+}
+
+static void CreateEncodeBufferKey(void)
+{
+    g_encodeBufferKeyCreated = (0 == pthread_key_create(&g_encodeBufferKey, FreeEncodeBuffer));
+}
+
+static EncodeBuffer_t *GetKeptEncodeBuffer(bool create)
+{
+    pthread_once(&g_encodeBufferKeyOnce, CreateEncodeBufferKey);
+    if (!g_encodeBufferKeyCreated)
+    {
+        return NULL;
+    }
+
+    EncodeBuffer_t *kept = (EncodeBuffer_t *)pthread_getspecific(g_encodeBufferKey);
+    if (!kept && create)
+    {
+        kept = (EncodeBuffer_t *)OICCalloc(1, sizeof(EncodeBuffer_t));
+        if (kept && 0 != pthread_setspecific(g_encodeBufferKey, kept))
+        {
+            OICFree(kept);
+            kept = NULL;
+        }
+    }
+    return kept;
+}
+#endif
+
+static uint8_t *GetEncodeBuffer(size_t *bufferSize)
+{
+#ifdef KEEP_ENCODE_BUFFER
+    EncodeBuffer_t *kept = GetKeptEncodeBuffer(false);
+    if (kept && kept->buffer)
+    {
+        uint8_t *buffer = kept->buffer;
+        *bufferSize = kept->size;
+        kept->buffer = NULL;
+        kept->size = 0;
+        return buffer;
+    }
+#endif
+    *bufferSize = INIT_SIZE;
+    return (uint8_t *)OICMalloc(INIT_SIZE);
+}
+
+static void ReleaseEncodeBuffer(uint8_t *buffer, size_t bufferSize)
+{
+#ifdef KEEP_ENCODE_BUFFER
+    if (buffer && bufferSize <= MAX_KEPT_BUFFER_SIZE)
+    {
+        EncodeBuffer_t *kept = GetKeptEncodeBuffer(true);
+        if (kept && !kept->buffer)
+        {
+            kept->buffer = buffer;
+            kept->size = bufferSize;
+            return;
+        }
+    }
+#else
+    (void)bufferSize;
+#endif
+    OICFree(buffer);
+}
+
+/*
+ * Returns the encoded payload in a buffer of its own. The encode buffer is
+ * either released or becomes the result.
+ */
+static uint8_t *TakeEncodedPayload(uint8_t *buffer, size_t bufferSize, size_t size)
+{
+#ifdef KEEP_ENCODE_BUFFER
+    if (bufferSize <= MAX_KEPT_BUFFER_SIZE)
+    {
+        uint8_t *out = (uint8_t *)OICMalloc(size ? size : 1);
+        if (out)
+        {
+            memcpy(out, buffer, size);
+        }
+        ReleaseEncodeBuffer(buffer, bufferSize);
+        return out;
+    }
+#endif
+    if (size && size < bufferSize)
+    {
+        uint8_t *out = (uint8_t *)OICRealloc(buffer, size);
+        if (out)
+        {
+            return out;
+        }
+    }
+    return buffer;
+}
+
 OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t* size)
 {
     // TinyCbor Version 47a78569c0 or better on master is required for the re-allocation
@@ -79,6 +202,8 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
     int64_t err;
     uint8_t *out = NULL;
     size_t curSize = INIT_SIZE;
+    uint8_t *buffer = NULL;
+    size_t bufferSize = 0;
 
     VERIFY_PARAM_NON_NULL(TAG, payload, "Input param, payload is NULL");
     VERIFY_PARAM_NON_NULL(TAG, outPayload, "OutPayload parameter is NULL");
@@ -87,45 +212,41 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
     OIC_LOG_V(INFO, TAG, "Converting payload of type %d", payload->type);
     if (PAYLOAD_TYPE_SECURITY == payload->type)
     {
+        // Security payloads are already encoded, they are copied at their size.
         size_t securityPayloadSize = ((OCSecurityPayload *)payload)->payloadSize;
-        if (securityPayloadSize > 0)
-        {
-            out = (uint8_t *)OICCalloc(1, ((OCSecurityPayload *)payload)->payloadSize);
-            VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate security payload");
-        }
-    }
-    if (out == NULL)
-    {
-        out = (uint8_t *)OICCalloc(1, curSize);
-        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
+        out = (uint8_t *)OICCalloc(1, securityPayloadSize ? securityPayloadSize : 1);
+        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate security payload");
+        OCConvertSecurityPayload((OCSecurityPayload *)payload, out, &curSize);
+
+        *size = curSize;
+        *outPayload = out;
+        return OC_STACK_OK;
     }
-    err = OCConvertPayloadHelper(payload, out, &curSize);
+
+    buffer = GetEncodeBuffer(&bufferSize);
+    VERIFY_PARAM_NON_NULL(TAG, buffer, "Failed to allocate payload");
+
+    // When the buffer is too small, tinycbor keeps counting the bytes needed,
+    // so curSize is the exact size and the second try succeeds.
+    curSize = bufferSize;
+    err = OCConvertPayloadHelper(payload, buffer, &curSize);
     ret = OC_STACK_NO_MEMORY;
 
-    if (err == CborErrorOutOfMemory)
+    while (err == CborErrorOutOfMemory)
     {
-        // reallocate "out" and try again!
-        uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-        VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-        out = out2;
-        err = OCConvertPayloadHelper(payload, out, &curSize);
-        while (err == CborErrorOutOfMemory)
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            out = out2;
-            err = OCConvertPayloadHelper(payload, out, &curSize);
-        }
+        // The contents are encoded again, so there is nothing to copy.
+        OICFree(buffer);
+        bufferSize = curSize;
+        buffer = (uint8_t *)OICMalloc(bufferSize);
+        VERIFY_PARAM_NON_NULL(TAG, buffer, "Failed to increase payload size");
+        err = OCConvertPayloadHelper(payload, buffer, &curSize);
     }
 
     if (err == CborNoError)
     {
-        if (curSize < INIT_SIZE && PAYLOAD_TYPE_SECURITY != payload->type)
-        {
-            uint8_t *out2 = (uint8_t *)OICRealloc(out, curSize);
-            VERIFY_PARAM_NON_NULL(TAG, out2, "Failed to increase payload size");
-            out = out2;
-        }
+        out = TakeEncodedPayload(buffer, bufferSize, curSize);
+        buffer = NULL;
+        VERIFY_PARAM_NON_NULL(TAG, out, "Failed to allocate payload");
 
         *size = curSize;
         *outPayload = out;
@@ -138,7 +259,7 @@ OCStackResult OCConvertPayload(OCPayload* payload, uint8_t** outPayload, size_t*
     ret = (OCStackResult)-err;
 
 exit:
-    OICFree(out);
+    ReleaseEncodeBuffer(buffer, bufferSize);
     return ret;
 }
 
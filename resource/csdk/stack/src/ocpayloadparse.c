@@ -33,22 +33,64 @@
 #include "oic_malloc.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
+#include "ocpayloadarena.h"
 #include "ocstackinternal.h"
 #include "payload_logging.h"
 #include "platform_features.h"
 
 #define TAG "OIC_RI_PAYLOADPARSE"
 
+/**
+ * Arena bytes reserved per received CBOR byte. Parsed nodes are much larger than
+ * their encoding, anything beyond the estimate goes to additional arena blocks.
+ */
+#define ARENA_SIZE_FACTOR 4
+
+/**
+ * Parse received representation payloads into an arena, see OCRepPayloadSetArenaParsing().
+ */
+static bool g_repPayloadArenaParsing = false;
+
 static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseDevicePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParsePlatformPayload(OCPayload **outPayload, CborValue *arrayVal);
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent, bool isRoot);
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal);
+static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *repParent, bool isRoot,
+        OCPayloadArena *arena);
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *arrayVal,
+        OCPayloadArena *arena);
+static OCStackResult OCParseRepPayloadInArena(OCPayload **outPayload, CborValue *arrayVal,
+        size_t payloadSize);
 static OCStackResult OCParsePresencePayload(OCPayload **outPayload, CborValue *arrayVal);
 static OCStackResult OCParseSecurityPayload(OCPayload **outPayload, const uint8_t *payload, size_t size);
 
+static OCStackResult OCParsePayloadInternal(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize, bool useArena);
+
 OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadType payloadType,
         const uint8_t *payload, size_t payloadSize)
+{
+    return OCParsePayloadInternal(outPayload, payloadType, payload, payloadSize, false);
+}
+
+OCStackResult OCParseReceivedPayload(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize)
+{
+    return OCParsePayloadInternal(outPayload, payloadType, payload, payloadSize,
+                                  g_repPayloadArenaParsing);
+}
+
+void OCRepPayloadSetArenaParsing(bool enable)
+{
+    if (enable && !OCPayloadArenaInitialize())
+    {
+        OIC_LOG(ERROR, TAG, "Failed initializing payload arenas");
+        return;
+    }
+    g_repPayloadArenaParsing = enable;
+}
+
+static OCStackResult OCParsePayloadInternal(OCPayload **outPayload, OCPayloadType payloadType,
+        const uint8_t *payload, size_t payloadSize, bool useArena)
 {
     OCStackResult result = OC_STACK_MALFORMED_RESPONSE;
     CborError err;
@@ -78,7 +120,14 @@ OCStackResult OCParsePayload(OCPayload **outPayload, OCPayloadType payloadType,
             result = OCParsePlatformPayload(outPayload, &rootValue);
             break;
         case PAYLOAD_TYPE_REPRESENTATION:
-            result = OCParseRepPayload(outPayload, &rootValue);
+            if (useArena)
+            {
+                result = OCParseRepPayloadInArena(outPayload, &rootValue, payloadSize);
+            }
+            else
+            {
+                result = OCParseRepPayload(outPayload, &rootValue, NULL);
+            }
             break;
         case PAYLOAD_TYPE_PRESENCE:
             result = OCParsePresencePayload(outPayload, &rootValue);
@@ -130,7 +179,96 @@ static char* InPlaceStringTrim(char* str)
     return str;
 }
 
-static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resource)
+static void *OCParseAlloc(OCPayloadArena *arena, size_t count, size_t size)
+{
+    if (arena)
+    {
+        if (size && count > SIZE_MAX / size)
+        {
+            return NULL;
+        }
+        return OCPayloadArenaAlloc(arena, count * size);
+    }
+    return OICCalloc(count, size);
+}
+
+static void OCParseFree(OCPayloadArena *arena, void *ptr)
+{
+    // Arena memory is only released with the whole arena.
+    if (!arena)
+    {
+        OICFree(ptr);
+    }
+}
+
+static CborError OCParseDupTextString(const CborValue *value, char **str, size_t *len,
+        OCPayloadArena *arena)
+{
+    if (!arena)
+    {
+        return cbor_value_dup_text_string(value, str, len, NULL);
+    }
+
+    CborError err = cbor_value_calculate_string_length(value, len);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+    size_t size = *len + 1;
+    *str = (char *)OCPayloadArenaAlloc(arena, size);
+    if (!*str)
+    {
+        return CborErrorOutOfMemory;
+    }
+    return cbor_value_copy_text_string(value, *str, &size, NULL);
+}
+
+static CborError OCParseDupByteString(const CborValue *value, uint8_t **bytes, size_t *len,
+        OCPayloadArena *arena)
+{
+    if (!arena)
+    {
+        return cbor_value_dup_byte_string(value, bytes, len, NULL);
+    }
+
+    CborError err = cbor_value_calculate_string_length(value, len);
+    if (CborNoError != err)
+    {
+        return err;
+    }
+    size_t size = *len;
+    *bytes = (uint8_t *)OCPayloadArenaAlloc(arena, size);
+    if (!*bytes)
+    {
+        return CborErrorOutOfMemory;
+    }
+    return cbor_value_copy_byte_string(value, *bytes, &size, NULL);
+}
+
+static bool OCParseAddStringLL(OCStringLL **stringLL, char *value, OCPayloadArena *arena)
+{
+    if (!arena)
+    {
+        return OCResourcePayloadAddStringLL(stringLL, value);
+    }
+
+    // The node points into the arena copy of the whole string, nothing is duplicated.
+    OCStringLL *node = (OCStringLL *)OCPayloadArenaAlloc(arena, sizeof(OCStringLL));
+    if (!node)
+    {
+        return false;
+    }
+    node->value = value;
+    while (*stringLL)
+    {
+        stringLL = &(*stringLL)->next;
+    }
+    *stringLL = node;
+    return true;
+}
+
+static CborError OCParseStringLLInArena(CborValue *map, char *type, OCStringLL **resource,
+        OCPayloadArena *arena)
 {
     CborValue val;
     CborError err = cbor_value_map_find_value(map, type, &val);
@@ -145,7 +283,7 @@ static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resour
         {
             size_t len = 0;
             char *input = NULL;
-            err = cbor_value_dup_text_string(&txtStr, &input, &len, NULL);
+            err = OCParseDupTextString(&txtStr, &input, &len, arena);
             VERIFY_CBOR_SUCCESS(TAG, err, "to find StringLL value.");
             if (input)
             {
@@ -156,14 +294,15 @@ static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resour
                     char *trimmed = InPlaceStringTrim(curPtr);
                     if (trimmed[0] !='\0')
                     {
-                        if (!OCResourcePayloadAddStringLL(resource, trimmed))
+                        if (!OCParseAddStringLL(resource, trimmed, arena))
                         {
+                            OCParseFree(arena, input);
                             return CborErrorOutOfMemory;
                         }
                     }
                     curPtr = strtok_r(NULL, " ", &savePtr);
                 }
-                OICFree(input);
+                OCParseFree(arena, input);
             }
             if (cbor_value_is_text_string(&txtStr))
             {
@@ -176,6 +315,11 @@ exit:
     return err;
 }
 
+static CborError OCParseStringLL(CborValue *map, char *type, OCStringLL **resource)
+{
+    return OCParseStringLLInArena(map, type, resource, NULL);
+}
+
 static OCStackResult OCParseDiscoveryPayload(OCPayload **outPayload, CborValue *rootValue)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
@@ -751,7 +895,8 @@ static size_t arrayStep(size_t dimensions[MAX_REP_ARRAY_DEPTH], size_t elementNu
 }
 
 static CborError OCParseArrayFillArray(const CborValue *parent,
-        size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void *targetArray)
+        size_t dimensions[MAX_REP_ARRAY_DEPTH], OCRepPayloadPropType type, void *targetArray,
+        OCPayloadArena *arena)
 {
     CborValue insideArray;
 
@@ -784,7 +929,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((int64_t*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_DOUBLE:
@@ -807,7 +952,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((double*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((double*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_BOOL:
@@ -818,39 +963,39 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((bool*)targetArray)[arrayStep(dimensions, i)]));
+                            &(((bool*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = cbor_value_dup_text_string(&insideArray, &tempStr, &tempLen, NULL);
+                        err = OCParseDupTextString(&insideArray, &tempStr, &tempLen, arena);
                         ((char**)targetArray)[i] = tempStr;
                         tempStr = NULL;
                     }
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((char**)targetArray)[arrayStep(dimensions, i)]));
+                            &(((char**)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_BYTE_STRING:
                     if (dimensions[1] == 0)
                     {
-                        err = cbor_value_dup_byte_string(&insideArray, &(ocByteStr.bytes),
-                                &(ocByteStr.len), NULL);
+                        err = OCParseDupByteString(&insideArray, &(ocByteStr.bytes),
+                                &(ocByteStr.len), arena);
                         ((OCByteString*)targetArray)[i] = ocByteStr;
                     }
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                                &(((OCByteString*)targetArray)[arrayStep(dimensions, i)]));
+                                &(((OCByteString*)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 case OCREP_PROP_OBJECT:
                     if (dimensions[1] == 0)
                     {
-                        err = OCParseSingleRepPayload(&tempPl, &insideArray, false);
+                        err = OCParseSingleRepPayload(&tempPl, &insideArray, false, arena);
                         ((OCRepPayload**)targetArray)[i] = tempPl;
                         tempPl = NULL;
                         noAdvance = true;
@@ -858,7 +1003,7 @@ static CborError OCParseArrayFillArray(const CborValue *parent,
                     else
                     {
                         err = OCParseArrayFillArray(&insideArray, newdim, type,
-                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]));
+                            &(((OCRepPayload**)targetArray)[arrayStep(dimensions, i)]), arena);
                     }
                     break;
                 default:
@@ -880,7 +1025,8 @@ exit:
     return err;
 }
 
-static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *container)
+static CborError OCParseArray(OCRepPayloadValueArray *outArray, CborValue *container,
+        OCPayloadArena *arena)
 {
     void *arr = NULL;
 
@@ -889,56 +1035,35 @@ static CborError OCParseArray(OCRepPayload *out, const char *name, CborValue *co
 
     size_t dimTotal = 0;
     size_t allocSize = 0;
-    bool res = true;
     CborError err = OCParseArrayFindDimensionsAndType(container, dimensions, &type);
     VERIFY_CBOR_SUCCESS(TAG, err, "Array details weren't clear");
 
+    outArray->type = type;
+    memcpy(outArray->dimensions, dimensions, sizeof(dimensions));
+    outArray->iArray = NULL;
     if (type == OCREP_PROP_NULL)
     {
-        res = OCRepPayloadSetNull(out, name);
-        err = (CborError) !res;
-        VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting value");
-        err = cbor_value_advance(container);
-        VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing container");
-        return err;
+        // An array of nulls is stored as a null value.
+        return CborNoError;
     }
 
     dimTotal = calcDimTotal(dimensions);
     allocSize = getAllocSize(type);
-    arr = OICCalloc(dimTotal, allocSize);
+    arr = OCParseAlloc(arena, dimTotal, allocSize);
+    err = CborErrorOutOfMemory;
     VERIFY_PARAM_NON_NULL(TAG, arr, "Array Parse allocation failed");
 
-    res = OCParseArrayFillArray(container, dimensions, type, arr);
+    err = OCParseArrayFillArray(container, dimensions, type, arr, arena);
     VERIFY_CBOR_SUCCESS(TAG, err, "Failed parse array");
 
-    switch (type)
-    {
-        case OCREP_PROP_INT:
-            res = OCRepPayloadSetIntArrayAsOwner(out, name, (int64_t *)arr, dimensions);
-            break;
-        case OCREP_PROP_DOUBLE:
-            res = OCRepPayloadSetDoubleArrayAsOwner(out, name, (double *)arr, dimensions);
-            break;
-        case OCREP_PROP_BOOL:
-            res = OCRepPayloadSetBoolArrayAsOwner(out, name, (bool *)arr, dimensions);
-            break;
-        case OCREP_PROP_STRING:
-            res = OCRepPayloadSetStringArrayAsOwner(out, name, (char **)arr, dimensions);
-            break;
-        case OCREP_PROP_BYTE_STRING:
-            res = OCRepPayloadSetByteStringArrayAsOwner(out, name, (OCByteString *)arr, dimensions);
-            break;
-        case OCREP_PROP_OBJECT:
-            res = OCRepPayloadSetPropObjectArrayAsOwner(out, name, (OCRepPayload**)arr, dimensions);
-            break;
-        default:
-            OIC_LOG(ERROR, TAG, "Invalid Array type in Parse Array");
-            break;
-    }
-    err = (CborError) !res;
-    VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting array parameter");
+    // Since this is a union, iArray will point to any of the array types
+    outArray->iArray = (int64_t *)arr;
     return CborNoError;
 exit:
+    if (arena || !arr)
+    {
+        return err;
+    }
     if (type == OCREP_PROP_STRING)
     {
         for(size_t i = 0; i < dimTotal; ++i)
@@ -964,7 +1089,106 @@ exit:
     return err;
 }
 
-static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap, bool isRoot)
+static OCRepPayload *OCParseCreateRepPayload(OCPayloadArena *arena)
+{
+    if (!arena)
+    {
+        return OCRepPayloadCreate();
+    }
+
+    OCRepPayload *payload = (OCRepPayload *)OCPayloadArenaAlloc(arena, sizeof(OCRepPayload));
+    if (!payload || !OCPayloadArenaRegister(arena, payload))
+    {
+        return NULL;
+    }
+    payload->base.type = PAYLOAD_TYPE_REPRESENTATION;
+    return payload;
+}
+
+/**
+ * Store a parsed value in the payload. The contents of the value are taken over.
+ * Heap payloads go through the AsOwner setters, which copy the name. In an arena
+ * the value node is allocated from the arena and keeps the name as is.
+ */
+static bool OCParseSetValue(OCRepPayload *payload, char *name, const OCRepPayloadValue *value,
+        OCPayloadArena *arena)
+{
+    if (arena)
+    {
+        if (!name)
+        {
+            return false;
+        }
+        OCRepPayloadValue *val =
+                (OCRepPayloadValue *)OCPayloadArenaAlloc(arena, sizeof(OCRepPayloadValue));
+        if (!val)
+        {
+            return false;
+        }
+        *val = *value;
+        val->name = name;
+
+        // Prepended while parsing, OCParseSingleRepPayload restores the order.
+        val->next = payload->values;
+        payload->values = val;
+        return true;
+    }
+
+    switch (value->type)
+    {
+        case OCREP_PROP_NULL:
+            return OCRepPayloadSetNull(payload, name);
+        case OCREP_PROP_INT:
+            return OCRepPayloadSetPropInt(payload, name, value->i);
+        case OCREP_PROP_DOUBLE:
+            return OCRepPayloadSetPropDouble(payload, name, value->d);
+        case OCREP_PROP_BOOL:
+            return OCRepPayloadSetPropBool(payload, name, value->b);
+        case OCREP_PROP_STRING:
+            return OCRepPayloadSetPropStringAsOwner(payload, name, value->str);
+        case OCREP_PROP_BYTE_STRING:
+            {
+                OCByteString tmp = value->ocByteStr;
+                return OCRepPayloadSetPropByteStringAsOwner(payload, name, &tmp);
+            }
+        case OCREP_PROP_OBJECT:
+            return OCRepPayloadSetPropObjectAsOwner(payload, name, value->obj);
+        case OCREP_PROP_ARRAY:
+            {
+                size_t dimensions[MAX_REP_ARRAY_DEPTH];
+                memcpy(dimensions, value->arr.dimensions, sizeof(dimensions));
+                switch (value->arr.type)
+                {
+                    case OCREP_PROP_INT:
+                        return OCRepPayloadSetIntArrayAsOwner(payload, name,
+                                value->arr.iArray, dimensions);
+                    case OCREP_PROP_DOUBLE:
+                        return OCRepPayloadSetDoubleArrayAsOwner(payload, name,
+                                value->arr.dArray, dimensions);
+                    case OCREP_PROP_BOOL:
+                        return OCRepPayloadSetBoolArrayAsOwner(payload, name,
+                                value->arr.bArray, dimensions);
+                    case OCREP_PROP_STRING:
+                        return OCRepPayloadSetStringArrayAsOwner(payload, name,
+                                value->arr.strArray, dimensions);
+                    case OCREP_PROP_BYTE_STRING:
+                        return OCRepPayloadSetByteStringArrayAsOwner(payload, name,
+                                value->arr.ocByteStrArray, dimensions);
+                    case OCREP_PROP_OBJECT:
+                        return OCRepPayloadSetPropObjectArrayAsOwner(payload, name,
+                                value->arr.objArray, dimensions);
+                    default:
+                        OIC_LOG(ERROR, TAG, "Invalid Array type in Parse Array");
+                        return false;
+                }
+            }
+        default:
+            return false;
+    }
+}
+
+static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *objMap, bool isRoot,
+        OCPayloadArena *arena)
 {
     CborError err = CborUnknownError;
     char *name = NULL;
@@ -976,7 +1200,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
     {
         if (!*outPayload)
         {
-            *outPayload = OCRepPayloadCreate();
+            *outPayload = OCParseCreateRepPayload(arena);
             if (!*outPayload)
             {
                 return CborErrorOutOfMemory;
@@ -994,7 +1218,7 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
         {
             if (cbor_value_is_text_string(&repMap))
             {
-                err = cbor_value_dup_text_string(&repMap, &name, &len, NULL);
+                err = OCParseDupTextString(&repMap, &name, &len, arena);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed finding tag name in the map");
                 err = cbor_value_advance(&repMap);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed advancing rootMap");
@@ -1005,76 +1229,68 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                     (0 == strcmp(OC_RSRVD_INTERFACE, name))))
                 {
                     err = cbor_value_advance(&repMap);
-                    OICFree(name);
+                    OCParseFree(arena, name);
                     continue;
                 }
             }
+            OCRepPayloadValue value;
+            memset(&value, 0, sizeof(value));
+            res = true;
             CborType type = cbor_value_get_type(&repMap);
             switch (type)
             {
                 case CborNullType:
-                    res = OCRepPayloadSetNull(curPayload, name);
+                    value.type = OCREP_PROP_NULL;
                     break;
                 case CborIntegerType:
-                    {
-                        int64_t intval = 0;
-                        err = cbor_value_get_int64(&repMap, &intval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
-                        res = OCRepPayloadSetPropInt(curPayload, name, intval);
-                    }
+                    value.type = OCREP_PROP_INT;
+                    err = cbor_value_get_int64(&repMap, &value.i);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting int value");
                     break;
                 case CborDoubleType:
-                    {
-                        double doubleval = 0;
-                        err = cbor_value_get_double(&repMap, &doubleval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
-                        res = OCRepPayloadSetPropDouble(curPayload, name, doubleval);
-                    }
+                    value.type = OCREP_PROP_DOUBLE;
+                    err = cbor_value_get_double(&repMap, &value.d);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting double value");
                     break;
                 case CborBooleanType:
-                    {
-                        bool boolval = false;
-                        err = cbor_value_get_boolean(&repMap, &boolval);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
-                        res = OCRepPayloadSetPropBool(curPayload, name, boolval);
-                    }
+                    value.type = OCREP_PROP_BOOL;
+                    err = cbor_value_get_boolean(&repMap, &value.b);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting boolean value");
                     break;
                 case CborTextStringType:
-                    {
-                        char *strval = NULL;
-                        err = cbor_value_dup_text_string(&repMap, &strval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
-                        res = OCRepPayloadSetPropStringAsOwner(curPayload, name, strval);
-                    }
+                    value.type = OCREP_PROP_STRING;
+                    err = OCParseDupTextString(&repMap, &value.str, &len, arena);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting string value");
                     break;
                 case CborByteStringType:
-                    {
-                        uint8_t* bytestrval = NULL;
-                        err = cbor_value_dup_byte_string(&repMap, &bytestrval, &len, NULL);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
-                        OCByteString tmp = {.bytes = bytestrval, .len = len};
-                        res = OCRepPayloadSetPropByteStringAsOwner(curPayload, name, &tmp);
-                    }
+                    value.type = OCREP_PROP_BYTE_STRING;
+                    err = OCParseDupByteString(&repMap, &value.ocByteStr.bytes,
+                            &value.ocByteStr.len, arena);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed getting byte string value");
                     break;
                 case CborMapType:
-                    {
-                        OCRepPayload *pl = NULL;
-                        err = OCParseSingleRepPayload(&pl, &repMap, false);
-                        VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
-                        res = OCRepPayloadSetPropObjectAsOwner(curPayload, name, pl);
-                    }
+                    value.type = OCREP_PROP_OBJECT;
+                    err = OCParseSingleRepPayload(&value.obj, &repMap, false, arena);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting parse single rep");
                     break;
                 case CborArrayType:
-                    err = OCParseArray(curPayload, name, &repMap);
+                    value.type = OCREP_PROP_ARRAY;
+                    err = OCParseArray(&value.arr, &repMap, arena);
+                    VERIFY_CBOR_SUCCESS(TAG, err, "Failed parse array");
+                    if (OCREP_PROP_NULL == value.arr.type)
+                    {
+                        value.type = OCREP_PROP_NULL;
+                    }
                     break;
                 default:
                     OIC_LOG_V(ERROR, TAG, "Parsing rep property, unknown type %d", repMap.type);
                     res = false;
             }
-            if (type != CborArrayType)
+            if (res)
             {
-                err = (CborError) !res;
+                res = OCParseSetValue(curPayload, name, &value, arena);
             }
+            err = (CborError) !res;
             VERIFY_CBOR_SUCCESS(TAG, err, "Failed setting value");
 
             if (type != CborMapType && cbor_value_is_valid(&repMap))
@@ -1082,9 +1298,22 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
                 err = cbor_value_advance(&repMap);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed advance repMap");
             }
-            OICFree(name);
+            OCParseFree(arena, name);
             name = NULL;
         }
+        if (arena)
+        {
+            // Put the prepended values back in the order they were received.
+            OCRepPayloadValue *ordered = NULL;
+            while (curPayload->values)
+            {
+                OCRepPayloadValue *val = curPayload->values;
+                curPayload->values = val->next;
+                val->next = ordered;
+                ordered = val;
+            }
+            curPayload->values = ordered;
+        }
         if (cbor_value_is_container(objMap))
         {
             err = cbor_value_leave_container(objMap, &repMap);
@@ -1094,13 +1323,14 @@ static CborError OCParseSingleRepPayload(OCRepPayload **outPayload, CborValue *o
     }
 
 exit:
-    OICFree(name);
+    OCParseFree(arena, name);
     OCRepPayloadDestroy(*outPayload);
     *outPayload = NULL;
     return err;
 }
 
-static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
+static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root,
+        OCPayloadArena *arena)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
     CborError err;
@@ -1119,7 +1349,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
     }
     while (cbor_value_is_valid(&rootMap))
     {
-        temp = OCRepPayloadCreate();
+        temp = OCParseCreateRepPayload(arena);
         ret = OC_STACK_NO_MEMORY;
         VERIFY_PARAM_NON_NULL(TAG, temp, "Failed allocating memory");
 
@@ -1138,7 +1368,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
             if (cbor_value_is_valid(&curVal))
             {
                 size_t len = 0;
-                err = cbor_value_dup_text_string(&curVal, &temp->uri, &len, NULL);
+                err = OCParseDupTextString(&curVal, &temp->uri, &len, arena);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find uri");
             }
         }
@@ -1148,7 +1378,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
         {
             if (CborNoError == cbor_value_map_find_value(&rootMap, OC_RSRVD_RESOURCE_TYPE, &curVal))
             {
-                err =  OCParseStringLL(&rootMap, OC_RSRVD_RESOURCE_TYPE, &temp->types);
+                err =  OCParseStringLLInArena(&rootMap, OC_RSRVD_RESOURCE_TYPE, &temp->types, arena);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find rt type tag/value");
             }
         }
@@ -1158,14 +1388,15 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
         {
             if (CborNoError == cbor_value_map_find_value(&rootMap, OC_RSRVD_INTERFACE, &curVal))
             {
-                err =  OCParseStringLL(&rootMap, OC_RSRVD_INTERFACE, &temp->interfaces);
+                err =  OCParseStringLLInArena(&rootMap, OC_RSRVD_INTERFACE, &temp->interfaces,
+                                              arena);
                 VERIFY_CBOR_SUCCESS(TAG, err, "Failed to find interfaces tag/value");
             }
         }
 
         if (cbor_value_is_map(&rootMap))
         {
-            err = OCParseSingleRepPayload(&temp, &rootMap, true);
+            err = OCParseSingleRepPayload(&temp, &rootMap, true, arena);
             VERIFY_CBOR_SUCCESS(TAG, err, "Failed to parse single rep payload");
         }
 
@@ -1179,6 +1410,7 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
             curPayload->next = temp;
             curPayload = curPayload->next;
         }
+        temp = NULL;
 
         if (cbor_value_is_array(&rootMap))
         {
@@ -1190,12 +1422,38 @@ static OCStackResult OCParseRepPayload(OCPayload **outPayload, CborValue *root)
     return OC_STACK_OK;
 
 exit:
-    OCRepPayloadDestroy(temp);
-    OCRepPayloadDestroy(rootPayload);
+    // An arena is freed as a whole by the caller.
+    if (!arena)
+    {
+        OCRepPayloadDestroy(temp);
+        OCRepPayloadDestroy(rootPayload);
+    }
     OIC_LOG(ERROR, TAG, "CBOR error in ParseRepPayload");
     return ret;
 }
 
+static OCStackResult OCParseRepPayloadInArena(OCPayload **outPayload, CborValue *root,
+        size_t payloadSize)
+{
+    OCPayloadArena *arena = OCPayloadArenaCreate(payloadSize * ARENA_SIZE_FACTOR);
+    if (!arena)
+    {
+        OIC_LOG(ERROR, TAG, "Failed allocating payload arena, parsing on the heap");
+        return OCParseRepPayload(outPayload, root, NULL);
+    }
+
+    OCStackResult result = OCParseRepPayload(outPayload, root, arena);
+    if (OC_STACK_OK != result || !*outPayload)
+    {
+        OCPayloadArenaDestroy(arena);
+        return result;
+    }
+
+    // Destroying the first payload of the list releases the arena.
+    arena->owner = *outPayload;
+    return result;
+}
+
 static OCStackResult OCParsePresencePayload(OCPayload **outPayload, CborValue *rootValue)
 {
     OCStackResult ret = OC_STACK_INVALID_PARAM;
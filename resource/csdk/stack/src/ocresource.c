@@ -45,7 +45,9 @@
 #include "oic_string.h"
 #include "logger.h"
 #include "cJSON.h"
+#include "uhashmap.h"
 #include "ocpayload.h"
+#include "ocpayloadcbor.h"
 #include "secureresourcemanager.h"
 #include "cacommon.h"
 #include "cainterface.h"
@@ -59,6 +61,10 @@
 #include "rd_database.h"
 #endif
 
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
 /// Module Name
 #define TAG "OIC_RI_RESOURCE"
 
@@ -70,10 +76,68 @@
 
 #include "platform_features.h"
 
+/**
+ * Number of encoded discovery responses kept in the discovery cache.
+ */
+#define DISCOVERY_CACHE_SIZE (8)
+
+/**
+ * Transport flags that do not change the discovery response.
+ */
+#define DISCOVERY_CACHE_IGNORED_FLAGS (OC_MULTICAST)
+
+/**
+ * A discovery response that was built for one kind of request.
+ */
+typedef struct
+{
+    /** Virtual resource that was requested. */
+    OCVirtualResources uri;
+
+    /** Query of the request, with the filters. NULL for a free entry. */
+    char *query;
+
+    /** Format that the requester accepts. */
+    OCPayloadFormat acceptFormat;
+
+    /** Adapter and flags of the requester, which select the ports in the response. */
+    OCTransportAdapter adapter;
+    OCTransportFlags flags;
+
+    /** Result of building the response, OC_STACK_OK or OC_STACK_NO_RESOURCE. */
+    OCStackResult result;
+
+    /** Encoded response if result is OC_STACK_OK. */
+    uint8_t *payload;
+    size_t payloadSize;
+} DiscoveryCacheEntry;
+
 extern OCResource *headResource;
+extern u_hashmap_t *resourceUriIndex;
 static OCPlatformInfo savedPlatformInfo = {0};
 static OCDeviceInfo savedDeviceInfo = {0};
 
+static DiscoveryCacheEntry discoveryCache[DISCOVERY_CACHE_SIZE];
+static size_t discoveryCacheNextEntry = 0;
+static uint32_t discoveryCacheHits = 0;
+static uint32_t discoveryCacheMisses = 0;
+
+/**
+ * Set by network monitor threads, the next discovery request drops the cache.
+ */
+static uint32_t discoveryCacheStale = 0;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ATOMIC_LOAD_ACQUIRE(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_RELEASE(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+#define ATOMIC_LOAD_ACQUIRE(p)      ((uint32_t) InterlockedOr((volatile LONG *)(p), 0))
+#define ATOMIC_STORE_RELEASE(p, v)  InterlockedExchange((volatile LONG *)(p), (LONG)(v))
+#else
+#define ATOMIC_LOAD_ACQUIRE(p)      (*(volatile uint32_t *)(p))
+#define ATOMIC_STORE_RELEASE(p, v)  (*(volatile uint32_t *)(p) = (v))
+#endif
+
 /**
  * Prepares a Payload for response.
  */
@@ -377,17 +441,12 @@ OCResource *FindResourceByUri(const char* resourceUri)
         return NULL;
     }
 
-    OCResource * pointer = headResource;
-    while (pointer)
+    OCResource *pointer = (OCResource *) u_hashmap_get(resourceUriIndex, resourceUri);
+    if (!pointer)
     {
-        if (strcmp(resourceUri, pointer->uri) == 0)
-        {
-            return pointer;
-        }
-        pointer = pointer->next;
+        OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
     }
-    OIC_LOG_V(INFO, TAG, "Resource %s not found", resourceUri);
-    return NULL;
+    return pointer;
 }
 
 
@@ -616,150 +675,354 @@ OCStackResult SendNonPersistantDiscoveryResponse(OCServerRequest *request, OCRes
     return OCDoResponse(&response);
 }
 
-static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource* resource)
+static OCStackResult SendEncodedDiscoveryResponse(OCServerRequest *request, OCResource *resource,
+                                                  const uint8_t *payload, size_t payloadSize)
 {
-    if (!request || !resource)
+    OCEntityHandlerResponse response = {0};
+
+    response.ehResult = OC_EH_OK;
+    response.persistentBufferFlag = 0;
+    response.requestHandle = (OCRequestHandle) request;
+    response.resourceHandle = (OCResourceHandle) resource;
+
+    // Discovery requests are always answered by HandleSingleResponse.
+    return HandleSingleEncodedResponse(&response, payload, payloadSize);
+}
+
+static void ClearDiscoveryCacheEntry(DiscoveryCacheEntry *entry)
+{
+    OICFree(entry->query);
+    OICFree(entry->payload);
+    memset(entry, 0, sizeof(*entry));
+}
+
+void InvalidateDiscoveryCache()
+{
+    for (size_t i = 0; i < DISCOVERY_CACHE_SIZE; i++)
     {
-        return OC_STACK_INVALID_PARAM;
+        if (discoveryCache[i].query)
+        {
+            ClearDiscoveryCacheEntry(&discoveryCache[i]);
+        }
     }
+}
 
-    OCStackResult discoveryResult = OC_STACK_ERROR;
-    OCPayload* payload = NULL;
+void MarkDiscoveryCacheStale()
+{
+    ATOMIC_STORE_RELEASE(&discoveryCacheStale, 1);
+}
 
-    OIC_LOG(INFO, TAG, "Entering HandleVirtualResource");
+static bool IsDiscoveryRequestCacheable(const OCServerRequest *request)
+{
+    if (request->acceptFormat != OC_FORMAT_UNDEFINED && request->acceptFormat != OC_FORMAT_CBOR)
+    {
+        return false;
+    }
+#ifdef RD_SERVER
+    // The resource directory adds resources from its database, which changes
+    // without the stack knowing.
+    if (FindResourceByUri(OC_RSRVD_RD_URI))
+    {
+        return false;
+    }
+#endif
+    return true;
+}
 
-    OCVirtualResources virtualUriInRequest = GetTypeOfVirtualURI (request->resourceUrl);
+/**
+ * Looks up the response to a discovery request. Must be called before the
+ * query of the request is parsed, which modifies it.
+ */
+static DiscoveryCacheEntry *FindDiscoveryCacheEntry(OCVirtualResources uri,
+                                                    const OCServerRequest *request)
+{
+    OCTransportFlags flags = (OCTransportFlags) (request->devAddr.flags &
+                                                 ~DISCOVERY_CACHE_IGNORED_FLAGS);
 
-    // Step 1: Generate the response to discovery request
-    if (virtualUriInRequest == OC_WELL_KNOWN_URI
-#ifdef MQ_BROKER
-            || virtualUriInRequest == OC_MQ_BROKER_URI
-#endif
-            )
+    for (size_t i = 0; i < DISCOVERY_CACHE_SIZE; i++)
     {
-        if (request->method == OC_REST_PUT || request->method == OC_REST_POST || request->method == OC_REST_DELETE)
+        DiscoveryCacheEntry *entry = &discoveryCache[i];
+        if (entry->query && entry->uri == uri
+            && entry->acceptFormat == request->acceptFormat
+            && entry->adapter == request->devAddr.adapter
+            && entry->flags == flags
+            && 0 == strcmp(entry->query, request->query))
         {
-            OIC_LOG_V(ERROR, TAG, "Resource : %s not permitted for method: %d", request->resourceUrl, request->method);
-            return OC_STACK_UNAUTHORIZED_REQ;
+            return entry;
         }
+    }
+    return NULL;
+}
 
-        char *interfaceQuery = NULL;
-        char *resourceTypeQuery = NULL;
+/**
+ * Stores the response to a discovery request.
+ *
+ * @param uri      Virtual resource that was requested.
+ * @param query    Query of the request before it was parsed. Owned by the cache
+ *                 on success.
+ * @param request  The request.
+ * @param result   Result of building the response.
+ * @param payload  The response if result is OC_STACK_OK.
+ *
+ * @return The new entry, NULL if the response cannot be cached.
+ */
+static DiscoveryCacheEntry *AddDiscoveryCacheEntry(OCVirtualResources uri, char *query,
+                                                   const OCServerRequest *request,
+                                                   OCStackResult result, OCPayload *payload)
+{
+    uint8_t *encoded = NULL;
+    size_t encodedSize = 0;
 
-        discoveryResult = getQueryParamsForFiltering (virtualUriInRequest, request->query,
-                &interfaceQuery, &resourceTypeQuery);
-        bool interfaceQueryAllocated = false;
-        if (!interfaceQuery && !resourceTypeQuery)
+    if (OC_STACK_OK == result)
+    {
+        if (!payload || OC_STACK_OK != OCConvertPayload(payload, &encoded, &encodedSize))
         {
-            interfaceQueryAllocated = true;
-            interfaceQuery = OICStrdup(OC_RSRVD_INTERFACE_LL);
+            OIC_LOG(ERROR, TAG, "Error converting discovery payload");
+            return NULL;
         }
+    }
+    else if (OC_STACK_NO_RESOURCE != result)
+    {
+        return NULL;
+    }
+
+    // Replace the entries in turn; the number of distinct queries is small.
+    DiscoveryCacheEntry *entry = &discoveryCache[discoveryCacheNextEntry];
+    discoveryCacheNextEntry = (discoveryCacheNextEntry + 1) % DISCOVERY_CACHE_SIZE;
+    ClearDiscoveryCacheEntry(entry);
+
+    entry->uri = uri;
+    entry->query = query;
+    entry->acceptFormat = request->acceptFormat;
+    entry->adapter = request->devAddr.adapter;
+    entry->flags = (OCTransportFlags) (request->devAddr.flags & ~DISCOVERY_CACHE_IGNORED_FLAGS);
+    entry->result = result;
+    entry->payload = encoded;
+    entry->payloadSize = encodedSize;
+    return entry;
+}
 
-        if (discoveryResult == OC_STACK_OK)
+OCStackResult OCGetDiscoveryCacheCounters(uint32_t *hits, uint32_t *misses)
+{
+    VERIFY_NON_NULL(hits, ERROR, OC_STACK_INVALID_PARAM);
+    VERIFY_NON_NULL(misses, ERROR, OC_STACK_INVALID_PARAM);
+
+    *hits = discoveryCacheHits;
+    *misses = discoveryCacheMisses;
+    return OC_STACK_OK;
+}
+
+/**
+ * Builds the response to a request for /oic/res.
+ *
+ * @param request              The request, whose query is modified by parsing it.
+ * @param resource             First resource of the list.
+ * @param virtualUriInRequest  The requested virtual resource.
+ * @param payload              Receives the response, which the caller destroys.
+ *
+ * @return ::OC_STACK_OK, ::OC_STACK_NO_RESOURCE if no resource matches the filters,
+ *         or some error value.
+ */
+static OCStackResult BuildDiscoveryPayload(OCServerRequest *request, OCResource *resource,
+                                           OCVirtualResources virtualUriInRequest,
+                                           OCPayload **payload)
+{
+    OCStackResult discoveryResult = OC_STACK_ERROR;
+
+    char *interfaceQuery = NULL;
+    char *resourceTypeQuery = NULL;
+
+    discoveryResult = getQueryParamsForFiltering (virtualUriInRequest, request->query,
+            &interfaceQuery, &resourceTypeQuery);
+    bool interfaceQueryAllocated = false;
+    if (!interfaceQuery && !resourceTypeQuery)
+    {
+        interfaceQueryAllocated = true;
+        interfaceQuery = OICStrdup(OC_RSRVD_INTERFACE_LL);
+    }
+
+    if (discoveryResult == OC_STACK_OK)
+    {
+        *payload = (OCPayload *)OCDiscoveryPayloadCreate();
+
+        if (*payload)
         {
-            payload = (OCPayload *)OCDiscoveryPayloadCreate();
+            OCDiscoveryPayload *discPayload = (OCDiscoveryPayload *)*payload;
+            bool foundResourceAtRD = false;
 
-            if (payload)
+            if (!resourceTypeQuery && interfaceQuery && (0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL)))
             {
-                OCDiscoveryPayload *discPayload = (OCDiscoveryPayload *)payload;
-                bool foundResourceAtRD = false;
-
-                if (!resourceTypeQuery && interfaceQuery && (0 == strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL)))
-                {
-                    OCResourceProperty prop = OC_DISCOVERABLE;
+                OCResourceProperty prop = OC_DISCOVERABLE;
 #ifdef MQ_BROKER
-                    if (OC_MQ_BROKER_URI == virtualUriInRequest)
-                    {
-                        prop = OC_MQ_BROKER;
-                    }
+                if (OC_MQ_BROKER_URI == virtualUriInRequest)
+                {
+                    prop = OC_MQ_BROKER;
+                }
 #endif
 
-                    for (; resource && discoveryResult == OC_STACK_OK; resource = resource->next)
-                    {
-                        foundResourceAtRD = false;
+                for (; resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+                {
+                    foundResourceAtRD = false;
 #ifdef RD_SERVER
-                        if (strcmp(resource->uri, OC_RSRVD_RD_URI) == 0)
+                    if (strcmp(resource->uri, OC_RSRVD_RD_URI) == 0)
+                    {
+                        if (OC_STACK_OK == OCRDDatabaseCheckResources(interfaceQuery, resourceTypeQuery, discPayload))
                         {
-                            if (OC_STACK_OK == OCRDDatabaseCheckResources(interfaceQuery, resourceTypeQuery, discPayload))
-                            {
-                                foundResourceAtRD = true;
-                                discoveryResult = OC_STACK_OK;
-                            }
+                            foundResourceAtRD = true;
+                            discoveryResult = OC_STACK_OK;
                         }
+                    }
 #endif
-                        if (!foundResourceAtRD && (resource->resourceProperties & prop))
-                        {
-                            discoveryResult = BuildVirtualResourceResponse(resource, discPayload, &request->devAddr);
-                        }
+                    if (!foundResourceAtRD && (resource->resourceProperties & prop))
+                    {
+                        discoveryResult = BuildVirtualResourceResponse(resource, discPayload, &request->devAddr);
                     }
                 }
-                else
+            }
+            else
+            {
+                if (interfaceQuery && (0 != strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL)))
                 {
-                    if (interfaceQuery && (0 != strcmp(interfaceQuery, OC_RSRVD_INTERFACE_LL)))
+                    discPayload->uri = OICStrdup(OC_RSRVD_WELL_KNOWN_URI);
+                    VERIFY_NON_NULL(discPayload->uri, ERROR, OC_STACK_NO_MEMORY);
+                    if (savedDeviceInfo.deviceName)
                     {
-                        discPayload->uri = OICStrdup(OC_RSRVD_WELL_KNOWN_URI);
-                        VERIFY_NON_NULL(discPayload->uri, ERROR, OC_STACK_NO_MEMORY);
-                        if (savedDeviceInfo.deviceName)
-                        {
-                            discPayload->name = OICStrdup(savedDeviceInfo.deviceName);
-                            VERIFY_NON_NULL(discPayload->name, ERROR, OC_STACK_NO_MEMORY);
-                        }
-                        discPayload->type = (OCStringLL*)OICCalloc(1, sizeof(OCStringLL));
-                        VERIFY_NON_NULL(discPayload->type, ERROR, OC_STACK_NO_MEMORY);
-                        discPayload->type->value = OICStrdup(OC_RSRVD_RESOURCE_TYPE_RES);
-                        VERIFY_NON_NULL(discPayload->type->value, ERROR, OC_STACK_NO_MEMORY);
-                        OCResourcePayloadAddStringLL(&discPayload->iface, OC_RSRVD_INTERFACE_LL);
-                        OCResourcePayloadAddStringLL(&discPayload->iface, OC_RSRVD_INTERFACE_DEFAULT);
-                        VERIFY_NON_NULL(discPayload->iface, ERROR, OC_STACK_NO_MEMORY);
+                        discPayload->name = OICStrdup(savedDeviceInfo.deviceName);
+                        VERIFY_NON_NULL(discPayload->name, ERROR, OC_STACK_NO_MEMORY);
                     }
-                    for (;resource && discoveryResult == OC_STACK_OK; resource = resource->next)
-                    {
+                    discPayload->type = (OCStringLL*)OICCalloc(1, sizeof(OCStringLL));
+                    VERIFY_NON_NULL(discPayload->type, ERROR, OC_STACK_NO_MEMORY);
+                    discPayload->type->value = OICStrdup(OC_RSRVD_RESOURCE_TYPE_RES);
+                    VERIFY_NON_NULL(discPayload->type->value, ERROR, OC_STACK_NO_MEMORY);
+                    OCResourcePayloadAddStringLL(&discPayload->iface, OC_RSRVD_INTERFACE_LL);
+                    OCResourcePayloadAddStringLL(&discPayload->iface, OC_RSRVD_INTERFACE_DEFAULT);
+                    VERIFY_NON_NULL(discPayload->iface, ERROR, OC_STACK_NO_MEMORY);
+                }
+                for (;resource && discoveryResult == OC_STACK_OK; resource = resource->next)
+                {
 #ifdef RD_SERVER
-                        if (strcmp(resource->uri, OC_RSRVD_RD_URI) == 0)
-                        {
-                            if (OC_STACK_OK == OCRDDatabaseCheckResources(interfaceQuery, resourceTypeQuery, discPayload))
-                            {
-                                foundResourceAtRD = true;
-                                discoveryResult = OC_STACK_OK;
-                            }
-                        }
-#endif
-                        if (!foundResourceAtRD && includeThisResourceInResponse(resource, interfaceQuery, resourceTypeQuery))
+                    if (strcmp(resource->uri, OC_RSRVD_RD_URI) == 0)
+                    {
+                        if (OC_STACK_OK == OCRDDatabaseCheckResources(interfaceQuery, resourceTypeQuery, discPayload))
                         {
-                            discoveryResult = BuildVirtualResourceResponse(resource, discPayload, &request->devAddr);
+                            foundResourceAtRD = true;
+                            discoveryResult = OC_STACK_OK;
                         }
                     }
-                    // Set discoveryResult appropriately if no 'valid' resources are available
-                    if (discPayload->resources == NULL && !foundResourceAtRD)
+#endif
+                    if (!foundResourceAtRD && includeThisResourceInResponse(resource, interfaceQuery, resourceTypeQuery))
                     {
-                        discoveryResult = OC_STACK_NO_RESOURCE;
+                        discoveryResult = BuildVirtualResourceResponse(resource, discPayload, &request->devAddr);
                     }
                 }
-                if (discoveryResult == OC_STACK_OK && foundResourceAtRD == false)
+                // Set discoveryResult appropriately if no 'valid' resources are available
+                if (discPayload->resources == NULL && !foundResourceAtRD)
                 {
-                    discPayload->sid = (char *)OICCalloc(1, UUID_STRING_SIZE);
-                    VERIFY_NON_NULL(discPayload->sid, ERROR, OC_STACK_NO_MEMORY);
-
-                    const char* uid = OCGetServerInstanceIDString();
-                    if (uid)
-                    {
-                        memcpy(discPayload->sid, uid, UUID_STRING_SIZE);
-                    }
+                    discoveryResult = OC_STACK_NO_RESOURCE;
                 }
             }
-            else
+            if (discoveryResult == OC_STACK_OK && foundResourceAtRD == false)
             {
-                discoveryResult = OC_STACK_NO_MEMORY;
+                discPayload->sid = (char *)OICCalloc(1, UUID_STRING_SIZE);
+                VERIFY_NON_NULL(discPayload->sid, ERROR, OC_STACK_NO_MEMORY);
+
+                const char* uid = OCGetServerInstanceIDString();
+                if (uid)
+                {
+                    memcpy(discPayload->sid, uid, UUID_STRING_SIZE);
+                }
             }
+        }
+        else
+        {
+            discoveryResult = OC_STACK_NO_MEMORY;
+        }
 
+    }
+    else
+    {
+        OIC_LOG_V(ERROR, TAG, "Error (%d) parsing query.", discoveryResult);
+    }
+    if (interfaceQueryAllocated)
+    {
+        OICFree(interfaceQuery);
+    }
+
+    return discoveryResult;
+}
+
+static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource* resource)
+{
+    if (!request || !resource)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    OCStackResult discoveryResult = OC_STACK_ERROR;
+    OCPayload* payload = NULL;
+    const uint8_t *encodedPayload = NULL;
+    size_t encodedPayloadSize = 0;
+
+    OIC_LOG(INFO, TAG, "Entering HandleVirtualResource");
+
+    OCVirtualResources virtualUriInRequest = GetTypeOfVirtualURI (request->resourceUrl);
+
+    // Step 1: Generate the response to discovery request
+    if (virtualUriInRequest == OC_WELL_KNOWN_URI
+#ifdef MQ_BROKER
+            || virtualUriInRequest == OC_MQ_BROKER_URI
+#endif
+            )
+    {
+        if (request->method == OC_REST_PUT || request->method == OC_REST_POST || request->method == OC_REST_DELETE)
+        {
+            OIC_LOG_V(ERROR, TAG, "Resource : %s not permitted for method: %d", request->resourceUrl, request->method);
+            return OC_STACK_UNAUTHORIZED_REQ;
+        }
+
+        // cleared before the cache is dropped, so a later change is not lost
+        if (ATOMIC_LOAD_ACQUIRE(&discoveryCacheStale))
+        {
+            ATOMIC_STORE_RELEASE(&discoveryCacheStale, 0);
+            InvalidateDiscoveryCache();
+        }
+
+        bool cacheable = IsDiscoveryRequestCacheable(request);
+        DiscoveryCacheEntry *entry = NULL;
+        if (cacheable)
+        {
+            entry = FindDiscoveryCacheEntry(virtualUriInRequest, request);
+        }
+
+        if (entry)
+        {
+            discoveryCacheHits++;
+            discoveryResult = entry->result;
         }
         else
         {
-            OIC_LOG_V(ERROR, TAG, "Error (%d) parsing query.", discoveryResult);
+            discoveryCacheMisses++;
+
+            // Parsing the query modifies it, keep the original for the cache.
+            char *query = cacheable ? OICStrdup(request->query) : NULL;
+
+            discoveryResult = BuildDiscoveryPayload(request, resource, virtualUriInRequest,
+                                                    &payload);
+            if (query)
+            {
+                entry = AddDiscoveryCacheEntry(virtualUriInRequest, query, request,
+                                               discoveryResult, payload);
+                if (!entry)
+                {
+                    OICFree(query);
+                }
+            }
         }
-        if (interfaceQueryAllocated)
+
+        if (entry && OC_STACK_OK == discoveryResult)
         {
-            OICFree(interfaceQuery);
+            encodedPayload = entry->payload;
+            encodedPayloadSize = entry->payloadSize;
         }
     }
     else if (virtualUriInRequest == OC_DEVICE_URI)
@@ -863,7 +1126,11 @@ static OCStackResult HandleVirtualResource (OCServerRequest *request, OCResource
     if (OC_GATEWAY_URI != virtualUriInRequest)
 #endif
     {
-        if(discoveryResult == OC_STACK_OK)
+        if(discoveryResult == OC_STACK_OK && encodedPayload)
+        {
+            SendEncodedDiscoveryResponse(request, resource, encodedPayload, encodedPayloadSize);
+        }
+        else if(discoveryResult == OC_STACK_OK)
         {
             SendNonPersistantDiscoveryResponse(request, resource, payload, OC_EH_OK);
         }
@@ -1280,6 +1547,8 @@ void DeleteDeviceInfo()
     savedDeviceInfo.deviceName = NULL;
     savedDeviceInfo.specVersion = NULL;
     savedDeviceInfo.dataModelVersions = NULL;
+
+    InvalidateDiscoveryCache();
 }
 
 static OCStackResult DeepCopyDeviceInfo(OCDeviceInfo info)
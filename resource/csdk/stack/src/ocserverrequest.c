@@ -102,6 +102,7 @@ static void DeleteServerRequest(OCServerRequest * serverRequest)
     {
         LL_DELETE(serverRequestList, serverRequest);
         OICFree(serverRequest->requestToken);
+        OICFree(serverRequest->receivers);
         OICFree(serverRequest);
         serverRequest = NULL;
         OIC_LOG(INFO, TAG, "Server Request Removed!!");
@@ -350,6 +351,40 @@ exit:
     return OC_STACK_NO_MEMORY;
 }
 
+OCStackResult AddNotificationReceiver(OCServerRequest *request,
+        const CAToken_t token, uint8_t tokenLength,
+        OCQualityOfService qos, const OCDevAddr *devAddr)
+{
+    if (!request || !devAddr || tokenLength > CA_MAX_TOKEN_LEN || (tokenLength && !token))
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+
+    if (request->numReceivers == request->receiversSize)
+    {
+        uint32_t size = request->receiversSize ? request->receiversSize * 2 : 4;
+        OCNotificationReceiver *receivers = (OCNotificationReceiver *)
+                OICRealloc(request->receivers, size * sizeof(OCNotificationReceiver));
+        if (!receivers)
+        {
+            OIC_LOG(ERROR, TAG, "Memory alloc for receivers failed");
+            return OC_STACK_NO_MEMORY;
+        }
+        request->receivers = receivers;
+        request->receiversSize = size;
+    }
+
+    OCNotificationReceiver *receiver = &request->receivers[request->numReceivers++];
+    if (tokenLength)
+    {
+        memcpy(receiver->token, token, tokenLength);
+    }
+    receiver->tokenLength = tokenLength;
+    receiver->qos = qos;
+    receiver->devAddr = *devAddr;
+    return OC_STACK_OK;
+}
+
 OCStackResult FormOCEntityHandlerRequest(
         OCEntityHandlerRequest * entityHandlerRequest,
         OCRequestHandle request,
@@ -379,7 +414,7 @@ OCStackResult FormOCEntityHandlerRequest(
 
         if(payload && payloadSize)
         {
-            if(OCParsePayload(&entityHandlerRequest->payload, payloadType,
+            if(OCParseReceivedPayload(&entityHandlerRequest->payload, payloadType,
                         payload, payloadSize) != OC_STACK_OK)
             {
                 return OC_STACK_ERROR;
@@ -491,14 +526,92 @@ CAResponseResult_t ConvertEHResultToCAResult (OCEntityHandlerResult result, OCMe
 
 
 /**
- * Handler function for sending a response from a single resource
+ * Send a response to the endpoint. A response to the default adapter is sent
+ * on all adapters.
+ *
+ * @param responseEndpoint - remote endpoint
+ * @param responseInfo - response to send
+ *
+ * @return
+ *     OCStackResult
+ */
+static OCStackResult SendResponseOnAdapters(CAEndpoint_t *responseEndpoint,
+                                            CAResponseInfo_t *responseInfo)
+{
+#ifdef WITH_PRESENCE
+    CATransportAdapter_t CAConnTypes[] = {
+                            CA_ADAPTER_IP,
+                            CA_ADAPTER_GATT_BTLE,
+                            CA_ADAPTER_RFCOMM_BTEDR,
+                            CA_ADAPTER_NFC
+#ifdef RA_ADAPTER
+                            , CA_ADAPTER_REMOTE_ACCESS
+#endif
+                            , CA_ADAPTER_TCP
+                        };
+
+    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
+
+    CATransportAdapter_t adapter = responseEndpoint->adapter;
+    // Default adapter, try to send response out on all adapters.
+    if (adapter == CA_DEFAULT_ADAPTER)
+    {
+        adapter =
+            (CATransportAdapter_t)(
+                CA_ADAPTER_IP           |
+                CA_ADAPTER_GATT_BTLE    |
+                CA_ADAPTER_RFCOMM_BTEDR |
+                CA_ADAPTER_NFC
+#ifdef RA_ADAP
+                | CA_ADAPTER_REMOTE_ACCESS
+#endif
+                | CA_ADAPTER_TCP
+            );
+    }
+
+    OCStackResult result = OC_STACK_OK;
+    OCStackResult tempResult = OC_STACK_OK;
+
+    for(size_t i = 0; i < size; i++ )
+    {
+        responseEndpoint->adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
+        if(responseEndpoint->adapter)
+        {
+            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
+            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
+            tempResult = OCSendResponse(responseEndpoint, responseInfo);
+        }
+        if(OC_STACK_OK != tempResult)
+        {
+            result = tempResult;
+        }
+    }
+#else
+
+    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
+    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", responseEndpoint->addr);
+    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", responseEndpoint->adapter);
+    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo->result);
+    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo->info.resourceUri);
+
+    OCStackResult result = OCSendResponse(responseEndpoint, responseInfo);
+#endif
+    return result;
+}
+
+/**
+ * Sends a response from a single resource.
  *
  * @param ehResponse - pointer to the response from the resource
+ * @param encodedPayload - payload already encoded in CBOR, used instead of
+ *                         ehResponse->payload if not NULL. It is not freed.
+ * @param encodedPayloadSize - size of encodedPayload
  *
  * @return
  *     OCStackResult
  */
-OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+static OCStackResult SendSingleResponse(OCEntityHandlerResponse * ehResponse,
+                                        const uint8_t *encodedPayload, size_t encodedPayloadSize)
 {
     OCStackResult result = OC_STACK_ERROR;
     CAEndpoint_t responseEndpoint = {.adapter = CA_DEFAULT_ADAPTER};
@@ -618,8 +731,26 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
     responseInfo.info.payloadSize = 0;
     responseInfo.info.payloadFormat = CA_FORMAT_UNDEFINED;
 
+    uint8_t *convertedPayload = NULL;
+    if (encodedPayload)
+    {
+        switch(serverRequest->acceptFormat)
+        {
+            case OC_FORMAT_UNDEFINED:
+            case OC_FORMAT_CBOR:
+                responseInfo.info.payload = (CAPayload_t) encodedPayload;
+                responseInfo.info.payloadSize = encodedPayloadSize;
+                if (responseInfo.info.payloadSize > 0)
+                {
+                    responseInfo.info.payloadFormat = CA_FORMAT_APPLICATION_CBOR;
+                }
+                break;
+            default:
+                responseInfo.result = CA_NOT_ACCEPTABLE;
+        }
+    }
     // Put the JSON prefix and suffix around the payload
-    if(ehResponse->payload)
+    else if(ehResponse->payload)
     {
         if (ehResponse->payload->type == PAYLOAD_TYPE_PRESENCE)
         {
@@ -643,6 +774,7 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
                     OICFree(responseInfo.info.options);
                     return result;
                 }
+                convertedPayload = responseInfo.info.payload;
                 // Add CONTENT_FORMAT OPT if payload exist
                 if (responseInfo.info.payloadSize > 0)
                 {
@@ -654,72 +786,56 @@ OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
         }
     }
 
-#ifdef WITH_PRESENCE
-    CATransportAdapter_t CAConnTypes[] = {
-                            CA_ADAPTER_IP,
-                            CA_ADAPTER_GATT_BTLE,
-                            CA_ADAPTER_RFCOMM_BTEDR,
-                            CA_ADAPTER_NFC
-#ifdef RA_ADAPTER
-                            , CA_ADAPTER_REMOTE_ACCESS
-#endif
-                            , CA_ADAPTER_TCP
-                        };
-
-    size_t size = sizeof(CAConnTypes)/ sizeof(CATransportAdapter_t);
+    result = SendResponseOnAdapters(&responseEndpoint, &responseInfo);
 
-    CATransportAdapter_t adapter = responseEndpoint.adapter;
-    // Default adapter, try to send response out on all adapters.
-    if (adapter == CA_DEFAULT_ADAPTER)
+    // Send the encoded payload to the observers grouped with this notification.
+    for (uint32_t i = 0; i < serverRequest->numReceivers; i++)
     {
-        adapter =
-            (CATransportAdapter_t)(
-                CA_ADAPTER_IP           |
-                CA_ADAPTER_GATT_BTLE    |
-                CA_ADAPTER_RFCOMM_BTEDR |
-                CA_ADAPTER_NFC
-#ifdef RA_ADAP
-                | CA_ADAPTER_REMOTE_ACCESS
-#endif
-                | CA_ADAPTER_TCP
-            );
-    }
+        OCNotificationReceiver *receiver = &serverRequest->receivers[i];
 
-    result = OC_STACK_OK;
-    OCStackResult tempResult = OC_STACK_OK;
+        CopyDevAddrToEndpoint(&receiver->devAddr, &responseEndpoint);
+        responseInfo.info.type = (receiver->qos == OC_HIGH_QOS) ?
+                                 CA_MSG_CONFIRM : CA_MSG_NONCONFIRM;
+        memcpy(responseInfo.info.token, receiver->token, receiver->tokenLength);
+        responseInfo.info.tokenLength = receiver->tokenLength;
 
-    for(size_t i = 0; i < size; i++ )
-    {
-        responseEndpoint.adapter = (CATransportAdapter_t)(adapter & CAConnTypes[i]);
-        if(responseEndpoint.adapter)
-        {
-            //The result is set to OC_STACK_OK only if OCSendResponse succeeds in sending the
-            //response on all the n/w interfaces else it is set to OC_STACK_ERROR
-            tempResult = OCSendResponse(&responseEndpoint, &responseInfo);
-        }
-        if(OC_STACK_OK != tempResult)
+        OCStackResult tempResult = SendResponseOnAdapters(&responseEndpoint, &responseInfo);
+        if (OC_STACK_OK != tempResult)
         {
             result = tempResult;
         }
     }
-#else
-
-    OIC_LOG(INFO, TAG, "Calling OCSendResponse with:");
-    OIC_LOG_V(INFO, TAG, "\tEndpoint address: %s", responseEndpoint.addr);
-    OIC_LOG_V(INFO, TAG, "\tEndpoint adapter: %s", responseEndpoint.adapter);
-    OIC_LOG_V(INFO, TAG, "\tResponse result : %s", responseInfo.result);
-    OIC_LOG_V(INFO, TAG, "\tResponse for uri: %s", responseInfo.info.resourceUri);
-
-    result = OCSendResponse(&responseEndpoint, &responseInfo);
-#endif
 
-    OICFree(responseInfo.info.payload);
+    OICFree(convertedPayload);
     OICFree(responseInfo.info.options);
     //Delete the request
     FindAndDeleteServerRequest(serverRequest);
     return result;
 }
 
+/**
+ * Handler function for sending a response from a single resource
+ *
+ * @param ehResponse - pointer to the response from the resource
+ *
+ * @return
+ *     OCStackResult
+ */
+OCStackResult HandleSingleResponse(OCEntityHandlerResponse * ehResponse)
+{
+    return SendSingleResponse(ehResponse, NULL, 0);
+}
+
+OCStackResult HandleSingleEncodedResponse(OCEntityHandlerResponse * ehResponse,
+                                          const uint8_t *payload, size_t payloadSize)
+{
+    if (!payload)
+    {
+        return OC_STACK_INVALID_PARAM;
+    }
+    return SendSingleResponse(ehResponse, payload, payloadSize);
+}
+
 /**
  * Handler function for sending a response from multiple resources, such as a collection.
  * Aggregates responses from multiple resource until all responses are received then sends the
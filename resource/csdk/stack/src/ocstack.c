@@ -58,8 +58,10 @@
 #include "cainterface.h"
 #include "ocpayload.h"
 #include "ocpayloadcbor.h"
+#include "ocpayloadarena.h"
 #include "cautilinterface.h"
 #include "oicgroup.h"
+#include "uhashmap.h"
 
 #if defined (ROUTING_GATEWAY) || defined (ROUTING_EP)
 #include "routingutility.h"
@@ -117,6 +119,10 @@ static OCStackState stackState = OC_STACK_UNINITIALIZED;
 
 OCResource *headResource = NULL;
 static OCResource *tailResource = NULL;
+/** Resources of the list indexed by uri. */
+u_hashmap_t *resourceUriIndex = NULL;
+/** Resources of the list indexed by their own address, to validate handles. */
+static u_hashmap_t *resourceNodeIndex = NULL;
 static OCResourceHandle platformResource = {0};
 static OCResourceHandle deviceResource = {0};
 #ifdef MQ_BROKER
@@ -130,6 +136,13 @@ static uint8_t PresenceTimeOutSize = 0;
 static uint32_t PresenceTimeOut[] = {50, 75, 85, 95, 100};
 #endif
 
+/**
+ * Ticks at which OCProcess next has timer work, 0 for none. Updated by OCProcess
+ * and read by OCWaitForProcess, normally on the same thread. A stale value only
+ * moves one wakeup, which is bounded by the timeout of OCWaitForProcess.
+ */
+static uint32_t nextProcessTicks = 0;
+
 static OCMode myStackMode;
 #ifdef RA_ADAPTER
 //TODO: revisit this design
@@ -162,6 +175,12 @@ CAConnectionStateChangedCB g_connectionHandler = NULL;
 
 #define MILLISECONDS_PER_SECOND   (1000)
 
+/**
+ * Longest sleep of OCWaitForProcess while OCProcess has periodic work whose
+ * deadlines it does not track (keep alive, routing). Those run on second scales.
+ */
+#define MAX_PERIODIC_PROCESS_WAIT_MS   (1000)
+
 //-----------------------------------------------------------------------------
 // Private internal function prototypes
 //-----------------------------------------------------------------------------
@@ -183,9 +202,10 @@ static OCStackResult initResources();
 /**
  * Add a resource to the end of the linked list of resources.
  *
- * @param resource Resource to be added
+ * @param resource Resource to be added, with its uri set.
+ * @return ::OC_STACK_OK on success, ::OC_STACK_NO_MEMORY if it could not be indexed.
  */
-static void insertResource(OCResource *resource);
+static OCStackResult insertResource(OCResource *resource);
 
 /**
  * Find a resource in the linked list of resources.
@@ -1418,7 +1438,7 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                     return;
                 }
 
-                if(OC_STACK_OK != OCParsePayload(&response.payload,
+                if(OC_STACK_OK != OCParseReceivedPayload(&response.payload,
                             type,
                             responseInfo->info.payload,
                             responseInfo->info.payloadSize))
@@ -1491,8 +1511,8 @@ void OCHandleResponse(const CAEndpoint_t* endPoint, const CAResponseInfo_t* resp
                 else
                 {
                     // To keep discovery callbacks active.
-                    cbNode->TTL = GetTicks(MAX_CB_TIMEOUT_SECONDS *
-                                            MILLISECONDS_PER_SECOND);
+                    SetClientCBTTL(cbNode, GetTicks(MAX_CB_TIMEOUT_SECONDS *
+                                                    MILLISECONDS_PER_SECOND));
                 }
             }
 
@@ -2240,6 +2260,12 @@ OCStackResult OCInit1(OCMode mode, OCTransportFlags serverFlags, OCTransportFlag
     result = InitializeScheduleResourceList();
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
+    if (!OCPayloadArenaInitialize())
+    {
+        result = OC_STACK_NO_MEMORY;
+        goto exit;
+    }
+
     result = CAResultToOCResult(CAInitialize());
     VERIFY_SUCCESS(result, OC_STACK_OK);
 
@@ -2321,6 +2347,7 @@ exit:
         deleteAllResources();
         CATerminate();
         TerminateScheduleResourceList();
+        OCPayloadArenaTerminate();
         stackState = OC_STACK_UNINITIALIZED;
     }
     return result;
@@ -2378,6 +2405,7 @@ OCStackResult OCStop()
     DeleteObserverList();
     // Remove all the client callbacks
     DeleteClientCBList();
+    OCPayloadArenaTerminate();
 
     // De-init the SRM Policy Engine
     // TODO after BeachHead delivery: consolidate into single SRMDeInit()
@@ -3049,6 +3077,12 @@ OCStackResult OCRegisterPersistentStorageHandler(OCPersistentStorage* persistent
     return SRMRegisterPersistentStorageHandler(persistentStorageHandler);
 }
 
+OCStackResult OCEnablePersistentStorageJournal(bool enable)
+{
+    OIC_LOG_V(INFO, TAG, "EnablePersistentStorageJournal %d", enable);
+    return SRMEnablePersistentStorageJournal(enable);
+}
+
 #ifdef WITH_PRESENCE
 
 OCStackResult OCProcessPresence()
@@ -3146,6 +3180,48 @@ exit:
 }
 #endif // WITH_PRESENCE
 
+/**
+ * Pick the earlier of two tick deadlines, where 0 stands for none.
+ */
+static uint32_t EarlierTicks(uint32_t ticks, uint32_t otherTicks)
+{
+    if (0 == ticks || (otherTicks && otherTicks < ticks))
+    {
+        return otherTicks;
+    }
+    return ticks;
+}
+
+#ifdef WITH_PRESENCE
+/**
+ * Get the ticks at which OCProcessPresence next has to act on a presence callback.
+ *
+ * @param next  Earliest deadline found so far, 0 for none.
+ * @return the earlier of next and the presence deadlines.
+ */
+static uint32_t GetNextPresenceTicks(uint32_t next)
+{
+    ClientCB* cbNode = NULL;
+
+    LL_FOREACH(cbList, cbNode)
+    {
+        if (OC_REST_PRESENCE != cbNode->method || !cbNode->presence ||
+            cbNode->presence->TTLlevel > PresenceTimeOutSize)
+        {
+            continue;
+        }
+
+        if (cbNode->presence->TTLlevel == PresenceTimeOutSize)
+        {
+            // The timeout is reported on the next pass.
+            return GetTicks(0);
+        }
+        next = EarlierTicks(next, cbNode->presence->timeOut[cbNode->presence->TTLlevel]);
+    }
+    return next;
+}
+#endif // WITH_PRESENCE
+
 OCStackResult OCProcess()
 {
 #ifdef WITH_PRESENCE
@@ -3153,6 +3229,8 @@ OCStackResult OCProcess()
 #endif
     CAHandleRequestResponse();
 
+    DeleteTimedOutClientCBs();
+
 #ifdef ROUTING_GATEWAY
     RMProcess();
 #endif
@@ -3160,9 +3238,48 @@ OCStackResult OCProcess()
 #ifdef TCP_ADAPTER
     ProcessKeepAlive();
 #endif
+
+    uint32_t next = GetNextClientCBTTL();
+#ifdef WITH_PRESENCE
+    next = GetNextPresenceTicks(next);
+#endif
+#if defined(ROUTING_GATEWAY) || defined(TCP_ADAPTER)
+    next = EarlierTicks(next, GetTicks(MAX_PERIODIC_PROCESS_WAIT_MS));
+#endif
+    nextProcessTicks = next;
+
     return OC_STACK_OK;
 }
 
+OCStackResult OCWaitForProcess(uint32_t timeoutMs)
+{
+    uint32_t waitMs = timeoutMs;
+    if (nextProcessTicks)
+    {
+        uint32_t now = GetTicks(0);
+        if (nextProcessTicks < now)
+        {
+            return OC_STACK_OK;
+        }
+
+        // Timers fire once their ticks have passed, so wait one tick beyond.
+        uint64_t ticks = (uint64_t)(nextProcessTicks - now) + 1;
+        uint64_t timerMs = (ticks * MILLISECONDS_PER_SECOND + COAP_TICKS_PER_SECOND - 1) /
+                           COAP_TICKS_PER_SECOND;
+        if (timerMs < waitMs)
+        {
+            waitMs = (uint32_t)timerMs;
+        }
+    }
+
+    return CAResultToOCStackResult(CAWaitForRequestResponse(waitMs));
+}
+
+OCStackResult OCWakeUpProcess()
+{
+    return CAResultToOCStackResult(CAWakeUpRequestResponse());
+}
+
 #ifdef WITH_PRESENCE
 OCStackResult OCStartPresence(const uint32_t ttl)
 {
@@ -3352,21 +3469,11 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
         return OC_STACK_INVALID_PARAM;
     }
 
-    // If the headResource is NULL, then no resources have been created...
-    pointer = headResource;
-    if (pointer)
+    // Repeated URLs are not allowed.
+    if (u_hashmap_get(resourceUriIndex, uri))
     {
-        // At least one resources is in the resource list, so we need to search for
-        // repeated URLs, which are not allowed.  If a repeat is found, exit with an error
-        while (pointer)
-        {
-            if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-            {
-                OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
-                return OC_STACK_INVALID_PARAM;
-            }
-            pointer = pointer->next;
-        }
+        OIC_LOG_V(ERROR, TAG, "Resource %s already exists", uri);
+        return OC_STACK_INVALID_PARAM;
     }
     // Create the pointer and insert it into the resource list
     pointer = (OCResource *) OICCalloc(1, sizeof(OCResource));
@@ -3377,12 +3484,13 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
     }
     pointer->sequenceNum = OC_OFFSET_SEQUENCE_NUMBER;
 
-    insertResource(pointer);
-
-    // Set the uri
+    // Set the uri, which indexes the resource
     pointer->uri = OICStrdup(uri);
-    if (!pointer->uri)
+    if (!pointer->uri || OC_STACK_OK != insertResource(pointer))
     {
+        OICFree(pointer->uri);
+        OICFree(pointer);
+        pointer = NULL;
         result = OC_STACK_NO_MEMORY;
         goto exit;
     }
@@ -3434,7 +3542,7 @@ OCStackResult OCCreateResource(OCResourceHandle *handle,
     }
 #endif
 exit:
-    if (result != OC_STACK_OK)
+    if (result != OC_STACK_OK && pointer)
     {
         // Deep delete of resource and other dynamic elements that it contains
         deleteResource(pointer);
@@ -3500,6 +3608,7 @@ OCStackResult OCBindResource(
     }
 
     OIC_LOG(INFO, TAG, "resource bound");
+    InvalidateDiscoveryCache();
 
 #ifdef WITH_PRESENCE
     if (presenceResource.handle)
@@ -3574,6 +3683,7 @@ OCStackResult OCUnBindResource(
             }
 
             OIC_LOG(INFO, TAG, "resource unbound");
+            InvalidateDiscoveryCache();
 
             // Send notification when resource is unbounded successfully.
 #ifdef WITH_PRESENCE
@@ -3676,6 +3786,7 @@ OCStackResult BindResourceTypeToResource(OCResource* resource,
     pointer->next = NULL;
 
     insertResourceType(resource, pointer);
+    InvalidateDiscoveryCache();
     result = OC_STACK_OK;
 
 exit:
@@ -3722,6 +3833,7 @@ OCStackResult BindResourceInterfaceToResource(OCResource* resource,
 
     // Bind the resourceinterface to the resource
     insertResourceInterface(resource, pointer);
+    InvalidateDiscoveryCache();
 
     result = OC_STACK_OK;
 
@@ -4232,6 +4344,7 @@ OCStackResult OCChangeResourceProperty(OCResourceProperty * inputProperty,
     {
         *inputProperty = (OCResourceProperty) (*inputProperty | resourceProperties);
     }
+    InvalidateDiscoveryCache();
     return OC_STACK_OK;
 }
 #endif
@@ -4301,8 +4414,28 @@ OCStackResult initResources()
     return result;
 }
 
-void insertResource(OCResource *resource)
+OCStackResult insertResource(OCResource *resource)
 {
+    if (!resourceUriIndex)
+    {
+        resourceUriIndex = u_hashmap_create(u_hashmap_hash_string, u_hashmap_equal_string);
+    }
+    if (!resourceNodeIndex)
+    {
+        resourceNodeIndex = u_hashmap_create(u_hashmap_hash_pointer, u_hashmap_equal_pointer);
+    }
+    if (!resourceUriIndex || !resourceNodeIndex ||
+        !u_hashmap_put(resourceUriIndex, resource->uri, resource) ||
+        !u_hashmap_put(resourceNodeIndex, resource, resource))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to index resource");
+        if (resourceUriIndex && u_hashmap_get(resourceUriIndex, resource->uri) == resource)
+        {
+            u_hashmap_remove(resourceUriIndex, resource->uri);
+        }
+        return OC_STACK_NO_MEMORY;
+    }
+
     if (!headResource)
     {
         headResource = resource;
@@ -4314,21 +4447,13 @@ void insertResource(OCResource *resource)
         tailResource = resource;
     }
     resource->next = NULL;
+    InvalidateDiscoveryCache();
+    return OC_STACK_OK;
 }
 
 OCResource *findResource(OCResource *resource)
 {
-    OCResource *pointer = headResource;
-
-    while (pointer)
-    {
-        if (pointer == resource)
-        {
-            return resource;
-        }
-        pointer = pointer->next;
-    }
-    return NULL;
+    return (OCResource *) u_hashmap_get(resourceNodeIndex, resource);
 }
 
 void deleteAllResources()
@@ -4363,6 +4488,9 @@ void deleteAllResources()
     deleteResource((OCResource *) presenceResource.handle);
     memset(&presenceResource, 0, sizeof(presenceResource));
 #endif // WITH_PRESENCE
+
+    u_hashmap_free(&resourceUriIndex);
+    u_hashmap_free(&resourceNodeIndex);
 }
 
 OCStackResult deleteResource(OCResource *resource)
@@ -4375,6 +4503,11 @@ OCStackResult deleteResource(OCResource *resource)
         return OC_STACK_INVALID_PARAM;
     }
 
+    if (!findResource(resource))
+    {
+        return OC_STACK_ERROR;
+    }
+
     OIC_LOG_V (INFO, TAG, "Deleting resource %s", resource->uri);
 
     temp = headResource;
@@ -4420,6 +4553,10 @@ OCStackResult deleteResource(OCResource *resource)
                 prev->next = temp->next;
             }
 
+            u_hashmap_remove(resourceUriIndex, temp->uri);
+            u_hashmap_remove(resourceNodeIndex, temp);
+            InvalidateDiscoveryCache();
+
             deleteResourceElements(temp);
             OICFree(temp);
             return OC_STACK_OK;
@@ -4801,6 +4938,9 @@ CAResult_t OCSelectNetwork()
         }
     }
 
+    // the ports in the discovery responses depend on the selected networks
+    InvalidateDiscoveryCache();
+
     if (retResult != CA_STATUS_OK)
     {
         return caResult; // Returns error of appropriate transport that failed fatally.
@@ -4882,6 +5022,7 @@ OCStackResult OCBindResourceInsToResource(OCResourceHandle handle, uint8_t ins)
     }
 
     resource->ins = ins;
+    InvalidateDiscoveryCache();
 
     return OC_STACK_OK;
 }
@@ -4894,18 +5035,12 @@ OCResourceHandle OCGetResourceHandleAtUri(const char *uri)
         return NULL;
     }
 
-    OCResource *pointer = headResource;
-
-    while (pointer)
+    OCResource *pointer = (OCResource *) u_hashmap_get(resourceUriIndex, uri);
+    if (pointer)
     {
-        if (strncmp(uri, pointer->uri, MAX_URI_LENGTH) == 0)
-        {
-            OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
-            return pointer;
-        }
-        pointer = pointer->next;
+        OIC_LOG_V(DEBUG, TAG, "Found Resource %s", uri);
     }
-    return NULL;
+    return pointer;
 }
 
 OCStackResult OCGetResourceIns(OCResourceHandle handle, uint8_t *ins)
@@ -5007,6 +5142,10 @@ OCStackResult OCGetHeaderOption(OCHeaderOption* ocHdrOpt, size_t numOptions, uin
 void OCDefaultAdapterStateChangedHandler(CATransportAdapter_t adapter, bool enabled)
 {
     OIC_LOG(DEBUG, TAG, "OCDefaultAdapterStateChangedHandler");
+
+    // interfaces and ports in the discovery responses may have changed
+    MarkDiscoveryCacheStale();
+
     if (g_adapterHandler)
     {
         g_adapterHandler(adapter, enabled);
@@ -5061,3 +5200,14 @@ OCStackResult OCSetDeviceId(const OCUUIdentity *deviceId)
     ret = SetDoxmDeviceID(&oicUuid);
     return ret;
 }
+
+OCStackResult OCSetTlsSessionCacheConfig(uint32_t maxEntries, uint32_t lifetime)
+{
+#ifdef __WITH_TLS__
+    return CAResultToOCResult(CAsetTlsSessionCacheConfig(maxEntries, lifetime));
+#else
+    OC_UNUSED(maxEntries);
+    OC_UNUSED(lifetime);
+    return OC_STACK_NOTIMPL;
+#endif
+}
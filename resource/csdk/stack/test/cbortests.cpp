@@ -24,6 +24,7 @@ extern "C"
     #include "ocstack.h"
     #include "ocpayload.h"
     #include "ocpayloadcbor.h"
+    #include "ocpayloadarena.h"
     #include "logger.h"
     #include "oic_malloc.h"
 }
@@ -222,3 +223,135 @@ TEST_F(CborByteStringTest, ByteStringArrayConvertParseTest )
 
     OCPayloadDestroy((OCPayload*)payload_out);
 }
+
+TEST_F(CborByteStringTest, ByteStringLargeConvertParseTest)
+{
+    OCRepPayloadSetUri(payload_in, "/a/quake_sensor");
+
+    // Larger than the initial encode buffer, and than the buffer a thread keeps
+    uint8_t *binval = (uint8_t*)OICMalloc(20000);
+    ASSERT_TRUE(binval != NULL);
+    for (size_t i = 0; i < 20000; i++)
+    {
+        binval[i] = (uint8_t)i;
+    }
+
+    for (size_t len = 16; len <= 20000; len *= 5)
+    {
+        OCByteString quakedata_in = { binval, len };
+        EXPECT_EQ(true, OCRepPayloadSetPropByteString(payload_in, "quakedata", quakedata_in));
+
+        // Converting twice reuses the encode buffer and gives the same result
+        uint8_t *payload_cbor = NULL;
+        size_t payload_cbor_size = 0;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor,
+                    &payload_cbor_size));
+        uint8_t *payload_cbor2 = NULL;
+        size_t payload_cbor2_size = 0;
+        EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor2,
+                    &payload_cbor2_size));
+        ASSERT_EQ(payload_cbor_size, payload_cbor2_size);
+        EXPECT_EQ(0, memcmp(payload_cbor, payload_cbor2, payload_cbor_size));
+
+        OCPayload* payload_out = NULL;
+        EXPECT_EQ(OC_STACK_OK, OCParsePayload(&payload_out, PAYLOAD_TYPE_REPRESENTATION,
+                    payload_cbor, payload_cbor_size));
+
+        OCByteString quakedata_out = { NULL, 0};
+        ASSERT_EQ(true, OCRepPayloadGetPropByteString((OCRepPayload*)payload_out, "quakedata",
+                    &quakedata_out));
+        EXPECT_EQ(quakedata_in.len, quakedata_out.len);
+        EXPECT_EQ(0, memcmp(quakedata_in.bytes, quakedata_out.bytes, quakedata_in.len));
+
+        // Cleanup
+        OICFree(quakedata_out.bytes);
+        OICFree(payload_cbor);
+        OICFree(payload_cbor2);
+        OCPayloadDestroy((OCPayload*)payload_out);
+    }
+
+    OICFree(binval);
+}
+
+TEST_F(CborByteStringTest, ByteStringArenaConvertParseTest)
+{
+    OCRepPayloadSetUri(payload_in, "/a/quake_sensor");
+    OCRepPayloadAddResourceType(payload_in, "core.sensor");
+    OCRepPayloadSetPropInt(payload_in, "scale", 4);
+    OCRepPayloadSetPropString(payload_in, "name", "quake");
+
+    uint8_t binval[] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77};
+    OCByteString quakedata_in = { binval, sizeof(binval) };
+    EXPECT_EQ(true, OCRepPayloadSetPropByteString(payload_in, "quakedata", quakedata_in));
+
+    const char *tags[] = { "north", "south", "east" };
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {3, 0, 0};
+    EXPECT_EQ(true, OCRepPayloadSetStringArray(payload_in, "tags", tags, dimensions));
+
+    OCRepPayload *location = OCRepPayloadCreate();
+    ASSERT_TRUE(location != NULL);
+    OCRepPayloadSetPropDouble(location, "lat", 37.5);
+    EXPECT_EQ(true, OCRepPayloadSetPropObjectAsOwner(payload_in, "location", location));
+
+    uint8_t *payload_cbor = NULL;
+    size_t payload_cbor_size = 0;
+    EXPECT_EQ(OC_STACK_OK, OCConvertPayload((OCPayload*) payload_in, &payload_cbor,
+                &payload_cbor_size));
+
+    OCRepPayloadSetArenaParsing(true);
+    OCPayload* payload_out = NULL;
+    EXPECT_EQ(OC_STACK_OK, OCParseReceivedPayload(&payload_out, PAYLOAD_TYPE_REPRESENTATION,
+                payload_cbor, payload_cbor_size));
+    OCRepPayloadSetArenaParsing(false);
+    ASSERT_TRUE(payload_out != NULL);
+
+    OCRepPayload *rep = (OCRepPayload*)payload_out;
+    EXPECT_TRUE(OCPayloadArenaFind(rep) != NULL);
+    EXPECT_STREQ("/a/quake_sensor", rep->uri);
+    ASSERT_TRUE(rep->types != NULL);
+    EXPECT_STREQ("core.sensor", rep->types->value);
+
+    int64_t scale = 0;
+    EXPECT_EQ(true, OCRepPayloadGetPropInt(rep, "scale", &scale));
+    EXPECT_EQ(4, scale);
+
+    char *name = NULL;
+    EXPECT_EQ(true, OCRepPayloadGetPropString(rep, "name", &name));
+    EXPECT_STREQ("quake", name);
+    OICFree(name);
+
+    OCByteString quakedata_out = { NULL, 0};
+    ASSERT_EQ(true, OCRepPayloadGetPropByteString(rep, "quakedata", &quakedata_out));
+    EXPECT_EQ(quakedata_in.len, quakedata_out.len);
+    EXPECT_EQ(0, memcmp(quakedata_in.bytes, quakedata_out.bytes, quakedata_in.len));
+    OICFree(quakedata_out.bytes);
+
+    char **tags_out = NULL;
+    size_t dimensions_out[MAX_REP_ARRAY_DEPTH] = {0};
+    ASSERT_EQ(true, OCRepPayloadGetStringArray(rep, "tags", &tags_out, dimensions_out));
+    EXPECT_EQ(3u, dimensions_out[0]);
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_STREQ(tags[i], tags_out[i]);
+        OICFree(tags_out[i]);
+    }
+    OICFree(tags_out);
+
+    // Nested objects are handed out as heap copies that can be modified
+    OCRepPayload *location_out = NULL;
+    ASSERT_EQ(true, OCRepPayloadGetPropObject(rep, "location", &location_out));
+    double lat = 0;
+    EXPECT_EQ(true, OCRepPayloadGetPropDouble(location_out, "lat", &lat));
+    EXPECT_EQ(37.5, lat);
+    EXPECT_TRUE(OCPayloadArenaFind(location_out) == NULL);
+    EXPECT_EQ(true, OCRepPayloadSetPropInt(location_out, "alt", 12));
+    OCRepPayloadDestroy(location_out);
+
+    // The arena payload itself is read only
+    EXPECT_EQ(false, OCRepPayloadSetPropInt(rep, "scale", 5));
+    EXPECT_EQ(false, OCRepPayloadSetUri(rep, "/a/other"));
+
+    // Cleanup
+    OICFree(payload_cbor);
+    OCPayloadDestroy(payload_out);
+}
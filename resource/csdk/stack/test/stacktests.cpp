@@ -24,8 +24,11 @@ extern "C"
     #include "ocpayload.h"
     #include "ocstack.h"
     #include "ocstackinternal.h"
+    #include "ocresourcehandler.h"
+    #include "ocobserve.h"
     #include "logger.h"
     #include "oic_malloc.h"
+    #include "oic_string.h"
 }
 
 #include "gtest/gtest.h"
@@ -44,8 +47,10 @@ extern "C"
 #include <stdio.h>
 #include <string.h>
 
+#include <atomic>
 #include <iostream>
 #include <stdint.h>
+#include <thread>
 
 #include "gtest_helper.h"
 
@@ -69,6 +74,9 @@ static char pinNumber;
 static OCDPDev_t peer;
 
 std::chrono::seconds const SHORT_TEST_TIMEOUT = std::chrono::seconds(5);
+std::chrono::seconds const BENCHMARK_TEST_TIMEOUT = std::chrono::seconds(60);
+
+static uint32_t gNotifyHandlerCalls = 0;
 
 //-----------------------------------------------------------------------------
 // Callback functions
@@ -141,6 +149,33 @@ OCEntityHandlerResult entityHandler(OCEntityHandlerFlag /*flag*/,
     return OC_EH_OK;
 }
 
+OCEntityHandlerResult notifyEntityHandler(OCEntityHandlerFlag flag,
+        OCEntityHandlerRequest *entityHandlerRequest,
+        void* /*callbackParam*/)
+{
+    if (!(flag & OC_REQUEST_FLAG))
+    {
+        return OC_EH_OK;
+    }
+    gNotifyHandlerCalls++;
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    OCRepPayloadSetUri(payload, "/a/sensor");
+    OCRepPayloadSetPropInt(payload, "temperature", 21);
+    OCRepPayloadSetPropString(payload, "units", "C");
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.requestHandle = entityHandlerRequest->requestHandle;
+    response.resourceHandle = entityHandlerRequest->resource;
+    response.ehResult = OC_EH_OK;
+    response.payload = (OCPayload *) payload;
+    OCStackResult result = OCDoResponse(&response);
+    OCRepPayloadDestroy(payload);
+
+    return OC_STACK_OK == result ? OC_EH_OK : OC_EH_ERROR;
+}
+
 //-----------------------------------------------------------------------------
 //  Local functions
 //-----------------------------------------------------------------------------
@@ -175,6 +210,152 @@ uint8_t InitResourceIndex()
     return 0;
 #endif
 }
+/**
+ * Passes a GET /oic/res from a local client to the stack as if it had been received.
+ */
+OCStackResult SendDiscoveryRequest()
+{
+    static uint8_t requestCount = 0;
+    char token[] = { 'c', 'a', 'c', 'h', 'e', 't', 's', (char) ++requestCount };
+
+    OCServerProtocolRequest request;
+    memset(&request, 0, sizeof(request));
+    request.method = OC_REST_GET;
+    request.acceptFormat = OC_FORMAT_CBOR;
+    OICStrcpy(request.resourceUrl, sizeof(request.resourceUrl), OC_RSRVD_WELL_KNOWN_URI);
+    request.qos = OC_LOW_QOS;
+    request.devAddr.adapter = OC_ADAPTER_IP;
+    request.devAddr.flags = OC_IP_USE_V4;
+    OICStrcpy(request.devAddr.addr, sizeof(request.devAddr.addr), "127.0.0.1");
+    request.devAddr.port = 5683;
+    request.requestToken = token;
+    request.tokenLength = sizeof(token);
+    request.coapID = requestCount;
+    request.observationOption = OC_OBSERVE_NO_OPTION;
+
+    return HandleStackRequests(&request);
+}
+
+void ExpectDiscoveryCacheCounters(uint32_t expectedHits, uint32_t expectedMisses)
+{
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    EXPECT_EQ(OC_STACK_OK, OCGetDiscoveryCacheCounters(&hits, &misses));
+    EXPECT_EQ(expectedHits, hits);
+    EXPECT_EQ(expectedMisses, misses);
+}
+
+/**
+ * Checks that the next discovery request misses the cache and the one after hits it.
+ */
+void ExpectDiscoveryCacheMiss()
+{
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    EXPECT_EQ(OC_STACK_OK, OCGetDiscoveryCacheCounters(&hits, &misses));
+    EXPECT_EQ(OC_STACK_OK, SendDiscoveryRequest());
+    ExpectDiscoveryCacheCounters(hits, misses + 1);
+    EXPECT_EQ(OC_STACK_OK, SendDiscoveryRequest());
+    ExpectDiscoveryCacheCounters(hits + 1, misses + 1);
+}
+
+/**
+ * Registers observers of @p resource until it has @p count of them, each one
+ * with its own token and loopback port.
+ */
+void AddLoopbackObservers(OCResource *resource, uint32_t first, uint32_t count)
+{
+    for (uint32_t i = first; i < count; i++)
+    {
+        char token[] = { 'o', 'b', 's', (char) (i >> 16), (char) (i >> 8), (char) i };
+
+        OCDevAddr devAddr;
+        memset(&devAddr, 0, sizeof(devAddr));
+        devAddr.adapter = OC_ADAPTER_IP;
+        devAddr.flags = OC_IP_USE_V4;
+        OICStrcpy(devAddr.addr, sizeof(devAddr.addr), "127.0.0.1");
+        devAddr.port = (uint16_t) (40000 + i);
+
+        OCObservationId obsId = 0;
+        EXPECT_EQ(OC_STACK_OK, GenerateObserverId(&obsId));
+        EXPECT_EQ(OC_STACK_OK, AddObserver(resource->uri, NULL, obsId, token, sizeof(token),
+                                           resource, OC_LOW_QOS, OC_FORMAT_CBOR, &devAddr));
+    }
+}
+
+/**
+ * Chain of GET requests to a resource of the same stack, each one sent from
+ * the response callback of the previous one.
+ */
+typedef struct
+{
+    OCDevAddr server;
+    int remaining;
+    std::atomic<bool> done;
+} RoundTrips;
+
+OCStackResult SendRoundTrip(RoundTrips *roundTrips);
+
+extern "C" OCStackApplicationResult roundTripCallback(void* ctx,
+        OCDoHandle /*handle*/, OCClientResponse * clientResponse)
+{
+    RoundTrips *roundTrips = (RoundTrips *) ctx;
+    EXPECT_EQ(OC_STACK_OK, clientResponse->result);
+
+    if (--roundTrips->remaining <= 0 || OC_STACK_OK != SendRoundTrip(roundTrips))
+    {
+        roundTrips->done = true;
+    }
+    return OC_STACK_DELETE_TRANSACTION;
+}
+
+OCStackResult SendRoundTrip(RoundTrips *roundTrips)
+{
+    OCCallbackData cbData;
+    cbData.cb = roundTripCallback;
+    cbData.context = roundTrips;
+    cbData.cd = NULL;
+
+    return OCDoResource(NULL, OC_REST_GET, "/a/sensor", &roundTrips->server, NULL,
+                        CT_ADAPTER_IP, OC_LOW_QOS, &cbData, NULL, 0);
+}
+
+/**
+ * Runs @p count loopback round trips from the OCProcess() loop and returns
+ * the mean round trip time in microseconds. The loop either sleeps 10 ms
+ * between calls, as the C++ wrapper used to, or waits in OCWaitForProcess().
+ */
+double MeasureRoundTrips(int count, bool waitForProcess)
+{
+    RoundTrips roundTrips;
+    memset(&roundTrips.server, 0, sizeof(roundTrips.server));
+    roundTrips.server.adapter = OC_ADAPTER_IP;
+    roundTrips.server.flags = OC_IP_USE_V4;
+    OICStrcpy(roundTrips.server.addr, sizeof(roundTrips.server.addr), "127.0.0.1");
+    roundTrips.server.port = caglobals.ip.u4.port;
+    roundTrips.remaining = count;
+    roundTrips.done = false;
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(OC_STACK_OK, SendRoundTrip(&roundTrips));
+    while (!roundTrips.done)
+    {
+        if (waitForProcess)
+        {
+            EXPECT_EQ(OC_STACK_OK, OCWaitForProcess(100));
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_EQ(OC_STACK_OK, OCProcess());
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(0, roundTrips.remaining);
+    return std::chrono::duration<double, std::micro>(elapsed).count() / count;
+}
+
 //-----------------------------------------------------------------------------
 //  Tests
 //-----------------------------------------------------------------------------
@@ -1702,6 +1883,180 @@ TEST(StackResourceAccess, DeleteMiddleResource)
     EXPECT_EQ(OC_STACK_OK, OCStop());
 }
 
+TEST(StackResourceAccess, FindResourceByUri)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+    OIC_LOG(INFO, TAG, "Starting FindResourceByUri test");
+    InitStack(OC_SERVER);
+
+    const int numCreated = 100;
+    OCResourceHandle handles[numCreated];
+    for (int i = 0; i < numCreated; ++i)
+    {
+        char uri[MAX_URI_LENGTH];
+        snprintf(uri, sizeof(uri), "/a/led%d", i);
+        EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handles[i],
+                                                "core.led",
+                                                "core.rw",
+                                                uri,
+                                                0,
+                                                NULL,
+                                                OC_DISCOVERABLE|OC_OBSERVABLE));
+    }
+
+    EXPECT_EQ((OCResource *) handles[0], FindResourceByUri("/a/led0"));
+    EXPECT_EQ((OCResource *) handles[50], FindResourceByUri("/a/led50"));
+    EXPECT_EQ((OCResource *) handles[99], FindResourceByUri("/a/led99"));
+    EXPECT_EQ(NULL, FindResourceByUri("/a/led100"));
+    EXPECT_EQ(NULL, FindResourceByUri(NULL));
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(handles[50]));
+    EXPECT_EQ(NULL, FindResourceByUri("/a/led50"));
+    EXPECT_EQ(OC_STACK_NO_RESOURCE, OCDeleteResource(handles[50]));
+
+    // The uri is free again after deletion.
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handles[50],
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led50",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    EXPECT_EQ((OCResource *) handles[50], FindResourceByUri("/a/led50"));
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+TEST(StackResourceAccess, DiscoveryCacheCounters)
+{
+    itst::DeadmanTimer killSwitch(SHORT_TEST_TIMEOUT);
+
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCGetDiscoveryCacheCounters(NULL, &misses));
+    EXPECT_EQ(OC_STACK_INVALID_PARAM, OCGetDiscoveryCacheCounters(&hits, NULL));
+
+    InitStack(OC_SERVER);
+
+    OCResourceHandle led;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&led,
+                                            "core.led",
+                                            "core.rw",
+                                            "/a/led",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    // The first request builds the response, a repeated one is answered from the cache.
+    EXPECT_EQ(OC_STACK_OK, OCGetDiscoveryCacheCounters(&hits, &misses));
+    EXPECT_EQ(OC_STACK_OK, SendDiscoveryRequest());
+    ExpectDiscoveryCacheCounters(hits, misses + 1);
+
+    EXPECT_EQ(OC_STACK_OK, OCGetDiscoveryCacheCounters(&hits, &misses));
+    EXPECT_EQ(OC_STACK_OK, SendDiscoveryRequest());
+    ExpectDiscoveryCacheCounters(hits + 1, misses);
+
+    // Every change to the resources invalidates the cached responses.
+    OCResourceHandle fan;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&fan,
+                                            "core.fan",
+                                            "core.rw",
+                                            "/a/fan",
+                                            0,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+    ExpectDiscoveryCacheMiss();
+
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceTypeToResource(led, "core.brightled"));
+    ExpectDiscoveryCacheMiss();
+
+    EXPECT_EQ(OC_STACK_OK, OCBindResourceInterfaceToResource(led, "oic.if.r"));
+    ExpectDiscoveryCacheMiss();
+
+    EXPECT_EQ(OC_STACK_OK, OCBindResource(led, fan));
+    ExpectDiscoveryCacheMiss();
+
+    EXPECT_EQ(OC_STACK_OK, OCUnBindResource(led, fan));
+    ExpectDiscoveryCacheMiss();
+
+    EXPECT_EQ(OC_STACK_OK, OCDeleteResource(fan));
+    ExpectDiscoveryCacheMiss();
+
+    // So does a change of the network reported by an adapter thread.
+    MarkDiscoveryCacheStale();
+    ExpectDiscoveryCacheMiss();
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+// Measures notifications per second against the number of observers. Observers
+// sharing the accept format and query get one entity handler call per notify.
+TEST(StackObserve, NotificationFanOutBenchmark)
+{
+    itst::DeadmanTimer killSwitch(BENCHMARK_TEST_TIMEOUT);
+    InitStack(OC_SERVER);
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.sensor",
+                                            "core.r",
+                                            "/a/sensor",
+                                            notifyEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE|OC_OBSERVABLE));
+
+    const uint32_t observerCounts[] = { 1, 10, 100, 500 };
+    const uint32_t notifies = 20;
+    uint32_t observers = 0;
+    for (size_t i = 0; i < sizeof(observerCounts) / sizeof(observerCounts[0]); i++)
+    {
+        AddLoopbackObservers((OCResource *) handle, observers, observerCounts[i]);
+        observers = observerCounts[i];
+        gNotifyHandlerCalls = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t n = 0; n < notifies; n++)
+        {
+            EXPECT_EQ(OC_STACK_OK, OCNotifyAllObservers(handle, OC_LOW_QOS));
+        }
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start).count();
+        EXPECT_EQ(notifies, gNotifyHandlerCalls);
+
+        std::cout << observers << " observers: " << observers * notifies / seconds
+                  << " notifications/s" << std::endl;
+    }
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
+// Measures the round trip time of a GET over loopback with a polling
+// OCProcess() loop and with one that waits for work.
+TEST(StackProcess, LoopbackRoundTripBenchmark)
+{
+    itst::DeadmanTimer killSwitch(BENCHMARK_TEST_TIMEOUT);
+    EXPECT_EQ(OC_STACK_OK, OCInit(NULL, 0, OC_CLIENT_SERVER));
+
+    OCResourceHandle handle;
+    EXPECT_EQ(OC_STACK_OK, OCCreateResource(&handle,
+                                            "core.sensor",
+                                            "core.r",
+                                            "/a/sensor",
+                                            notifyEntityHandler,
+                                            NULL,
+                                            OC_DISCOVERABLE));
+
+    const int roundTrips = 50;
+    double polled = MeasureRoundTrips(roundTrips, false);
+    double waited = MeasureRoundTrips(roundTrips, true);
+    EXPECT_LT(waited, polled);
+
+    std::cout << "round trip with 10 ms polling: " << polled << " us, "
+              << "with OCWaitForProcess: " << waited << " us" << std::endl;
+
+    EXPECT_EQ(OC_STACK_OK, OCStop());
+}
+
 // Visual Studio versions earlier than 2015 have bugs in is_pod and report the wrong answer.
 #if !defined(_MSC_VER) || (_MSC_VER >= 1900)
 TEST(PODTests, OCHeaderOption)
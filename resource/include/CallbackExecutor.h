@@ -0,0 +1,99 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ *
+ * This file contains the declaration of the thread pool that runs client callbacks.
+ */
+
+#ifndef OC_CALLBACK_EXECUTOR_H_
+#define OC_CALLBACK_EXECUTOR_H_
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace OC
+{
+    /**
+     * Fixed size work-stealing thread pool for client callbacks.
+     *
+     * Every worker has its own queue and takes work from the other queues when
+     * its own is empty. Tasks posted with the same key run one after another in
+     * posting order, which keeps e.g. the notifications of one observation in
+     * sequence. Tasks without a key run in any order, possibly concurrently.
+     *
+     * A callback that blocks holds up a worker, so the pool should have more
+     * threads than callbacks that are expected to block at the same time.
+     */
+    class CallbackExecutor
+    {
+        public:
+            typedef std::function<void()> Task;
+
+            /**
+             * Start the workers.
+             *
+             * @param threadCount Number of worker threads, 0 for one per hardware thread.
+             */
+            explicit CallbackExecutor(unsigned int threadCount = 0);
+
+            /**
+             * Run the tasks that are still queued, then stop the workers.
+             */
+            ~CallbackExecutor();
+
+            CallbackExecutor(const CallbackExecutor&) = delete;
+            CallbackExecutor& operator=(const CallbackExecutor&) = delete;
+
+            /**
+             * Queue a task that may run in any order.
+             *
+             * @param task Task to run on a worker.
+             */
+            void post(Task task);
+
+            /**
+             * Queue a task that runs after the previously posted tasks of the same key.
+             *
+             * @param key  Identifies the sequence, nullptr for no ordering. Only the
+             *             address is used, it is never dereferenced.
+             * @param task Task to run on a worker.
+             */
+            void post(const void* key, Task task);
+
+            /**
+             * @return Number of worker threads.
+             */
+            unsigned int threadCount() const;
+
+        private:
+            struct State;
+
+            // Shared with the workers, so a worker can outlive the executor when
+            // it drops the last reference from inside a callback.
+            std::shared_ptr<State> m_state;
+            std::vector<std::thread> m_threads;
+    };
+}
+
+#endif // OC_CALLBACK_EXECUTOR_H_
@@ -27,6 +27,7 @@
 #include <iostream>
 
 #include <OCApi.h>
+#include <CallbackExecutor.h>
 #include <IClientWrapper.h>
 #include <InitializeException.h>
 #include <ResourceInitException.h>
@@ -35,78 +36,97 @@ namespace OC
 {
     namespace ClientCallbackContext
     {
-        struct GetContext
+        /**
+         * Executor the callbacks of a context run on, null to run each on a new thread.
+         */
+        struct CallbackContext
+        {
+            std::shared_ptr<CallbackExecutor> executor;
+            CallbackContext(std::shared_ptr<CallbackExecutor> ex) : executor(ex){}
+        };
+
+        struct GetContext : public CallbackContext
         {
             GetCallback callback;
-            GetContext(GetCallback cb) : callback(cb){}
+            GetContext(GetCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : CallbackContext(ex), callback(cb){}
         };
 
-        struct SetContext
+        struct SetContext : public CallbackContext
         {
             PutCallback callback;
-            SetContext(PutCallback cb) : callback(cb){}
+            SetContext(PutCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : CallbackContext(ex), callback(cb){}
         };
 
-        struct ListenContext
+        struct ListenContext : public CallbackContext
         {
             FindCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
 
-            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            ListenContext(FindCallback cb, std::weak_ptr<IClientWrapper> cw,
+                          std::shared_ptr<CallbackExecutor> ex)
+                : CallbackContext(ex), callback(cb), clientWrapper(cw){}
         };
 
-        struct ListenErrorContext
+        struct ListenErrorContext : public CallbackContext
         {
             FindCallback callback;
             FindErrorCallback errorCallback;
             std::weak_ptr<IClientWrapper> clientWrapper;
 
             ListenErrorContext(FindCallback cb1, FindErrorCallback cb2,
-                               std::weak_ptr<IClientWrapper> cw)
-                : callback(cb1), errorCallback(cb2), clientWrapper(cw){}
+                               std::weak_ptr<IClientWrapper> cw,
+                               std::shared_ptr<CallbackExecutor> ex)
+                : CallbackContext(ex), callback(cb1), errorCallback(cb2), clientWrapper(cw){}
         };
 
-        struct DeviceListenContext
+        struct DeviceListenContext : public CallbackContext
         {
             FindDeviceCallback callback;
             IClientWrapper::Ptr clientWrapper;
-            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw)
-                    : callback(cb), clientWrapper(cw){}
+            DeviceListenContext(FindDeviceCallback cb, IClientWrapper::Ptr cw,
+                                std::shared_ptr<CallbackExecutor> ex)
+                    : CallbackContext(ex), callback(cb), clientWrapper(cw){}
         };
 
-        struct SubscribePresenceContext
+        struct SubscribePresenceContext : public CallbackContext
         {
             SubscribeCallback callback;
-            SubscribePresenceContext(SubscribeCallback cb) : callback(cb){}
+            SubscribePresenceContext(SubscribeCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : CallbackContext(ex), callback(cb){}
         };
 
-        struct DeleteContext
+        struct DeleteContext : public CallbackContext
         {
             DeleteCallback callback;
-            DeleteContext(DeleteCallback cb) : callback(cb){}
+            DeleteContext(DeleteCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : CallbackContext(ex), callback(cb){}
         };
 
-        struct ObserveContext
+        struct ObserveContext : public CallbackContext
         {
             ObserveCallback callback;
-            ObserveContext(ObserveCallback cb) : callback(cb){}
+            ObserveContext(ObserveCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : CallbackContext(ex), callback(cb){}
         };
 
-        struct DirectPairingContext
+        struct DirectPairingContext : public CallbackContext
         {
             DirectPairingCallback callback;
-            DirectPairingContext(DirectPairingCallback cb) : callback(cb){}
+            DirectPairingContext(DirectPairingCallback cb, std::shared_ptr<CallbackExecutor> ex)
+                : CallbackContext(ex), callback(cb){}
 
         };
 
 #ifdef WITH_MQ
-        struct MQTopicContext
+        struct MQTopicContext : public CallbackContext
         {
             MQTopicCallback callback;
             std::weak_ptr<IClientWrapper> clientWrapper;
-            MQTopicContext(MQTopicCallback cb, std::weak_ptr<IClientWrapper> cw)
-                : callback(cb), clientWrapper(cw){}
+            MQTopicContext(MQTopicCallback cb, std::weak_ptr<IClientWrapper> cw,
+                           std::shared_ptr<CallbackExecutor> ex)
+                : CallbackContext(ex), callback(cb), clientWrapper(cw){}
         };
 #endif
     }
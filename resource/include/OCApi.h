@@ -45,6 +45,7 @@ namespace OC
     class OCResourceRequest;
     class OCResourceResponse;
     class OCDirectPairing;
+    class CallbackExecutor;
 } // namespace OC
 
 namespace OC
@@ -158,6 +159,10 @@ namespace OC
         /** persistant storage Handler structure (open/read/write/close/unlink). */
         OCPersistentStorage        *ps;
 
+        /** thread pool that runs client callbacks. If not set, every callback
+         *  runs on a new thread.*/
+        std::shared_ptr<CallbackExecutor> callbackExecutor;
+
         public:
             PlatformConfig()
                 : serviceType(ServiceType::InProc),
@@ -167,7 +172,8 @@ namespace OC
                 ipAddress("0.0.0.0"),
                 port(0),
                 QoS(QualityOfService::NaQos),
-                ps(nullptr)
+                ps(nullptr),
+                callbackExecutor(nullptr)
         {}
             PlatformConfig(const ServiceType serviceType_,
             const ModeType mode_,
@@ -182,7 +188,8 @@ namespace OC
                 ipAddress(""),
                 port(0),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackExecutor(nullptr)
         {}
             // for backward compatibility
             PlatformConfig(const ServiceType serviceType_,
@@ -198,7 +205,8 @@ namespace OC
                 ipAddress(ipAddress_),
                 port(port_),
                 QoS(QoS_),
-                ps(ps_)
+                ps(ps_),
+                callbackExecutor(nullptr)
         {}
     };
 
@@ -268,6 +276,10 @@ namespace OC
     // Used in GET, PUT, POST methods on links to other remote resources of a group.
     const std::string GROUP_INTERFACE = "oic.mi.grp";
 
+    // Longest time the stack thread sleeps in OCWaitForProcess() between two
+    // OCProcess() calls. It is woken earlier whenever the stack has work.
+    const uint32_t MAX_PROCESS_WAIT_MS = 1000;
+
     //Typedef for list direct paired devices
     typedef std::vector<std::shared_ptr<OCDirectPairing>> PairedDevices;
 
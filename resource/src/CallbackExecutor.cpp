@@ -0,0 +1,249 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include "CallbackExecutor.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include "OCApi.h"
+
+namespace OC
+{
+    struct CallbackExecutor::State
+    {
+        struct Worker
+        {
+            std::mutex lock;
+            std::deque<Task> tasks;
+        };
+
+        explicit State(unsigned int threadCount)
+            : workers(threadCount), nextWorker(0), pending(0), stopped(false)
+        {
+            for (auto& worker : workers)
+            {
+                worker.reset(new Worker());
+            }
+        }
+
+        void push(Task task)
+        {
+            Worker& worker = *workers[nextWorker++ % workers.size()];
+            {
+                std::lock_guard<std::mutex> lock(worker.lock);
+                worker.tasks.push_back(std::move(task));
+            }
+            {
+                std::lock_guard<std::mutex> lock(idleLock);
+                ++pending;
+            }
+            idle.notify_one();
+        }
+
+        // Take the oldest task of the own queue, or steal the newest of another one.
+        bool pop(size_t self, Task& task)
+        {
+            for (size_t i = 0; i < workers.size(); ++i)
+            {
+                Worker& worker = *workers[(self + i) % workers.size()];
+                std::lock_guard<std::mutex> lock(worker.lock);
+                if (!worker.tasks.empty())
+                {
+                    if (0 == i)
+                    {
+                        task = std::move(worker.tasks.front());
+                        worker.tasks.pop_front();
+                    }
+                    else
+                    {
+                        task = std::move(worker.tasks.back());
+                        worker.tasks.pop_back();
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void run(size_t self)
+        {
+            for (;;)
+            {
+                {
+                    // Reserve one of the queued tasks, or leave once all are done.
+                    std::unique_lock<std::mutex> lock(idleLock);
+                    idle.wait(lock, [this]{ return stopped || pending > 0; });
+                    if (0 == pending)
+                    {
+                        return;
+                    }
+                    --pending;
+                }
+
+                Task task;
+                while (!pop(self, task))
+                {
+                    // The reserved task is being taken by another worker that made
+                    // its reservation earlier; one is left for us.
+                    std::this_thread::yield();
+                }
+                execute(task);
+            }
+        }
+
+        void execute(Task& task)
+        {
+            try
+            {
+                task();
+            }
+            catch (std::exception& e)
+            {
+                oclog() << "Exception in client callback: " << e.what() << std::flush;
+            }
+            catch (...)
+            {
+                oclog() << "Unknown exception in client callback" << std::flush;
+            }
+        }
+
+        void postOrdered(const std::shared_ptr<State>& self, const void* key, Task task)
+        {
+            bool running;
+            {
+                std::lock_guard<std::mutex> lock(sequenceLock);
+                std::deque<Task>& tasks = sequences[key];
+                running = !tasks.empty();
+                tasks.push_back(std::move(task));
+            }
+            if (!running)
+            {
+                push([self, key]{ self->runOrdered(self, key); });
+            }
+        }
+
+        // The task at the front of a sequence stays queued while it runs, so a
+        // non-empty sequence always has exactly one runner scheduled.
+        void runOrdered(const std::shared_ptr<State>& self, const void* key)
+        {
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock(sequenceLock);
+                task = std::move(sequences[key].front());
+            }
+
+            execute(task);
+
+            bool more;
+            {
+                std::lock_guard<std::mutex> lock(sequenceLock);
+                auto it = sequences.find(key);
+                it->second.pop_front();
+                more = !it->second.empty();
+                if (!more)
+                {
+                    sequences.erase(it);
+                }
+            }
+            if (more)
+            {
+                // Requeue rather than loop, so a busy sequence does not hog a worker.
+                push([self, key]{ self->runOrdered(self, key); });
+            }
+        }
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic<size_t> nextWorker;
+
+        std::mutex idleLock;
+        std::condition_variable idle;
+        size_t pending;
+        bool stopped;
+
+        std::mutex sequenceLock;
+        std::unordered_map<const void*, std::deque<Task>> sequences;
+    };
+
+    CallbackExecutor::CallbackExecutor(unsigned int threadCount)
+    {
+        if (0 == threadCount)
+        {
+            threadCount = std::thread::hardware_concurrency();
+        }
+        if (0 == threadCount)
+        {
+            threadCount = 1;
+        }
+
+        m_state = std::make_shared<State>(threadCount);
+        for (unsigned int i = 0; i < threadCount; ++i)
+        {
+            std::shared_ptr<State> state = m_state;
+            m_threads.push_back(std::thread([state, i]{ state->run(i); }));
+        }
+    }
+
+    CallbackExecutor::~CallbackExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_state->idleLock);
+            m_state->stopped = true;
+        }
+        m_state->idle.notify_all();
+
+        for (auto& thread : m_threads)
+        {
+            if (thread.get_id() == std::this_thread::get_id())
+            {
+                // Destroyed from one of its own callbacks; that worker finishes
+                // the queue on its own.
+                thread.detach();
+            }
+            else
+            {
+                thread.join();
+            }
+        }
+    }
+
+    void CallbackExecutor::post(Task task)
+    {
+        m_state->push(std::move(task));
+    }
+
+    void CallbackExecutor::post(const void* key, Task task)
+    {
+        if (!key)
+        {
+            m_state->push(std::move(task));
+            return;
+        }
+        m_state->postOrdered(m_state, key, std::move(task));
+    }
+
+    unsigned int CallbackExecutor::threadCount() const
+    {
+        return static_cast<unsigned int>(m_threads.size());
+    }
+}
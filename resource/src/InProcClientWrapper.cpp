@@ -29,6 +29,26 @@ using namespace std;
 
 namespace OC
 {
+    /**
+     * Run a user callback on the executor, or on a new detached thread if there is none.
+     * Callbacks posted with the same key run one at a time in posting order.
+     */
+    template<typename... Args>
+    static void dispatchCallback(const std::shared_ptr<CallbackExecutor>& executor,
+                                 const void* key, Args&&... args)
+    {
+        CallbackExecutor::Task task = std::bind(std::forward<Args>(args)...);
+        if (executor)
+        {
+            executor->post(key, std::move(task));
+        }
+        else
+        {
+            std::thread exec(std::move(task));
+            exec.detach();
+        }
+    }
+
     InProcClientWrapper::InProcClientWrapper(
         std::weak_ptr<std::recursive_mutex> csdkLock, PlatformConfig cfg)
             : m_threadRun(false), m_csdkLock(csdkLock),
@@ -60,6 +80,7 @@ namespace OC
         if (m_threadRun && m_listeningThread.joinable())
         {
             m_threadRun = false;
+            OCWakeUpProcess();
             m_listeningThread.join();
         }
 
@@ -92,8 +113,11 @@ namespace OC
                 // TODO: do something with result if failed?
             }
 
-            // To minimize CPU utilization we may wish to do this with sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until the stack has work, without holding the lock.
+            if (OC_STACK_OK != OCWaitForProcess(MAX_PROCESS_WAIT_MS))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -173,8 +197,7 @@ namespace OC
 
             for(auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                dispatchCallback(context->executor, nullptr, context->callback, resource);
             }
         }
         catch (std::exception &e)
@@ -226,15 +249,13 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, resource);
-                exec.detach();
+                dispatchCallback(context->executor, nullptr, context->callback, resource);
             }
             return OC_STACK_KEEP_TRANSACTION;
         }
 
         std::string resourceURI = clientResponse->resourceUri;
-        std::thread exec(context->errorCallback, resourceURI, result);
-        exec.detach();
+        dispatchCallback(context->executor, nullptr, context->errorCallback, resourceURI, result);
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -254,7 +275,8 @@ namespace OC
         resourceUri << serviceUrl << resourceType;
 
         ClientCallbackContext::ListenContext* context =
-            new ClientCallbackContext::ListenContext(callback, shared_from_this());
+            new ClientCallbackContext::ListenContext(callback, shared_from_this(),
+                                                     m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(context),
         cbdata.cb      = listenCallback;
@@ -296,7 +318,8 @@ namespace OC
 
         ClientCallbackContext::ListenErrorContext* context =
             new ClientCallbackContext::ListenErrorContext(callback, errorCallback,
-                                                          shared_from_this());
+                                                          shared_from_this(),
+                                                          m_cfg.callbackExecutor);
         if (!context)
         {
             return OC_STACK_ERROR;
@@ -346,9 +369,8 @@ namespace OC
                     << clientResponse->result
                     << std::flush;
 
-            std::thread exec(context->callback, clientResponse->result,
+            dispatchCallback(context->executor, nullptr, context->callback, clientResponse->result,
                              resourceURI, nullptr);
-            exec.detach();
 
             return OC_STACK_DELETE_TRANSACTION;
         }
@@ -369,9 +391,8 @@ namespace OC
             // loop to ensure valid construction of all resources
             for (auto resource : container.Resources())
             {
-                std::thread exec(context->callback, clientResponse->result,
+                dispatchCallback(context->executor, nullptr, context->callback, clientResponse->result,
                                  resourceURI, resource);
-                exec.detach();
             }
         }
         catch (std::exception &e)
@@ -398,7 +419,8 @@ namespace OC
         }
 
         ClientCallbackContext::MQTopicContext* context =
-            new ClientCallbackContext::MQTopicContext(callback, shared_from_this());
+            new ClientCallbackContext::MQTopicContext(callback, shared_from_this(),
+                                                      m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(context),
         cbdata.cb      = listenMQCallback;
@@ -441,8 +463,7 @@ namespace OC
         try
         {
             OCRepresentation rep = parseGetSetCallback(clientResponse);
-            std::thread exec(context->callback, rep);
-            exec.detach();
+            dispatchCallback(context->executor, nullptr, context->callback, rep);
         }
         catch(OC::OCException& e)
         {
@@ -469,7 +490,8 @@ namespace OC
         deviceUri << serviceUrl << deviceURI;
 
         ClientCallbackContext::DeviceListenContext* context =
-            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this());
+            new ClientCallbackContext::DeviceListenContext(callback, shared_from_this(),
+                                                           m_cfg.callbackExecutor);
         OCCallbackData cbdata;
 
         cbdata.context = static_cast<void*>(context),
@@ -579,18 +601,16 @@ namespace OC
                                             createdUri);
                 for (auto resource : container.Resources())
                 {
-                    std::thread exec(context->callback, result,
+                    dispatchCallback(context->executor, nullptr, context->callback, result,
                                      createdUri,
                                      resource);
-                    exec.detach();
                 }
             }
             else
             {
-                std::thread exec(context->callback, result,
+                dispatchCallback(context->executor, nullptr, context->callback, result,
                                  createdUri,
                                  nullptr);
-                exec.detach();
             }
         }
         catch (std::exception &e)
@@ -614,7 +634,8 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::MQTopicContext* ctx =
-                new ClientCallbackContext::MQTopicContext(callback, shared_from_this());
+                new ClientCallbackContext::MQTopicContext(callback, shared_from_this(),
+                                                          m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = createMQTopicCallback;
@@ -670,8 +691,8 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, rep, result);
-        exec.detach();
+        dispatchCallback(context->executor, nullptr, context->callback, serverHeaderOptions, rep,
+                         result);
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -688,7 +709,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::GetContext* ctx =
-            new ClientCallbackContext::GetContext(callback);
+            new ClientCallbackContext::GetContext(callback, m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = getResourceCallback;
@@ -749,8 +770,8 @@ namespace OC
             }
         }
 
-        std::thread exec(context->callback, serverHeaderOptions, attrs, result);
-        exec.detach();
+        dispatchCallback(context->executor, nullptr, context->callback, serverHeaderOptions, attrs,
+                         result);
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -858,7 +879,8 @@ namespace OC
             return OC_STACK_INVALID_PARAM;
         }
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = setResourceCallback;
@@ -904,7 +926,8 @@ namespace OC
             return OC_STACK_INVALID_PARAM;
         }
         OCStackResult result;
-        ClientCallbackContext::SetContext* ctx = new ClientCallbackContext::SetContext(callback);
+        ClientCallbackContext::SetContext* ctx =
+            new ClientCallbackContext::SetContext(callback, m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = setResourceCallback;
@@ -951,8 +974,8 @@ namespace OC
         {
             parseServerHeaderOptions(clientResponse, serverHeaderOptions);
         }
-        std::thread exec(context->callback, serverHeaderOptions, clientResponse->result);
-        exec.detach();
+        dispatchCallback(context->executor, nullptr, context->callback, serverHeaderOptions,
+                         clientResponse->result);
         return OC_STACK_DELETE_TRANSACTION;
     }
 
@@ -970,7 +993,7 @@ namespace OC
         }
         OCStackResult result;
         ClientCallbackContext::DeleteContext* ctx =
-            new ClientCallbackContext::DeleteContext(callback);
+            new ClientCallbackContext::DeleteContext(callback, m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = deleteResourceCallback;
@@ -1025,9 +1048,9 @@ namespace OC
                 result = e.code();
             }
         }
-        std::thread exec(context->callback, serverHeaderOptions, attrs,
-                    result, sequenceNumber);
-        exec.detach();
+        // Notifications of one observation are delivered in the order received.
+        dispatchCallback(context->executor, context, context->callback, serverHeaderOptions,
+                         attrs, result, sequenceNumber);
         if (sequenceNumber == MAX_SEQUENCE_NUMBER + 1)
         {
             return OC_STACK_DELETE_TRANSACTION;
@@ -1049,7 +1072,7 @@ namespace OC
         OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
-            new ClientCallbackContext::ObserveContext(callback);
+            new ClientCallbackContext::ObserveContext(callback, m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = observeResourceCallback;
@@ -1137,10 +1160,8 @@ namespace OC
          */
         std::string url = clientResponse->devAddr.addr;
 
-        std::thread exec(context->callback, clientResponse->result,
-                    clientResponse->sequenceNumber, url);
-
-        exec.detach();
+        dispatchCallback(context->executor, context, context->callback, clientResponse->result,
+                         clientResponse->sequenceNumber, url);
 
         return OC_STACK_KEEP_TRANSACTION;
     }
@@ -1155,7 +1176,8 @@ namespace OC
         }
 
         ClientCallbackContext::SubscribePresenceContext* ctx =
-            new ClientCallbackContext::SubscribePresenceContext(presenceHandler);
+            new ClientCallbackContext::SubscribePresenceContext(presenceHandler,
+                                                                m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = subscribePresenceCallback;
@@ -1216,7 +1238,7 @@ namespace OC
         OCStackResult result;
 
         ClientCallbackContext::ObserveContext* ctx =
-            new ClientCallbackContext::ObserveContext(callback);
+            new ClientCallbackContext::ObserveContext(callback, m_cfg.callbackExecutor);
         OCCallbackData cbdata;
         cbdata.context = static_cast<void*>(ctx),
         cbdata.cb      = observeResourceCallback;
@@ -1327,8 +1349,7 @@ namespace OC
             }
             else {
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                dispatchCallback(m_cfg.callbackExecutor, nullptr, callback, dpDeviceList);
                 result = OC_STACK_OK;
             }
         }
@@ -1366,8 +1387,7 @@ namespace OC
             }
             else {
                 convert(list, dpDeviceList);
-                std::thread exec(callback, dpDeviceList);
-                exec.detach();
+                dispatchCallback(m_cfg.callbackExecutor, nullptr, callback, dpDeviceList);
                 result = OC_STACK_OK;
             }
         }
@@ -1386,8 +1406,7 @@ namespace OC
         ClientCallbackContext::DirectPairingContext* context =
             static_cast<ClientCallbackContext::DirectPairingContext*>(ctx);
 
-        std::thread exec(context->callback, cloneDevice(peer), result);
-        exec.detach();
+        dispatchCallback(context->executor, nullptr, context->callback, cloneDevice(peer), result);
     }
 
     OCStackResult InProcClientWrapper::DoDirectPairing(std::shared_ptr<OCDirectPairing> peer,
@@ -1401,7 +1420,7 @@ namespace OC
 
         OCStackResult result = OC_STACK_ERROR;
         ClientCallbackContext::DirectPairingContext* context =
-            new ClientCallbackContext::DirectPairingContext(callback);
+            new ClientCallbackContext::DirectPairingContext(callback, m_cfg.callbackExecutor);
 
         auto cLock = m_csdkLock.lock();
         if (cLock)
@@ -313,7 +313,11 @@ namespace OC
                 // ...the value of variable result is simply ignored for now.
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Sleep until the stack has work, without holding the lock.
+            if (OC_STACK_OK != OCWaitForProcess(MAX_PROCESS_WAIT_MS))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
         }
     }
 
@@ -754,6 +758,7 @@ namespace OC
         if(m_processThread.joinable())
         {
             m_threadRun = false;
+            OCWakeUpProcess();
             m_processThread.join();
         }
 
@@ -0,0 +1,225 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <CallbackExecutor.h>
+
+namespace CallbackExecutorTest
+{
+    using namespace OC;
+
+    typedef std::chrono::steady_clock Clock;
+
+    const size_t NOTIFICATIONS = 5000;
+    const int OBSERVATIONS = 8;
+    // 10 kHz in total, e.g. 100 Hz from each of 100 observations.
+    const std::chrono::microseconds NOTIFICATION_INTERVAL(100);
+
+    /**
+     * Collects the time from posting a notification to the start of its
+     * callback. Shared with the callbacks, which may outlive the test body
+     * when they run on detached threads.
+     */
+    class LatencyRecorder
+    {
+        public:
+            explicit LatencyRecorder(size_t count) : m_latencies(count), m_done(0) {}
+
+            void record(size_t index, Clock::time_point posted)
+            {
+                m_latencies[index] =
+                    std::chrono::duration<double, std::micro>(Clock::now() - posted).count();
+                std::lock_guard<std::mutex> guard(m_lock);
+                if (++m_done == m_latencies.size())
+                {
+                    m_cond.notify_all();
+                }
+            }
+
+            void wait()
+            {
+                std::unique_lock<std::mutex> guard(m_lock);
+                m_cond.wait(guard, [this]{ return m_done == m_latencies.size(); });
+            }
+
+            void print(const char* name, size_t threadsStarted)
+            {
+                std::vector<double> sorted(m_latencies);
+                std::sort(sorted.begin(), sorted.end());
+                double sum = 0;
+                for (double latency : sorted)
+                {
+                    sum += latency;
+                }
+                std::cout << name << ": " << sum / sorted.size() << " us mean, "
+                          << sorted[sorted.size() * 99 / 100] << " us p99 callback latency, "
+                          << threadsStarted << " threads started" << std::endl;
+            }
+
+        private:
+            std::vector<double> m_latencies;
+            size_t m_done;
+            std::mutex m_lock;
+            std::condition_variable m_cond;
+    };
+
+    TEST(CallbackExecutorTest, ThreadCount)
+    {
+        CallbackExecutor executor(3);
+        EXPECT_EQ(3u, executor.threadCount());
+
+        CallbackExecutor defaultExecutor;
+        EXPECT_LE(1u, defaultExecutor.threadCount());
+    }
+
+    TEST(CallbackExecutorTest, RunsAllTasksBeforeDestruction)
+    {
+        std::atomic<int> count(0);
+        {
+            CallbackExecutor executor(4);
+            for (int i = 0; i < 10000; ++i)
+            {
+                executor.post([&count]{ ++count; });
+            }
+        }
+        EXPECT_EQ(10000, count);
+    }
+
+    TEST(CallbackExecutorTest, UsesPoolThreads)
+    {
+        std::mutex lock;
+        std::set<std::thread::id> threads;
+        {
+            CallbackExecutor executor(2);
+            for (int i = 0; i < 1000; ++i)
+            {
+                executor.post([&]
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    threads.insert(std::this_thread::get_id());
+                });
+            }
+        }
+        EXPECT_GE(2u, threads.size());
+        EXPECT_EQ(0u, threads.count(std::this_thread::get_id()));
+    }
+
+    TEST(CallbackExecutorTest, KeepsOrderPerKey)
+    {
+        const int keys = 8;
+        const int tasksPerKey = 2000;
+        int keyObjects[keys];
+        std::vector<int> received[keys];
+        std::atomic<int> concurrent[keys];
+        std::atomic<bool> overlap(false);
+        for (int k = 0; k < keys; ++k)
+        {
+            concurrent[k] = 0;
+        }
+
+        {
+            CallbackExecutor executor(4);
+            for (int i = 0; i < tasksPerKey; ++i)
+            {
+                for (int k = 0; k < keys; ++k)
+                {
+                    executor.post(&keyObjects[k], [&, k, i]
+                    {
+                        if (++concurrent[k] != 1)
+                        {
+                            overlap = true;
+                        }
+                        received[k].push_back(i);
+                        --concurrent[k];
+                    });
+                }
+            }
+        }
+
+        EXPECT_FALSE(overlap);
+        for (int k = 0; k < keys; ++k)
+        {
+            ASSERT_EQ(static_cast<size_t>(tasksPerKey), received[k].size());
+            for (int i = 0; i < tasksPerKey; ++i)
+            {
+                EXPECT_EQ(i, received[k][i]);
+            }
+        }
+    }
+
+    TEST(CallbackExecutorTest, SurvivesThrowingTask)
+    {
+        std::atomic<int> count(0);
+        {
+            CallbackExecutor executor(1);
+            executor.post([]{ throw std::runtime_error("callback failed"); });
+            executor.post([&count]{ ++count; });
+        }
+        EXPECT_EQ(1, count);
+    }
+
+    // Measures callback latency and thread churn for observe notifications
+    // arriving at a high rate, once with a thread per callback as without an
+    // executor and once on an executor.
+    TEST(CallbackExecutorTest, NotificationRateBenchmark)
+    {
+        int observations[OBSERVATIONS];
+
+        auto perThread = std::make_shared<LatencyRecorder>(NOTIFICATIONS);
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < NOTIFICATIONS; ++i)
+        {
+            std::this_thread::sleep_until(start + i * NOTIFICATION_INTERVAL);
+            Clock::time_point posted = Clock::now();
+            std::thread callback([perThread, i, posted]{ perThread->record(i, posted); });
+            callback.detach();
+        }
+        perThread->wait();
+        perThread->print("thread per callback", NOTIFICATIONS);
+
+        auto pooled = std::make_shared<LatencyRecorder>(NOTIFICATIONS);
+        unsigned int threads = 0;
+        {
+            CallbackExecutor executor(4);
+            threads = executor.threadCount();
+            start = Clock::now();
+            for (size_t i = 0; i < NOTIFICATIONS; ++i)
+            {
+                std::this_thread::sleep_until(start + i * NOTIFICATION_INTERVAL);
+                Clock::time_point posted = Clock::now();
+                executor.post(&observations[i % OBSERVATIONS],
+                              [pooled, i, posted]{ pooled->record(i, posted); });
+            }
+            pooled->wait();
+        }
+        pooled->print("executor", threads);
+    }
+}
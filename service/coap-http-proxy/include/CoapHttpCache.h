@@ -0,0 +1,81 @@
+/* ****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+/**
+ * @file
+ * This file contains the response cache of the CoAP-HTTP Proxy
+ */
+
+#ifndef COAP_HTTP_CACHE_H_
+#define COAP_HTTP_CACHE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "octypes.h"
+
+/**
+ * Maximum number of responses kept in the cache.
+ */
+#define CHP_CACHE_MAX_ENTRIES (32)
+
+/**
+ * Initialize the response cache.
+ * @return ::OC_STACK_OK or appropriate error code.
+ */
+OCStackResult CHPCacheInitialize();
+
+/**
+ * Terminate the response cache and drop all cached responses.
+ */
+void CHPCacheTerminate();
+
+/**
+ * Function to fill a response for a GET request from the cache.
+ * On a hit, response payload is a copy that the caller destroys, and a Max-Age
+ * option carrying the remaining freshness lifetime is appended to the options.
+ * @param[in]   proxyUri          Proxy-Uri of the request.
+ * @param[out]  response          Response to be filled.
+ * @return true if a fresh response was found.
+ */
+bool CHPCacheGetResponse(const char *proxyUri, OCEntityHandlerResponse *response);
+
+/**
+ * Function to store a 2.05 response to a GET request.
+ * @param[in]   proxyUri          Proxy-Uri of the request.
+ * @param[in]   response          Response without Max-Age option.
+ * @param[in]   maxAge            Freshness lifetime in seconds.
+ */
+void CHPCachePutResponse(const char *proxyUri, const OCEntityHandlerResponse *response,
+                         uint32_t maxAge);
+
+/**
+ * Function to drop the cached response of a resource, e.g. when it is modified.
+ * @param[in]   proxyUri          Proxy-Uri of the resource.
+ */
+void CHPCacheInvalidate(const char *proxyUri);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
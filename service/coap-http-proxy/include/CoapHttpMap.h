@@ -32,7 +32,7 @@ extern "C"
 #endif
 
 #include "CoapHttpParser.h"
-#include "cJSON.h"
+#include "ocpayload.h"
 
 /**
  * Function to get CoAP code for an HTTP code.
@@ -76,18 +76,39 @@ OCStackResult CHPGetHttpMethod(const OCMethod method, HttpMethod_t *httpMethod);
 OCStackResult CHPGetHttpOption(const OCHeaderOption* option, HttpHeaderOption_t **ret);
 
 /**
- * Function to convert Json payload to CBOR representational payload.
- * @param[in]   rootJSon          Json payload.
- * @param[out]  payload           CBor representational payload.
+ * Function to get the remaining freshness lifetime of an HTTP response from
+ * its Cache-Control and Age headers. s-maxage is preferred over max-age, and
+ * no-store, no-cache or private yield a lifetime of 0.
+ * @param[in]   headerOptions     HTTP response header options.
+ * @param[out]  maxAge            Freshness lifetime less the Age in seconds.
+ * @return true if the response carries explicit freshness information.
  */
-void CHPJsonToRepPayload(cJSON* rootJSon, OCRepPayload* payload);
+bool CHPGetHttpMaxAge(const u_arraylist_t *headerOptions, uint32_t *maxAge);
 
 /**
- * Function to convert CBOR representational payload to Json payload.
+ * Function to encode a freshness lifetime as CoAP Max-Age option.
+ * @param[in]   maxAge            Freshness lifetime in seconds.
+ * @param[out]  option            Max-Age option.
+ */
+void CHPSetMaxAgeOption(uint32_t maxAge, OCHeaderOption *option);
+
+/**
+ * Function to parse Json text straight into a CBOR representational payload,
+ * without building an intermediate Json tree.
+ * @param[in]   json              Json text, need not be NUL terminated.
+ * @param[in]   length            Length of the Json text.
+ * @return CBor representational payload or NULL if json is not a valid Json object.
+ */
+OCRepPayload* CHPJsonToRepPayload(const char* json, size_t length);
+
+/**
+ * Function to serialize a CBOR representational payload as Json text,
+ * without building an intermediate Json tree.
  * @param[in]   repData           Cbor representational payload.
- * @return CJson payload.
+ * @param[out]  length            Length of the Json text. Can be NULL.
+ * @return Json text to be freed with OICFree(), or NULL if repData has no values.
  */
-cJSON* CHPRepPayloadToJson(OCRepPayload* repData);
+char* CHPRepPayloadToJson(const OCRepPayload* repData, size_t *length);
 #ifdef __cplusplus
 }
 #endif
@@ -50,6 +50,7 @@ extern "C"
 #define HTTP_OPTION_CONTENT_TYPE    "content-type"
 #define HTTP_OPTION_CONTENT_LENGTH  "content-length"
 #define HTTP_OPTION_EXPIRES         "expires"
+#define HTTP_OPTION_AGE             "age"
 
 /**
  * @enum HttpResponseResult_t
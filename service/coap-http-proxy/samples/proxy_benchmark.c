@@ -0,0 +1,320 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+/**
+ * @file
+ * Measures the proxy pipeline against an in-process HTTP/1.1 stand-in
+ * server on the loopback interface: JSON transcoding, GET requests over
+ * pooled keep-alive connections and hits in the response cache.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "ocpayload.h"
+#include "oic_malloc.h"
+#include "CoapHttpCache.h"
+#include "CoapHttpMap.h"
+#include "CoapHttpParser.h"
+
+#define DEFAULT_ITERATIONS 2000
+#define MAX_BODY_LENGTH 4096
+#define MAX_REQUEST_LENGTH 8192
+
+static char g_body[MAX_BODY_LENGTH];
+static size_t g_bodyLength;
+static int g_listenFd = -1;
+static int g_connections;
+static pthread_mutex_t g_connectionMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static sem_t g_responseSem;
+static int g_okResponses;
+
+static double NowSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void BuildBody()
+{
+    int len = snprintf(g_body, sizeof(g_body),
+                       "{\"rt\":[\"oic.r.sensor\"],\"if\":[\"oic.if.baseline\",\"oic.if.s\"],"
+                       "\"temperature\":21.5,\"units\":\"C\",\"range\":[-40.0,125.0],"
+                       "\"id\":\"sensor-0001\",\"samples\":[");
+    for (int i = 0; i < 16; i++)
+    {
+        len += snprintf(g_body + len, sizeof(g_body) - len,
+                        "%s{\"t\":%d,\"v\":%.2f,\"ok\":true,\"tag\":\"seq%d\"}",
+                        i ? "," : "", i, i * 0.25, i);
+    }
+    len += snprintf(g_body + len, sizeof(g_body) - len, "]}");
+    g_bodyLength = (size_t)len;
+}
+
+/**
+ * Serves one keep-alive connection until the client closes it.
+ */
+static void *ServeConnection(void *data)
+{
+    int fd = (int)(intptr_t)data;
+    char request[MAX_REQUEST_LENGTH];
+    size_t have = 0;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    for (;;)
+    {
+        char *end = NULL;
+        request[have] = '\0';
+        while (!(end = strstr(request, "\r\n\r\n")))
+        {
+            ssize_t n = read(fd, request + have, sizeof(request) - 1 - have);
+            if (n <= 0)
+            {
+                close(fd);
+                return NULL;
+            }
+            have += (size_t)n;
+            request[have] = '\0';
+        }
+
+        size_t used = (size_t)(end + 4 - request);
+        memmove(request, request + used, have - used);
+        have -= used;
+
+        char response[MAX_BODY_LENGTH + 256];
+        int len = snprintf(response, sizeof(response),
+                           "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                           "Content-Length: %zu\r\nCache-Control: max-age=60\r\n\r\n",
+                           g_bodyLength);
+        memcpy(response + len, g_body, g_bodyLength);
+        if (write(fd, response, len + g_bodyLength) < 0)
+        {
+            close(fd);
+            return NULL;
+        }
+    }
+}
+
+static void *AcceptConnections(void *data)
+{
+    (void)data;
+    for (;;)
+    {
+        int fd = accept(g_listenFd, NULL, NULL);
+        if (fd < 0)
+        {
+            return NULL;
+        }
+
+        pthread_mutex_lock(&g_connectionMutex);
+        g_connections++;
+        pthread_mutex_unlock(&g_connectionMutex);
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, ServeConnection, (void *)(intptr_t)fd))
+        {
+            close(fd);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+}
+
+static int StartServer(unsigned short *port)
+{
+    g_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (g_listenFd < 0)
+    {
+        return -1;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLength = sizeof(addr);
+    if (bind(g_listenFd, (struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(g_listenFd, 16) ||
+        getsockname(g_listenFd, (struct sockaddr *)&addr, &addrLength))
+    {
+        close(g_listenFd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, AcceptConnections, NULL))
+    {
+        close(g_listenFd);
+        return -1;
+    }
+    pthread_detach(thread);
+    return 0;
+}
+
+static void BenchmarkTranscode(int iterations)
+{
+    double start = NowSeconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        OCRepPayload *payload = CHPJsonToRepPayload(g_body, g_bodyLength);
+        char *json = CHPRepPayloadToJson(payload, NULL);
+        OICFree(json);
+        OCRepPayloadDestroy(payload);
+    }
+    double elapsed = NowSeconds() - start;
+    printf("transcode round trip (%zu byte body): %.2f us\n", g_bodyLength,
+           elapsed / iterations * 1e6);
+}
+
+static void HttpResponseCallback(const HttpResponse_t *response, void *context)
+{
+    (void)context;
+    if (CHP_SUCCESS == response->status && response->payloadLength == g_bodyLength)
+    {
+        g_okResponses++;
+    }
+    sem_post(&g_responseSem);
+}
+
+static int BenchmarkHttp(const char *uri, int iterations)
+{
+    if (OC_STACK_OK != CHPParserInitialize())
+    {
+        printf("Failed to initialize parser\n");
+        return -1;
+    }
+
+    HttpRequest_t request;
+    memset(&request, 0, sizeof(request));
+    request.httpMajor = 1;
+    request.httpMinor = 1;
+    request.method = CHP_GET;
+    strncpy(request.resourceUri, uri, sizeof(request.resourceUri) - 1);
+    strncpy(request.acceptFormat, JSON_CONTENT_TYPE, sizeof(request.acceptFormat) - 1);
+
+    double start = 0;
+    // The first request opens the connection and is not measured.
+    for (int i = 0; i <= iterations; i++)
+    {
+        if (1 == i)
+        {
+            start = NowSeconds();
+        }
+        if (OC_STACK_OK != CHPPostHttpRequest(&request, HttpResponseCallback, NULL))
+        {
+            printf("Failed to post request %d\n", i);
+            CHPParserTerminate();
+            return -1;
+        }
+        sem_wait(&g_responseSem);
+    }
+    double elapsed = NowSeconds() - start;
+    CHPParserTerminate();
+
+    pthread_mutex_lock(&g_connectionMutex);
+    int connections = g_connections;
+    pthread_mutex_unlock(&g_connectionMutex);
+    printf("%s: %d GETs, %.1f us/request, %d ok, %d connection(s)\n", uri, iterations,
+           elapsed / iterations * 1e6, g_okResponses, connections);
+    return 0;
+}
+
+static int BenchmarkCache(const char *uri, int iterations)
+{
+    if (OC_STACK_OK != CHPCacheInitialize())
+    {
+        printf("Failed to initialize cache\n");
+        return -1;
+    }
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.ehResult = OC_EH_CONTENT;
+    response.payload = (OCPayload *)CHPJsonToRepPayload(g_body, g_bodyLength);
+    CHPCachePutResponse(uri, &response, 60);
+
+    int hits = 0;
+    double start = NowSeconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        OCEntityHandlerResponse cached;
+        memset(&cached, 0, sizeof(cached));
+        if (CHPCacheGetResponse(uri, &cached))
+        {
+            hits++;
+            OCPayloadDestroy(cached.payload);
+        }
+    }
+    double elapsed = NowSeconds() - start;
+    printf("cache: %d lookups, %.2f us/hit, %d hits\n", iterations,
+           elapsed / iterations * 1e6, hits);
+
+    OCPayloadDestroy(response.payload);
+    CHPCacheTerminate();
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0)
+    {
+        printf("Usage: %s [iterations]\n", argv[0]);
+        return -1;
+    }
+
+    BuildBody();
+    sem_init(&g_responseSem, 0, 0);
+
+    unsigned short port = 0;
+    if (StartServer(&port))
+    {
+        printf("Failed to start stand-in server\n");
+        return -1;
+    }
+
+    char uri[64];
+    snprintf(uri, sizeof(uri), "http://127.0.0.1:%hu/sensor", port);
+
+    BenchmarkTranscode(iterations * 10);
+    int ret = BenchmarkHttp(uri, iterations);
+    if (!ret)
+    {
+        ret = BenchmarkCache(uri, iterations * 10);
+    }
+
+    close(g_listenFd);
+    sem_destroy(&g_responseSem);
+    return ret;
+}
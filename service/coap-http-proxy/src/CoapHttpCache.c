@@ -0,0 +1,266 @@
+/* ****************************************************************
+ *
+ * Copyright 2016 Samsung Electronics All Rights Reserved.
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************/
+
+#include "CoapHttpCache.h"
+#include <string.h>
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "oic_time.h"
+#include "octhread.h"
+#include "uhashmap.h"
+#include "logger.h"
+#include "ocpayload.h"
+#include "CoapHttpMap.h"
+
+#define TAG "CHPCache"
+
+/**
+ * Cached response of a GET request, keyed by its Proxy-Uri.
+ */
+typedef struct
+{
+    char *proxyUri;
+    OCRepPayload *payload;
+    OCHeaderOption *options;
+    uint8_t numOptions;
+    /* Absolute expiry time in milliseconds */
+    uint64_t expiry;
+} CHPCacheEntry_t;
+
+static u_hashmap_t *g_cache = NULL;
+static oc_mutex g_cacheMutex = NULL;
+
+static void CHPCacheFreeEntry(CHPCacheEntry_t *entry)
+{
+    if (entry)
+    {
+        OCRepPayloadDestroy(entry->payload);
+        OICFree(entry->options);
+        OICFree(entry->proxyUri);
+        OICFree(entry);
+    }
+}
+
+static void CHPCacheRemoveEntry(CHPCacheEntry_t *entry)
+{
+    u_hashmap_remove(g_cache, entry->proxyUri);
+    CHPCacheFreeEntry(entry);
+}
+
+/* Make room for a new entry by dropping the one closest to (or past) expiry. */
+static void CHPCacheEvict()
+{
+    CHPCacheEntry_t *oldest = NULL;
+    CHPCacheEntry_t *entry = NULL;
+    uint32_t iter = 0;
+    while (NULL != (entry = u_hashmap_next(g_cache, &iter)))
+    {
+        if (!oldest || entry->expiry < oldest->expiry)
+        {
+            oldest = entry;
+        }
+    }
+
+    if (oldest)
+    {
+        CHPCacheRemoveEntry(oldest);
+    }
+}
+
+OCStackResult CHPCacheInitialize()
+{
+    if (g_cache)
+    {
+        return OC_STACK_OK;
+    }
+
+    g_cacheMutex = oc_mutex_new();
+    if (!g_cacheMutex)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create mutex");
+        return OC_STACK_ERROR;
+    }
+
+    g_cache = u_hashmap_create(u_hashmap_hash_string, u_hashmap_equal_string);
+    if (!g_cache)
+    {
+        OIC_LOG(ERROR, TAG, "Failed to create cache");
+        oc_mutex_free(g_cacheMutex);
+        g_cacheMutex = NULL;
+        return OC_STACK_NO_MEMORY;
+    }
+
+    return OC_STACK_OK;
+}
+
+void CHPCacheTerminate()
+{
+    if (!g_cache)
+    {
+        return;
+    }
+
+    oc_mutex_lock(g_cacheMutex);
+    CHPCacheEntry_t *entry = NULL;
+    uint32_t iter = 0;
+    while (NULL != (entry = u_hashmap_next(g_cache, &iter)))
+    {
+        CHPCacheRemoveEntry(entry);
+        iter = 0;
+    }
+    u_hashmap_free(&g_cache);
+    oc_mutex_unlock(g_cacheMutex);
+
+    oc_mutex_free(g_cacheMutex);
+    g_cacheMutex = NULL;
+}
+
+bool CHPCacheGetResponse(const char *proxyUri, OCEntityHandlerResponse *response)
+{
+    VERIFY_NON_NULL_RET(proxyUri, TAG, "proxyUri", false);
+    VERIFY_NON_NULL_RET(response, TAG, "response", false);
+
+    if (!g_cache)
+    {
+        return false;
+    }
+
+    bool hit = false;
+    oc_mutex_lock(g_cacheMutex);
+    CHPCacheEntry_t *entry = u_hashmap_get(g_cache, proxyUri);
+    if (entry)
+    {
+        uint64_t now = OICGetCurrentTime(TIME_IN_MS);
+        if (now >= entry->expiry)
+        {
+            OIC_LOG_V(DEBUG, TAG, "Cached response for %s is stale", proxyUri);
+            CHPCacheRemoveEntry(entry);
+        }
+        else
+        {
+            response->payload = (OCPayload *)OCRepPayloadClone(entry->payload);
+            if (response->payload || !entry->payload)
+            {
+                if (entry->numOptions)
+                {
+                    memcpy(response->sendVendorSpecificHeaderOptions, entry->options,
+                           entry->numOptions * sizeof(OCHeaderOption));
+                }
+                response->numSendVendorSpecificHeaderOptions = entry->numOptions;
+
+                // Served responses carry the remaining freshness lifetime (RFC 7252, 5.6.1).
+                if (response->numSendVendorSpecificHeaderOptions < MAX_HEADER_OPTIONS)
+                {
+                    CHPSetMaxAgeOption((uint32_t)((entry->expiry - now) / 1000),
+                        &response->sendVendorSpecificHeaderOptions[
+                            response->numSendVendorSpecificHeaderOptions++]);
+                }
+                response->ehResult = OC_EH_CONTENT;
+                hit = true;
+            }
+        }
+    }
+    oc_mutex_unlock(g_cacheMutex);
+
+    OIC_LOG_V(DEBUG, TAG, "Cache %s for %s", hit ? "hit" : "miss", proxyUri);
+    return hit;
+}
+
+void CHPCachePutResponse(const char *proxyUri, const OCEntityHandlerResponse *response,
+                         uint32_t maxAge)
+{
+    VERIFY_NON_NULL_VOID(proxyUri, TAG, "proxyUri");
+    VERIFY_NON_NULL_VOID(response, TAG, "response");
+
+    if (!g_cache || 0 == maxAge ||
+        (response->payload && PAYLOAD_TYPE_REPRESENTATION != response->payload->type))
+    {
+        return;
+    }
+
+    CHPCacheEntry_t *entry = (CHPCacheEntry_t *)OICCalloc(1, sizeof(CHPCacheEntry_t));
+    if (!entry)
+    {
+        OIC_LOG(ERROR, TAG, "Memory allocation failed");
+        return;
+    }
+
+    entry->proxyUri = OICStrdup(proxyUri);
+    if (response->payload)
+    {
+        entry->payload = OCRepPayloadClone((OCRepPayload *)response->payload);
+    }
+    if (response->numSendVendorSpecificHeaderOptions)
+    {
+        entry->numOptions = response->numSendVendorSpecificHeaderOptions;
+        entry->options = (OCHeaderOption *)OICMalloc(entry->numOptions * sizeof(OCHeaderOption));
+        if (entry->options)
+        {
+            memcpy(entry->options, response->sendVendorSpecificHeaderOptions,
+                   entry->numOptions * sizeof(OCHeaderOption));
+        }
+    }
+    if (!entry->proxyUri || (response->payload && !entry->payload) ||
+        (entry->numOptions && !entry->options))
+    {
+        OIC_LOG(ERROR, TAG, "Memory allocation failed");
+        CHPCacheFreeEntry(entry);
+        return;
+    }
+    entry->expiry = OICGetCurrentTime(TIME_IN_MS) + (uint64_t)maxAge * 1000;
+
+    oc_mutex_lock(g_cacheMutex);
+    CHPCacheEntry_t *old = u_hashmap_get(g_cache, proxyUri);
+    if (old)
+    {
+        CHPCacheRemoveEntry(old);
+    }
+    else if (u_hashmap_length(g_cache) >= CHP_CACHE_MAX_ENTRIES)
+    {
+        CHPCacheEvict();
+    }
+
+    if (!u_hashmap_put(g_cache, entry->proxyUri, entry))
+    {
+        OIC_LOG(ERROR, TAG, "Failed to add cache entry");
+        CHPCacheFreeEntry(entry);
+    }
+    oc_mutex_unlock(g_cacheMutex);
+    OIC_LOG_V(DEBUG, TAG, "Cached %s for %u seconds", proxyUri, maxAge);
+}
+
+void CHPCacheInvalidate(const char *proxyUri)
+{
+    VERIFY_NON_NULL_VOID(proxyUri, TAG, "proxyUri");
+
+    if (!g_cache)
+    {
+        return;
+    }
+
+    oc_mutex_lock(g_cacheMutex);
+    CHPCacheEntry_t *entry = u_hashmap_get(g_cache, proxyUri);
+    if (entry)
+    {
+        OIC_LOG_V(DEBUG, TAG, "Invalidating cached response for %s", proxyUri);
+        CHPCacheRemoveEntry(entry);
+    }
+    oc_mutex_unlock(g_cacheMutex);
+}
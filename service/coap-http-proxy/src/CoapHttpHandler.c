@@ -27,7 +27,7 @@
 #include "uarraylist.h"
 #include "CoapHttpParser.h"
 #include "CoapHttpMap.h"
-#include "cJSON.h"
+#include "CoapHttpCache.h"
 
 #define TAG "CHPHandler"
 
@@ -42,6 +42,7 @@ typedef struct
 {
     OCMethod method;
     OCRequestHandle requestHandle;
+    char proxyUri[MAX_HEADER_OPTION_DATA_LENGTH];
 } CHPRequest_t;
 
 /**
@@ -83,10 +84,19 @@ OCStackResult CHPInitialize(bool secure)
         return result;
     }
 
+    result = CHPCacheInitialize();
+    if (OC_STACK_OK != result)
+    {
+        OIC_LOG_V(ERROR, TAG, "Cache initialization failed[%d]", result);
+        CHPParserTerminate();
+        return result;
+    }
+
     result = OCSetProxyURI(OC_RSRVD_PROXY_URI);
     if (OC_STACK_OK != result)
     {
         OIC_LOG_V(ERROR, TAG, "Setting proxy uri failed[%d]", result);
+        CHPCacheTerminate();
         CHPParserTerminate();
         return result;
     }
@@ -107,6 +117,7 @@ OCStackResult CHPInitialize(bool secure)
     if (OC_STACK_OK != result)
     {
         OIC_LOG_V(ERROR, TAG, "Create resource for proxy failed[%d]", result);
+        CHPCacheTerminate();
         CHPParserTerminate();
         return result;
     }
@@ -124,6 +135,7 @@ OCStackResult CHPTerminate()
     {
         OIC_LOG_V(ERROR, TAG, "Parser termination failed[%d]", result);
     }
+    CHPCacheTerminate();
 
     result = OCDeleteResource(g_proxyHandle);
     if (OC_STACK_OK != result)
@@ -305,9 +317,6 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
         return;
     }
 
-    // ctxt not required now.
-    OICFree(ctxt);
-
     if (httpResponse->dataFormat[0] != '\0')
     {
         OCPayloadFormat format = CHPGetOCContentType(httpResponse->dataFormat);
@@ -325,13 +334,16 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
                     {
                         OIC_LOG(ERROR, TAG, "Error sending response");
                     }
+                    OICFree(ctxt);
                     return;
                 }
                 break;
             case OC_FORMAT_JSON:
                 OIC_LOG(DEBUG, TAG, "Payload format is JSON");
-                cJSON *payloadJson = cJSON_Parse((char *)httpResponse->payload);
-                if (!payloadJson)
+                response.payload = (OCPayload *)CHPJsonToRepPayload(
+                                                    (const char *)httpResponse->payload,
+                                                    httpResponse->payloadLength);
+                if (!response.payload)
                 {
                     OIC_LOG(ERROR, TAG, "Unable to parse json response");
                     response.ehResult = OC_EH_INTERNAL_SERVER_ERROR;
@@ -339,23 +351,9 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
                     {
                         OIC_LOG(ERROR, TAG, "Error sending response");
                     }
+                    OICFree(ctxt);
                     return;
                 }
-                OCRepPayload* payloadCbor = OCRepPayloadCreate();
-                if (!payloadCbor)
-                {
-                    response.ehResult = OC_EH_INTERNAL_SERVER_ERROR;
-                    if (OCDoResponse(&response) != OC_STACK_OK)
-                    {
-                        OIC_LOG(ERROR, TAG, "Error sending response");
-                    }
-                    cJSON_Delete(payloadJson);
-                    return;
-                }
-
-                CHPJsonToRepPayload(payloadJson, payloadCbor);
-                response.payload = (OCPayload *)payloadCbor;
-                cJSON_Delete(payloadJson);
                 break;
             default:
                 OIC_LOG(ERROR, TAG, "Payload format is not supported");
@@ -364,6 +362,7 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
                 {
                     OIC_LOG(ERROR, TAG, "Error sending response");
                 }
+                OICFree(ctxt);
                 return;
         }
     }
@@ -389,12 +388,31 @@ void CHPHandleHttpResponse(const HttpResponse_t *httpResponse, void *context)
         optionsPointer += 1;
     }
 
+    uint32_t maxAge = 0;
+    if (CHPGetHttpMaxAge(httpResponse->headerOptions, &maxAge))
+    {
+        if (OC_REST_GET == ctxt->method && OC_EH_CONTENT == response.ehResult)
+        {
+            // Cache before Max-Age is added; it is recomputed when the entry is served.
+            CHPCachePutResponse(ctxt->proxyUri, &response, maxAge);
+        }
+
+        if (response.numSendVendorSpecificHeaderOptions < MAX_HEADER_OPTIONS)
+        {
+            CHPSetMaxAgeOption(maxAge, optionsPointer);
+            response.numSendVendorSpecificHeaderOptions++;
+        }
+    }
+
+    // ctxt not required now.
+    OICFree(ctxt);
+
     if (OCDoResponse(&response) != OC_STACK_OK)
     {
         OIC_LOG(ERROR, TAG, "Error sending response");
     }
 
-    //OICFree(coapResponseInfo.info.payload);
+    OCPayloadDestroy(response.payload);
     OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
 }
 
@@ -421,6 +439,25 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
         return OC_STACK_ERROR;
     }
 
+    if (OC_REST_GET == requestInfo->method)
+    {
+        if (CHPCacheGetResponse(proxyUri, &response))
+        {
+            if (OCDoResponse(&response) != OC_STACK_OK)
+            {
+                OIC_LOG(ERROR, TAG, "Error sending response");
+            }
+
+            OCPayloadDestroy(response.payload);
+            return OC_STACK_OK;
+        }
+    }
+    else
+    {
+        // Unsafe methods invalidate the stored response (RFC 7252, 5.9).
+        CHPCacheInvalidate(proxyUri);
+    }
+
     uint8_t vendorOptions = requestInfo->numRcvdVendorSpecificHeaderOptions;
     if (vendorOptions)
     {
@@ -444,8 +481,9 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
     if (requestInfo->payload && requestInfo->payload->type == PAYLOAD_TYPE_REPRESENTATION)
     {
         // Conversion from cbor to json.
-        cJSON *payloadJson = CHPRepPayloadToJson((OCRepPayload *)requestInfo->payload);
-        if (!payloadJson)
+        httpRequest.payload = CHPRepPayloadToJson((OCRepPayload *)requestInfo->payload,
+                                                  &httpRequest.payloadLength);
+        if (!httpRequest.payload)
         {
             response.ehResult = OC_EH_BAD_REQ;
             if (OCDoResponse(&response) != OC_STACK_OK)
@@ -453,14 +491,11 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
                 OIC_LOG(ERROR, TAG, "Error sending response");
             }
 
+            u_arraylist_destroy(httpRequest.headerOptions);
             return OC_STACK_ERROR;
-
         }
-        httpRequest.payload = (void *)cJSON_Print(payloadJson);
-        httpRequest.payloadLength = strlen(httpRequest.payload);
         OICStrcpy(httpRequest.payloadFormat, sizeof(httpRequest.payloadFormat),
-                  CBOR_CONTENT_TYPE);
-        cJSON_Delete(payloadJson);
+                  JSON_CONTENT_TYPE);
     }
 
     OICStrcpy(httpRequest.acceptFormat, sizeof(httpRequest.acceptFormat),
@@ -482,6 +517,7 @@ OCStackResult CHPHandleOCFRequest(const OCEntityHandlerRequest* requestInfo,
 
     chpRequest->requestHandle = requestInfo->requestHandle;
     chpRequest->method = requestInfo->method;
+    OICStrcpy(chpRequest->proxyUri, sizeof(chpRequest->proxyUri), proxyUri);
 
     result = CHPPostHttpRequest(&httpRequest, CHPHandleHttpResponse,
                                 (void *)chpRequest);
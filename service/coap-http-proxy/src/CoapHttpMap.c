@@ -19,7 +19,12 @@
  ******************************************************************/
 
 #include "CoapHttpMap.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include "oic_malloc.h"
 #include "oic_string.h"
 #include "logger.h"
@@ -29,6 +34,10 @@
 
 #define TAG "CHPMap"
 
+#define CHP_JSON_INITIAL_SIZE (256)
+#define CHP_JSON_INITIAL_ARRAY_SIZE (8)
+#define CHP_JSON_MAX_DEPTH (32)
+
 int CHPGetOptionID(const char *httpOptionName)
 {
     if (!httpOptionName)
@@ -37,13 +46,10 @@ int CHPGetOptionID(const char *httpOptionName)
         return 0;
     }
 
+    // Cache-Control is mapped to Max-Age by CHPGetHttpMaxAge(). Expires is relative to
+    // the Date header and is not mapped.
     OICStringToLower((char *)httpOptionName);
-    if (0 == strcmp(httpOptionName, HTTP_OPTION_CACHE_CONTROL) ||
-        0 == strcmp(httpOptionName, HTTP_OPTION_EXPIRES))
-    {
-        return COAP_OPTION_MAXAGE;
-    }
-    else if (0 == strcmp(httpOptionName, HTTP_OPTION_IF_MATCH))
+    if (0 == strcmp(httpOptionName, HTTP_OPTION_IF_MATCH))
     {
         return COAP_OPTION_IF_MATCH;
     }
@@ -259,262 +265,1028 @@ OCStackResult CHPGetHttpOption(const OCHeaderOption* option, HttpHeaderOption_t*
     return OC_STACK_OK;
 }
 
-void CHPJsonToRepPayload(cJSON* rootJSon, OCRepPayload* payload)
+bool CHPGetHttpMaxAge(const u_arraylist_t *headerOptions, uint32_t *maxAge)
 {
-    cJSON* dataJson = rootJSon->child;
-    while (dataJson)
+    VERIFY_NON_NULL_RET(maxAge, TAG, "maxAge", false);
+
+    bool found = false;
+    bool hasSharedMaxAge = false;
+    uint32_t age = 0;
+    *maxAge = 0;
+
+    uint32_t count = u_arraylist_length(headerOptions);
+    for (uint32_t i = 0; i < count; i++)
     {
-        switch (dataJson->type)
+        HttpHeaderOption_t *option = u_arraylist_get(headerOptions, i);
+        if (option && 0 == strcasecmp(option->optionName, HTTP_OPTION_AGE))
         {
-            case cJSON_String:
-                OCRepPayloadSetPropString(payload, dataJson->string, dataJson->valuestring);
-                break;
-            case cJSON_Number:
-                if (dataJson->valueint == dataJson->valuedouble)
-                {
-                    OCRepPayloadSetPropInt(payload, dataJson->string, dataJson->valueint);
-                }
-                else
-                {
-                    OCRepPayloadSetPropDouble(payload, dataJson->string, dataJson->valuedouble);
-                }
-                break;
-            case cJSON_False:
-                OCRepPayloadSetPropBool(payload, dataJson->string, false);
-                break;
-            case cJSON_True:
-                OCRepPayloadSetPropBool(payload, dataJson->string, true);
-                break;
-            case cJSON_Object:
+            // Time the response already spent in upstream caches.
+            char *end = NULL;
+            unsigned long long seconds = strtoull(option->optionData, &end, 10);
+            if (end != option->optionData)
             {
-                OCRepPayload* childPayload = OCRepPayloadCreate();
-                CHPJsonToRepPayload(dataJson,childPayload);
-                OCRepPayloadSetPropObject(payload, dataJson->string,childPayload );
-                break;
+                age = seconds > UINT32_MAX ? UINT32_MAX : (uint32_t)seconds;
+            }
+            continue;
+        }
+        if (!option || 0 != strcasecmp(option->optionName, HTTP_OPTION_CACHE_CONTROL))
+        {
+            continue;
+        }
+
+        char directives[CHP_MAX_HF_DATA_LENGTH];
+        OICStrcpy(directives, sizeof(directives), option->optionData);
+        OICStringToLower(directives);
+
+        char *savePtr = NULL;
+        for (char *token = strtok_r(directives, ",", &savePtr); token;
+             token = strtok_r(NULL, ",", &savePtr))
+        {
+            while (' ' == *token || '\t' == *token)
+            {
+                token++;
+            }
+
+            if (0 == strncmp(token, "no-store", 8) || 0 == strncmp(token, "no-cache", 8) ||
+                0 == strncmp(token, "private", 7))
+            {
+                // Response must not be served again without revalidation.
+                *maxAge = 0;
+                return true;
+            }
+
+            // s-maxage takes precedence over max-age for a shared cache like the proxy.
+            bool isShared = (0 == strncmp(token, "s-maxage=", 9));
+            if (!isShared && 0 != strncmp(token, "max-age=", 8))
+            {
+                continue;
             }
-            case cJSON_Array:
+            if (hasSharedMaxAge && !isShared)
             {
-                int size = cJSON_GetArraySize(dataJson);
-                size_t dimensions[MAX_REP_ARRAY_DEPTH];
-                dimensions[0] = size;
-                dimensions[1] = dimensions[2] = 0;
+                continue;
+            }
 
-                int i = 0;
-                int type = cJSON_IsReference;
-                int numType = 0;    // int:1, double:2
-                const int intType = 1;
-                const int doubleType = 2;
+            char *end = NULL;
+            const char *value = strchr(token, '=') + 1;
+            if ('"' == *value)
+            {
+                value++;
+            }
+            unsigned long long seconds = strtoull(value, &end, 10);
+            if (end == value)
+            {
+                continue;
+            }
 
-                int64_t intArray[size];
-                double doubleArray[size];
-                char* strArray[size];
-                OCRepPayload* objPayloadArray[size];
+            *maxAge = seconds > UINT32_MAX ? UINT32_MAX : (uint32_t)seconds;
+            hasSharedMaxAge = isShared;
+            found = true;
+        }
+    }
 
-                for (; i < size ; ++i)
-                {
-                    cJSON* subitem = cJSON_GetArrayItem(dataJson, i);
-                    if (subitem == NULL)
-                    {
-                        continue;
-                    }
+    // Only the remaining freshness may be cached or advertised downstream.
+    *maxAge = *maxAge > age ? *maxAge - age : 0;
+    return found;
+}
 
-                    if ((type != cJSON_IsReference) && (type != subitem->type))
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        type = subitem->type;
-                        switch (type)
-                        {
-                            case cJSON_Number:
-                                if (subitem->valueint == subitem->valuedouble)
-                                {
-                                    numType = intType;
-                                    intArray[i] = (int64_t) subitem->valueint;
-                                }
-                                else
-                                {
-                                    numType = doubleType;
-                                    doubleArray[i] = subitem->valuedouble;
-                                }
-                                break;
-                            case cJSON_String:
-                                strArray[i] = subitem->valuestring;
-                                break;
-                            case cJSON_Object:
-                                objPayloadArray[i] = OCRepPayloadCreate();
-                                CHPJsonToRepPayload(subitem,objPayloadArray[i]);
-                                break;
-                            default:
-                                OIC_LOG(ERROR, TAG, "wrong ArrayType in JsonToRepPayload()");
-                                break;
-                        }
-                    }
-                }
+void CHPSetMaxAgeOption(uint32_t maxAge, OCHeaderOption *option)
+{
+    VERIFY_NON_NULL_VOID(option, TAG, "option");
 
-                switch (type)
-                {
-                    case cJSON_Number:
-                    if (numType == intType)
-                    {
-                        OCRepPayloadSetIntArray(payload, dataJson->string,(const int64_t*)intArray,
-                                                dimensions);
-                    }
-                    else if (numType == doubleType)
-                    {
-                        OCRepPayloadSetDoubleArray(payload, dataJson->string,
-                                                   (const double*)doubleArray,
-                                                   dimensions);
-                    }
-                    break;
-                    case cJSON_String:
-                        OCRepPayloadSetStringArray(payload, dataJson->string,
-                                                   (const char**)strArray,
-                                                   dimensions);
-                    break;
-                    case cJSON_Object:
-                        OCRepPayloadSetPropObjectArray(payload, dataJson->string,
-                                                       (const OCRepPayload**)objPayloadArray,
-                                                       dimensions);
-                        break;
-                  default:
-                        OIC_LOG(ERROR, TAG, "wrong ArrayType in JsonToRepPayload()");
-                        break;
-                }
+    // CoAP uint options are sent in network byte order without leading zero bytes.
+    option->protocolID = OC_COAP_ID;
+    option->optionID = COAP_OPTION_MAXAGE;
+    option->optionLength = 0;
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        uint8_t byte = (maxAge >> shift) & 0xFF;
+        if (byte || option->optionLength)
+        {
+            option->optionData[option->optionLength++] = byte;
+        }
+    }
+}
+
+/**
+ * Growable output buffer used to serialize a representation as Json text.
+ */
+typedef struct
+{
+    char *buffer;
+    size_t length;
+    size_t capacity;
+    bool failed;
+} CHPJsonWriter_t;
+
+static void CHPJsonWrite(CHPJsonWriter_t *writer, const char *data, size_t length)
+{
+    if (writer->failed)
+    {
+        return;
+    }
+
+    if (writer->length + length + 1 > writer->capacity)
+    {
+        size_t capacity = writer->capacity ? writer->capacity : CHP_JSON_INITIAL_SIZE;
+        while (writer->length + length + 1 > capacity)
+        {
+            capacity *= 2;
+        }
+
+        char *buffer = OICRealloc(writer->buffer, capacity);
+        if (!buffer)
+        {
+            OIC_LOG(ERROR, TAG, "Json buffer allocation failed");
+            writer->failed = true;
+            return;
+        }
+        writer->buffer = buffer;
+        writer->capacity = capacity;
+    }
+
+    memcpy(writer->buffer + writer->length, data, length);
+    writer->length += length;
+    writer->buffer[writer->length] = '\0';
+}
+
+static void CHPJsonWriteChar(CHPJsonWriter_t *writer, char c)
+{
+    CHPJsonWrite(writer, &c, 1);
+}
+
+static void CHPJsonWriteString(CHPJsonWriter_t *writer, const char *str)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    CHPJsonWriteChar(writer, '"');
+    const char *run = str;
+    for (const char *c = str; *c; c++)
+    {
+        unsigned char ch = (unsigned char)*c;
+        if (ch >= 0x20 && '"' != ch && '\\' != ch)
+        {
+            continue;
+        }
+
+        CHPJsonWrite(writer, run, c - run);
+        run = c + 1;
+        switch (ch)
+        {
+            case '"':  CHPJsonWrite(writer, "\\\"", 2); break;
+            case '\\': CHPJsonWrite(writer, "\\\\", 2); break;
+            case '\b': CHPJsonWrite(writer, "\\b", 2); break;
+            case '\f': CHPJsonWrite(writer, "\\f", 2); break;
+            case '\n': CHPJsonWrite(writer, "\\n", 2); break;
+            case '\r': CHPJsonWrite(writer, "\\r", 2); break;
+            case '\t': CHPJsonWrite(writer, "\\t", 2); break;
+            default:
+            {
+                char escaped[] = { '\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0x0F] };
+                CHPJsonWrite(writer, escaped, sizeof(escaped));
                 break;
             }
         }
-        dataJson = dataJson->next;
     }
+    CHPJsonWrite(writer, run, strlen(run));
+    CHPJsonWriteChar(writer, '"');
 }
 
-cJSON* CHPRepPayloadToJson(OCRepPayload* repData)
+static void CHPJsonWriteInt(CHPJsonWriter_t *writer, int64_t value)
 {
-    cJSON *outJson = cJSON_CreateObject();
-    if (outJson == NULL)
+    char number[24];
+    int length = snprintf(number, sizeof(number), "%" PRId64, value);
+    CHPJsonWrite(writer, number, length);
+}
+
+static void CHPJsonWriteDouble(CHPJsonWriter_t *writer, double value)
+{
+    if (!isfinite(value))
     {
-        return NULL;
+        // Json has no representation for NaN or infinity.
+        CHPJsonWrite(writer, "null", 4);
+        return;
+    }
+
+    char number[32];
+    int length = snprintf(number, sizeof(number), "%.17g", value);
+    CHPJsonWrite(writer, number, length);
+}
+
+static void CHPJsonWriteBool(CHPJsonWriter_t *writer, bool value)
+{
+    if (value)
+    {
+        CHPJsonWrite(writer, "true", 4);
+    }
+    else
+    {
+        CHPJsonWrite(writer, "false", 5);
+    }
+}
+
+static void CHPJsonWriteObject(CHPJsonWriter_t *writer, const OCRepPayload *repData);
+
+static bool CHPIsJsonArrayType(OCRepPayloadPropType type)
+{
+    return OCREP_PROP_INT == type || OCREP_PROP_DOUBLE == type || OCREP_PROP_BOOL == type ||
+           OCREP_PROP_STRING == type || OCREP_PROP_OBJECT == type;
+}
+
+static void CHPJsonWriteArray(CHPJsonWriter_t *writer, const OCRepPayloadValueArray *arr,
+                              size_t dim, size_t *index)
+{
+    CHPJsonWriteChar(writer, '[');
+    for (size_t i = 0; i < arr->dimensions[dim]; i++)
+    {
+        if (i)
+        {
+            CHPJsonWriteChar(writer, ',');
+        }
+
+        if (dim + 1 < MAX_REP_ARRAY_DEPTH && arr->dimensions[dim + 1])
+        {
+            CHPJsonWriteArray(writer, arr, dim + 1, index);
+            continue;
+        }
+
+        size_t pos = (*index)++;
+        switch (arr->type)
+        {
+            case OCREP_PROP_INT:
+                CHPJsonWriteInt(writer, arr->iArray[pos]);
+                break;
+            case OCREP_PROP_DOUBLE:
+                CHPJsonWriteDouble(writer, arr->dArray[pos]);
+                break;
+            case OCREP_PROP_BOOL:
+                CHPJsonWriteBool(writer, arr->bArray[pos]);
+                break;
+            case OCREP_PROP_STRING:
+                CHPJsonWriteString(writer, arr->strArray[pos] ? arr->strArray[pos] : "");
+                break;
+            case OCREP_PROP_OBJECT:
+                CHPJsonWriteObject(writer, arr->objArray[pos]);
+                break;
+            default:
+                break;
+        }
     }
+    CHPJsonWriteChar(writer, ']');
+}
 
-    OCRepPayloadValue* val = repData->values;
-    while (val)
+static void CHPJsonWriteObject(CHPJsonWriter_t *writer, const OCRepPayload *repData)
+{
+    bool first = true;
+
+    CHPJsonWriteChar(writer, '{');
+    for (OCRepPayloadValue *val = repData ? repData->values : NULL; val; val = val->next)
     {
+        if ((OCREP_PROP_ARRAY == val->type && !CHPIsJsonArrayType(val->arr.type)) ||
+            OCREP_PROP_BYTE_STRING == val->type)
+        {
+            OIC_LOG_V(ERROR, TAG, "Unknown/unsupported type: %s", val->name);
+            continue;
+        }
+
+        if (!first)
+        {
+            CHPJsonWriteChar(writer, ',');
+        }
+        first = false;
+
+        CHPJsonWriteString(writer, val->name);
+        CHPJsonWriteChar(writer, ':');
         switch (val->type)
         {
             case OCREP_PROP_NULL:
+                CHPJsonWrite(writer, "null", 4);
                 break;
             case OCREP_PROP_INT:
-                OIC_LOG_V(DEBUG, TAG, "%s(int):%d", val->name, (int)val->i);
-                cJSON_AddNumberToObject(outJson,val->name,(int)val->i);
+                CHPJsonWriteInt(writer, val->i);
                 break;
             case OCREP_PROP_DOUBLE:
-                OIC_LOG_V(DEBUG, TAG, "%s(double):%f", val->name, val->d);
-                cJSON_AddNumberToObject(outJson,val->name,val->d);
+                CHPJsonWriteDouble(writer, val->d);
                 break;
             case OCREP_PROP_BOOL:
-                OIC_LOG_V(DEBUG, TAG, "%s(bool):%s", val->name, val->b ? "true" : "false");
-                cJSON_AddBoolToObject(outJson,val->name,val->b);
+                CHPJsonWriteBool(writer, val->b);
                 break;
             case OCREP_PROP_STRING:
-                OIC_LOG_V(DEBUG, TAG, "%s(string):%s", val->name, val->str);
-                cJSON_AddStringToObject(outJson,val->name,val->str);
+                CHPJsonWriteString(writer, val->str);
                 break;
             case OCREP_PROP_OBJECT:
+                CHPJsonWriteObject(writer, val->obj);
+                break;
+            case OCREP_PROP_ARRAY:
             {
-                cJSON *objJson = CHPRepPayloadToJson(val->obj);
-                if (objJson != NULL)
-                {
-                    cJSON_AddItemToObject(outJson,val->name,objJson);
-                }
+                size_t index = 0;
+                CHPJsonWriteArray(writer, &val->arr, 0, &index);
                 break;
             }
-            case OCREP_PROP_ARRAY:
+            default:
+                break;
+        }
+    }
+    CHPJsonWriteChar(writer, '}');
+}
+
+char* CHPRepPayloadToJson(const OCRepPayload* repData, size_t *length)
+{
+    VERIFY_NON_NULL_RET(repData, TAG, "repData", NULL);
+
+    if (!repData->values)
+    {
+        return NULL;
+    }
+
+    CHPJsonWriter_t writer = { .buffer = NULL };
+    CHPJsonWriteObject(&writer, repData);
+    if (writer.failed)
+    {
+        OICFree(writer.buffer);
+        return NULL;
+    }
+
+    if (length)
+    {
+        *length = writer.length;
+    }
+    return writer.buffer;
+}
+
+/**
+ * Cursor over Json text being parsed into a representation.
+ */
+typedef struct
+{
+    const char *cur;
+    const char *end;
+    int depth;
+} CHPJsonReader_t;
+
+/**
+ * Parsed array element, kept until the array type is known.
+ */
+typedef struct
+{
+    OCRepPayloadPropType type;
+    union
+    {
+        int64_t i;
+        double d;
+        bool b;
+        char *str;
+        OCRepPayload *obj;
+    } value;
+} CHPJsonElement_t;
+
+static OCRepPayload* CHPJsonParseObject(CHPJsonReader_t *reader);
+
+static void CHPJsonSkipSpace(CHPJsonReader_t *reader)
+{
+    while (reader->cur < reader->end && (' ' == *reader->cur || '\t' == *reader->cur ||
+                                         '\n' == *reader->cur || '\r' == *reader->cur))
+    {
+        reader->cur++;
+    }
+}
+
+static bool CHPJsonConsume(CHPJsonReader_t *reader, char c)
+{
+    CHPJsonSkipSpace(reader);
+    if (reader->cur < reader->end && c == *reader->cur)
+    {
+        reader->cur++;
+        return true;
+    }
+    return false;
+}
+
+static bool CHPJsonConsumeLiteral(CHPJsonReader_t *reader, const char *literal)
+{
+    size_t length = strlen(literal);
+    if ((size_t)(reader->end - reader->cur) < length ||
+        0 != memcmp(reader->cur, literal, length))
+    {
+        return false;
+    }
+    reader->cur += length;
+    return true;
+}
+
+static bool CHPJsonParseHex(CHPJsonReader_t *reader, uint32_t *value)
+{
+    if (reader->end - reader->cur < 4)
+    {
+        return false;
+    }
+
+    *value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char c = *reader->cur++;
+        *value <<= 4;
+        if (c >= '0' && c <= '9')
+        {
+            *value |= c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            *value |= c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            *value |= c - 'A' + 10;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static char* CHPJsonParseString(CHPJsonReader_t *reader)
+{
+    if (!CHPJsonConsume(reader, '"'))
+    {
+        return NULL;
+    }
+
+    // Escapes only ever shrink, so the raw length bounds the decoded string.
+    const char *close = reader->cur;
+    while (close < reader->end && '"' != *close)
+    {
+        close += ('\\' == *close) ? 2 : 1;
+    }
+    if (close >= reader->end)
+    {
+        return NULL;
+    }
+
+    char *str = OICMalloc(close - reader->cur + 1);
+    if (!str)
+    {
+        OIC_LOG(ERROR, TAG, "Memory allocation failed");
+        return NULL;
+    }
+
+    char *out = str;
+    while ('"' != *reader->cur)
+    {
+        char c = *reader->cur++;
+        if ('\\' != c)
+        {
+            *out++ = c;
+            continue;
+        }
+
+        c = *reader->cur++;
+        switch (c)
+        {
+            case '"':
+            case '\\':
+            case '/':
+                *out++ = c;
+                break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u':
             {
-                unsigned int i = 0;
-                int arraySize = (int)val->arr.dimensions[0];
-                switch (val->arr.type)
+                uint32_t code = 0;
+                if (!CHPJsonParseHex(reader, &code) || 0 == code)
+                {
+                    goto error;
+                }
+                if (code >= 0xD800 && code <= 0xDBFF)
+                {
+                    uint32_t low = 0;
+                    if (!CHPJsonConsumeLiteral(reader, "\\u") || !CHPJsonParseHex(reader, &low) ||
+                        low < 0xDC00 || low > 0xDFFF)
+                    {
+                        goto error;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (code >= 0xDC00 && code <= 0xDFFF)
+                {
+                    // A low surrogate without its high half is not a character.
+                    goto error;
+                }
+
+                // Encode as UTF-8; never longer than the escape it replaces.
+                if (code < 0x80)
+                {
+                    *out++ = (char)code;
+                }
+                else if (code < 0x800)
+                {
+                    *out++ = (char)(0xC0 | (code >> 6));
+                    *out++ = (char)(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000)
+                {
+                    *out++ = (char)(0xE0 | (code >> 12));
+                    *out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (code & 0x3F));
+                }
+                else
                 {
-                    case OCREP_PROP_INT:
-                        OIC_LOG_V(DEBUG, TAG, "%s(int array)", val->name);
-                        if (arraySize > 0)
-                        {
-                            int castVal[val->arr.dimensions[0]];
-                            for (i = 0 ; i < (unsigned int)arraySize ; i++)
-                            {
-                                castVal[i] = (int)val->arr.iArray[i];
-                            }
-                            cJSON *array = cJSON_CreateIntArray(castVal,arraySize);
-                            if (array != NULL)
-                            {
-                                cJSON_AddItemToObject(outJson,val->name,array);
-                            }
-                        }
-                        break;
-                    case OCREP_PROP_DOUBLE:
-                        OIC_LOG_V(DEBUG, TAG, "%s(double array)", val->name);
-                        if (arraySize > 0)
-                        {
-                            cJSON *array = cJSON_CreateDoubleArray(val->arr.dArray,arraySize);
-                            if (array != NULL)
-                            {
-                                cJSON_AddItemToObject(outJson,val->name,array);
-                            }
-                        }
-                        break;
-                    case OCREP_PROP_STRING:
-                        OIC_LOG_V(DEBUG, TAG, "%s(string array)", val->name);
-                        if (arraySize > 0)
-                        {
-                            cJSON *array = cJSON_CreateStringArray((const char**)val->arr.strArray,
-                                                                   arraySize);
-                            if (array != NULL)
-                            {
-                                cJSON_AddItemToObject(outJson,val->name,array);
-                            }
-                        }
-                        break;
-                    case OCREP_PROP_OBJECT:
-                        if (arraySize > 0)
-                        {
-                            cJSON *arrayJson = cJSON_CreateArray();
-                            for (i = 0 ; i < (unsigned int)arraySize ; i++)
-                            {
-                                cJSON *objJson = CHPRepPayloadToJson(val->arr.objArray[i]);
-                                if (objJson != NULL && arrayJson != NULL)
-                                {
-                                    cJSON_AddItemToArray(arrayJson, objJson);
-                                }
-                            }
-                            if (arrayJson != NULL)
-                            {
-                                cJSON_AddItemToObject(outJson,val->name,arrayJson);
-                            }
-                        }
-                        break;
-                    case OCREP_PROP_BOOL:
-                        //TODO : Not support - cJSON_CreateBoolArray
-                        break;
-                    default:
-                        OIC_LOG_V(ERROR, TAG, "Unknown/unsupported array type: %s", val->name);
-                        break;
+                    *out++ = (char)(0xF0 | (code >> 18));
+                    *out++ = (char)(0x80 | ((code >> 12) & 0x3F));
+                    *out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (code & 0x3F));
                 }
                 break;
             }
             default:
-                OIC_LOG_V(ERROR, TAG, "Unknown type: %s", val->name);
-                break;
+                goto error;
+        }
+
+        if (reader->cur >= reader->end)
+        {
+            goto error;
+        }
+    }
+
+    reader->cur++;
+    *out = '\0';
+    return str;
+
+error:
+    OIC_LOG(ERROR, TAG, "Invalid Json string");
+    OICFree(str);
+    return NULL;
+}
+
+static bool CHPJsonParseNumber(CHPJsonReader_t *reader, CHPJsonElement_t *element)
+{
+    const char *start = reader->cur;
+    bool isDouble = false;
+    while (reader->cur < reader->end && strchr("+-0123456789.eE", *reader->cur))
+    {
+        if ('.' == *reader->cur || 'e' == *reader->cur || 'E' == *reader->cur)
+        {
+            isDouble = true;
         }
-        val = val->next;
+        reader->cur++;
     }
 
-    if( repData->values != NULL)
+    char number[64];
+    size_t length = reader->cur - start;
+    if (0 == length || length >= sizeof(number))
     {
-        return outJson;
+        return false;
+    }
+    memcpy(number, start, length);
+    number[length] = '\0';
+
+    char *end = NULL;
+    if (!isDouble)
+    {
+        errno = 0;
+        long long value = strtoll(number, &end, 10);
+        if (0 == errno && '\0' == *end)
+        {
+            element->type = OCREP_PROP_INT;
+            element->value.i = value;
+            return true;
+        }
+    }
+
+    // Fractions, exponents and integers out of int64 range.
+    double value = strtod(number, &end);
+    if ('\0' != *end)
+    {
+        return false;
+    }
+
+    // Integral values are kept as integers, as the cJSON based mapping did.
+    if (value >= INT64_MIN && value < (double)INT64_MAX && value == (double)(int64_t)value)
+    {
+        element->type = OCREP_PROP_INT;
+        element->value.i = (int64_t)value;
     }
     else
     {
-        cJSON_Delete(outJson);
+        element->type = OCREP_PROP_DOUBLE;
+        element->value.d = value;
+    }
+    return true;
+}
+
+static void CHPJsonFreeElement(CHPJsonElement_t *element)
+{
+    if (OCREP_PROP_STRING == element->type)
+    {
+        OICFree(element->value.str);
+    }
+    else if (OCREP_PROP_OBJECT == element->type)
+    {
+        OCRepPayloadDestroy(element->value.obj);
+    }
+    element->type = OCREP_PROP_NULL;
+}
+
+static bool CHPJsonSkipValue(CHPJsonReader_t *reader);
+
+/**
+ * Parse a scalar, string or object value. Arrays are reported as OCREP_PROP_ARRAY
+ * and left unconsumed for the caller.
+ */
+static bool CHPJsonParseElement(CHPJsonReader_t *reader, CHPJsonElement_t *element)
+{
+    CHPJsonSkipSpace(reader);
+    if (reader->cur >= reader->end)
+    {
+        return false;
+    }
+
+    switch (*reader->cur)
+    {
+        case '"':
+            element->type = OCREP_PROP_STRING;
+            element->value.str = CHPJsonParseString(reader);
+            return NULL != element->value.str;
+        case '{':
+            element->type = OCREP_PROP_OBJECT;
+            element->value.obj = CHPJsonParseObject(reader);
+            return NULL != element->value.obj;
+        case '[':
+            element->type = OCREP_PROP_ARRAY;
+            return true;
+        case 't':
+            element->type = OCREP_PROP_BOOL;
+            element->value.b = true;
+            return CHPJsonConsumeLiteral(reader, "true");
+        case 'f':
+            element->type = OCREP_PROP_BOOL;
+            element->value.b = false;
+            return CHPJsonConsumeLiteral(reader, "false");
+        case 'n':
+            element->type = OCREP_PROP_NULL;
+            return CHPJsonConsumeLiteral(reader, "null");
+        default:
+            return CHPJsonParseNumber(reader, element);
+    }
+}
+
+static bool CHPJsonSkipValue(CHPJsonReader_t *reader)
+{
+    CHPJsonElement_t element = { .type = OCREP_PROP_NULL };
+    if (!CHPJsonParseElement(reader, &element))
+    {
+        return false;
+    }
+    if (OCREP_PROP_ARRAY != element.type)
+    {
+        CHPJsonFreeElement(&element);
+        return true;
+    }
+
+    if (++reader->depth > CHP_JSON_MAX_DEPTH)
+    {
+        return false;
+    }
+    reader->cur++;
+    if (!CHPJsonConsume(reader, ']'))
+    {
+        do
+        {
+            if (!CHPJsonSkipValue(reader))
+            {
+                return false;
+            }
+        } while (CHPJsonConsume(reader, ','));
+
+        if (!CHPJsonConsume(reader, ']'))
+        {
+            return false;
+        }
+    }
+    reader->depth--;
+    return true;
+}
+
+static bool CHPJsonSetArray(OCRepPayload *payload, const char *name,
+                            CHPJsonElement_t *elements, size_t count)
+{
+    OCRepPayloadPropType type = elements[0].type;
+    for (size_t i = 1; i < count; i++)
+    {
+        if (OCREP_PROP_INT == type && OCREP_PROP_DOUBLE == elements[i].type)
+        {
+            type = OCREP_PROP_DOUBLE;
+        }
+        else if (elements[i].type != type &&
+                 !(OCREP_PROP_DOUBLE == type && OCREP_PROP_INT == elements[i].type))
+        {
+            OIC_LOG_V(ERROR, TAG, "Mixed array type for %s is not supported", name);
+            return false;
+        }
+    }
+
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = { count, 0, 0 };
+    switch (type)
+    {
+        case OCREP_PROP_INT:
+        {
+            int64_t *array = OICMalloc(count * sizeof(int64_t));
+            if (!array)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                array[i] = elements[i].value.i;
+            }
+            if (!OCRepPayloadSetIntArrayAsOwner(payload, name, array, dimensions))
+            {
+                OICFree(array);
+                return false;
+            }
+            return true;
+        }
+        case OCREP_PROP_DOUBLE:
+        {
+            double *array = OICMalloc(count * sizeof(double));
+            if (!array)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                array[i] = (OCREP_PROP_INT == elements[i].type) ?
+                            (double)elements[i].value.i : elements[i].value.d;
+            }
+            if (!OCRepPayloadSetDoubleArrayAsOwner(payload, name, array, dimensions))
+            {
+                OICFree(array);
+                return false;
+            }
+            return true;
+        }
+        case OCREP_PROP_BOOL:
+        {
+            bool *array = OICMalloc(count * sizeof(bool));
+            if (!array)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                array[i] = elements[i].value.b;
+            }
+            if (!OCRepPayloadSetBoolArrayAsOwner(payload, name, array, dimensions))
+            {
+                OICFree(array);
+                return false;
+            }
+            return true;
+        }
+        case OCREP_PROP_STRING:
+        {
+            char **array = OICMalloc(count * sizeof(char *));
+            if (!array)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                array[i] = elements[i].value.str;
+            }
+            if (!OCRepPayloadSetStringArrayAsOwner(payload, name, array, dimensions))
+            {
+                OICFree(array);
+                return false;
+            }
+            break;
+        }
+        case OCREP_PROP_OBJECT:
+        {
+            OCRepPayload **array = OICMalloc(count * sizeof(OCRepPayload *));
+            if (!array)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                array[i] = elements[i].value.obj;
+            }
+            if (!OCRepPayloadSetPropObjectArrayAsOwner(payload, name, array, dimensions))
+            {
+                OICFree(array);
+                return false;
+            }
+            break;
+        }
+        default:
+            OIC_LOG_V(ERROR, TAG, "Array type for %s is not supported", name);
+            return false;
+    }
+
+    // Strings and objects are now owned by the payload.
+    for (size_t i = 0; i < count; i++)
+    {
+        elements[i].type = OCREP_PROP_NULL;
+    }
+    return true;
+}
+
+static bool CHPJsonParseArray(CHPJsonReader_t *reader, OCRepPayload *payload, const char *name)
+{
+    // Opening bracket was seen by CHPJsonParseElement.
+    reader->cur++;
+    if (CHPJsonConsume(reader, ']'))
+    {
+        OIC_LOG_V(INFO, TAG, "Empty array %s is ignored", name);
+        return true;
+    }
+
+    size_t count = 0;
+    size_t capacity = CHP_JSON_INITIAL_ARRAY_SIZE;
+    CHPJsonElement_t *elements = OICMalloc(capacity * sizeof(CHPJsonElement_t));
+    bool supported = true;
+    bool result = false;
+    if (!elements)
+    {
+        return false;
+    }
+
+    do
+    {
+        if (count == capacity)
+        {
+            CHPJsonElement_t *grown = OICRealloc(elements, 2 * capacity * sizeof(*elements));
+            if (!grown)
+            {
+                goto exit;
+            }
+            elements = grown;
+            capacity *= 2;
+        }
+
+        CHPJsonElement_t *element = &elements[count];
+        element->type = OCREP_PROP_NULL;
+        if (!CHPJsonParseElement(reader, element))
+        {
+            CHPJsonFreeElement(element);
+            goto exit;
+        }
+        if (OCREP_PROP_ARRAY == element->type || OCREP_PROP_NULL == element->type)
+        {
+            // Nested arrays and null elements have no representation in OCRepPayload arrays.
+            if (OCREP_PROP_ARRAY == element->type && !CHPJsonSkipValue(reader))
+            {
+                goto exit;
+            }
+            element->type = OCREP_PROP_NULL;
+            supported = false;
+            continue;
+        }
+        count++;
+    } while (CHPJsonConsume(reader, ','));
+
+    if (!CHPJsonConsume(reader, ']'))
+    {
+        goto exit;
+    }
+
+    result = true;
+    if (!supported || 0 == count || !CHPJsonSetArray(payload, name, elements, count))
+    {
+        OIC_LOG_V(ERROR, TAG, "Array %s could not be mapped", name);
+    }
+
+exit:
+    for (size_t i = 0; i < count; i++)
+    {
+        CHPJsonFreeElement(&elements[i]);
+    }
+    OICFree(elements);
+    return result;
+}
+
+static bool CHPJsonParseMember(CHPJsonReader_t *reader, OCRepPayload *payload)
+{
+    char *name = CHPJsonParseString(reader);
+    if (!name)
+    {
+        return false;
+    }
+
+    bool result = false;
+    CHPJsonElement_t element = { .type = OCREP_PROP_NULL };
+    if (!CHPJsonConsume(reader, ':') || !CHPJsonParseElement(reader, &element))
+    {
+        CHPJsonFreeElement(&element);
+        OICFree(name);
+        return false;
+    }
+
+    switch (element.type)
+    {
+        case OCREP_PROP_NULL:
+            result = OCRepPayloadSetNull(payload, name);
+            break;
+        case OCREP_PROP_INT:
+            result = OCRepPayloadSetPropInt(payload, name, element.value.i);
+            break;
+        case OCREP_PROP_DOUBLE:
+            result = OCRepPayloadSetPropDouble(payload, name, element.value.d);
+            break;
+        case OCREP_PROP_BOOL:
+            result = OCRepPayloadSetPropBool(payload, name, element.value.b);
+            break;
+        case OCREP_PROP_STRING:
+            result = OCRepPayloadSetPropStringAsOwner(payload, name, element.value.str);
+            break;
+        case OCREP_PROP_OBJECT:
+            result = OCRepPayloadSetPropObjectAsOwner(payload, name, element.value.obj);
+            break;
+        case OCREP_PROP_ARRAY:
+            if (++reader->depth > CHP_JSON_MAX_DEPTH)
+            {
+                break;
+            }
+            result = CHPJsonParseArray(reader, payload, name);
+            reader->depth--;
+            OICFree(name);
+            return result;
+        default:
+            break;
+    }
+
+    if (!result)
+    {
+        CHPJsonFreeElement(&element);
+    }
+    OICFree(name);
+    return result;
+}
+
+static OCRepPayload* CHPJsonParseObject(CHPJsonReader_t *reader)
+{
+    if (++reader->depth > CHP_JSON_MAX_DEPTH)
+    {
+        OIC_LOG(ERROR, TAG, "Json nesting is too deep");
+        return NULL;
+    }
+
+    if (!CHPJsonConsume(reader, '{'))
+    {
+        return NULL;
+    }
+
+    OCRepPayload *payload = OCRepPayloadCreate();
+    if (!payload)
+    {
+        OIC_LOG(ERROR, TAG, "Memory allocation failed");
+        return NULL;
+    }
+
+    if (!CHPJsonConsume(reader, '}'))
+    {
+        do
+        {
+            if (!CHPJsonParseMember(reader, payload))
+            {
+                OCRepPayloadDestroy(payload);
+                return NULL;
+            }
+        } while (CHPJsonConsume(reader, ','));
+
+        if (!CHPJsonConsume(reader, '}'))
+        {
+            OCRepPayloadDestroy(payload);
+            return NULL;
+        }
+    }
+
+    reader->depth--;
+    return payload;
+}
+
+OCRepPayload* CHPJsonToRepPayload(const char* json, size_t length)
+{
+    VERIFY_NON_NULL_RET(json, TAG, "json", NULL);
+
+    CHPJsonReader_t reader = { .cur = json, .end = json + length, .depth = 0 };
+    OCRepPayload *payload = CHPJsonParseObject(&reader);
+    if (!payload)
+    {
+        OIC_LOG(ERROR, TAG, "Unable to parse json");
+        return NULL;
+    }
+
+    CHPJsonSkipSpace(&reader);
+    if (reader.cur < reader.end && '\0' != *reader.cur)
+    {
+        OIC_LOG(ERROR, TAG, "Trailing data after json object");
+        OCRepPayloadDestroy(payload);
         return NULL;
     }
+    return payload;
 }
@@ -47,6 +47,10 @@
 
 #define DEFAULT_USER_AGENT "IoTivity"
 #define MAX_PAYLOAD_SIZE (1048576U) // 1 MB
+/* Number of idle easy handles kept for reuse */
+#define MAX_IDLE_HANDLES (8)
+/* Number of idle keep-alive connections kept in the multi handle connection cache */
+#define MAX_IDLE_CONNECTIONS (16)
 
 typedef struct
 {
@@ -64,14 +68,31 @@ typedef struct
     CURL* easyHandle;
     /* libcurl does not copy header options passed to a request */
     struct curl_slist *list;
+    /* scheme://host:port of the request, used to hand the easy handle back to the pool */
+    char origin[CHP_MAX_HF_DATA_LENGTH];
 } CHPContext_t;
 
+/**
+ * Idle easy handle waiting for reuse.
+ * Connections themselves are kept alive in the connection cache of the multi handle,
+ * but each easy handle keeps its own TLS session cache so a handle is preferably
+ * reused for the origin it last talked to.
+ */
+typedef struct
+{
+    char origin[CHP_MAX_HF_DATA_LENGTH];
+    CURL *easyHandle;
+} CHPIdleHandle_t;
+
 /* A curl mutihandle is not threadsafe so we require mutexes to add new easy
  * handles to multihandle.
  */
 static CURLM *g_multiHandle;
 static int g_activeConnections;
 
+/* Idle easy handles, oldest first. Guarded by g_multiHandleMutex. */
+static u_arraylist_t *g_idleHandles;
+
 /*  Mutex code is taken from CA.
  *  General utility functions shall be placed in common location
  *  so that all modules can use them.
@@ -110,17 +131,127 @@ static void CHPParserResetHeaderOptions(u_arraylist_t** headerOptions)
     u_arraylist_free(headerOptions);
 }
 
+/*
+ * Extract scheme://host:port from uri in lowercase. User information, path,
+ * query and fragment are not part of the origin.
+ */
+static void CHPParserGetOrigin(const char *uri, char *origin, size_t originLength)
+{
+    const char *scheme = strstr(uri, "://");
+    const char *authority = scheme ? scheme + 3 : uri;
+    size_t authorityLength = strcspn(authority, "/?#");
+    const char *userInfo = memchr(authority, '@', authorityLength);
+    if (userInfo)
+    {
+        authorityLength -= (userInfo + 1) - authority;
+    }
+
+    if (scheme)
+    {
+        snprintf(origin, originLength, "%.*s%.*s", (int)(authority - uri), uri,
+                 (int)authorityLength, userInfo ? userInfo + 1 : authority);
+    }
+    else
+    {
+        // Uri without scheme is fetched over http by curl.
+        snprintf(origin, originLength, "http://%.*s", (int)authorityLength,
+                 userInfo ? userInfo + 1 : authority);
+    }
+    OICStringToLower(origin);
+}
+
+/*
+ * Get an easy handle for origin, reusing an idle one if possible.
+ * Must be called with g_multiHandleMutex held.
+ */
+static CURL *CHPParserAcquireEasyHandle(const char *origin)
+{
+    uint32_t count = u_arraylist_length(g_idleHandles);
+    if (count)
+    {
+        // Prefer the most recently used handle of the same origin, else the oldest one.
+        uint32_t index = 0;
+        for (uint32_t i = count; i-- > 0;)
+        {
+            CHPIdleHandle_t *idle = u_arraylist_get(g_idleHandles, i);
+            if (0 == strcmp(idle->origin, origin))
+            {
+                index = i;
+                break;
+            }
+        }
+
+        CHPIdleHandle_t *idle = u_arraylist_remove(g_idleHandles, index);
+        CURL *e = idle->easyHandle;
+        OIC_LOG_V(DEBUG, TAG, "Reusing easy handle of %s for %s", idle->origin, origin);
+        OICFree(idle);
+        return e;
+    }
+
+    return curl_easy_init();
+}
+
+/*
+ * Return an easy handle, already removed from the multi handle, to the idle pool.
+ * Must be called with g_multiHandleMutex held.
+ */
+static void CHPParserReleaseEasyHandle(CURL *easyHandle, const char *origin)
+{
+    // Reset options but keep the handle's session cache for the next request.
+    curl_easy_reset(easyHandle);
+
+    if (!g_idleHandles)
+    {
+        g_idleHandles = u_arraylist_create();
+    }
+
+    CHPIdleHandle_t *idle = OICCalloc(1, sizeof(CHPIdleHandle_t));
+    if (!idle || !g_idleHandles)
+    {
+        OICFree(idle);
+        curl_easy_cleanup(easyHandle);
+        return;
+    }
+
+    if (u_arraylist_length(g_idleHandles) >= MAX_IDLE_HANDLES)
+    {
+        CHPIdleHandle_t *oldest = u_arraylist_remove(g_idleHandles, 0);
+        curl_easy_cleanup(oldest->easyHandle);
+        OICFree(oldest);
+    }
+
+    OICStrcpy(idle->origin, sizeof(idle->origin), origin);
+    idle->easyHandle = easyHandle;
+    if (!u_arraylist_add(g_idleHandles, idle))
+    {
+        OICFree(idle);
+        curl_easy_cleanup(easyHandle);
+    }
+}
+
+static void CHPParserFreeIdleHandles()
+{
+    CHPIdleHandle_t *idle = NULL;
+    while (NULL != (idle = u_arraylist_remove(g_idleHandles, 0)))
+    {
+        curl_easy_cleanup(idle->easyHandle);
+        OICFree(idle);
+    }
+    u_arraylist_free(&g_idleHandles);
+}
+
+/* Must be called with g_multiHandleMutex held. */
 static void CHPFreeContext(CHPContext_t *ctxt)
 {
     VERIFY_NON_NULL_VOID(ctxt, TAG, "ctxt is NULL");
-    if(ctxt->list)
+    if(ctxt->easyHandle)
     {
-        curl_slist_free_all(ctxt->list);
+        CHPParserReleaseEasyHandle(ctxt->easyHandle, ctxt->origin);
     }
 
-    if(ctxt->easyHandle)
+    if(ctxt->list)
     {
-        curl_easy_cleanup(ctxt->easyHandle);
+        curl_slist_free_all(ctxt->list);
     }
 
     CHPParserResetHeaderOptions(&(ctxt->resp.headerOptions));
@@ -187,6 +318,12 @@ static void *CHPParserExecuteMultiHandle(void* data)
                 // with no timeout.
                 curlMultiTimeout = -1;
             }
+            else if(curlMultiTimeout == 0)
+            {
+                // A new easy handle is waiting to be started, call curl_multi_perform()
+                // right away instead of stalling the request.
+                goForSelect = false;
+            }
             else
             {
                 // libcurl recommend doing this.
@@ -217,7 +354,7 @@ static void *CHPParserExecuteMultiHandle(void* data)
             else
             {
                 timeout.tv_sec = curlMultiTimeout / 1000;
-                timeout.tv_usec = 0;
+                timeout.tv_usec = (curlMultiTimeout % 1000) * 1000;
                 tv = &timeout;
             }
 
@@ -407,6 +544,9 @@ static OCStackResult CHPParserInitializeMultiHandle()
         return OC_STACK_ERROR;
     }
 
+    /* Keep connections alive across requests to the same origin */
+    curl_multi_setopt(g_multiHandle, CURLMOPT_MAXCONNECTS, (long)MAX_IDLE_CONNECTIONS);
+
     CHPParserUnlockMutex();
     return OC_STACK_OK;
 }
@@ -421,6 +561,7 @@ static OCStackResult CHPParserTerminateMultiHandle()
         return OC_STACK_OK;
     }
 
+    CHPParserFreeIdleHandles();
     curl_multi_cleanup(g_multiHandle);
     g_multiHandle = NULL;
     CHPParserUnlockMutex();
@@ -717,7 +858,10 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
     VERIFY_NON_NULL_RET(easyHandle, TAG, "easyHandle", OC_STACK_INVALID_PARAM);
     VERIFY_NON_NULL_RET(handleContext, TAG, "handleContext", OC_STACK_INVALID_PARAM);
 
-    CURL *e = curl_easy_init();
+    CHPParserGetOrigin(req->resourceUri, handleContext->origin, sizeof(handleContext->origin));
+    CHPParserLockMutex();
+    CURL *e = CHPParserAcquireEasyHandle(handleContext->origin);
+    CHPParserUnlockMutex();
     if(!e)
     {
         OIC_LOG(ERROR, TAG, "easy init failed!");
@@ -747,8 +891,10 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
     curl_easy_setopt(e, CURLOPT_LOW_SPEED_LIMIT, 1024L);
     curl_easy_setopt(e, CURLOPT_LOW_SPEED_TIME, 60L);
     curl_easy_setopt(e, CURLOPT_USERAGENT, DEFAULT_USER_AGENT);
-    /* Close connection once done with transaction */
-    curl_easy_setopt(e, CURLOPT_FORBID_REUSE, 1L);
+#if LIBCURL_VERSION_NUM >= 0x071900
+    /* Probe idle keep-alive connections so dead ones are dropped from the cache */
+    curl_easy_setopt(e, CURLOPT_TCP_KEEPALIVE, 1L);
+#endif
     /* Allow redirect */
     curl_easy_setopt(e, CURLOPT_FOLLOWLOCATION, 1L);
     /* Only redirect to http servers */
@@ -788,6 +934,9 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
             curl_easy_setopt(e, CURLOPT_CUSTOMREQUEST, "DELETE");
             break;
         default:
+            CHPParserLockMutex();
+            CHPParserReleaseEasyHandle(e, handleContext->origin);
+            CHPParserUnlockMutex();
             return OC_STACK_INVALID_METHOD;
     }
 
@@ -814,8 +963,13 @@ static OCStackResult CHPInitializeEasyHandle(CURL** easyHandle, HttpRequest_t *r
     /* Add content-type and accept header */
     snprintf(buffer, sizeof(buffer), "Accept: %s", req->acceptFormat);
     list = curl_slist_append(list, buffer);
-    snprintf(buffer, sizeof(buffer), "Content-Type: %s", req->payloadFormat);
+    if (req->payloadFormat[0] != '\0')
+    {
+        snprintf(buffer, sizeof(buffer), "Content-Type: %s", req->payloadFormat);
+        list = curl_slist_append(list, buffer);
+    }
     curl_easy_setopt(e, CURLOPT_HTTPHEADER, list);
+    handleContext->list = list;
 
     *easyHandle = e;
     OIC_LOG_V(DEBUG, TAG, "%s OUT", __func__);
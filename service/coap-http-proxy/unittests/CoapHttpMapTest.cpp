@@ -0,0 +1,320 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+extern "C"
+{
+#include "ocpayload.h"
+#include "oic_malloc.h"
+#include "oic_string.h"
+#include "CoapHttpCache.h"
+#include "CoapHttpMap.h"
+}
+
+namespace
+{
+    bool IsAccepted(const std::string & json)
+    {
+        OCRepPayload * payload = CHPJsonToRepPayload(json.data(), json.size());
+        OCRepPayloadDestroy(payload);
+        return payload != NULL;
+    }
+
+    // Parses json and writes it back; returns "(rejected)" if json is not accepted.
+    std::string RoundTrip(const std::string & json)
+    {
+        OCRepPayload * payload = CHPJsonToRepPayload(json.data(), json.size());
+        if (!payload)
+        {
+            return "(rejected)";
+        }
+
+        size_t length = 0;
+        char * out = CHPRepPayloadToJson(payload, &length);
+        OCRepPayloadDestroy(payload);
+        if (!out)
+        {
+            return "(empty)";
+        }
+
+        std::string result(out);
+        EXPECT_EQ(result.size(), length);
+        OICFree(out);
+        return result;
+    }
+
+    std::string NestedObjects(int depth)
+    {
+        std::string json;
+        for (int i = 0; i < depth; i++)
+        {
+            json += "{\"a\":";
+        }
+        json += "1";
+        json.append(depth, '}');
+        return json;
+    }
+
+    HttpHeaderOption_t * CreateOption(const char * name, const char * data)
+    {
+        HttpHeaderOption_t * option = (HttpHeaderOption_t *) OICCalloc(1, sizeof(HttpHeaderOption_t));
+        OICStrcpy(option->optionName, sizeof(option->optionName), name);
+        OICStrcpy(option->optionData, sizeof(option->optionData), data);
+        return option;
+    }
+}
+
+class CoapHttpMapMaxAgeTest : public testing::Test
+{
+protected:
+    u_arraylist_t * headerOptions;
+
+    void SetUp()
+    {
+        headerOptions = u_arraylist_create();
+    }
+
+    void TearDown()
+    {
+        HttpHeaderOption_t * option = NULL;
+        while (NULL != (option = (HttpHeaderOption_t *) u_arraylist_remove(headerOptions, 0)))
+        {
+            OICFree(option);
+        }
+        u_arraylist_free(&headerOptions);
+    }
+
+    void AddOption(const char * name, const char * data)
+    {
+        u_arraylist_add(headerOptions, CreateOption(name, data));
+    }
+};
+
+TEST(CoapHttpMapJsonTest, RoundTripsScalarsAndObjects)
+{
+    EXPECT_EQ("{\"a\":1,\"b\":-2.5,\"c\":true,\"d\":false,\"e\":null,\"f\":\"x\"}",
+              RoundTrip("{\"a\":1,\"b\":-2.5,\"c\":true,\"d\":false,\"e\":null,\"f\":\"x\"}"));
+    EXPECT_EQ("{\"o\":{\"p\":[1,2]},\"q\":[{\"r\":1},{\"s\":\"t\"}]}",
+              RoundTrip(" { \"o\" : { \"p\" : [ 1 , 2 ] } , \"q\":[{\"r\":1},{\"s\":\"t\"}] } \n"));
+}
+
+TEST(CoapHttpMapJsonTest, RoundTripsArrays)
+{
+    EXPECT_EQ("{\"m\":[1,2.5,3]}", RoundTrip("{\"m\":[1,2.5,3]}"));
+    EXPECT_EQ("{\"b\":[true,false]}", RoundTrip("{\"b\":[true,false]}"));
+    EXPECT_EQ("{\"s\":[\"a\",\"b\\\"c\"]}", RoundTrip("{\"s\":[\"a\",\"b\\\"c\"]}"));
+}
+
+TEST(CoapHttpMapJsonTest, WritesMultiDimensionalArrays)
+{
+    OCRepPayload * payload = OCRepPayloadCreate();
+    int64_t values[6] = {1, 2, 3, 4, 5, 6};
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = {2, 3, 0};
+    ASSERT_TRUE(OCRepPayloadSetIntArray(payload, "m", values, dimensions));
+
+    char * out = CHPRepPayloadToJson(payload, NULL);
+    ASSERT_NE(nullptr, out);
+    EXPECT_STREQ("{\"m\":[[1,2,3],[4,5,6]]}", out);
+    OICFree(out);
+    OCRepPayloadDestroy(payload);
+}
+
+TEST(CoapHttpMapJsonTest, DecodesEscapes)
+{
+    EXPECT_EQ("{\"u\":\"\\n\\t/\\\\\\\"\\u0001\"}",
+              RoundTrip("{\"u\":\"\\n\\t\\/\\\\\\\"\\u0001\"}"));
+    EXPECT_EQ("{\"u\":\"\xc3\xa9\"}", RoundTrip("{\"u\":\"\\u00e9\"}"));
+}
+
+TEST(CoapHttpMapJsonTest, DecodesSurrogatePairs)
+{
+    EXPECT_EQ("{\"u\":\"\xf0\x9f\x98\x80\"}", RoundTrip("{\"u\":\"\\ud83d\\ude00\"}"));
+    EXPECT_FALSE(IsAccepted("{\"u\":\"\\ud800x\"}"));
+    EXPECT_FALSE(IsAccepted("{\"u\":\"\\ud800\"}"));
+    EXPECT_FALSE(IsAccepted("{\"u\":\"\\ud800\\u0041\"}"));
+    EXPECT_FALSE(IsAccepted("{\"u\":\"\\ude00\"}"));
+}
+
+TEST(CoapHttpMapJsonTest, RejectsNulCharacter)
+{
+    EXPECT_FALSE(IsAccepted("{\"u\":\"\\u0000\"}"));
+    EXPECT_FALSE(IsAccepted("{\"u\\u0000\":1}"));
+}
+
+TEST(CoapHttpMapJsonTest, RejectsTruncatedInput)
+{
+    EXPECT_FALSE(IsAccepted("{\"a\":1"));
+    EXPECT_FALSE(IsAccepted("{\"a\":"));
+    EXPECT_FALSE(IsAccepted("{\"a\""));
+    EXPECT_FALSE(IsAccepted("{\"a\":\"abc"));
+    EXPECT_FALSE(IsAccepted("{\"a\":\"abc\\"));
+    EXPECT_FALSE(IsAccepted("{\"a\":\"\\u12\"}"));
+    EXPECT_FALSE(IsAccepted("{\"a\":\"\\u12"));
+    EXPECT_FALSE(IsAccepted("{\"a\":\"\\ud83d\\ude"));
+    EXPECT_FALSE(IsAccepted("{\"a\":[1,"));
+    EXPECT_FALSE(IsAccepted("{\"a\":tru}"));
+    EXPECT_FALSE(IsAccepted("{\"a\":-}"));
+    EXPECT_FALSE(IsAccepted(""));
+}
+
+TEST(CoapHttpMapJsonTest, RejectsMalformedInput)
+{
+    EXPECT_FALSE(IsAccepted("{\"a\":1,}"));
+    EXPECT_FALSE(IsAccepted("{\"a\":[1,}"));
+    EXPECT_FALSE(IsAccepted("[1,2]"));
+    EXPECT_FALSE(IsAccepted("{\"a\":\"\\q\"}"));
+}
+
+TEST(CoapHttpMapJsonTest, RejectsTrailingData)
+{
+    EXPECT_FALSE(IsAccepted("{\"a\":1} x"));
+    EXPECT_FALSE(IsAccepted("{\"a\":1}{\"b\":2}"));
+    EXPECT_TRUE(IsAccepted("{\"a\":1} \r\n\t"));
+}
+
+TEST(CoapHttpMapJsonTest, ParsesInputWithoutTerminator)
+{
+    const char json[] = "{\"a\":1}{\"b\":2}";
+    OCRepPayload * payload = CHPJsonToRepPayload(json, 7);
+    ASSERT_NE(nullptr, payload);
+
+    int64_t value = 0;
+    EXPECT_TRUE(OCRepPayloadGetPropInt(payload, "a", &value));
+    EXPECT_EQ(1, value);
+    EXPECT_FALSE(OCRepPayloadGetPropInt(payload, "b", &value));
+    OCRepPayloadDestroy(payload);
+
+    // A string running into the end of the buffer is truncated, not read past.
+    const char truncated[] = "{\"a\":\"abc\"}";
+    EXPECT_EQ(nullptr, CHPJsonToRepPayload(truncated, 9));
+}
+
+TEST(CoapHttpMapJsonTest, LimitsNestingDepth)
+{
+    EXPECT_TRUE(IsAccepted(NestedObjects(32)));
+    EXPECT_FALSE(IsAccepted(NestedObjects(33)));
+    EXPECT_FALSE(IsAccepted(NestedObjects(1000)));
+
+    std::string arrays = "{\"a\":" + std::string(1000, '[') + std::string(1000, ']') + "}";
+    EXPECT_FALSE(IsAccepted(arrays));
+}
+
+TEST(CoapHttpMapJsonTest, SkipsArraysWithoutRepresentation)
+{
+    EXPECT_EQ("{\"k\":1}", RoundTrip("{\"n\":[[1,2],[3]],\"k\":1}"));
+    EXPECT_EQ("{\"k\":1}", RoundTrip("{\"mix\":[1,\"a\"],\"k\":1}"));
+    EXPECT_EQ("{\"k\":2}", RoundTrip("{\"e\":[],\"k\":2}"));
+    EXPECT_EQ("{\"k\":3}", RoundTrip("{\"z\":[null,1],\"k\":3}"));
+    EXPECT_EQ("(empty)", RoundTrip("{}"));
+}
+
+TEST(CoapHttpMapJsonTest, KeepsIntegersThatOverflowAsDoubles)
+{
+    EXPECT_EQ("{\"max\":9223372036854775807,\"min\":-9223372036854775808}",
+              RoundTrip("{\"max\":9223372036854775807,\"min\":-9223372036854775808}"));
+
+    std::string json = "{\"over\":9223372036854775808,\"under\":-9223372036854775809,"
+                       "\"huge\":1e300}";
+    OCRepPayload * payload = CHPJsonToRepPayload(json.data(), json.size());
+    ASSERT_NE(nullptr, payload);
+
+    int64_t intValue = 0;
+    double value = 0;
+    EXPECT_FALSE(OCRepPayloadGetPropInt(payload, "over", &intValue));
+    EXPECT_TRUE(OCRepPayloadGetPropDouble(payload, "over", &value));
+    EXPECT_DOUBLE_EQ(9223372036854775808.0, value);
+    EXPECT_TRUE(OCRepPayloadGetPropDouble(payload, "under", &value));
+    EXPECT_DOUBLE_EQ(-9223372036854775809.0, value);
+    EXPECT_TRUE(OCRepPayloadGetPropDouble(payload, "huge", &value));
+    EXPECT_DOUBLE_EQ(1e300, value);
+    OCRepPayloadDestroy(payload);
+}
+
+TEST_F(CoapHttpMapMaxAgeTest, PrefersSharedMaxAge)
+{
+    uint32_t maxAge = 0;
+    AddOption("Cache-Control", "max-age=120, s-maxage=30");
+    EXPECT_TRUE(CHPGetHttpMaxAge(headerOptions, &maxAge));
+    EXPECT_EQ(30u, maxAge);
+}
+
+TEST_F(CoapHttpMapMaxAgeTest, DisallowsStoringPrivateResponses)
+{
+    uint32_t maxAge = 0;
+    AddOption("Cache-Control", "max-age=120, private");
+    EXPECT_TRUE(CHPGetHttpMaxAge(headerOptions, &maxAge));
+    EXPECT_EQ(0u, maxAge);
+}
+
+TEST_F(CoapHttpMapMaxAgeTest, SubtractsUpstreamAge)
+{
+    uint32_t maxAge = 0;
+    AddOption("Cache-Control", "public, max-age=120");
+    AddOption("Age", "20");
+    EXPECT_TRUE(CHPGetHttpMaxAge(headerOptions, &maxAge));
+    EXPECT_EQ(100u, maxAge);
+}
+
+TEST_F(CoapHttpMapMaxAgeTest, ExpiresWhenAgeExceedsLifetime)
+{
+    uint32_t maxAge = 0;
+    AddOption("Age", "200");
+    AddOption("Cache-Control", "max-age=120");
+    EXPECT_TRUE(CHPGetHttpMaxAge(headerOptions, &maxAge));
+    EXPECT_EQ(0u, maxAge);
+}
+
+TEST_F(CoapHttpMapMaxAgeTest, IgnoresAgeWithoutLifetime)
+{
+    uint32_t maxAge = 0;
+    AddOption("Age", "20");
+    EXPECT_FALSE(CHPGetHttpMaxAge(headerOptions, &maxAge));
+    EXPECT_EQ(0u, maxAge);
+}
+
+TEST(CoapHttpCacheTest, DoesNotStoreExpiredResponses)
+{
+    ASSERT_EQ(OC_STACK_OK, CHPCacheInitialize());
+
+    OCEntityHandlerResponse response;
+    memset(&response, 0, sizeof(response));
+    response.ehResult = OC_EH_CONTENT;
+    response.payload = (OCPayload *) CHPJsonToRepPayload("{\"a\":1}", 7);
+
+    OCEntityHandlerResponse cached;
+    memset(&cached, 0, sizeof(cached));
+    CHPCachePutResponse("http://host/expired", &response, 0);
+    EXPECT_FALSE(CHPCacheGetResponse("http://host/expired", &cached));
+
+    CHPCachePutResponse("http://host/fresh", &response, 60);
+    ASSERT_TRUE(CHPCacheGetResponse("http://host/fresh", &cached));
+    EXPECT_EQ(OC_EH_CONTENT, cached.ehResult);
+    EXPECT_NE(nullptr, cached.payload);
+    OCPayloadDestroy(cached.payload);
+
+    CHPCacheInvalidate("http://host/fresh");
+    EXPECT_FALSE(CHPCacheGetResponse("http://host/fresh", &cached));
+
+    OCPayloadDestroy(response.payload);
+    CHPCacheTerminate();
+}
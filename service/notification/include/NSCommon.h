@@ -164,5 +164,25 @@ typedef struct
 
 } NSSyncInfo;
 
+/**
+ *  Statistics of the notification messages delivered in batches.
+ *  A batch is a notification that carries more than one message,
+ *  a message sent alone is not counted.
+ */
+typedef struct
+{
+    /* Number of batches */
+    uint64_t batchCount;
+    /* Number of messages in all batches */
+    uint64_t messageCount;
+    /* Largest number of messages in one batch */
+    uint32_t maxBatchSize;
+    /* Sum over the batches of the time their first message was held back, in milliseconds */
+    uint64_t totalDelay;
+    /* Longest time the first message of a batch was held back, in milliseconds */
+    uint64_t maxDelay;
+
+} NSBatchMetrics;
+
 #endif /* _NS_COMMON_H_ */
 
@@ -130,6 +130,15 @@ NSTopicLL * NSConsumerGetTopicList(const char * providerId);
  */
 NSResult NSConsumerUpdateTopicList(const char * providerId, NSTopicLL * topics);
 
+/**
+ * Get statistics of the messages received in batches. Providers send batches
+ * only if they enable message batching, the messages are passed to the
+ * message callback one by one.
+ * @param[out] metrics batch metrics since the consumer service was started
+ * @return NSResult
+ */
+NSResult NSConsumerGetBatchMetrics(NSBatchMetrics * metrics);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -177,6 +177,23 @@ NSTopicLL * NSProviderGetConsumerTopics(const char * consumerId);
  */
 NSTopicLL * NSProviderGetTopics();
 
+/**
+ * Coalesce notification messages sent close together into one notification per consumer.
+ * A message is held for at most windowMs, or until maxCount messages are waiting.
+ * Batching is off by default, consumers of earlier versions can not read batches.
+ * @param[in]  windowMs  time to wait for more messages in milliseconds, 0 disables batching
+ * @param[in]  maxCount  number of messages in a batch at most, up to 64
+ * @return ::NS_OK if the action is requested succesfully or NS_FAIL if wrong parameter is set.
+ */
+NSResult NSProviderSetMessageBatching(uint32_t windowMs, uint32_t maxCount);
+
+/**
+ * Get statistics of the messages sent in batches
+ * @param[out] metrics  batch metrics since the provider service was started
+ * @return ::NS_OK or NS_FAIL if metrics is NULL.
+ */
+NSResult NSProviderGetBatchMetrics(NSBatchMetrics * metrics);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
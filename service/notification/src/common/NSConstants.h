@@ -60,6 +60,9 @@
 // SCHEDULE //
 #define THREAD_COUNT               5
 
+// Messages coalesced into one notification at most
+#define NS_MAX_BATCH_SIZE          64
+
 // NOTIOBJ //
 #define NOTIOBJ_TITLE_KEY          "title"
 #define NOTIOBJ_ID_KEY             "id"
@@ -205,6 +208,8 @@
 #define NS_ATTRIBUTE_DATETIME "dateTime"
 #define NS_ATTRIBUTE_TTL "ttl"
 #define NS_ATTRIBUTE_ICON_IMAGE "iconImage"
+#define NS_ATTRIBUTE_MESSAGES "messages"
+#define NS_ATTRIBUTE_BATCH_DELAY "batchDelay"
 
 typedef enum eConnectionState
 {
@@ -54,11 +54,14 @@ typedef struct _NSCacheElement
     struct _NSCacheElement * next;
 } NSCacheElement;
 
+typedef struct _NSCacheIndex NSCacheIndex;
+
 typedef struct
 {
     NSCacheType cacheType;
     NSCacheElement * head;
     NSCacheElement * tail;
+    NSCacheIndex * index; // lookup index of the provider cache, NULL otherwise
 } NSCacheList;
 
 typedef struct
@@ -20,6 +20,9 @@
 
 #include "NSConsumerCommunication.h"
 
+#include <pthread.h>
+#include <string.h>
+
 #include "NSConstants.h"
 #include "NSUtil.h"
 #include "NSConsumerCommon.h"
@@ -32,7 +35,7 @@
 NSMessage * NSCreateMessage_internal(uint64_t msgId, const char * providerId);
 NSSyncInfo * NSCreateSyncInfo_consumer(uint64_t msgId, const char * providerId, NSSyncType state);
 
-NSMessage * NSGetMessage(OCClientResponse * clientResponse);
+NSMessage * NSGetMessage(OCRepPayload * payload);
 NSSyncInfo * NSGetSyncInfoc(OCClientResponse * clientResponse);
 NSTopicLL * NSGetTopicLL(OCClientResponse * clientResponse);
 
@@ -174,19 +177,44 @@ OCStackApplicationResult NSConsumerSyncInfoListener(
     return OC_STACK_KEEP_TRANSACTION;
 }
 
-OCStackApplicationResult NSConsumerMessageListener(
-        void * ctx, OCDoHandle handle, OCClientResponse * clientResponse)
+static pthread_mutex_t NSBatchMetricsMutex = PTHREAD_MUTEX_INITIALIZER;
+static NSBatchMetrics NSBatchStats;
+
+void NSGetConsumerBatchMetrics(NSBatchMetrics * metrics)
 {
-    (void) ctx;
-    (void) handle;
+    pthread_mutex_lock(&NSBatchMetricsMutex);
+    *metrics = NSBatchStats;
+    pthread_mutex_unlock(&NSBatchMetricsMutex);
+}
 
-    NS_VERIFY_NOT_NULL(clientResponse, OC_STACK_KEEP_TRANSACTION);
-    NS_VERIFY_STACK_SUCCESS(NSOCResultToSuccess(clientResponse->result), OC_STACK_KEEP_TRANSACTION);
+void NSResetConsumerBatchMetrics()
+{
+    pthread_mutex_lock(&NSBatchMetricsMutex);
+    memset(&NSBatchStats, 0, sizeof(NSBatchStats));
+    pthread_mutex_unlock(&NSBatchMetricsMutex);
+}
 
-    NS_LOG(DEBUG, "build NSMessage");
-    NSMessage * newNoti = NSGetMessage(clientResponse);
-    NS_VERIFY_NOT_NULL(newNoti, OC_STACK_KEEP_TRANSACTION);
+static void NSUpdateMessageBatchMetrics(size_t count, int64_t delay)
+{
+    uint64_t batchDelay = delay > 0 ? (uint64_t) delay : 0;
+
+    pthread_mutex_lock(&NSBatchMetricsMutex);
+    NSBatchStats.batchCount++;
+    NSBatchStats.messageCount += count;
+    if (count > NSBatchStats.maxBatchSize)
+    {
+        NSBatchStats.maxBatchSize = (uint32_t) count;
+    }
+    NSBatchStats.totalDelay += batchDelay;
+    if (batchDelay > NSBatchStats.maxDelay)
+    {
+        NSBatchStats.maxDelay = batchDelay;
+    }
+    pthread_mutex_unlock(&NSBatchMetricsMutex);
+}
 
+static void NSConsumerPushMessage(NSMessage * newNoti)
+{
     NSTaskType type = TASK_CONSUMER_RECV_MESSAGE;
 
     if (newNoti->messageId == NS_ALLOW || newNoti->messageId == NS_DENY)
@@ -206,9 +234,52 @@ OCStackApplicationResult NSConsumerMessageListener(
 
     NS_LOG(DEBUG, "build NSTask");
     NSTask * task = NSMakeTask(type, (void *) newNoti);
-    NS_VERIFY_NOT_NULL_WITH_POST_CLEANING(task, NS_ERROR, NSRemoveMessage(newNoti));
+    NS_VERIFY_NOT_NULL_WITH_POST_CLEANING_V(task, NSRemoveMessage(newNoti));
 
     NSConsumerPushEvent(task);
+}
+
+OCStackApplicationResult NSConsumerMessageListener(
+        void * ctx, OCDoHandle handle, OCClientResponse * clientResponse)
+{
+    (void) ctx;
+    (void) handle;
+
+    NS_VERIFY_NOT_NULL(clientResponse, OC_STACK_KEEP_TRANSACTION);
+    NS_VERIFY_STACK_SUCCESS(NSOCResultToSuccess(clientResponse->result), OC_STACK_KEEP_TRANSACTION);
+    NS_VERIFY_NOT_NULL(clientResponse->payload, OC_STACK_KEEP_TRANSACTION);
+
+    OCRepPayload * payload = (OCRepPayload *) clientResponse->payload;
+    OCRepPayload ** batch = NULL;
+    size_t dimensions[MAX_REP_ARRAY_DEPTH] = { 0, };
+
+    if (OCRepPayloadGetPropObjectArray(payload, NS_ATTRIBUTE_MESSAGES, &batch, dimensions))
+    {
+        NS_LOG_V(DEBUG, "unpack %zu batched messages", dimensions[0]);
+
+        int64_t delay = 0;
+        OCRepPayloadGetPropInt(payload, NS_ATTRIBUTE_BATCH_DELAY, &delay);
+        NSUpdateMessageBatchMetrics(dimensions[0], delay);
+
+        for (size_t i = 0; i < dimensions[0]; ++i)
+        {
+            NSMessage * newNoti = NSGetMessage(batch[i]);
+            if (newNoti)
+            {
+                NSConsumerPushMessage(newNoti);
+            }
+            OCRepPayloadDestroy(batch[i]);
+        }
+        NSOICFree(batch);
+
+        return OC_STACK_KEEP_TRANSACTION;
+    }
+
+    NS_LOG(DEBUG, "build NSMessage");
+    NSMessage * newNoti = NSGetMessage(payload);
+    NS_VERIFY_NOT_NULL(newNoti, OC_STACK_KEEP_TRANSACTION);
+
+    NSConsumerPushMessage(newNoti);
 
     return OC_STACK_KEEP_TRANSACTION;
 }
@@ -376,10 +447,9 @@ OCRepPayload * NSGetExtraInfo(OCRepPayload * payload)
     }
 }
 
-NSMessage * NSGetMessage(OCClientResponse * clientResponse)
+NSMessage * NSGetMessage(OCRepPayload * payload)
 {
-    NS_VERIFY_NOT_NULL(clientResponse->payload, NULL);
-    OCRepPayload * payload = (OCRepPayload *)clientResponse->payload;
+    NS_VERIFY_NOT_NULL(payload, NULL);
 
     NS_LOG(DEBUG, "get msg id");
     uint64_t id = NULL;
@@ -42,6 +42,10 @@ OCStackApplicationResult NSConsumerSyncInfoListener(void *, OCDoHandle, OCClient
 
 OCStackApplicationResult NSIntrospectTopic(void *, OCDoHandle, OCClientResponse *);
 
+void NSGetConsumerBatchMetrics(NSBatchMetrics *);
+
+void NSResetConsumerBatchMetrics();
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -27,6 +27,7 @@
 #include "NSConsumerCommon.h"
 #include "NSConstants.h"
 #include "NSConsumerScheduler.h"
+#include "NSConsumerCommunication.h"
 #include "oic_malloc.h"
 #include "oic_string.h"
 
@@ -44,6 +45,7 @@ NSResult NSStartConsumer(NSConsumerConfig config)
     NSSetNotificationSyncCb(config.syncInfoCb);
     NSSetProviderChangedCb(config.changedCb);
     NSSetIsStartedConsumer(true);
+    NSResetConsumerBatchMetrics();
 
     NSResult ret = NSConsumerMessageHandlerInit();
     NS_VERIFY_NOT_NULL_WITH_POST_CLEANING(ret == NS_OK ? (void *) 1 : NULL,
@@ -222,3 +224,12 @@ NSResult NSConsumerUpdateTopicList(const char * providerId, NSTopicLL * topics)
 
     return NSConsumerPushEvent(topicTask);
 }
+
+NSResult NSConsumerGetBatchMetrics(NSBatchMetrics * metrics)
+{
+    NS_VERIFY_NOT_NULL(metrics, NS_ERROR);
+
+    NSGetConsumerBatchMetrics(metrics);
+
+    return NS_OK;
+}
@@ -100,6 +100,7 @@ NSResult NSStartProvider(NSProviderConfig config)
 #endif
 
         NSInitialize();
+        NSResetProviderBatchMetrics();
         NSInitScheduler();
         NSStartScheduler();
 
@@ -237,6 +238,35 @@ NSResult NSProviderSendSyncInfo(uint64_t messageId, NSSyncType type)
     return NS_OK;
 }
 
+NSResult NSProviderSetMessageBatching(uint32_t windowMs, uint32_t maxCount)
+{
+    NS_LOG(DEBUG, "NSProviderSetMessageBatching - IN");
+
+    if (maxCount > NS_MAX_BATCH_SIZE)
+    {
+        NS_LOG_V(ERROR, "Batch size is limited to %d messages", NS_MAX_BATCH_SIZE);
+        return NS_FAIL;
+    }
+
+    NS_LOG_V(DEBUG, "batch window = %u ms, batch size = %u", windowMs, maxCount);
+    NSSetMessageBatching(windowMs, maxCount);
+
+    NS_LOG(DEBUG, "NSProviderSetMessageBatching - OUT");
+    return NS_OK;
+}
+
+NSResult NSProviderGetBatchMetrics(NSBatchMetrics * metrics)
+{
+    if (!metrics)
+    {
+        NS_LOG(ERROR, "metrics is NULL");
+        return NS_FAIL;
+    }
+
+    NSGetProviderBatchMetrics(metrics);
+    return NS_OK;
+}
+
 NSResult NSAcceptSubscription(const char * consumerId, bool accepted)
 {
     NS_LOG(DEBUG, "NSAccept - IN");
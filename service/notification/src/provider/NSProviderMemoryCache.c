@@ -21,6 +21,399 @@
 #include "NSProviderMemoryCache.h"
 #include <string.h>
 
+#include "uarraylist.h"
+#include "uhashmap.h"
+
+// observation ids are uint8_t
+#define NS_OBSERVATION_ID_COUNT (UINT8_MAX + 1)
+
+pthread_mutex_t NSCacheMutex;
+pthread_mutexattr_t NSCacheMutexAttr;
+
+struct _NSCacheIndex
+{
+    NSCacheType type; // cache type of the list when the index was created
+    u_hashmap_t * elements; // element by subscriber id, topic name or topic subscription
+    u_hashmap_t * topics; // NSCacheTopicSubscribers by topic name, consumer topics only
+    u_arraylist_t * observers[NS_OBSERVATION_ID_COUNT]; // subscribers by observation id
+};
+
+typedef struct
+{
+    char * topicName;
+    u_arraylist_t * elements; // consumer topic elements of the topic
+} NSCacheTopicSubscribers;
+
+static bool NSIsConsumerTopicCache(NSCacheType type)
+{
+    return type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME ||
+            type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID;
+}
+
+static bool NSIsSubscriberCache(NSCacheType type)
+{
+    return type == NS_PROVIDER_CACHE_SUBSCRIBER ||
+            type == NS_PROVIDER_CACHE_SUBSCRIBER_OBSERVE_ID;
+}
+
+static bool NSIsIndexedCache(NSCacheType type)
+{
+    return NSIsSubscriberCache(type) ||
+            type == NS_PROVIDER_CACHE_REGISTER_TOPIC ||
+            NSIsConsumerTopicCache(type);
+}
+
+static uint32_t NSHashTopicSubData(const void * key)
+{
+    const NSCacheTopicSubData * topicData = (const NSCacheTopicSubData *) key;
+    uint32_t hash = u_hashmap_hash_bytes(U_HASHMAP_HASH_SEED, topicData->id,
+            strlen(topicData->id));
+    return u_hashmap_hash_bytes(hash, topicData->topicName, strlen(topicData->topicName));
+}
+
+static bool NSEqualTopicSubData(const void * key1, const void * key2)
+{
+    const NSCacheTopicSubData * topicData1 = (const NSCacheTopicSubData *) key1;
+    const NSCacheTopicSubData * topicData2 = (const NSCacheTopicSubData *) key2;
+    return strcmp(topicData1->id, topicData2->id) == 0 &&
+            strcmp(topicData1->topicName, topicData2->topicName) == 0;
+}
+
+static const void * NSGetCacheIndexKey(NSCacheIndex * index, NSCacheData * data)
+{
+    if (index->type == NS_PROVIDER_CACHE_REGISTER_TOPIC)
+    {
+        return ((NSCacheTopicData *) data)->topicName;
+    }
+    else if (NSIsConsumerTopicCache(index->type))
+    {
+        return data;
+    }
+
+    return ((NSCacheSubData *) data)->id;
+}
+
+static void NSFreeTopicSubscribers(NSCacheTopicSubscribers * subscribers)
+{
+    u_arraylist_free(&subscribers->elements);
+    OICFree(subscribers->topicName);
+    OICFree(subscribers);
+}
+
+static void NSDestroyCacheIndex(NSCacheIndex * index)
+{
+    if (!index)
+    {
+        return;
+    }
+
+    if (index->topics)
+    {
+        uint32_t iter = 0;
+        NSCacheTopicSubscribers * subscribers = NULL;
+        while ((subscribers = (NSCacheTopicSubscribers *) u_hashmap_next(index->topics, &iter)))
+        {
+            NSFreeTopicSubscribers(subscribers);
+        }
+        u_hashmap_free(&index->topics);
+    }
+
+    for (size_t id = 0; id < NS_OBSERVATION_ID_COUNT; id++)
+    {
+        u_arraylist_free(&index->observers[id]);
+    }
+
+    u_hashmap_free(&index->elements);
+    OICFree(index);
+}
+
+/* The index is created by the first write, callers set the cache type after creating the list. */
+static NSCacheIndex * NSGetCacheIndex(NSCacheList * list)
+{
+    if (list->index || !NSIsIndexedCache(list->cacheType))
+    {
+        return list->index;
+    }
+
+    NSCacheIndex * index = (NSCacheIndex *) OICCalloc(1, sizeof(NSCacheIndex));
+    if (!index)
+    {
+        return NULL;
+    }
+
+    index->type = list->cacheType;
+    if (NSIsConsumerTopicCache(index->type))
+    {
+        index->elements = u_hashmap_create(NSHashTopicSubData, NSEqualTopicSubData);
+        index->topics = u_hashmap_create(u_hashmap_hash_string, u_hashmap_equal_string);
+        if (!index->topics)
+        {
+            NSDestroyCacheIndex(index);
+            return NULL;
+        }
+    }
+    else
+    {
+        index->elements = u_hashmap_create(u_hashmap_hash_string, u_hashmap_equal_string);
+    }
+
+    if (!index->elements)
+    {
+        NSDestroyCacheIndex(index);
+        return NULL;
+    }
+
+    list->index = index;
+    return index;
+}
+
+static bool NSAddTopicSubscriber(NSCacheIndex * index, NSCacheElement * element)
+{
+    NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) element->data;
+    NSCacheTopicSubscribers * subscribers =
+            (NSCacheTopicSubscribers *) u_hashmap_get(index->topics, topicData->topicName);
+
+    if (!subscribers)
+    {
+        subscribers = (NSCacheTopicSubscribers *) OICCalloc(1, sizeof(NSCacheTopicSubscribers));
+        if (!subscribers)
+        {
+            return false;
+        }
+
+        subscribers->topicName = OICStrdup(topicData->topicName);
+        subscribers->elements = u_arraylist_create();
+        if (!subscribers->topicName || !subscribers->elements ||
+                !u_hashmap_put(index->topics, subscribers->topicName, subscribers))
+        {
+            NSFreeTopicSubscribers(subscribers);
+            return false;
+        }
+    }
+
+    return u_arraylist_add(subscribers->elements, element);
+}
+
+static void NSRemoveTopicSubscriber(NSCacheIndex * index, NSCacheElement * element)
+{
+    NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) element->data;
+    NSCacheTopicSubscribers * subscribers =
+            (NSCacheTopicSubscribers *) u_hashmap_get(index->topics, topicData->topicName);
+
+    if (!subscribers)
+    {
+        return;
+    }
+
+    uint32_t len = u_arraylist_length(subscribers->elements);
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if (u_arraylist_get(subscribers->elements, i) == element)
+        {
+            u_arraylist_remove(subscribers->elements, i);
+            break;
+        }
+    }
+
+    if (u_arraylist_length(subscribers->elements) == 0)
+    {
+        u_hashmap_remove(index->topics, subscribers->topicName);
+        NSFreeTopicSubscribers(subscribers);
+    }
+}
+
+/* Fills ids with the distinct observation ids of the subscriber, 0 is no observation. */
+static size_t NSGetObservationIds(NSCacheSubData * subData, OCObservationId * ids)
+{
+    int obIds[] = { subData->messageObId, subData->syncObId,
+            subData->remote_messageObId, subData->remote_syncObId };
+    size_t count = 0;
+
+    for (size_t i = 0; i < sizeof(obIds) / sizeof(obIds[0]); i++)
+    {
+        bool isNew = obIds[i] > 0 && obIds[i] < NS_OBSERVATION_ID_COUNT;
+        for (size_t j = 0; isNew && j < count; j++)
+        {
+            isNew = ids[j] != obIds[i];
+        }
+
+        if (isNew)
+        {
+            ids[count++] = (OCObservationId) obIds[i];
+        }
+    }
+
+    return count;
+}
+
+static void NSRemoveObservers(NSCacheIndex * index, NSCacheElement * element)
+{
+    OCObservationId ids[4];
+    size_t count = NSGetObservationIds((NSCacheSubData *) element->data, ids);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        u_arraylist_t * elements = index->observers[ids[i]];
+        uint32_t len = u_arraylist_length(elements);
+        for (uint32_t j = 0; j < len; j++)
+        {
+            if (u_arraylist_get(elements, j) == element)
+            {
+                u_arraylist_remove(elements, j);
+                break;
+            }
+        }
+    }
+}
+
+static bool NSAddObservers(NSCacheIndex * index, NSCacheElement * element)
+{
+    OCObservationId ids[4];
+    size_t count = NSGetObservationIds((NSCacheSubData *) element->data, ids);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!index->observers[ids[i]])
+        {
+            index->observers[ids[i]] = u_arraylist_create();
+        }
+
+        if (!index->observers[ids[i]] || !u_arraylist_add(index->observers[ids[i]], element))
+        {
+            // only the ids before this one hold the element
+            for (size_t j = 0; j < i; j++)
+            {
+                u_arraylist_t * elements = index->observers[ids[j]];
+                u_arraylist_remove(elements, u_arraylist_length(elements) - 1);
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool NSAddToCacheIndex(NSCacheList * list, NSCacheElement * element)
+{
+    NSCacheIndex * index = NSGetCacheIndex(list);
+    if (!index)
+    {
+        return !NSIsIndexedCache(list->cacheType);
+    }
+
+    const void * key = NSGetCacheIndexKey(index, element->data);
+    if (!u_hashmap_put(index->elements, key, element))
+    {
+        return false;
+    }
+
+    if ((NSIsConsumerTopicCache(index->type) && !NSAddTopicSubscriber(index, element)) ||
+            (NSIsSubscriberCache(index->type) && !NSAddObservers(index, element)))
+    {
+        u_hashmap_remove(index->elements, key);
+        return false;
+    }
+
+    return true;
+}
+
+static void NSRemoveFromCacheIndex(NSCacheList * list, NSCacheElement * element)
+{
+    NSCacheIndex * index = list->index;
+    if (!index)
+    {
+        return;
+    }
+
+    const void * key = NSGetCacheIndexKey(index, element->data);
+    if (u_hashmap_get(index->elements, key) == element)
+    {
+        u_hashmap_remove(index->elements, key);
+    }
+
+    if (NSIsConsumerTopicCache(index->type))
+    {
+        NSRemoveTopicSubscriber(index, element);
+    }
+    else if (NSIsSubscriberCache(index->type))
+    {
+        NSRemoveObservers(index, element);
+    }
+}
+
+/*
+ * Finds the element of the id for the current cache type of the list.
+ * Consumer ids of topic subscriptions are not indexed.
+ * NSCacheMutex must be held.
+ */
+static NSCacheElement * NSFindCacheElement(NSCacheList * list, const char * findId)
+{
+    NSCacheType type = list->cacheType;
+    NSCacheIndex * index = list->index;
+
+    if (index && (type == NS_PROVIDER_CACHE_SUBSCRIBER || type == NS_PROVIDER_CACHE_REGISTER_TOPIC))
+    {
+        return (NSCacheElement *) u_hashmap_get(index->elements, findId);
+    }
+    else if (index && type == NS_PROVIDER_CACHE_SUBSCRIBER_OBSERVE_ID && *findId != 0)
+    {
+        OCObservationId id = (OCObservationId) *findId;
+        return (NSCacheElement *) u_arraylist_get(index->observers[id], 0);
+    }
+    else if (index && type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME)
+    {
+        NSCacheTopicSubscribers * subscribers =
+                (NSCacheTopicSubscribers *) u_hashmap_get(index->topics, findId);
+        return subscribers ? (NSCacheElement *) u_arraylist_get(subscribers->elements, 0) : NULL;
+    }
+
+    NSCacheElement * iter = list->head;
+    while (iter)
+    {
+        if (NSProviderCompareIdCacheData(type, iter->data, findId))
+        {
+            return iter;
+        }
+        iter = iter->next;
+    }
+
+    return NULL;
+}
+
+/* Unlinks and frees the element. NSCacheMutex must be held. */
+static void NSRemoveCacheElement(NSCacheList * list, NSCacheElement * del)
+{
+    NSRemoveFromCacheIndex(list, del);
+
+    if (del == list->head) // first object
+    {
+        if (del == list->tail) // first object (one object)
+        {
+            list->tail = del->next;
+        }
+
+        list->head = del->next;
+    }
+    else
+    {
+        NSCacheElement * prev = list->head;
+        while (prev->next != del)
+        {
+            prev = prev->next;
+        }
+
+        if (del == list->tail) // delete object same to last object
+        {
+            list->tail = prev;
+        }
+
+        prev->next = del->next;
+    }
+
+    NSProviderDeleteCacheData(list->cacheType, del->data);
+    OICFree(del);
+}
+
 NSCacheList * NSProviderStorageCreate()
 {
     pthread_mutex_lock(&NSCacheMutex);
@@ -32,6 +425,7 @@ NSCacheList * NSProviderStorageCreate()
     }
 
     newList->head = newList->tail = NULL;
+    newList->index = NULL;
 
     pthread_mutex_unlock(&NSCacheMutex);
     NS_LOG(DEBUG, "NSCacheCreate");
@@ -45,31 +439,23 @@ NSCacheElement * NSProviderStorageRead(NSCacheList * list, const char * findId)
 
     NS_LOG(DEBUG, "NSCacheRead - IN");
 
-    NSCacheElement * iter = list->head;
-    NSCacheElement * next = NULL;
-    NSCacheType type = list->cacheType;
-
     NS_LOG_V(DEBUG, "Find ID - %s", findId);
 
-    while (iter)
-    {
-        next = iter->next;
+    NSCacheElement * iter = NSFindCacheElement(list, findId);
 
-        if (NSProviderCompareIdCacheData(type, iter->data, findId))
-        {
-            NS_LOG(DEBUG, "Found in Cache");
-            pthread_mutex_unlock(&NSCacheMutex);
-            return iter;
-        }
-
-        iter = next;
+    if (iter)
+    {
+        NS_LOG(DEBUG, "Found in Cache");
+    }
+    else
+    {
+        NS_LOG(DEBUG, "Not found in Cache");
     }
 
-    NS_LOG(DEBUG, "Not found in Cache");
     NS_LOG(DEBUG, "NSCacheRead - OUT");
     pthread_mutex_unlock(&NSCacheMutex);
 
-    return NULL;
+    return iter;
 }
 
 NSResult NSCacheUpdateSubScriptionState(NSCacheList * list, char * id, bool state)
@@ -140,56 +526,65 @@ NSResult NSProviderStorageWrite(NSCacheList * list, NSCacheElement * newObj)
         NS_LOG(DEBUG, "Type is SUBSCRIBER");
 
         NSCacheSubData * subData = (NSCacheSubData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, subData->id);
+        NSCacheElement * it = NSFindCacheElement(list, subData->id);
 
         if (it)
         {
             NSCacheSubData * itData = (NSCacheSubData *) it->data;
 
-            if (strcmp(itData->id, subData->id) == 0)
+            NS_LOG(DEBUG, "Update Data - IN");
+
+            NS_LOG_V(DEBUG, "currData_ID = %s", itData->id);
+            NS_LOG_V(DEBUG, "currData_MsgObID = %d", itData->messageObId);
+            NS_LOG_V(DEBUG, "currData_SyncObID = %d", itData->syncObId);
+            NS_LOG_V(DEBUG, "currData_Cloud_MsgObID = %d", itData->remote_messageObId);
+            NS_LOG_V(DEBUG, "currData_Cloud_SyncObID = %d", itData->remote_syncObId);
+            NS_LOG_V(DEBUG, "currData_IsWhite = %d", itData->isWhite);
+
+            NS_LOG_V(DEBUG, "subData_ID = %s", subData->id);
+            NS_LOG_V(DEBUG, "subData_MsgObID = %d", subData->messageObId);
+            NS_LOG_V(DEBUG, "subData_SyncObID = %d", subData->syncObId);
+            NS_LOG_V(DEBUG, "subData_Cloud_MsgObID = %d", subData->remote_messageObId);
+            NS_LOG_V(DEBUG, "subData_Cloud_SyncObID = %d", subData->remote_syncObId);
+            NS_LOG_V(DEBUG, "subData_IsWhite = %d", subData->isWhite);
+
+            if (list->index)
+            {
+                NSRemoveObservers(list->index, it);
+            }
+
+            if (subData->messageObId != 0)
+            {
+                itData->messageObId = subData->messageObId;
+            }
+
+            if (subData->syncObId != 0)
             {
-                NS_LOG(DEBUG, "Update Data - IN");
-
-                NS_LOG_V(DEBUG, "currData_ID = %s", itData->id);
-                NS_LOG_V(DEBUG, "currData_MsgObID = %d", itData->messageObId);
-                NS_LOG_V(DEBUG, "currData_SyncObID = %d", itData->syncObId);
-                NS_LOG_V(DEBUG, "currData_Cloud_MsgObID = %d", itData->remote_messageObId);
-                NS_LOG_V(DEBUG, "currData_Cloud_SyncObID = %d", itData->remote_syncObId);
-                NS_LOG_V(DEBUG, "currData_IsWhite = %d", itData->isWhite);
-
-                NS_LOG_V(DEBUG, "subData_ID = %s", subData->id);
-                NS_LOG_V(DEBUG, "subData_MsgObID = %d", subData->messageObId);
-                NS_LOG_V(DEBUG, "subData_SyncObID = %d", subData->syncObId);
-                NS_LOG_V(DEBUG, "subData_Cloud_MsgObID = %d", subData->remote_messageObId);
-                NS_LOG_V(DEBUG, "subData_Cloud_SyncObID = %d", subData->remote_syncObId);
-                NS_LOG_V(DEBUG, "subData_IsWhite = %d", subData->isWhite);
-
-                if (subData->messageObId != 0)
-                {
-                    itData->messageObId = subData->messageObId;
-                }
-
-                if (subData->syncObId != 0)
-                {
-                    itData->syncObId = subData->syncObId;
-                }
-
-                if (subData->remote_messageObId != 0)
-                {
-                    itData->remote_messageObId = subData->remote_messageObId;
-                }
-
-                if (subData->remote_syncObId != 0)
-                {
-                    itData->remote_syncObId = subData->remote_syncObId;
-                    NS_LOG_V(DEBUG, "sync id cached: %d", itData->remote_syncObId);
-                }
-
-                NS_LOG(DEBUG, "Update Data - OUT");
+                itData->syncObId = subData->syncObId;
+            }
+
+            if (subData->remote_messageObId != 0)
+            {
+                itData->remote_messageObId = subData->remote_messageObId;
+            }
+
+            if (subData->remote_syncObId != 0)
+            {
+                itData->remote_syncObId = subData->remote_syncObId;
+                NS_LOG_V(DEBUG, "sync id cached: %d", itData->remote_syncObId);
+            }
 
+            if (list->index && !NSAddObservers(list->index, it))
+            {
+                NS_LOG(ERROR, "Fail to index observation ids");
                 pthread_mutex_unlock(&NSCacheMutex);
-                return NS_OK;
+                return NS_ERROR;
             }
+
+            NS_LOG(DEBUG, "Update Data - OUT");
+
+            pthread_mutex_unlock(&NSCacheMutex);
+            return NS_OK;
         }
 
     }
@@ -198,7 +593,7 @@ NSResult NSProviderStorageWrite(NSCacheList * list, NSCacheElement * newObj)
         NS_LOG(DEBUG, "Type is REGITSTER TOPIC");
 
         NSCacheTopicData * topicData = (NSCacheTopicData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, topicData->topicName);
+        NSCacheElement * it = NSFindCacheElement(list, topicData->topicName);
 
         if (it)
         {
@@ -209,37 +604,28 @@ NSResult NSProviderStorageWrite(NSCacheList * list, NSCacheElement * newObj)
             return NS_FAIL;
         }
     }
-    else if(type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME)
+    else if(NSIsConsumerTopicCache(type))
     {
-        NS_LOG(DEBUG, "Type is REGITSTER TOPIC");
+        NS_LOG(DEBUG, "Type is CONSUMER TOPIC");
 
+        // the same topic may be subscribed by many consumers, but only once by each of them.
         NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, topicData->topicName);
 
-        if (it)
+        if (list->index && u_hashmap_get(list->index->elements, topicData))
         {
-            NS_LOG(DEBUG, "already registered for topic name");
+            NS_LOG(DEBUG, "already subscribed for topic name");
             OICFree(topicData->topicName);
             OICFree(topicData);
             pthread_mutex_unlock(&NSCacheMutex);
             return NS_FAIL;
         }
     }
-    else if(type == NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID)
-    {
-        NS_LOG(DEBUG, "Type is REGITSTER TOPIC");
 
-        NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) newObj->data;
-        NSCacheElement * it = NSProviderStorageRead(list, topicData->id);
-
-        if (it)
-        {
-            NS_LOG(DEBUG, "already registered for topic name");
-            OICFree(topicData->topicName);
-            OICFree(topicData);
-            pthread_mutex_unlock(&NSCacheMutex);
-            return NS_FAIL;
-        }
+    if (!NSAddToCacheIndex(list, newObj))
+    {
+        NS_LOG(ERROR, "Fail to index cache data");
+        pthread_mutex_unlock(&NSCacheMutex);
+        return NS_ERROR;
     }
 
     if (list->head == NULL)
@@ -270,6 +656,7 @@ NSResult NSProviderStorageDestroy(NSCacheList * list)
         iter = next;
     }
 
+    NSDestroyCacheIndex(list->index);
     OICFree(list);
     return NS_OK;
 }
@@ -417,57 +804,25 @@ NSResult NSProviderDeleteCacheData(NSCacheType type, void * data)
 NSResult NSProviderStorageDelete(NSCacheList * list, const char * delId)
 {
     pthread_mutex_lock(&NSCacheMutex);
-    NSCacheElement * prev = list->head;
-    NSCacheElement * del = list->head;
 
-    NSCacheType type = list->cacheType;
-
-    if(!del)
+    if(!list->head)
     {
         NS_LOG(DEBUG, "list head is NULL");
         pthread_mutex_unlock(&NSCacheMutex);
         return NS_FAIL;
     }
 
-    if (NSProviderCompareIdCacheData(type, del->data, delId))
-    {
-        if (del == list->head) // first object
-        {
-            if (del == list->tail) // first object (one object)
-            {
-                list->tail = del->next;
-            }
-
-            list->head = del->next;
-            NSProviderDeleteCacheData(type, del->data);
-            OICFree(del);
-            pthread_mutex_unlock(&NSCacheMutex);
-            return NS_OK;
-        }
-    }
+    NSCacheElement * del = NSFindCacheElement(list, delId);
 
-    del = del->next;
-    while (del)
+    if (!del)
     {
-        if (NSProviderCompareIdCacheData(type, del->data, delId))
-        {
-            if (del == list->tail) // delete object same to last object
-            {
-                list->tail = prev;
-            }
-
-            prev->next = del->next;
-            NSProviderDeleteCacheData(type, del->data);
-            OICFree(del);
-            pthread_mutex_unlock(&NSCacheMutex);
-            return NS_OK;
-        }
-
-        prev = del;
-        del = del->next;
+        pthread_mutex_unlock(&NSCacheMutex);
+        return NS_FAIL;
     }
+
+    NSRemoveCacheElement(list, del);
     pthread_mutex_unlock(&NSCacheMutex);
-    return NS_FAIL;
+    return NS_OK;
 }
 
 NSTopicLL * NSProviderGetTopicsCacheData(NSCacheList * regTopicList)
@@ -528,71 +883,66 @@ NSTopicLL * NSProviderGetConsumerTopicsCacheData(NSCacheList * regTopicList,
     pthread_mutex_lock(&NSCacheMutex);
     NSTopicLL * topics = NSProviderGetTopicsCacheData(regTopicList);
 
-    if(!topics)
+    if(!topics || !consumerId || !conTopicList->index)
     {
         pthread_mutex_unlock(&NSCacheMutex);
-        return NULL;
+        return topics;
     }
 
-    NSCacheElement * iter = conTopicList->head;
-    conTopicList->cacheType = NS_PROVIDER_CACHE_CONSUMER_TOPIC_CID;
+    NSCacheTopicSubData key;
+    OICStrcpy(key.id, sizeof(key.id), consumerId);
 
-    while(iter)
+    NSTopicLL * topicIter = topics;
+    while(topicIter)
     {
-        NSCacheTopicSubData * curr = (NSCacheTopicSubData *)iter->data;
+        key.topicName = topicIter->topicName;
 
-        if(curr && strcmp(curr->id, consumerId) == 0)
+        if(key.topicName && u_hashmap_get(conTopicList->index->elements, &key))
         {
-            NS_LOG_V(DEBUG, "curr->id = %s", curr->id);
-            NS_LOG_V(DEBUG, "curr->topicName = %s", curr->topicName);
-
-            NSTopicLL * topicIter = topics;
-            while(topicIter)
-            {
-                if(strcmp(topicIter->topicName, curr->topicName) == 0)
-                {
-                    topicIter->state = NS_TOPIC_SUBSCRIBED;
-                    break;
-                }
-                topicIter = topicIter->next;
-            }
+            NS_LOG_V(DEBUG, "subscribed topicName = %s", key.topicName);
+            topicIter->state = NS_TOPIC_SUBSCRIBED;
         }
-
-        iter = iter->next;
+        topicIter = topicIter->next;
     }
 
-    conTopicList->cacheType = NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME;
     pthread_mutex_unlock(&NSCacheMutex);
     NS_LOG(DEBUG, "NSProviderGetConsumerTopics - OUT");
 
     return topics;
 }
 
-bool NSProviderIsTopicSubScribed(NSCacheElement * conTopicList, char * cId, char * topicName)
+void NSProviderForEachTopicSubscriber(NSCacheList * subList, NSCacheList * conTopicList,
+        const char * topicName, NSCacheSubDataCallback callback, void * context)
 {
     pthread_mutex_lock(&NSCacheMutex);
 
-    if(!conTopicList || !cId || !topicName)
+    if(!subList || !subList->index || !conTopicList || !conTopicList->index ||
+            !topicName || !callback)
     {
         pthread_mutex_unlock(&NSCacheMutex);
-        return false;
+        return;
     }
 
-    NSCacheElement * iter = conTopicList;
-    while(iter)
+    NSCacheTopicSubscribers * subscribers = (NSCacheTopicSubscribers *)
+            u_hashmap_get(conTopicList->index->topics, topicName);
+
+    uint32_t len = subscribers ? u_arraylist_length(subscribers->elements) : 0;
+
+    for (uint32_t i = 0; i < len; i++)
     {
-        NSCacheTopicSubData * curr = (NSCacheTopicSubData *) iter->data;
+        NSCacheElement * topicElement =
+                (NSCacheElement *) u_arraylist_get(subscribers->elements, i);
+        NSCacheTopicSubData * topicData = (NSCacheTopicSubData *) topicElement->data;
 
-        if( (strcmp(curr->id, cId) == 0) && (strcmp(curr->topicName, topicName) == 0) )
+        NSCacheElement * subElement =
+                (NSCacheElement *) u_hashmap_get(subList->index->elements, topicData->id);
+        if (subElement)
         {
-            pthread_mutex_unlock(&NSCacheMutex);
-            return true;
+            callback((NSCacheSubData *) subElement->data, context);
         }
-        iter = iter->next;
     }
 
     pthread_mutex_unlock(&NSCacheMutex);
-    return false;
 }
 
 NSResult NSProviderDeleteConsumerTopic(NSCacheList * conTopicList,
@@ -609,65 +959,26 @@ NSResult NSProviderDeleteConsumerTopic(NSCacheList * conTopicList,
         return NS_ERROR;
     }
 
-    NSCacheElement * prev = conTopicList->head;
-    NSCacheElement * del = conTopicList->head;
-
-    NSCacheType type = conTopicList->cacheType;
-
-    if(!del)
+    if(!conTopicList->head || !conTopicList->index)
     {
         NS_LOG(DEBUG, "list head is NULL");
         pthread_mutex_unlock(&NSCacheMutex);
         return NS_FAIL;
     }
 
-    NSCacheTopicSubData * curr = (NSCacheTopicSubData *) del->data;
     NS_LOG_V(DEBUG, "compareid = %s", cId);
     NS_LOG_V(DEBUG, "comparetopicName = %s", topicName);
-    NS_LOG_V(DEBUG, "curr->id = %s", curr->id);
-    NS_LOG_V(DEBUG, "curr->topicName = %s", curr->topicName);
-
-    if( (strncmp(curr->id, cId, NS_UUID_STRING_SIZE) == 0) &&
-            (strcmp(curr->topicName, topicName) == 0) )
-    {
-        if (del == conTopicList->head) // first object
-        {
-            if (del == conTopicList->tail) // first object (one object)
-            {
-                conTopicList->tail = del->next;
-            }
 
-            conTopicList->head = del->next;
-            NSProviderDeleteCacheData(type, del->data);
-            OICFree(del);
-            pthread_mutex_unlock(&NSCacheMutex);
-            return NS_OK;
-        }
-    }
+    NSCacheElement * del =
+            (NSCacheElement *) u_hashmap_get(conTopicList->index->elements, topicSubData);
 
-    curr = NULL;
-    del = del->next;
-    while (del)
+    if (!del)
     {
-        curr = (NSCacheTopicSubData *) del->data;
-        if( (strncmp(curr->id, cId, NS_UUID_STRING_SIZE) == 0) &&
-                (strcmp(curr->topicName, topicName) == 0) )
-        {
-            if (del == conTopicList->tail) // delete object same to last object
-            {
-                conTopicList->tail = prev;
-            }
-
-            prev->next = del->next;
-            NSProviderDeleteCacheData(type, del->data);
-            OICFree(del);
-            pthread_mutex_unlock(&NSCacheMutex);
-            return NS_OK;
-        }
-
-        prev = del;
-        del = del->next;
+        pthread_mutex_unlock(&NSCacheMutex);
+        return NS_FAIL;
     }
+
+    NSRemoveCacheElement(conTopicList, del);
     pthread_mutex_unlock(&NSCacheMutex);
-    return NS_FAIL;
+    return NS_OK;
 }
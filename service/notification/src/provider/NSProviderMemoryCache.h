@@ -52,12 +52,16 @@ NSTopicLL * NSProviderGetTopicsCacheData(NSCacheList * regTopicList);
 NSTopicLL * NSProviderGetConsumerTopicsCacheData(NSCacheList * regTopicList,
         NSCacheList * conTopicList, const char * consumerId);
 
-bool NSProviderIsTopicSubScribed(NSCacheElement * conTopicList, char * cId, char * topicName);
+typedef void (* NSCacheSubDataCallback)(NSCacheSubData * subData, void * context);
+
+/* Calls callback for each subscriber of the topic, with NSCacheMutex held. */
+void NSProviderForEachTopicSubscriber(NSCacheList * subList, NSCacheList * conTopicList,
+        const char * topicName, NSCacheSubDataCallback callback, void * context);
 
 NSResult NSProviderDeleteConsumerTopic(NSCacheList * conTopicList,
         NSCacheTopicSubData * topicSubData);
 
-pthread_mutex_t NSCacheMutex;
-pthread_mutexattr_t NSCacheMutexAttr;
+extern pthread_mutex_t NSCacheMutex;
+extern pthread_mutexattr_t NSCacheMutexAttr;
 
 #endif /* _NS_PROVIDER_CACHEADAPTER__H_ */
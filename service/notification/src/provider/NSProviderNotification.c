@@ -20,6 +20,25 @@
 
 #include "NSProviderNotification.h"
 
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include "oic_time.h"
+
+// OCNotifyListOfObservers() takes the number of observers as uint8_t.
+#define NS_MAX_OBSERVER_COUNT 255
+
+// observation ids are uint8_t, so a notification has at most this many distinct observers.
+#define NS_OBSERVATION_ID_COUNT (UINT8_MAX + 1)
+
+typedef struct
+{
+    OCObservationId ids[NS_OBSERVATION_ID_COUNT];
+    bool added[NS_OBSERVATION_ID_COUNT];
+    int count;
+} NSObserverList;
+
 NSResult NSSetMessagePayload(NSMessage *msg, OCRepPayload** msgPayload)
 {
     NS_LOG(DEBUG, "NSSetMessagePayload - IN");
@@ -76,102 +95,130 @@ NSResult NSSetSyncPayload(NSSyncInfo *sync, OCRepPayload** syncPayload)
     return NS_OK;
 }
 
-NSResult NSSendNotification(NSMessage *msg)
+static void NSAddObserver(NSObserverList * observers, int obId)
 {
-    NS_LOG(DEBUG, "NSSendMessage - IN");
+    if (obId > 0 && obId < NS_OBSERVATION_ID_COUNT && !observers->added[obId])
+    {
+        observers->added[obId] = true;
+        observers->ids[observers->count++] = (OCObservationId) obId;
+    }
+}
 
-    OCResourceHandle rHandle;
-    OCObservationId obArray[255] = { 0, };
-    int obCount = 0, i;
+static void NSAddMessageObservers(NSCacheSubData * subData, void * context)
+{
+    NSObserverList * observers = (NSObserverList *) context;
 
-    if (NSPutMessageResource(msg, &rHandle) != NS_OK)
+    NS_LOG_V(DEBUG, "message subData->id = %s", subData->id);
+    NS_LOG_V(DEBUG, "subData->messageId = %d", subData->messageObId);
+    NS_LOG_V(DEBUG, "subData->cloud_messageId = %d", subData->remote_messageObId);
+    NS_LOG_V(DEBUG, "subData->isWhite = %d", subData->isWhite);
+
+    if (!subData->isWhite)
     {
-        NS_LOG(ERROR, "fail to Put notification resource");
-        return NS_ERROR;
+        return;
     }
 
-    if (consumerSubList->head == NULL)
+    NSAddObserver(observers, subData->messageObId);
+
+#if(defined WITH_CLOUD && defined RD_CLIENT)
+    NSAddObserver(observers, subData->remote_messageObId);
+#endif
+}
+
+static int NSGetMessageObservers(NSMessage *msg, NSObserverList * observers)
+{
+    memset(observers, 0, sizeof(NSObserverList));
+
+    if (msg->topic && (msg->topic)[0] != '\0')
     {
-        NS_LOG(ERROR, "SubList->head is NULL, empty SubList");
-        return NS_ERROR;
+        NS_LOG_V(DEBUG, "this is topic message: %s", msg->topic);
+
+        NSProviderForEachTopicSubscriber(consumerSubList, consumerTopicList, msg->topic,
+                NSAddMessageObservers, observers);
     }
+    else
+    {
+        NSCacheElement * it = consumerSubList->head;
 
-    OCRepPayload* payload = NULL;
+        while (it)
+        {
+            NSAddMessageObservers((NSCacheSubData *) it->data, observers);
+            it = it->next;
+        }
+    }
 
-    if (NSSetMessagePayload(msg, &payload) != NS_OK)
+    for (int i = 0; i < observers->count; ++i)
     {
-        NS_LOG(ERROR, "fail to Get message payload");
-        return NS_ERROR;
+        NS_LOG(DEBUG, "-------------------------------------------------------message\n");
+        NS_LOG_V(DEBUG, "SubScription WhiteList[%d] = %d", i, observers->ids[i]);
+        NS_LOG(DEBUG, "-------------------------------------------------------message\n");
     }
 
-    NSCacheElement * it = consumerSubList->head;
+    return observers->count;
+}
 
-    while (it)
+/* Notifies the observers NS_MAX_OBSERVER_COUNT at a time, returns the first failure. */
+static OCStackResult NSNotifyObservers(OCResourceHandle rHandle, OCObservationId * obArray,
+        int obCount, OCRepPayload * payload)
+{
+    OCStackResult result = OC_STACK_OK;
+
+    for (int sent = 0; sent < obCount; sent += NS_MAX_OBSERVER_COUNT)
     {
-        NSCacheSubData * subData = (NSCacheSubData *) it->data;
-        NS_LOG_V(DEBUG, "message subData->id = %s", subData->id);
-        NS_LOG_V(DEBUG, "subData->messageId = %d", subData->messageObId);
-        NS_LOG_V(DEBUG, "subData->cloud_messageId = %d", subData->remote_messageObId);
-        NS_LOG_V(DEBUG, "subData->syncId = %d", subData->syncObId);
-        NS_LOG_V(DEBUG, "subData->cloud_syncId = %d", subData->remote_syncObId);
-        NS_LOG_V(DEBUG, "subData->isWhite = %d", subData->isWhite);
+        int count = obCount - sent;
+        if (count > NS_MAX_OBSERVER_COUNT)
+        {
+            count = NS_MAX_OBSERVER_COUNT;
+        }
 
-        if (subData->isWhite)
+        OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray + sent,
+                (uint8_t) count, payload, OC_LOW_QOS);
+
+        if (ocstackResult != OC_STACK_OK && result == OC_STACK_OK)
         {
-            if(subData->messageObId != 0)
-            {
-                if(msg->topic && (msg->topic)[0] != '\0')
-                {
-                    NS_LOG_V(DEBUG, "this is topic message: %s", msg->topic);
+            result = ocstackResult;
+        }
+    }
 
-                    if(NSProviderIsTopicSubScribed(consumerTopicList->head, subData->id, msg->topic))
-                    {
-                        obArray[obCount++] = subData->messageObId;
-                    }
-                }
-                else
-                {
-                    obArray[obCount++] = subData->messageObId;
-                }
-            }
+    return result;
+}
 
-#if(defined WITH_CLOUD && defined RD_CLIENT)
-            if(subData->remote_messageObId != 0)
-            {
-                if(msg->topic && (msg->topic)[0] != '\0')
-                {
-                    NS_LOG_V(DEBUG, "this is topic message via remote server: %s", msg->topic);
-                    if(NSProviderIsTopicSubScribed(consumerTopicList->head, subData->id, msg->topic))
-                    {
-                        obArray[obCount++] = subData->remote_messageObId;
-                    }
-                }
-                else
-                {
-                    obArray[obCount++] = subData->remote_messageObId;
-                }
-            }
-#endif
+NSResult NSSendNotification(NSMessage *msg)
+{
+    NS_LOG(DEBUG, "NSSendMessage - IN");
 
-        }
-        it = it->next;
+    OCResourceHandle rHandle;
+    NSObserverList observers;
+
+    if (NSPutMessageResource(msg, &rHandle) != NS_OK)
+    {
+        NS_LOG(ERROR, "fail to Put notification resource");
+        return NS_ERROR;
     }
 
-    for (i = 0; i < obCount; ++i)
+    if (consumerSubList->head == NULL)
     {
-        NS_LOG(DEBUG, "-------------------------------------------------------message\n");
-        NS_LOG_V(DEBUG, "SubScription WhiteList[%d] = %d", i, obArray[i]);
-        NS_LOG(DEBUG, "-------------------------------------------------------message\n");
+        NS_LOG(ERROR, "SubList->head is NULL, empty SubList");
+        return NS_ERROR;
     }
 
+    int obCount = NSGetMessageObservers(msg, &observers);
+
     if(!obCount)
     {
         NS_LOG(ERROR, "observer count is zero");
         return NS_ERROR;
     }
 
-    OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray, obCount, payload,
-            OC_LOW_QOS);
+    OCRepPayload* payload = NULL;
+
+    if (NSSetMessagePayload(msg, &payload) != NS_OK)
+    {
+        NS_LOG(ERROR, "fail to Get message payload");
+        return NS_ERROR;
+    }
+
+    OCStackResult ocstackResult = NSNotifyObservers(rHandle, observers.ids, obCount, payload);
 
     NS_LOG_V(DEBUG, "Message ocstackResult = %d", ocstackResult);
 
@@ -194,8 +241,8 @@ NSResult NSSendSync(NSSyncInfo *sync)
 {
     NS_LOG(DEBUG, "NSSendSync - IN");
 
-    OCObservationId obArray[255] = { 0, };
-    int obCount = 0;
+    NSObserverList observers;
+    memset(&observers, 0, sizeof(NSObserverList));
     int i;
 
     OCResourceHandle rHandle;
@@ -219,16 +266,10 @@ NSResult NSSendSync(NSSyncInfo *sync)
 
         if (subData->isWhite)
         {
-            if(subData->syncObId != 0)
-            {
-                obArray[obCount++] = subData->syncObId;
-            }
+            NSAddObserver(&observers, subData->syncObId);
 
 #if(defined WITH_CLOUD && defined RD_CLIENT)
-            if(subData->remote_syncObId != 0)
-            {
-                obArray[obCount++] = subData->remote_syncObId;
-            }
+            NSAddObserver(&observers, subData->remote_syncObId);
 #endif
         }
         it = it->next;
@@ -241,15 +282,15 @@ NSResult NSSendSync(NSSyncInfo *sync)
         return NS_ERROR;
     }
 
-    for (i = 0; i < obCount; ++i)
+    for (i = 0; i < observers.count; ++i)
     {
         NS_LOG(DEBUG, "-------------------------------------------------------message\n");
-        NS_LOG_V(DEBUG, "Sync WhiteList[%d] = %d", i, obArray[i]);
+        NS_LOG_V(DEBUG, "Sync WhiteList[%d] = %d", i, observers.ids[i]);
         NS_LOG(DEBUG, "-------------------------------------------------------message\n");
     }
 
-    OCStackResult ocstackResult = OCNotifyListOfObservers(rHandle, obArray,
-            obCount, payload, OC_LOW_QOS);
+    OCStackResult ocstackResult = NSNotifyObservers(rHandle, observers.ids, observers.count,
+            payload);
 
     NS_LOG_V(DEBUG, "Sync ocstackResult = %d", ocstackResult);
 
@@ -266,6 +307,260 @@ NSResult NSSendSync(NSSyncInfo *sync)
     return NS_OK;
 }
 
+static pthread_mutex_t NSBatchMutex = PTHREAD_MUTEX_INITIALIZER; // guards config and metrics
+static uint32_t NSBatchWindow = 0;
+static uint32_t NSBatchMaxCount = 0;
+static NSBatchMetrics NSBatchStats;
+
+// The waiting batch is only touched by the notification scheduler thread.
+static NSMessage * NSBatchMsg[NS_MAX_BATCH_SIZE];
+static size_t NSBatchCount = 0;
+static uint64_t NSBatchStartTime = 0;
+static struct timespec NSBatchDeadline;
+
+void NSSetMessageBatching(uint32_t windowMs, uint32_t maxCount)
+{
+    pthread_mutex_lock(&NSBatchMutex);
+    NSBatchWindow = windowMs;
+    NSBatchMaxCount = maxCount;
+    pthread_mutex_unlock(&NSBatchMutex);
+}
+
+void NSGetProviderBatchMetrics(NSBatchMetrics * metrics)
+{
+    pthread_mutex_lock(&NSBatchMutex);
+    *metrics = NSBatchStats;
+    pthread_mutex_unlock(&NSBatchMutex);
+}
+
+void NSResetProviderBatchMetrics()
+{
+    pthread_mutex_lock(&NSBatchMutex);
+    memset(&NSBatchStats, 0, sizeof(NSBatchStats));
+    pthread_mutex_unlock(&NSBatchMutex);
+}
+
+/* Only notifications that carry a batch are counted, like the consumer does. */
+static void NSUpdateBatchMetrics(size_t count, uint64_t delay)
+{
+    pthread_mutex_lock(&NSBatchMutex);
+    NSBatchStats.batchCount++;
+    NSBatchStats.messageCount += count;
+    if (count > NSBatchStats.maxBatchSize)
+    {
+        NSBatchStats.maxBatchSize = (uint32_t) count;
+    }
+    NSBatchStats.totalDelay += delay;
+    if (delay > NSBatchStats.maxDelay)
+    {
+        NSBatchStats.maxDelay = delay;
+    }
+    pthread_mutex_unlock(&NSBatchMutex);
+}
+
+static NSResult NSNotifyMessageBatch(OCResourceHandle rHandle, OCObservationId * obArray,
+        int obCount, OCRepPayload ** payloads, uint64_t msgMask, uint64_t delay)
+{
+    const OCRepPayload * items[NS_MAX_BATCH_SIZE];
+    size_t itemCount = 0;
+
+    for (size_t i = 0; i < NS_MAX_BATCH_SIZE; ++i)
+    {
+        if (msgMask & ((uint64_t) 1 << i))
+        {
+            items[itemCount++] = payloads[i];
+        }
+    }
+
+    OCRepPayload * batch = NULL;
+    OCRepPayload * payload = (OCRepPayload *) items[0];
+
+    // A single message goes out as before, so consumers without batch support can read it.
+    if (itemCount > 1)
+    {
+        size_t dimensions[MAX_REP_ARRAY_DEPTH] = { itemCount, 0, 0 };
+        batch = OCRepPayloadCreate();
+
+        if (!batch ||
+                !OCRepPayloadSetUri(batch, NS_COLLECTION_MESSAGE_URI) ||
+                !OCRepPayloadSetPropObjectArray(batch, NS_ATTRIBUTE_MESSAGES, items, dimensions) ||
+                !OCRepPayloadSetPropInt(batch, NS_ATTRIBUTE_BATCH_DELAY, (int64_t) delay))
+        {
+            NS_LOG(ERROR, "Failed to allocate batch payload");
+            OCRepPayloadDestroy(batch);
+            return NS_ERROR;
+        }
+        payload = batch;
+    }
+
+    NS_LOG_V(DEBUG, "Send %zu messages to %d observers", itemCount, obCount);
+
+    OCStackResult ocstackResult = NSNotifyObservers(rHandle, obArray, obCount, payload);
+    OCRepPayloadDestroy(batch);
+
+    if (batch && ocstackResult == OC_STACK_OK)
+    {
+        NSUpdateBatchMetrics(itemCount, delay);
+    }
+
+    NS_LOG_V(DEBUG, "Message batch ocstackResult = %d", ocstackResult);
+    return ocstackResult == OC_STACK_OK ? NS_OK : NS_ERROR;
+}
+
+/*
+ * Sends the waiting messages. The messages of each observer are coalesced into one
+ * notification, and observers that get the same messages share that notification.
+ */
+static void NSSendMessageBatch(NSMessage ** msgs, size_t count, uint64_t delay)
+{
+    // messages by observation id, a bit for each message of the batch
+    uint64_t msgMasks[NS_OBSERVATION_ID_COUNT] = { 0, };
+    OCRepPayload * payloads[NS_MAX_BATCH_SIZE] = { NULL, };
+    OCObservationId obArray[NS_OBSERVATION_ID_COUNT] = { 0, };
+    NSObserverList observers;
+    OCResourceHandle rHandle = NULL;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (NSPutMessageResource(msgs[i], &rHandle) != NS_OK || consumerSubList->head == NULL)
+        {
+            continue;
+        }
+
+        int obCount = NSGetMessageObservers(msgs[i], &observers);
+        if (!obCount || NSSetMessagePayload(msgs[i], &payloads[i]) != NS_OK)
+        {
+            continue;
+        }
+        msgs[i]->extraInfo = NULL;
+
+        for (int j = 0; j < obCount; ++j)
+        {
+            msgMasks[observers.ids[j]] |= (uint64_t) 1 << i;
+        }
+    }
+
+    for (int id = 0; id < NS_OBSERVATION_ID_COUNT; ++id)
+    {
+        uint64_t msgMask = msgMasks[id];
+        if (!msgMask)
+        {
+            continue;
+        }
+
+        int obCount = 0;
+        for (int other = id; other < NS_OBSERVATION_ID_COUNT; ++other)
+        {
+            if (msgMasks[other] == msgMask)
+            {
+                obArray[obCount++] = (OCObservationId) other;
+                msgMasks[other] = 0;
+            }
+        }
+
+        if (NSNotifyMessageBatch(rHandle, obArray, obCount, payloads, msgMask, delay) != NS_OK)
+        {
+            NS_LOG(ERROR, "fail to send message batch");
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        OCRepPayloadDestroy(payloads[i]);
+    }
+}
+
+static void NSFlushMessageBatch()
+{
+    if (!NSBatchCount)
+    {
+        return;
+    }
+
+    size_t count = NSBatchCount;
+    uint64_t delay = OICGetCurrentTime(TIME_IN_MS) - NSBatchStartTime;
+    NSBatchCount = 0;
+
+    NS_LOG_V(DEBUG, "Flush %zu messages held for %" PRIu64 " ms", count, delay);
+    NSSendMessageBatch(NSBatchMsg, count, delay);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        NSFreeMessage(NSBatchMsg[i]);
+        NSBatchMsg[i] = NULL;
+    }
+}
+
+static bool NSIsBatchDeadlinePassed()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return now.tv_sec > NSBatchDeadline.tv_sec
+        || (now.tv_sec == NSBatchDeadline.tv_sec && now.tv_nsec >= NSBatchDeadline.tv_nsec);
+}
+
+/* Returns false if the message is not batched and has to be sent by the caller. */
+static bool NSBatchMessage(NSMessage * msg)
+{
+    pthread_mutex_lock(&NSBatchMutex);
+    uint32_t windowMs = NSBatchWindow;
+    uint32_t maxCount = NSBatchMaxCount;
+    pthread_mutex_unlock(&NSBatchMutex);
+
+    if (!windowMs || maxCount < 2)
+    {
+        // batching was turned off, the waiting messages still go first
+        NSFlushMessageBatch();
+        return false;
+    }
+
+    if (!NSBatchCount)
+    {
+        NSBatchStartTime = OICGetCurrentTime(TIME_IN_MS);
+
+        clock_gettime(CLOCK_REALTIME, &NSBatchDeadline);
+        NSBatchDeadline.tv_sec += windowMs / 1000;
+        NSBatchDeadline.tv_nsec += (long) (windowMs % 1000) * 1000000L;
+        if (NSBatchDeadline.tv_nsec >= 1000000000L)
+        {
+            NSBatchDeadline.tv_sec++;
+            NSBatchDeadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    NSBatchMsg[NSBatchCount++] = msg;
+
+    // a steady stream of tasks never lets the scheduler's timed wait run out
+    if (NSBatchCount >= maxCount || NSBatchCount >= NS_MAX_BATCH_SIZE
+        || NSIsBatchDeadlinePassed())
+    {
+        NSFlushMessageBatch();
+    }
+
+    return true;
+}
+
+/* Returns false if the batch window elapsed before a task was queued. */
+static bool NSWaitNotificationTask()
+{
+    if (!NSBatchCount)
+    {
+        sem_wait(&NSSemaphore[NOTIFICATION_SCHEDULER]);
+        return true;
+    }
+
+    while (sem_timedwait(&NSSemaphore[NOTIFICATION_SCHEDULER], &NSBatchDeadline) != 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void * NSNotificationSchedule(void *ptr)
 {
     if (ptr == NULL)
@@ -275,7 +570,14 @@ void * NSNotificationSchedule(void *ptr)
 
     while (NSIsRunning[NOTIFICATION_SCHEDULER])
     {
-        sem_wait(&NSSemaphore[NOTIFICATION_SCHEDULER]);
+        if (!NSWaitNotificationTask())
+        {
+            pthread_mutex_lock(&NSMutex[NOTIFICATION_SCHEDULER]);
+            NSFlushMessageBatch();
+            pthread_mutex_unlock(&NSMutex[NOTIFICATION_SCHEDULER]);
+            continue;
+        }
+
         pthread_mutex_lock(&NSMutex[NOTIFICATION_SCHEDULER]);
 
         if (NSHeadMsg[NOTIFICATION_SCHEDULER] != NULL)
@@ -288,17 +590,22 @@ void * NSNotificationSchedule(void *ptr)
                 case TASK_SEND_NOTIFICATION:
                 {
                     NS_LOG(DEBUG, "CASE TASK_SEND_NOTIFICATION : ");
-                    NSSendNotification((NSMessage *)node->taskData);
-                    NSFreeMessage((NSMessage *)node->taskData);
+                    if (!NSBatchMessage((NSMessage *)node->taskData))
+                    {
+                        NSSendNotification((NSMessage *)node->taskData);
+                        NSFreeMessage((NSMessage *)node->taskData);
+                    }
                 }
                     break;
                 case TASK_SEND_READ:
                     NS_LOG(DEBUG, "CASE TASK_SEND_READ : ");
+                    NSFlushMessageBatch();
                     NSSendSync((NSSyncInfo*) node->taskData);
                     NSFreeSync((NSSyncInfo*) node->taskData);
                     break;
                 case TASK_RECV_READ:
                     NS_LOG(DEBUG, "CASE TASK_RECV_READ : ");
+                    NSFlushMessageBatch();
                     NSSendSync((NSSyncInfo*) node->taskData);
                     NSPushQueue(CALLBACK_RESPONSE_SCHEDULER, TASK_CB_SYNC, node->taskData);
                     break;
@@ -314,6 +621,14 @@ void * NSNotificationSchedule(void *ptr)
 
     }
 
+    // the resources are gone by now, waiting messages are dropped like the queued ones
+    for (size_t i = 0; i < NSBatchCount; ++i)
+    {
+        NSFreeMessage(NSBatchMsg[i]);
+        NSBatchMsg[i] = NULL;
+    }
+    NSBatchCount = 0;
+
     NS_LOG(INFO, "Destroy NSNotificationSchedule");
     return NULL;
 }
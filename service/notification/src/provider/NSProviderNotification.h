@@ -34,4 +34,8 @@
 
 NSResult NSRegisterResource();
 
+void NSSetMessageBatching(uint32_t windowMs, uint32_t maxCount);
+void NSGetProviderBatchMetrics(NSBatchMetrics * metrics);
+void NSResetProviderBatchMetrics();
+
 #endif /* _NS_PROVIDER_NOTIFICATION_H_ */
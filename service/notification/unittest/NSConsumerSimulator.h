@@ -153,8 +153,26 @@ private:
             const OC::OCRepresentation &rep , const int & /*eCode*/, const int &,
             std::shared_ptr<OC::OCResource> )
     {
-        if (rep.getUri() == "/notification/message" && rep.hasAttribute("messageId")
-                && rep.getValue<int>("messageId") != 1)
+        if (rep.getUri() == "/notification/message" && rep.hasAttribute("messages"))
+        {
+            for (auto & message : rep.getValue<std::vector<OC::OCRepresentation>>("messages"))
+            {
+                onMessage(message);
+            }
+        }
+        else if (rep.getUri() == "/notification/message")
+        {
+            onMessage(rep);
+        }
+        else if (rep.getUri() == "/notification/sync")
+        {
+            m_syncFunc(int(rep.getValue<int>("state")), int(rep.getValue<int>("messageId")));
+        }
+    }
+
+    void onMessage(const OC::OCRepresentation & rep)
+    {
+        if (rep.hasAttribute("messageId") && rep.getValue<int>("messageId") != 1)
         {
             m_messageFunc(int(rep.getValue<int>("messageId")),
                           std::string(rep.getValueToString("title")),
@@ -169,10 +187,6 @@ private:
                                 OC::QualityOfService::LowQos);
             }
         }
-        else if (rep.getUri() == "/notification/sync")
-        {
-            m_syncFunc(int(rep.getValue<int>("state")), int(rep.getValue<int>("messageId")));
-        }
     }
 
     void onTopicGet(const OC::HeaderOptions &/*headerOption*/,
@@ -0,0 +1,218 @@
+//******************************************************************
+//
+// Copyright 2016 Samsung Electronics All Rights Reserved.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+extern "C"
+{
+#include "NSProviderMemoryCache.h"
+}
+
+namespace
+{
+    void NSCountSubscriber(NSCacheSubData * subData, void * context)
+    {
+        if (subData->isWhite)
+        {
+            (*(size_t *) context)++;
+        }
+    }
+}
+
+class NotificationProviderCacheTest : public testing::Test
+{
+protected:
+    NSCacheList * subList;
+    NSCacheList * topicList;
+
+    static void SetUpTestCase()
+    {
+        pthread_mutexattr_init(&NSCacheMutexAttr);
+        pthread_mutexattr_settype(&NSCacheMutexAttr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&NSCacheMutex, &NSCacheMutexAttr);
+    }
+
+    static void TearDownTestCase()
+    {
+        pthread_mutex_destroy(&NSCacheMutex);
+        pthread_mutexattr_destroy(&NSCacheMutexAttr);
+    }
+
+    void SetUp()
+    {
+        subList = NSProviderStorageCreate();
+        subList->cacheType = NS_PROVIDER_CACHE_SUBSCRIBER;
+        topicList = NSProviderStorageCreate();
+        topicList->cacheType = NS_PROVIDER_CACHE_CONSUMER_TOPIC_NAME;
+    }
+
+    void TearDown()
+    {
+        NSProviderStorageDestroy(subList);
+        NSProviderStorageDestroy(topicList);
+    }
+
+    NSResult WriteSubscriber(const std::string & id, int messageObId, int syncObId, bool isWhite)
+    {
+        NSCacheSubData * subData = (NSCacheSubData *) OICCalloc(1, sizeof(NSCacheSubData));
+        OICStrcpy(subData->id, sizeof(subData->id), id.c_str());
+        subData->messageObId = messageObId;
+        subData->syncObId = syncObId;
+        subData->isWhite = isWhite;
+
+        NSCacheElement * element = (NSCacheElement *) OICCalloc(1, sizeof(NSCacheElement));
+        element->data = (NSCacheData *) subData;
+        return NSProviderStorageWrite(subList, element);
+    }
+
+    NSResult WriteTopic(const std::string & id, const std::string & topicName)
+    {
+        NSCacheTopicSubData * topicData =
+                (NSCacheTopicSubData *) OICCalloc(1, sizeof(NSCacheTopicSubData));
+        OICStrcpy(topicData->id, sizeof(topicData->id), id.c_str());
+        topicData->topicName = OICStrdup(topicName.c_str());
+
+        NSCacheElement * element = (NSCacheElement *) OICCalloc(1, sizeof(NSCacheElement));
+        element->data = (NSCacheData *) topicData;
+        return NSProviderStorageWrite(topicList, element);
+    }
+
+    size_t CountTopicSubscribers(const std::string & topicName)
+    {
+        size_t count = 0;
+        NSProviderForEachTopicSubscriber(subList, topicList, topicName.c_str(),
+                NSCountSubscriber, &count);
+        return count;
+    }
+
+    NSCacheSubData * ReadObserver(OCObservationId id)
+    {
+        subList->cacheType = NS_PROVIDER_CACHE_SUBSCRIBER_OBSERVE_ID;
+        NSCacheElement * element = NSProviderStorageRead(subList, (const char *) &id);
+        subList->cacheType = NS_PROVIDER_CACHE_SUBSCRIBER;
+        return element ? (NSCacheSubData *) element->data : NULL;
+    }
+
+    int DeleteObserver(OCObservationId id)
+    {
+        int count = 0;
+        subList->cacheType = NS_PROVIDER_CACHE_SUBSCRIBER_OBSERVE_ID;
+        while (NSProviderStorageDelete(subList, (const char *) &id) != NS_FAIL)
+        {
+            count++;
+        }
+        subList->cacheType = NS_PROVIDER_CACHE_SUBSCRIBER;
+        return count;
+    }
+};
+
+TEST_F(NotificationProviderCacheTest, TopicSubscribersAreNotLimitedToOneNotification)
+{
+    for (int i = 0; i < 600; i++)
+    {
+        std::string id = "consumer" + std::to_string(i);
+        ASSERT_EQ(NS_OK, WriteSubscriber(id, i % 255 + 1, 0, i % 2 == 0));
+        ASSERT_EQ(NS_OK, WriteTopic(id, "topic"));
+    }
+
+    EXPECT_EQ(300u, CountTopicSubscribers("topic"));
+    EXPECT_EQ(0u, CountTopicSubscribers("unknown"));
+}
+
+TEST_F(NotificationProviderCacheTest, FindsSubscriberByObservationId)
+{
+    ASSERT_EQ(NS_OK, WriteSubscriber("consumer1", 10, 0, true));
+    ASSERT_EQ(NS_OK, WriteSubscriber("consumer2", 20, 21, true));
+
+    ASSERT_NE(nullptr, ReadObserver(10));
+    EXPECT_STREQ("consumer1", ReadObserver(10)->id);
+    ASSERT_NE(nullptr, ReadObserver(21));
+    EXPECT_STREQ("consumer2", ReadObserver(21)->id);
+    EXPECT_EQ(nullptr, ReadObserver(30));
+
+    // the sync observation of consumer1 arrives later
+    ASSERT_EQ(NS_OK, WriteSubscriber("consumer1", 0, 30, true));
+    ASSERT_NE(nullptr, ReadObserver(30));
+    EXPECT_STREQ("consumer1", ReadObserver(30)->id);
+    EXPECT_EQ(10, ReadObserver(30)->messageObId);
+}
+
+TEST_F(NotificationProviderCacheTest, DeletesEverySubscriberOfObservationId)
+{
+    ASSERT_EQ(NS_OK, WriteSubscriber("consumer1", 10, 11, true));
+    ASSERT_EQ(NS_OK, WriteSubscriber("consumer2", 20, 11, true));
+    ASSERT_EQ(NS_OK, WriteSubscriber("consumer3", 30, 31, true));
+
+    EXPECT_EQ(2, DeleteObserver(11));
+    EXPECT_EQ(nullptr, ReadObserver(10));
+    EXPECT_EQ(nullptr, ReadObserver(20));
+    EXPECT_EQ(nullptr, NSProviderStorageRead(subList, "consumer1"));
+    EXPECT_EQ(nullptr, NSProviderStorageRead(subList, "consumer2"));
+    EXPECT_NE(nullptr, NSProviderStorageRead(subList, "consumer3"));
+    EXPECT_EQ(0, DeleteObserver(11));
+}
+
+// Measures the lookups of one notification sent to 5000 consumers over 50 topics.
+TEST_F(NotificationProviderCacheTest, FanOutBenchmark)
+{
+    const int consumerCount = 5000;
+    const int topicCount = 50;
+
+    for (int i = 0; i < consumerCount; i++)
+    {
+        std::string id = "consumer" + std::to_string(i);
+        ASSERT_EQ(NS_OK, WriteSubscriber(id, i % 255 + 1, 0, true));
+        ASSERT_EQ(NS_OK, WriteTopic(id, "topic" + std::to_string(i % topicCount)));
+        ASSERT_EQ(NS_OK, WriteTopic(id, "topic" + std::to_string((i + 1) % topicCount)));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t total = 0;
+    for (int round = 0; round < 100; round++)
+    {
+        for (int topic = 0; topic < topicCount; topic++)
+        {
+            total += CountTopicSubscribers("topic" + std::to_string(topic));
+        }
+    }
+    auto fanOut = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ((size_t) 100 * 2 * consumerCount, total);
+
+    start = std::chrono::steady_clock::now();
+    int deleted = 0;
+    for (int id = 1; id <= 255; id++)
+    {
+        deleted += DeleteObserver((OCObservationId) id);
+    }
+    auto unsubscribe = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(consumerCount, deleted);
+
+    std::cout << "topic fan-out: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(fanOut).count() / 100
+              << " us per round of " << topicCount << " topics, unsubscribe of "
+              << consumerCount << " consumers by observation id: "
+              << std::chrono::duration_cast<std::chrono::microseconds>(unsubscribe).count()
+              << " us" << std::endl;
+}
@@ -25,6 +25,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <chrono>
+#include <vector>
 
 #include "NSProviderInterface.h"
 #include "NSConsumerSimulator.h"
@@ -331,6 +332,73 @@ TEST_F(NotificationProviderTest, ExpectCallbackSyncOnReadFromConsumer)
     }
 }
 
+TEST_F(NotificationProviderTest, ExpectBatchedMessagesInOrderBeforeSync)
+{
+    const int messageCount = 5;
+    std::vector<int> sentIDs;
+    std::vector<int> receivedIDs;
+    size_t receivedBeforeSync = 0;
+    bool isSynced = false;
+
+    mocks.OnCallFunc(NSMessageCallbackFromConsumerEmpty).Do(
+            [&receivedIDs](const int &id, const std::string&, const std::string&, const std::string&)
+            {
+                std::unique_lock< std::mutex > lock{ mutexForCondition };
+                receivedIDs.push_back(id);
+            });
+
+    mocks.OnCallFunc(NSSyncCallbackFromConsumerEmpty).Do(
+            [&sentIDs, &receivedIDs, &receivedBeforeSync, &isSynced](int type, int syncId)
+            {
+                std::unique_lock< std::mutex > lock{ mutexForCondition };
+                if (!sentIDs.empty() && syncId == sentIDs.back() && type == NS_SYNC_READ)
+                {
+                    receivedBeforeSync = receivedIDs.size();
+                    isSynced = true;
+                    responseCon.notify_all();
+                }
+            });
+
+    NSBatchMetrics before;
+    NSProviderGetBatchMetrics(&before);
+    NSProviderSetMessageBatching(10000, messageCount + 1);
+
+    for (int i = 0; i < messageCount; i++)
+    {
+        NSMessage * msg = NSCreateMessage();
+        ASSERT_NE((void*)msg, (void*)NULL);
+
+        msg->title = g_title;
+        msg->contentText = g_body;
+        msg->sourceName = g_sourceName;
+        {
+            std::unique_lock< std::mutex > lock{ mutexForCondition };
+            sentIDs.push_back((int)msg->messageId);
+        }
+        NSSendMessage(msg);
+    }
+
+    // the sync flushes the waiting messages long before the window ends
+    NSProviderSendSyncInfo(sentIDs.back(), NS_SYNC_READ);
+
+    {
+        std::unique_lock< std::mutex > lock{ mutexForCondition };
+        responseCon.wait_for(lock, std::chrono::milliseconds(3000), [&isSynced]{ return isSynced; });
+    }
+
+    NSProviderSetMessageBatching(0, 0);
+
+    NSBatchMetrics after;
+    NSProviderGetBatchMetrics(&after);
+
+    std::unique_lock< std::mutex > lock{ mutexForCondition };
+    EXPECT_TRUE(isSynced);
+    EXPECT_EQ(sentIDs, receivedIDs);
+    EXPECT_EQ((size_t)messageCount, receivedBeforeSync);
+    EXPECT_EQ(before.batchCount + 1, after.batchCount);
+    EXPECT_EQ(before.messageCount + messageCount, after.messageCount);
+}
+
 TEST_F(NotificationProviderTest, ExpectEqualAddedTopicsAndRegisteredTopics)
 {
     std::string str("TEST1");
@@ -22,6 +22,9 @@
 
 #include "RCSException.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace OIC
 {
     namespace Service
@@ -30,17 +33,28 @@ namespace OIC
         namespace
         {
             constexpr ExpiryTimerImpl::Id INVALID_ID{ 0U };
+
+            constexpr long long TICK_IN_MILLIS{ 5 };
+            constexpr long long WHEEL_SIZE{ 1024 };
+            constexpr long long NO_TICK{ std::numeric_limits< long long >::max() };
         }
 
         ExpiryTimerImpl::ExpiryTimerImpl() :
-                m_tasks{ },
+                m_shards{ },
+                m_nextId{ 1U },
                 m_thread{ },
                 m_mutex{ },
                 m_cond{ },
                 m_stop{ false },
-                m_mt{ std::random_device{ }() },
-                m_dist{ }
+                m_nextWakeUp{ NO_TICK }
         {
+            const Tick now = currentTick();
+            for (auto& shard : m_shards)
+            {
+                shard.slots.resize(WHEEL_SIZE);
+                shard.current = now;
+            }
+
             m_thread = std::thread(&ExpiryTimerImpl::run, this);
         }
 
@@ -48,7 +62,6 @@ namespace OIC
         {
             {
                 std::lock_guard< std::mutex > lock{ m_mutex };
-                m_tasks.clear();
                 m_stop = true;
             }
             m_cond.notify_all();
@@ -73,125 +86,194 @@ namespace OIC
                 throw RCSInvalidParameterException{ "callback is empty." };
             }
 
-            return addTask(convertToTime(Milliseconds{ delay }), std::move(cb), generateId());
+            return addTask(convertToTick(Milliseconds{ delay }), std::move(cb));
         }
 
         bool ExpiryTimerImpl::cancel(Id id)
         {
             if (id == INVALID_ID) return false;
 
-            std::lock_guard< std::mutex > lock{ m_mutex };
+            Shard& shard = getShard(id);
+            std::lock_guard< std::mutex > lock{ shard.mutex };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end(); ++it)
-            {
-                if(it->second->getId() == id)
-                {
-                    m_tasks.erase(it);
-                    return true;
-                }
-            }
-            return false;
+            auto it = shard.index.find(id);
+            if (it == shard.index.end()) return false;
+
+            shard.slots[it->second->expiry % WHEEL_SIZE].erase(it->second);
+            shard.index.erase(it);
+            return true;
         }
 
         size_t ExpiryTimerImpl::cancelAll(
                 const std::unordered_set< std::shared_ptr<TimerTask > >& tasks)
         {
-            std::lock_guard< std::mutex > lock{ m_mutex };
             size_t erased { 0 };
 
-            for(auto it = m_tasks.begin(); it != m_tasks.end();)
+            for (const auto& task : tasks)
             {
-                if(tasks.count(it->second))
-                {
-                    it = m_tasks.erase(it);
-                    ++erased;
-                }
-                else
-                {
-                    ++it;
-                }
+                if (cancel(task->getId())) ++erased;
             }
             return erased;
         }
 
-        ExpiryTimerImpl::Milliseconds ExpiryTimerImpl::convertToTime(Milliseconds delay)
+        ExpiryTimerImpl::Tick ExpiryTimerImpl::currentTick()
         {
-            const auto now = std::chrono::system_clock::now();
-            return std::chrono::duration_cast< Milliseconds >(now.time_since_epoch()) + delay;
+            const auto now = std::chrono::steady_clock::now().time_since_epoch();
+            return std::chrono::duration_cast< Milliseconds >(now).count() / TICK_IN_MILLIS;
         }
 
-        std::shared_ptr< TimerTask > ExpiryTimerImpl::addTask(
-                Milliseconds delay, Callback cb, Id id)
+        ExpiryTimerImpl::Tick ExpiryTimerImpl::convertToTick(Milliseconds delay)
         {
-            std::lock_guard< std::mutex > lock{ m_mutex };
+            const auto now = std::chrono::steady_clock::now().time_since_epoch();
+            const Milliseconds time{ std::chrono::duration_cast< Milliseconds >(now) + delay };
 
-            auto newTask = std::make_shared< TimerTask >(id, std::move(cb));
-            m_tasks.insert({ delay, newTask });
-            m_cond.notify_all();
+            // rounded up, a task never expires before its delay.
+            return (time.count() + TICK_IN_MILLIS - 1) / TICK_IN_MILLIS;
+        }
 
-            return newTask;
+        ExpiryTimerImpl::Shard& ExpiryTimerImpl::getShard(Id id)
+        {
+            return m_shards[id % NUM_OF_SHARDS];
         }
 
-        bool ExpiryTimerImpl::containsId(Id id) const
+        std::shared_ptr< TimerTask > ExpiryTimerImpl::addTask(Tick expiry, Callback cb)
         {
-            for (const auto& info : m_tasks)
+            std::shared_ptr< TimerTask > newTask;
+
+            while (!newTask)
             {
-                if (info.second->getId() == id) return true;
+                const Id id = m_nextId++;
+                if (id == INVALID_ID) continue;
+
+                Shard& shard = getShard(id);
+                std::lock_guard< std::mutex > lock{ shard.mutex };
+
+                // ids wrap around, skip the ones still armed.
+                if (shard.index.count(id)) continue;
+
+                // a tick already executed is not visited again until the next round.
+                expiry = std::max(expiry, shard.current + 1);
+
+                newTask = std::make_shared< TimerTask >(id, std::move(cb));
+
+                Slot& slot = shard.slots[expiry % WHEEL_SIZE];
+                shard.index[id] = slot.insert(slot.end(), TimerEntry{ expiry, newTask });
             }
-            return false;
+
+            wakeUpAt(expiry);
+
+            return newTask;
         }
 
-        ExpiryTimerImpl::Id ExpiryTimerImpl::generateId()
+        void ExpiryTimerImpl::wakeUpAt(Tick tick)
         {
-            Id newId = m_dist(m_mt);
+            if (tick >= m_nextWakeUp) return;
 
             std::lock_guard< std::mutex > lock{ m_mutex };
-
-            while (newId == INVALID_ID || containsId(newId))
+            if (tick < m_nextWakeUp)
             {
-                newId = m_dist(m_mt);
+                m_nextWakeUp = tick;
+                m_cond.notify_all();
             }
-            return newId;
         }
 
-        void ExpiryTimerImpl::executeExpired()
+        void ExpiryTimerImpl::executeExpired(Tick now)
         {
-            if (m_tasks.empty()) return;
-
-            auto now = std::chrono::system_clock::now().time_since_epoch();
+            std::vector< std::pair< Id, Callback > > expired;
 
-            auto it = m_tasks.begin();
-            for (; it != m_tasks.end() && it->first <= now; ++it)
+            for (auto& shard : m_shards)
             {
-                it->second->execute();
+                std::lock_guard< std::mutex > lock{ shard.mutex };
+
+                if (shard.current >= now) continue;
+
+                // every slot is visited at most once, however long the thread slept.
+                for (Tick tick = std::max(shard.current + 1, now - WHEEL_SIZE + 1);
+                        tick <= now; ++tick)
+                {
+                    Slot& slot = shard.slots[tick % WHEEL_SIZE];
+
+                    for (auto it = slot.begin(); it != slot.end();)
+                    {
+                        if (it->expiry > now)
+                        {
+                            ++it;
+                            continue;
+                        }
+
+                        const Id id{ it->task->getId() };
+                        shard.index.erase(id);
+                        expired.emplace_back(id, it->task->expire());
+                        it = slot.erase(it);
+                    }
+                }
+                shard.current = now;
             }
 
-            m_tasks.erase(m_tasks.begin(), it);
+            if (expired.empty()) return;
+
+            std::thread(
+                    [](std::vector< std::pair< Id, Callback > > tasks)
+                    {
+                        for (auto& task : tasks)
+                        {
+                            task.second(task.first);
+                        }
+                    }, std::move(expired)).detach();
         }
 
-        ExpiryTimerImpl::Milliseconds ExpiryTimerImpl::remainingTimeForNext() const
+        ExpiryTimerImpl::Tick ExpiryTimerImpl::getNextExpiry(Tick now)
         {
-            const Milliseconds& expiredTime = m_tasks.begin()->first;
+            Tick next{ NO_TICK };
+
+            for (auto& shard : m_shards)
+            {
+                std::lock_guard< std::mutex > lock{ shard.mutex };
 
-            return std::chrono::duration_cast< Milliseconds >(expiredTime -
-                    std::chrono::system_clock::now().time_since_epoch()) + Milliseconds{ 1 };
+                if (shard.index.empty()) continue;
+
+                // the first non-empty slot is a lower bound of the shard's next expiry.
+                for (Tick tick = now + 1; tick < next && tick <= now + WHEEL_SIZE; ++tick)
+                {
+                    if (!shard.slots[tick % WHEEL_SIZE].empty())
+                    {
+                        next = tick;
+                        break;
+                    }
+                }
+            }
+            return next;
         }
 
         void ExpiryTimerImpl::run()
         {
-            auto hasTaskOrStop = [this](){ return !m_tasks.empty() || m_stop; };
-
             std::unique_lock< std::mutex > lock{ m_mutex };
 
-            while(!m_stop)
+            while (!m_stop)
             {
-                m_cond.wait(lock, hasTaskOrStop);
+                // tasks posted from now on lower it and wake the thread up.
+                m_nextWakeUp = NO_TICK;
+                lock.unlock();
 
-                if (m_stop) break;
+                const Tick now = currentTick();
+                executeExpired(now);
+                const Tick next = getNextExpiry(now);
+
+                lock.lock();
 
-                m_cond.wait_for(lock, remainingTimeForNext());
+                if (next < m_nextWakeUp) m_nextWakeUp = next;
 
-                executeExpired();
+                if (m_stop) break;
+
+                if (m_nextWakeUp == NO_TICK)
+                {
+                    m_cond.wait(lock);
+                }
+                else
+                {
+                    m_cond.wait_until(lock, std::chrono::steady_clock::time_point{
+                            Milliseconds{ m_nextWakeUp * TICK_IN_MILLIS } });
+                }
             }
         }
 
@@ -202,16 +284,14 @@ namespace OIC
         {
         }
 
-        void TimerTask::execute()
+        ExpiryTimerImpl::Callback TimerTask::expire()
         {
-            if (isExecuted()) return;
-
-            ExpiryTimerImpl::Id id { m_id };
             m_id = INVALID_ID;
 
-            std::thread(std::move(m_callback), id).detach();
-
+            ExpiryTimerImpl::Callback cb{ std::move(m_callback) };
             m_callback = ExpiryTimerImpl::Callback{ };
+
+            return cb;
         }
 
         bool TimerTask::isExecuted() const
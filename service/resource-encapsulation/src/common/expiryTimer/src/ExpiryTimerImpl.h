@@ -22,14 +22,17 @@
 #define _EXPIRY_TIMER_IMPL_H_
 
 #include <functional>
-#include <map>
+#include <array>
+#include <list>
+#include <vector>
+#include <unordered_map>
 #include <mutex>
 #include <thread>
 #include <chrono>
 #include <condition_variable>
-#include <random>
 #include <unordered_set>
 #include <atomic>
+#include <memory>
 
 namespace OIC
 {
@@ -37,6 +40,14 @@ namespace OIC
     {
         class TimerTask;
 
+        /**
+         * Timer service shared by all ExpiryTimer instances.
+         *
+         * Tasks are kept in a hashed timer wheel, so post and cancel don't depend on
+         * the number of armed tasks. The wheel is split into shards by task id, each
+         * with its own lock. Tasks expiring at the same tick are dispatched together
+         * on one thread.
+         */
         class ExpiryTimerImpl
         {
         public:
@@ -47,6 +58,27 @@ namespace OIC
 
         private:
             typedef std::chrono::milliseconds Milliseconds;
+            typedef long long Tick;
+
+            struct TimerEntry
+            {
+                Tick expiry;
+                std::shared_ptr< TimerTask > task;
+            };
+
+            typedef std::list< TimerEntry > Slot;
+
+            struct Shard
+            {
+                std::mutex mutex;
+                std::vector< Slot > slots;
+                std::unordered_map< Id, Slot::iterator > index;
+
+                // the last tick whose tasks were executed.
+                Tick current;
+            };
+
+            static constexpr size_t NUM_OF_SHARDS{ 8 };
 
         private:
             ExpiryTimerImpl();
@@ -64,38 +96,33 @@ namespace OIC
             size_t cancelAll(const std::unordered_set< std::shared_ptr<TimerTask > >&);
 
         private:
-            static Milliseconds convertToTime(Milliseconds);
+            static Tick currentTick();
+            static Tick convertToTick(Milliseconds);
 
-            std::shared_ptr< TimerTask > addTask(Milliseconds, Callback, Id);
+            Shard& getShard(Id);
 
-            /**
-             * @pre The lock must be acquired with m_mutex.
-             */
-            bool containsId(Id) const;
-            Id generateId();
+            std::shared_ptr< TimerTask > addTask(Tick, Callback);
 
-            /**
-             * @pre The lock must be acquired with m_mutex.
-             */
-            void executeExpired();
+            void wakeUpAt(Tick);
 
-            /**
-             * @pre The lock must be acquired with m_mutex.
-             */
-            Milliseconds remainingTimeForNext() const;
+            void executeExpired(Tick);
+            Tick getNextExpiry(Tick);
 
             void run();
 
         private:
-            std::multimap< Milliseconds, std::shared_ptr< TimerTask > > m_tasks;
+            std::array< Shard, NUM_OF_SHARDS > m_shards;
+            std::atomic< Id > m_nextId;
 
             std::thread m_thread;
             std::mutex m_mutex;
             std::condition_variable m_cond;
             bool m_stop;
 
-            std::mt19937 m_mt;
-            std::uniform_int_distribution< Id > m_dist;
+            /**
+             * Tick the timer thread wakes up at. Lowered under m_mutex by posting.
+             */
+            std::atomic< Tick > m_nextWakeUp;
 
         };
 
@@ -114,7 +141,7 @@ namespace OIC
             ExpiryTimerImpl::Id getId() const;
 
         private:
-            void execute();
+            ExpiryTimerImpl::Callback expire();
 
         private:
             std::atomic< ExpiryTimerImpl::Id > m_id;
@@ -22,6 +22,9 @@
 
 #include <mutex>
 #include <atomic>
+#include <chrono>
+#include <iostream>
+#include <vector>
 
 #include "RCSException.h"
 #include "ExpiryTimer.h"
@@ -118,6 +121,19 @@ TEST_F(ExpiryTimerImplTest, CallbackBeInvokedWithTimerId)
     Wait();
 }
 
+TEST_F(ExpiryTimerImplTest, CallbackBeNotInvokedBeforeDelay)
+{
+    FunctionObject* functor = mocks.Mock< FunctionObject >();
+
+    mocks.NeverCall(functor, FunctionObject::execute);
+
+    ExpiryTimerImpl::Id id = ExpiryTimerImpl::getInstance()->post(TOLERANCE_IN_MILLIS * 2,
+            std::bind(&FunctionObject::execute, functor, std::placeholders::_1))->getId();
+    Wait();
+
+    ASSERT_TRUE(ExpiryTimerImpl::getInstance()->cancel(id));
+}
+
 TEST_F(ExpiryTimerImplTest, CanceledTaskBeNotCalled)
 {
     FunctionObject* functor = mocks.Mock< FunctionObject >();
@@ -182,6 +198,56 @@ TEST_F(ExpiryTimerImplTest, CallbackBeInvokedWithinToleranceWithMultiplePost)
     ASSERT_EQ(NUM_OF_POST, called);
 }
 
+// Measures post and cancel with 100k armed tasks, and how long 1k short
+// tasks take to expire while they are armed.
+TEST_F(ExpiryTimerImplTest, ArmedTasksBenchmark)
+{
+    constexpr int NUM_OF_ARMED{ 100000 };
+    constexpr int NUM_OF_SHORT{ 1000 };
+    constexpr int SHORT_DELAY{ 10 };
+
+    std::vector< ExpiryTimerImpl::Id > ids;
+    ids.reserve(NUM_OF_ARMED);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i=0; i<NUM_OF_ARMED; ++i)
+    {
+        ids.push_back(ExpiryTimerImpl::getInstance()->post(60000 + rand() % 60000,
+                [](ExpiryTimerImpl::Id)
+                {
+                })->getId());
+    }
+    auto posted = std::chrono::steady_clock::now();
+
+    std::atomic_int called{ 0 };
+    for (int i=0; i<NUM_OF_SHORT; ++i)
+    {
+        ExpiryTimerImpl::getInstance()->post(SHORT_DELAY,
+                [this, &called](ExpiryTimerImpl::Id)
+                {
+                    if (++called == NUM_OF_SHORT) Proceed();
+                });
+    }
+    auto shortPosted = std::chrono::steady_clock::now();
+    Wait(SHORT_DELAY + TOLERANCE_IN_MILLIS * 10);
+    auto expired = std::chrono::steady_clock::now();
+    ASSERT_EQ(NUM_OF_SHORT, called);
+
+    for (const auto& id : ids)
+    {
+        ASSERT_TRUE(ExpiryTimerImpl::getInstance()->cancel(id));
+    }
+    auto cancelled = std::chrono::steady_clock::now();
+
+    typedef std::chrono::duration< double, std::micro > Micros;
+    typedef std::chrono::duration< double, std::milli > Millis;
+    std::cout << NUM_OF_ARMED << " armed tasks: "
+              << Micros(posted - start).count() / NUM_OF_ARMED << " us per post, "
+              << Micros(cancelled - expired).count() / NUM_OF_ARMED << " us per cancel, "
+              << NUM_OF_SHORT << " tasks of " << SHORT_DELAY << " ms expired after "
+              << Millis(expired - shortPosted).count() << " ms" << std::endl;
+}
+
 class ExpiryTimerTest: public TestWithMock
 {
 public: